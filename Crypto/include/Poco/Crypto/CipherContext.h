@@ -0,0 +1,229 @@
+//
+// CipherContext.h
+//
+// $Id$
+//
+// Library: Crypto
+// Package: Cipher
+// Module:  CipherContext
+//
+// Definition of the CipherContext class.
+//
+// Copyright (c) 2008, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Crypto_CipherContext_INCLUDED
+#define Crypto_CipherContext_INCLUDED
+
+
+#include "Poco/Crypto/Crypto.h"
+#include "Poco/Crypto/CipherKey.h"
+#include "Poco/Crypto/OpenSSLInitializer.h"
+#include <openssl/evp.h>
+
+
+namespace Poco {
+namespace Crypto {
+
+
+class Crypto_API CipherContext
+	/// A CipherContext encrypts or decrypts messages in caller-supplied
+	/// buffers, without the internal buffering of a CryptoStream and
+	/// without creating new strings like Cipher::encryptString().
+	///
+	/// The key schedule is set up once, when the CipherContext is
+	/// created. Every message is then started with reset(), which only
+	/// sets the initialization vector (nonce), so a CipherContext can
+	/// be reused for any number of messages.
+	///
+	/// Data can be transformed in place (output and input buffers are
+	/// the same) or into a separate buffer of the same size. Padding
+	/// is disabled, so for block cipher modes like CBC or ECB the
+	/// size of the data passed to update() must be a multiple of the
+	/// block size. Stream cipher modes (CTR, CFB, OFB) and the AEAD
+	/// modes accept any size.
+	///
+	/// For the AEAD ciphers (AES-GCM, AES-CCM and, with OpenSSL 1.1.0
+	/// or newer, ChaCha20-Poly1305), additional authenticated data can
+	/// be passed with addAuthData() before the message data, and the
+	/// authentication tag is obtained with getTag() after encryption,
+	/// or passed with setTag() before finalizing decryption.
+	///
+	/// Example:
+	///
+	///     CipherKey key("aes-256-gcm");
+	///     CipherContext encryptor(key, CipherContext::DIR_ENCRYPT);
+	///     unsigned char tag[16];
+	///     encryptor.reset(nonce, 12);
+	///     encryptor.addAuthData(header, headerLength);
+	///     encryptor.update(payload, payloadLength);
+	///     encryptor.finalize();
+	///     encryptor.getTag(tag);
+	///
+	/// AES-CCM needs to know the message size in advance and binds the
+	/// nonce size to the key setup, so it can only be used with the
+	/// one-shot encrypt() and decrypt() member functions, which are
+	/// available for all ciphers.
+	///
+	/// A CipherContext is not thread-safe.
+{
+public:
+	enum Direction
+	{
+		DIR_ENCRYPT,
+		DIR_DECRYPT
+	};
+
+	enum
+	{
+		DEFAULT_TAG_LENGTH = 16
+			/// Default size of the authentication tag of AEAD ciphers.
+	};
+
+	CipherContext(const CipherKey& key, Direction direction, std::size_t tagLength = DEFAULT_TAG_LENGTH);
+		/// Creates a CipherContext for the given key and direction.
+		///
+		/// The tagLength gives the size of the authentication tag
+		/// for AEAD ciphers, and is ignored for other ciphers.
+		/// The first message uses the key's initialization vector.
+
+	~CipherContext();
+		/// Destroys the CipherContext.
+
+	const std::string& name() const;
+		/// Returns the name of the cipher.
+
+	Direction direction() const;
+		/// Returns the direction of the CipherContext.
+
+	bool isAEAD() const;
+		/// Returns true if the cipher is an AEAD cipher that
+		/// produces an authentication tag.
+
+	std::size_t blockSize() const;
+		/// Returns the block size of the cipher.
+
+	std::size_t tagLength() const;
+		/// Returns the size of the authentication tag, or 0 if
+		/// the cipher is not an AEAD cipher.
+
+	void reset();
+		/// Starts a new message, using the key's initialization vector.
+
+	void reset(const unsigned char* iv, std::size_t ivLength);
+		/// Starts a new message with the given initialization vector
+		/// (nonce). For GCM and ChaCha20-Poly1305, the size of the
+		/// nonce may differ from the cipher's default IV size.
+		///
+		/// Never reuse a nonce with the same key for GCM, CCM or
+		/// ChaCha20-Poly1305.
+
+	void addAuthData(const unsigned char* data, std::size_t length);
+		/// Adds additional authenticated data (e.g., a message header)
+		/// that is authenticated, but not encrypted. Must be called
+		/// before update() for the current message.
+		///
+		/// Throws an IllegalStateException if the cipher is not an
+		/// AEAD cipher.
+
+	void update(unsigned char* data, std::size_t length);
+		/// Encrypts or decrypts the given data in place.
+
+	void update(const unsigned char* input, unsigned char* output, std::size_t length);
+		/// Encrypts or decrypts length bytes from input and writes
+		/// the result to output, which must have room for length bytes.
+		/// Input and output may be the same buffer, but must not
+		/// otherwise overlap.
+
+	void setTag(const unsigned char* tag);
+		/// Sets the expected authentication tag of the current message,
+		/// which must be tagLength() bytes. Must be called before
+		/// finalize() when decrypting with an AEAD cipher.
+
+	void finalize();
+		/// Finishes the current message.
+		///
+		/// When decrypting with an AEAD cipher, the message is verified
+		/// against the tag passed to setTag(). If the verification
+		/// fails, a DataException is thrown, and the data returned by
+		/// update() must be discarded.
+
+	void getTag(unsigned char* tag) const;
+		/// Copies the authentication tag of the current message, which
+		/// is tagLength() bytes, to tag. Must be called after finalize()
+		/// when encrypting with an AEAD cipher.
+
+	void encrypt(const unsigned char* iv, std::size_t ivLength, const unsigned char* authData, std::size_t authDataLength, unsigned char* data, std::size_t length, unsigned char* tag);
+		/// Encrypts a complete message in place and stores the
+		/// authentication tag (for AEAD ciphers) in tag.
+		///
+		/// authData may be null if authDataLength is 0, and tag
+		/// may be null if the cipher is not an AEAD cipher.
+
+	void decrypt(const unsigned char* iv, std::size_t ivLength, const unsigned char* authData, std::size_t authDataLength, unsigned char* data, std::size_t length, const unsigned char* tag);
+		/// Decrypts and verifies a complete message in place.
+		///
+		/// Throws a DataException if the message could not be verified.
+
+private:
+	CipherContext();
+	CipherContext(const CipherContext&);
+	CipherContext& operator = (const CipherContext&);
+
+	bool isCCM() const;
+	void checkIncremental() const;
+	void init(const unsigned char* iv, std::size_t ivLength);
+
+	CipherKey _key;
+	const EVP_CIPHER* _pCipher;
+	EVP_CIPHER_CTX* _pContext;
+	Direction _direction;
+	bool _aead;
+	std::size_t _tagLength;
+	std::size_t _ivLength;
+	unsigned char _tag[EVP_MAX_BLOCK_LENGTH];
+	OpenSSLInitializer _openSSLInitializer;
+};
+
+
+//
+// inlines
+//
+inline const std::string& CipherContext::name() const
+{
+	return _key.name();
+}
+
+
+inline CipherContext::Direction CipherContext::direction() const
+{
+	return _direction;
+}
+
+
+inline bool CipherContext::isAEAD() const
+{
+	return _aead;
+}
+
+
+inline std::size_t CipherContext::tagLength() const
+{
+	return _aead ? _tagLength : 0;
+}
+
+
+inline void CipherContext::update(unsigned char* data, std::size_t length)
+{
+	update(data, data, length);
+}
+
+
+} } // namespace Poco::Crypto
+
+
+#endif // Crypto_CipherContext_INCLUDED
@@ -50,7 +50,10 @@ public:
 		MODE_ECB,			/// Electronic codebook (plain concatenation)
 		MODE_CBC,			/// Cipher block chaining (default)
 		MODE_CFB,			/// Cipher feedback
-		MODE_OFB			/// Output feedback
+		MODE_OFB,			/// Output feedback
+		MODE_CTR,			/// Counter mode
+		MODE_GCM,			/// Galois/Counter mode
+		MODE_CCM			/// Counter with CBC-MAC
 	};
 
 	CipherKeyImpl(const std::string& name, 
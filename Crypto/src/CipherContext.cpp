@@ -0,0 +1,317 @@
+//
+// CipherContext.cpp
+//
+// $Id$
+//
+// Library: Crypto
+// Package: Cipher
+// Module:  CipherContext
+//
+// Copyright (c) 2008, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Crypto/CipherContext.h"
+#include "Poco/Exception.h"
+#include <openssl/err.h>
+#include <cstring>
+
+
+namespace Poco {
+namespace Crypto {
+
+
+namespace
+{
+	void throwError()
+	{
+		unsigned long err;
+		std::string msg;
+
+		while ((err = ERR_get_error()))
+		{
+			if (!msg.empty())
+				msg.append("; ");
+			msg.append(ERR_error_string(err, 0));
+		}
+
+		throw Poco::IOException(msg);
+	}
+
+
+	void control(EVP_CIPHER_CTX* pContext, int type, int arg, void* ptr)
+	{
+		if (EVP_CIPHER_CTX_ctrl(pContext, type, arg, ptr) != 1)
+			throwError();
+	}
+
+
+	const std::size_t MAX_CHUNK_SIZE = 0x40000000;
+		// EVP_CipherUpdate() takes an int length; a multiple of every block size.
+}
+
+
+CipherContext::CipherContext(const CipherKey& key, Direction direction, std::size_t tagLength):
+	_key(key),
+	_pCipher(_key.impl()->cipher()),
+	_pContext(EVP_CIPHER_CTX_new()),
+	_direction(direction),
+	_aead(false),
+	_tagLength(tagLength),
+	_ivLength(EVP_CIPHER_iv_length(_pCipher))
+{
+	if (!_pContext) throw Poco::OutOfMemoryException("Cannot create cipher context");
+
+#if defined(EVP_CIPH_FLAG_AEAD_CIPHER)
+	_aead = (EVP_CIPHER_flags(_pCipher) & EVP_CIPH_FLAG_AEAD_CIPHER) != 0;
+#endif
+	try
+	{
+		if (_aead && (_tagLength == 0 || _tagLength > 16))
+			throw Poco::InvalidArgumentException("Invalid authentication tag length");
+
+		const CipherKey::ByteVec& keyBytes = _key.getKey();
+		int enc = _direction == DIR_ENCRYPT ? 1 : 0;
+		if (isCCM())
+		{
+			// the key is set up for every message in encrypt()/decrypt()
+			if (EVP_CipherInit_ex(_pContext, _pCipher, 0, 0, 0, enc) != 1)
+				throwError();
+		}
+		else
+		{
+			if (EVP_CipherInit_ex(_pContext, _pCipher, 0, &keyBytes[0], 0, enc) != 1)
+				throwError();
+			EVP_CIPHER_CTX_set_padding(_pContext, 0);
+			reset();
+		}
+	}
+	catch (...)
+	{
+		EVP_CIPHER_CTX_free(_pContext);
+		throw;
+	}
+}
+
+
+CipherContext::~CipherContext()
+{
+	EVP_CIPHER_CTX_free(_pContext);
+}
+
+
+std::size_t CipherContext::blockSize() const
+{
+	return EVP_CIPHER_block_size(_pCipher);
+}
+
+
+void CipherContext::reset()
+{
+	const CipherKey::ByteVec& iv = _key.getIV();
+	reset(iv.empty() ? 0 : &iv[0], iv.size());
+}
+
+
+void CipherContext::reset(const unsigned char* iv, std::size_t ivLength)
+{
+	checkIncremental();
+	init(iv, ivLength);
+}
+
+
+void CipherContext::addAuthData(const unsigned char* data, std::size_t length)
+{
+	checkIncremental();
+	if (!_aead) throw Poco::IllegalStateException("Not an AEAD cipher", name());
+
+	while (length > 0)
+	{
+		int chunk = static_cast<int>(length < MAX_CHUNK_SIZE ? length : MAX_CHUNK_SIZE);
+		int outLength = 0;
+		if (EVP_CipherUpdate(_pContext, 0, &outLength, data, chunk) != 1)
+			throwError();
+		data += chunk;
+		length -= chunk;
+	}
+}
+
+
+void CipherContext::update(const unsigned char* input, unsigned char* output, std::size_t length)
+{
+	checkIncremental();
+	std::size_t size = blockSize();
+	if (size > 1 && length % size != 0)
+		throw Poco::InvalidArgumentException("Data size must be a multiple of the block size", name());
+
+	while (length > 0)
+	{
+		int chunk = static_cast<int>(length < MAX_CHUNK_SIZE ? length : MAX_CHUNK_SIZE);
+		int outLength = 0;
+		if (EVP_CipherUpdate(_pContext, output, &outLength, input, chunk) != 1)
+			throwError();
+		poco_assert (outLength == chunk);
+		input += chunk;
+		output += chunk;
+		length -= chunk;
+	}
+}
+
+
+void CipherContext::setTag(const unsigned char* tag)
+{
+	checkIncremental();
+	if (!_aead) throw Poco::IllegalStateException("Not an AEAD cipher", name());
+	if (_direction != DIR_DECRYPT) throw Poco::IllegalStateException("Tag can only be set for decryption");
+
+#if defined(EVP_CIPH_FLAG_AEAD_CIPHER)
+	std::memcpy(_tag, tag, _tagLength);
+	control(_pContext, EVP_CTRL_GCM_SET_TAG, static_cast<int>(_tagLength), _tag);
+#endif
+}
+
+
+void CipherContext::finalize()
+{
+	checkIncremental();
+
+	unsigned char buffer[EVP_MAX_BLOCK_LENGTH];
+	int length = 0;
+	if (EVP_CipherFinal_ex(_pContext, buffer, &length) != 1)
+	{
+		if (_aead && _direction == DIR_DECRYPT)
+		{
+			ERR_clear_error();
+			throw Poco::DataException("Authentication failed", name());
+		}
+		throwError();
+	}
+	poco_assert (length == 0);
+
+#if defined(EVP_CIPH_FLAG_AEAD_CIPHER)
+	if (_aead && _direction == DIR_ENCRYPT)
+		control(_pContext, EVP_CTRL_GCM_GET_TAG, static_cast<int>(_tagLength), _tag);
+#endif
+}
+
+
+void CipherContext::getTag(unsigned char* tag) const
+{
+	if (!_aead) throw Poco::IllegalStateException("Not an AEAD cipher", name());
+	if (_direction != DIR_ENCRYPT) throw Poco::IllegalStateException("Tag is only available after encryption");
+
+	std::memcpy(tag, _tag, _tagLength);
+}
+
+
+void CipherContext::encrypt(const unsigned char* iv, std::size_t ivLength, const unsigned char* authData, std::size_t authDataLength, unsigned char* data, std::size_t length, unsigned char* tag)
+{
+	if (_direction != DIR_ENCRYPT) throw Poco::IllegalStateException("Not an encryptor", name());
+
+#if defined(EVP_CIPH_CCM_MODE)
+	if (isCCM())
+	{
+		const CipherKey::ByteVec& keyBytes = _key.getKey();
+		control(_pContext, EVP_CTRL_CCM_SET_IVLEN, static_cast<int>(ivLength), 0);
+		control(_pContext, EVP_CTRL_CCM_SET_TAG, static_cast<int>(_tagLength), 0);
+		if (EVP_CipherInit_ex(_pContext, 0, 0, &keyBytes[0], iv, -1) != 1)
+			throwError();
+
+		int outLength = 0;
+		if (EVP_CipherUpdate(_pContext, 0, &outLength, 0, static_cast<int>(length)) != 1)
+			throwError();
+		if (authDataLength > 0 && EVP_CipherUpdate(_pContext, 0, &outLength, authData, static_cast<int>(authDataLength)) != 1)
+			throwError();
+		if (EVP_CipherUpdate(_pContext, data, &outLength, data, static_cast<int>(length)) != 1)
+			throwError();
+		unsigned char buffer[EVP_MAX_BLOCK_LENGTH];
+		if (EVP_CipherFinal_ex(_pContext, buffer, &outLength) != 1)
+			throwError();
+		control(_pContext, EVP_CTRL_CCM_GET_TAG, static_cast<int>(_tagLength), tag);
+		return;
+	}
+#endif
+
+	init(iv, ivLength);
+	if (authDataLength > 0) addAuthData(authData, authDataLength);
+	update(data, length);
+	finalize();
+	if (_aead) getTag(tag);
+}
+
+
+void CipherContext::decrypt(const unsigned char* iv, std::size_t ivLength, const unsigned char* authData, std::size_t authDataLength, unsigned char* data, std::size_t length, const unsigned char* tag)
+{
+	if (_direction != DIR_DECRYPT) throw Poco::IllegalStateException("Not a decryptor", name());
+
+#if defined(EVP_CIPH_CCM_MODE)
+	if (isCCM())
+	{
+		const CipherKey::ByteVec& keyBytes = _key.getKey();
+		std::memcpy(_tag, tag, _tagLength);
+		control(_pContext, EVP_CTRL_CCM_SET_IVLEN, static_cast<int>(ivLength), 0);
+		control(_pContext, EVP_CTRL_CCM_SET_TAG, static_cast<int>(_tagLength), _tag);
+		if (EVP_CipherInit_ex(_pContext, 0, 0, &keyBytes[0], iv, -1) != 1)
+			throwError();
+
+		int outLength = 0;
+		if (EVP_CipherUpdate(_pContext, 0, &outLength, 0, static_cast<int>(length)) != 1)
+			throwError();
+		if (authDataLength > 0 && EVP_CipherUpdate(_pContext, 0, &outLength, authData, static_cast<int>(authDataLength)) != 1)
+			throwError();
+		// CCM verifies the tag while decrypting
+		if (EVP_CipherUpdate(_pContext, data, &outLength, data, static_cast<int>(length)) <= 0)
+		{
+			ERR_clear_error();
+			throw Poco::DataException("Authentication failed", name());
+		}
+		return;
+	}
+#endif
+
+	init(iv, ivLength);
+	if (authDataLength > 0) addAuthData(authData, authDataLength);
+	if (_aead) setTag(tag);
+	update(data, length);
+	finalize();
+}
+
+
+bool CipherContext::isCCM() const
+{
+#if defined(EVP_CIPH_CCM_MODE)
+	return EVP_CIPHER_mode(_pCipher) == EVP_CIPH_CCM_MODE;
+#else
+	return false;
+#endif
+}
+
+
+void CipherContext::checkIncremental() const
+{
+	if (isCCM()) throw Poco::IllegalStateException("CCM mode requires encrypt() or decrypt()", name());
+}
+
+
+void CipherContext::init(const unsigned char* iv, std::size_t ivLength)
+{
+	if (ivLength != _ivLength)
+	{
+#if defined(EVP_CIPH_FLAG_AEAD_CIPHER)
+		if (!_aead) throw Poco::InvalidArgumentException("Invalid IV size", name());
+		control(_pContext, EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(ivLength), 0);
+		_ivLength = ivLength;
+#else
+		throw Poco::InvalidArgumentException("Invalid IV size", name());
+#endif
+	}
+	// only sets the IV; the key schedule is kept
+	if (EVP_CipherInit_ex(_pContext, 0, 0, 0, iv, -1) != 1)
+		throwError();
+}
+
+
+} } // namespace Poco::Crypto
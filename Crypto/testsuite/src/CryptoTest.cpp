@@ -18,9 +18,13 @@
 #include "Poco/Crypto/CipherKey.h"
 #include "Poco/Crypto/X509Certificate.h"
 #include "Poco/Crypto/CryptoStream.h"
+#include "Poco/Crypto/CipherContext.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/Base64Encoder.h"
+#include "Poco/Stopwatch.h"
 #include <sstream>
+#include <iostream>
+#include <cstring>
 
 
 using namespace Poco::Crypto;
@@ -249,6 +253,186 @@ void CryptoTest::testCertificate()
 }
 
 
+void CryptoTest::testCipherContextGCM()
+{
+	// NIST GCM test case 2
+	static const unsigned char CIPHERTEXT[] = { 0x03, 0x88, 0xda, 0xce, 0x60, 0xb6, 0xa3, 0x92, 0xf3, 0x28, 0xc2, 0xb9, 0x71, 0xb2, 0xfe, 0x78 };
+	static const unsigned char TAG[] = { 0xab, 0x6e, 0x47, 0xd4, 0x2c, 0xec, 0x13, 0xbd, 0xf5, 0x3a, 0x67, 0xb2, 0x12, 0x57, 0xbd, 0xdf };
+
+	CipherKey key("aes-128-gcm", CipherKey::ByteVec(16, 0), CipherKey::ByteVec(12, 0));
+	CipherContext encryptor(key, CipherContext::DIR_ENCRYPT);
+	assert (encryptor.isAEAD());
+	assert (encryptor.tagLength() == 16);
+
+	unsigned char data[16] = { 0 };
+	unsigned char tag[16];
+	encryptor.reset();
+	encryptor.update(data, 8);
+	encryptor.update(data + 8, 8);
+	encryptor.finalize();
+	encryptor.getTag(tag);
+	assert (std::memcmp(data, CIPHERTEXT, 16) == 0);
+	assert (std::memcmp(tag, TAG, 16) == 0);
+
+	CipherContext decryptor(key, CipherContext::DIR_DECRYPT);
+	decryptor.reset();
+	decryptor.update(data, 16);
+	decryptor.setTag(tag);
+	decryptor.finalize();
+	for (int i = 0; i < 16; i++) assert (data[i] == 0);
+
+	tag[15] ^= 1;
+	std::memcpy(data, CIPHERTEXT, 16);
+	try
+	{
+		decryptor.reset();
+		decryptor.update(data, 16);
+		decryptor.setTag(tag);
+		decryptor.finalize();
+		fail("modified tag - must throw");
+	}
+	catch (Poco::DataException&)
+	{
+	}
+}
+
+
+void CryptoTest::testAEADRoundTrip(CipherKey& key)
+{
+	CipherContext encryptor(key, CipherContext::DIR_ENCRYPT);
+	CipherContext decryptor(key, CipherContext::DIR_DECRYPT);
+	assert (encryptor.isAEAD());
+
+	const std::string header("header");
+	const unsigned char* pHeader = reinterpret_cast<const unsigned char*>(header.data());
+	unsigned char nonce[12] = { 0 };
+	unsigned char tag[16];
+	for (int n = 0; n < 10; n++)
+	{
+		nonce[0] = static_cast<unsigned char>(n);
+		std::string message(n*100 + 1, 'a' + n);
+		std::string data(message);
+		unsigned char* pData = reinterpret_cast<unsigned char*>(&data[0]);
+
+		encryptor.encrypt(nonce, sizeof(nonce), pHeader, header.size(), pData, data.size(), tag);
+		assert (data != message);
+
+		decryptor.decrypt(nonce, sizeof(nonce), pHeader, header.size(), pData, data.size(), tag);
+		assert (data == message);
+
+		encryptor.encrypt(nonce, sizeof(nonce), pHeader, header.size(), pData, data.size(), tag);
+		try
+		{
+			decryptor.decrypt(nonce, sizeof(nonce), pHeader, header.size() - 1, pData, data.size(), tag);
+			fail("modified header - must throw");
+		}
+		catch (Poco::DataException&)
+		{
+		}
+	}
+}
+
+
+void CryptoTest::testCipherContextAEAD()
+{
+	CipherKey gcmKey("aes-256-gcm");
+	testAEADRoundTrip(gcmKey);
+
+	CipherKey ccmKey("aes-128-ccm");
+	testAEADRoundTrip(ccmKey);
+
+	try
+	{
+		CipherKey chachaKey("chacha20-poly1305");
+		testAEADRoundTrip(chachaKey);
+	}
+	catch (Poco::NotFoundException&)
+	{
+		// requires OpenSSL 1.1.0 or newer
+	}
+}
+
+
+void CryptoTest::testCipherContextInPlace()
+{
+	CipherKey key("aes-256-cbc");
+	Cipher::Ptr pCipher = CipherFactory::defaultFactory().createCipher(key);
+	CipherContext encryptor(key, CipherContext::DIR_ENCRYPT);
+	CipherContext decryptor(key, CipherContext::DIR_DECRYPT);
+
+	std::string message(4*encryptor.blockSize(), 'x');
+	std::string data(message);
+	unsigned char* pData = reinterpret_cast<unsigned char*>(&data[0]);
+	encryptor.reset();
+	encryptor.update(pData, data.size());
+	encryptor.finalize();
+
+	// same result as Cipher, without the padding block
+	std::string encrypted = pCipher->encryptString(message);
+	assert (encrypted.size() == data.size() + encryptor.blockSize());
+	assert (encrypted.compare(0, data.size(), data) == 0);
+
+	std::string result(data.size(), '\0');
+	decryptor.reset();
+	decryptor.update(pData, reinterpret_cast<unsigned char*>(&result[0]), data.size());
+	decryptor.finalize();
+	assert (result == message);
+
+	try
+	{
+		encryptor.reset();
+		encryptor.update(pData, data.size() - 1);
+		fail("partial block - must throw");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+}
+
+
+void CryptoTest::testCipherContextBenchmark()
+{
+	static const std::size_t SIZES[] = { 64, 1024, 16384, 1024*1024 };
+	const std::size_t total = 16*1024*1024;
+
+	CipherKey key("aes-256-gcm");
+	CipherContext encryptor(key, CipherContext::DIR_ENCRYPT);
+	Cipher::Ptr pCipher = CipherFactory::defaultFactory().createCipher(CipherKey("aes-256-cbc"));
+
+	Poco::Stopwatch sw;
+	std::cout << std::endl;
+	for (std::size_t i = 0; i < sizeof(SIZES)/sizeof(SIZES[0]); i++)
+	{
+		std::string message(SIZES[i], 'x');
+		unsigned char* pData = reinterpret_cast<unsigned char*>(&message[0]);
+		unsigned char nonce[12] = { 0 };
+		unsigned char tag[16];
+		std::size_t count = total/SIZES[i];
+
+		sw.restart();
+		for (std::size_t n = 0; n < count; n++)
+		{
+			std::memcpy(nonce, &n, sizeof(n) < sizeof(nonce) ? sizeof(n) : sizeof(nonce));
+			encryptor.encrypt(nonce, sizeof(nonce), 0, 0, pData, message.size(), tag);
+		}
+		sw.stop();
+		Poco::Timestamp::TimeDiff contextTime = sw.elapsed() ? sw.elapsed() : 1;
+
+		sw.restart();
+		for (std::size_t n = 0; n < count; n++)
+		{
+			std::string encrypted = pCipher->encryptString(message);
+		}
+		sw.stop();
+		Poco::Timestamp::TimeDiff stringTime = sw.elapsed() ? sw.elapsed() : 1;
+
+		std::cout << SIZES[i] << " byte messages: CipherContext aes-256-gcm "
+			<< static_cast<long>(total/contextTime) << " MB/s, Cipher::encryptString() aes-256-cbc "
+			<< static_cast<long>(total/stringTime) << " MB/s" << std::endl;
+	}
+}
+
+
 void CryptoTest::setUp()
 {
 }
@@ -271,6 +455,10 @@ CppUnit::Test* CryptoTest::suite()
 	CppUnit_addTest(pSuite, CryptoTest, testDecryptInterop);
 	CppUnit_addTest(pSuite, CryptoTest, testStreams);
 	CppUnit_addTest(pSuite, CryptoTest, testCertificate);
+	CppUnit_addTest(pSuite, CryptoTest, testCipherContextGCM);
+	CppUnit_addTest(pSuite, CryptoTest, testCipherContextAEAD);
+	CppUnit_addTest(pSuite, CryptoTest, testCipherContextInPlace);
+	CppUnit_addTest(pSuite, CryptoTest, testCipherContextBenchmark);
 
 	return pSuite;
 }
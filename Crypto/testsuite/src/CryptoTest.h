@@ -18,6 +18,7 @@
 
 #include "Poco/Crypto/Crypto.h"
 #include "CppUnit/TestCase.h"
+#include "Poco/Crypto/CipherKey.h"
 
 
 class CryptoTest: public CppUnit::TestCase
@@ -39,6 +40,10 @@ public:
 	void testEncryptInterop();
 	void testDecryptInterop();
 	void testCertificate();
+	void testCipherContextGCM();
+	void testCipherContextAEAD();
+	void testCipherContextInPlace();
+	void testCipherContextBenchmark();
 	
 	void setUp();
 	void tearDown();
@@ -46,6 +51,7 @@ public:
 	static CppUnit::Test* suite();
 
 private:
+	void testAEADRoundTrip(Poco::Crypto::CipherKey& key);
 };
 
 
@@ -23,6 +23,7 @@
 #include "Poco/Data/SQLite/SQLite.h"
 #include "Poco/Data/SQLite/Binder.h"
 #include "Poco/Data/SQLite/Extractor.h"
+#include "Poco/Data/SQLite/StatementCache.h"
 #include "Poco/Data/StatementImpl.h"
 #include "Poco/Data/MetaColumn.h"
 #include "Poco/SharedPtr.h"
@@ -44,8 +45,11 @@ class SQLite_API SQLiteStatementImpl: public Poco::Data::StatementImpl
 	/// Implements statement functionality needed for SQLite
 {
 public:
-	SQLiteStatementImpl(Poco::Data::SessionImpl& rSession, sqlite3* pDB);
+	SQLiteStatementImpl(Poco::Data::SessionImpl& rSession, sqlite3* pDB, StatementCache* pCache = 0);
 		/// Creates the SQLiteStatementImpl.
+		///
+		/// If a StatementCache is given, prepared statements are
+		/// taken from and handed back to the cache.
 
 	~SQLiteStatementImpl();
 		/// Destroys the SQLiteStatementImpl.
@@ -95,7 +99,16 @@ protected:
 
 private:
 	void clear();
-		/// Removes the _pStmt
+		/// Removes the _pStmt, handing it back to the
+		/// statement cache if it came from there.
+
+	void beginImplicitTransaction();
+		/// Begins an implicit transaction for a multi-row binding,
+		/// if the session is in autocommit mode and the
+		/// implicitTransaction feature is enabled.
+
+	void endImplicitTransaction(bool commit);
+		/// Commits or rolls back the implicit transaction, if any.
 
 	typedef Poco::SharedPtr<Binder>             BinderPtr;
 	typedef Poco::SharedPtr<Extractor>          ExtractorPtr;
@@ -108,6 +121,8 @@ private:
 
 	sqlite3*         _pDB;
 	sqlite3_stmt*    _pStmt;
+	StatementCache*  _pCache;
+	std::string      _cacheKey;
 	bool             _stepCalled;
 	int              _nextResponse;
 	BinderPtr        _pBinder;
@@ -119,6 +134,7 @@ private:
 	bool             _canBind;
 	bool             _isExtracted;
 	bool             _canCompile;
+	bool             _implicitTransaction;
 
 	static const int POCO_SQLITE_INV_ROW_CNT;
 };
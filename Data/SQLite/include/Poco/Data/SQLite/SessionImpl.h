@@ -23,6 +23,7 @@
 #include "Poco/Data/SQLite/SQLite.h"
 #include "Poco/Data/SQLite/Connector.h"
 #include "Poco/Data/SQLite/Binder.h"
+#include "Poco/Data/SQLite/StatementCache.h"
 #include "Poco/Data/AbstractSessionImpl.h"
 #include "Poco/SharedPtr.h"
 #include "Poco/Mutex.h"
@@ -46,6 +47,37 @@ public:
 	SessionImpl(const std::string& fileName,
 		std::size_t loginTimeout = LOGIN_TIMEOUT_DEFAULT);
 		/// Creates the SessionImpl. Opens a connection to the database.
+		///
+		/// Besides the properties common to all sessions, the following
+		/// properties are supported:
+		///
+		///   - maxStatementCacheSize (std::size_t): the maximum number of
+		///     prepared statements kept for reuse (see StatementCache).
+		///     Zero, the default, disables statement caching.
+		///   - statementCacheHits (Poco::UInt64, read-only): the number of
+		///     statements that reused a cached prepared statement.
+		///   - statementCacheMisses (Poco::UInt64, read-only): the number of
+		///     statements that had to be prepared while caching was enabled.
+		///   - journalMode (std::string): the journal mode of the main
+		///     database (PRAGMA journal_mode), e.g. "WAL" or "DELETE".
+		///   - synchronous (std::string): the synchronous level
+		///     (PRAGMA synchronous), one of "OFF", "NORMAL", "FULL" or "EXTRA".
+		///   - cacheSize (int): the page cache size (PRAGMA cache_size).
+		///     Positive values are pages, negative values are KiB.
+		///   - mmapSize (Poco::Int64): the maximum number of bytes of the
+		///     database file accessed through memory mapping (PRAGMA mmap_size).
+		///
+		/// The values of journalMode and synchronous must be names,
+		/// otherwise an InvalidArgumentException is thrown.
+		///
+		/// and the following feature:
+		///
+		///   - implicitTransaction: if true, a statement that binds a
+		///     container of more than one row while the session is in
+		///     autocommit mode runs all rows within a single implicit
+		///     transaction. The transaction is committed after the last
+		///     row and rolled back if any row fails. Without it, SQLite
+		///     commits (and syncs) every row separately. Default is false.
 
 	~SessionImpl();
 		/// Destroys the SessionImpl.
@@ -117,17 +149,51 @@ public:
 	const std::string& connectorName() const;
 		/// Returns the name of the connector.
 
+	void setImplicitTransaction(const std::string&, bool val);
+		/// Sets the implicitTransaction feature.
+
+	bool isImplicitTransaction(const std::string& name="");
+		/// Returns the value of the implicitTransaction feature.
+
 protected:
 	void setConnectionTimeout(const std::string& prop, const Poco::Any& value);
 	Poco::Any getConnectionTimeout(const std::string& prop);
+	void setMaxStatementCacheSize(const std::string& prop, const Poco::Any& value);
+	Poco::Any getMaxStatementCacheSize(const std::string& prop);
+	Poco::Any getStatementCacheHits(const std::string& prop);
+	Poco::Any getStatementCacheMisses(const std::string& prop);
+	void setJournalMode(const std::string& prop, const Poco::Any& value);
+	Poco::Any getJournalMode(const std::string& prop);
+	void setSynchronous(const std::string& prop, const Poco::Any& value);
+	Poco::Any getSynchronous(const std::string& prop);
+	void setCacheSize(const std::string& prop, const Poco::Any& value);
+	Poco::Any getCacheSize(const std::string& prop);
+	void setMmapSize(const std::string& prop, const Poco::Any& value);
+	Poco::Any getMmapSize(const std::string& prop);
 
 private:
+	void setPragma(const std::string& name, const std::string& value);
+		/// Executes "PRAGMA name=value".
+		///
+		/// Throws an InvalidArgumentException if the name is not
+		/// an identifier, or the value is neither an identifier
+		/// nor an integer.
+
+	static bool isPragmaToken(const std::string& token, bool allowNumber);
+		/// Returns true iff token is an identifier, or, if allowNumber
+		/// is true, an integer with an optional sign.
+
+	std::string getPragma(const std::string& name);
+		/// Executes "PRAGMA name" and returns the first column of the result.
+
 	std::string _connector;
 	sqlite3*    _pDB;
 	bool        _connected;
 	bool        _isTransaction;
+	bool        _implicitTransaction;
 	int         _timeout;
 	Poco::Mutex _mutex;
+	StatementCache _statementCache;
 
 	static const std::string DEFERRED_BEGIN_TRANSACTION;
 	static const std::string COMMIT_TRANSACTION;
@@ -156,6 +222,18 @@ inline const std::string& SessionImpl::connectorName() const
 }
 
 
+inline void SessionImpl::setImplicitTransaction(const std::string&, bool val)
+{
+	_implicitTransaction = val;
+}
+
+
+inline bool SessionImpl::isImplicitTransaction(const std::string&)
+{
+	return _implicitTransaction;
+}
+
+
 inline std::size_t SessionImpl::getConnectionTimeout()
 {
 	return static_cast<std::size_t>(_timeout);
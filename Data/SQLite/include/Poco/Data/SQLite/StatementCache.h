@@ -0,0 +1,157 @@
+//
+// StatementCache.h
+//
+// $Id: //poco/Main/Data/SQLite/include/Poco/Data/SQLite/StatementCache.h#1 $
+//
+// Library: SQLite
+// Package: SQLite
+// Module:  StatementCache
+//
+// Definition of the StatementCache class.
+//
+// Copyright (c) 2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Data_SQLite_StatementCache_INCLUDED
+#define Data_SQLite_StatementCache_INCLUDED
+
+
+#include "Poco/Data/SQLite/SQLite.h"
+#include "Poco/Mutex.h"
+#include <string>
+#include <list>
+#include <map>
+
+
+extern "C"
+{
+	typedef struct sqlite3 sqlite3;
+	typedef struct sqlite3_stmt sqlite3_stmt;
+}
+
+
+namespace Poco {
+namespace Data {
+namespace SQLite {
+
+
+class SQLite_API StatementCache
+	/// A least recently used cache of prepared SQLite statements,
+	/// keyed by their SQL text.
+	///
+	/// Every SQLite session owns a StatementCache. When a statement
+	/// is compiled, SQLiteStatementImpl first tries to take an already
+	/// prepared statement for the same SQL text out of the cache, and
+	/// only calls sqlite3_prepare_v2() if there is none. When the
+	/// statement is done, the prepared statement is reset, its
+	/// bindings are cleared and it is handed back to the cache instead
+	/// of being finalized. New values are bound on the next use.
+	///
+	/// A statement is owned by exactly one SQLiteStatementImpl while
+	/// it is in use, so the same prepared statement is never shared.
+	///
+	/// The cache is disabled (maximum size zero) by default. It can be
+	/// enabled per session with the "maxStatementCacheSize" property, or for
+	/// all sessions of a SessionPool with SessionPool::setProperty().
+	/// Because pooled sessions are kept open, they also keep their
+	/// caches warm.
+	///
+	/// The cache is cleared whenever a CREATE, DROP or ALTER statement
+	/// is executed through the session. SQLite transparently re-prepares
+	/// a cached statement if the schema has been changed through another
+	/// connection; however, the result columns of a "SELECT *" statement
+	/// are taken from the cached statement in that case.
+{
+public:
+	StatementCache(std::size_t maxSize = 0);
+		/// Creates the StatementCache with the given maximum
+		/// number of cached statements.
+
+	~StatementCache();
+		/// Destroys the StatementCache and finalizes all cached statements.
+
+	void attach(sqlite3* pDB);
+		/// Attaches the cache to the given database connection.
+		/// Only statements prepared on this connection are cached.
+
+	void detach();
+		/// Finalizes all cached statements and detaches the cache
+		/// from its database connection. Must be called before
+		/// the database connection is closed.
+
+	sqlite3_stmt* acquire(const std::string& sql);
+		/// Removes the prepared statement for the given SQL text from
+		/// the cache and returns it, or returns null if no statement
+		/// is cached for the SQL text.
+
+	void release(const std::string& sql, sqlite3_stmt* pStmt);
+		/// Resets the given statement, clears its bindings and adds it
+		/// to the cache.
+		///
+		/// The statement is finalized instead if the cache is disabled,
+		/// not attached to the statement's connection, or already holds
+		/// a statement for the same SQL text. If the cache is full, the
+		/// least recently used statement is finalized.
+
+	void clear();
+		/// Finalizes all cached statements.
+
+	void setMaxSize(std::size_t maxSize);
+		/// Sets the maximum number of cached statements.
+		/// A size of zero disables the cache.
+
+	std::size_t getMaxSize() const;
+		/// Returns the maximum number of cached statements.
+
+	std::size_t size() const;
+		/// Returns the number of cached statements.
+
+	Poco::UInt64 hits() const;
+		/// Returns the number of acquire() calls that returned
+		/// a cached statement.
+
+	Poco::UInt64 misses() const;
+		/// Returns the number of acquire() calls for which no
+		/// statement was cached, while the cache was enabled.
+
+	static bool isSchemaChange(const std::string& sql);
+		/// Returns true if the given SQL text starts with
+		/// CREATE, DROP or ALTER.
+
+private:
+	typedef std::pair<std::string, sqlite3_stmt*> Entry;
+	typedef std::list<Entry>                      EntryList;
+	typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+	StatementCache(const StatementCache&);
+	StatementCache& operator = (const StatementCache&);
+
+	void evict(std::size_t maxSize);
+
+	sqlite3*      _pDB;
+	std::size_t   _maxSize;
+	EntryList     _entries; // most recently used first
+	EntryMap      _index;
+	Poco::UInt64  _hits;
+	Poco::UInt64  _misses;
+	mutable Poco::FastMutex _mutex;
+};
+
+
+//
+// inlines
+//
+inline std::size_t StatementCache::getMaxSize() const
+{
+	return _maxSize;
+}
+
+
+} } } // namespace Poco::Data::SQLite
+
+
+#endif // Data_SQLite_StatementCache_INCLUDED
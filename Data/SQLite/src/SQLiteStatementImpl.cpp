@@ -15,6 +15,7 @@
 
 
 #include "Poco/Data/SQLite/SQLiteStatementImpl.h"
+#include "Poco/Data/SQLite/SessionImpl.h"
 #include "Poco/Data/SQLite/Utility.h"
 #include "Poco/Data/SQLite/SQLiteException.h"
 #include "Poco/String.h"
@@ -35,16 +36,18 @@ namespace SQLite {
 const int SQLiteStatementImpl::POCO_SQLITE_INV_ROW_CNT = -1;
 
 
-SQLiteStatementImpl::SQLiteStatementImpl(Poco::Data::SessionImpl& rSession, sqlite3* pDB):
+SQLiteStatementImpl::SQLiteStatementImpl(Poco::Data::SessionImpl& rSession, sqlite3* pDB, StatementCache* pCache):
 	StatementImpl(rSession),
 	_pDB(pDB),
 	_pStmt(0),
+	_pCache(pCache),
 	_stepCalled(false),
 	_nextResponse(0),
 	_affectedRowCount(POCO_SQLITE_INV_ROW_CNT),
 	_canBind(false),
 	_isExtracted(false),
-	_canCompile(true)
+	_canCompile(true),
+	_implicitTransaction(false)
 {
 	_columns.resize(1);
 }
@@ -79,34 +82,54 @@ void SQLiteStatementImpl::compileImpl()
 		throw InvalidSQLStatementException("Empty statements are illegal");
 
 	int rc = SQLITE_OK;
-	const char* pLeftover = 0;
+	const char* pLeftover = "";
 	bool queryFound = false;
+	bool cacheable = false;
 
-	do
+	if (_pCache && !_pLeftover)
 	{
-		rc = sqlite3_prepare_v2(_pDB, pSql, -1, &pStmt, &pLeftover);
-		if (rc != SQLITE_OK)
+		if (StatementCache::isSchemaChange(statement))
 		{
-			if (pStmt) sqlite3_finalize(pStmt);
-			pStmt = 0;
-			std::string errMsg = sqlite3_errmsg(_pDB);
-			Utility::throwException(rc, errMsg);
+			_pCache->clear();
 		}
-		else if (rc == SQLITE_OK && pStmt)
+		else
 		{
-			queryFound = true;
+			// release the previous statement first, so that
+			// re-executing a statement picks up its own handle
+			clear();
+			pStmt = _pCache->acquire(statement);
+			cacheable = true;
 		}
-		else if (rc == SQLITE_OK && !pStmt) // comment/whitespace ignore
+	}
+
+	if (!pStmt)
+	{
+		do
 		{
-			pSql = pLeftover;
-			if (std::strlen(pSql) == 0)
+			rc = sqlite3_prepare_v2(_pDB, pSql, -1, &pStmt, &pLeftover);
+			if (rc != SQLITE_OK)
+			{
+				if (pStmt) sqlite3_finalize(pStmt);
+				pStmt = 0;
+				std::string errMsg = sqlite3_errmsg(_pDB);
+				Utility::throwException(rc, errMsg);
+			}
+			else if (rc == SQLITE_OK && pStmt)
 			{
-				// empty statement or an conditional statement! like CREATE IF NOT EXISTS
-				// this is valid
 				queryFound = true;
 			}
-		}
-	} while (rc == SQLITE_OK && !pStmt && !queryFound);
+			else if (rc == SQLITE_OK && !pStmt) // comment/whitespace ignore
+			{
+				pSql = pLeftover;
+				if (std::strlen(pSql) == 0)
+				{
+					// empty statement or an conditional statement! like CREATE IF NOT EXISTS
+					// this is valid
+					queryFound = true;
+				}
+			}
+		} while (rc == SQLITE_OK && !pStmt && !queryFound);
+	}
 
 	//Finalization call in clear() invalidates the pointer, so the value is remembered here.
 	//For last statement in a batch (or a single statement), pLeftover == "", so the next call
@@ -115,6 +138,7 @@ void SQLiteStatementImpl::compileImpl()
 	trimInPlace(leftOver);
 	clear();
 	_pStmt = pStmt;
+	if (cacheable && pStmt && leftOver.empty()) _cacheKey = statement;
 	if (!leftOver.empty())
 	{
 		_pLeftover = new std::string(leftOver);
@@ -190,15 +214,24 @@ void SQLiteStatementImpl::bindImpl()
 	if (_bindBegin != bindings().end())
 	{
 		boundRowCount = (*_bindBegin)->numOfRowsHandled();
+		if (boundRowCount > 1) beginImplicitTransaction();
 
 		Bindings::iterator oldBegin = _bindBegin;
-		for (std::size_t pos = 1; _bindBegin != bindEnd && (*_bindBegin)->canBind(); ++_bindBegin)
+		try
 		{
-			if (boundRowCount != (*_bindBegin)->numOfRowsHandled())
-				throw BindingException("Size mismatch in Bindings. All Bindings MUST have the same size");
+			for (std::size_t pos = 1; _bindBegin != bindEnd && (*_bindBegin)->canBind(); ++_bindBegin)
+			{
+				if (boundRowCount != (*_bindBegin)->numOfRowsHandled())
+					throw BindingException("Size mismatch in Bindings. All Bindings MUST have the same size");
 
-			(*_bindBegin)->bind(pos);
-			pos += (*_bindBegin)->numOfColumnsHandled();
+				(*_bindBegin)->bind(pos);
+				pos += (*_bindBegin)->numOfColumnsHandled();
+			}
+		}
+		catch (...)
+		{
+			endImplicitTransaction(false);
+			throw;
 		}
 
 		if ((*oldBegin)->canBind())
@@ -212,14 +245,51 @@ void SQLiteStatementImpl::bindImpl()
 }
 
 
+void SQLiteStatementImpl::beginImplicitTransaction()
+{
+	if (_implicitTransaction || !sqlite3_get_autocommit(_pDB)) return;
+	if (!static_cast<SessionImpl&>(session()).isImplicitTransaction()) return;
+
+	int rc = sqlite3_exec(_pDB, "BEGIN", 0, 0, 0);
+	if (rc != SQLITE_OK) Utility::throwException(rc, std::string(sqlite3_errmsg(_pDB)));
+	_implicitTransaction = true;
+}
+
+
+void SQLiteStatementImpl::endImplicitTransaction(bool commit)
+{
+	if (!_implicitTransaction) return;
+	_implicitTransaction = false;
+
+	if (_pStmt) sqlite3_reset(_pStmt);
+	if (commit)
+	{
+		int rc = sqlite3_exec(_pDB, "COMMIT", 0, 0, 0);
+		if (rc != SQLITE_OK)
+		{
+			std::string errMsg(sqlite3_errmsg(_pDB));
+			sqlite3_exec(_pDB, "ROLLBACK", 0, 0, 0);
+			Utility::throwException(rc, errMsg);
+		}
+	}
+	else sqlite3_exec(_pDB, "ROLLBACK", 0, 0, 0);
+}
+
+
 void SQLiteStatementImpl::clear()
 {
+	endImplicitTransaction(false);
 	_columns[currentDataSet()].clear();
 	_affectedRowCount = POCO_SQLITE_INV_ROW_CNT;
 
 	if (_pStmt)
 	{
-		sqlite3_finalize(_pStmt);
+		if (!_cacheKey.empty())
+		{
+			_pCache->release(_cacheKey, _pStmt);
+			_cacheKey.clear();
+		}
+		else sqlite3_finalize(_pStmt);
 		_pStmt=0;
 	}
 	_pLeftover = 0;
@@ -247,7 +317,14 @@ bool SQLiteStatementImpl::hasNext()
 		_affectedRowCount += sqlite3_changes(_pDB);
 
 	if (_nextResponse != SQLITE_ROW && _nextResponse != SQLITE_OK && _nextResponse != SQLITE_DONE)
+	{
+		endImplicitTransaction(false);
 		Utility::throwException(_nextResponse);
+	}
+	else if (_nextResponse == SQLITE_DONE && !_canBind)
+	{
+		endImplicitTransaction(true);
+	}
 
 	_pExtractor->reset();//clear the cached null indicators
 
@@ -22,7 +22,10 @@
 #include "Poco/ActiveMethod.h"
 #include "Poco/ActiveResult.h"
 #include "Poco/String.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/NumberParser.h"
 #include "Poco/Mutex.h"
+#include "Poco/Ascii.h"
 #include "Poco/Data/DataException.h"
 #if defined(POCO_UNBUNDLED)
 #include <sqlite3.h>
@@ -52,7 +55,8 @@ SessionImpl::SessionImpl(const std::string& fileName, std::size_t loginTimeout):
 	_connector(Connector::KEY),
 	_pDB(0),
 	_connected(false),
-	_isTransaction(false)
+	_isTransaction(false),
+	_implicitTransaction(false)
 {
 	open();
 	setConnectionTimeout(CONNECTION_TIMEOUT_DEFAULT);
@@ -61,6 +65,16 @@ SessionImpl::SessionImpl(const std::string& fileName, std::size_t loginTimeout):
 		&SessionImpl::autoCommit, 
 		&SessionImpl::isAutoCommit);
 	addProperty("connectionTimeout", &SessionImpl::setConnectionTimeout, &SessionImpl::getConnectionTimeout);
+	addProperty("maxStatementCacheSize", &SessionImpl::setMaxStatementCacheSize, &SessionImpl::getMaxStatementCacheSize);
+	addProperty("statementCacheHits", 0, &SessionImpl::getStatementCacheHits);
+	addProperty("statementCacheMisses", 0, &SessionImpl::getStatementCacheMisses);
+	addProperty("journalMode", &SessionImpl::setJournalMode, &SessionImpl::getJournalMode);
+	addProperty("synchronous", &SessionImpl::setSynchronous, &SessionImpl::getSynchronous);
+	addProperty("cacheSize", &SessionImpl::setCacheSize, &SessionImpl::getCacheSize);
+	addProperty("mmapSize", &SessionImpl::setMmapSize, &SessionImpl::getMmapSize);
+	addFeature("implicitTransaction",
+		&SessionImpl::setImplicitTransaction,
+		&SessionImpl::isImplicitTransaction);
 }
 
 
@@ -80,14 +94,14 @@ SessionImpl::~SessionImpl()
 Poco::Data::StatementImpl* SessionImpl::createStatementImpl()
 {
 	poco_check_ptr (_pDB);
-	return new SQLiteStatementImpl(*this, _pDB);
+	return new SQLiteStatementImpl(*this, _pDB, &_statementCache);
 }
 
 
 void SessionImpl::begin()
 {
 	Poco::Mutex::ScopedLock l(_mutex);
-	SQLiteStatementImpl tmp(*this, _pDB);
+	SQLiteStatementImpl tmp(*this, _pDB, &_statementCache);
 	tmp.add(DEFERRED_BEGIN_TRANSACTION);
 	tmp.execute();
 	_isTransaction = true;
@@ -97,7 +111,7 @@ void SessionImpl::begin()
 void SessionImpl::commit()
 {
 	Poco::Mutex::ScopedLock l(_mutex);
-	SQLiteStatementImpl tmp(*this, _pDB);
+	SQLiteStatementImpl tmp(*this, _pDB, &_statementCache);
 	tmp.add(COMMIT_TRANSACTION);
 	tmp.execute();
 	_isTransaction = false;
@@ -107,7 +121,7 @@ void SessionImpl::commit()
 void SessionImpl::rollback()
 {
 	Poco::Mutex::ScopedLock l(_mutex);
-	SQLiteStatementImpl tmp(*this, _pDB);
+	SQLiteStatementImpl tmp(*this, _pDB, &_statementCache);
 	tmp.add(ABORT_TRANSACTION);
 	tmp.execute();
 	_isTransaction = false;
@@ -199,6 +213,7 @@ void SessionImpl::open(const std::string& connect)
 		throw ConnectionFailedException(ex.displayText());
 	}
 
+	_statementCache.attach(_pDB);
 	_connected = true;
 }
 
@@ -207,6 +222,7 @@ void SessionImpl::close()
 {
 	if (_pDB)
 	{
+		_statementCache.detach();
 		sqlite3_close(_pDB);
 		_pDB = 0;
 	}
@@ -242,6 +258,165 @@ Poco::Any SessionImpl::getConnectionTimeout(const std::string& prop)
 }
 
 
+void SessionImpl::setMaxStatementCacheSize(const std::string& prop, const Poco::Any& value)
+{
+	_statementCache.setMaxSize(Poco::RefAnyCast<std::size_t>(value));
+}
+
+
+Poco::Any SessionImpl::getMaxStatementCacheSize(const std::string& prop)
+{
+	return Poco::Any(_statementCache.getMaxSize());
+}
+
+
+Poco::Any SessionImpl::getStatementCacheHits(const std::string& prop)
+{
+	return Poco::Any(_statementCache.hits());
+}
+
+
+Poco::Any SessionImpl::getStatementCacheMisses(const std::string& prop)
+{
+	return Poco::Any(_statementCache.misses());
+}
+
+
+void SessionImpl::setJournalMode(const std::string& prop, const Poco::Any& value)
+{
+	setPragma("journal_mode", Poco::RefAnyCast<std::string>(value));
+}
+
+
+Poco::Any SessionImpl::getJournalMode(const std::string& prop)
+{
+	return Poco::Any(Poco::toUpper(getPragma("journal_mode")));
+}
+
+
+void SessionImpl::setSynchronous(const std::string& prop, const Poco::Any& value)
+{
+	setPragma("synchronous", Poco::RefAnyCast<std::string>(value));
+}
+
+
+Poco::Any SessionImpl::getSynchronous(const std::string& prop)
+{
+	static const char* levels[] = { "OFF", "NORMAL", "FULL", "EXTRA" };
+
+	std::string level = getPragma("synchronous");
+	int n = 0;
+	if (Poco::NumberParser::tryParse(level, n) && n >= 0 && n < 4)
+		return Poco::Any(std::string(levels[n]));
+	return Poco::Any(level);
+}
+
+
+void SessionImpl::setCacheSize(const std::string& prop, const Poco::Any& value)
+{
+	setPragma("cache_size", Poco::NumberFormatter::format(Poco::RefAnyCast<int>(value)));
+}
+
+
+Poco::Any SessionImpl::getCacheSize(const std::string& prop)
+{
+	return Poco::Any(Poco::NumberParser::parse(getPragma("cache_size")));
+}
+
+
+void SessionImpl::setMmapSize(const std::string& prop, const Poco::Any& value)
+{
+	setPragma("mmap_size", Poco::NumberFormatter::format(Poco::RefAnyCast<Poco::Int64>(value)));
+}
+
+
+Poco::Any SessionImpl::getMmapSize(const std::string& prop)
+{
+	return Poco::Any(Poco::NumberParser::parse64(getPragma("mmap_size")));
+}
+
+
+void SessionImpl::setPragma(const std::string& name, const std::string& value)
+{
+	poco_check_ptr (_pDB);
+
+	if (!isPragmaToken(name, false))
+		throw Poco::InvalidArgumentException("Invalid pragma name", name);
+	if (!isPragmaToken(value, true))
+		throw Poco::InvalidArgumentException("Invalid pragma value", value);
+
+	Poco::Mutex::ScopedLock l(_mutex);
+	std::string sql("PRAGMA ");
+	sql.append(name).append("=").append(value);
+	sqlite3_stmt* pStmt = 0;
+	int rc = sqlite3_prepare_v2(_pDB, sql.c_str(), -1, &pStmt, 0);
+	if (rc == SQLITE_OK) rc = sqlite3_step(pStmt);
+	if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+	{
+		std::string errMsg(sqlite3_errmsg(_pDB));
+		sqlite3_finalize(pStmt);
+		Utility::throwException(rc, errMsg);
+	}
+	sqlite3_finalize(pStmt);
+}
+
+
+bool SessionImpl::isPragmaToken(const std::string& token, bool allowNumber)
+{
+	std::string::const_iterator it  = token.begin();
+	std::string::const_iterator end = token.end();
+	if (it == end) return false;
+	if (Poco::Ascii::isAlpha(*it) || *it == '_')
+	{
+		for (++it; it != end; ++it)
+		{
+			if (!Poco::Ascii::isAlphaNumeric(*it) && *it != '_') return false;
+		}
+		return true;
+	}
+	else if (allowNumber)
+	{
+		if (*it == '-' || *it == '+') ++it;
+		if (it == end) return false;
+		for (; it != end; ++it)
+		{
+			if (!Poco::Ascii::isDigit(*it)) return false;
+		}
+		return true;
+	}
+	return false;
+}
+
+
+std::string SessionImpl::getPragma(const std::string& name)
+{
+	poco_check_ptr (_pDB);
+
+	Poco::Mutex::ScopedLock l(_mutex);
+	std::string sql("PRAGMA ");
+	sql.append(name);
+	sqlite3_stmt* pStmt = 0;
+	int rc = sqlite3_prepare_v2(_pDB, sql.c_str(), -1, &pStmt, 0);
+	if (rc == SQLITE_OK) rc = sqlite3_step(pStmt);
+
+	std::string result;
+	if (rc == SQLITE_ROW)
+	{
+		const char* pText = reinterpret_cast<const char*>(sqlite3_column_text(pStmt, 0));
+		if (pText) result = pText;
+	}
+	else if (rc != SQLITE_DONE)
+	{
+		std::string errMsg(sqlite3_errmsg(_pDB));
+		sqlite3_finalize(pStmt);
+		Utility::throwException(rc, errMsg);
+	}
+	sqlite3_finalize(pStmt);
+
+	return result;
+}
+
+
 void SessionImpl::autoCommit(const std::string&, bool)
 {
 	// The problem here is to decide whether to call commit or rollback
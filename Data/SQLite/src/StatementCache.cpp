@@ -0,0 +1,173 @@
+//
+// StatementCache.cpp
+//
+// $Id: //poco/Main/Data/SQLite/src/StatementCache.cpp#1 $
+//
+// Library: SQLite
+// Package: SQLite
+// Module:  StatementCache
+//
+// Copyright (c) 2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Data/SQLite/StatementCache.h"
+#include "Poco/String.h"
+#include "Poco/Ascii.h"
+#if defined(POCO_UNBUNDLED)
+#include <sqlite3.h>
+#else
+#include "sqlite3.h"
+#endif
+
+
+namespace Poco {
+namespace Data {
+namespace SQLite {
+
+
+StatementCache::StatementCache(std::size_t maxSize):
+	_pDB(0),
+	_maxSize(maxSize),
+	_hits(0),
+	_misses(0)
+{
+}
+
+
+StatementCache::~StatementCache()
+{
+	try
+	{
+		clear();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+void StatementCache::attach(sqlite3* pDB)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	evict(0);
+	_pDB = pDB;
+}
+
+
+void StatementCache::detach()
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	evict(0);
+	_pDB = 0;
+}
+
+
+sqlite3_stmt* StatementCache::acquire(const std::string& sql)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	if (_maxSize == 0) return 0;
+
+	EntryMap::iterator it = _index.find(sql);
+	if (it == _index.end())
+	{
+		++_misses;
+		return 0;
+	}
+
+	sqlite3_stmt* pStmt = it->second->second;
+	_entries.erase(it->second);
+	_index.erase(it);
+	++_hits;
+	return pStmt;
+}
+
+
+void StatementCache::release(const std::string& sql, sqlite3_stmt* pStmt)
+{
+	poco_check_ptr (pStmt);
+
+	sqlite3_reset(pStmt);
+	sqlite3_clear_bindings(pStmt);
+
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	if (_maxSize == 0 || !_pDB || sqlite3_db_handle(pStmt) != _pDB || _index.find(sql) != _index.end())
+	{
+		sqlite3_finalize(pStmt);
+		return;
+	}
+
+	evict(_maxSize - 1);
+	_entries.push_front(Entry(sql, pStmt));
+	_index[sql] = _entries.begin();
+}
+
+
+void StatementCache::clear()
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	evict(0);
+}
+
+
+void StatementCache::setMaxSize(std::size_t maxSize)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	_maxSize = maxSize;
+	evict(_maxSize);
+}
+
+
+std::size_t StatementCache::size() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return _index.size();
+}
+
+
+Poco::UInt64 StatementCache::hits() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return _hits;
+}
+
+
+Poco::UInt64 StatementCache::misses() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return _misses;
+}
+
+
+bool StatementCache::isSchemaChange(const std::string& sql)
+{
+	std::string::const_iterator it  = sql.begin();
+	std::string::const_iterator end = sql.end();
+	while (it != end && Poco::Ascii::isSpace(*it)) ++it;
+
+	std::string keyword;
+	while (it != end && Poco::Ascii::isAlpha(*it) && keyword.size() < 6) keyword += *it++;
+
+	return 0 == Poco::icompare(keyword, "CREATE") ||
+		0 == Poco::icompare(keyword, "DROP") ||
+		0 == Poco::icompare(keyword, "ALTER");
+}
+
+
+void StatementCache::evict(std::size_t maxSize)
+{
+	while (_entries.size() > maxSize)
+	{
+		Entry& entry = _entries.back();
+		sqlite3_finalize(entry.second);
+		_index.erase(entry.first);
+		_entries.pop_back();
+	}
+}
+
+
+} } } // namespace Poco::Data::SQLite
@@ -18,6 +18,7 @@
 #include "Poco/Data/LOB.h"
 #include "Poco/Data/Statement.h"
 #include "Poco/Data/RecordSet.h"
+#include "Poco/Data/Batch.h"
 #include "Poco/Data/JSONRowFormatter.h"
 #include "Poco/Data/SQLChannel.h"
 #include "Poco/Data/SessionFactory.h"
@@ -42,6 +43,7 @@
 #include "Poco/Exception.h"
 #include "Poco/RefCountedObject.h"
 #include "Poco/Stopwatch.h"
+#include "Poco/File.h"
 #include "Poco/Delegate.h"
 #include <iostream>
 
@@ -50,11 +52,13 @@ using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
 using Poco::Data::Statement;
 using Poco::Data::RecordSet;
+using Poco::Data::Batch;
 using Poco::Data::JSONRowFormatter;
 using Poco::Data::Column;
 using Poco::Data::Row;
 using Poco::Data::SQLChannel;
 using Poco::Data::LimitException;
+using Poco::Data::DataException;
 using Poco::Data::CLOB;
 using Poco::Data::Date;
 using Poco::Data::Time;
@@ -76,6 +80,7 @@ using Poco::AutoPtr;
 using Poco::Thread;
 using Poco::format;
 using Poco::InvalidAccessException;
+using Poco::InvalidArgumentException;
 using Poco::RangeException;
 using Poco::BadCastException;
 using Poco::NotFoundException;
@@ -3437,6 +3442,350 @@ void SQLiteTest::checkJSON(const std::string& sql, const std::string& json, int
 }
 
 
+void SQLiteTest::testStatementCache()
+{
+	Session tmp(Poco::Data::SQLite::Connector::KEY, "dummy.db");
+	assert (0 == AnyCast<std::size_t>(tmp.getProperty("maxStatementCacheSize")));
+	tmp.setProperty("maxStatementCacheSize", std::size_t(2));
+	assert (2 == AnyCast<std::size_t>(tmp.getProperty("maxStatementCacheSize")));
+
+	tmp << "DROP TABLE IF EXISTS Strings", now;
+	tmp << "CREATE TABLE IF NOT EXISTS Strings (str VARCHAR(30), num INTEGER)", now;
+	assert (0 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheHits")));
+	assert (0 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")));
+
+	for (int i = 0; i < 10; ++i)
+	{
+		std::string str(format("str%d", i));
+		tmp << "INSERT INTO Strings VALUES(?, ?)", use(str), bind(i), now;
+	}
+	assert (9 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheHits")));
+	assert (1 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")));
+
+	int count = 0;
+	tmp << "SELECT COUNT(*) FROM Strings", into(count), now;
+	assert (10 == count);
+
+	std::string str;
+	for (int i = 0; i < 10; ++i)
+	{
+		tmp << "SELECT str FROM Strings WHERE num = ?", use(i), into(str), now;
+		assert (format("str%d", i) == str);
+	}
+	assert (18 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheHits")));
+	assert (3 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")));
+
+	// re-executing an explicit statement reuses its own prepared statement
+	int num = 0;
+	Statement stmt = (tmp << "SELECT str FROM Strings WHERE num = ?", use(num), into(str));
+	for (num = 0; num < 3; ++num)
+	{
+		stmt.execute();
+		assert (format("str%d", num) == str);
+	}
+	assert (21 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheHits")));
+	assert (3 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")));
+
+	// schema changes clear the cache
+	tmp << "DROP TABLE IF EXISTS Strings", now;
+	tmp << "CREATE TABLE IF NOT EXISTS Strings (str VARCHAR(30), num INTEGER, str2 VARCHAR(30))", now;
+	tmp << "INSERT INTO Strings VALUES(?, ?, ?)", bind("abc"), bind(1), bind("def"), now;
+	tmp << "SELECT str2 FROM Strings WHERE num = 1", into(str), now;
+	assert ("def" == str);
+	assert (5 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")));
+
+	try
+	{
+		tmp.setProperty("statementCacheHits", Poco::UInt64(0));
+		fail ("must fail");
+	}
+	catch (NotImplementedException&) { }
+
+	tmp.setProperty("maxStatementCacheSize", std::size_t(0));
+	tmp << "SELECT COUNT(*) FROM Strings", into(count), now;
+	assert (1 == count);
+	assert (5 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")));
+}
+
+
+void SQLiteTest::testBatch()
+{
+	Session tmp(Poco::Data::SQLite::Connector::KEY, "dummy.db");
+	tmp << "DROP TABLE IF EXISTS Person", now;
+	tmp << "CREATE TABLE IF NOT EXISTS Person (LastName VARCHAR(30), FirstName VARCHAR, Address VARCHAR, Age INTEGER(3))", now;
+
+	Batch batch(tmp);
+	assert (0 == batch.size());
+
+	std::vector<std::string> lastNames;
+	std::vector<int> ages;
+	for (int i = 0; i < 10; ++i)
+	{
+		lastNames.push_back(format("LN%d", i));
+		ages.push_back(i);
+	}
+	for (int i = 0; i < 10; ++i)
+	{
+		batch << "INSERT INTO Person VALUES(?, 'FN', 'Springfield', ?)", use(lastNames[i]), use(ages[i]);
+	}
+	batch << "SELECT COUNT(*) FROM Person";
+	batch << "SELECT LastName, Age FROM Person WHERE Age >= 5 ORDER BY Age";
+	assert (12 == batch.size());
+
+	assert (16 == batch.execute());
+	assert (12 == batch.executed());
+
+	RecordSet count = batch.recordSet(10);
+	assert (10 == count.value(0, 0).convert<int>());
+
+	RecordSet rs = batch.recordSet(11);
+	assert (5 == rs.rowCount());
+	assert ("LN5" == rs.value<std::string>(0, 0));
+	assert (9 == rs.value(1, 4).convert<int>());
+
+	try { batch.recordSet(12); fail ("must fail"); }
+	catch (RangeException&) { }
+
+	// the remaining statements are skipped after a failure
+	batch.clear();
+	assert (0 == batch.size());
+	batch << "INSERT INTO Person VALUES('LN10', 'FN', 'Springfield', 10)";
+	batch << "INSERT INTO NoSuchTable VALUES(1)";
+	batch << "INSERT INTO Person VALUES('LN11', 'FN', 'Springfield', 11)";
+	try { batch.execute(); fail ("must fail"); }
+	catch (DataException&) { }
+	assert (1 == batch.executed());
+
+	int n = 0;
+	tmp << "SELECT COUNT(*) FROM Person", into(n), now;
+	assert (11 == n);
+
+	// consecutive writes without bindings are sent as one call
+	batch.clear();
+	batch << "INSERT INTO Person VALUES('LN12', 'FN', 'Springfield', 12)";
+	batch << "UPDATE Person SET Address = 'Shelbyville' WHERE Age = 12";
+	batch << "DELETE FROM Person WHERE Age = 0";
+	batch << "SELECT COUNT(*) FROM Person WHERE Address = 'Shelbyville'";
+	tmp.setProperty("maxStatementCacheSize", std::size_t(16));
+	Poco::UInt64 misses = AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses"));
+	Batch::Result result = batch.executeAsync();
+	result.wait();
+	assert (!result.failed());
+	assert (4 == result.data());
+	assert (4 == batch.executed());
+	assert (2 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")) - misses);
+	assert (1 == batch.recordSet(3).value(0, 0).convert<int>());
+	tmp << "SELECT COUNT(*) FROM Person", into(n), now;
+	assert (11 == n);
+
+	// the exception of an asynchronous execution is kept in the result
+	batch.clear();
+	batch << "INSERT INTO Person VALUES('LN13', 'FN', 'Springfield', 13)";
+	batch << "INSERT INTO NoSuchTable VALUES(1)";
+	result = batch.executeAsync();
+	result.wait();
+	assert (result.failed());
+	assert (1 == batch.executed());
+	tmp << "SELECT COUNT(*) FROM Person", into(n), now;
+	assert (12 == n);
+}
+
+
+void SQLiteTest::testSessionTuning()
+{
+	{
+		Session tmp(Poco::Data::SQLite::Connector::KEY, "tuning.db");
+		tmp.setProperty("journalMode", std::string("WAL"));
+		assert ("WAL" == AnyCast<std::string>(tmp.getProperty("journalMode")));
+		tmp.setProperty("journalMode", std::string("delete"));
+		assert ("DELETE" == AnyCast<std::string>(tmp.getProperty("journalMode")));
+
+		tmp.setProperty("synchronous", std::string("NORMAL"));
+		assert ("NORMAL" == AnyCast<std::string>(tmp.getProperty("synchronous")));
+		tmp.setProperty("synchronous", std::string("OFF"));
+		assert ("OFF" == AnyCast<std::string>(tmp.getProperty("synchronous")));
+
+		tmp.setProperty("cacheSize", -4096);
+		assert (-4096 == AnyCast<int>(tmp.getProperty("cacheSize")));
+		tmp.setProperty("cacheSize", 500);
+		assert (500 == AnyCast<int>(tmp.getProperty("cacheSize")));
+
+		// memory mapping may be disabled or limited at compile time
+		tmp.setProperty("mmapSize", Poco::Int64(1024*1024));
+		Poco::Int64 mmapSize = AnyCast<Poco::Int64>(tmp.getProperty("mmapSize"));
+		assert (mmapSize >= 0 && mmapSize <= 1024*1024);
+
+		// values must be numbers or names, not SQL
+		tmp << "CREATE TABLE IF NOT EXISTS Tuning (num INTEGER)", now;
+		try
+		{
+			tmp.setProperty("synchronous", std::string("OFF; DROP TABLE Tuning"));
+			fail ("must fail");
+		}
+		catch (InvalidArgumentException&) { }
+		try
+		{
+			tmp.setProperty("journalMode", std::string("WAL'"));
+			fail ("must fail");
+		}
+		catch (InvalidArgumentException&) { }
+		int count = 0;
+		tmp << "SELECT COUNT(*) FROM Tuning", into(count), now;
+		assert (0 == count);
+	}
+	Poco::File("tuning.db").remove();
+}
+
+
+void SQLiteTest::testImplicitTransaction()
+{
+	Session tmp(Poco::Data::SQLite::Connector::KEY, "dummy.db");
+	assert (!tmp.getFeature("implicitTransaction"));
+
+	tmp << "DROP TABLE IF EXISTS Ints", now;
+	tmp << "CREATE TABLE IF NOT EXISTS Ints (theInt INTEGER PRIMARY KEY)", now;
+
+	std::vector<int> ints;
+	for (int i = 0; i < 100; ++i) ints.push_back(i);
+
+	tmp.setFeature("implicitTransaction", true);
+	assert (tmp.getFeature("implicitTransaction"));
+	tmp << "INSERT INTO Ints VALUES(?)", use(ints), now;
+	assert (tmp.getFeature("autoCommit"));
+	int count = 0;
+	tmp << "SELECT COUNT(*) FROM Ints", into(count), now;
+	assert (100 == count);
+
+	// a failing row rolls back the whole container
+	std::vector<int> more;
+	for (int i = 100; i < 110; ++i) more.push_back(i);
+	more.push_back(5);
+	try
+	{
+		tmp << "INSERT INTO Ints VALUES(?)", use(more), now;
+		fail ("must fail");
+	}
+	catch (ConstraintViolationException&) { }
+	assert (tmp.getFeature("autoCommit"));
+	tmp << "SELECT COUNT(*) FROM Ints", into(count), now;
+	assert (100 == count);
+
+	// without the implicit transaction, rows before the failing one remain
+	tmp.setFeature("implicitTransaction", false);
+	try
+	{
+		tmp << "INSERT INTO Ints VALUES(?)", use(more), now;
+		fail ("must fail");
+	}
+	catch (ConstraintViolationException&) { }
+	tmp << "SELECT COUNT(*) FROM Ints", into(count), now;
+	assert (110 == count);
+
+	// an explicit transaction takes precedence
+	tmp.setFeature("implicitTransaction", true);
+	std::vector<int> rolledBack;
+	for (int i = 200; i < 210; ++i) rolledBack.push_back(i);
+	tmp.begin();
+	tmp << "INSERT INTO Ints VALUES(?)", use(rolledBack), now;
+	assert (tmp.isTransaction());
+	tmp.rollback();
+	tmp << "SELECT COUNT(*) FROM Ints", into(count), now;
+	assert (110 == count);
+}
+
+
+void SQLiteTest::testInsertBenchmark()
+{
+	const int rows = 500;
+	std::vector<int> ints;
+	std::vector<std::string> strs;
+	for (int i = 0; i < rows; ++i)
+	{
+		ints.push_back(i);
+		strs.push_back(format("row %d", i));
+	}
+
+	static const char* runs[] =
+	{
+		"uncached statement per row",
+		"cached statement per row",
+		"prepared statement",
+		"prepared statement, WAL",
+		"container",
+		"container, WAL, implicit transaction"
+	};
+
+	Poco::Stopwatch sw;
+	for (std::size_t run = 0; run < sizeof(runs)/sizeof(runs[0]); ++run)
+	{
+		Session tmp(Poco::Data::SQLite::Connector::KEY, "bench.db");
+		tmp << "DROP TABLE IF EXISTS Bench", now;
+		tmp << "CREATE TABLE Bench (num INTEGER, str VARCHAR(30))", now;
+
+		switch (run)
+		{
+		case 1:
+			tmp.setProperty("maxStatementCacheSize", std::size_t(8));
+			break;
+		case 3:
+			tmp.setProperty("journalMode", std::string("WAL"));
+			tmp.setProperty("synchronous", std::string("NORMAL"));
+			break;
+		case 5:
+			tmp.setProperty("journalMode", std::string("WAL"));
+			tmp.setProperty("synchronous", std::string("NORMAL"));
+			tmp.setFeature("implicitTransaction", true);
+			break;
+		}
+
+		sw.restart();
+		if (run < 2)
+		{
+			for (int i = 0; i < rows; ++i)
+			{
+				tmp << "INSERT INTO Bench VALUES(?, ?)", use(ints[i]), use(strs[i]), now;
+			}
+		}
+		else if (run < 4)
+		{
+			int num = 0;
+			std::string str;
+			Statement stmt = (tmp << "INSERT INTO Bench VALUES(?, ?)", use(num), use(str));
+			for (int i = 0; i < rows; ++i)
+			{
+				num = ints[i];
+				str = strs[i];
+				stmt.execute();
+			}
+		}
+		else
+		{
+			tmp << "INSERT INTO Bench VALUES(?, ?)", use(ints), use(strs), now;
+		}
+		sw.stop();
+		std::cout << "Inserts: " << runs[run] << ", Time: " << sw.elapsed() / 1000.0 << " [ms]" << std::endl;
+
+		if (run == 0)
+		{
+			assert (0 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheHits")));
+			assert (0 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")));
+		}
+		else if (run == 1)
+		{
+			// the insert is prepared once and taken from the cache afterwards
+			assert (Poco::UInt64(rows - 1) == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheHits")));
+			assert (1 == AnyCast<Poco::UInt64>(tmp.getProperty("statementCacheMisses")));
+		}
+
+		int count = 0;
+		tmp << "SELECT COUNT(*) FROM Bench", into(count), now;
+		assert (rows == count);
+		tmp.setProperty("journalMode", std::string("DELETE"));
+	}
+	Poco::File("bench.db").remove();
+}
+
+
 void SQLiteTest::setUp()
 {
 }
@@ -3538,6 +3887,11 @@ CppUnit::Test* SQLiteTest::suite()
 	CppUnit_addTest(pSuite, SQLiteTest, testTransactor);
 	CppUnit_addTest(pSuite, SQLiteTest, testFTS3);
 	CppUnit_addTest(pSuite, SQLiteTest, testJSONRowFormatter);
+	CppUnit_addTest(pSuite, SQLiteTest, testStatementCache);
+	CppUnit_addTest(pSuite, SQLiteTest, testBatch);
+	CppUnit_addTest(pSuite, SQLiteTest, testSessionTuning);
+	CppUnit_addTest(pSuite, SQLiteTest, testImplicitTransaction);
+	CppUnit_addTest(pSuite, SQLiteTest, testInsertBenchmark);
 
 	return pSuite;
 }
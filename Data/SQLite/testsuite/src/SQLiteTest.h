@@ -136,6 +136,11 @@ public:
 	void testFTS3();
 
 	void testJSONRowFormatter();
+	void testStatementCache();
+	void testBatch();
+	void testSessionTuning();
+	void testImplicitTransaction();
+	void testInsertBenchmark();
 
 	void setUp();
 	void tearDown();
@@ -0,0 +1,191 @@
+//
+// Batch.h
+//
+// $Id: //poco/Main/Data/include/Poco/Data/Batch.h#1 $
+//
+// Library: Data
+// Package: DataCore
+// Module:  Batch
+//
+// Definition of the Batch class.
+//
+// Copyright (c) 2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Data_Batch_INCLUDED
+#define Data_Batch_INCLUDED
+
+
+#include "Poco/Data/Data.h"
+#include "Poco/Data/Session.h"
+#include "Poco/Data/Statement.h"
+#include "Poco/Data/RecordSet.h"
+#include "Poco/ActiveMethod.h"
+#include "Poco/ActiveResult.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Mutex.h"
+#include <deque>
+
+
+namespace Poco {
+namespace Data {
+
+
+class Data_API Batch
+	/// A Batch collects statements for a session and executes them
+	/// in the order they were added, either synchronously with
+	/// execute() or in a background thread with executeAsync().
+	///
+	/// Once the batch has been executed, the data returned by each
+	/// statement is available as a RecordSet:
+	///
+	///     Batch batch(session);
+	///     batch << "INSERT INTO Person VALUES(?, ?)", use(name), use(age);
+	///     batch << "SELECT * FROM Person";
+	///     Batch::Result result = batch.executeAsync();
+	///     ...
+	///     result.wait();
+	///     RecordSet rs = batch.recordSet(1);
+	///
+	/// For SQLite sessions, consecutive INSERT, UPDATE, DELETE and REPLACE
+	/// statements without bindings and extractions are sent to the database
+	/// as a single multi-statement call, enclosed in a savepoint. If that
+	/// call fails, the savepoint is rolled back and the statements are
+	/// executed one by one, so that a failure is reported for the
+	/// statement that caused it. Other connectors execute the statements
+	/// one after another.
+	///
+	/// Statements are executed in their synchronous form. The "now" and
+	/// "async" manipulators must not be used with statements added to a
+	/// batch.
+	///
+	/// If a statement throws, the statements following it are not
+	/// executed and execute() passes the exception on to the caller.
+	/// executed() returns the number of statements that completed
+	/// successfully.
+	///
+	/// The batch keeps its session while it executes, and executions of
+	/// the same batch are serialized. Statements must not be added or
+	/// removed while the batch is executing. The destructor waits for
+	/// a pending asynchronous execution to complete.
+{
+public:
+	typedef ActiveResult<std::size_t> Result;
+
+	explicit Batch(Session& session);
+		/// Creates the Batch for the given session.
+
+	~Batch();
+		/// Destroys the Batch.
+
+	template <typename T>
+	Statement& operator << (const T& t)
+		/// Creates a Statement for the batch's session, using
+		/// the given data as its SQL content, and appends it to
+		/// the batch. Returns a reference to the statement, so
+		/// that bindings and extractions can be added.
+	{
+		_statements.push_back(_session << t);
+		return _statements.back();
+	}
+
+	Statement& add(const Statement& stmt);
+		/// Appends a statement to the batch and returns a reference to it.
+		///
+		/// The statement must have been created for the batch's session.
+
+	std::size_t size() const;
+		/// Returns the number of statements in the batch.
+
+	Statement& operator [] (std::size_t pos);
+		/// Returns the statement at the given position.
+		///
+		/// Throws a RangeException if the position is invalid.
+
+	std::size_t execute();
+		/// Executes all statements of the batch and returns the
+		/// total number of rows returned or affected by them.
+		///
+		/// Stops at the first statement that throws, and
+		/// rethrows its exception.
+
+	Result executeAsync();
+		/// Executes all statements of the batch in a thread from
+		/// the default thread pool and returns the result, which
+		/// yields the total number of rows returned or affected
+		/// by the statements once the execution completes.
+		///
+		/// If a statement throws, the exception is stored
+		/// in the result.
+
+	std::size_t executed() const;
+		/// Returns the number of statements that have been executed
+		/// successfully during the last execution of the batch.
+
+	RecordSet recordSet(std::size_t pos);
+		/// Returns a RecordSet for the data returned by
+		/// the statement at the given position.
+
+	void clear();
+		/// Removes all statements from the batch.
+
+	Session session();
+		/// Returns the session the batch is executed on.
+
+private:
+	typedef std::deque<Statement>                      StatementList;
+	typedef ActiveMethod<std::size_t, void, Batch>     AsyncExecMethod;
+	typedef SharedPtr<Result>                          ResultPtr;
+
+	Batch();
+	Batch(const Batch&);
+	Batch& operator = (const Batch&);
+
+	std::size_t executeCombined(std::size_t begin, std::size_t end);
+		/// Executes the statements in [begin, end) as a single
+		/// multi-statement call inside a savepoint. Falls back to
+		/// executing them one by one if the call fails.
+
+	bool canCombine(const Statement& stmt) const;
+		/// Returns true if the statement can be combined with
+		/// its neighbours into a multi-statement call.
+
+	Session         _session;
+	StatementList   _statements;
+	std::size_t     _executed;
+	bool            _multiStatements;
+	AsyncExecMethod _asyncExec;
+	ResultPtr       _pResult;
+	Mutex           _mutex;
+};
+
+
+//
+// inlines
+//
+inline std::size_t Batch::size() const
+{
+	return _statements.size();
+}
+
+
+inline std::size_t Batch::executed() const
+{
+	return _executed;
+}
+
+
+inline Session Batch::session()
+{
+	return _session;
+}
+
+
+} } // namespace Poco::Data
+
+
+#endif // Data_Batch_INCLUDED
@@ -81,6 +81,8 @@ protected:
 				
 private:	
 	mutable Poco::AutoPtr<PooledSessionHolder> _pHolder;
+
+	friend class SessionPool;
 };
 
 
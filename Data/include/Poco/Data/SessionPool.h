@@ -27,6 +27,9 @@
 #include "Poco/HashMap.h"
 #include "Poco/Any.h"
 #include "Poco/Timer.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Activity.h"
+#include "Poco/Event.h"
 #include "Poco/Mutex.h"
 #include <list>
 
@@ -61,6 +64,20 @@ class Data_API SessionPool: public RefCountedObject
 	///
 	/// Not connected idle sessions can not exist.
 	///
+	/// The pool lock is only held while a session is taken from or
+	/// returned to the idle stack. Opening new sessions, probing an
+	/// idle session with isConnected() before handing it out and closing
+	/// expired sessions all happen outside the lock, so a slow database
+	/// does not make all requesting threads queue up behind each other.
+	///
+	/// Optionally, the pool can keep a number of idle sessions ready
+	/// for handout (see setMinIdle()). A background warmer activity then
+	/// opens new sessions whenever the number of idle sessions drops
+	/// below that limit.
+	///
+	/// The time spent in get() is recorded and can be obtained with
+	/// checkouts(), totalWaitTime(), maxWaitTime() and averageWaitTime().
+	///
 	/// Usage example:
 	///
 	///     SessionPool pool("ODBC", "...");
@@ -103,8 +120,11 @@ public:
 		/// value when the session is reclaimed by the pool.
 	{
 		Session s = get();
-		_addPropertyMap.insert(AddPropertyMap::value_type(s.impl(),
-			std::make_pair(name, s.getProperty(name))));
+		SessionImpl* pImpl = static_cast<PooledSessionImpl*>(s.impl())->impl();
+		{
+			Poco::Mutex::ScopedLock lock(_mutex);
+			_addPropertyMap[pImpl] = std::make_pair(name, s.getProperty(name));
+		}
 		s.setProperty(name, value);
 
 		return s;
@@ -153,6 +173,38 @@ public:
 	Poco::Any getProperty(const std::string& name);
 		/// Returns the requested property.
 
+	void setMinIdle(int minIdle);
+		/// Sets the number of idle sessions the pool tries to keep
+		/// ready for handout, within the pool capacity.
+		///
+		/// If minIdle is greater than zero, a background activity
+		/// opens new sessions whenever the number of idle sessions
+		/// drops below minIdle. Idle sessions are not purged by the
+		/// janitor timer if this would leave fewer than minIdle idle
+		/// sessions in the pool. The default is zero (no pre-warming).
+
+	int getMinIdle() const;
+		/// Returns the number of idle sessions the pool tries to keep
+		/// ready for handout.
+
+	Poco::UInt64 checkouts() const;
+		/// Returns the number of sessions successfully handed out by get().
+
+	Poco::Timestamp::TimeDiff totalWaitTime() const;
+		/// Returns the accumulated time, in microseconds, callers have
+		/// spent in get() for successful checkouts.
+
+	Poco::Timestamp::TimeDiff maxWaitTime() const;
+		/// Returns the longest time, in microseconds, a single
+		/// successful get() call took.
+
+	Poco::Timestamp::TimeDiff averageWaitTime() const;
+		/// Returns the average time, in microseconds, a successful
+		/// get() call took, or zero if no session has been handed out yet.
+
+	void resetStatistics();
+		/// Resets the checkout statistics.
+
 	void shutdown();
 		/// Shuts down the session pool.
 
@@ -171,6 +223,19 @@ protected:
 	void applySettings(SessionImpl* pImpl);
 	void putBack(PooledSessionHolderPtr pHolder);
 	void onJanitorTimer(Poco::Timer&);
+	PooledSessionHolderPtr newSession();
+		/// Opens a new session for a slot already reserved in _nSessions.
+		/// Must be called without holding the pool lock. If opening the
+		/// session fails, the slot is released and the exception rethrown.
+	void releaseSession(PooledSessionHolderPtr pHolder);
+		/// Closes the session and releases its slot.
+		/// Must be called without holding the pool lock.
+	void restoreSettings(SessionImpl* pImpl);
+		/// Reverts the settings applied by get(name, value) and
+		/// re-applies the default pool settings.
+	void warmUp();
+		/// Opens idle sessions until minIdle idle sessions are available.
+	void runWarmer();
 
 private:
 	typedef std::pair<std::string, Poco::Any> PropertyPair; 
@@ -183,11 +248,17 @@ private:
 		
 	void closeAll(SessionList& sessionList);
 
+	enum
+	{
+		WARMER_INTERVAL = 1000 /// Milliseconds between periodic warmer checks.
+	};
+
 	std::string    _connector;
 	std::string    _connectionString;
 	int            _minSessions;
 	int            _maxSessions;
 	int            _idleTime;
+	int            _minIdle;
 	int            _nSessions;
 	SessionList    _idleSessions;
 	SessionList    _activeSessions;
@@ -197,6 +268,11 @@ private:
 	bool           _shutdown;
 	AddPropertyMap _addPropertyMap;
 	AddFeatureMap  _addFeatureMap;
+	Poco::UInt64   _checkouts;
+	Poco::Timestamp::TimeDiff _totalWaitTime;
+	Poco::Timestamp::TimeDiff _maxWaitTime;
+	Poco::Event    _warmEvent;
+	Poco::Activity<SessionPool> _warmer;
 	mutable
 	Poco::Mutex _mutex;
 	
@@ -223,6 +299,12 @@ inline bool SessionPool::isActive() const
 }
 
 
+inline int SessionPool::getMinIdle() const
+{
+	return _minIdle;
+}
+
+
 } } // namespace Poco::Data
 
 
@@ -352,6 +352,9 @@ public:
 		/// Returns the number of extraction storage buffers associated
 		/// with the current data set.
 
+	std::size_t bindingCount() const;
+		/// Returns the number of bindings associated with the statement.
+
 	std::size_t dataSetCount() const;
 		/// Returns the number of data sets associated with the statement.
 
@@ -692,6 +695,12 @@ inline std::size_t Statement::extractionCount() const
 }
 
 
+inline std::size_t Statement::bindingCount() const
+{
+	return _pImpl->bindingCount();
+}
+
+
 inline std::size_t Statement::columnsExtracted(int dataSet) const
 {
 	return _pImpl->columnsExtracted(dataSet);
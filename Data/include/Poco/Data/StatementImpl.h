@@ -154,6 +154,9 @@ public:
 		/// Returns the number of extraction storage buffers associated
 		/// with the statement.
 
+	std::size_t bindingCount() const;
+		/// Returns the number of bindings associated with the statement.
+
 	std::size_t dataSetCount() const;
 		/// Returns the number of data sets associated with the statement.
 		
@@ -526,6 +529,12 @@ inline std::size_t StatementImpl::extractionCount() const
 }
 
 
+inline std::size_t StatementImpl::bindingCount() const
+{
+	return static_cast<std::size_t>(bindings().size());
+}
+
+
 inline std::size_t StatementImpl::dataSetCount() const
 {
 	return static_cast<std::size_t>(_extractors.size());
@@ -0,0 +1,182 @@
+//
+// Batch.cpp
+//
+// $Id: //poco/Main/Data/src/Batch.cpp#1 $
+//
+// Library: Data
+// Package: DataCore
+// Module:  Batch
+//
+// Copyright (c) 2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Data/Batch.h"
+#include "Poco/Data/DataException.h"
+#include "Poco/Exception.h"
+#include "Poco/Ascii.h"
+#include "Poco/String.h"
+
+
+namespace Poco {
+namespace Data {
+
+
+namespace
+{
+	const std::string SAVEPOINT("poco_batch");
+}
+
+
+Batch::Batch(Session& session):
+	_session(session),
+	_executed(0),
+	_multiStatements(session.connector() == "sqlite"),
+	_asyncExec(this, &Batch::execute)
+{
+}
+
+
+Batch::~Batch()
+{
+	try
+	{
+		if (_pResult) _pResult->wait();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+Statement& Batch::add(const Statement& stmt)
+{
+	_statements.push_back(stmt);
+	return _statements.back();
+}
+
+
+Statement& Batch::operator [] (std::size_t pos)
+{
+	if (pos >= _statements.size())
+		throw RangeException("Batch statement position out of range.");
+
+	return _statements[pos];
+}
+
+
+std::size_t Batch::execute()
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	_executed = 0;
+	std::size_t rows = 0;
+	std::size_t pos = 0;
+	std::size_t count = _statements.size();
+	while (pos < count)
+	{
+		std::size_t end = pos;
+		if (_multiStatements)
+		{
+			while (end < count && canCombine(_statements[end])) ++end;
+		}
+		if (end - pos > 1)
+		{
+			rows += executeCombined(pos, end);
+			pos = end;
+		}
+		else
+		{
+			rows += _statements[pos].execute();
+			++_executed;
+			++pos;
+		}
+	}
+	return rows;
+}
+
+
+Batch::Result Batch::executeAsync()
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	_pResult = new Result(_asyncExec());
+	return *_pResult;
+}
+
+
+std::size_t Batch::executeCombined(std::size_t begin, std::size_t end)
+{
+	std::string sql("SAVEPOINT ");
+	sql.append(SAVEPOINT).append(";\n");
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		sql.append(trimRight(_statements[i].toString()));
+		if (sql[sql.size() - 1] != ';') sql += ';';
+		sql += '\n';
+	}
+	sql.append("RELEASE ").append(SAVEPOINT);
+
+	std::size_t rows = 0;
+	try
+	{
+		Statement stmt(_session);
+		stmt << sql;
+		rows = stmt.execute();
+	}
+	catch (DataException&)
+	{
+		_session << "ROLLBACK TO " + SAVEPOINT, Keywords::now;
+		_session << "RELEASE " + SAVEPOINT, Keywords::now;
+
+		rows = 0;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			rows += _statements[i].execute();
+			++_executed;
+		}
+		return rows;
+	}
+	_executed += end - begin;
+	return rows;
+}
+
+
+bool Batch::canCombine(const Statement& stmt) const
+{
+	if (stmt.bindingCount() > 0 || stmt.extractionCount() > 0)
+		return false;
+
+	const std::string& sql = stmt.toString();
+	std::string::const_iterator it  = sql.begin();
+	std::string::const_iterator end = sql.end();
+	while (it != end && Ascii::isSpace(*it)) ++it;
+
+	std::string keyword;
+	while (it != end && Ascii::isAlpha(*it) && keyword.size() < 7) keyword += *it++;
+
+	return 0 == icompare(keyword, "INSERT") ||
+		0 == icompare(keyword, "UPDATE") ||
+		0 == icompare(keyword, "DELETE") ||
+		0 == icompare(keyword, "REPLACE");
+}
+
+
+RecordSet Batch::recordSet(std::size_t pos)
+{
+	return RecordSet((*this)[pos]);
+}
+
+
+void Batch::clear()
+{
+	_statements.clear();
+	_executed = 0;
+}
+
+
+} } // namespace Poco::Data
@@ -30,9 +30,14 @@ SessionPool::SessionPool(const std::string& connector, const std::string& connec
 	_minSessions(minSessions),
 	_maxSessions(maxSessions),
 	_idleTime(idleTime),
+	_minIdle(0),
 	_nSessions(0),
 	_janitorTimer(1000*idleTime, 1000*idleTime/4),
-	_shutdown(false)
+	_shutdown(false),
+	_checkouts(0),
+	_totalWaitTime(0),
+	_maxWaitTime(0),
+	_warmer(this, &SessionPool::runWarmer)
 {
 	Poco::TimerCallback<SessionPool> callback(*this, &SessionPool::onJanitorTimer);
 	_janitorTimer.start(callback);
@@ -55,8 +60,11 @@ SessionPool::~SessionPool()
 Session SessionPool::get(const std::string& name, bool value)
 {
 	Session s = get();
-	_addFeatureMap.insert(AddFeatureMap::value_type(s.impl(),
-		std::make_pair(name, s.getFeature(name))));
+	SessionImpl* pImpl = static_cast<PooledSessionImpl*>(s.impl())->impl();
+	{
+		Poco::Mutex::ScopedLock lock(_mutex);
+		_addFeatureMap[pImpl] = std::make_pair(name, s.getFeature(name));
+	}
 	s.setFeature(name, value);
 
 	return s;
@@ -65,34 +73,92 @@ Session SessionPool::get(const std::string& name, bool value)
 
 Session SessionPool::get()
 {
-	Poco::Mutex::ScopedLock lock(_mutex);
-    if (_shutdown) throw InvalidAccessException("Session pool has been shut down.");
-	
-	purgeDeadSessions();
+	Poco::Timestamp started;
+	PooledSessionHolderPtr pHolder;
+	while (!pHolder)
+	{
+		{
+			Poco::Mutex::ScopedLock lock(_mutex);
+			if (_shutdown) throw InvalidAccessException("Session pool has been shut down.");
+
+			if (!_idleSessions.empty())
+			{
+				pHolder = _idleSessions.front();
+				_idleSessions.pop_front();
+			}
+			else if (_nSessions < _maxSessions)
+			{
+				++_nSessions;
+			}
+			else throw SessionPoolExhaustedException(_connector, _connectionString);
+		}
+
+		if (!pHolder)
+		{
+			pHolder = newSession();
+		}
+		else if (!pHolder->session()->isConnected())
+		{
+			releaseSession(pHolder);
+			pHolder = 0;
+		}
+	}
 
-	if (_idleSessions.empty())
+	bool active = false;
 	{
-		if (_nSessions < _maxSessions)
+		Poco::Mutex::ScopedLock lock(_mutex);
+		if (!_shutdown)
 		{
-			Session newSession(SessionFactory::instance().create(_connector, _connectionString));
-			applySettings(newSession.impl());
+			active = true;
+			_activeSessions.push_front(pHolder);
 
-			PooledSessionHolderPtr pHolder(new PooledSessionHolder(*this, newSession.impl()));
-			_idleSessions.push_front(pHolder);
-			++_nSessions;
+			Poco::Timestamp::TimeDiff waitTime = started.elapsed();
+			++_checkouts;
+			_totalWaitTime += waitTime;
+			if (waitTime > _maxWaitTime) _maxWaitTime = waitTime;
+
+			if (_minIdle > 0) _warmEvent.set();
 		}
-		else throw SessionPoolExhaustedException(_connector, _connectionString);
+	}
+	if (!active)
+	{
+		releaseSession(pHolder);
+		throw InvalidAccessException("Session pool has been shut down.");
 	}
 
-	PooledSessionHolderPtr pHolder(_idleSessions.front());
 	PooledSessionImplPtr pPSI(new PooledSessionImpl(pHolder));
-	
-	_activeSessions.push_front(pHolder);
-	_idleSessions.pop_front();
 	return Session(pPSI);
 }
 
 
+SessionPool::PooledSessionHolderPtr SessionPool::newSession()
+{
+	try
+	{
+		Session newSession(SessionFactory::instance().create(_connector, _connectionString));
+		applySettings(newSession.impl());
+
+		return new PooledSessionHolder(*this, newSession.impl());
+	}
+	catch (...)
+	{
+		Poco::Mutex::ScopedLock lock(_mutex);
+		if (_nSessions > 0) --_nSessions;
+		throw;
+	}
+}
+
+
+void SessionPool::releaseSession(PooledSessionHolderPtr pHolder)
+{
+	try	{ pHolder->session()->close(); }
+	catch (...) { }
+
+	Poco::Mutex::ScopedLock lock(_mutex);
+	if (_nSessions > 0) --_nSessions;
+}
+
+
 void SessionPool::purgeDeadSessions()
 {
 	Poco::Mutex::ScopedLock lock(_mutex);
@@ -221,32 +287,76 @@ void SessionPool::applySettings(SessionImpl* pImpl)
 }
 
 
+void SessionPool::restoreSettings(SessionImpl* pImpl)
+{
+	PropertyPair addProperty;
+	FeaturePair addFeature;
+	bool hasProperty = false;
+	bool hasFeature = false;
+	{
+		Poco::Mutex::ScopedLock lock(_mutex);
+		AddPropertyMap::iterator pIt = _addPropertyMap.find(pImpl);
+		if (pIt != _addPropertyMap.end())
+		{
+			addProperty = pIt->second;
+			hasProperty = true;
+			_addPropertyMap.erase(pIt);
+		}
+
+		AddFeatureMap::iterator fIt = _addFeatureMap.find(pImpl);
+		if (fIt != _addFeatureMap.end())
+		{
+			addFeature = fIt->second;
+			hasFeature = true;
+			_addFeatureMap.erase(fIt);
+		}
+	}
+
+	// reverse settings applied at acquisition time, if any
+	if (hasProperty) pImpl->setProperty(addProperty.first, addProperty.second);
+	if (hasFeature) pImpl->setFeature(addFeature.first, addFeature.second);
+
+	// re-apply the default pool settings
+	applySettings(pImpl);
+}
+
+
 void SessionPool::putBack(PooledSessionHolderPtr pHolder)
 {
+	if (!isActive()) return;
+
+	bool connected = pHolder->session()->isConnected();
+	if (connected)
+	{
+		try
+		{
+			restoreSettings(pHolder->session());
+		}
+		catch (...)
+		{
+			// a session we cannot reset is of no use to the next user
+			try	{ pHolder->session()->close(); }
+			catch (...) { }
+			connected = false;
+		}
+	}
+
 	Poco::Mutex::ScopedLock lock(_mutex);
 	if (_shutdown) return;
 
 	SessionList::iterator it = std::find(_activeSessions.begin(), _activeSessions.end(), pHolder);
 	if (it != _activeSessions.end())
 	{
-		if (pHolder->session()->isConnected())
+		if (connected)
 		{
-			// reverse settings applied at acquisition time, if any
-			AddPropertyMap::iterator pIt = _addPropertyMap.find(pHolder->session());
-			if (pIt != _addPropertyMap.end())
-				pHolder->session()->setProperty(pIt->second.first, pIt->second.second);
-
-			AddFeatureMap::iterator fIt = _addFeatureMap.find(pHolder->session());
-			if (fIt != _addFeatureMap.end())
-				pHolder->session()->setFeature(fIt->second.first, fIt->second.second);
-
-			// re-apply the default pool settings
-			applySettings(pHolder->session());
-
 			pHolder->access();
 			_idleSessions.push_front(pHolder);
 		}
-		else --_nSessions;
+		else
+		{
+			--_nSessions;
+			if (_minIdle > 0) _warmEvent.set();
+		}
 
 		_activeSessions.erase(it);
 	}
@@ -259,30 +369,155 @@ void SessionPool::putBack(PooledSessionHolderPtr pHolder)
 
 void SessionPool::onJanitorTimer(Poco::Timer&)
 {
-	Poco::Mutex::ScopedLock lock(_mutex);
-	if (_shutdown) return;
+	SessionList expired;
+	{
+		Poco::Mutex::ScopedLock lock(_mutex);
+		if (_shutdown) return;
+
+		SessionList::iterator it = _idleSessions.begin(); 
+		while (_nSessions > _minSessions && it != _idleSessions.end())
+		{
+			bool connected = (*it)->session()->isConnected();
+			if (!connected || ((*it)->idle() > _idleTime && (int) _idleSessions.size() > _minIdle))
+			{
+				expired.push_back(*it);
+				it = _idleSessions.erase(it);
+				--_nSessions;
+			}
+			else ++it;
+		}
+	}
 
-	SessionList::iterator it = _idleSessions.begin(); 
-	while (_nSessions > _minSessions && it != _idleSessions.end())
+	// closing may involve a round trip to the server, so do it outside the lock
+	for (SessionList::iterator it = expired.begin(); it != expired.end(); ++it)
 	{
-		if ((*it)->idle() > _idleTime || !(*it)->session()->isConnected())
-		{	
-			try	{ (*it)->session()->close(); }
-			catch (...) { }
-			it = _idleSessions.erase(it);
-			--_nSessions;
+		try	{ (*it)->session()->close(); }
+		catch (...) { }
+	}
+}
+
+
+void SessionPool::setMinIdle(int minIdle)
+{
+	poco_assert (minIdle >= 0);
+
+	{
+		Poco::Mutex::ScopedLock lock(_mutex);
+		if (_shutdown) throw InvalidAccessException("Session pool has been shut down.");
+
+		_minIdle = minIdle > _maxSessions ? _maxSessions : minIdle;
+	}
+	if (minIdle > 0)
+	{
+		_warmer.start();
+		_warmEvent.set();
+	}
+}
+
+
+void SessionPool::warmUp()
+{
+	for (;;)
+	{
+		{
+			Poco::Mutex::ScopedLock lock(_mutex);
+			if (_shutdown || (int) _idleSessions.size() >= _minIdle || _nSessions >= _maxSessions)
+				return;
+			++_nSessions;
+		}
+
+		PooledSessionHolderPtr pHolder;
+		try
+		{
+			pHolder = newSession();
+		}
+		catch (...)
+		{
+			// the database is not reachable right now, try again later
+			return;
+		}
+
+		bool idle = false;
+		{
+			Poco::Mutex::ScopedLock lock(_mutex);
+			if (!_shutdown)
+			{
+				idle = true;
+				pHolder->access();
+				_idleSessions.push_back(pHolder);
+			}
+		}
+		if (!idle)
+		{
+			// the pool has been shut down meanwhile
+			releaseSession(pHolder);
+			return;
 		}
-		else ++it;
 	}
 }
 
 
-void SessionPool::shutdown()
+void SessionPool::runWarmer()
+{
+	while (!_warmer.isStopped())
+	{
+		_warmEvent.tryWait(WARMER_INTERVAL);
+		if (_warmer.isStopped()) break;
+		warmUp();
+	}
+}
+
+
+Poco::UInt64 SessionPool::checkouts() const
 {
 	Poco::Mutex::ScopedLock lock(_mutex);
-	if (_shutdown) return;
-	_shutdown = true;
+	return _checkouts;
+}
+
+
+Poco::Timestamp::TimeDiff SessionPool::totalWaitTime() const
+{
+	Poco::Mutex::ScopedLock lock(_mutex);
+	return _totalWaitTime;
+}
+
+
+Poco::Timestamp::TimeDiff SessionPool::maxWaitTime() const
+{
+	Poco::Mutex::ScopedLock lock(_mutex);
+	return _maxWaitTime;
+}
+
+
+Poco::Timestamp::TimeDiff SessionPool::averageWaitTime() const
+{
+	Poco::Mutex::ScopedLock lock(_mutex);
+	return _checkouts ? _totalWaitTime/static_cast<Poco::Timestamp::TimeDiff>(_checkouts) : 0;
+}
+
+
+void SessionPool::resetStatistics()
+{
+	Poco::Mutex::ScopedLock lock(_mutex);
+	_checkouts = 0;
+	_totalWaitTime = 0;
+	_maxWaitTime = 0;
+}
+
+
+void SessionPool::shutdown()
+{
+	{
+		Poco::Mutex::ScopedLock lock(_mutex);
+		if (_shutdown) return;
+		_shutdown = true;
+	}
+	_warmer.stop();
+	_warmEvent.set();
+	_warmer.wait();
 	_janitorTimer.stop();
+
+	Poco::Mutex::ScopedLock lock(_mutex);
 	closeAll(_idleSessions);
 	closeAll(_activeSessions);
 }
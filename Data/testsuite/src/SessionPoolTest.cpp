@@ -253,6 +253,90 @@ void SessionPoolTest::testSessionPoolContainer()
 }
 
 
+void SessionPoolTest::testSessionPoolMinIdle()
+{
+	SessionPool pool("test", "cs", 1, 4, 2);
+	assert (pool.getMinIdle() == 0);
+	assert (pool.allocated() == 0);
+
+	pool.setMinIdle(2);
+	assert (pool.getMinIdle() == 2);
+	for (int i = 0; i < 50 && pool.idle() < 2; ++i) Thread::sleep(100);
+	assert (pool.idle() == 2);
+	assert (pool.allocated() == 2);
+
+	Session s1(pool.get());
+	Session s2(pool.get());
+	for (int i = 0; i < 50 && pool.idle() < 2; ++i) Thread::sleep(100);
+	assert (pool.used() == 2);
+	assert (pool.idle() == 2);
+	assert (pool.allocated() == 4);
+
+	// capacity is exhausted, the warmer must not open more sessions
+	Session s3(pool.get());
+	Thread::sleep(200);
+	assert (pool.used() == 3);
+	assert (pool.idle() == 1);
+	assert (pool.allocated() == 4);
+
+	// a dead session is dropped and replaced by the warmer
+	s3.setFeature("connected", false);
+	s3.close();
+	for (int i = 0; i < 50 && pool.idle() < 2; ++i) Thread::sleep(100);
+	assert (pool.used() == 2);
+	assert (pool.idle() == 2);
+	assert (pool.allocated() == 4);
+	
+	s1.close();
+	s2.close();
+	assert (pool.idle() == 4);
+	// the janitor closes idle sessions, but must keep minIdle sessions
+	for (int i = 0; i < 100 && pool.idle() > 2; ++i) Thread::sleep(100);
+	assert (pool.idle() == 2);
+	assert (pool.allocated() == 2);
+
+	pool.shutdown();
+	assert (pool.allocated() == 0);
+	try { pool.setMinIdle(1); fail ("must fail"); }
+	catch (InvalidAccessException&) { }
+}
+
+
+void SessionPoolTest::testSessionPoolStatistics()
+{
+	SessionPool pool("test", "cs", 1, 4, 2);
+	assert (pool.checkouts() == 0);
+	assert (pool.totalWaitTime() == 0);
+	assert (pool.maxWaitTime() == 0);
+	assert (pool.averageWaitTime() == 0);
+
+	{
+		Session s1(pool.get());
+		Session s2(pool.get());
+	}
+	Session s3(pool.get());
+	assert (pool.checkouts() == 3);
+	assert (pool.maxWaitTime() <= pool.totalWaitTime());
+	assert (pool.averageWaitTime() <= pool.maxWaitTime());
+
+	Session s4(pool.get());
+	Session s5(pool.get());
+	Session s6(pool.get());
+	try
+	{
+		Session s7(pool.get());
+		fail("pool exhausted - must throw");
+	}
+	catch (SessionPoolExhaustedException&) { }
+	assert (pool.checkouts() == 6);
+
+	pool.resetStatistics();
+	assert (pool.checkouts() == 0);
+	assert (pool.totalWaitTime() == 0);
+	assert (pool.maxWaitTime() == 0);
+}
+
+
 void SessionPoolTest::setUp()
 {
 }
@@ -269,6 +353,8 @@ CppUnit::Test* SessionPoolTest::suite()
 
 	CppUnit_addTest(pSuite, SessionPoolTest, testSessionPool);
 	CppUnit_addTest(pSuite, SessionPoolTest, testSessionPoolContainer);
+	CppUnit_addTest(pSuite, SessionPoolTest, testSessionPoolMinIdle);
+	CppUnit_addTest(pSuite, SessionPoolTest, testSessionPoolStatistics);
 
 	return pSuite;
 }
@@ -28,6 +28,8 @@ public:
 
 	void testSessionPool();
 	void testSessionPoolContainer();
+	void testSessionPoolMinIdle();
+	void testSessionPoolStatistics();
 
 	void setUp();
 	void tearDown();
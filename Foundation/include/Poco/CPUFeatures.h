@@ -0,0 +1,71 @@
+//
+// CPUFeatures.h
+//
+// $Id$
+//
+// Library: Foundation
+// Package: Core
+// Module:  CPUFeatures
+//
+// Runtime detection of x86 instruction set extensions.
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Foundation_CPUFeatures_INCLUDED
+#define Foundation_CPUFeatures_INCLUDED
+
+
+#include "Poco/Foundation.h"
+
+
+namespace Poco {
+namespace CPUFeatures {
+	/// Detects the x86 instruction set extensions used by
+	/// Checksum, SHA1Engine and SHA2Engine. On other platforms,
+	/// no feature is supported.
+
+
+enum Feature
+{
+	FEATURE_SSE42  = 0x01, /// The SSE4.2 CRC32 instruction.
+	FEATURE_PCLMUL = 0x02, /// Carry-less multiplication.
+	FEATURE_SHA    = 0x04, /// The SHA-1 and SHA-256 extensions.
+	FEATURE_AVX2   = 0x08  /// AVX2, supported by the CPU and the operating system.
+};
+
+
+bool Foundation_API hasSSE42();
+	/// Returns true if the CPU supports the SSE4.2 CRC32 instruction.
+
+bool Foundation_API hasPCLMUL();
+	/// Returns true if the CPU supports carry-less multiplication.
+
+bool Foundation_API hasSHA();
+	/// Returns true if the CPU supports the SHA-1 and SHA-256 extensions.
+
+bool Foundation_API hasAVX2();
+	/// Returns true if the CPU and the operating system support AVX2.
+
+void Foundation_API disable(int features);
+	/// Disables the given features, a combination of Feature values,
+	/// so that they are reported as not supported and the code paths
+	/// not using them are taken. disable(0) enables all features
+	/// supported by the CPU again.
+	///
+	/// This is meant for testing all code paths on a single machine,
+	/// and must not be called while other threads compute checksums
+	/// or hashes.
+
+int Foundation_API disabled();
+	/// Returns the features disabled with disable().
+
+
+} } // namespace Poco::CPUFeatures
+
+
+#endif // Foundation_CPUFeatures_INCLUDED
@@ -27,13 +27,20 @@ namespace Poco {
 
 
 class Foundation_API Checksum
-	/// This class calculates CRC-32 or Adler-32 checksums
+	/// This class calculates CRC-32, CRC-32C or Adler-32 checksums
 	/// for arbitrary data.
 	///
 	/// A cyclic redundancy check (CRC) is a type of hash function, which is used to produce a 
 	/// small, fixed-size checksum of a larger block of data, such as a packet of network 
 	/// traffic or a computer file. CRC-32 is one of the most commonly used CRC algorithms.
 	///
+	/// CRC-32C uses the Castagnoli polynomial, which has better error detection
+	/// properties than CRC-32 and is used by iSCSI, SCTP, ext4 and others.
+	///
+	/// On x86 CPUs, CRC-32C is computed with the SSE4.2 CRC32 instruction, and
+	/// CRC-32 of larger buffers with carry-less multiplication (PCLMULQDQ),
+	/// if supported by the CPU.
+	///
 	/// Adler-32 is a checksum algorithm which was invented by Mark Adler. 
 	/// It is almost as reliable as a 32-bit cyclic redundancy check for protecting against 
 	/// accidental modification of data, such as distortions occurring during a transmission, 
@@ -44,7 +51,8 @@ public:
 	enum Type
 	{
 		TYPE_ADLER32 = 0,
-		TYPE_CRC32
+		TYPE_CRC32,
+		TYPE_CRC32C
 	};
 
 	Checksum();
@@ -229,7 +229,7 @@ private:
 	bool isEqual(const std::string& s1, const std::string& s2) const
 	{
 		if (!CaseSensitive)
-			return Poco::icompare(s1, s2) == 0;
+			return s1.size() == s2.size() && Poco::icompare(s1, s2) == 0;
 		else
 			return s1 == s2;
 	}
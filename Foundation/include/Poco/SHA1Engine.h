@@ -36,6 +36,9 @@ namespace Poco {
 class Foundation_API SHA1Engine: public DigestEngine
 	/// This class implementes the SHA-1 message digest algorithm.
 	/// (FIPS 180-1, see http://www.itl.nist.gov/fipspubs/fip180-1.htm)
+	///
+	/// On x86 CPUs supporting the SHA extensions, these are
+	/// used instead of the portable implementation.
 {
 public:
 	enum
@@ -56,6 +59,7 @@ protected:
 
 private:
 	void transform();
+	void transformBlocks(const UInt8* data, std::size_t blocks);
 	static void byteReverse(UInt32* buffer, int byteCount);
 
 	typedef UInt8 BYTE;
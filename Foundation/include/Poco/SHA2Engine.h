@@ -0,0 +1,125 @@
+//
+// SHA2Engine.h
+//
+// $Id$
+//
+// Library: Foundation
+// Package: Crypt
+// Module:  SHA2Engine
+//
+// Definition of class SHA2Engine.
+//
+// Secure Hash Standard SHA-2 algorithms
+// (FIPS 180-4, see http://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.180-4.pdf)
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Foundation_SHA2Engine_INCLUDED
+#define Foundation_SHA2Engine_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include "Poco/DigestEngine.h"
+
+
+namespace Poco {
+
+
+class Foundation_API SHA2Engine: public DigestEngine
+	/// This class implements the SHA-224, SHA-256, SHA-384 and
+	/// SHA-512 message digest algorithms.
+	/// (FIPS 180-4, see http://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.180-4.pdf)
+	///
+	/// On x86 CPUs supporting the SHA extensions, these are used
+	/// for SHA-224 and SHA-256 instead of the portable implementation.
+{
+public:
+	enum ALGORITHM
+	{
+		SHA_224 = 224,
+		SHA_256 = 256,
+		SHA_384 = 384,
+		SHA_512 = 512
+	};
+
+	enum
+	{
+		MAX_BLOCK_SIZE  = 128,
+		MAX_DIGEST_SIZE = 64
+	};
+
+	SHA2Engine(ALGORITHM algorithm = SHA_256);
+	~SHA2Engine();
+
+	ALGORITHM algorithm() const;
+		/// Returns the algorithm of the SHA2Engine.
+
+	std::size_t blockSize() const;
+		/// Returns the block size of the algorithm, which is
+		/// 64 for SHA-224 and SHA-256, and 128 for SHA-384 and SHA-512.
+
+	std::size_t digestLength() const;
+	void reset();
+	const DigestEngine::Digest& digest();
+
+	static void digestMany(std::size_t count, const void* const* data, const std::size_t* lengths, Digest* digests, ALGORITHM algorithm = SHA_256);
+		/// Computes the digests of count independent messages. The
+		/// message with index i has the given data and lengths[i] bytes,
+		/// and its digest is stored in digests[i].
+		///
+		/// For SHA-224 and SHA-256 on x86 CPUs with AVX2, but without
+		/// the SHA extensions, eight messages are hashed at the same
+		/// time, one in each 32-bit lane of the vector registers. This
+		/// is considerably faster than hashing many small messages
+		/// one after the other. Otherwise, the messages are hashed
+		/// one after the other, without creating a new SHA2Engine for
+		/// every message.
+
+protected:
+	void updateImpl(const void* data, std::size_t length);
+
+private:
+	void transformBlocks(const UInt8* data, std::size_t blocks);
+
+	struct Context
+	{
+		UInt32 state32[8];
+		UInt64 state64[8];
+		UInt8  buffer[MAX_BLOCK_SIZE];
+		std::size_t bufferLength;
+		UInt64 totalLength;
+	};
+
+	ALGORITHM _algorithm;
+	Context _context;
+	DigestEngine::Digest _digest;
+
+	SHA2Engine(const SHA2Engine&);
+	SHA2Engine& operator = (const SHA2Engine&);
+};
+
+
+//
+// inlines
+//
+inline SHA2Engine::ALGORITHM SHA2Engine::algorithm() const
+{
+	return _algorithm;
+}
+
+
+inline std::size_t SHA2Engine::blockSize() const
+{
+	return _algorithm <= SHA_256 ? 64 : 128;
+}
+
+
+} // namespace Poco
+
+
+#endif // Foundation_SHA2Engine_INCLUDED
@@ -0,0 +1,341 @@
+//
+// URIView.h
+//
+// $Id$
+//
+// Library: Foundation
+// Package: URI
+// Module:  URIView
+//
+// Definition of the URIView class.
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Foundation_URIView_INCLUDED
+#define Foundation_URIView_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include <cstring>
+
+
+namespace Poco {
+
+
+class Foundation_API URIView
+	/// A URIView splits a URI, or the request target of a HTTP
+	/// request, into its parts without copying them. Its parts
+	/// refer to the characters of the parsed string, which must
+	/// remain valid and unchanged while the URIView is used.
+	///
+	/// The parts are returned as they appear in the URI, still
+	/// percent-encoded. Unlike URI, URIView neither decodes nor
+	/// normalizes them. They can be decoded with decode(), which
+	/// can reuse a buffer supplied by the caller. The parameters
+	/// of the query can be iterated with a QueryIterator, without
+	/// building a container for them:
+	///
+	///     URIView view(request.getURI());
+	///     URIView::QueryIterator it(view.query());
+	///     std::string name;
+	///     std::string value;
+	///     while (it.next())
+	///     {
+	///         it.decodeName(name);
+	///         it.decodeValue(value);
+	///         ...
+	///     }
+{
+public:
+	class Foundation_API Range
+		/// A range of characters within a parsed URI.
+	{
+	public:
+		Range();
+			/// Creates an empty Range.
+
+		Range(const char* begin, const char* end);
+			/// Creates a Range for the given characters.
+
+		const char* begin() const;
+			/// Returns a pointer to the first character.
+
+		const char* end() const;
+			/// Returns a pointer behind the last character.
+
+		std::size_t size() const;
+			/// Returns the number of characters.
+
+		bool empty() const;
+			/// Returns true iff the range is empty.
+
+		std::string toString() const;
+			/// Returns a copy of the characters.
+
+		bool operator == (const std::string& str) const;
+		bool operator != (const std::string& str) const;
+
+	private:
+		const char* _begin;
+		const char* _end;
+	};
+
+	class Foundation_API QueryIterator
+		/// Iterates over the parameters of a query string in
+		/// the form name1=value1&name2=value2, where plus signs
+		/// stand for spaces.
+	{
+	public:
+		explicit QueryIterator(const Range& query);
+			/// Creates a QueryIterator for the given query string.
+			/// next() must be called to move to the first parameter.
+
+		bool next();
+			/// Moves to the next parameter. Returns false if
+			/// there are no more parameters.
+
+		const Range& name() const;
+			/// Returns the encoded name of the current parameter.
+
+		const Range& value() const;
+			/// Returns the encoded value of the current parameter.
+
+		void decodeName(std::string& name) const;
+			/// Decodes the name of the current parameter into
+			/// the given string, replacing its content.
+
+		void decodeValue(std::string& value) const;
+			/// Decodes the value of the current parameter into
+			/// the given string, replacing its content.
+
+	private:
+		const char* _it;
+		const char* _end;
+		Range       _name;
+		Range       _value;
+	};
+
+	URIView();
+		/// Creates an empty URIView.
+
+	explicit URIView(const std::string& uri);
+		/// Parses the given URI, which must remain valid and
+		/// unchanged while the URIView is used.
+		///
+		/// Throws a SyntaxException if the URI is not valid.
+
+	URIView(const char* begin, const char* end);
+		/// Parses the URI given by the characters from begin to end,
+		/// which must remain valid and unchanged while the URIView
+		/// is used.
+		///
+		/// Throws a SyntaxException if the URI is not valid.
+
+	~URIView();
+		/// Destroys the URIView.
+
+	void parse(const std::string& uri);
+		/// Parses the given URI, replacing the
+		/// previous one.
+
+	void parse(const char* begin, const char* end);
+		/// Parses the URI given by the characters from
+		/// begin to end, replacing the previous one.
+
+	void clear();
+		/// Clears the URIView.
+
+	const Range& scheme() const;
+		/// Returns the scheme, as given in the URI.
+
+	const Range& userInfo() const;
+		/// Returns the encoded user information.
+
+	const Range& host() const;
+		/// Returns the host, as given in the URI. An
+		/// IPv6 address is returned without brackets.
+
+	unsigned short getPort() const;
+		/// Returns the port number given in the URI,
+		/// or 0 if the URI does not specify one.
+
+	const Range& path() const;
+		/// Returns the encoded path.
+
+	const Range& query() const;
+		/// Returns the encoded query.
+
+	const Range& fragment() const;
+		/// Returns the encoded fragment.
+
+	bool getQueryParameter(const std::string& name, std::string& value) const;
+		/// Looks for the first query parameter with the given
+		/// name and decodes its value into value. Returns false
+		/// if there is no such parameter.
+
+	static std::size_t decode(const char* begin, const char* end, char* buffer, bool plusAsSpace = false);
+		/// Decodes the percent-encoded characters from begin to end
+		/// into the given buffer, which must have room for end - begin
+		/// characters. As the decoded string is never longer than the
+		/// encoded one, buffer may be begin, to decode in place.
+		/// If plusAsSpace is true, plus signs are decoded as spaces.
+		///
+		/// Returns the length of the decoded string.
+		///
+		/// Throws a SyntaxException if a percent sign is not
+		/// followed by two hex digits.
+
+	static void decode(const Range& range, std::string& decoded, bool plusAsSpace = false);
+		/// Decodes the given range into decoded, replacing its
+		/// content. The string's capacity is reused, so that a
+		/// string used for decoding repeatedly has to grow
+		/// only rarely.
+
+private:
+	void parseAuthority(const char*& it, const char* end);
+	void parsePathEtc(const char* it, const char* end);
+
+	Range          _scheme;
+	Range          _userInfo;
+	Range          _host;
+	unsigned short _port;
+	Range          _path;
+	Range          _query;
+	Range          _fragment;
+};
+
+
+//
+// inlines
+//
+inline URIView::Range::Range():
+	_begin(0),
+	_end(0)
+{
+}
+
+
+inline URIView::Range::Range(const char* begin, const char* end):
+	_begin(begin),
+	_end(end)
+{
+}
+
+
+inline const char* URIView::Range::begin() const
+{
+	return _begin;
+}
+
+
+inline const char* URIView::Range::end() const
+{
+	return _end;
+}
+
+
+inline std::size_t URIView::Range::size() const
+{
+	return static_cast<std::size_t>(_end - _begin);
+}
+
+
+inline bool URIView::Range::empty() const
+{
+	return _begin == _end;
+}
+
+
+inline std::string URIView::Range::toString() const
+{
+	return std::string(_begin, _end);
+}
+
+
+inline bool URIView::Range::operator == (const std::string& str) const
+{
+	return str.size() == size() && (str.empty() || std::memcmp(str.data(), _begin, str.size()) == 0);
+}
+
+
+inline bool URIView::Range::operator != (const std::string& str) const
+{
+	return !(*this == str);
+}
+
+
+inline const URIView::Range& URIView::QueryIterator::name() const
+{
+	return _name;
+}
+
+
+inline const URIView::Range& URIView::QueryIterator::value() const
+{
+	return _value;
+}
+
+
+inline void URIView::QueryIterator::decodeName(std::string& name) const
+{
+	URIView::decode(_name, name, true);
+}
+
+
+inline void URIView::QueryIterator::decodeValue(std::string& value) const
+{
+	URIView::decode(_value, value, true);
+}
+
+
+inline const URIView::Range& URIView::scheme() const
+{
+	return _scheme;
+}
+
+
+inline const URIView::Range& URIView::userInfo() const
+{
+	return _userInfo;
+}
+
+
+inline const URIView::Range& URIView::host() const
+{
+	return _host;
+}
+
+
+inline unsigned short URIView::getPort() const
+{
+	return _port;
+}
+
+
+inline const URIView::Range& URIView::path() const
+{
+	return _path;
+}
+
+
+inline const URIView::Range& URIView::query() const
+{
+	return _query;
+}
+
+
+inline const URIView::Range& URIView::fragment() const
+{
+	return _fragment;
+}
+
+
+} // namespace Poco
+
+
+#endif // Foundation_URIView_INCLUDED
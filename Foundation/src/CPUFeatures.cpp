@@ -0,0 +1,131 @@
+//
+// CPUFeatures.cpp
+//
+// $Id$
+//
+// Library: Foundation
+// Package: Core
+// Module:  CPUFeatures
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/CPUFeatures.h"
+#include "X86Intrinsics.h"
+
+
+namespace Poco {
+namespace CPUFeatures {
+
+
+namespace
+{
+	int disabledFeatures = 0;
+
+#if defined(POCO_HAVE_X86_INTRINSICS)
+
+	void cpuid(unsigned leaf, unsigned regs[4])
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuidex(info, static_cast<int>(leaf), 0);
+		for (int i = 0; i < 4; i++) regs[i] = static_cast<unsigned>(info[i]);
+#else
+		__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	UInt64 xgetbv()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned eax, edx;
+		__asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+		return (static_cast<UInt64>(edx) << 32) | eax;
+#endif
+	}
+
+	int detect()
+	{
+		int features = 0;
+		unsigned regs[4] = { 0, 0, 0, 0 };
+		cpuid(0, regs);
+		unsigned maxLeaf = regs[0];
+		if (maxLeaf < 1) return features;
+
+		cpuid(1, regs);
+		bool ssse3 = (regs[2] & (1u << 9)) != 0;
+		bool sse41 = (regs[2] & (1u << 19)) != 0;
+		if ((regs[2] & (1u << 20)) != 0) features |= FEATURE_SSE42;
+		if ((regs[2] & (1u << 1)) != 0 && sse41) features |= FEATURE_PCLMUL;
+		bool osxsave = (regs[2] & (1u << 27)) != 0;
+		bool avx = (regs[2] & (1u << 28)) != 0;
+		if (maxLeaf < 7) return features;
+
+		// AVX registers must be saved by the operating system
+		bool avxEnabled = avx && osxsave && (xgetbv() & 0x6) == 0x6;
+		cpuid(7, regs);
+		if ((regs[1] & (1u << 29)) != 0 && ssse3 && sse41) features |= FEATURE_SHA;
+		if ((regs[1] & (1u << 5)) != 0 && avxEnabled) features |= FEATURE_AVX2;
+		return features;
+	}
+
+#else
+
+	int detect()
+	{
+		return 0;
+	}
+
+#endif // POCO_HAVE_X86_INTRINSICS
+
+	inline bool supported(Feature feature)
+	{
+		static const int features = detect();
+		return (features & feature) != 0 && (disabledFeatures & feature) == 0;
+	}
+}
+
+
+bool hasSSE42()
+{
+	return supported(FEATURE_SSE42);
+}
+
+
+bool hasPCLMUL()
+{
+	return supported(FEATURE_PCLMUL);
+}
+
+
+bool hasSHA()
+{
+	return supported(FEATURE_SHA);
+}
+
+
+bool hasAVX2()
+{
+	return supported(FEATURE_AVX2);
+}
+
+
+void disable(int features)
+{
+	disabledFeatures = features;
+}
+
+
+int disabled()
+{
+	return disabledFeatures;
+}
+
+
+} } // namespace Poco::CPUFeatures
@@ -18,6 +18,7 @@
 
 
 #include "Poco/SHA1Engine.h"
+#include "X86Intrinsics.h"
 #include <cstring>
 
 
@@ -68,18 +69,33 @@ void SHA1Engine::updateImpl(const void* buffer_, std::size_t count)
 	_context.countLo += ((UInt32) count << 3);
 	_context.countHi += ((UInt32 ) count >> 29);
 
-	/* Process data in BLOCK_SIZE chunks */
-	while (count-- > 0)
+	/* Complete a partial block */
+	if (_context.slop > 0)
 	{
-		db[_context.slop++] = *(buffer++);
-		if (_context.slop == BLOCK_SIZE)
-		{ 
-			/* transform this one block */
-			SHA1_BYTE_REVERSE(_context.data, BLOCK_SIZE);
-			transform();
-			_context.slop = 0 ;	/* no slop left */
-		}
+		std::size_t n = BLOCK_SIZE - _context.slop;
+		if (n > count) n = count;
+		std::memcpy(db + _context.slop, buffer, n);
+		_context.slop += static_cast<UInt32>(n);
+		buffer += n;
+		count -= n;
+		if (_context.slop < BLOCK_SIZE) return;
+
+		transformBlocks(db, 1);
+		_context.slop = 0;
 	}
+
+	/* Process whole blocks directly from the input */
+	if (count >= BLOCK_SIZE)
+	{
+		std::size_t blocks = count/BLOCK_SIZE;
+		transformBlocks(buffer, blocks);
+		buffer += blocks*BLOCK_SIZE;
+		count  -= blocks*BLOCK_SIZE;
+	}
+
+	/* Save the rest */
+	std::memcpy(db, buffer, count);
+	_context.slop = static_cast<UInt32>(count);
 }
 
 
@@ -151,6 +167,87 @@ const DigestEngine::Digest& SHA1Engine::digest()
 }
 
 
+#if defined(POCO_HAVE_X86_INTRINSICS)
+
+
+namespace
+{
+	// SHA-1 using the SHA extensions. Each SHA1RNDS4 instruction performs
+	// four rounds; the message schedule for rounds 16 to 79 is computed
+	// with SHA1MSG1 and SHA1MSG2, four words at a time.
+
+	POCO_TARGET("sha,sse4.1") inline __m128i sha1Schedule(__m128i w0, __m128i w1, __m128i w2, __m128i w3)
+	{
+		return _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w0, w1), w2), w3);
+	}
+
+	#define SHA1_ROUNDS4(i, f) \
+		E1 = ABCD; \
+		ABCD = _mm_sha1rnds4_epu32(ABCD, E0, f); \
+		if (i < 19) E0 = _mm_sha1nexte_epu32(E1, W[i + 1]);
+
+	POCO_TARGET("sha,sse4.1") void sha1TransformSHA(UInt32* digest, const unsigned char* data, std::size_t blocks)
+	{
+		const __m128i MASK = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+
+		// A is kept in the most significant word
+		__m128i ABCD = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digest)), 0x1B);
+		__m128i E = _mm_set_epi32(static_cast<int>(digest[4]), 0, 0, 0);
+		__m128i W[20];
+
+		while (blocks-- > 0)
+		{
+			__m128i ABCDSave = ABCD;
+			__m128i ESave = E;
+
+			for (int i = 0; i < 4; i++)
+				W[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16*i)), MASK);
+			for (int i = 4; i < 20; i++)
+				W[i] = sha1Schedule(W[i - 4], W[i - 3], W[i - 2], W[i - 1]);
+
+			__m128i E0 = _mm_add_epi32(E, W[0]);
+			__m128i E1;
+			SHA1_ROUNDS4( 0, 0); SHA1_ROUNDS4( 1, 0); SHA1_ROUNDS4( 2, 0); SHA1_ROUNDS4( 3, 0); SHA1_ROUNDS4( 4, 0);
+			SHA1_ROUNDS4( 5, 1); SHA1_ROUNDS4( 6, 1); SHA1_ROUNDS4( 7, 1); SHA1_ROUNDS4( 8, 1); SHA1_ROUNDS4( 9, 1);
+			SHA1_ROUNDS4(10, 2); SHA1_ROUNDS4(11, 2); SHA1_ROUNDS4(12, 2); SHA1_ROUNDS4(13, 2); SHA1_ROUNDS4(14, 2);
+			SHA1_ROUNDS4(15, 3); SHA1_ROUNDS4(16, 3); SHA1_ROUNDS4(17, 3); SHA1_ROUNDS4(18, 3); SHA1_ROUNDS4(19, 3);
+
+			E = _mm_sha1nexte_epu32(E1, ESave);
+			ABCD = _mm_add_epi32(ABCD, ABCDSave);
+			data += 64;
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(digest), _mm_shuffle_epi32(ABCD, 0x1B));
+		digest[4] = static_cast<UInt32>(_mm_extract_epi32(E, 3));
+	}
+
+	#undef SHA1_ROUNDS4
+}
+
+
+#endif // POCO_HAVE_X86_INTRINSICS
+
+
+void SHA1Engine::transformBlocks(const BYTE* data, std::size_t blocks)
+{
+#if defined(POCO_HAVE_X86_INTRINSICS)
+	if (CPUFeatures::hasSHA())
+	{
+		sha1TransformSHA(_context.digest, data, blocks);
+		return;
+	}
+#endif
+	while (blocks-- > 0)
+	{
+		if (data != (const BYTE*) _context.data)
+			std::memcpy(_context.data, data, BLOCK_SIZE);
+		SHA1_BYTE_REVERSE(_context.data, BLOCK_SIZE);
+		transform();
+		data += BLOCK_SIZE;
+	}
+}
+
+
 /* The SHA f()-functions */
 #define f1(x,y,z)   ( ( x & y ) | ( ~x & z ) )              /* Rounds  0-19 */
 #define f2(x,y,z)   ( x ^ y ^ z )                           /* Rounds 20-39 */
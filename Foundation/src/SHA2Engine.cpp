@@ -0,0 +1,599 @@
+//
+// SHA2Engine.cpp
+//
+// $Id$
+//
+// Library: Foundation
+// Package: Crypt
+// Module:  SHA2Engine
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/SHA2Engine.h"
+#include "X86Intrinsics.h"
+#include <cstring>
+
+
+namespace Poco {
+
+
+namespace
+{
+	const UInt32 K256[64] =
+	{
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	const UInt64 K512[80] =
+	{
+		0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+		0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+		0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+		0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+		0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+		0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+		0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+		0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+		0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+		0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+		0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+		0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+		0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+		0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+		0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+		0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+		0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+		0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+		0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+		0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+	};
+
+	const UInt32 IV224[8] =
+	{
+		0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4
+	};
+
+	const UInt32 IV256[8] =
+	{
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+
+	const UInt64 IV384[8] =
+	{
+		0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+		0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+	};
+
+	const UInt64 IV512[8] =
+	{
+		0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+		0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+	};
+
+
+	inline UInt32 load32(const UInt8* p)
+	{
+		return (UInt32(p[0]) << 24) | (UInt32(p[1]) << 16) | (UInt32(p[2]) << 8) | UInt32(p[3]);
+	}
+
+
+	inline UInt64 load64(const UInt8* p)
+	{
+		return (UInt64(load32(p)) << 32) | load32(p + 4);
+	}
+
+
+	inline void store32(UInt8* p, UInt32 v)
+	{
+		p[0] = UInt8(v >> 24);
+		p[1] = UInt8(v >> 16);
+		p[2] = UInt8(v >> 8);
+		p[3] = UInt8(v);
+	}
+
+
+	inline void store64(UInt8* p, UInt64 v)
+	{
+		store32(p, UInt32(v >> 32));
+		store32(p + 4, UInt32(v));
+	}
+
+
+	inline UInt32 rotr32(UInt32 x, int n)
+	{
+		return (x >> n) | (x << (32 - n));
+	}
+
+
+	inline UInt64 rotr64(UInt64 x, int n)
+	{
+		return (x >> n) | (x << (64 - n));
+	}
+
+
+	void sha256Transform(UInt32* state, const UInt8* data, std::size_t blocks)
+	{
+		UInt32 W[64];
+		while (blocks-- > 0)
+		{
+			for (int t = 0; t < 16; t++)
+				W[t] = load32(data + 4*t);
+			for (int t = 16; t < 64; t++)
+			{
+				UInt32 s0 = rotr32(W[t - 15], 7) ^ rotr32(W[t - 15], 18) ^ (W[t - 15] >> 3);
+				UInt32 s1 = rotr32(W[t - 2], 17) ^ rotr32(W[t - 2], 19) ^ (W[t - 2] >> 10);
+				W[t] = W[t - 16] + s0 + W[t - 7] + s1;
+			}
+
+			UInt32 a = state[0], b = state[1], c = state[2], d = state[3];
+			UInt32 e = state[4], f = state[5], g = state[6], h = state[7];
+			for (int t = 0; t < 64; t++)
+			{
+				UInt32 S1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+				UInt32 ch = (e & f) ^ (~e & g);
+				UInt32 temp1 = h + S1 + ch + K256[t] + W[t];
+				UInt32 S0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+				UInt32 maj = (a & b) ^ (a & c) ^ (b & c);
+				UInt32 temp2 = S0 + maj;
+				h = g;
+				g = f;
+				f = e;
+				e = d + temp1;
+				d = c;
+				c = b;
+				b = a;
+				a = temp1 + temp2;
+			}
+			state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+			state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+			data += 64;
+		}
+	}
+
+
+	void sha512Transform(UInt64* state, const UInt8* data, std::size_t blocks)
+	{
+		UInt64 W[80];
+		while (blocks-- > 0)
+		{
+			for (int t = 0; t < 16; t++)
+				W[t] = load64(data + 8*t);
+			for (int t = 16; t < 80; t++)
+			{
+				UInt64 s0 = rotr64(W[t - 15], 1) ^ rotr64(W[t - 15], 8) ^ (W[t - 15] >> 7);
+				UInt64 s1 = rotr64(W[t - 2], 19) ^ rotr64(W[t - 2], 61) ^ (W[t - 2] >> 6);
+				W[t] = W[t - 16] + s0 + W[t - 7] + s1;
+			}
+
+			UInt64 a = state[0], b = state[1], c = state[2], d = state[3];
+			UInt64 e = state[4], f = state[5], g = state[6], h = state[7];
+			for (int t = 0; t < 80; t++)
+			{
+				UInt64 S1 = rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41);
+				UInt64 ch = (e & f) ^ (~e & g);
+				UInt64 temp1 = h + S1 + ch + K512[t] + W[t];
+				UInt64 S0 = rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39);
+				UInt64 maj = (a & b) ^ (a & c) ^ (b & c);
+				UInt64 temp2 = S0 + maj;
+				h = g;
+				g = f;
+				f = e;
+				e = d + temp1;
+				d = c;
+				c = b;
+				b = a;
+				a = temp1 + temp2;
+			}
+			state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+			state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+			data += 128;
+		}
+	}
+
+
+#if defined(POCO_HAVE_X86_INTRINSICS)
+
+
+	// SHA-256 using the SHA extensions. The state is kept in two
+	// registers, ABEF and CDGH; each SHA256RNDS2 instruction performs
+	// two rounds, and the message schedule for rounds 16 to 63 is
+	// computed with SHA256MSG1 and SHA256MSG2, four words at a time.
+
+	POCO_TARGET("sha,sse4.1") void sha256TransformSHA(UInt32* state, const UInt8* data, std::size_t blocks)
+	{
+		const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+
+		__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);        // CDAB
+		__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B); // EFGH
+		__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);    // ABEF
+		state1 = _mm_blend_epi16(state1, tmp, 0xF0);         // CDGH
+
+		__m128i M[16];
+		while (blocks-- > 0)
+		{
+			__m128i save0 = state0;
+			__m128i save1 = state1;
+
+			for (int i = 0; i < 16; i++)
+			{
+				if (i < 4)
+				{
+					M[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16*i)), MASK);
+				}
+				else
+				{
+					__m128i w = _mm_add_epi32(_mm_sha256msg1_epu32(M[i - 4], M[i - 3]), _mm_alignr_epi8(M[i - 1], M[i - 2], 4));
+					M[i] = _mm_sha256msg2_epu32(w, M[i - 1]);
+				}
+				__m128i msg = _mm_add_epi32(M[i], _mm_loadu_si128(reinterpret_cast<const __m128i*>(K256 + 4*i)));
+				state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+				state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			}
+
+			state0 = _mm_add_epi32(state0, save0);
+			state1 = _mm_add_epi32(state1, save1);
+			data += 64;
+		}
+
+		tmp = _mm_shuffle_epi32(state0, 0x1B);               // FEBA
+		state1 = _mm_shuffle_epi32(state1, 0xB1);            // DCHG
+		state0 = _mm_blend_epi16(tmp, state1, 0xF0);         // DCBA
+		state1 = _mm_alignr_epi8(state1, tmp, 8);            // HGFE
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+	}
+
+
+	// SHA-256 of eight independent blocks, one in each 32-bit lane
+	// of the AVX2 registers. state holds the eight state words of
+	// lane l at state[8*word + l].
+
+	#define SHA256X8_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+	POCO_TARGET("avx2") void sha256TransformX8(UInt32* state, const UInt8* const* blocks)
+	{
+		const __m256i MASK = _mm256_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL, 0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+
+		__m256i W[64];
+		for (int t = 0; t < 16; t++)
+		{
+			UInt32 words[8];
+			for (int l = 0; l < 8; l++)
+				std::memcpy(&words[l], blocks[l] + 4*t, 4);
+			W[t] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words)), MASK);
+		}
+		for (int t = 16; t < 64; t++)
+		{
+			__m256i w15 = W[t - 15];
+			__m256i w2 = W[t - 2];
+			__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(SHA256X8_ROTR(w15, 7), SHA256X8_ROTR(w15, 18)), _mm256_srli_epi32(w15, 3));
+			__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(SHA256X8_ROTR(w2, 17), SHA256X8_ROTR(w2, 19)), _mm256_srli_epi32(w2, 10));
+			W[t] = _mm256_add_epi32(_mm256_add_epi32(W[t - 16], s0), _mm256_add_epi32(W[t - 7], s1));
+		}
+
+		__m256i* pState = reinterpret_cast<__m256i*>(state);
+		__m256i a = _mm256_loadu_si256(pState + 0), b = _mm256_loadu_si256(pState + 1);
+		__m256i c = _mm256_loadu_si256(pState + 2), d = _mm256_loadu_si256(pState + 3);
+		__m256i e = _mm256_loadu_si256(pState + 4), f = _mm256_loadu_si256(pState + 5);
+		__m256i g = _mm256_loadu_si256(pState + 6), h = _mm256_loadu_si256(pState + 7);
+		for (int t = 0; t < 64; t++)
+		{
+			__m256i S1 = _mm256_xor_si256(_mm256_xor_si256(SHA256X8_ROTR(e, 6), SHA256X8_ROTR(e, 11)), SHA256X8_ROTR(e, 25));
+			__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+			__m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(h, S1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(K256[t])), W[t])));
+			__m256i S0 = _mm256_xor_si256(_mm256_xor_si256(SHA256X8_ROTR(a, 2), SHA256X8_ROTR(a, 13)), SHA256X8_ROTR(a, 22));
+			__m256i maj = _mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_xor_si256(a, b)));
+			__m256i temp2 = _mm256_add_epi32(S0, maj);
+			h = g;
+			g = f;
+			f = e;
+			e = _mm256_add_epi32(d, temp1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm256_add_epi32(temp1, temp2);
+		}
+		_mm256_storeu_si256(pState + 0, _mm256_add_epi32(_mm256_loadu_si256(pState + 0), a));
+		_mm256_storeu_si256(pState + 1, _mm256_add_epi32(_mm256_loadu_si256(pState + 1), b));
+		_mm256_storeu_si256(pState + 2, _mm256_add_epi32(_mm256_loadu_si256(pState + 2), c));
+		_mm256_storeu_si256(pState + 3, _mm256_add_epi32(_mm256_loadu_si256(pState + 3), d));
+		_mm256_storeu_si256(pState + 4, _mm256_add_epi32(_mm256_loadu_si256(pState + 4), e));
+		_mm256_storeu_si256(pState + 5, _mm256_add_epi32(_mm256_loadu_si256(pState + 5), f));
+		_mm256_storeu_si256(pState + 6, _mm256_add_epi32(_mm256_loadu_si256(pState + 6), g));
+		_mm256_storeu_si256(pState + 7, _mm256_add_epi32(_mm256_loadu_si256(pState + 7), h));
+	}
+
+	#undef SHA256X8_ROTR
+
+
+	class SHA256Lanes
+		/// Schedules messages onto the eight lanes of sha256TransformX8().
+		/// A lane that has processed all blocks of its message
+		/// is refilled with the next message.
+	{
+	public:
+		enum
+		{
+			LANES = 8
+		};
+
+		SHA256Lanes(std::size_t count, const void* const* data, const std::size_t* lengths, DigestEngine::Digest* digests, bool sha224):
+			_count(count),
+			_data(data),
+			_lengths(lengths),
+			_digests(digests),
+			_pIV(sha224 ? IV224 : IV256),
+			_digestWords(sha224 ? 7 : 8),
+			_next(0)
+		{
+			std::memset(_zero, 0, sizeof(_zero));
+			for (int l = 0; l < LANES; l++) assign(l);
+		}
+
+		void run()
+		{
+			const UInt8* blocks[LANES];
+			for (;;)
+			{
+				bool active = false;
+				for (int l = 0; l < LANES; l++)
+				{
+					Lane& lane = _lanes[l];
+					if (!lane.active)
+						blocks[l] = _zero;
+					else if (lane.blocks > 0)
+						blocks[l] = lane.pData;
+					else
+						blocks[l] = lane.tail + 64*lane.tailPos;
+					active = active || lane.active;
+				}
+				if (!active) break;
+
+				sha256TransformX8(_state, blocks);
+
+				for (int l = 0; l < LANES; l++)
+				{
+					Lane& lane = _lanes[l];
+					if (!lane.active) continue;
+					if (lane.blocks > 0)
+					{
+						lane.pData += 64;
+						lane.blocks--;
+					}
+					else if (++lane.tailPos == lane.tailBlocks)
+					{
+						finish(l);
+						assign(l);
+					}
+				}
+			}
+		}
+
+	private:
+		struct Lane
+		{
+			bool active;
+			std::size_t message;
+			const UInt8* pData;
+			std::size_t blocks;
+			UInt8 tail[128];
+			int tailBlocks;
+			int tailPos;
+		};
+
+		void assign(int l)
+		{
+			Lane& lane = _lanes[l];
+			lane.active = _next < _count;
+			if (!lane.active) return;
+
+			lane.message = _next++;
+			std::size_t length = _lengths[lane.message];
+			lane.pData = static_cast<const UInt8*>(_data[lane.message]);
+			lane.blocks = length/64;
+
+			// the remaining bytes, followed by the padding
+			std::size_t rest = length % 64;
+			lane.tailBlocks = rest + 9 > 64 ? 2 : 1;
+			lane.tailPos = 0;
+			std::memset(lane.tail, 0, sizeof(lane.tail));
+			std::memcpy(lane.tail, lane.pData + 64*lane.blocks, rest);
+			lane.tail[rest] = 0x80;
+			store64(lane.tail + 64*lane.tailBlocks - 8, UInt64(length) << 3);
+
+			for (int i = 0; i < 8; i++)
+				_state[8*i + l] = _pIV[i];
+		}
+
+		void finish(int l)
+		{
+			UInt8 hash[32];
+			for (int i = 0; i < _digestWords; i++)
+				store32(hash + 4*i, _state[8*i + l]);
+			_digests[_lanes[l].message].assign(hash, hash + 4*_digestWords);
+		}
+
+		std::size_t _count;
+		const void* const* _data;
+		const std::size_t* _lengths;
+		DigestEngine::Digest* _digests;
+		const UInt32* _pIV;
+		int _digestWords;
+		std::size_t _next;
+		Lane _lanes[LANES];
+		UInt32 _state[8*LANES];
+		UInt8 _zero[64];
+	};
+
+
+#endif // POCO_HAVE_X86_INTRINSICS
+}
+
+
+SHA2Engine::SHA2Engine(ALGORITHM algorithm):
+	_algorithm(algorithm)
+{
+	_digest.reserve(MAX_DIGEST_SIZE);
+	reset();
+}
+
+
+SHA2Engine::~SHA2Engine()
+{
+	reset();
+}
+
+
+std::size_t SHA2Engine::digestLength() const
+{
+	return static_cast<std::size_t>(_algorithm)/8;
+}
+
+
+void SHA2Engine::reset()
+{
+	switch (_algorithm)
+	{
+	case SHA_224:
+		std::memcpy(_context.state32, IV224, sizeof(IV224));
+		break;
+	case SHA_256:
+		std::memcpy(_context.state32, IV256, sizeof(IV256));
+		break;
+	case SHA_384:
+		std::memcpy(_context.state64, IV384, sizeof(IV384));
+		break;
+	case SHA_512:
+		std::memcpy(_context.state64, IV512, sizeof(IV512));
+		break;
+	}
+	std::memset(_context.buffer, 0, sizeof(_context.buffer));
+	_context.bufferLength = 0;
+	_context.totalLength = 0;
+}
+
+
+void SHA2Engine::updateImpl(const void* data, std::size_t length)
+{
+	const UInt8* p = static_cast<const UInt8*>(data);
+	std::size_t size = blockSize();
+	_context.totalLength += length;
+
+	// complete a partial block
+	if (_context.bufferLength > 0)
+	{
+		std::size_t n = size - _context.bufferLength;
+		if (n > length) n = length;
+		std::memcpy(_context.buffer + _context.bufferLength, p, n);
+		_context.bufferLength += n;
+		p += n;
+		length -= n;
+		if (_context.bufferLength < size) return;
+
+		transformBlocks(_context.buffer, 1);
+		_context.bufferLength = 0;
+	}
+
+	// process whole blocks directly from the input
+	if (length >= size)
+	{
+		std::size_t blocks = length/size;
+		transformBlocks(p, blocks);
+		p += blocks*size;
+		length -= blocks*size;
+	}
+
+	std::memcpy(_context.buffer, p, length);
+	_context.bufferLength = length;
+}
+
+
+const DigestEngine::Digest& SHA2Engine::digest()
+{
+	std::size_t size = blockSize();
+	std::size_t lengthSize = size/8;
+	UInt64 bitLength = _context.totalLength << 3;
+
+	_context.buffer[_context.bufferLength++] = 0x80;
+	if (_context.bufferLength > size - lengthSize)
+	{
+		std::memset(_context.buffer + _context.bufferLength, 0, size - _context.bufferLength);
+		transformBlocks(_context.buffer, 1);
+		_context.bufferLength = 0;
+	}
+	std::memset(_context.buffer + _context.bufferLength, 0, size - _context.bufferLength);
+	if (lengthSize == 16)
+		store64(_context.buffer + size - 16, _context.totalLength >> 61);
+	store64(_context.buffer + size - 8, bitLength);
+	transformBlocks(_context.buffer, 1);
+
+	UInt8 hash[MAX_DIGEST_SIZE];
+	if (_algorithm <= SHA_256)
+	{
+		for (int i = 0; i < 8; i++)
+			store32(hash + 4*i, _context.state32[i]);
+	}
+	else
+	{
+		for (int i = 0; i < 8; i++)
+			store64(hash + 8*i, _context.state64[i]);
+	}
+	_digest.clear();
+	_digest.insert(_digest.begin(), hash, hash + digestLength());
+	reset();
+	return _digest;
+}
+
+
+void SHA2Engine::digestMany(std::size_t count, const void* const* data, const std::size_t* lengths, Digest* digests, ALGORITHM algorithm)
+{
+#if defined(POCO_HAVE_X86_INTRINSICS)
+	if (algorithm <= SHA_256 && count > 1 && CPUFeatures::hasAVX2() && !CPUFeatures::hasSHA())
+	{
+		SHA256Lanes lanes(count, data, lengths, digests, algorithm == SHA_224);
+		lanes.run();
+		return;
+	}
+#endif
+	SHA2Engine engine(algorithm);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		engine.update(data[i], lengths[i]);
+		digests[i] = engine.digest();
+	}
+}
+
+
+void SHA2Engine::transformBlocks(const UInt8* data, std::size_t blocks)
+{
+	if (_algorithm <= SHA_256)
+	{
+#if defined(POCO_HAVE_X86_INTRINSICS)
+		if (CPUFeatures::hasSHA())
+		{
+			sha256TransformSHA(_context.state32, data, blocks);
+			return;
+		}
+#endif
+		sha256Transform(_context.state32, data, blocks);
+	}
+	else
+	{
+		sha512Transform(_context.state64, data, blocks);
+	}
+}
+
+
+} // namespace Poco
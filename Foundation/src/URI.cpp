@@ -15,6 +15,7 @@
 
 
 #include "Poco/URI.h"
+#include "Poco/URIView.h"
 #include "Poco/NumberFormatter.h"
 #include "Poco/Exception.h"
 #include "Poco/String.h"
@@ -353,38 +354,12 @@ std::string URI::getQuery() const
 URI::QueryParameters URI::getQueryParameters() const
 {
 	QueryParameters result;
-	std::string::const_iterator it(_query.begin());
-	std::string::const_iterator end(_query.end());
-	while (it != end)
+	URIView::QueryIterator it(URIView::Range(_query.data(), _query.data() + _query.size()));
+	while (it.next())
 	{
-		std::string name;
-		std::string value;
-		while (it != end && *it != '=' && *it != '&')
-		{
-			if (*it == '+') 
-				name += ' ';
-			else
-				name += *it;
-			++it;
-		}
-		if (it != end && *it == '=')
-		{
-			++it;
-			while (it != end && *it != '&')
-			{
-				if (*it == '+') 
-					value += ' ';
-				else
-					value += *it;
-				++it;
-			}
-		}
-		std::string decodedName;
-		std::string decodedValue;
-		URI::decode(name, decodedName);
-		URI::decode(value, decodedValue);
-		result.push_back(std::make_pair(decodedName, decodedValue));
-		if (it != end && *it == '&') ++it;	
+		result.push_back(QueryParameters::value_type());
+		it.decodeName(result.back().first);
+		it.decodeValue(result.back().second);
 	}
 	return result;
 }
@@ -0,0 +1,264 @@
+//
+// URIView.cpp
+//
+// $Id$
+//
+// Library: Foundation
+// Package: URI
+// Module:  URIView
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/URIView.h"
+#include "Poco/Exception.h"
+
+
+namespace Poco {
+
+
+namespace
+{
+	inline int hexValue(char c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		else if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		else if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		else
+			return -1;
+	}
+}
+
+
+URIView::QueryIterator::QueryIterator(const Range& query):
+	_it(query.begin()),
+	_end(query.end())
+{
+}
+
+
+bool URIView::QueryIterator::next()
+{
+	if (_it == _end) return false;
+
+	const char* nameBegin = _it;
+	while (_it != _end && *_it != '=' && *_it != '&') ++_it;
+	_name = Range(nameBegin, _it);
+	if (_it != _end && *_it == '=')
+	{
+		++_it;
+		const char* valueBegin = _it;
+		while (_it != _end && *_it != '&') ++_it;
+		_value = Range(valueBegin, _it);
+	}
+	else _value = Range(_it, _it);
+	if (_it != _end) ++_it;
+	return true;
+}
+
+
+URIView::URIView():
+	_port(0)
+{
+}
+
+
+URIView::URIView(const std::string& uri):
+	_port(0)
+{
+	parse(uri);
+}
+
+
+URIView::URIView(const char* begin, const char* end):
+	_port(0)
+{
+	parse(begin, end);
+}
+
+
+URIView::~URIView()
+{
+}
+
+
+void URIView::parse(const std::string& uri)
+{
+	parse(uri.data(), uri.data() + uri.size());
+}
+
+
+void URIView::parse(const char* begin, const char* end)
+{
+	clear();
+	const char* it = begin;
+	if (it == end) return;
+	if (*it != '/' && *it != '.' && *it != '?' && *it != '#')
+	{
+		while (it != end && *it != ':' && *it != '?' && *it != '#' && *it != '/') ++it;
+		if (it != end && *it == ':')
+		{
+			Range scheme(begin, it);
+			++it;
+			if (it == end) throw SyntaxException("URI scheme must be followed by authority or path", std::string(begin, end));
+			_scheme = scheme;
+			if (end - it >= 2 && it[0] == '/' && it[1] == '/')
+			{
+				it += 2;
+				parseAuthority(it, end);
+			}
+			parsePathEtc(it, end);
+		}
+		else parsePathEtc(begin, end);
+	}
+	else parsePathEtc(it, end);
+}
+
+
+void URIView::clear()
+{
+	_scheme   = Range();
+	_userInfo = Range();
+	_host     = Range();
+	_port     = 0;
+	_path     = Range();
+	_query    = Range();
+	_fragment = Range();
+}
+
+
+bool URIView::getQueryParameter(const std::string& name, std::string& value) const
+{
+	std::string decodedName;
+	QueryIterator it(_query);
+	while (it.next())
+	{
+		it.decodeName(decodedName);
+		if (decodedName == name)
+		{
+			it.decodeValue(value);
+			return true;
+		}
+	}
+	return false;
+}
+
+
+std::size_t URIView::decode(const char* begin, const char* end, char* buffer, bool plusAsSpace)
+{
+	char* out = buffer;
+	const char* it = begin;
+	while (it != end)
+	{
+		char c = *it++;
+		if (c == '+' && plusAsSpace) c = ' ';
+		else if (c == '%')
+		{
+			if (it == end) throw SyntaxException("URI encoding: no hex digit following percent sign", std::string(begin, end));
+			if (end - it < 2) throw SyntaxException("URI encoding: two hex digits must follow percent sign", std::string(begin, end));
+			int hi = hexValue(*it++);
+			int lo = hexValue(*it++);
+			if (hi < 0 || lo < 0) throw SyntaxException("URI encoding: not a hex digit");
+			c = static_cast<char>(hi*16 + lo);
+		}
+		*out++ = c;
+	}
+	return static_cast<std::size_t>(out - buffer);
+}
+
+
+void URIView::decode(const Range& range, std::string& decoded, bool plusAsSpace)
+{
+	// most names and values contain nothing to decode
+	const char* it = range.begin();
+	while (it != range.end() && *it != '%' && (*it != '+' || !plusAsSpace)) ++it;
+	if (it == range.end())
+	{
+		decoded.assign(range.begin(), range.end());
+	}
+	else
+	{
+		decoded.resize(range.size());
+		std::size_t n = decode(range.begin(), range.end(), &decoded[0], plusAsSpace);
+		decoded.resize(n);
+	}
+}
+
+
+void URIView::parseAuthority(const char*& it, const char* end)
+{
+	const char* begin = it;
+	while (it != end && *it != '/' && *it != '?' && *it != '#') ++it;
+
+	// the user information ends at the last '@'
+	const char* hostBegin = begin;
+	for (const char* p = begin; p != it; ++p)
+	{
+		if (*p == '@') hostBegin = p + 1;
+	}
+	if (hostBegin != begin) _userInfo = Range(begin, hostBegin - 1);
+
+	const char* p = hostBegin;
+	if (p == it) return;
+	if (*p == '[')
+	{
+		// IPv6 address
+		const char* hostEnd = ++p;
+		while (hostEnd != it && *hostEnd != ']') ++hostEnd;
+		if (hostEnd == it) throw SyntaxException("unterminated IPv6 address");
+		_host = Range(p, hostEnd);
+		p = hostEnd + 1;
+	}
+	else
+	{
+		const char* hostEnd = p;
+		while (hostEnd != it && *hostEnd != ':') ++hostEnd;
+		_host = Range(p, hostEnd);
+		p = hostEnd;
+	}
+	if (p != it && *p == ':')
+	{
+		++p;
+		if (p != it)
+		{
+			int port = 0;
+			const char* portBegin = p;
+			while (p != it && *p >= '0' && *p <= '9' && port < 65536)
+			{
+				port = port*10 + (*p++ - '0');
+			}
+			if (p != it || port == 0 || port >= 65536)
+				throw SyntaxException("bad or invalid port number", std::string(portBegin, it));
+			_port = static_cast<unsigned short>(port);
+		}
+	}
+}
+
+
+void URIView::parsePathEtc(const char* it, const char* end)
+{
+	const char* begin = it;
+	while (it != end && *it != '?' && *it != '#') ++it;
+	_path = Range(begin, it);
+	if (it != end && *it == '?')
+	{
+		begin = ++it;
+		while (it != end && *it != '#') ++it;
+		_query = Range(begin, it);
+	}
+	if (it != end && *it == '#')
+	{
+		++it;
+		_fragment = Range(it, end);
+	}
+}
+
+
+} // namespace Poco
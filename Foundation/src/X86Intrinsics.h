@@ -0,0 +1,48 @@
+//
+// X86Intrinsics.h
+//
+// $Id$
+//
+// Library: Foundation
+// Package: Core
+// Module:  CPUFeatures
+//
+// Support for x86 instruction set extensions in selected functions.
+// This header is used internally by Foundation and is not installed.
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Foundation_X86Intrinsics_INCLUDED
+#define Foundation_X86Intrinsics_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include "Poco/CPUFeatures.h"
+
+
+//
+// POCO_HAVE_X86_INTRINSICS is defined if the compiler can generate
+// code for SSE4.2, PCLMULQDQ, SHA and AVX2 in functions marked with
+// POCO_TARGET, without these extensions being enabled for the
+// whole translation unit. Such functions must only be called if
+// the corresponding CPUFeatures function returns true.
+//
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+	#define POCO_HAVE_X86_INTRINSICS
+	#define POCO_TARGET(features) __attribute__((target(features)))
+	#include <cpuid.h>
+	#include <immintrin.h>
+#elif defined(_MSC_VER) && _MSC_VER >= 1900 && (defined(_M_X64) || defined(_M_IX86))
+	#define POCO_HAVE_X86_INTRINSICS
+	#define POCO_TARGET(features)
+	#include <intrin.h>
+	#include <immintrin.h>
+#endif
+
+
+#endif // Foundation_X86Intrinsics_INCLUDED
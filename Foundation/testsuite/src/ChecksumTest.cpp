@@ -0,0 +1,132 @@
+//
+// ChecksumTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "ChecksumTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Checksum.h"
+#include <algorithm>
+
+
+using Poco::Checksum;
+
+
+namespace
+{
+	std::string testData()
+	{
+		std::string data;
+		for (int i = 0; i < 100000; ++i)
+			data += static_cast<char>(i*7 + 3);
+		return data;
+	}
+}
+
+
+ChecksumTest::ChecksumTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+ChecksumTest::~ChecksumTest()
+{
+}
+
+
+void ChecksumTest::testCRC32()
+{
+	Checksum checksum(Checksum::TYPE_CRC32);
+	assert (checksum.type() == Checksum::TYPE_CRC32);
+	checksum.update("123456789");
+	assert (checksum.checksum() == 0xCBF43926);
+
+	// large enough for the carry-less multiplication path
+	Checksum large(Checksum::TYPE_CRC32);
+	large.update(testData());
+	assert (large.checksum() == 0xF730CAA8);
+}
+
+
+void ChecksumTest::testCRC32C()
+{
+	Checksum checksum(Checksum::TYPE_CRC32C);
+	assert (checksum.type() == Checksum::TYPE_CRC32C);
+	assert (checksum.checksum() == 0);
+	checksum.update("123456789");
+	assert (checksum.checksum() == 0xE3069283);
+
+	Checksum large(Checksum::TYPE_CRC32C);
+	large.update(testData());
+	assert (large.checksum() == 0x96F31DC6);
+}
+
+
+void ChecksumTest::testAdler32()
+{
+	Checksum checksum;
+	assert (checksum.type() == Checksum::TYPE_CRC32);
+
+	Checksum adler(Checksum::TYPE_ADLER32);
+	adler.update("123456789");
+	assert (adler.checksum() == 0x091E01DE);
+
+	Checksum large(Checksum::TYPE_ADLER32);
+	large.update(testData());
+	assert (large.checksum() == 0x2DFB940F);
+}
+
+
+void ChecksumTest::testChunked()
+{
+	std::string data = testData();
+	Checksum::Type types[] = { Checksum::TYPE_ADLER32, Checksum::TYPE_CRC32, Checksum::TYPE_CRC32C };
+	for (int t = 0; t < 3; ++t)
+	{
+		Checksum whole(types[t]);
+		whole.update(data);
+
+		std::size_t chunkSizes[] = { 1, 7, 15, 16, 17, 63, 64, 65, 1000, 4099 };
+		for (int c = 0; c < 10; ++c)
+		{
+			Checksum chunked(types[t]);
+			for (std::size_t pos = 0; pos < data.size(); pos += chunkSizes[c])
+			{
+				std::size_t n = std::min(chunkSizes[c], data.size() - pos);
+				chunked.update(data.data() + pos, static_cast<unsigned>(n));
+			}
+			assert (chunked.checksum() == whole.checksum());
+		}
+	}
+}
+
+
+void ChecksumTest::setUp()
+{
+}
+
+
+void ChecksumTest::tearDown()
+{
+}
+
+
+CppUnit::Test* ChecksumTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("ChecksumTest");
+
+	CppUnit_addTest(pSuite, ChecksumTest, testCRC32);
+	CppUnit_addTest(pSuite, ChecksumTest, testCRC32C);
+	CppUnit_addTest(pSuite, ChecksumTest, testAdler32);
+	CppUnit_addTest(pSuite, ChecksumTest, testChunked);
+
+	return pSuite;
+}
@@ -38,6 +38,7 @@
 #include "TypeListTest.h"
 #include "ObjectPoolTest.h"
 #include "ListMapTest.h"
+#include "ChecksumTest.h"
 
 
 CppUnit::Test* CoreTestSuite::suite()
@@ -71,6 +72,7 @@ CppUnit::Test* CoreTestSuite::suite()
 	pSuite->addTest(TypeListTest::suite());
 	pSuite->addTest(ObjectPoolTest::suite());
 	pSuite->addTest(ListMapTest::suite());
+	pSuite->addTest(ChecksumTest::suite());
 
 	return pSuite;
 }
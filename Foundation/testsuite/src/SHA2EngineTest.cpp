@@ -0,0 +1,250 @@
+//
+// SHA2EngineTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "SHA2EngineTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/SHA2Engine.h"
+#include "Poco/CPUFeatures.h"
+#include <vector>
+#include <algorithm>
+
+
+using Poco::SHA2Engine;
+using Poco::DigestEngine;
+namespace CPUFeatures = Poco::CPUFeatures;
+
+
+namespace
+{
+	const std::string MSG448("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+	const std::string MSG896("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu");
+}
+
+
+SHA2EngineTest::SHA2EngineTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+SHA2EngineTest::~SHA2EngineTest()
+{
+}
+
+
+void SHA2EngineTest::testSHA224()
+{
+	SHA2Engine engine(SHA2Engine::SHA_224);
+	assert (engine.digestLength() == 28);
+
+	// test vectors from FIPS 180-4 examples
+
+	engine.update("abc");
+	assert (DigestEngine::digestToHex(engine.digest()) == "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7");
+
+	engine.update(MSG448);
+	assert (DigestEngine::digestToHex(engine.digest()) == "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525");
+
+	for (int i = 0; i < 1000000; ++i)
+		engine.update('a');
+	assert (DigestEngine::digestToHex(engine.digest()) == "20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67");
+}
+
+
+void SHA2EngineTest::testSHA256()
+{
+	SHA2Engine engine;
+	assert (engine.algorithm() == SHA2Engine::SHA_256);
+	assert (engine.digestLength() == 32);
+
+	engine.update("abc");
+	assert (DigestEngine::digestToHex(engine.digest()) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+	engine.update(MSG448);
+	assert (DigestEngine::digestToHex(engine.digest()) == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+	for (int i = 0; i < 1000000; ++i)
+		engine.update('a');
+	assert (DigestEngine::digestToHex(engine.digest()) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+
+void SHA2EngineTest::testSHA384()
+{
+	SHA2Engine engine(SHA2Engine::SHA_384);
+	assert (engine.digestLength() == 48);
+	assert (engine.blockSize() == 128);
+
+	engine.update("abc");
+	assert (DigestEngine::digestToHex(engine.digest()) == "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7");
+
+	engine.update(MSG896);
+	assert (DigestEngine::digestToHex(engine.digest()) == "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712fcc7c71a557e2db966c3e9fa91746039");
+
+	for (int i = 0; i < 1000000; ++i)
+		engine.update('a');
+	assert (DigestEngine::digestToHex(engine.digest()) == "9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b07b8b3dc38ecc4ebae97ddd87f3d8985");
+}
+
+
+void SHA2EngineTest::testSHA512()
+{
+	SHA2Engine engine(SHA2Engine::SHA_512);
+	assert (engine.digestLength() == 64);
+
+	engine.update("abc");
+	assert (DigestEngine::digestToHex(engine.digest()) == "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+
+	engine.update(MSG896);
+	assert (DigestEngine::digestToHex(engine.digest()) == "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909");
+
+	for (int i = 0; i < 1000000; ++i)
+		engine.update('a');
+	assert (DigestEngine::digestToHex(engine.digest()) == "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b");
+}
+
+
+void SHA2EngineTest::testChunked()
+{
+	std::string data;
+	for (int i = 0; i < 10000; ++i)
+		data += static_cast<char>(i*7 + 3);
+
+	SHA2Engine::ALGORITHM algorithms[] = { SHA2Engine::SHA_224, SHA2Engine::SHA_256, SHA2Engine::SHA_384, SHA2Engine::SHA_512 };
+	for (int a = 0; a < 4; ++a)
+	{
+		SHA2Engine engine(algorithms[a]);
+		engine.update(data);
+		DigestEngine::Digest whole = engine.digest();
+
+		// odd chunk sizes cross block boundaries in every possible way
+		std::size_t chunkSizes[] = { 1, 3, 63, 64, 65, 127, 128, 129, 1000 };
+		for (int c = 0; c < 9; ++c)
+		{
+			for (std::size_t pos = 0; pos < data.size(); pos += chunkSizes[c])
+			{
+				engine.update(data.data() + pos, std::min(chunkSizes[c], data.size() - pos));
+			}
+			assert (engine.digest() == whole);
+		}
+	}
+}
+
+
+void SHA2EngineTest::testDigestMany()
+{
+	const std::size_t count = 21;
+	std::vector<std::string> messages(count);
+	std::vector<const void*> data(count);
+	std::vector<std::size_t> lengths(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		// different lengths, so that lanes finish at different times
+		messages[i].assign(i*37, static_cast<char>('a' + i));
+		data[i] = messages[i].data();
+		lengths[i] = messages[i].size();
+	}
+
+	SHA2Engine::ALGORITHM algorithms[] = { SHA2Engine::SHA_224, SHA2Engine::SHA_256, SHA2Engine::SHA_384, SHA2Engine::SHA_512 };
+	for (int a = 0; a < 4; ++a)
+	{
+		std::vector<DigestEngine::Digest> digests(count);
+		SHA2Engine::digestMany(count, &data[0], &lengths[0], &digests[0], algorithms[a]);
+
+		SHA2Engine engine(algorithms[a]);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			engine.update(messages[i]);
+			assert (digests[i] == engine.digest());
+		}
+	}
+}
+
+
+void SHA2EngineTest::testImplementations()
+{
+	const std::size_t count = 21;
+	std::vector<std::string> messages(count);
+	std::vector<const void*> data(count);
+	std::vector<std::size_t> lengths(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		messages[i].assign(i*37, static_cast<char>('a' + i));
+		data[i] = messages[i].data();
+		lengths[i] = messages[i].size();
+	}
+
+	// the portable implementation is the reference
+	CPUFeatures::disable(CPUFeatures::FEATURE_SHA | CPUFeatures::FEATURE_AVX2);
+	assert (!CPUFeatures::hasSHA() && !CPUFeatures::hasAVX2());
+	SHA2Engine::ALGORITHM algorithms[] = { SHA2Engine::SHA_224, SHA2Engine::SHA_256 };
+	std::vector<DigestEngine::Digest> reference[2];
+	for (int a = 0; a < 2; ++a)
+	{
+		SHA2Engine engine(algorithms[a]);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			engine.update(messages[i]);
+			reference[a].push_back(engine.digest());
+		}
+	}
+	SHA2Engine engine;
+	engine.update("abc");
+	assert (DigestEngine::digestToHex(engine.digest()) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+	// with SHA extensions disabled, digestMany() uses the AVX2 lanes;
+	// the paths the CPU does not support fall back to the portable code
+	int disabled[] = { 0, CPUFeatures::FEATURE_SHA, CPUFeatures::FEATURE_AVX2 };
+	for (int d = 0; d < 3; ++d)
+	{
+		CPUFeatures::disable(disabled[d]);
+		for (int a = 0; a < 2; ++a)
+		{
+			std::vector<DigestEngine::Digest> digests(count);
+			SHA2Engine::digestMany(count, &data[0], &lengths[0], &digests[0], algorithms[a]);
+			SHA2Engine engine(algorithms[a]);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				assert (digests[i] == reference[a][i]);
+				engine.update(messages[i]);
+				assert (engine.digest() == reference[a][i]);
+			}
+		}
+	}
+}
+
+
+void SHA2EngineTest::setUp()
+{
+}
+
+
+void SHA2EngineTest::tearDown()
+{
+	CPUFeatures::disable(0);
+}
+
+
+CppUnit::Test* SHA2EngineTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("SHA2EngineTest");
+
+	CppUnit_addTest(pSuite, SHA2EngineTest, testSHA224);
+	CppUnit_addTest(pSuite, SHA2EngineTest, testSHA256);
+	CppUnit_addTest(pSuite, SHA2EngineTest, testSHA384);
+	CppUnit_addTest(pSuite, SHA2EngineTest, testSHA512);
+	CppUnit_addTest(pSuite, SHA2EngineTest, testChunked);
+	CppUnit_addTest(pSuite, SHA2EngineTest, testDigestMany);
+	CppUnit_addTest(pSuite, SHA2EngineTest, testImplementations);
+
+	return pSuite;
+}
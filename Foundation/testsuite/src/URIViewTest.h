@@ -0,0 +1,44 @@
+//
+// URIViewTest.h
+//
+// $Id$
+//
+// Definition of the URIViewTest class.
+//
+// Copyright (c) 2004-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef URIViewTest_INCLUDED
+#define URIViewTest_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include "CppUnit/TestCase.h"
+
+
+class URIViewTest: public CppUnit::TestCase
+{
+public:
+	URIViewTest(const std::string& name);
+	~URIViewTest();
+
+	void testParse();
+	void testInvalid();
+	void testDecode();
+	void testQueryIterator();
+	void testQueryParameter();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // URIViewTest_INCLUDED
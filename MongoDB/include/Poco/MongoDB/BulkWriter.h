@@ -0,0 +1,264 @@
+//
+// BulkWriter.h
+//
+// $Id$
+//
+// Library: MongoDB
+// Package: MongoDB
+// Module:  BulkWriter
+//
+// Definition of the BulkWriter class.
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef MongoDB_BulkWriter_INCLUDED
+#define MongoDB_BulkWriter_INCLUDED
+
+
+#include "Poco/MongoDB/MongoDB.h"
+#include "Poco/MongoDB/Connection.h"
+#include "Poco/MongoDB/OpMsgMessage.h"
+#include "Poco/MongoDB/Document.h"
+#include <vector>
+#include <deque>
+
+
+namespace Poco {
+namespace MongoDB {
+
+
+class MongoDB_API BulkWriter
+	/// BulkWriter collects insert, update and delete operations for
+	/// a collection and sends them to the server in batches, using
+	/// OP_MSG insert, update and delete commands with document
+	/// sequences.
+	///
+	/// Consecutive operations of the same kind are combined into one
+	/// command, split so that no command exceeds the maximum batch
+	/// size (number of operations) or the maximum message size.
+	///
+	/// In ordered mode, the operations are executed in the order they
+	/// were added, and execution stops at the first failed operation.
+	/// The batches are sent one at a time, since a batch must not be
+	/// executed if the previous one has failed.
+	///
+	/// In unordered mode, the server continues after a failed
+	/// operation, and up to maxPipelined() batches are sent before
+	/// waiting for the first reply.
+	///
+	/// The failed operations are reported in the Result, with their
+	/// index in the order the operations were added:
+	///
+	///     BulkWriter writer(connection, "team", "players", false);
+	///     for (...) writer.insert(player);
+	///     BulkWriter::Result result = writer.execute();
+	///     for (BulkWriter::WriteErrors::const_iterator it = result.errors.begin(); ...)
+	///         std::cout << it->index << ": " << it->message << std::endl;
+	///
+	/// A BulkWriter is not thread-safe. The connection can be shared
+	/// with other threads sending OP_MSG requests.
+{
+public:
+	enum
+	{
+		DEFAULT_MAX_BATCH_SIZE = 100000,
+			/// Default maximum number of operations in a single command.
+		DEFAULT_MAX_MESSAGE_SIZE = 48000000,
+			/// Default maximum size of a single message in bytes.
+		DEFAULT_MAX_PIPELINED = 4
+			/// Default maximum number of batches in flight in unordered mode.
+	};
+
+	struct WriteError
+		/// Describes a failed operation.
+	{
+		std::size_t index;
+			/// The index of the operation, counting all operations
+			/// added to the BulkWriter since the last execution.
+		Int32 code;
+			/// The error code reported by the server.
+		std::string message;
+			/// The error message reported by the server.
+	};
+
+	typedef std::vector<WriteError> WriteErrors;
+
+	struct Result
+		/// The outcome of BulkWriter::execute().
+	{
+		Result();
+
+		std::size_t inserted;
+			/// Number of inserted documents.
+		std::size_t matched;
+			/// Number of documents matched by updates.
+		std::size_t modified;
+			/// Number of documents modified by updates.
+		std::size_t upserted;
+			/// Number of documents inserted by upserts.
+		std::size_t deleted;
+			/// Number of deleted documents.
+		std::size_t batches;
+			/// Number of commands sent.
+		WriteErrors errors;
+			/// The failed operations, ordered by index.
+	};
+
+	BulkWriter(Connection& connection, const std::string& databaseName, const std::string& collectionName, bool ordered = true);
+		/// Creates a BulkWriter for the given collection.
+		/// The collection name must not contain the database name.
+
+	~BulkWriter();
+		/// Destroys the BulkWriter. Operations not executed are discarded.
+
+	void insert(Document::Ptr document);
+		/// Adds a document to insert.
+
+	void update(Document::Ptr selector, Document::Ptr update, bool multi = false, bool upsert = false);
+		/// Adds an update of the documents matching the selector.
+		/// If multi is false, only the first matching document is updated.
+
+	void remove(Document::Ptr selector, bool justOne = false);
+		/// Adds a delete of the documents matching the selector.
+
+	std::size_t size() const;
+		/// Returns the number of operations not yet executed.
+
+	Result execute();
+		/// Sends all operations added since the last execution to
+		/// the server and returns the outcome.
+		///
+		/// Failed operations are reported in the result, and the
+		/// operations are removed from the BulkWriter.
+		///
+		/// Network errors are thrown. In this case, the operations
+		/// of the batches the server has acknowledged are removed and
+		/// reported by lastResult(). The operations of all other batches,
+		/// including a batch the server may have received but not
+		/// acknowledged, remain in the BulkWriter, and can be sent again
+		/// by calling execute() or discarded by calling clear().
+
+	const Result& lastResult() const;
+		/// Returns the outcome of the last execution. If execute()
+		/// has thrown, the result covers the acknowledged batches.
+
+	void clear();
+		/// Discards all operations not yet executed.
+
+	bool isOrdered() const;
+		/// Returns true if the BulkWriter is in ordered mode.
+
+	void setMaxBatchSize(std::size_t maxBatchSize);
+		/// Sets the maximum number of operations in a single command.
+
+	std::size_t getMaxBatchSize() const;
+		/// Returns the maximum number of operations in a single command.
+
+	void setMaxMessageSize(std::size_t maxMessageSize);
+		/// Sets the maximum size of a single message in bytes.
+
+	std::size_t getMaxMessageSize() const;
+		/// Returns the maximum size of a single message in bytes.
+
+	void setMaxPipelined(std::size_t maxPipelined);
+		/// Sets the maximum number of batches sent in unordered
+		/// mode before waiting for a reply.
+
+	std::size_t getMaxPipelined() const;
+		/// Returns the maximum number of batches in flight in unordered mode.
+
+private:
+	enum Kind
+	{
+		OP_INSERT,
+		OP_UPDATE,
+		OP_DELETE
+	};
+
+	struct Operation
+	{
+		Kind kind;
+		Document::Ptr document;
+		std::size_t size;
+	};
+
+	struct Batch
+	{
+		Kind kind;
+		std::size_t first;
+		std::size_t count;
+		OpMsgMessage::Ptr pRequest;
+		Int32 requestID;
+	};
+
+	typedef std::vector<Operation> Operations;
+	typedef std::deque<Batch> Batches;
+
+	BulkWriter();
+	BulkWriter(const BulkWriter&);
+	BulkWriter& operator = (const BulkWriter&);
+
+	void add(Kind kind, Document::Ptr document);
+	bool nextBatch(const Operations& operations, std::size_t& pos, Batch& batch) const;
+	bool processReply(const Batch& batch, OpMsgMessage& reply, Result& result);
+
+	Connection& _connection;
+	std::string _databaseName;
+	std::string _collectionName;
+	bool _ordered;
+	std::size_t _maxBatchSize;
+	std::size_t _maxMessageSize;
+	std::size_t _maxPipelined;
+	Operations _operations;
+	Result _result;
+};
+
+
+//
+// inlines
+//
+inline std::size_t BulkWriter::size() const
+{
+	return _operations.size();
+}
+
+
+inline const BulkWriter::Result& BulkWriter::lastResult() const
+{
+	return _result;
+}
+
+
+inline bool BulkWriter::isOrdered() const
+{
+	return _ordered;
+}
+
+
+inline std::size_t BulkWriter::getMaxBatchSize() const
+{
+	return _maxBatchSize;
+}
+
+
+inline std::size_t BulkWriter::getMaxMessageSize() const
+{
+	return _maxMessageSize;
+}
+
+
+inline std::size_t BulkWriter::getMaxPipelined() const
+{
+	return _maxPipelined;
+}
+
+
+} } // namespace Poco::MongoDB
+
+
+#endif //MongoDB_BulkWriter_INCLUDED
@@ -23,8 +23,12 @@
 #include "Poco/Net/SocketAddress.h"
 #include "Poco/Net/StreamSocket.h"
 #include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include "Poco/AtomicCounter.h"
 #include "Poco/MongoDB/RequestMessage.h"
 #include "Poco/MongoDB/ResponseMessage.h"
+#include "Poco/MongoDB/OpMsgMessage.h"
+#include <map>
 
 
 namespace Poco {
@@ -33,6 +37,17 @@ namespace MongoDB {
 
 class MongoDB_API Connection
 	/// Represents a connection to a MongoDB server
+	///
+	/// Legacy requests (RequestMessage) are sent one at a time: the
+	/// response is read directly after the request, so a connection
+	/// used for legacy requests must not be shared between threads.
+	///
+	/// OP_MSG requests (OpMsgMessage) are matched to their replies by
+	/// request id. Any number of threads can send OP_MSG requests over
+	/// the same connection concurrently, and a single thread can
+	/// pipeline requests with postRequest() and collect the replies
+	/// later with receiveResponse(). Legacy and OP_MSG requests must
+	/// not be in flight on a connection at the same time.
 {
 public:
 	typedef Poco::SharedPtr<Connection> Ptr;
@@ -79,11 +94,57 @@ public:
 		/// Use this when a response is expected: only a query or getmore
 		/// request will return a response.
 
+	void sendRequest(OpMsgMessage& request);
+		/// Sends an OP_MSG request with the moreToCome flag set,
+		/// so that the server does not send a reply.
+
+	void sendRequest(OpMsgMessage& request, OpMsgMessage& response);
+		/// Sends an OP_MSG request to the MongoDB server and waits
+		/// for its reply. Other threads can send requests and
+		/// receive replies over the same connection in the meantime.
+
+	Int32 postRequest(OpMsgMessage& request);
+		/// Sends an OP_MSG request without waiting for the reply and
+		/// returns the request id to pass to receiveResponse().
+		///
+		/// Use this to pipeline several requests over the connection.
+		/// Every posted request must be followed by a call to
+		/// receiveResponse() for its request id, otherwise its reply
+		/// is kept by the connection until it is disconnected.
+
+	void receiveResponse(Int32 requestID, OpMsgMessage& response);
+		/// Waits for the reply to the request with the given id.
+		///
+		/// Replies to other requests received in the meantime are
+		/// kept for the threads waiting for them.
+
 private:
-	Net::SocketAddress _address;
-	Net::StreamSocket _socket;
+	typedef std::map<Int32, std::string> PendingResponses;
+
+	Connection(const Connection&);
+	Connection& operator = (const Connection&);
+
 	void connect();
 		/// Connects to the MongoDB server
+
+	void sendMessage(const std::string& message);
+		/// Writes a serialized message to the socket.
+
+	Int32 receiveMessage(std::string& message);
+		/// Reads a complete message from the socket and
+		/// returns the request id it responds to.
+
+	void receiveBytes(char* buffer, int length);
+		/// Reads exactly length bytes from the socket.
+
+	Net::SocketAddress _address;
+	Net::StreamSocket _socket;
+	Poco::AtomicCounter _requestID;
+	Poco::FastMutex _writeMutex;
+	Poco::FastMutex _readMutex;
+	Poco::Condition _responseReady;
+	bool _reading;
+	PendingResponses _pendingResponses;
 };
 
 
@@ -27,6 +27,7 @@
 #include "Poco/MongoDB/InsertRequest.h"
 #include "Poco/MongoDB/UpdateRequest.h"
 #include "Poco/MongoDB/DeleteRequest.h"
+#include "Poco/MongoDB/OpMsgMessage.h"
 
 
 namespace Poco {
@@ -64,6 +65,13 @@ public:
 		/// Creates an InsertRequest to insert new documents in the given collection.
 		/// The collectionname must not contain the database name!
 
+	Poco::SharedPtr<Poco::MongoDB::OpMsgMessage> createOpMsgMessage(const std::string& collectionName) const;
+		/// Creates an OpMsgMessage for a command on the given collection.
+		/// The collectionname must not contain the database name!
+
+	Poco::SharedPtr<Poco::MongoDB::OpMsgMessage> createOpMsgMessage() const;
+		/// Creates an OpMsgMessage for a database command.
+
 	Poco::SharedPtr<Poco::MongoDB::QueryRequest> createQueryRequest(const std::string& collectionName) const;
 		/// Creates a QueryRequest. The collectionname must not contain the database name!
 
@@ -115,6 +123,20 @@ Database::createInsertRequest(const std::string& collectionName) const
 }
 
 
+inline Poco::SharedPtr<Poco::MongoDB::OpMsgMessage>
+Database::createOpMsgMessage(const std::string& collectionName) const
+{
+	return new Poco::MongoDB::OpMsgMessage(_dbname, collectionName);
+}
+
+
+inline Poco::SharedPtr<Poco::MongoDB::OpMsgMessage>
+Database::createOpMsgMessage() const
+{
+	return new Poco::MongoDB::OpMsgMessage(_dbname, "");
+}
+
+
 inline Poco::SharedPtr<Poco::MongoDB::QueryRequest>
 Database::createQueryRequest(const std::string& collectionName) const
 {
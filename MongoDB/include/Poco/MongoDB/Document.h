@@ -64,6 +64,10 @@ public:
 	Document& addElement(Element::Ptr element);
 		/// Add an element to the document.
 		/// The active document is returned to allow chaining of the add methods.
+		///
+		/// Elements are kept in the order they are added. An element
+		/// with the name of an existing element does not replace it,
+		/// but is added as well.
 
 	template<typename T>
 	Document& add(const std::string& name, T value)
@@ -185,7 +189,7 @@ protected:
 
 inline Document& Document::addElement(Element::Ptr element)
 {
-	_elements.insert(element);
+	_elements.push_back(element);
 	return *this;
 }
 
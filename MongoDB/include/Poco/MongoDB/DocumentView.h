@@ -0,0 +1,251 @@
+//
+// DocumentView.h
+//
+// $Id$
+//
+// Library: MongoDB
+// Package: MongoDB
+// Module:  DocumentView
+//
+// Definition of the DocumentView class.
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef MongoDB_DocumentView_INCLUDED
+#define MongoDB_DocumentView_INCLUDED
+
+
+#include "Poco/MongoDB/MongoDB.h"
+#include "Poco/MongoDB/Document.h"
+#include "Poco/MongoDB/Element.h"
+#include "Poco/MongoDB/BSONReader.h"
+#include "Poco/BinaryReader.h"
+#include "Poco/MemoryStream.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Exception.h"
+#include <string>
+#include <vector>
+
+
+namespace Poco {
+namespace MongoDB {
+
+
+class MongoDB_API DocumentView
+	/// A read-only view on a BSON document stored in a buffer.
+	///
+	/// Unlike Document, a DocumentView does not decode the document
+	/// into Element objects. It shares the buffer holding the raw BSON
+	/// data (typically the whole reply received from the server) and
+	/// decodes an element only when it is accessed. Creating a view
+	/// does not allocate memory, and neither does accessing elements
+	/// of scalar types.
+	///
+	/// Without an index, looking up an element scans the element names
+	/// of the document. For documents with many elements that are
+	/// accessed repeatedly, buildIndex() creates an index of the
+	/// element offsets sorted by name, so that lookups become a
+	/// binary search.
+	///
+	/// A view can be converted into a Document with toDocument().
+	///
+	/// The buffer must not be modified while views on it exist.
+{
+public:
+	typedef std::vector<DocumentView> Vector;
+	typedef SharedPtr<std::string> Buffer;
+
+	DocumentView();
+		/// Creates an empty DocumentView.
+
+	DocumentView(const Buffer& pBuffer, std::size_t offset = 0);
+		/// Creates a DocumentView for the BSON document starting
+		/// at the given offset of the buffer.
+		///
+		/// Throws a DataFormatException if the buffer does not
+		/// contain a complete document at the given offset.
+
+	~DocumentView();
+		/// Destroys the DocumentView.
+
+	std::size_t byteSize() const;
+		/// Returns the size of the BSON document in bytes.
+
+	bool empty() const;
+		/// Returns true if the document has no elements.
+
+	std::size_t size() const;
+		/// Returns the number of elements in the document.
+
+	bool exists(const std::string& name) const;
+		/// Returns true if the document has an element with the given name.
+
+	template <typename T>
+	bool isType(const std::string& name) const
+		/// Returns true when the type of the element equals the TypeId of ElementTrait
+	{
+		std::size_t pos = find(name);
+		return pos != NOT_FOUND && ElementTraits<T>::TypeId == type(pos);
+	}
+
+	template <typename T>
+	T get(const std::string& name) const
+		/// Returns the value of the element with the given name,
+		/// decoded as the template type. When the element is not found,
+		/// a NotFoundException will be thrown. When the element has
+		/// a different type, a BadCastException will be thrown.
+	{
+		std::size_t pos = find(name);
+		if (pos == NOT_FOUND)
+			throw NotFoundException(name);
+		if (ElementTraits<T>::TypeId != type(pos))
+			throw BadCastException("Invalid type mismatch!");
+
+		T value = T();
+		readValue(pos, value);
+		return value;
+	}
+
+	template <typename T>
+	T get(const std::string& name, const T& def) const
+		/// Returns the value of the element with the given name,
+		/// decoded as the template type. When the element is not found,
+		/// or has a different type, the def argument will be returned.
+	{
+		std::size_t pos = find(name);
+		if (pos == NOT_FOUND || ElementTraits<T>::TypeId != type(pos))
+			return def;
+
+		T value = T();
+		readValue(pos, value);
+		return value;
+	}
+
+	DocumentView getDocument(const std::string& name) const;
+		/// Returns a view on the embedded document or array with the
+		/// given name. The view shares the buffer of this view.
+		///
+		/// When the element is not found, a NotFoundException will
+		/// be thrown. When the element is not a document or an array,
+		/// a BadCastException will be thrown.
+
+	void buildIndex();
+		/// Builds the index of element offsets used for lookups by name.
+
+	bool hasIndex() const;
+		/// Returns true if the index has been built.
+
+	Document::Ptr toDocument() const;
+		/// Decodes the complete document into a Document.
+
+	std::string toString(int indent = 0) const;
+		/// Returns a JSON-like representation of the document.
+
+private:
+	static const std::size_t NOT_FOUND;
+
+	struct IndexEntry
+	{
+		std::size_t name;
+		std::size_t element;
+	};
+
+	typedef std::vector<IndexEntry> Index;
+
+	class IndexCompare;
+
+	std::size_t find(const std::string& name) const;
+		/// Returns the offset of the element with the given name,
+		/// or NOT_FOUND.
+
+	int type(std::size_t pos) const;
+		/// Returns the type of the element at the given offset.
+
+	std::size_t valueOffset(std::size_t pos) const;
+		/// Returns the offset of the value of the element at the given offset.
+
+	std::size_t nextElement(std::size_t pos) const;
+		/// Returns the offset of the element following the element
+		/// at the given offset.
+
+	std::size_t readLength(std::size_t pos, std::size_t end) const;
+		/// Reads a length prefix and checks it against the end offset.
+
+	Int32 readInt32(std::size_t pos) const;
+
+	const char* data() const;
+
+	template <typename T>
+	void readValue(std::size_t pos, T& value) const
+	{
+		std::size_t offset = valueOffset(pos);
+		MemoryInputStream istr(data() + offset, _offset + _size - offset);
+		BinaryReader reader(istr, BinaryReader::LITTLE_ENDIAN_BYTE_ORDER);
+		BSONReader(reader).read(value);
+	}
+
+	template <typename T>
+	void readValue(std::size_t pos, SharedPtr<T>& value) const
+	{
+		value = new T;
+		std::size_t offset = valueOffset(pos);
+		MemoryInputStream istr(data() + offset, _offset + _size - offset);
+		BinaryReader reader(istr, BinaryReader::LITTLE_ENDIAN_BYTE_ORDER);
+		BSONReader(reader).read(value);
+	}
+
+	Buffer _pBuffer;
+	std::size_t _offset;
+	std::size_t _size;
+	SharedPtr<Index> _pIndex;
+};
+
+
+//
+// inlines
+//
+inline std::size_t DocumentView::byteSize() const
+{
+	return _size;
+}
+
+
+inline bool DocumentView::empty() const
+{
+	return _size <= 5;
+}
+
+
+inline bool DocumentView::exists(const std::string& name) const
+{
+	return find(name) != NOT_FOUND;
+}
+
+
+inline bool DocumentView::hasIndex() const
+{
+	return !_pIndex.isNull();
+}
+
+
+inline int DocumentView::type(std::size_t pos) const
+{
+	return static_cast<unsigned char>(data()[pos]);
+}
+
+
+inline const char* DocumentView::data() const
+{
+	return _pBuffer->data();
+}
+
+
+} } // namespace Poco::MongoDB
+
+
+#endif //MongoDB_DocumentView_INCLUDED
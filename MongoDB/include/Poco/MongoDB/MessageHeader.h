@@ -35,6 +35,9 @@ class MongoDB_API MessageHeader
 public:
 	static const unsigned int MSG_HEADER_SIZE = 16;
 
+	static const Int32 MAX_MESSAGE_SIZE = 48000000;
+		/// The maximum message size accepted by MongoDB.
+
 	typedef enum
 	{
 		  Reply = 1
@@ -45,6 +48,7 @@ public:
 		, GetMore = 2005
 		, Delete = 2006
 		, KillCursors = 2007
+		, OpMsg = 2013
 	} OpCode;
 
 	virtual ~MessageHeader();
@@ -71,6 +75,10 @@ public:
 	Int32 responseTo() const;
 		/// Returns the request id from the original request. 
 
+	void setResponseTo(Int32 id);
+		/// Sets the request id of the request this message
+		/// is a response to.
+
 private:
 	MessageHeader(OpCode opcode);
 		/// Constructor.
@@ -123,6 +131,12 @@ inline Int32 MessageHeader::responseTo() const
 }
 
 
+inline void MessageHeader::setResponseTo(Int32 id)
+{
+	_responseTo = id;
+}
+
+
 } } // namespace Poco::MongoDB
 
 
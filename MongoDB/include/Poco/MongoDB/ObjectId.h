@@ -74,6 +74,7 @@ private:
 	friend class BSONWriter;
 	friend class BSONReader;
 	friend class Document;
+	friend class DocumentView;
 	
 	static int fromHex(char c);
 	
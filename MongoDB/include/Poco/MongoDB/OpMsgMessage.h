@@ -0,0 +1,227 @@
+//
+// OpMsgMessage.h
+//
+// $Id$
+//
+// Library: MongoDB
+// Package: MongoDB
+// Module:  OpMsgMessage
+//
+// Definition of the OpMsgMessage class.
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef MongoDB_OpMsgMessage_INCLUDED
+#define MongoDB_OpMsgMessage_INCLUDED
+
+
+#include "Poco/MongoDB/MongoDB.h"
+#include "Poco/MongoDB/Message.h"
+#include "Poco/MongoDB/Document.h"
+#include <istream>
+#include <ostream>
+
+
+namespace Poco {
+namespace MongoDB {
+
+
+class MongoDB_API OpMsgMessage : public Message
+	/// Class that represents an OP_MSG message, the extensible wire
+	/// protocol message used by MongoDB 3.6 and later for commands
+	/// and their replies.
+	///
+	/// An OP_MSG carries a command document (the body) and optionally
+	/// one sequence of documents that belongs to the command, like the
+	/// documents of an insert command. Sending the documents as a
+	/// sequence instead of an array inside the body allows a batched
+	/// insert, update or delete to be sent as a single message without
+	/// building a nested BSON array.
+	///
+	/// The same class is used for requests and replies. OP_MSG replies
+	/// are matched to their requests by request id, so any number of
+	/// requests can be in flight on one Connection (see
+	/// Connection::sendRequest()).
+	///
+	/// Example for a batched insert:
+	///
+	///     OpMsgMessage request("team", "players");
+	///     request.setCommandName(OpMsgMessage::CMD_INSERT);
+	///     request.documents().push_back(player1);
+	///     request.documents().push_back(player2);
+	///
+	///     OpMsgMessage response;
+	///     connection.sendRequest(request, response);
+	///     if (response.responseOk()) ...
+{
+public:
+	typedef SharedPtr<OpMsgMessage> Ptr;
+
+	enum Flags
+	{
+		MSG_FLAGS_DEFAULT    = 0,
+		MSG_CHECKSUM_PRESENT = (1 << 0),
+			/// The message ends with a CRC-32C checksum.
+		MSG_MORE_TO_COME     = (1 << 1),
+			/// The sender will not wait for a reply.
+		MSG_EXHAUST_ALLOWED  = (1 << 16)
+			/// The client is prepared for multiple replies.
+	};
+
+	static const std::string CMD_INSERT;
+	static const std::string CMD_UPDATE;
+	static const std::string CMD_DELETE;
+	static const std::string CMD_FIND;
+	static const std::string CMD_GET_MORE;
+	static const std::string CMD_COUNT;
+	static const std::string CMD_PING;
+
+	OpMsgMessage();
+		/// Creates an empty OpMsgMessage. Use this constructor
+		/// for a message that receives a reply.
+
+	OpMsgMessage(const std::string& databaseName, const std::string& collectionName, UInt32 flags = MSG_FLAGS_DEFAULT);
+		/// Creates an OpMsgMessage for a command on the given collection.
+		/// The collection name must not contain the database name.
+		/// Use an empty collection name for commands that do not
+		/// operate on a collection.
+
+	virtual ~OpMsgMessage();
+		/// Destructor
+
+	const std::string& databaseName() const;
+		/// Returns the name of the database the command is sent to.
+
+	const std::string& collectionName() const;
+		/// Returns the name of the collection the command operates on.
+
+	void setCommandName(const std::string& command);
+		/// Clears the body and the document sequence and starts a new
+		/// command document with the given command name as its first
+		/// element. Its value is the collection name, or 1 if the
+		/// collection name is empty.
+		///
+		/// For the insert, update and delete commands the identifier of
+		/// the document sequence is set to "documents", "updates" and
+		/// "deletes", respectively.
+
+	const std::string& commandName() const;
+		/// Returns the command name.
+
+	UInt32 flags() const;
+		/// Returns the message flags.
+
+	void setFlags(UInt32 flags);
+		/// Sets the message flags.
+
+	Document& body();
+		/// Returns the command document of a request, or the
+		/// reply document of a response.
+
+	Document::Vector& documents();
+		/// Returns the document sequence sent along with the body.
+
+	const std::string& documentsIdentifier() const;
+		/// Returns the identifier of the document sequence, which is
+		/// the name of the command argument the sequence provides.
+
+	void setDocumentsIdentifier(const std::string& identifier);
+		/// Sets the identifier of the document sequence.
+
+	bool responseOk() const;
+		/// Returns true if the body of a reply contains a non-zero
+		/// "ok" element.
+
+	void clear();
+		/// Clears the flags, the body and the document sequence.
+
+	void send(std::ostream& ostr);
+		/// Writes the message to the stream.
+		///
+		/// The "$db" element is added to the body if it is not present.
+		/// The document sequence is only sent if it is not empty.
+
+	void read(std::istream& istr);
+		/// Reads a message from the stream.
+		///
+		/// Throws a ProtocolException if the message is not an OP_MSG
+		/// or contains an unknown section kind. A trailing checksum
+		/// is skipped but not verified.
+
+private:
+	std::string _databaseName;
+	std::string _collectionName;
+	std::string _commandName;
+	UInt32 _flags;
+	Document _body;
+	std::string _documentsIdentifier;
+	Document::Vector _documents;
+};
+
+
+//
+// inlines
+//
+inline const std::string& OpMsgMessage::databaseName() const
+{
+	return _databaseName;
+}
+
+
+inline const std::string& OpMsgMessage::collectionName() const
+{
+	return _collectionName;
+}
+
+
+inline const std::string& OpMsgMessage::commandName() const
+{
+	return _commandName;
+}
+
+
+inline UInt32 OpMsgMessage::flags() const
+{
+	return _flags;
+}
+
+
+inline void OpMsgMessage::setFlags(UInt32 flags)
+{
+	_flags = flags;
+}
+
+
+inline Document& OpMsgMessage::body()
+{
+	return _body;
+}
+
+
+inline Document::Vector& OpMsgMessage::documents()
+{
+	return _documents;
+}
+
+
+inline const std::string& OpMsgMessage::documentsIdentifier() const
+{
+	return _documentsIdentifier;
+}
+
+
+inline void OpMsgMessage::setDocumentsIdentifier(const std::string& identifier)
+{
+	_documentsIdentifier = identifier;
+}
+
+
+} } // namespace Poco::MongoDB
+
+
+#endif //MongoDB_OpMsgMessage_INCLUDED
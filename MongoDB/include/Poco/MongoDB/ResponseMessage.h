@@ -23,6 +23,7 @@
 #include "Poco/MongoDB/MongoDB.h"
 #include "Poco/MongoDB/Message.h"
 #include "Poco/MongoDB/Document.h"
+#include "Poco/MongoDB/DocumentView.h"
 #include <istream>
 
 
@@ -32,6 +33,11 @@ namespace MongoDB {
 
 class MongoDB_API ResponseMessage : public Message
 	/// Class that represents a response (OP_REPLY) from MongoDB
+	///
+	/// The returned documents are kept in the buffer they were
+	/// received in. views() gives access to them without decoding,
+	/// while documents() decodes all of them into Document objects
+	/// on first use.
 {
 public:
 	ResponseMessage();
@@ -50,7 +56,13 @@ public:
 		/// Returns the number of documents in the response
 
 	Document::Vector& documents();
-		/// Returns the retrieved documents
+		/// Returns the retrieved documents. The documents are
+		/// decoded when this method is called for the first time
+		/// after a response has been read.
+
+	const DocumentView::Vector& views() const;
+		/// Returns views on the retrieved documents, which decode
+		/// elements only when they are accessed.
 
 	bool empty() const;
 		/// Returns true when the response doesn't contain any documents
@@ -66,19 +78,21 @@ private:
 	Int64 _cursorID;
 	Int32 _startingFrom;
 	Int32 _numberReturned;
+	DocumentView::Vector _views;
 	Document::Vector _documents;
+	bool _decoded;
 };
 
 
 inline size_t ResponseMessage::count() const
 {
-	return _documents.size();
+	return _decoded ? _documents.size() : _views.size();
 }
 
 
 inline bool ResponseMessage::empty() const
 {
-	return _documents.size() == 0;
+	return count() == 0;
 }
 
 
@@ -88,15 +102,15 @@ inline Int64 ResponseMessage::cursorID() const
 }
 
 
-inline Document::Vector& ResponseMessage::documents()
+inline const DocumentView::Vector& ResponseMessage::views() const
 {
-	return _documents;
+	return _views;
 }
 
 
 inline bool ResponseMessage::hasDocuments() const
 {
-	return _documents.size() > 0;
+	return count() > 0;
 }
 
 
@@ -0,0 +1,268 @@
+//
+// BulkWriter.cpp
+//
+// $Id$
+//
+// Library: MongoDB
+// Package: MongoDB
+// Module:  BulkWriter
+//
+// Implementation of the BulkWriter class.
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/MongoDB/BulkWriter.h"
+#include "Poco/MongoDB/Array.h"
+#include "Poco/CountingStream.h"
+#include "Poco/BinaryWriter.h"
+
+
+namespace Poco {
+namespace MongoDB {
+
+
+namespace
+{
+	const std::size_t MESSAGE_OVERHEAD = 1024;
+		// Space reserved for the message header and the command document.
+}
+
+
+BulkWriter::Result::Result():
+	inserted(0),
+	matched(0),
+	modified(0),
+	upserted(0),
+	deleted(0),
+	batches(0)
+{
+}
+
+
+BulkWriter::BulkWriter(Connection& connection, const std::string& databaseName, const std::string& collectionName, bool ordered):
+	_connection(connection),
+	_databaseName(databaseName),
+	_collectionName(collectionName),
+	_ordered(ordered),
+	_maxBatchSize(DEFAULT_MAX_BATCH_SIZE),
+	_maxMessageSize(DEFAULT_MAX_MESSAGE_SIZE),
+	_maxPipelined(DEFAULT_MAX_PIPELINED)
+{
+}
+
+
+BulkWriter::~BulkWriter()
+{
+}
+
+
+void BulkWriter::insert(Document::Ptr document)
+{
+	add(OP_INSERT, document);
+}
+
+
+void BulkWriter::update(Document::Ptr selector, Document::Ptr update, bool multi, bool upsert)
+{
+	Document::Ptr statement = new Document();
+	statement->add("q", selector);
+	statement->add("u", update);
+	statement->add("multi", multi);
+	statement->add("upsert", upsert);
+	add(OP_UPDATE, statement);
+}
+
+
+void BulkWriter::remove(Document::Ptr selector, bool justOne)
+{
+	Document::Ptr statement = new Document();
+	statement->add("q", selector);
+	statement->add("limit", justOne ? 1 : 0);
+	add(OP_DELETE, statement);
+}
+
+
+void BulkWriter::clear()
+{
+	_operations.clear();
+}
+
+
+void BulkWriter::setMaxBatchSize(std::size_t maxBatchSize)
+{
+	poco_assert (maxBatchSize > 0);
+	_maxBatchSize = maxBatchSize;
+}
+
+
+void BulkWriter::setMaxMessageSize(std::size_t maxMessageSize)
+{
+	_maxMessageSize = maxMessageSize;
+}
+
+
+void BulkWriter::setMaxPipelined(std::size_t maxPipelined)
+{
+	poco_assert (maxPipelined > 0);
+	_maxPipelined = maxPipelined;
+}
+
+
+BulkWriter::Result BulkWriter::execute()
+{
+	_result = Result();
+	Operations operations;
+	operations.swap(_operations);
+
+	std::size_t maxInFlight = _ordered ? 1 : _maxPipelined;
+	std::size_t pos = 0;
+	bool stop = false;
+	Batches inFlight;
+	try
+	{
+		for (;;)
+		{
+			while (!stop && inFlight.size() < maxInFlight)
+			{
+				Batch batch;
+				std::size_t next = pos;
+				if (!nextBatch(operations, next, batch)) break;
+
+				batch.requestID = _connection.postRequest(*batch.pRequest);
+				batch.pRequest = 0;
+				inFlight.push_back(batch);
+				pos = next;
+				++_result.batches;
+			}
+			if (inFlight.empty()) break;
+
+			OpMsgMessage reply;
+			_connection.receiveResponse(inFlight.front().requestID, reply);
+			if (!processReply(inFlight.front(), reply, _result) && _ordered) stop = true;
+			inFlight.pop_front();
+		}
+	}
+	catch (...)
+	{
+		// keep the operations of all batches not acknowledged by the server
+		std::size_t first = inFlight.empty() ? pos : inFlight.front().first;
+		_operations.assign(operations.begin() + first, operations.end());
+		throw;
+	}
+	return _result;
+}
+
+
+void BulkWriter::add(Kind kind, Document::Ptr document)
+{
+	poco_check_ptr (document);
+
+	CountingOutputStream counter;
+	BinaryWriter writer(counter, BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+	document->write(writer);
+	writer.flush();
+
+	Operation operation;
+	operation.kind = kind;
+	operation.document = document;
+	operation.size = counter.chars();
+	_operations.push_back(operation);
+}
+
+
+bool BulkWriter::nextBatch(const Operations& operations, std::size_t& pos, Batch& batch) const
+{
+	if (pos >= operations.size()) return false;
+
+	batch.kind = operations[pos].kind;
+	batch.first = pos;
+	batch.pRequest = new OpMsgMessage(_databaseName, _collectionName);
+	switch (batch.kind)
+	{
+	case OP_INSERT:
+		batch.pRequest->setCommandName(OpMsgMessage::CMD_INSERT);
+		break;
+	case OP_UPDATE:
+		batch.pRequest->setCommandName(OpMsgMessage::CMD_UPDATE);
+		break;
+	case OP_DELETE:
+		batch.pRequest->setCommandName(OpMsgMessage::CMD_DELETE);
+		break;
+	}
+	batch.pRequest->body().add("ordered", _ordered);
+
+	std::size_t maxBytes = _maxMessageSize > MESSAGE_OVERHEAD ? _maxMessageSize - MESSAGE_OVERHEAD : 0;
+	std::size_t bytes = 0;
+	Document::Vector& documents = batch.pRequest->documents();
+	while (pos < operations.size() && operations[pos].kind == batch.kind && documents.size() < _maxBatchSize)
+	{
+		// a single operation exceeding the limit is sent on its own
+		// and rejected by the server
+		if (!documents.empty() && bytes + operations[pos].size > maxBytes) break;
+
+		documents.push_back(operations[pos].document);
+		bytes += operations[pos].size;
+		++pos;
+	}
+	batch.count = pos - batch.first;
+	return true;
+}
+
+
+bool BulkWriter::processReply(const Batch& batch, OpMsgMessage& reply, Result& result)
+{
+	Document& body = reply.body();
+	if (!reply.responseOk())
+	{
+		// the whole command failed
+		WriteError error;
+		error.index = batch.first;
+		error.code = body.get<Int32>("code", 0);
+		error.message = body.get<std::string>("errmsg", std::string());
+		result.errors.push_back(error);
+		return false;
+	}
+
+	std::size_t n = static_cast<std::size_t>(body.get<Int32>("n", 0));
+	switch (batch.kind)
+	{
+	case OP_INSERT:
+		result.inserted += n;
+		break;
+	case OP_UPDATE:
+		{
+			std::size_t upserted = 0;
+			if (body.isType<Array::Ptr>("upserted"))
+				upserted = body.get<Array::Ptr>("upserted")->size();
+			result.upserted += upserted;
+			result.matched += n - upserted;
+			result.modified += static_cast<std::size_t>(body.get<Int32>("nModified", 0));
+		}
+		break;
+	case OP_DELETE:
+		result.deleted += n;
+		break;
+	}
+
+	if (!body.isType<Array::Ptr>("writeErrors")) return true;
+
+	Array::Ptr errors = body.get<Array::Ptr>("writeErrors");
+	for (std::size_t i = 0; i < errors->size(); ++i)
+	{
+		Document::Ptr pError = errors->get<Document::Ptr>(static_cast<int>(i));
+		WriteError error;
+		error.index = batch.first + pError->get<Int32>("index", 0);
+		error.code = pError->get<Int32>("code", 0);
+		error.message = pError->get<std::string>("errmsg", std::string());
+		result.errors.push_back(error);
+	}
+	return errors->size() == 0;
+}
+
+
+} } // namespace Poco::MongoDB
@@ -17,32 +17,38 @@
 
 
 #include "Poco/Net/SocketStream.h"
+#include "Poco/Net/NetException.h"
 #include "Poco/MongoDB/Connection.h"
+#include "Poco/ScopedUnlock.h"
+#include "Poco/ByteOrder.h"
+#include "Poco/Exception.h"
 #include <iostream>
+#include <sstream>
+#include <cstring>
 
 
 namespace Poco {
 namespace MongoDB {
 
 
-Connection::Connection() : _address(), _socket()
+Connection::Connection() : _address(), _socket(), _reading(false)
 {
 }
 
 
-Connection::Connection(const std::string& hostAndPort) : _address(hostAndPort), _socket()
+Connection::Connection(const std::string& hostAndPort) : _address(hostAndPort), _socket(), _reading(false)
 {
 	connect();
 }
 
 
-Connection::Connection(const std::string& host, int port) : _address(host, port), _socket()
+Connection::Connection(const std::string& host, int port) : _address(host, port), _socket(), _reading(false)
 {
 	connect();
 }
 
 
-Connection::Connection(const Net::SocketAddress& addrs) : _address(addrs), _socket()
+Connection::Connection(const Net::SocketAddress& addrs) : _address(addrs), _socket(), _reading(false)
 {
 	connect();
 }
@@ -63,6 +69,9 @@ Connection::~Connection()
 void Connection::connect()
 {
 	_socket.connect(_address);
+
+	FastMutex::ScopedLock lock(_readMutex);
+	_pendingResponses.clear();
 }
 
 
@@ -90,11 +99,17 @@ void Connection::connect(const Net::SocketAddress& addrs)
 void Connection::disconnect()
 {
 	_socket.close();
+
+	FastMutex::ScopedLock lock(_readMutex);
+	_pendingResponses.clear();
 }
 
 
 void Connection::sendRequest(RequestMessage& request)
 {
+	request.header().setRequestID(++_requestID);
+
+	FastMutex::ScopedLock lock(_writeMutex);
 	Net::SocketOutputStream sos(_socket);
 	request.send(sos);
 }
@@ -108,4 +123,130 @@ void Connection::sendRequest(RequestMessage& request, ResponseMessage& response)
 	response.read(sis);
 }
 
+
+void Connection::sendRequest(OpMsgMessage& request)
+{
+	request.setFlags(request.flags() | OpMsgMessage::MSG_MORE_TO_COME);
+	request.header().setRequestID(++_requestID);
+
+	std::ostringstream ostr;
+	request.send(ostr);
+	sendMessage(ostr.str());
+}
+
+
+void Connection::sendRequest(OpMsgMessage& request, OpMsgMessage& response)
+{
+	receiveResponse(postRequest(request), response);
+}
+
+
+Int32 Connection::postRequest(OpMsgMessage& request)
+{
+	request.setFlags(request.flags() & ~OpMsgMessage::MSG_MORE_TO_COME);
+	request.header().setRequestID(++_requestID);
+
+	std::ostringstream ostr;
+	request.send(ostr);
+	sendMessage(ostr.str());
+	return request.header().getRequestID();
+}
+
+
+void Connection::receiveResponse(Int32 requestID, OpMsgMessage& response)
+{
+	std::string message;
+
+	// The first waiting thread reads replies from the socket and hands
+	// replies to other requests over to their threads. When it has
+	// received its own reply, another waiting thread takes over.
+	FastMutex::ScopedLock lock(_readMutex);
+	for (;;)
+	{
+		PendingResponses::iterator it = _pendingResponses.find(requestID);
+		if (it != _pendingResponses.end())
+		{
+			message.swap(it->second);
+			_pendingResponses.erase(it);
+			break;
+		}
+		if (_reading)
+		{
+			_responseReady.wait(_readMutex);
+			continue;
+		}
+
+		_reading = true;
+		Int32 responseTo;
+		try
+		{
+			ScopedUnlock<FastMutex> unlock(_readMutex);
+			responseTo = receiveMessage(message);
+		}
+		catch (...)
+		{
+			_reading = false;
+			_responseReady.broadcast();
+			throw;
+		}
+		_reading = false;
+		_responseReady.broadcast();
+
+		if (responseTo == requestID) break;
+		_pendingResponses[responseTo].swap(message);
+	}
+
+	std::istringstream istr(message);
+	response.read(istr);
+}
+
+
+void Connection::sendMessage(const std::string& message)
+{
+	FastMutex::ScopedLock lock(_writeMutex);
+
+	const char* pData = message.data();
+	int remaining = static_cast<int>(message.size());
+	while (remaining > 0)
+	{
+		int n = _socket.sendBytes(pData, remaining);
+		pData += n;
+		remaining -= n;
+	}
+}
+
+
+Int32 Connection::receiveMessage(std::string& message)
+{
+	char header[MessageHeader::MSG_HEADER_SIZE];
+	receiveBytes(header, sizeof(header));
+
+	Int32 length;
+	Int32 responseTo;
+	std::memcpy(&length, header, sizeof(length));
+	std::memcpy(&responseTo, header + 8, sizeof(responseTo));
+	length = ByteOrder::fromLittleEndian(length);
+	responseTo = ByteOrder::fromLittleEndian(responseTo);
+
+	if (length < static_cast<Int32>(sizeof(header)) || length > MessageHeader::MAX_MESSAGE_SIZE)
+		throw ProtocolException("Invalid MongoDB message length");
+
+	message.assign(header, sizeof(header));
+	message.resize(length);
+	receiveBytes(&message[sizeof(header)], length - static_cast<int>(sizeof(header)));
+	return responseTo;
+}
+
+
+void Connection::receiveBytes(char* buffer, int length)
+{
+	while (length > 0)
+	{
+		int n = _socket.receiveBytes(buffer, length);
+		if (n == 0) throw Net::ConnectionResetException("MongoDB connection closed by peer");
+		buffer += n;
+		length -= n;
+	}
+}
+
 } } // Poco::MongoDB
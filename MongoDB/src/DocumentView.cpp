@@ -0,0 +1,266 @@
+//
+// DocumentView.cpp
+//
+// $Id$
+//
+// Library: MongoDB
+// Package: MongoDB
+// Module:  DocumentView
+//
+// Implementation of the DocumentView class.
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/MongoDB/DocumentView.h"
+#include "Poco/MongoDB/Array.h"
+#include "Poco/ByteOrder.h"
+#include <algorithm>
+#include <cstring>
+
+
+namespace Poco {
+namespace MongoDB {
+
+
+const std::size_t DocumentView::NOT_FOUND = ~std::size_t(0);
+
+
+class DocumentView::IndexCompare
+{
+public:
+	IndexCompare(const char* pData) : _pData(pData)
+	{
+	}
+
+	bool operator()(const IndexEntry& e1, const IndexEntry& e2) const
+	{
+		return std::strcmp(_pData + e1.name, _pData + e2.name) < 0;
+	}
+
+	bool operator()(const IndexEntry& e, const char* name) const
+	{
+		return std::strcmp(_pData + e.name, name) < 0;
+	}
+
+private:
+	const char* _pData;
+};
+
+
+DocumentView::DocumentView() : _offset(0), _size(0)
+{
+}
+
+
+DocumentView::DocumentView(const Buffer& pBuffer, std::size_t offset) : _pBuffer(pBuffer), _offset(offset), _size(0)
+{
+	poco_check_ptr (pBuffer);
+
+	if (_offset + 5 > _pBuffer->size())
+		throw DataFormatException("BSON document exceeds buffer");
+
+	Int32 size = readInt32(_offset);
+	if (size < 5 || _offset + size > _pBuffer->size() || data()[_offset + size - 1] != '\0')
+		throw DataFormatException("Invalid BSON document size");
+
+	_size = static_cast<std::size_t>(size);
+}
+
+
+DocumentView::~DocumentView()
+{
+}
+
+
+std::size_t DocumentView::size() const
+{
+	std::size_t count = 0;
+	if (_size == 0) return count;
+
+	std::size_t end = _offset + _size - 1;
+	for (std::size_t pos = _offset + 4; pos < end; pos = nextElement(pos))
+	{
+		++count;
+	}
+	return count;
+}
+
+
+DocumentView DocumentView::getDocument(const std::string& name) const
+{
+	std::size_t pos = find(name);
+	if (pos == NOT_FOUND)
+		throw NotFoundException(name);
+	if (type(pos) != ElementTraits<Document::Ptr>::TypeId && type(pos) != ElementTraits<Array::Ptr>::TypeId)
+		throw BadCastException("Invalid type mismatch!");
+
+	return DocumentView(_pBuffer, valueOffset(pos));
+}
+
+
+void DocumentView::buildIndex()
+{
+	SharedPtr<Index> pIndex = new Index;
+	if (_size > 0)
+	{
+		std::size_t end = _offset + _size - 1;
+		for (std::size_t pos = _offset + 4; pos < end; pos = nextElement(pos))
+		{
+			IndexEntry entry;
+			entry.name = pos + 1;
+			entry.element = pos;
+			pIndex->push_back(entry);
+		}
+		// stable, so that the first of several elements with the same name is found
+		std::stable_sort(pIndex->begin(), pIndex->end(), IndexCompare(data()));
+	}
+	_pIndex = pIndex;
+}
+
+
+Document::Ptr DocumentView::toDocument() const
+{
+	Document::Ptr pDocument = new Document;
+	if (_size > 0)
+	{
+		MemoryInputStream istr(data() + _offset, _size);
+		BinaryReader reader(istr, BinaryReader::LITTLE_ENDIAN_BYTE_ORDER);
+		pDocument->read(reader);
+	}
+	return pDocument;
+}
+
+
+std::string DocumentView::toString(int indent) const
+{
+	return toDocument()->toString(indent);
+}
+
+
+std::size_t DocumentView::find(const std::string& name) const
+{
+	if (_size == 0) return NOT_FOUND;
+
+	if (_pIndex)
+	{
+		Index::const_iterator it = std::lower_bound(_pIndex->begin(), _pIndex->end(), name.c_str(), IndexCompare(data()));
+		if (it != _pIndex->end() && name == data() + it->name)
+			return it->element;
+		return NOT_FOUND;
+	}
+
+	std::size_t end = _offset + _size - 1;
+	for (std::size_t pos = _offset + 4; pos < end; pos = nextElement(pos))
+	{
+		if (name == data() + pos + 1) return pos;
+	}
+	return NOT_FOUND;
+}
+
+
+std::size_t DocumentView::valueOffset(std::size_t pos) const
+{
+	const char* pName = data() + pos + 1;
+	const char* pEnd = static_cast<const char*>(std::memchr(pName, '\0', _offset + _size - 1 - (pos + 1)));
+	if (!pEnd)
+		throw DataFormatException("Invalid BSON element name");
+
+	return pEnd - data() + 1;
+}
+
+
+std::size_t DocumentView::nextElement(std::size_t pos) const
+{
+	std::size_t value = valueOffset(pos);
+	std::size_t end = _offset + _size - 1;
+	std::size_t length = 0;
+
+	switch (type(pos))
+	{
+	case 0x06: // undefined
+	case 0x0A: // null
+	case 0x7F: // max key
+	case 0xFF: // min key
+		length = 0;
+		break;
+	case 0x08: // boolean
+		length = 1;
+		break;
+	case 0x10: // int32
+		length = 4;
+		break;
+	case 0x01: // double
+	case 0x09: // UTC datetime
+	case 0x11: // timestamp
+	case 0x12: // int64
+		length = 8;
+		break;
+	case 0x07: // ObjectId
+		length = 12;
+		break;
+	case 0x13: // decimal128
+		length = 16;
+		break;
+	case 0x02: // string
+	case 0x0D: // JavaScript code
+	case 0x0E: // symbol
+		length = 4 + readLength(value, end);
+		break;
+	case 0x0C: // DBPointer
+		length = 4 + readLength(value, end) + 12;
+		break;
+	case 0x03: // document
+	case 0x04: // array
+	case 0x0F: // JavaScript code with scope
+		length = readLength(value, end);
+		break;
+	case 0x05: // binary
+		length = 4 + 1 + readLength(value, end);
+		break;
+	case 0x0B: // regular expression: two cstrings
+		{
+			const char* pStart = data() + value;
+			const char* pPattern = static_cast<const char*>(std::memchr(pStart, '\0', end - value));
+			const char* pOptions = pPattern ? static_cast<const char*>(std::memchr(pPattern + 1, '\0', end - (pPattern + 1 - data()))) : 0;
+			if (!pOptions) throw DataFormatException("Invalid BSON regular expression");
+			length = pOptions + 1 - pStart;
+		}
+		break;
+	default:
+		throw DataFormatException("Unsupported BSON element type");
+	}
+
+	if (value + length > end)
+		throw DataFormatException("BSON element exceeds document");
+
+	return value + length;
+}
+
+
+std::size_t DocumentView::readLength(std::size_t pos, std::size_t end) const
+{
+	if (pos + 4 > end)
+		throw DataFormatException("BSON element exceeds document");
+
+	Int32 length = readInt32(pos);
+	if (length < 0)
+		throw DataFormatException("Invalid BSON element length");
+
+	return static_cast<std::size_t>(length);
+}
+
+
+Int32 DocumentView::readInt32(std::size_t pos) const
+{
+	Int32 value;
+	std::memcpy(&value, data() + pos, sizeof(value));
+	return ByteOrder::fromLittleEndian(value);
+}
+
+
+} } // namespace Poco::MongoDB
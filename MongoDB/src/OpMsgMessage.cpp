@@ -0,0 +1,202 @@
+//
+// OpMsgMessage.cpp
+//
+// $Id$
+//
+// Library: MongoDB
+// Package: MongoDB
+// Module:  OpMsgMessage
+//
+// Implementation of the OpMsgMessage class.
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/MongoDB/OpMsgMessage.h"
+#include "Poco/Exception.h"
+#include "Poco/StreamCopier.h"
+#include <sstream>
+
+
+namespace Poco {
+namespace MongoDB {
+
+
+const std::string OpMsgMessage::CMD_INSERT("insert");
+const std::string OpMsgMessage::CMD_UPDATE("update");
+const std::string OpMsgMessage::CMD_DELETE("delete");
+const std::string OpMsgMessage::CMD_FIND("find");
+const std::string OpMsgMessage::CMD_GET_MORE("getMore");
+const std::string OpMsgMessage::CMD_COUNT("count");
+const std::string OpMsgMessage::CMD_PING("ping");
+
+
+OpMsgMessage::OpMsgMessage() : Message(MessageHeader::OpMsg), _flags(MSG_FLAGS_DEFAULT)
+{
+}
+
+
+OpMsgMessage::OpMsgMessage(const std::string& databaseName, const std::string& collectionName, UInt32 flags)
+	: Message(MessageHeader::OpMsg),
+	_databaseName(databaseName),
+	_collectionName(collectionName),
+	_flags(flags)
+{
+}
+
+
+OpMsgMessage::~OpMsgMessage()
+{
+}
+
+
+void OpMsgMessage::setCommandName(const std::string& command)
+{
+	_commandName = command;
+	_body.clear();
+	_documents.clear();
+
+	if (_collectionName.empty())
+		_body.add(_commandName, 1);
+	else
+		_body.add(_commandName, _collectionName);
+
+	if (_commandName == CMD_INSERT)
+		_documentsIdentifier = "documents";
+	else if (_commandName == CMD_UPDATE)
+		_documentsIdentifier = "updates";
+	else if (_commandName == CMD_DELETE)
+		_documentsIdentifier = "deletes";
+	else
+		_documentsIdentifier.clear();
+}
+
+
+bool OpMsgMessage::responseOk() const
+{
+	Element::Ptr ok = _body.get("ok");
+	if (ok.isNull()) return false;
+
+	switch (ok->type())
+	{
+	case ElementTraits<double>::TypeId:
+		return static_cast<ConcreteElement<double>*>(ok.get())->value() != 0;
+	case ElementTraits<Int32>::TypeId:
+		return static_cast<ConcreteElement<Int32>*>(ok.get())->value() != 0;
+	case ElementTraits<Int64>::TypeId:
+		return static_cast<ConcreteElement<Int64>*>(ok.get())->value() != 0;
+	case ElementTraits<bool>::TypeId:
+		return static_cast<ConcreteElement<bool>*>(ok.get())->value();
+	default:
+		return false;
+	}
+}
+
+
+void OpMsgMessage::clear()
+{
+	_flags = MSG_FLAGS_DEFAULT;
+	_body.clear();
+	_documents.clear();
+	_documentsIdentifier.clear();
+}
+
+
+void OpMsgMessage::send(std::ostream& ostr)
+{
+	if (!_databaseName.empty() && !_body.exists("$db"))
+		_body.add("$db", _databaseName);
+
+	std::stringstream ss;
+	BinaryWriter writer(ss, BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+	writer << _flags;
+
+	writer << static_cast<unsigned char>(0); // section kind 0: body
+	_body.write(writer);
+
+	if (!_documents.empty())
+	{
+		std::stringstream sequence;
+		BinaryWriter sequenceWriter(sequence, BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+		BSONWriter(sequenceWriter).writeCString(_documentsIdentifier);
+		for (Document::Vector::iterator it = _documents.begin(); it != _documents.end(); ++it)
+		{
+			(*it)->write(sequenceWriter);
+		}
+		sequenceWriter.flush();
+
+		writer << static_cast<unsigned char>(1); // section kind 1: document sequence
+		writer << static_cast<Int32>(4 + sequence.tellp()); // 4 = size of the length
+		writer.writeRaw(sequence.str());
+	}
+	writer.flush();
+
+	messageLength(static_cast<Poco::Int32>(ss.tellp()));
+
+	BinaryWriter socketWriter(ostr, BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+	_header.write(socketWriter);
+	StreamCopier::copyStream(ss, ostr);
+	ostr.flush();
+}
+
+
+void OpMsgMessage::read(std::istream& istr)
+{
+	clear();
+
+	BinaryReader reader(istr, BinaryReader::LITTLE_ENDIAN_BYTE_ORDER);
+	_header.read(reader);
+
+	if (_header.opCode() != MessageHeader::OpMsg)
+		throw ProtocolException("Not an OP_MSG message");
+
+	Int32 payloadLength = _header.getMessageLength() - MessageHeader::MSG_HEADER_SIZE;
+	if (payloadLength < 5)
+		throw ProtocolException("Invalid OP_MSG message length");
+
+	std::string payload;
+	reader.readRaw(payloadLength, payload);
+	if (!reader.good())
+		throw IOException("Failed to read OP_MSG message");
+
+	std::istringstream payloadStream(payload);
+	BinaryReader payloadReader(payloadStream, BinaryReader::LITTLE_ENDIAN_BYTE_ORDER);
+	payloadReader >> _flags;
+
+	std::streamoff end = payloadLength;
+	if (_flags & MSG_CHECKSUM_PRESENT) end -= 4;
+
+	while (payloadStream.tellg() < end)
+	{
+		unsigned char kind;
+		payloadReader >> kind;
+		if (kind == 0)
+		{
+			_body.read(payloadReader);
+		}
+		else if (kind == 1)
+		{
+			std::streamoff start = payloadStream.tellg();
+			Int32 size;
+			payloadReader >> size;
+			_documentsIdentifier = BSONReader(payloadReader).readCString();
+			while (payloadReader.good() && payloadStream.tellg() < start + size)
+			{
+				Document::Ptr doc = new Document();
+				doc->read(payloadReader);
+				_documents.push_back(doc);
+			}
+		}
+		else throw ProtocolException("Unknown OP_MSG section kind");
+
+		if (!payloadReader.good())
+			throw ProtocolException("Malformed OP_MSG message");
+	}
+}
+
+
+} } // namespace Poco::MongoDB
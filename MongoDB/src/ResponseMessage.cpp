@@ -24,7 +24,7 @@ namespace Poco {
 namespace MongoDB {
 
 
-ResponseMessage::ResponseMessage() : Message(MessageHeader::Reply), _responseFlags(0), _cursorID(0), _startingFrom(0), _numberReturned(0)
+ResponseMessage::ResponseMessage() : Message(MessageHeader::Reply), _responseFlags(0), _cursorID(0), _startingFrom(0), _numberReturned(0), _decoded(true)
 {
 }
 
@@ -40,7 +40,24 @@ void ResponseMessage::clear()
 	_startingFrom = 0;
 	_cursorID = 0;
 	_numberReturned = 0;
+	_views.clear();
 	_documents.clear();
+	_decoded = true;
+}
+
+
+Document::Vector& ResponseMessage::documents()
+{
+	if (!_decoded)
+	{
+		_documents.reserve(_views.size());
+		for (DocumentView::Vector::const_iterator it = _views.begin(); it != _views.end(); ++it)
+		{
+			_documents.push_back(it->toDocument());
+		}
+		_decoded = true;
+	}
+	return _documents;
 }
 
 
@@ -57,12 +74,33 @@ void ResponseMessage::read(std::istream& istr)
 	reader >> _startingFrom;
 	reader >> _numberReturned;
 
+	if (!reader.good())
+		throw IOException("Failed to read from socket");
+
+	// 20 = size of the response flags, cursor id, starting from and number returned
+	if (_header.getMessageLength() > MessageHeader::MAX_MESSAGE_SIZE)
+		throw DataFormatException("MongoDB reply too large");
+	Int32 length = _header.getMessageLength() - MessageHeader::MSG_HEADER_SIZE - 20;
+	// every document takes at least 5 bytes
+	if (length < 0 || _numberReturned < 0 || _numberReturned > length/5)
+		throw DataFormatException("Invalid MongoDB reply");
+
+	DocumentView::Buffer pBuffer = new std::string;
+	reader.readRaw(length, *pBuffer);
+	if (!reader.good())
+		throw IOException("Failed to read from socket");
+
+	_views.reserve(_numberReturned);
+	std::size_t offset = 0;
 	for(int i = 0; i < _numberReturned; ++i)
 	{
-		Document::Ptr doc = new Document();
-		doc->read(reader);
-		_documents.push_back(doc);
+		DocumentView view(pBuffer, offset);
+		if (offset + view.byteSize() > static_cast<std::size_t>(length))
+			throw DataFormatException("BSON document exceeds MongoDB reply");
+		offset += view.byteSize();
+		_views.push_back(view);
 	}
+	_decoded = false;
 }
 
 
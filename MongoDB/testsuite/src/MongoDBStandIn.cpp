@@ -0,0 +1,204 @@
+//
+// MongoDBStandIn.cpp
+//
+// $Id$
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "MongoDBStandIn.h"
+#include "Poco/MongoDB/Array.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Timespan.h"
+#include "Poco/ByteOrder.h"
+#include "Poco/SharedPtr.h"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+
+using Poco::Net::Socket;
+using Poco::Net::StreamSocket;
+using Poco::Net::SocketAddress;
+using Poco::MongoDB::OpMsgMessage;
+
+
+MongoDBStandIn::MongoDBStandIn():
+	_socket(SocketAddress()),
+	_thread("MongoDBStandIn"),
+	_stop(false),
+	_replyBatch(1),
+	_dropAt(0),
+	_requests(0),
+	_documents(0)
+{
+	_thread.start(*this);
+	_ready.wait();
+}
+
+
+MongoDBStandIn::~MongoDBStandIn()
+{
+	_stop = true;
+	_thread.join();
+}
+
+
+Poco::UInt16 MongoDBStandIn::port() const
+{
+	return _socket.address().port();
+}
+
+
+void MongoDBStandIn::setReplyBatch(int batch)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	_replyBatch = batch;
+}
+
+
+void MongoDBStandIn::setDropAt(int request)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	_dropAt = request;
+}
+
+
+int MongoDBStandIn::requests() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return _requests;
+}
+
+
+int MongoDBStandIn::documents() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return _documents;
+}
+
+
+void MongoDBStandIn::run()
+{
+	_ready.set();
+	Poco::Timespan span(250000);
+	while (!_stop)
+	{
+		if (_socket.poll(span, Socket::SELECT_READ))
+		{
+			StreamSocket ss = _socket.acceptConnection();
+			try
+			{
+				std::vector<Poco::SharedPtr<OpMsgMessage> > pending;
+				while (!_stop)
+				{
+					if (!ss.poll(span, Socket::SELECT_READ)) continue;
+
+					std::string message;
+					if (!receiveMessage(ss, message)) break;
+
+					Poco::SharedPtr<OpMsgMessage> pRequest = new OpMsgMessage;
+					std::istringstream istr(message);
+					pRequest->read(istr);
+
+					int replyBatch;
+					bool drop;
+					{
+						Poco::FastMutex::ScopedLock lock(_mutex);
+						++_requests;
+						_documents += static_cast<int>(pRequest->documents().size());
+						replyBatch = _replyBatch;
+						drop = _requests == _dropAt;
+					}
+					if (drop) break;
+					if (pRequest->flags() & OpMsgMessage::MSG_MORE_TO_COME) continue;
+
+					pending.push_back(pRequest);
+					if (static_cast<int>(pending.size()) >= replyBatch)
+					{
+						while (!pending.empty())
+						{
+							reply(ss, *pending.back());
+							pending.pop_back();
+						}
+					}
+				}
+			}
+			catch (Poco::Exception& exc)
+			{
+				std::cerr << "MongoDBStandIn: " << exc.displayText() << std::endl;
+			}
+		}
+	}
+}
+
+
+bool MongoDBStandIn::receiveMessage(StreamSocket& ss, std::string& message)
+{
+	char header[16];
+	int received = 0;
+	while (received < static_cast<int>(sizeof(header)))
+	{
+		int n = ss.receiveBytes(header + received, static_cast<int>(sizeof(header)) - received);
+		if (n == 0) return false;
+		received += n;
+	}
+
+	Poco::Int32 length;
+	std::memcpy(&length, header, sizeof(length));
+	length = Poco::ByteOrder::fromLittleEndian(length);
+
+	message.assign(header, sizeof(header));
+	message.resize(length);
+	while (received < length)
+	{
+		int n = ss.receiveBytes(&message[received], length - received);
+		if (n == 0) return false;
+		received += n;
+	}
+	return true;
+}
+
+
+void MongoDBStandIn::reply(StreamSocket& ss, OpMsgMessage& request)
+{
+	OpMsgMessage response;
+	response.header().setRequestID(request.header().getRequestID() + 1000000);
+	response.header().setResponseTo(request.header().getRequestID());
+
+	// documents with a "fail" element fail like a duplicate key, and
+	// in ordered mode (the default) the remaining documents are skipped
+	bool ordered = request.body().get<bool>("ordered", true);
+	Poco::Int32 n = 0;
+	Poco::MongoDB::Array::Ptr pErrors = new Poco::MongoDB::Array();
+	for (std::size_t i = 0; i < request.documents().size(); ++i)
+	{
+		if (request.documents()[i]->exists("fail"))
+		{
+			Poco::MongoDB::Document::Ptr pError = new Poco::MongoDB::Document();
+			pError->add("index", static_cast<Poco::Int32>(i));
+			pError->add("code", 11000);
+			pError->add("errmsg", std::string("E11000 duplicate key error"));
+			pErrors->add(Poco::NumberFormatter::format(pErrors->size()), pError);
+			if (ordered) break;
+		}
+		else ++n;
+	}
+
+	response.body().add("n", n);
+	if (request.body().exists("update")) response.body().add("nModified", n);
+	if (pErrors->size() > 0) response.body().add("writeErrors", pErrors);
+	std::string tag = request.body().get<std::string>("tag", std::string());
+	if (!tag.empty()) response.body().add("tag", tag);
+	response.body().add("ok", 1.0);
+
+	std::ostringstream ostr;
+	response.send(ostr);
+	std::string data = ostr.str();
+	ss.sendBytes(data.data(), static_cast<int>(data.size()));
+}
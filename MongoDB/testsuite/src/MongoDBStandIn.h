@@ -0,0 +1,95 @@
+//
+// MongoDBStandIn.h
+//
+// $Id$
+//
+// Definition of the MongoDBStandIn class.
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef MongoDBStandIn_INCLUDED
+#define MongoDBStandIn_INCLUDED
+
+
+#include "Poco/MongoDB/MongoDB.h"
+#include "Poco/MongoDB/OpMsgMessage.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Thread.h"
+#include "Poco/Event.h"
+#include "Poco/Mutex.h"
+#include <vector>
+
+
+class MongoDBStandIn: public Poco::Runnable
+	/// A minimal, sequential stand-in for mongod that
+	/// answers OP_MSG requests.
+	///
+	/// Every request is answered with a reply containing
+	/// the number of documents in the request's document
+	/// sequence ("n"), the "tag" string element of the
+	/// request body, if present, and "ok": 1.0. Requests
+	/// with the moreToCome flag are not answered.
+	///
+	/// Documents in the sequence that have a "fail" element
+	/// are reported in "writeErrors", like mongod reports a
+	/// duplicate key. Unless the request body has "ordered":
+	/// false, the documents after a failed one are skipped.
+	///
+	/// To test response matching, the stand-in can be told
+	/// to collect a number of requests and answer them in
+	/// reverse order. To test lost connections, it can be
+	/// told to close the connection instead of answering
+	/// a request.
+{
+public:
+	MongoDBStandIn();
+		/// Creates the MongoDBStandIn.
+
+	~MongoDBStandIn();
+		/// Destroys the MongoDBStandIn.
+
+	Poco::UInt16 port() const;
+		/// Returns the port the stand-in is listening on.
+
+	void setReplyBatch(int batch);
+		/// Sets the number of requests collected before
+		/// they are answered in reverse order. Default is 1.
+
+	void setDropAt(int request);
+		/// Sets the number of the request (counting from 1) at
+		/// which the connection is closed without answering it.
+		/// Default is 0 (never).
+
+	int requests() const;
+		/// Returns the number of requests received.
+
+	int documents() const;
+		/// Returns the number of documents received in
+		/// document sequences.
+
+	void run();
+		/// Does the work.
+
+private:
+	bool receiveMessage(Poco::Net::StreamSocket& ss, std::string& message);
+	void reply(Poco::Net::StreamSocket& ss, Poco::MongoDB::OpMsgMessage& request);
+
+	Poco::Net::ServerSocket _socket;
+	Poco::Thread _thread;
+	Poco::Event  _ready;
+	bool         _stop;
+	int          _replyBatch;
+	int          _dropAt;
+	int          _requests;
+	int          _documents;
+	mutable Poco::FastMutex _mutex;
+};
+
+
+#endif // MongoDBStandIn_INCLUDED
@@ -21,16 +21,56 @@
 #include "Poco/MongoDB/Database.h"
 #include "Poco/MongoDB/Cursor.h"
 #include "Poco/MongoDB/ObjectId.h"
+#include "Poco/MongoDB/OpMsgMessage.h"
+#include "Poco/MongoDB/DocumentView.h"
+#include "Poco/MongoDB/Array.h"
+#include "Poco/MongoDB/BulkWriter.h"
 
 #include "Poco/Net/NetException.h"
+#include "Poco/Thread.h"
+#include "Poco/Stopwatch.h"
+#include "Poco/NumberFormatter.h"
 
 #include "MongoDBTest.h"
+#include "MongoDBStandIn.h"
 #include "CppUnit/TestCaller.h"
 #include "CppUnit/TestSuite.h"
 
 using namespace Poco::MongoDB;
 
 
+namespace
+{
+	class OpMsgRunnable: public Poco::Runnable
+	{
+	public:
+		OpMsgRunnable(Connection& connection, const std::string& tag):
+			_connection(connection),
+			_tag(tag)
+		{
+		}
+
+		void run()
+		{
+			OpMsgMessage request("team", "");
+			request.setCommandName(OpMsgMessage::CMD_PING);
+			request.body().add("tag", _tag);
+			_connection.sendRequest(request, _response);
+		}
+
+		OpMsgMessage& response()
+		{
+			return _response;
+		}
+
+	private:
+		Connection&  _connection;
+		std::string  _tag;
+		OpMsgMessage _response;
+	};
+}
+
+
 bool MongoDBTest::_connected = false;
 Poco::MongoDB::Connection MongoDBTest::_mongo;
 
@@ -410,6 +450,487 @@ void MongoDBTest::testObjectID()
 }
 
 
+void MongoDBTest::testOpMsgMessage()
+{
+	OpMsgMessage request("team", "players");
+	request.setCommandName(OpMsgMessage::CMD_INSERT);
+	request.body().add("ordered", false);
+	for (int i = 0; i < 3; ++i)
+	{
+		Document::Ptr doc = new Document();
+		doc->add("number", i);
+		request.documents().push_back(doc);
+	}
+	request.header().setRequestID(42);
+
+	std::stringstream sstr;
+	request.send(sstr);
+
+	OpMsgMessage copy;
+	copy.read(sstr);
+	assert (copy.header().getRequestID() == 42);
+	assert (copy.flags() == OpMsgMessage::MSG_FLAGS_DEFAULT);
+	assert (copy.body().get<std::string>("insert") == "players");
+	assert (copy.body().get<std::string>("$db") == "team");
+	assert (!copy.body().get<bool>("ordered"));
+	assert (copy.documentsIdentifier() == "documents");
+	assert (copy.documents().size() == 3);
+	assert (copy.documents()[2]->get<Poco::Int32>("number") == 2);
+	assert (!copy.responseOk());
+
+	// the command name must stay the first element of the body
+	std::string body = copy.body().toString();
+	assert (body.find("\"insert\"") == 1);
+}
+
+
+void MongoDBTest::testOpMsgInsert()
+{
+	MongoDBStandIn standIn;
+	Connection connection("localhost", standIn.port());
+
+	Database db("team");
+	Poco::SharedPtr<OpMsgMessage> request = db.createOpMsgMessage("players");
+	request->setCommandName(OpMsgMessage::CMD_INSERT);
+	for (int i = 0; i < 100; ++i)
+	{
+		Document::Ptr doc = new Document();
+		doc->add("number", i);
+		request->documents().push_back(doc);
+	}
+
+	OpMsgMessage response;
+	connection.sendRequest(*request, response);
+	assert (response.responseOk());
+	assert (response.header().responseTo() == request->header().getRequestID());
+	assert (response.body().get<Poco::Int32>("n") == 100);
+	assert (standIn.requests() == 1);
+	assert (standIn.documents() == 100);
+
+	// no reply for a request with the moreToCome flag
+	request->setCommandName(OpMsgMessage::CMD_INSERT);
+	Document::Ptr doc = new Document();
+	doc->add("number", 100);
+	request->documents().push_back(doc);
+	connection.sendRequest(*request);
+	assert (request->flags() & OpMsgMessage::MSG_MORE_TO_COME);
+
+	Poco::SharedPtr<OpMsgMessage> ping = db.createOpMsgMessage();
+	ping->setCommandName(OpMsgMessage::CMD_PING);
+	connection.sendRequest(*ping, response);
+	assert (response.responseOk());
+	assert (response.header().responseTo() == ping->header().getRequestID());
+	assert (standIn.requests() == 3);
+	assert (standIn.documents() == 101);
+}
+
+
+void MongoDBTest::testOpMsgPipelining()
+{
+	MongoDBStandIn standIn;
+	standIn.setReplyBatch(3);
+	Connection connection("localhost", standIn.port());
+
+	std::vector<Poco::Int32> ids;
+	for (int i = 0; i < 3; ++i)
+	{
+		OpMsgMessage request("team", "");
+		request.setCommandName(OpMsgMessage::CMD_PING);
+		request.body().add("tag", Poco::NumberFormatter::format(i));
+		ids.push_back(connection.postRequest(request));
+	}
+
+	// the stand-in replies in reverse order
+	for (int i = 0; i < 3; ++i)
+	{
+		OpMsgMessage response;
+		connection.receiveResponse(ids[i], response);
+		assert (response.responseOk());
+		assert (response.header().responseTo() == ids[i]);
+		assert (response.body().get<std::string>("tag") == Poco::NumberFormatter::format(i));
+	}
+}
+
+
+void MongoDBTest::testOpMsgMultiplexing()
+{
+	const int THREADS = 4;
+
+	MongoDBStandIn standIn;
+	standIn.setReplyBatch(THREADS);
+	Connection connection("localhost", standIn.port());
+
+	std::vector<Poco::SharedPtr<OpMsgRunnable> > runnables;
+	std::vector<Poco::SharedPtr<Poco::Thread> > threads;
+	for (int i = 0; i < THREADS; ++i)
+	{
+		runnables.push_back(new OpMsgRunnable(connection, Poco::NumberFormatter::format(i)));
+		threads.push_back(new Poco::Thread);
+		threads.back()->start(*runnables.back());
+	}
+	for (int i = 0; i < THREADS; ++i)
+	{
+		threads[i]->join();
+		assert (runnables[i]->response().responseOk());
+		assert (runnables[i]->response().body().get<std::string>("tag") == Poco::NumberFormatter::format(i));
+	}
+	assert (standIn.requests() == THREADS);
+}
+
+
+void MongoDBTest::testDocumentView()
+{
+	Document::Ptr address = new Document();
+	address->add("city", std::string("Brussels"));
+	Array::Ptr numbers = new Array();
+	numbers->add("0", 1).add("1", 2);
+
+	Document doc;
+	doc.add("lastname", std::string("Braem"));
+	doc.add("start", 1993);
+	doc.add("score", 3.5);
+	doc.add("active", true);
+	doc.add("big", Poco::Int64(1) << 40);
+	doc.add("unknown", NullValue());
+	doc.add("address", address);
+	doc.add("numbers", numbers);
+
+	std::stringstream sstr;
+	Poco::BinaryWriter writer(sstr, Poco::BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+	writer << Poco::Int32(0); // leading padding, to test a view at an offset
+	doc.write(writer);
+	writer.flush();
+
+	DocumentView::Buffer pBuffer = new std::string(sstr.str());
+	DocumentView view(pBuffer, 4);
+	assert (view.byteSize() == pBuffer->size() - 4);
+	assert (view.size() == 8);
+	assert (!view.empty());
+
+	for (int i = 0; i < 2; ++i)
+	{
+		if (i == 1)
+		{
+			view.buildIndex();
+			assert (view.hasIndex());
+		}
+
+		assert (view.exists("lastname"));
+		assert (!view.exists("firstname"));
+		assert (view.isType<std::string>("lastname"));
+		assert (!view.isType<Poco::Int32>("lastname"));
+		assert (view.get<std::string>("lastname") == "Braem");
+		assert (view.get<Poco::Int32>("start") == 1993);
+		assert (view.get<double>("score") == 3.5);
+		assert (view.get<bool>("active"));
+		assert (view.get<Poco::Int64>("big") == Poco::Int64(1) << 40);
+		assert (view.isType<NullValue>("unknown"));
+		assert (view.get<Poco::Int32>("missing", 42) == 42);
+		assert (view.get<Poco::Int32>("lastname", 42) == 42);
+
+		DocumentView addressView = view.getDocument("address");
+		assert (addressView.get<std::string>("city") == "Brussels");
+		assert (view.get<Document::Ptr>("address")->get<std::string>("city") == "Brussels");
+		assert (view.getDocument("numbers").get<Poco::Int32>("1") == 2);
+
+		try
+		{
+			view.get<std::string>("firstname");
+			fail("must throw");
+		}
+		catch (Poco::NotFoundException&)
+		{
+		}
+		try
+		{
+			view.get<Poco::Int32>("lastname");
+			fail("must throw");
+		}
+		catch (Poco::BadCastException&)
+		{
+		}
+	}
+
+	assert (view.toDocument()->toString() == doc.toString());
+
+	std::string truncated(pBuffer->substr(0, pBuffer->size() - 1));
+	try
+	{
+		DocumentView invalid(new std::string(truncated), 4);
+		fail("must throw");
+	}
+	catch (Poco::DataFormatException&)
+	{
+	}
+}
+
+
+void MongoDBTest::testResponseMessageViews()
+{
+	const int DOCUMENTS = 10000;
+
+	std::stringstream documents;
+	Poco::BinaryWriter docWriter(documents, Poco::BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+	for (int i = 0; i < DOCUMENTS; ++i)
+	{
+		Document doc;
+		doc.add("number", i);
+		doc.add("name", std::string("document ") + Poco::NumberFormatter::format(i));
+		doc.add("value", i * 0.5);
+		doc.write(docWriter);
+	}
+	docWriter.flush();
+	std::string payload = documents.str();
+
+	std::stringstream reply;
+	Poco::BinaryWriter writer(reply, Poco::BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+	writer << Poco::Int32(16 + 20 + static_cast<Poco::Int32>(payload.size())); // message length
+	writer << Poco::Int32(2) << Poco::Int32(1) << Poco::Int32(MessageHeader::Reply);
+	writer << Poco::Int32(0) << Poco::Int64(0) << Poco::Int32(0) << Poco::Int32(DOCUMENTS);
+	writer.writeRaw(payload);
+	writer.flush();
+	std::string message = reply.str();
+
+	ResponseMessage response;
+	std::istringstream viewStream(message);
+	response.read(viewStream);
+	assert (response.count() == DOCUMENTS);
+	Poco::Int64 sum = 0;
+	for (DocumentView::Vector::const_iterator it = response.views().begin(); it != response.views().end(); ++it)
+	{
+		sum += it->get<Poco::Int32>("number");
+	}
+
+	ResponseMessage decoded;
+	std::istringstream documentStream(message);
+	decoded.read(documentStream);
+	Poco::Int64 documentSum = 0;
+	for (Document::Vector::iterator it = decoded.documents().begin(); it != decoded.documents().end(); ++it)
+	{
+		documentSum += (*it)->get<Poco::Int32>("number");
+	}
+
+	assert (sum == documentSum);
+	assert (decoded.count() == DOCUMENTS);
+	assert (decoded.documents()[DOCUMENTS - 1]->get<std::string>("name") == "document 9999");
+
+	std::stringstream tooLarge;
+	Poco::BinaryWriter tooLargeWriter(tooLarge, Poco::BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+	tooLargeWriter << Poco::Int32(MessageHeader::MAX_MESSAGE_SIZE + 1);
+	tooLargeWriter << Poco::Int32(2) << Poco::Int32(1) << Poco::Int32(MessageHeader::Reply);
+	tooLargeWriter << Poco::Int32(0) << Poco::Int64(0) << Poco::Int32(0) << Poco::Int32(1);
+	tooLargeWriter.flush();
+	try
+	{
+		ResponseMessage invalid;
+		invalid.read(tooLarge);
+		fail("must throw");
+	}
+	catch (Poco::DataFormatException&)
+	{
+	}
+
+	std::stringstream tooMany;
+	Poco::BinaryWriter tooManyWriter(tooMany, Poco::BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+	tooManyWriter << Poco::Int32(16 + 20 + static_cast<Poco::Int32>(payload.size()));
+	tooManyWriter << Poco::Int32(2) << Poco::Int32(1) << Poco::Int32(MessageHeader::Reply);
+	tooManyWriter << Poco::Int32(0) << Poco::Int64(0) << Poco::Int32(0) << Poco::Int32(0x7FFFFFFF);
+	tooManyWriter.writeRaw(payload);
+	tooManyWriter.flush();
+	try
+	{
+		ResponseMessage invalid;
+		invalid.read(tooMany);
+		fail("must throw");
+	}
+	catch (Poco::DataFormatException&)
+	{
+	}
+}
+
+
+void MongoDBTest::testBulkWriter()
+{
+	MongoDBStandIn standIn;
+	Connection connection("localhost", standIn.port());
+
+	BulkWriter writer(connection, "team", "numbers");
+	writer.setMaxBatchSize(1000);
+	for (int i = 0; i < 2500; ++i)
+	{
+		Document::Ptr doc = new Document();
+		doc->add("number", i);
+		writer.insert(doc);
+	}
+	Document::Ptr selector = new Document();
+	selector->add("number", 1);
+	Document::Ptr update = new Document();
+	update->addNewDocument("$set").add("number", 2);
+	writer.update(selector, update);
+	writer.remove(selector);
+	writer.remove(selector, true);
+	assert (writer.size() == 2503);
+
+	BulkWriter::Result result = writer.execute();
+	assert (writer.size() == 0);
+	assert (result.errors.empty());
+	assert (result.batches == 5);
+	assert (result.inserted == 2500);
+	assert (result.matched == 1);
+	assert (result.modified == 1);
+	assert (result.deleted == 2);
+	assert (standIn.requests() == 5);
+	assert (standIn.documents() == 2503);
+
+	// split by message size
+	writer.setMaxMessageSize(1024 + 100 * 17);
+	for (int i = 0; i < 1000; ++i)
+	{
+		Document::Ptr doc = new Document();
+		doc->add("number", i); // 17 bytes
+		writer.insert(doc);
+	}
+	result = writer.execute();
+	assert (result.batches == 10);
+	assert (result.inserted == 1000);
+}
+
+
+void MongoDBTest::testBulkWriterErrors()
+{
+	MongoDBStandIn standIn;
+	Connection connection("localhost", standIn.port());
+
+	for (int ordered = 0; ordered < 2; ++ordered)
+	{
+		BulkWriter writer(connection, "team", "numbers", ordered != 0);
+		writer.setMaxBatchSize(10);
+		writer.setMaxPipelined(2);
+		for (int i = 0; i < 50; ++i)
+		{
+			Document::Ptr doc = new Document();
+			doc->add("number", i);
+			if (i == 15 || i == 35) doc->add("fail", true);
+			writer.insert(doc);
+		}
+
+		BulkWriter::Result result = writer.execute();
+		if (ordered)
+		{
+			// the batch with the failed document stops after it, no further batches are sent
+			assert (result.batches == 2);
+			assert (result.inserted == 15);
+			assert (result.errors.size() == 1);
+		}
+		else
+		{
+			assert (result.batches == 5);
+			assert (result.inserted == 48);
+			assert (result.errors.size() == 2);
+			assert (result.errors[1].index == 35);
+		}
+		assert (result.errors[0].index == 15);
+		assert (result.errors[0].code == 11000);
+		assert (!result.errors[0].message.empty());
+	}
+
+	// operations are kept if the connection fails
+	MongoDBStandIn* pStandIn = new MongoDBStandIn;
+	Connection lostConnection("localhost", pStandIn->port());
+	delete pStandIn;
+	BulkWriter writer(lostConnection, "team", "numbers");
+	for (int i = 0; i < 3; ++i)
+	{
+		Document::Ptr doc = new Document();
+		doc->add("number", i);
+		writer.insert(doc);
+	}
+	try
+	{
+		writer.execute();
+		fail("must throw");
+	}
+	catch (Poco::Exception&)
+	{
+	}
+	assert (writer.size() == 3);
+
+	// only the operations not acknowledged are kept if the connection is lost
+	for (int ordered = 0; ordered < 2; ++ordered)
+	{
+		MongoDBStandIn droppingStandIn;
+		droppingStandIn.setDropAt(3);
+		Connection droppedConnection("localhost", droppingStandIn.port());
+		BulkWriter droppedWriter(droppedConnection, "team", "numbers", ordered != 0);
+		droppedWriter.setMaxBatchSize(10);
+		droppedWriter.setMaxPipelined(2);
+		for (int i = 0; i < 50; ++i)
+		{
+			Document::Ptr doc = new Document();
+			doc->add("number", i);
+			droppedWriter.insert(doc);
+		}
+		try
+		{
+			droppedWriter.execute();
+			fail("must throw");
+		}
+		catch (Poco::Exception&)
+		{
+		}
+		assert (droppedWriter.size() == 30);
+		assert (droppedWriter.lastResult().inserted == 20);
+		assert (droppedWriter.lastResult().batches == (ordered ? 3 : 4));
+	}
+}
+
+
+void MongoDBTest::testBulkWriterBenchmark()
+{
+	const int DOCUMENTS = 20000;
+
+	MongoDBStandIn standIn;
+	Connection connection("localhost", standIn.port());
+
+	Poco::Stopwatch sw;
+	sw.start();
+	for (int i = 0; i < DOCUMENTS; ++i)
+	{
+		OpMsgMessage request("team", "numbers");
+		request.setCommandName(OpMsgMessage::CMD_INSERT);
+		Document::Ptr doc = new Document();
+		doc->add("number", i);
+		request.documents().push_back(doc);
+
+		OpMsgMessage response;
+		connection.sendRequest(request, response);
+		assert (response.responseOk());
+	}
+	sw.stop();
+	std::cout << "Single inserts, Time: " << sw.elapsed() / 1000.0 << " [ms]" << std::endl;
+
+	for (int ordered = 1; ordered >= 0; --ordered)
+	{
+		BulkWriter writer(connection, "team", "numbers", ordered != 0);
+		writer.setMaxBatchSize(1000);
+		for (int i = 0; i < DOCUMENTS; ++i)
+		{
+			Document::Ptr doc = new Document();
+			doc->add("number", i);
+			writer.insert(doc);
+		}
+		sw.restart();
+		BulkWriter::Result result = writer.execute();
+		sw.stop();
+		std::cout << (ordered ? "Ordered" : "Unordered") << " bulk inserts, Time: " << sw.elapsed() / 1000.0 << " [ms]" << std::endl;
+
+		assert (result.inserted == DOCUMENTS);
+		assert (result.batches == DOCUMENTS/1000);
+	}
+	assert (standIn.documents() == 3*DOCUMENTS);
+}
+
+
 CppUnit::Test* MongoDBTest::suite()
 {
 	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("MongoDBTest");
@@ -425,6 +946,15 @@ CppUnit::Test* MongoDBTest::suite()
 	CppUnit_addTest(pSuite, MongoDBTest, testBuildInfo);
 	CppUnit_addTest(pSuite, MongoDBTest, testCursorRequest);
 	CppUnit_addTest(pSuite, MongoDBTest, testObjectID);
+	CppUnit_addTest(pSuite, MongoDBTest, testOpMsgMessage);
+	CppUnit_addTest(pSuite, MongoDBTest, testOpMsgInsert);
+	CppUnit_addTest(pSuite, MongoDBTest, testOpMsgPipelining);
+	CppUnit_addTest(pSuite, MongoDBTest, testOpMsgMultiplexing);
+	CppUnit_addTest(pSuite, MongoDBTest, testDocumentView);
+	CppUnit_addTest(pSuite, MongoDBTest, testResponseMessageViews);
+	CppUnit_addTest(pSuite, MongoDBTest, testBulkWriter);
+	CppUnit_addTest(pSuite, MongoDBTest, testBulkWriterErrors);
+	CppUnit_addTest(pSuite, MongoDBTest, testBulkWriterBenchmark);
 
 	return pSuite;
 }
@@ -41,6 +41,15 @@ public:
 	void testConnectionPool();
 	void testCursorRequest();
 	void testObjectID();
+	void testOpMsgMessage();
+	void testOpMsgInsert();
+	void testOpMsgPipelining();
+	void testOpMsgMultiplexing();
+	void testDocumentView();
+	void testResponseMessageViews();
+	void testBulkWriter();
+	void testBulkWriterErrors();
+	void testBulkWriterBenchmark();
 	void setUp();
 	void tearDown();
 
@@ -24,6 +24,7 @@
 #include "Poco/Net/SocketDefs.h"
 #include "Poco/Net/IPAddress.h"
 #include "Poco/Net/HostEntry.h"
+#include "Poco/ActiveResult.h"
 
 
 namespace Poco {
@@ -35,6 +36,8 @@ class Net_API DNS
 	/// domain name service.
 	///
 	/// An internal DNS cache is used to speed up name lookups.
+	/// See DNSCache for how results are cached, and how the
+	/// cache can be configured or disabled.
 {
 public:
 	enum HintFlag
@@ -71,7 +74,26 @@ public:
 		/// Throws a DNSException in case of a general DNS error.
 		///
 		/// Throws an IOException in case of any other error.
-		
+		///
+		/// The result is taken from DNSCache::defaultCache() if
+		/// it is there, and stored in it otherwise, unless the
+		/// cache has been disabled.
+
+	static Poco::ActiveResult<HostEntry> hostByNameAsync(const std::string& hostname, unsigned hintFlags =
+#ifdef POCO_HAVE_ADDRINFO
+		DNS_HINT_AI_CANONNAME | DNS_HINT_AI_ADDRCONFIG
+#else
+		DNS_HINT_NONE
+#endif
+		);
+		/// Returns an ActiveResult for the HostEntry of the host
+		/// with the given name, which is looked up in the background
+		/// by the threads of DNSCache::defaultCache(), so that the
+		/// calling thread does not block.
+		///
+		/// If the lookup fails, the result holds one of the
+		/// exceptions thrown by hostByName().
+
 	static HostEntry hostByAddress(const IPAddress& address, unsigned hintFlags =
 #ifdef POCO_HAVE_ADDRINFO
 		DNS_HINT_AI_CANONNAME | DNS_HINT_AI_ADDRCONFIG
@@ -129,17 +151,17 @@ public:
 		/// has been compiled with -DPOCO_HAVE_LIBRESOLV. Otherwise
 		/// it will do nothing.
 
-	//@ deprecated
 	static void flushCache();
 		/// Flushes the internal DNS cache.
-		///
-		/// As of 1.4.2, the DNS cache is no longer used
-		/// and this method does not do anything.
 		
 	static std::string hostName();
 		/// Returns the host name of this host.
 
 protected:
+	static HostEntry lookupByName(const std::string& hostname, unsigned hintFlags);
+		/// Looks up the host with the given name,
+		/// bypassing the DNS cache.
+
 	static int lastError();
 		/// Returns the code of the last error.
 		
@@ -148,6 +170,8 @@ protected:
 
 	static void aierror(int code, const std::string& arg);
 		/// Throws an exception according to the getaddrinfo() error code.
+
+	friend class DNSCache;
 };
 
 
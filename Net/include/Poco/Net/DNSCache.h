@@ -0,0 +1,244 @@
+//
+// DNSCache.h
+//
+// $Id$
+//
+// Library: Net
+// Package: NetCore
+// Module:  DNSCache
+//
+// Definition of the DNSCache class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_DNSCache_INCLUDED
+#define Net_DNSCache_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HostEntry.h"
+#include "Poco/UniqueExpireLRUCache.h"
+#include "Poco/ActiveResult.h"
+#include "Poco/NotificationQueue.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/AtomicCounter.h"
+#include "Poco/Exception.h"
+#include "Poco/Mutex.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Timespan.h"
+#include <vector>
+#include <map>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API DNSCache: private Poco::Runnable
+	/// A thread-safe, size-limited cache for the results of
+	/// host name lookups.
+	///
+	/// Successful lookups are cached for the time to live.
+	/// After that, an entry is stale. A stale entry is still
+	/// returned for the stale time to live, while it is
+	/// refreshed in the background, so that callers do not
+	/// have to wait for the lookup. Lookups that fail with
+	/// a HostNotFoundException or a NoAddressFoundException
+	/// are cached for the negative time to live, and the
+	/// exception is thrown again for the cached entry. Other
+	/// errors, which are usually temporary, are not cached.
+	/// If the cache is full, the least recently used entry
+	/// is discarded.
+	///
+	/// The system resolver does not report the time to live
+	/// of DNS records, so the same time to live is used for
+	/// all entries.
+	///
+	/// Lookups can also be done asynchronously with
+	/// hostByNameAsync(). They are done by a small number of
+	/// threads owned by the cache, which are started when
+	/// they are needed first. Concurrent lookups of the same
+	/// host name are combined into a single one.
+	///
+	/// DNS::hostByName() uses the cache returned by
+	/// defaultCache(), unless it has been disabled.
+{
+public:
+	enum
+	{
+		DEFAULT_MAX_ENTRIES = 1024,
+		DEFAULT_THREADS = 2
+	};
+
+	DNSCache(std::size_t maxEntries = DEFAULT_MAX_ENTRIES, int threads = DEFAULT_THREADS);
+		/// Creates a DNSCache holding at most the given number
+		/// of entries, which uses the given number of threads
+		/// for asynchronous lookups.
+
+	virtual ~DNSCache();
+		/// Stops the threads and destroys the DNSCache.
+		/// Asynchronous lookups that have not been started
+		/// yet fail with an IOException.
+
+	HostEntry hostByName(const std::string& hostname, unsigned hintFlags);
+		/// Returns the HostEntry for the host with the given name,
+		/// looking it up if it is not in the cache. See
+		/// DNS::hostByName() for the hint flags and the exceptions
+		/// thrown.
+
+	Poco::ActiveResult<HostEntry> hostByNameAsync(const std::string& hostname, unsigned hintFlags);
+		/// Returns an ActiveResult for the HostEntry of the host
+		/// with the given name. If the host is in the cache, the
+		/// result is available immediately. Otherwise the host
+		/// name is looked up by one of the cache's threads.
+		///
+		/// If the lookup fails, the result holds the exception.
+
+	void remove(const std::string& hostname);
+		/// Removes all entries for the given host name.
+
+	void clear();
+		/// Removes all entries from the cache.
+
+	std::size_t size();
+		/// Returns the number of entries in the cache.
+
+	void setEnabled(bool enabled);
+		/// Enables or disables the cache. A disabled cache
+		/// neither returns nor stores entries, but still
+		/// does asynchronous lookups. The cache is enabled
+		/// by default.
+
+	bool isEnabled() const;
+		/// Returns true iff the cache is enabled.
+
+	void setTimeToLive(const Poco::Timespan& ttl);
+		/// Sets the time for which a successful lookup is
+		/// cached. The default is 60 seconds.
+
+	const Poco::Timespan& getTimeToLive() const;
+		/// Returns the time for which a successful lookup
+		/// is cached.
+
+	void setStaleTimeToLive(const Poco::Timespan& ttl);
+		/// Sets the time for which an entry is still returned
+		/// after its time to live, while it is refreshed.
+		/// The default is 30 seconds. Zero disables returning
+		/// stale entries.
+
+	const Poco::Timespan& getStaleTimeToLive() const;
+		/// Returns the time for which an entry is still
+		/// returned after its time to live.
+
+	void setNegativeTimeToLive(const Poco::Timespan& ttl);
+		/// Sets the time for which a failed lookup is
+		/// cached. The default is 5 seconds. Zero disables
+		/// caching of failed lookups.
+
+	const Poco::Timespan& getNegativeTimeToLive() const;
+		/// Returns the time for which a failed lookup
+		/// is cached.
+
+	int lookups() const;
+		/// Returns the number of lookups that have been
+		/// done, which is the number of cache misses
+		/// including refreshes of stale entries.
+
+	static DNSCache& defaultCache();
+		/// Returns the DNSCache used by DNS::hostByName().
+
+protected:
+	virtual HostEntry lookup(const std::string& hostname, unsigned hintFlags);
+		/// Looks up the host with the given name, bypassing
+		/// the cache. The default implementation uses the
+		/// system resolver.
+		///
+		/// Subclasses can override this method to use
+		/// another resolver.
+
+private:
+	DNSCache(const DNSCache&);
+	DNSCache& operator = (const DNSCache&);
+
+	struct Entry
+	{
+		HostEntry                         hostEntry;
+		Poco::SharedPtr<Poco::Exception>  pException;
+		Poco::Timestamp                   fresh;
+		Poco::Timestamp                   expires;
+
+		const Poco::Timestamp& getExpiration() const
+		{
+			return expires;
+		}
+	};
+
+	typedef Poco::UniqueExpireLRUCache<std::string, Entry> Cache;
+	typedef Poco::ActiveResult<HostEntry> Result;
+	typedef std::map<std::string, Result> PendingMap;
+
+	void run();
+	HostEntry resolve(const std::string& key, const std::string& hostname, unsigned hintFlags);
+	void storeFailure(const std::string& key, const Poco::Exception& exc);
+	Result enqueue(const std::string& key, const std::string& hostname, unsigned hintFlags);
+	void startThreads();
+	static std::string makeKey(const std::string& hostname, unsigned hintFlags);
+
+	Cache                      _cache;
+	bool                       _enabled;
+	Poco::Timespan             _ttl;
+	Poco::Timespan             _staleTtl;
+	Poco::Timespan             _negativeTtl;
+	Poco::AtomicCounter        _lookups;
+	PendingMap                 _pending;
+	Poco::NotificationQueue    _queue;
+	int                        _maxThreads;
+	std::vector<Poco::Thread*> _threads;
+	Poco::FastMutex            _mutex;
+};
+
+
+//
+// inlines
+//
+inline bool DNSCache::isEnabled() const
+{
+	return _enabled;
+}
+
+
+inline const Poco::Timespan& DNSCache::getTimeToLive() const
+{
+	return _ttl;
+}
+
+
+inline const Poco::Timespan& DNSCache::getStaleTimeToLive() const
+{
+	return _staleTtl;
+}
+
+
+inline const Poco::Timespan& DNSCache::getNegativeTimeToLive() const
+{
+	return _negativeTtl;
+}
+
+
+inline int DNSCache::lookups() const
+{
+	return _lookups.value();
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_DNSCache_INCLUDED
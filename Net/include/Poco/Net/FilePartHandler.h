@@ -0,0 +1,122 @@
+//
+// FilePartHandler.h
+//
+// $Id$
+//
+// Library: Net
+// Package: Messages
+// Module:  FilePartHandler
+//
+// Definition of the FilePartHandler class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_FilePartHandler_INCLUDED
+#define Net_FilePartHandler_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/PartHandler.h"
+#include <vector>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API FilePartHandler: public PartHandler
+	/// A PartHandler that streams every part it is given
+	/// into a file, so that large uploads do not have
+	/// to be held in memory.
+	///
+	/// For security reasons, the file name given by the sender
+	/// is not used. Every part is stored in a file with a unique
+	/// temporary name in the handler's directory.
+	///
+	/// The files are deleted when the FilePartHandler is destroyed,
+	/// unless keepFiles() has been called. To keep the file of a
+	/// part, it can also be moved elsewhere with File::moveTo().
+{
+public:
+	struct Part
+	{
+		std::string  name;      /// The name of the form field, from the Content-Disposition header.
+		std::string  filename;  /// The file name given by the sender.
+		std::string  mediaType; /// The content type of the part.
+		std::string  path;      /// The path of the file the part has been stored in.
+		Poco::UInt64 size;      /// The size of the part in bytes.
+	};
+
+	typedef std::vector<Part> PartVec;
+
+	FilePartHandler();
+		/// Creates the FilePartHandler, which stores
+		/// the parts in the system's temporary directory.
+
+	explicit FilePartHandler(const std::string& directory);
+		/// Creates the FilePartHandler, which stores
+		/// the parts in the given directory.
+
+	~FilePartHandler();
+		/// Destroys the FilePartHandler and deletes the
+		/// files of the parts, unless keepFiles() has been
+		/// called.
+
+	void handlePart(const MessageHeader& header, std::istream& stream);
+		/// Stores the part in a new file.
+		///
+		/// Throws a MessageException if the part is larger
+		/// than the maximum part size. Throws a FileException
+		/// if the file cannot be written.
+
+	const PartVec& parts() const;
+		/// Returns the parts that have been stored.
+
+	void setMaxPartSize(Poco::UInt64 maxSize);
+		/// Sets the maximum size of a part. Zero, the
+		/// default, means no limit.
+
+	Poco::UInt64 getMaxPartSize() const;
+		/// Returns the maximum size of a part.
+
+	void keepFiles();
+		/// Keeps the files of the parts when the
+		/// FilePartHandler is destroyed.
+
+private:
+	enum
+	{
+		BUFFER_SIZE = 65536
+	};
+
+	std::string  _directory;
+	PartVec      _parts;
+	Poco::UInt64 _maxPartSize;
+	bool         _keepFiles;
+};
+
+
+//
+// inlines
+//
+inline const FilePartHandler::PartVec& FilePartHandler::parts() const
+{
+	return _parts;
+}
+
+
+inline Poco::UInt64 FilePartHandler::getMaxPartSize() const
+{
+	return _maxPartSize;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_FilePartHandler_INCLUDED
@@ -0,0 +1,250 @@
+//
+// HPACK.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HPACK
+//
+// Definition of the HPACKTable, HPACKEncoder and HPACKDecoder classes.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HPACK_INCLUDED
+#define Net_HPACK_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include <deque>
+#include <vector>
+#include <string>
+#include <utility>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API HPACKTable
+	/// The indexing table of the HPACK header compression
+	/// format for HTTP/2 (RFC 7541), consisting of the static
+	/// table and a dynamic table.
+	///
+	/// Indices start at 1. Indices 1 to 61 refer to the static
+	/// table, higher indices to the dynamic table, which holds
+	/// the most recently added field at index 62.
+{
+public:
+	typedef std::pair<std::string, std::string> Field;
+	typedef std::vector<Field> FieldList;
+
+	enum
+	{
+		STATIC_TABLE_LENGTH = 61,
+		DEFAULT_TABLE_SIZE  = 4096,
+		ENTRY_OVERHEAD      = 32
+	};
+
+	explicit HPACKTable(std::size_t maxSize = DEFAULT_TABLE_SIZE);
+		/// Creates the HPACKTable with an empty dynamic
+		/// table of the given maximum size.
+
+	~HPACKTable();
+		/// Destroys the HPACKTable.
+
+	std::size_t length() const;
+		/// Returns the number of entries in the table,
+		/// including the static table.
+
+	std::size_t size() const;
+		/// Returns the size of the dynamic table, as defined
+		/// in RFC 7541, section 4.1.
+
+	std::size_t maxSize() const;
+		/// Returns the maximum size of the dynamic table.
+
+	void setMaxSize(std::size_t maxSize);
+		/// Sets the maximum size of the dynamic table, evicting
+		/// entries if necessary.
+
+	const Field& get(std::size_t index) const;
+		/// Returns the entry with the given index.
+		///
+		/// Throws a HTTP2Exception if the index is invalid.
+
+	void add(const std::string& name, const std::string& value);
+		/// Adds an entry to the dynamic table, evicting
+		/// old entries as necessary.
+
+	std::size_t find(const std::string& name, const std::string& value, bool& valueMatch) const;
+		/// Looks for an entry with the given name, preferring
+		/// one that also has the given value. Returns the index
+		/// of the entry, or 0 if there is none. valueMatch is set
+		/// to true if the entry's value matches as well.
+
+private:
+	HPACKTable(const HPACKTable&);
+	HPACKTable& operator = (const HPACKTable&);
+
+	void evict(std::size_t maxSize);
+
+	std::deque<Field> _entries;
+	std::size_t       _size;
+	std::size_t       _maxSize;
+};
+
+
+class Net_API HPACKEncoder
+	/// This class encodes header lists into HPACK header
+	/// blocks (RFC 7541).
+	///
+	/// Fields are added to the dynamic table, except for
+	/// credentials (authorization, proxy-authorization and
+	/// cookie fields with short values), which are encoded
+	/// as never indexed. String literals are Huffman-encoded
+	/// if this makes them shorter.
+	///
+	/// Header names must be in lowercase.
+{
+public:
+	HPACKEncoder();
+		/// Creates the HPACKEncoder.
+
+	~HPACKEncoder();
+		/// Destroys the HPACKEncoder.
+
+	void encode(const HPACKTable::FieldList& fields, std::string& block);
+		/// Encodes the given fields and appends the
+		/// resulting header block to block.
+
+	void setMaxTableSize(std::size_t maxSize);
+		/// Sets the size of the dynamic table. Called with the
+		/// value of the decoder's SETTINGS_HEADER_TABLE_SIZE
+		/// setting. The new size is signalled to the decoder
+		/// at the beginning of the next header block.
+
+	const HPACKTable& table() const;
+		/// Returns the encoder's indexing table.
+
+	static void encodeInteger(Poco::UInt32 value, int prefixBits, unsigned char flags, std::string& output);
+		/// Encodes an integer with the given prefix length.
+		/// The flags are stored in the bits above the prefix.
+
+	static void encodeString(const std::string& value, std::string& output);
+		/// Encodes a string literal, using Huffman encoding
+		/// unless this makes the result longer.
+
+	static void huffmanEncode(const std::string& value, std::string& output);
+		/// Appends the Huffman-encoded value to output.
+
+	static std::size_t huffmanLength(const std::string& value);
+		/// Returns the length of the Huffman-encoded value.
+
+private:
+	HPACKEncoder(const HPACKEncoder&);
+	HPACKEncoder& operator = (const HPACKEncoder&);
+
+	HPACKTable  _table;
+	std::size_t _pendingSize;
+	bool        _sizeUpdate;
+};
+
+
+class Net_API HPACKDecoder
+	/// This class decodes HPACK header blocks (RFC 7541).
+	///
+	/// Decoding errors are reported with a HTTP2Exception
+	/// having the COMPRESSION_ERROR code. The dynamic table
+	/// is in an undefined state after an error, so the
+	/// connection must be closed.
+{
+public:
+	enum
+	{
+		DEFAULT_MAX_HEADER_LIST_SIZE = 65536
+	};
+
+	HPACKDecoder();
+		/// Creates the HPACKDecoder.
+
+	~HPACKDecoder();
+		/// Destroys the HPACKDecoder.
+
+	void decode(const char* block, std::size_t length, HPACKTable::FieldList& fields);
+		/// Decodes the given header block and appends
+		/// the fields to the given list.
+
+	void setMaxTableSize(std::size_t maxSize);
+		/// Sets the maximum size of the dynamic table the encoder
+		/// may use. This is the value of the decoder's
+		/// SETTINGS_HEADER_TABLE_SIZE setting.
+
+	void setMaxHeaderListSize(std::size_t maxSize);
+		/// Sets the maximum size of a decoded header list,
+		/// as defined for SETTINGS_MAX_HEADER_LIST_SIZE.
+
+	const HPACKTable& table() const;
+		/// Returns the decoder's indexing table.
+
+	static Poco::UInt32 decodeInteger(const unsigned char*& it, const unsigned char* end, int prefixBits);
+		/// Decodes an integer with the given prefix length.
+
+	static void decodeString(const unsigned char*& it, const unsigned char* end, std::string& value);
+		/// Decodes a string literal.
+
+	static void huffmanDecode(const unsigned char* data, std::size_t length, std::string& output);
+		/// Appends the decoded Huffman-encoded data to output.
+
+private:
+	HPACKDecoder(const HPACKDecoder&);
+	HPACKDecoder& operator = (const HPACKDecoder&);
+
+	HPACKTable  _table;
+	std::size_t _maxTableSize;
+	std::size_t _maxHeaderListSize;
+};
+
+
+//
+// inlines
+//
+inline std::size_t HPACKTable::length() const
+{
+	return STATIC_TABLE_LENGTH + _entries.size();
+}
+
+
+inline std::size_t HPACKTable::size() const
+{
+	return _size;
+}
+
+
+inline std::size_t HPACKTable::maxSize() const
+{
+	return _maxSize;
+}
+
+
+inline const HPACKTable& HPACKEncoder::table() const
+{
+	return _table;
+}
+
+
+inline const HPACKTable& HPACKDecoder::table() const
+{
+	return _table;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HPACK_INCLUDED
@@ -193,6 +193,8 @@ public:
 	static const int         UNKNOWN_CONTENT_LENGTH;
 protected:
 	void readUrl(std::istream& istr);
+	void readUrl(const char* begin, const char* end);
+	void readUrl(const char* begin, const char* end, int& fields);
 	void readMultipart(std::istream& istr, PartHandler& handler);
 	void writeUrl(std::ostream& ostr);
 	void writeMultipart(std::ostream& ostr);
@@ -203,7 +205,9 @@ private:
 
 	enum Limits
 	{
-		DFL_FIELD_LIMIT = 100
+		DFL_FIELD_LIMIT  = 100,
+		MAX_NAME_LENGTH  = 1024,
+		MAX_VALUE_LENGTH = 256*1024
 	};
 
 	struct Part
@@ -0,0 +1,136 @@
+//
+// HTTP2ClientSession.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2ClientSession
+//
+// Definition of the HTTP2ClientSession class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTP2ClientSession_INCLUDED
+#define Net_HTTP2ClientSession_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HTTPSession.h"
+#include "Poco/Net/HTTP2Connection.h"
+#include "Poco/Thread.h"
+#include "Poco/RunnableAdapter.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTPRequest;
+class HTTPResponse;
+
+
+class Net_API HTTP2ClientSession: public HTTPSession
+	/// This class implements the client-side of a
+	/// HTTP/2 connection, over which any number of
+	/// requests can be sent concurrently.
+	///
+	/// Each request is sent on a stream of its own, which is
+	/// returned by sendRequest(). The response is received with
+	/// receiveResponse(), and its body can be read with a
+	/// HTTP2InputStream for the stream:
+	///
+	///     HTTP2ClientSession session("localhost", 8080);
+	///     HTTPRequest request(HTTPRequest::HTTP_GET, "/");
+	///     HTTP2Stream::Ptr pStream = session.sendRequest(request);
+	///     HTTPResponse response;
+	///     session.receiveResponse(pStream, response);
+	///     HTTP2InputStream rs(pStream);
+	///
+	/// All methods can be called from multiple threads.
+	/// The session starts a thread that receives frames
+	/// for all streams.
+	///
+	/// A session created with a host and port uses HTTP/2 over
+	/// TCP with prior knowledge (h2c). For HTTP/2 over TLS (h2),
+	/// create the session with a SecureStreamSocket that has
+	/// negotiated "h2" with ALPN. Upgrading a HTTP/1.1 connection
+	/// is not supported on the client side.
+{
+public:
+	HTTP2ClientSession(const std::string& host, Poco::UInt16 port = HTTPSession::HTTP_PORT);
+		/// Creates a HTTP2ClientSession connected to the given host and port.
+
+	explicit HTTP2ClientSession(const StreamSocket& socket);
+		/// Creates a HTTP2ClientSession using the given connected socket.
+
+	~HTTP2ClientSession();
+		/// Closes the connection and destroys the HTTP2ClientSession.
+
+	HTTP2Stream::Ptr sendRequest(const HTTPRequest& request);
+		/// Sends the header of the given request, which
+		/// has no body, on a new stream.
+		///
+		/// Blocks while the server's limit of concurrent
+		/// streams has been reached.
+
+	HTTP2Stream::Ptr sendRequest(const HTTPRequest& request, const std::string& body);
+		/// Sends the given request and request body
+		/// on a new stream.
+
+	HTTP2Stream::Ptr sendRequestHeader(const HTTPRequest& request);
+		/// Sends the header of the given request on a new stream.
+		/// The request body must be written with a HTTP2OutputStream
+		/// for the returned stream, which ends the request when
+		/// it is destroyed.
+
+	void receiveResponse(HTTP2Stream::Ptr pStream, HTTPResponse& response);
+		/// Waits for the final response on the given stream,
+		/// and stores its status and header in response.
+		/// Interim (1xx) responses are skipped.
+		///
+		/// Throws a HTTP2Exception if the stream has been reset,
+		/// for example because the connection has been closed.
+
+	void cancel(HTTP2Stream::Ptr pStream);
+		/// Cancels the given stream.
+
+	void close();
+		/// Sends a GOAWAY frame and closes the connection.
+
+	HTTP2Connection& connection();
+		/// Returns the session's HTTP2Connection.
+
+private:
+	HTTP2ClientSession();
+	HTTP2ClientSession(const HTTP2ClientSession&);
+	HTTP2ClientSession& operator = (const HTTP2ClientSession&);
+
+	void startConnection();
+	void requestHeaders(const HTTPRequest& request, HPACKTable::FieldList& fields) const;
+
+	std::string     _host;
+	HTTP2Connection _connection;
+	Poco::RunnableAdapter<HTTP2Connection> _runnable;
+	Poco::Thread    _thread;
+};
+
+
+//
+// inlines
+//
+inline HTTP2Connection& HTTP2ClientSession::connection()
+{
+	return _connection;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTP2ClientSession_INCLUDED
@@ -0,0 +1,310 @@
+//
+// HTTP2Connection.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2Connection
+//
+// Definition of the HTTP2Connection class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTP2Connection_INCLUDED
+#define Net_HTTP2Connection_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HPACK.h"
+#include "Poco/Net/HTTP2Stream.h"
+#include "Poco/Buffer.h"
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include <map>
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTPSession;
+
+
+class Net_API HTTP2Connection
+	/// This class implements the framing layer of HTTP/2 (RFC 7540)
+	/// on top of a HTTPSession, which supplies the socket and the
+	/// receive buffer.
+	///
+	/// The connection is driven by run(), which reads and processes
+	/// frames until the connection is closed, and must be called
+	/// by a dedicated thread. Streams are read and written by other
+	/// threads, using the stream methods of HTTP2Connection, which
+	/// block as necessary to honor flow control.
+	///
+	/// Stream and connection level flow control is implemented
+	/// as specified. Received data is acknowledged to the peer when
+	/// it has been read from its stream, or discarded, so that the
+	/// connection's receive window bounds the data buffered for all
+	/// streams together. Stream priorities are ignored, and server push
+	/// is not supported: SETTINGS_ENABLE_PUSH is always sent as 0,
+	/// and a PUSH_PROMISE frame is treated as a protocol error.
+{
+public:
+	enum FrameType
+	{
+		FRAME_DATA          = 0x0,
+		FRAME_HEADERS       = 0x1,
+		FRAME_PRIORITY      = 0x2,
+		FRAME_RST_STREAM    = 0x3,
+		FRAME_SETTINGS      = 0x4,
+		FRAME_PUSH_PROMISE  = 0x5,
+		FRAME_PING          = 0x6,
+		FRAME_GOAWAY        = 0x7,
+		FRAME_WINDOW_UPDATE = 0x8,
+		FRAME_CONTINUATION  = 0x9
+	};
+
+	enum FrameFlags
+	{
+		FLAG_END_STREAM  = 0x01,
+		FLAG_ACK         = 0x01,
+		FLAG_END_HEADERS = 0x04,
+		FLAG_PADDED      = 0x08,
+		FLAG_PRIORITY    = 0x20
+	};
+
+	enum SettingsId
+	{
+		SETTINGS_HEADER_TABLE_SIZE      = 0x1,
+		SETTINGS_ENABLE_PUSH            = 0x2,
+		SETTINGS_MAX_CONCURRENT_STREAMS = 0x3,
+		SETTINGS_INITIAL_WINDOW_SIZE    = 0x4,
+		SETTINGS_MAX_FRAME_SIZE         = 0x5,
+		SETTINGS_MAX_HEADER_LIST_SIZE   = 0x6
+	};
+
+	enum ErrorCode
+	{
+		H2_NO_ERROR            = 0x0,
+		H2_PROTOCOL_ERROR      = 0x1,
+		H2_INTERNAL_ERROR      = 0x2,
+		H2_FLOW_CONTROL_ERROR  = 0x3,
+		H2_SETTINGS_TIMEOUT    = 0x4,
+		H2_STREAM_CLOSED       = 0x5,
+		H2_FRAME_SIZE_ERROR    = 0x6,
+		H2_REFUSED_STREAM      = 0x7,
+		H2_CANCEL              = 0x8,
+		H2_COMPRESSION_ERROR   = 0x9,
+		H2_CONNECT_ERROR       = 0xa,
+		H2_ENHANCE_YOUR_CALM   = 0xb,
+		H2_INADEQUATE_SECURITY = 0xc,
+		H2_HTTP_1_1_REQUIRED   = 0xd
+	};
+
+	enum
+	{
+		FRAME_HEADER_SIZE      = 9,
+		DEFAULT_WINDOW_SIZE    = 65535,
+		DEFAULT_FRAME_SIZE     = 16384,
+		MAX_WINDOW_SIZE        = 0x7FFFFFFF,
+		CONNECTION_WINDOW_SIZE = 1048576,
+		MAX_HEADER_BLOCK_SIZE  = 65536
+	};
+
+	struct Net_API Settings
+		/// The HTTP/2 connection settings.
+	{
+		Settings();
+			/// Creates the default settings, as specified in
+			/// RFC 7540, section 6.5.2, except for enablePush,
+			/// which is 0, maxConcurrentStreams, which is 100,
+			/// and maxHeaderListSize, which is 65536.
+
+		Poco::UInt32 headerTableSize;
+		Poco::UInt32 enablePush;
+		Poco::UInt32 maxConcurrentStreams;
+		Poco::UInt32 initialWindowSize;
+		Poco::UInt32 maxFrameSize;
+		Poco::UInt32 maxHeaderListSize;
+	};
+
+	HTTP2Connection(HTTPSession& session, bool server);
+		/// Creates the HTTP2Connection for the server or the
+		/// client end of the given session.
+
+	virtual ~HTTP2Connection();
+		/// Destroys the HTTP2Connection.
+
+	void start(const Settings& settings);
+		/// Sends the connection preface (on the client),
+		/// the given settings and a WINDOW_UPDATE frame
+		/// enlarging the connection's receive window to
+		/// CONNECTION_WINDOW_SIZE.
+
+	void run();
+		/// Reads and processes frames until the connection
+		/// is closed by the peer, shut down, or fails.
+		///
+		/// On return, all streams have been reset and all
+		/// threads waiting for a stream have been woken up.
+
+	void shutdown(Poco::UInt32 errorCode = H2_NO_ERROR);
+		/// Sends a GOAWAY frame. Streams already opened
+		/// by the peer are still processed, new ones are
+		/// refused, and the connection is shut down as
+		/// soon as there are no more streams.
+
+	HTTP2Stream::Ptr openStream(const HPACKTable::FieldList& headers, bool endStream);
+		/// Opens a new stream by sending the given request
+		/// headers (client only). Blocks while the peer's
+		/// limit on concurrent streams has been reached.
+		///
+		/// Throws a HTTP2Exception if the connection has
+		/// been closed or is going away.
+
+	HTTP2Stream::Ptr upgradeStream(const HPACKTable::FieldList& headers, const std::string& settings);
+		/// Creates stream 1 for a request that has been received
+		/// in a HTTP/1.1 upgrade request (server only). The
+		/// stream is half-closed (remote), and the given headers
+		/// are available with receiveHeaders().
+		///
+		/// The settings contain the decoded payload of the
+		/// request's HTTP2-Settings header, which is applied
+		/// as if received in a SETTINGS frame.
+
+	void sendHeaders(HTTP2Stream& stream, const HPACKTable::FieldList& headers, bool endStream);
+		/// Sends a header block on the given stream.
+
+	void sendData(HTTP2Stream& stream, const char* data, std::size_t length, bool endStream);
+		/// Sends data on the given stream, blocking while
+		/// the stream's or the connection's send window
+		/// is exhausted.
+		///
+		/// Throws a HTTP2Exception if the stream has been reset.
+
+	bool receiveHeaders(HTTP2Stream& stream, HPACKTable::FieldList& headers);
+		/// Waits for the next header block on the given stream.
+		/// Returns false if the stream has been closed without
+		/// one.
+		///
+		/// Throws a HTTP2Exception if the stream has been reset.
+
+	int receiveData(HTTP2Stream& stream, char* buffer, int length);
+		/// Waits for data on the given stream, and returns the
+		/// number of bytes copied to buffer, or 0 if the peer
+		/// has closed the stream.
+		///
+		/// Throws a HTTP2Exception if the stream has been reset.
+
+	void resetStream(HTTP2Stream& stream, Poco::UInt32 errorCode = H2_CANCEL);
+		/// Resets the stream by sending a RST_STREAM frame,
+		/// unless the stream has already been closed.
+
+	int activeStreams() const;
+		/// Returns the number of streams that have not been closed.
+
+	bool closed() const;
+		/// Returns true if the connection has been closed.
+
+	HTTPSession& session();
+		/// Returns the connection's session.
+
+	static const std::string PREFACE;
+		/// The client connection preface,
+		/// "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n".
+
+protected:
+	virtual void streamOpened(HTTP2Stream::Ptr pStream);
+		/// Called by run() when the peer has opened a new stream
+		/// with a complete header block (server only).
+		///
+		/// The default implementation resets the stream.
+
+	void readPreface(std::size_t offset);
+		/// Reads the client connection preface, starting at the
+		/// given offset, from the session (server only).
+		///
+		/// Throws a HTTP2Exception if the preface is invalid.
+
+private:
+	typedef std::map<Poco::UInt32, HTTP2Stream::Ptr> StreamMap;
+
+	HTTP2Connection();
+	HTTP2Connection(const HTTP2Connection&);
+	HTTP2Connection& operator = (const HTTP2Connection&);
+
+	bool readFrame(Poco::UInt8& type, Poco::UInt8& flags, Poco::UInt32& streamId);
+	int read(char* buffer, std::size_t length);
+		/// Reads from the session. On a secure socket, reading
+		/// and writing are serialized, as OpenSSL does not allow
+		/// a connection to be used by several threads at once.
+
+	void readFully(char* buffer, std::size_t length);
+	void processFrame(Poco::UInt8 type, Poco::UInt8 flags, Poco::UInt32 streamId);
+	void processData(Poco::UInt8 flags, Poco::UInt32 streamId);
+	void processHeaders(Poco::UInt8 type, Poco::UInt8 flags, Poco::UInt32 streamId);
+	void processHeaderBlock(Poco::UInt32 streamId, bool endStream);
+	void processResetStream(Poco::UInt32 streamId);
+	void processSettings(Poco::UInt8 flags, Poco::UInt32 streamId);
+	void applySettings(const char* data, std::size_t length);
+	void processPing(Poco::UInt8 flags, Poco::UInt32 streamId);
+	void processGoAway(Poco::UInt32 streamId);
+	void processWindowUpdate(Poco::UInt32 streamId);
+	std::size_t stripPadding(Poco::UInt8 flags, std::size_t& offset);
+	void writeFrame(Poco::UInt8 type, Poco::UInt8 flags, Poco::UInt32 streamId, const char* payload, std::size_t length);
+	void writeHeaders(Poco::UInt32 streamId, const HPACKTable::FieldList& headers, bool endStream);
+	void writeResetStream(Poco::UInt32 streamId, Poco::UInt32 errorCode);
+	void writeWindowUpdate(Poco::UInt32 streamId, Poco::UInt32 increment);
+	void writeGoAway(Poco::UInt32 errorCode);
+	void checkStream(const HTTP2Stream& stream) const;
+	void closeStream(HTTP2Stream& stream);
+	void updateReceiveWindow();
+		/// Sends a WINDOW_UPDATE frame for the connection if
+		/// enough received data has been read or discarded.
+
+	HTTPSession&          _session;
+	bool                  _server;
+	Settings              _localSettings;
+	Settings              _peerSettings;
+	StreamMap             _streams;
+	Poco::UInt32          _nextStreamId;
+	Poco::UInt32          _lastPeerStreamId;
+	Poco::Int64           _sendWindow;
+	Poco::Int64           _receiveWindow;
+	Poco::UInt32          _unacknowledged;
+	bool                  _closed;
+	bool                  _goingAway;
+	bool                  _peerGoingAway;
+	HPACKEncoder          _encoder;
+	HPACKDecoder          _decoder;
+	Poco::Buffer<char>    _payload;
+	std::size_t           _payloadLength;
+	std::string           _headerBlock;
+	std::string           _frameBuffer;
+	Poco::UInt32          _headerStreamId;
+	bool                  _headerEndStream;
+	mutable Poco::FastMutex _mutex;
+	Poco::Condition       _condition;
+	Poco::Mutex           _writeMutex;
+};
+
+
+//
+// inlines
+//
+inline HTTPSession& HTTP2Connection::session()
+{
+	return _session;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTP2Connection_INCLUDED
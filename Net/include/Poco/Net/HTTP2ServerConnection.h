@@ -0,0 +1,106 @@
+//
+// HTTP2ServerConnection.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2ServerConnection
+//
+// Definition of the HTTP2ServerConnection class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTP2ServerConnection_INCLUDED
+#define Net_HTTP2ServerConnection_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HTTP2Connection.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTPServerSession;
+class HTTPRequest;
+class HTTPServerResponse;
+
+
+class Net_API HTTP2ServerConnection: public HTTP2Connection
+	/// This class serves a HTTP/2 connection for HTTPServerConnection.
+	///
+	/// Every stream opened by the client is handled by a request
+	/// handler obtained from the HTTPRequestHandlerFactory, exactly
+	/// like a HTTP/1.x request. Handlers run concurrently in threads
+	/// from the server's thread pool. A stream is refused if no
+	/// thread is available.
+{
+public:
+	HTTP2ServerConnection(HTTPServerSession& session, HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory, Poco::ThreadPool& threadPool);
+		/// Creates the HTTP2ServerConnection. The request
+		/// handlers run in threads from the given thread pool.
+
+	~HTTP2ServerConnection();
+		/// Destroys the HTTP2ServerConnection.
+
+	void upgrade(const HTTPRequest& request, HTTPServerResponse& response);
+		/// Sends the 101 Switching Protocols response to an upgrade
+		/// request for which isUpgrade() returned true, and prepares
+		/// the request to be handled on stream 1 by serve().
+
+	void serve();
+		/// Reads the connection preface and processes the
+		/// connection until it is closed. Returns after all
+		/// request handlers have completed.
+
+	static bool isPreface(const HTTPRequest& request);
+		/// Returns true if the given HTTP/1.x request is the
+		/// first part of the HTTP/2 connection preface.
+
+	static bool isUpgrade(const HTTPRequest& request);
+		/// Returns true if the given HTTP/1.1 request asks
+		/// for an upgrade to h2c, and can be upgraded. Requests
+		/// with a body are not upgraded.
+
+	static const std::string UPGRADE_H2C;
+	static const std::string HTTP2_SETTINGS;
+
+protected:
+	void streamOpened(HTTP2Stream::Ptr pStream);
+	void handleStream(HTTP2Stream::Ptr pStream);
+
+private:
+	class StreamHandler;
+
+	HTTPServerSession&             _session;
+	HTTPServerParams::Ptr          _pParams;
+	HTTPRequestHandlerFactory::Ptr _pFactory;
+	Poco::ThreadPool&              _threadPool;
+	HTTP2Stream::Ptr               _pUpgradeStream;
+	SocketAddress                  _clientAddress;
+	SocketAddress                  _serverAddress;
+	int                            _handlers;
+	Poco::FastMutex                _handlerMutex;
+	Poco::Condition                _handlerCondition;
+
+	friend class StreamHandler;
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTP2ServerConnection_INCLUDED
@@ -0,0 +1,117 @@
+//
+// HTTP2ServerRequestImpl.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2ServerRequestImpl
+//
+// Definition of the HTTP2ServerRequestImpl class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTP2ServerRequestImpl_INCLUDED
+#define Net_HTTP2ServerRequestImpl_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTP2Stream.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/AutoPtr.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTP2ServerResponseImpl;
+
+
+class Net_API HTTP2ServerRequestImpl: public HTTPServerRequest
+	/// This subclass of HTTPServerRequest is used for
+	/// representing requests received on a HTTP/2 stream.
+	///
+	/// The pseudo-header fields of the request are mapped to
+	/// the method, URI and Host header, and the request's
+	/// version is "HTTP/2.0".
+{
+public:
+	HTTP2ServerRequestImpl(HTTP2ServerResponseImpl& response, HTTP2Stream::Ptr pStream, const HPACKTable::FieldList& headers, HTTPServerParams* pParams, const SocketAddress& clientAddress, const SocketAddress& serverAddress);
+		/// Creates the HTTP2ServerRequestImpl from the given
+		/// header fields.
+		///
+		/// Throws a MessageException if the request is malformed.
+
+	~HTTP2ServerRequestImpl();
+		/// Destroys the HTTP2ServerRequestImpl.
+
+	std::istream& stream();
+		/// Returns the input stream for reading
+		/// the request body.
+
+	bool expectContinue() const;
+		/// Returns true if the client expects a
+		/// 100 Continue response.
+
+	const SocketAddress& clientAddress() const;
+		/// Returns the client's address.
+
+	const SocketAddress& serverAddress() const;
+		/// Returns the server's address.
+
+	const HTTPServerParams& serverParams() const;
+		/// Returns a reference to the server parameters.
+
+	HTTPServerResponse& response() const;
+		/// Returns a reference to the associated response.
+
+	static const std::string HTTP_2;
+
+private:
+	HTTP2ServerResponseImpl&        _response;
+	HTTP2InputStream                _stream;
+	Poco::AutoPtr<HTTPServerParams> _pParams;
+	SocketAddress                   _clientAddress;
+	SocketAddress                   _serverAddress;
+};
+
+
+//
+// inlines
+//
+inline std::istream& HTTP2ServerRequestImpl::stream()
+{
+	return _stream;
+}
+
+
+inline const SocketAddress& HTTP2ServerRequestImpl::clientAddress() const
+{
+	return _clientAddress;
+}
+
+
+inline const SocketAddress& HTTP2ServerRequestImpl::serverAddress() const
+{
+	return _serverAddress;
+}
+
+
+inline const HTTPServerParams& HTTP2ServerRequestImpl::serverParams() const
+{
+	return *_pParams;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTP2ServerRequestImpl_INCLUDED
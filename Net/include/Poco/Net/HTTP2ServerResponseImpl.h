@@ -0,0 +1,148 @@
+//
+// HTTP2ServerResponseImpl.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2ServerResponseImpl
+//
+// Definition of the HTTP2ServerResponseImpl class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTP2ServerResponseImpl_INCLUDED
+#define Net_HTTP2ServerResponseImpl_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTP2Stream.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTP2ServerRequestImpl;
+
+
+class Net_API HTTP2ServerResponseImpl: public HTTPServerResponse
+	/// This subclass of HTTPServerResponse is used for
+	/// representing responses sent on a HTTP/2 stream.
+	///
+	/// The status is sent as the :status pseudo-header field,
+	/// and header names are converted to lowercase. The reason
+	/// phrase and connection-specific header fields (Connection,
+	/// Keep-Alive, Proxy-Connection, Transfer-Encoding and Upgrade)
+	/// are not sent, as HTTP/2 does not use them. Chunked transfer
+	/// encoding is therefore neither needed nor used.
+	///
+	/// If enabled in the HTTPServerParams, the message
+	/// body is compressed (see HTTPCompression).
+{
+public:
+	HTTP2ServerResponseImpl(HTTP2Stream::Ptr pStream);
+		/// Creates the HTTP2ServerResponseImpl.
+
+	~HTTP2ServerResponseImpl();
+		/// Destroys the HTTP2ServerResponseImpl.
+
+	void sendContinue();
+		/// Sends a 100 Continue response to the
+		/// client.
+
+	std::ostream& send();
+		/// Sends the response header to the client and
+		/// returns an output stream for sending the
+		/// response body.
+		///
+		/// The returned stream is valid until the response
+		/// object is destroyed.
+		///
+		/// Must not be called after sendFile(), sendBuffer()
+		/// or redirect() has been called.
+
+	void sendFile(const std::string& path, const std::string& mediaType);
+		/// Sends the response header to the client, followed
+		/// by the content of the given file.
+		///
+		/// Must not be called after send(), sendBuffer()
+		/// or redirect() has been called.
+		///
+		/// Throws a FileNotFoundException if the file
+		/// cannot be found, or an OpenFileException if
+		/// the file cannot be opened.
+
+	void sendBuffer(const void* pBuffer, std::size_t length);
+		/// Sends the response header to the client, followed
+		/// by the contents of the given buffer.
+		///
+		/// Must not be called after send(), sendFile()
+		/// or redirect() has been called.
+
+	void redirect(const std::string& uri, HTTPStatus status = HTTP_FOUND);
+		/// Sets the status code, which must be one of
+		/// HTTP_MOVED_PERMANENTLY (301), HTTP_FOUND (302),
+		/// or HTTP_SEE_OTHER (303),
+		/// and sets the "Location" header field
+		/// to the given URI, which according to
+		/// the HTTP specification, must be absolute.
+		///
+		/// Must not be called after send() has been called.
+
+	void requireAuthentication(const std::string& realm);
+		/// Sets the status code to 401 (Unauthorized)
+		/// and sets the "WWW-Authenticate" header field
+		/// according to the given realm.
+
+	bool sent() const;
+		/// Returns true if the response (header) has been sent.
+
+	void finish();
+		/// Completes the response after the request handler
+		/// has returned, by sending the header if this has
+		/// not been done yet, and ending the stream.
+
+protected:
+	void attachRequest(HTTP2ServerRequestImpl* pRequest);
+	void sendHeader(bool endStream);
+	bool hasBody() const;
+	std::string contentEncoding(Poco::Int64 length);
+	void sendCompressed(const std::string& data, const std::string& encoding);
+
+private:
+	HTTP2Stream::Ptr        _pStream;
+	HTTP2ServerRequestImpl* _pRequest;
+	std::ostream*           _pOutput;
+	std::ostream*           _pDeflater;
+	bool                    _sent;
+
+	friend class HTTP2ServerRequestImpl;
+};
+
+
+//
+// inlines
+//
+inline bool HTTP2ServerResponseImpl::sent() const
+{
+	return _sent;
+}
+
+
+inline void HTTP2ServerResponseImpl::attachRequest(HTTP2ServerRequestImpl* pRequest)
+{
+	_pRequest = pRequest;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTP2ServerResponseImpl_INCLUDED
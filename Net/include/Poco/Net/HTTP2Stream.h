@@ -0,0 +1,160 @@
+//
+// HTTP2Stream.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2Stream
+//
+// Definition of the HTTP2Stream class and the HTTP/2 stream buffers.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTP2Stream_INCLUDED
+#define Net_HTTP2Stream_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HPACK.h"
+#include "Poco/Net/HTTPBasicStreamBuf.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/AutoPtr.h"
+#include <deque>
+#include <istream>
+#include <ostream>
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTP2Connection;
+
+
+class Net_API HTTP2Stream: public Poco::RefCountedObject
+	/// The state of a single HTTP/2 stream.
+	///
+	/// All state is owned and synchronized by the HTTP2Connection
+	/// the stream belongs to. Reading and writing is done with
+	/// the methods of HTTP2Connection, or with HTTP2InputStream
+	/// and HTTP2OutputStream.
+{
+public:
+	typedef Poco::AutoPtr<HTTP2Stream> Ptr;
+
+	HTTP2Stream(HTTP2Connection& connection, Poco::UInt32 id, Poco::Int64 sendWindow, Poco::Int64 receiveWindow);
+		/// Creates the HTTP2Stream.
+
+	Poco::UInt32 id() const;
+		/// Returns the stream identifier.
+
+	HTTP2Connection& connection() const;
+		/// Returns the connection the stream belongs to.
+
+protected:
+	~HTTP2Stream();
+
+private:
+	HTTP2Stream();
+	HTTP2Stream(const HTTP2Stream&);
+	HTTP2Stream& operator = (const HTTP2Stream&);
+
+	HTTP2Connection& _connection;
+	Poco::UInt32     _id;
+	bool             _localClosed;
+	bool             _remoteClosed;
+	bool             _reset;
+	Poco::UInt32     _errorCode;
+	Poco::Int64      _sendWindow;
+	Poco::Int64      _receiveWindow;
+	Poco::UInt32     _unacknowledged;
+	std::string      _data;
+	std::size_t      _dataOffset;
+	std::deque<HPACKTable::FieldList> _headers;
+
+	friend class HTTP2Connection;
+};
+
+
+class Net_API HTTP2StreamBuf: public HTTPBasicStreamBuf
+	/// This is the streambuf class used for reading and writing
+	/// the body of a HTTP/2 request or response. Every write
+	/// to the device results in a DATA frame.
+{
+public:
+	typedef HTTPBasicStreamBuf::openmode openmode;
+
+	HTTP2StreamBuf(HTTP2Stream::Ptr pStream, openmode mode);
+	~HTTP2StreamBuf();
+	void close();
+
+protected:
+	int readFromDevice(char* buffer, std::streamsize length);
+	int writeToDevice(const char* buffer, std::streamsize length);
+
+private:
+	HTTP2Stream::Ptr _pStream;
+	openmode         _mode;
+	bool             _closed;
+};
+
+
+class Net_API HTTP2IOS: public virtual std::ios
+	/// The base class for HTTP2InputStream and HTTP2OutputStream.
+{
+public:
+	HTTP2IOS(HTTP2Stream::Ptr pStream, HTTP2StreamBuf::openmode mode);
+	~HTTP2IOS();
+	HTTP2StreamBuf* rdbuf();
+
+protected:
+	HTTP2StreamBuf _buf;
+};
+
+
+class Net_API HTTP2InputStream: public HTTP2IOS, public std::istream
+	/// An input stream for reading the body of a
+	/// HTTP/2 request or response.
+{
+public:
+	HTTP2InputStream(HTTP2Stream::Ptr pStream);
+	~HTTP2InputStream();
+};
+
+
+class Net_API HTTP2OutputStream: public HTTP2IOS, public std::ostream
+	/// An output stream for writing the body of a
+	/// HTTP/2 request or response. Destroying the stream
+	/// ends the stream.
+{
+public:
+	HTTP2OutputStream(HTTP2Stream::Ptr pStream);
+	~HTTP2OutputStream();
+};
+
+
+//
+// inlines
+//
+inline Poco::UInt32 HTTP2Stream::id() const
+{
+	return _id;
+}
+
+
+inline HTTP2Connection& HTTP2Stream::connection() const
+{
+	return _connection;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTP2Stream_INCLUDED
@@ -0,0 +1,392 @@
+//
+// HTTPAsyncClient.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPClient
+// Module:  HTTPAsyncClient
+//
+// Definition of the HTTPAsyncClient class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTPAsyncClient_INCLUDED
+#define Net_HTTPAsyncClient_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Net/HostEntry.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/ActiveResult.h"
+#include "Poco/AtomicCounter.h"
+#include "Poco/Exception.h"
+#include "Poco/Event.h"
+#include "Poco/Mutex.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Timespan.h"
+#include <vector>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API HTTPAsyncClient
+	/// This class implements an asynchronous HTTP/1.1 client,
+	/// which sends requests to any number of servers without
+	/// blocking the calling thread.
+	///
+	/// sendRequest() returns an Exchange, which represents the
+	/// request and its response. The response is received by one
+	/// of the client's threads, each of which drives many non-blocking
+	/// connections with a PollSet. When the response has been received
+	/// completely, or the exchange has failed, the optional Callback
+	/// is invoked, and threads waiting for the exchange are woken up:
+	///
+	///     HTTPAsyncClient client;
+	///     HTTPRequest request(HTTPRequest::HTTP_GET, "/", HTTPMessage::HTTP_1_1);
+	///     HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("localhost", 8080, request);
+	///     ...
+	///     pExchange->wait();
+	///     std::cout << pExchange->response().getStatus() << pExchange->responseBody();
+	///
+	/// Connections are kept alive and reused for further requests
+	/// to the same host and port. At most getMaxConnectionsPerHost()
+	/// connections are opened to a server; further requests wait
+	/// until a connection becomes available. Idle connections are
+	/// closed after the keep-alive timeout. If the server closes a
+	/// reused connection without sending a response, a request with
+	/// an idempotent method (GET, HEAD, OPTIONS, TRACE, PUT, DELETE)
+	/// is sent again once on a new connection. Requests with other
+	/// methods, such as POST, fail instead, as the server may have
+	/// processed them.
+	///
+	/// Every exchange has a deadline, which covers resolving the
+	/// host name, waiting for a connection, connecting, sending the
+	/// request and receiving the complete response. An exchange that
+	/// has not completed by then fails with a TimeoutException.
+	///
+	/// Host names are resolved asynchronously with DNS::hostByNameAsync(),
+	/// which caches the results in DNSCache::defaultCache(), so
+	/// sendRequest() never waits for a DNS lookup.
+	///
+	/// Request and response bodies are held in memory.
+	/// Only plain HTTP connections are supported; proxies and
+	/// HTTP/1.1 upgrades are not.
+{
+private:
+	class Loop;
+	class Connection;
+	struct Host;
+
+public:
+	class Callback;
+
+	class Net_API Exchange: public Poco::RefCountedObject
+		/// An Exchange holds a request sent with an HTTPAsyncClient
+		/// and, once it has completed, its response.
+	{
+	public:
+		typedef Poco::AutoPtr<Exchange> Ptr;
+
+		enum State
+		{
+			EXCHANGE_PENDING,   /// The response has not been received yet.
+			EXCHANGE_COMPLETED, /// The response has been received.
+			EXCHANGE_FAILED     /// The exchange has failed or timed out.
+		};
+
+		const std::string& host() const;
+			/// Returns the host the request is sent to.
+
+		Poco::UInt16 port() const;
+			/// Returns the port number the request is sent to.
+
+		const HTTPRequest& request() const;
+			/// Returns the request.
+
+		const std::string& requestBody() const;
+			/// Returns the request body.
+
+		const HTTPResponse& response() const;
+			/// Returns the response. Must only be used after the
+			/// exchange has completed.
+
+		const std::string& responseBody() const;
+			/// Returns the response body. Must only be used after
+			/// the exchange has completed.
+
+		State state() const;
+			/// Returns the state of the exchange.
+
+		bool done() const;
+			/// Returns true iff the exchange has completed or failed.
+
+		void wait();
+			/// Waits until the exchange has completed or failed.
+			/// If it has failed, the exception that caused the
+			/// failure is rethrown.
+
+		bool tryWait(long milliseconds);
+			/// Waits at most the given number of milliseconds for
+			/// the exchange to complete or fail. Returns true if
+			/// the exchange has completed, false if it has not
+			/// completed yet. If it has failed, the exception that
+			/// caused the failure is rethrown.
+
+		const Poco::Exception* exception() const;
+			/// Returns the exception that caused the exchange to
+			/// fail, or null if the exchange has not failed.
+
+	protected:
+		~Exchange();
+
+	private:
+		typedef Poco::SharedPtr<Poco::ActiveResult<HostEntry> > LookupPtr;
+
+		Exchange(const std::string& host, Poco::UInt16 port, const HTTPRequest& request, const std::string& body, Callback* pCallback, const Poco::Timestamp& deadline);
+		Exchange();
+		Exchange(const Exchange&);
+		Exchange& operator = (const Exchange&);
+
+		std::string        _host;
+		Poco::UInt16       _port;
+		SocketAddress      _address;
+		LookupPtr          _pLookup;
+		HTTPRequest        _request;
+		std::string        _requestBody;
+		HTTPResponse       _response;
+		std::string        _responseBody;
+		Callback*          _pCallback;
+		Poco::Timestamp    _deadline;
+		bool               _retried;
+		volatile State     _state;
+		Poco::Exception*   _pException;
+		Poco::Event        _done;
+
+		friend class HTTPAsyncClient;
+		friend class HTTPAsyncClient::Loop;
+		friend class HTTPAsyncClient::Connection;
+	};
+
+	class Net_API Callback
+		/// The interface for objects that are notified
+		/// when an exchange has completed or failed.
+	{
+	public:
+		virtual ~Callback();
+
+		virtual void exchangeCompleted(Exchange& exchange) = 0;
+			/// Called when the given exchange has completed or failed.
+			///
+			/// This method is called by one of the client's threads,
+			/// which drives many other exchanges as well, and must
+			/// therefore not block. It may send further requests.
+	};
+
+	enum
+	{
+		DEFAULT_THREADS = 1,
+		DEFAULT_MAX_CONNECTIONS_PER_HOST = 32
+	};
+
+	explicit HTTPAsyncClient(int threads = DEFAULT_THREADS);
+		/// Creates a HTTPAsyncClient with the given
+		/// number of threads, and starts the threads.
+		///
+		/// Each thread serves the connections to a part
+		/// of the servers the client sends requests to.
+
+	~HTTPAsyncClient();
+		/// Closes the client and destroys it.
+
+	Exchange::Ptr sendRequest(const std::string& host, Poco::UInt16 port, const HTTPRequest& request, const std::string& body = "", Callback* pCallback = 0);
+		/// Sends the given request, with the given body,
+		/// to the given host and port, and returns the
+		/// Exchange for it. The deadline of the exchange is
+		/// given by the client's timeout.
+		///
+		/// If the request has no Host header, it is added. The
+		/// Content-Length header is set if the body is not empty.
+		/// Unless the request has a Connection header, it is
+		/// sent on a persistent connection.
+		///
+		/// If given, the callback, which must remain valid until
+		/// it has been invoked, is notified when the exchange has
+		/// completed or failed. The callback is always invoked by
+		/// one of the client's threads, even if the host name
+		/// cannot be resolved.
+		///
+		/// Throws an IllegalStateException if the client has
+		/// been closed.
+
+	Exchange::Ptr sendRequest(const std::string& host, Poco::UInt16 port, const HTTPRequest& request, const std::string& body, Callback* pCallback, const Poco::Timespan& timeout);
+		/// Sends the given request like the other overload,
+		/// with a deadline given by the given timeout.
+
+	void close();
+		/// Closes all connections and stops the client's threads.
+		/// Exchanges that have not completed fail with an
+		/// IOException.
+
+	void setTimeout(const Poco::Timespan& timeout);
+		/// Sets the default timeout for exchanges.
+		/// The default is 30 seconds.
+
+	const Poco::Timespan& getTimeout() const;
+		/// Returns the default timeout for exchanges.
+
+	void setKeepAliveTimeout(const Poco::Timespan& timeout);
+		/// Sets the time after which idle connections
+		/// are closed. The default is 8 seconds.
+
+	const Poco::Timespan& getKeepAliveTimeout() const;
+		/// Returns the time after which idle connections
+		/// are closed.
+
+	void setMaxConnectionsPerHost(int maxConnections);
+		/// Sets the maximum number of connections opened
+		/// to a single host and port.
+
+	int getMaxConnectionsPerHost() const;
+		/// Returns the maximum number of connections opened
+		/// to a single host and port.
+
+	int pending() const;
+		/// Returns the number of exchanges that
+		/// have not completed or failed yet.
+
+	int connections() const;
+		/// Returns the number of connections that
+		/// are currently open.
+
+	int connectionsOpened() const;
+		/// Returns the total number of connections
+		/// that have been opened by the client.
+
+private:
+	HTTPAsyncClient(const HTTPAsyncClient&);
+	HTTPAsyncClient& operator = (const HTTPAsyncClient&);
+
+	void finishExchange(Exchange::Ptr pExchange, const Poco::Exception* pException);
+
+	std::vector<Loop*>  _loops;
+	Poco::Timespan      _timeout;
+	Poco::Timespan      _keepAliveTimeout;
+	int                 _maxConnectionsPerHost;
+	Poco::AtomicCounter _pending;
+	Poco::AtomicCounter _connections;
+	Poco::AtomicCounter _connectionsOpened;
+	bool                _closed;
+	mutable Poco::FastMutex _mutex;
+};
+
+
+//
+// inlines
+//
+inline const std::string& HTTPAsyncClient::Exchange::host() const
+{
+	return _host;
+}
+
+
+inline Poco::UInt16 HTTPAsyncClient::Exchange::port() const
+{
+	return _port;
+}
+
+
+inline const HTTPRequest& HTTPAsyncClient::Exchange::request() const
+{
+	return _request;
+}
+
+
+inline const std::string& HTTPAsyncClient::Exchange::requestBody() const
+{
+	return _requestBody;
+}
+
+
+inline const HTTPResponse& HTTPAsyncClient::Exchange::response() const
+{
+	return _response;
+}
+
+
+inline const std::string& HTTPAsyncClient::Exchange::responseBody() const
+{
+	return _responseBody;
+}
+
+
+inline HTTPAsyncClient::Exchange::State HTTPAsyncClient::Exchange::state() const
+{
+	return _state;
+}
+
+
+inline bool HTTPAsyncClient::Exchange::done() const
+{
+	return _state != EXCHANGE_PENDING;
+}
+
+
+inline const Poco::Exception* HTTPAsyncClient::Exchange::exception() const
+{
+	return _state == EXCHANGE_FAILED ? _pException : 0;
+}
+
+
+inline const Poco::Timespan& HTTPAsyncClient::getTimeout() const
+{
+	return _timeout;
+}
+
+
+inline const Poco::Timespan& HTTPAsyncClient::getKeepAliveTimeout() const
+{
+	return _keepAliveTimeout;
+}
+
+
+inline int HTTPAsyncClient::getMaxConnectionsPerHost() const
+{
+	return _maxConnectionsPerHost;
+}
+
+
+inline int HTTPAsyncClient::pending() const
+{
+	return _pending.value();
+}
+
+
+inline int HTTPAsyncClient::connections() const
+{
+	return _connections.value();
+}
+
+
+inline int HTTPAsyncClient::connectionsOpened() const
+{
+	return _connectionsOpened.value();
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTPAsyncClient_INCLUDED
@@ -49,6 +49,10 @@ public:
 protected:
 	int readFromDevice(char* buffer, std::streamsize length);
 	int writeToDevice(const char* buffer, std::streamsize length);
+	int sync();
+		/// Writes the buffered data as a chunk. Unless the session
+		/// defers its output, output held back in the session, such
+		/// as the message header, is sent as well.
 
 private:
 	HTTPSession&    _session;
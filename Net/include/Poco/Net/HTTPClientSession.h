@@ -24,6 +24,7 @@
 #include "Poco/Net/HTTPSession.h"
 #include "Poco/Net/SocketAddress.h"
 #include "Poco/SharedPtr.h"
+#include <deque>
 #include <istream>
 #include <ostream>
 
@@ -56,6 +57,15 @@ class Net_API HTTPClientSession: public HTTPSession
 	/// This will return an input stream that can be used to
 	/// read the response body.
 	///
+	/// If persistent connections are enabled, several requests
+	/// can be sent before the first response is received
+	/// (HTTP pipelining). Each call to receiveResponse() then
+	/// returns the response to the oldest request whose response
+	/// has not been received yet. Requests sent this way are
+	/// collected in a buffer and sent with as few writes as
+	/// possible. If the server closes the connection, the
+	/// outstanding requests must be sent again.
+	///
 	/// See RFC 2616 <http://www.faqs.org/rfcs/rfc2616.html> for more
 	/// information about the HTTP protocol.
 	///
@@ -195,6 +205,12 @@ public:
 		/// receiveResponse() is called or the session
 		/// is destroyed.
 		///
+		/// If persistent connections are enabled and the
+		/// responses to previous requests have not been received
+		/// yet, the request is pipelined on the same connection.
+		/// The stream for the previous request body then becomes
+		/// invalid.
+		///
 		/// In case a network or server failure happens
 		/// while writing the request body to the returned stream,
 		/// the stream state will change to bad or fail. In this
@@ -219,6 +235,10 @@ public:
 		/// part of the next request's response header, resulting
 		/// in a Poco::Net::MessageException being thrown.
 		///
+		/// With pipelined requests, the unread part of the
+		/// previous response body is skipped, and the stream
+		/// for it becomes invalid.
+		///
 		/// In case a network or server failure happens
 		/// while reading the response body from the returned stream,
 		/// the stream state will change to bad or fail. In this
@@ -227,6 +247,10 @@ public:
 		/// to ensure a new connection will be set up
 		/// for the next request.
 		
+	int pendingResponses() const;
+		/// Returns the number of requests sent whose
+		/// responses have not been received yet.
+
 	void reset();
 		/// Resets the session and closes the socket.
 		///
@@ -291,6 +315,7 @@ private:
 	bool            _reconnect;
 	bool            _mustReconnect;
 	bool            _expectResponseBody;
+	std::deque<bool> _pipeline;
 	Poco::SharedPtr<std::ostream> _pRequestStream;
 	Poco::SharedPtr<std::istream> _pResponseStream;
 
@@ -360,6 +385,12 @@ inline const Poco::Timespan& HTTPClientSession::getKeepAliveTimeout() const
 }
 
 
+inline int HTTPClientSession::pendingResponses() const
+{
+	return static_cast<int>(_pipeline.size());
+}
+
+
 } } // namespace Poco::Net
 
 
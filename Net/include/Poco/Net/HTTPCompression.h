@@ -0,0 +1,105 @@
+//
+// HTTPCompression.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPCompression
+//
+// Definition of the HTTPCompression class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTPCompression_INCLUDED
+#define Net_HTTPCompression_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/DeflatingStream.h"
+#include <vector>
+#include <istream>
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTPServerRequest;
+class HTTPResponse;
+
+
+class Net_API HTTPCompression
+	/// This class implements the content coding negotiation
+	/// and compression of response bodies, which HTTPServer
+	/// performs if enabled with HTTPServerParams::setCompressionEnabled().
+	///
+	/// Responses are compressed with gzip or deflate, if
+	///   - the client accepts one of these codings, according
+	///     to the Accept-Encoding header of the request,
+	///   - the response is successful (2xx, except 204 and 206),
+	///   - its content type is one of the compressed media types,
+	///   - no Content-Encoding has been set by the handler, and
+	///   - the body is not shorter than the minimum compression
+	///     size, if its length is known in advance.
+	///
+	/// A HEAD request is answered with the same headers as the
+	/// corresponding GET request. A strong entity tag set by the
+	/// handler is weakened if the response is compressed.
+{
+public:
+	static std::string negotiate(const std::string& acceptEncoding);
+		/// Returns the content coding preferred by a client with
+		/// the given Accept-Encoding header, which is GZIP, DEFLATE,
+		/// or an empty string if the client accepts neither.
+		/// GZIP is chosen if both codings are equally acceptable.
+
+	static bool isCompressible(const std::string& contentType, const std::vector<std::string>& mediaTypes);
+		/// Returns true iff the media type of the given content type
+		/// matches one of the given media types. A media type
+		/// of the form "type/*" matches all subtypes of type.
+
+	static std::string encodingFor(const HTTPServerRequest& request, HTTPResponse& response, Poco::Int64 length);
+		/// Returns the content coding to use for the response to
+		/// the given request, or an empty string if the response
+		/// must not be compressed. The length of the response body
+		/// must be given, or -1 if it is not known yet.
+		///
+		/// Adds "Accept-Encoding" to the Vary header of responses
+		/// with a compressible content type.
+
+	static void compress(const char* data, std::size_t length, const std::string& encoding, int level, std::string& output);
+		/// Compresses the given data with the given content coding
+		/// and compression level, and stores the result in output.
+
+	static void compress(std::istream& istr, const std::string& encoding, int level, std::string& output);
+		/// Compresses the data read from istr with the given content
+		/// coding and compression level, and stores the result in output.
+
+	static Poco::DeflatingStreamBuf::StreamType streamType(const std::string& encoding);
+		/// Returns the stream type for DeflatingOutputStream
+		/// corresponding to the given content coding.
+
+	static const std::string GZIP;
+	static const std::string DEFLATE;
+	static const std::string ACCEPT_ENCODING;
+	static const std::string CONTENT_ENCODING;
+	static const std::string VARY;
+	static const std::string ETAG;
+
+private:
+	HTTPCompression();
+	HTTPCompression(const HTTPCompression&);
+	HTTPCompression& operator = (const HTTPCompression&);
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTPCompression_INCLUDED
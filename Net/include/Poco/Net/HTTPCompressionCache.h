@@ -0,0 +1,109 @@
+//
+// HTTPCompressionCache.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPCompression
+//
+// Definition of the HTTPCompressionCache class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTPCompressionCache_INCLUDED
+#define Net_HTTPCompressionCache_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/LRUCache.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Timestamp.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API HTTPCompressionCache
+	/// A cache of compressed files, which HTTPServerResponse::sendFile()
+	/// uses if response compression is enabled in HTTPServerParams.
+	///
+	/// Entries are keyed by path and content coding. An entry is
+	/// compressed again if the modification time or size of the file
+	/// has changed. If the cache is full, the least recently used
+	/// entry is discarded. Files larger than the maximum file size
+	/// are not cached.
+	///
+	/// HTTPCompressionCache is thread-safe.
+{
+public:
+	typedef Poco::SharedPtr<HTTPCompressionCache> Ptr;
+	typedef Poco::SharedPtr<std::string> DataPtr;
+
+	enum
+	{
+		DEFAULT_MAX_ENTRIES = 256,
+		DEFAULT_MAX_FILE_SIZE = 1024*1024
+	};
+
+	HTTPCompressionCache(std::size_t maxEntries = DEFAULT_MAX_ENTRIES, std::size_t maxFileSize = DEFAULT_MAX_FILE_SIZE);
+		/// Creates the HTTPCompressionCache.
+
+	~HTTPCompressionCache();
+		/// Destroys the HTTPCompressionCache.
+
+	DataPtr get(const std::string& path, const Poco::Timestamp& modified, Poco::UInt64 size, const std::string& encoding, int level);
+		/// Returns the file with the given path, modification time and size,
+		/// compressed with the given content coding and compression level.
+		/// Compresses and caches the file if it is not in the cache,
+		/// or if the cached entry is outdated.
+		///
+		/// Returns null if the file is larger than the maximum file size.
+		///
+		/// Throws an OpenFileException if the file cannot be opened.
+
+	void clear();
+		/// Removes all entries from the cache.
+
+	std::size_t size();
+		/// Returns the number of entries in the cache.
+
+	std::size_t maxFileSize() const;
+		/// Returns the maximum size of a cached file.
+
+private:
+	struct Entry
+	{
+		Poco::Timestamp modified;
+		Poco::UInt64 size;
+		int level;
+		DataPtr pData;
+	};
+
+	HTTPCompressionCache(const HTTPCompressionCache&);
+	HTTPCompressionCache& operator = (const HTTPCompressionCache&);
+
+	Poco::LRUCache<std::string, Entry> _cache;
+	std::size_t _maxFileSize;
+};
+
+
+//
+// inlines
+//
+inline std::size_t HTTPCompressionCache::maxFileSize() const
+{
+	return _maxFileSize;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTPCompressionCache_INCLUDED
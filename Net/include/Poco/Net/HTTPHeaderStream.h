@@ -50,8 +50,10 @@ protected:
 	int writeToDevice(const char* buffer, std::streamsize length);
 
 private:
-	HTTPSession& _session;
-	bool         _end;
+	HTTPSession&    _session;
+	bool            _end;
+	std::streamsize _lineLength;
+	char            _firstChar;
 };
 
 
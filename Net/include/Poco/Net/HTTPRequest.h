@@ -22,6 +22,7 @@
 
 #include "Poco/Net/Net.h"
 #include "Poco/Net/HTTPMessage.h"
+#include "Poco/URIView.h"
 
 
 namespace Poco {
@@ -65,6 +66,15 @@ public:
 		
 	const std::string& getURI() const;
 		/// Returns the request URI.
+
+	const Poco::URIView& getURIView() const;
+		/// Returns a URIView of the request URI.
+		///
+		/// The request URI is parsed on the first call only.
+		/// The URIView remains valid until the URI is changed.
+		///
+		/// Throws a SyntaxException if the request URI
+		/// is not valid.
 		
 	void setHost(const std::string& host);
 		/// Sets the value of the Host header field.
@@ -165,6 +175,8 @@ private:
 	
 	std::string _method;
 	std::string _uri;
+	mutable Poco::URIView _uriView;
+	mutable bool _uriViewValid;
 	
 	HTTPRequest(const HTTPRequest&);
 	HTTPRequest& operator = (const HTTPRequest&);
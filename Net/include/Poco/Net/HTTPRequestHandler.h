@@ -40,10 +40,13 @@ class Net_API HTTPRequestHandler
 	///
 	/// The handleRequest() method must perform the complete handling
 	/// of the HTTP request connection. As soon as the handleRequest() 
-	/// method returns, the request handler object is destroyed.
+	/// method returns, the request handler object is given back to
+	/// the factory, which by default destroys it.
 	///
-	/// A new HTTPRequestHandler object will be created for
+	/// Usually, a new HTTPRequestHandler object will be created for
 	/// each new HTTP request that is received by the HTTPServer.
+	/// Factories like HTTPRouter reuse handler objects instead,
+	/// so their handleRequest() method must be thread-safe.
 {
 public:
 	HTTPRequestHandler();
@@ -41,6 +41,32 @@ class Net_API HTTPRequestHandlerFactory
 {
 public:
 	typedef Poco::SharedPtr<HTTPRequestHandlerFactory> Ptr;
+
+	class Net_API ScopedHandler
+		/// Obtains a request handler from a HTTPRequestHandlerFactory,
+		/// and gives it back to the factory when destroyed.
+	{
+	public:
+		ScopedHandler(HTTPRequestHandlerFactory& factory, const HTTPServerRequest& request);
+			/// Calls createRequestHandler() for the given request.
+
+		~ScopedHandler();
+			/// Calls releaseRequestHandler() for the handler.
+
+		HTTPRequestHandler* get() const;
+			/// Returns the handler, which may be null.
+
+		HTTPRequestHandler* operator -> () const;
+			/// Returns the handler.
+
+	private:
+		ScopedHandler();
+		ScopedHandler(const ScopedHandler&);
+		ScopedHandler& operator = (const ScopedHandler&);
+
+		HTTPRequestHandlerFactory& _factory;
+		HTTPRequestHandler* _pHandler;
+	};
 	
 	HTTPRequestHandlerFactory();
 		/// Creates the HTTPRequestHandlerFactory.
@@ -52,6 +78,16 @@ public:
 		/// Must be overridden by sublasses.
 		///
 		/// Creates a new request handler for the given HTTP request.
+		///
+		/// Factories that override releaseRequestHandler() can
+		/// also return an existing handler object, which may then
+		/// be used by several threads at the same time.
+
+	virtual void releaseRequestHandler(HTTPRequestHandler* pHandler);
+		/// Called by the server with the handler returned by
+		/// createRequestHandler() after the request has been handled.
+		///
+		/// The default implementation deletes the handler.
 
 protected:
 	Poco::BasicEvent<const bool> serverStopped;
@@ -65,6 +101,21 @@ private:
 };
 
 
+//
+// inlines
+//
+inline HTTPRequestHandler* HTTPRequestHandlerFactory::ScopedHandler::get() const
+{
+	return _pHandler;
+}
+
+
+inline HTTPRequestHandler* HTTPRequestHandlerFactory::ScopedHandler::operator -> () const
+{
+	return _pHandler;
+}
+
+
 } } // namespace Poco::Net
 
 
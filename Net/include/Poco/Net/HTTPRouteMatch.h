@@ -0,0 +1,157 @@
+//
+// HTTPRouteMatch.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPRouter
+//
+// Definition of the HTTPRouteMatch class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTPRouteMatch_INCLUDED
+#define Net_HTTPRouteMatch_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include <cstddef>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API HTTPRouteMatch
+	/// The result of matching a request path against
+	/// the routes of a HTTPRouter.
+	///
+	/// The parameter values captured from the path are stored
+	/// as positions in the request URI, so matching a request
+	/// does not allocate memory. The request URI must therefore
+	/// not change while the HTTPRouteMatch is in use.
+	///
+	/// Parameter values are returned as they appear in the
+	/// URI, without any percent-decoding.
+{
+public:
+	enum
+	{
+		MAX_PARAMETERS = 16
+			/// The maximum number of parameters in a route.
+	};
+
+	HTTPRouteMatch();
+		/// Creates an empty HTTPRouteMatch.
+
+	~HTTPRouteMatch();
+		/// Destroys the HTTPRouteMatch.
+
+	const std::string& pattern() const;
+		/// Returns the pattern of the matched route,
+		/// or an empty string if no route has matched.
+
+	std::size_t count() const;
+		/// Returns the number of captured parameters.
+
+	const std::string& name(std::size_t index) const;
+		/// Returns the name of the parameter with the given index.
+
+	std::string value(std::size_t index) const;
+		/// Returns the value of the parameter with the given index.
+
+	const char* data(std::size_t index) const;
+		/// Returns a pointer to the value of the parameter
+		/// with the given index, within the request URI.
+		/// The value is not null-terminated.
+
+	std::size_t length(std::size_t index) const;
+		/// Returns the length of the value of the parameter
+		/// with the given index.
+
+	bool has(const std::string& name) const;
+		/// Returns true iff a parameter with the given name
+		/// has been captured.
+
+	std::string get(const std::string& name) const;
+		/// Returns the value of the parameter with the given name.
+		///
+		/// Throws a NotFoundException if no such parameter
+		/// has been captured.
+
+	std::string get(const std::string& name, const std::string& defaultValue) const;
+		/// Returns the value of the parameter with the given name,
+		/// or defaultValue if no such parameter has been captured.
+
+	const std::string& allowedMethods() const;
+		/// If the path matches a route, but not for the request
+		/// method, returns the methods allowed for the path as a
+		/// comma-separated list, suitable for an Allow header.
+		/// Otherwise, returns an empty string.
+
+	void clear();
+		/// Clears the HTTPRouteMatch.
+
+private:
+	struct Parameter
+	{
+		const std::string* pName;
+		std::size_t offset;
+		std::size_t length;
+	};
+
+	std::size_t find(const std::string& name) const;
+
+	const std::string* _pURI;
+	const std::string* _pPattern;
+	const std::string* _pAllowedMethods;
+	std::size_t _count;
+	Parameter _parameters[MAX_PARAMETERS];
+
+	friend class HTTPRouter;
+};
+
+
+//
+// inlines
+//
+inline std::size_t HTTPRouteMatch::count() const
+{
+	return _count;
+}
+
+
+inline const std::string& HTTPRouteMatch::name(std::size_t index) const
+{
+	poco_assert (index < _count);
+
+	return *_parameters[index].pName;
+}
+
+
+inline const char* HTTPRouteMatch::data(std::size_t index) const
+{
+	poco_assert (index < _count);
+
+	return _pURI->data() + _parameters[index].offset;
+}
+
+
+inline std::size_t HTTPRouteMatch::length(std::size_t index) const
+{
+	poco_assert (index < _count);
+
+	return _parameters[index].length;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTPRouteMatch_INCLUDED
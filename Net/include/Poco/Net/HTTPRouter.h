@@ -0,0 +1,135 @@
+//
+// HTTPRouter.h
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPRouter
+//
+// Definition of the HTTPRouter class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTPRouter_INCLUDED
+#define Net_HTTPRouter_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRouteMatch.h"
+#include "Poco/SharedPtr.h"
+#include <vector>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API HTTPRouter: public HTTPRequestHandlerFactory
+	/// A HTTPRequestHandlerFactory that dispatches requests
+	/// to handlers based on the request path and method.
+	///
+	/// Routes are stored in a radix tree, so the time needed
+	/// to find the handler for a request depends on the length
+	/// of the request path, not on the number of routes.
+	///
+	/// A route pattern is a path that can contain parameters:
+	///   - {name} matches a single, non-empty path segment.
+	///   - {name*} matches the rest of the path, which may be
+	///     empty or contain slashes. It must be the last
+	///     segment of the pattern.
+	/// For example, "/users/{id}/orders" matches "/users/42/orders",
+	/// and "/static/{path*}" matches "/static/css/site.css".
+	/// A path segment that matches a route literally takes
+	/// precedence over a parameter.
+	///
+	/// Handler objects are not created per request. Every route
+	/// has a handler object, which is used for all requests to
+	/// the route, possibly from several threads at the same time.
+	/// The parameters captured for the current request can be
+	/// obtained in the handler with HTTPRouter::currentMatch():
+	///
+	///     void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+	///     {
+	///         std::string id = HTTPRouter::currentMatch().get("id");
+	///         ...
+	///     }
+	///
+	/// A request to a path without route is handled by the
+	/// not-found handler, which by default sends a 404 response.
+	/// If the path has routes, but not for the request method,
+	/// a 405 response is sent. HEAD requests are handled by the
+	/// handler for GET, unless a handler for HEAD exists.
+	///
+	/// All routes must be added before the router is used
+	/// by a HTTPServer.
+{
+public:
+	typedef Poco::SharedPtr<HTTPRequestHandler> HandlerPtr;
+
+	HTTPRouter();
+		/// Creates an empty HTTPRouter.
+
+	~HTTPRouter();
+		/// Destroys the HTTPRouter and its handlers.
+
+	void addRoute(const std::string& method, const std::string& pattern, HandlerPtr pHandler);
+		/// Adds a route for the given method and pattern.
+		/// The method ANY_METHOD matches all methods without a
+		/// route of their own. The same handler can be used for
+		/// several routes.
+		///
+		/// Throws an InvalidArgumentException if the pattern is
+		/// invalid, or if it uses a different parameter name than
+		/// an existing route at the same position. Throws an
+		/// ExistsException if the route already exists.
+
+	void setNotFoundHandler(HandlerPtr pHandler);
+		/// Sets the handler for requests to paths without a route.
+
+	bool match(const std::string& method, const std::string& uri, HTTPRouteMatch& match) const;
+		/// Finds the route for the given method and request URI.
+		/// Returns true if a route has been found, and stores the
+		/// captured parameters in match.
+
+	HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request);
+		/// Returns the handler for the request.
+
+	void releaseRequestHandler(HTTPRequestHandler* pHandler);
+		/// Does nothing, as handlers are owned by the router.
+
+	static const HTTPRouteMatch& currentMatch();
+		/// Returns the match for the request that is
+		/// currently handled by the calling thread.
+
+	static const std::string ANY_METHOD;
+
+private:
+	struct Node;
+
+	HTTPRouter(const HTTPRouter&);
+	HTTPRouter& operator = (const HTTPRouter&);
+
+	HTTPRequestHandler* route(const std::string& method, const std::string& uri, HTTPRouteMatch& match) const;
+	static Node* insert(Node* pNode, const std::string& pattern);
+	static Node* insertStatic(Node* pNode, const std::string& pattern, std::size_t pos, std::size_t end);
+	static const Node* find(const Node* pNode, const std::string& uri, std::size_t pos, std::size_t end, HTTPRouteMatch& match);
+
+	Node* _pRoot;
+	std::vector<HandlerPtr> _handlers;
+	HandlerPtr _pNotFoundHandler;
+	HandlerPtr _pMethodNotAllowedHandler;
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTPRouter_INCLUDED
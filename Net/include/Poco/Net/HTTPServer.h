@@ -79,7 +79,9 @@ public:
 		///
 		/// The server also takes ownership of the HTTPServerParams object.
 		///
-		/// New threads are taken from the given thread pool.
+		/// New threads are taken from the given thread pool. This
+		/// includes the threads for the request handlers of HTTP/2
+		/// streams.
 
 	~HTTPServer();
 		/// Destroys the HTTPServer and its HTTPRequestHandlerFactory.
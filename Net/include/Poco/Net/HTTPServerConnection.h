@@ -25,6 +25,7 @@
 #include "Poco/Net/HTTPResponse.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
 #include "Poco/Net/HTTPServerParams.h"
+#include "Poco/ThreadPool.h"
 #include "Poco/Mutex.h"
 
 
@@ -42,6 +43,15 @@ class Net_API HTTPServerConnection: public TCPServerConnection
 public:
 	HTTPServerConnection(const StreamSocket& socket, HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory);
 		/// Creates the HTTPServerConnection.
+		///
+		/// The request handlers for HTTP/2 streams run in
+		/// threads from the default thread pool.
+
+	HTTPServerConnection(const StreamSocket& socket, HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory, Poco::ThreadPool& threadPool);
+		/// Creates the HTTPServerConnection.
+		///
+		/// The request handlers for HTTP/2 streams run in
+		/// threads from the given thread pool.
 
 	virtual ~HTTPServerConnection();
 		/// Destroys the HTTPServerConnection.
@@ -56,6 +66,7 @@ protected:
 private:
 	HTTPServerParams::Ptr          _pParams;
 	HTTPRequestHandlerFactory::Ptr _pFactory;
+	Poco::ThreadPool&              _threadPool;
 	bool _stopped;
 	Poco::FastMutex _mutex;
 };
@@ -24,6 +24,7 @@
 #include "Poco/Net/TCPServerConnectionFactory.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
 #include "Poco/Net/HTTPServerParams.h"
+#include "Poco/ThreadPool.h"
 
 
 namespace Poco {
@@ -37,6 +38,15 @@ class Net_API HTTPServerConnectionFactory: public TCPServerConnectionFactory
 public:
 	HTTPServerConnectionFactory(HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory);
 		/// Creates the HTTPServerConnectionFactory.
+		///
+		/// The request handlers for HTTP/2 streams run in
+		/// threads from the default thread pool.
+
+	HTTPServerConnectionFactory(HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory, Poco::ThreadPool& threadPool);
+		/// Creates the HTTPServerConnectionFactory.
+		///
+		/// The request handlers for HTTP/2 streams run in
+		/// threads from the given thread pool.
 
 	~HTTPServerConnectionFactory();
 		/// Destroys the HTTPServerConnectionFactory.
@@ -48,6 +58,7 @@ public:
 private:
 	HTTPServerParams::Ptr          _pParams;
 	HTTPRequestHandlerFactory::Ptr _pFactory;
+	Poco::ThreadPool&              _threadPool;
 };
 
 
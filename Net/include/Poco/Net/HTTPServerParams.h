@@ -22,6 +22,8 @@
 
 #include "Poco/Net/Net.h"
 #include "Poco/Net/TCPServerParams.h"
+#include "Poco/Net/HTTPCompressionCache.h"
+#include <vector>
 
 
 namespace Poco {
@@ -45,6 +47,15 @@ public:
 		///   - keepAlive:            true
 		///   - maxKeepAliveRequests: 0
 		///   - keepAliveTimeout:     10 seconds
+		///   - http2Enabled:         false
+		///   - maxConcurrentStreams: 100
+		///   - compressionEnabled:   false
+		///   - compressionLevel:     6
+		///   - fileCompressionLevel: 9
+		///   - minCompressionSize:   1024
+		///   - compressedMediaTypes: text/*, application/json, application/javascript,
+		///                           application/xml, image/svg+xml
+		///   - compressionCache:     a HTTPCompressionCache with default settings
 		
 	void setServerName(const std::string& serverName);
 		/// Sets the name and port (name:port) that the server uses to identify itself.
@@ -97,6 +108,82 @@ public:
 		/// during a persistent connection, or 0 if
 		/// unlimited connections are allowed.
 
+	void setHTTP2Enabled(bool enabled);
+		/// Enables (enabled == true) or disables (enabled == false)
+		/// HTTP/2.
+		///
+		/// If enabled, the server accepts HTTP/2 connections
+		/// started with the HTTP/2 connection preface, either
+		/// directly (prior knowledge, or after TLS negotiated "h2"
+		/// with ALPN), or after a HTTP/1.1 request upgrading the
+		/// connection to "h2c".
+
+	bool getHTTP2Enabled() const;
+		/// Returns true iff HTTP/2 is enabled.
+
+	void setMaxConcurrentStreams(int maxConcurrentStreams);
+		/// Sets the maximum number of concurrent streams a
+		/// client may open on a HTTP/2 connection.
+
+	int getMaxConcurrentStreams() const;
+		/// Returns the maximum number of concurrent streams
+		/// on a HTTP/2 connection.
+
+	void setCompressionEnabled(bool enabled);
+		/// Enables (enabled == true) or disables (enabled == false)
+		/// the compression of response bodies.
+		///
+		/// If enabled, responses sent with send(), sendFile() or
+		/// sendBuffer() are compressed with gzip or deflate if the
+		/// client accepts it. See HTTPCompression for the details.
+		/// Bodies of unknown length sent with send() are compressed
+		/// as they are written, using chunked transfer encoding, so
+		/// the connection can be kept alive. Such bodies are only
+		/// compressed for HTTP/1.1 clients.
+
+	bool getCompressionEnabled() const;
+		/// Returns true iff response compression is enabled.
+
+	void setCompressionLevel(int level);
+		/// Sets the compression level (1 - 9) for bodies
+		/// sent with send() or sendBuffer().
+
+	int getCompressionLevel() const;
+		/// Returns the compression level for bodies
+		/// sent with send() or sendBuffer().
+
+	void setFileCompressionLevel(int level);
+		/// Sets the compression level (1 - 9) for files sent with
+		/// sendFile(). As compressed files are cached, this is
+		/// usually higher than the compression level.
+
+	int getFileCompressionLevel() const;
+		/// Returns the compression level for files sent with sendFile().
+
+	void setMinCompressionSize(int size);
+		/// Sets the minimum length of a response body in bytes
+		/// for compression. Shorter bodies are not compressed,
+		/// as compression would not save enough to be worth it.
+
+	int getMinCompressionSize() const;
+		/// Returns the minimum length of a response body
+		/// in bytes for compression.
+
+	void setCompressedMediaTypes(const std::vector<std::string>& mediaTypes);
+		/// Sets the media types of responses to compress.
+		/// A media type of the form "type/*" matches
+		/// all subtypes of type.
+
+	const std::vector<std::string>& getCompressedMediaTypes() const;
+		/// Returns the media types of responses to compress.
+
+	void setCompressionCache(HTTPCompressionCache::Ptr pCache);
+		/// Sets the cache of compressed files used by sendFile().
+		/// If null, files are compressed for every request.
+
+	HTTPCompressionCache::Ptr getCompressionCache() const;
+		/// Returns the cache of compressed files used by sendFile().
+
 protected:
 	virtual ~HTTPServerParams();
 		/// Destroys the HTTPServerParams.
@@ -108,6 +195,14 @@ private:
 	bool           _keepAlive;
 	int            _maxKeepAliveRequests;
 	Poco::Timespan _keepAliveTimeout;
+	bool           _http2Enabled;
+	int            _maxConcurrentStreams;
+	bool           _compressionEnabled;
+	int            _compressionLevel;
+	int            _fileCompressionLevel;
+	int            _minCompressionSize;
+	std::vector<std::string>  _compressedMediaTypes;
+	HTTPCompressionCache::Ptr _pCompressionCache;
 };
 
 
@@ -150,6 +245,54 @@ inline const Poco::Timespan& HTTPServerParams::getKeepAliveTimeout() const
 }
 
 
+inline bool HTTPServerParams::getHTTP2Enabled() const
+{
+	return _http2Enabled;
+}
+
+
+inline int HTTPServerParams::getMaxConcurrentStreams() const
+{
+	return _maxConcurrentStreams;
+}
+
+
+inline bool HTTPServerParams::getCompressionEnabled() const
+{
+	return _compressionEnabled;
+}
+
+
+inline int HTTPServerParams::getCompressionLevel() const
+{
+	return _compressionLevel;
+}
+
+
+inline int HTTPServerParams::getFileCompressionLevel() const
+{
+	return _fileCompressionLevel;
+}
+
+
+inline int HTTPServerParams::getMinCompressionSize() const
+{
+	return _minCompressionSize;
+}
+
+
+inline const std::vector<std::string>& HTTPServerParams::getCompressedMediaTypes() const
+{
+	return _compressedMediaTypes;
+}
+
+
+inline HTTPCompressionCache::Ptr HTTPServerParams::getCompressionCache() const
+{
+	return _pCompressionCache;
+}
+
+
 } } // namespace Poco::Net
 
 
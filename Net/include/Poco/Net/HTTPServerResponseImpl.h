@@ -42,6 +42,9 @@ class Net_API HTTPServerResponseImpl: public HTTPServerResponse
 	/// handleRequest() must set a status code
 	/// and optional reason phrase, set headers
 	/// as necessary, and provide a message body.
+	///
+	/// If enabled in the HTTPServerParams, the message
+	/// body is compressed (see HTTPCompression).
 {
 public:
 	HTTPServerResponseImpl(HTTPServerSession& session);
@@ -112,9 +115,27 @@ protected:
 	void attachRequest(HTTPServerRequestImpl* pRequest);
 	
 private:
+	std::string contentEncoding(Poco::Int64 length);
+		/// Returns the content coding for the response body,
+		/// or an empty string if it is not compressed.
+
+	void sendCompressed(const std::string& data, const std::string& encoding);
+		/// Sends the response header, followed by the given
+		/// compressed body.
+
+	void setContentEncoding(const std::string& encoding);
+		/// Sets the Content-Encoding header and weakens
+		/// a strong ETag.
+
+	void writeHeader();
+		/// Writes the response header for a chunked body. The header
+		/// is held back in the session, so that it is sent together
+		/// with the first chunk.
+
 	HTTPServerSession& _session;
 	HTTPServerRequestImpl* _pRequest;
 	std::ostream*      _pStream;
+	std::ostream*      _pDeflater;
 	
 	friend class HTTPServerRequestImpl;
 };
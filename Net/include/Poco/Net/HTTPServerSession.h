@@ -46,6 +46,14 @@ public:
 				
 	bool hasMoreRequests();
 		/// Returns true if there are requests available.
+		///
+		/// Sends any deferred output before waiting for
+		/// the next request.
+
+	bool hasBufferedRequest() const;
+		/// Returns true if (a part of) the next request has
+		/// already been received, which is usually the case
+		/// if the client pipelines its requests.
 	
 	bool canKeepAlive() const;
 		/// Returns true if the session can be kept alive.
@@ -72,6 +80,12 @@ inline bool HTTPServerSession::canKeepAlive() const
 }
 
 
+inline bool HTTPServerSession::hasBufferedRequest() const
+{
+	return buffered() > 0;
+}
+
+
 } } // namespace Poco::Net
 
 
@@ -92,6 +92,28 @@ public:
 		HTTP_PORT = 80
 	};
 	
+	void setDeferredOutput(bool deferred);
+		/// Enables or disables deferred output.
+		///
+		/// If deferred output is enabled, data written to the
+		/// session is held back in an output buffer instead
+		/// of being sent immediately. The buffer is sent when
+		/// it becomes full, when flush() is called, or before the
+		/// session waits for data from the peer.
+		///
+		/// If deferred output is disabled, data that has been
+		/// held back is sent together with the next write.
+		///
+		/// This is used to send the responses to pipelined
+		/// requests, or pipelined requests, with fewer writes.
+
+	bool getDeferredOutput() const;
+		/// Returns true if deferred output is enabled.
+
+	void flush();
+		/// Sends any data that has been held back by
+		/// deferred output.
+
 	StreamSocket detachSocket();
 		/// Detaches the socket from the session.
 		///
@@ -181,6 +203,9 @@ private:
 	char*            _pBuffer;
 	char*            _pCurrent;
 	char*            _pEnd;
+	char*            _pOutput;
+	int              _outputLength;
+	bool             _deferredOutput;
 	bool             _keepAlive;
 	Poco::Timespan   _timeout;
 	Poco::Exception* _pException;
@@ -190,6 +215,7 @@ private:
 	friend class HTTPHeaderStreamBuf;
 	friend class HTTPFixedLengthStreamBuf;
 	friend class HTTPChunkedStreamBuf;
+	friend class HTTP2Connection;
 };
 
 
@@ -220,6 +246,12 @@ inline const Poco::Exception* HTTPSession::networkException() const
 }
 
 
+inline bool HTTPSession::getDeferredOutput() const
+{
+	return _deferredOutput;
+}
+
+
 inline int HTTPSession::buffered() const
 {
 	return static_cast<int>(_pEnd - _pCurrent);
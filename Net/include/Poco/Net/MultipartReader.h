@@ -22,6 +22,7 @@
 
 #include "Poco/Net/Net.h"
 #include "Poco/BufferedStreamBuf.h"
+#include "Poco/Buffer.h"
 #include <istream>
 
 
@@ -32,11 +33,61 @@ namespace Net {
 class MessageHeader;
 
 
+class Net_API MultipartSourceBuf: public std::streambuf
+	/// This is the streambuf class MultipartReader reads a multipart
+	/// message through. It reads ahead from the underlying stream in
+	/// large blocks, and lets MultipartStreamBuf search its buffer
+	/// for boundaries directly.
+	///
+	/// This class is for internal use by MultipartReader only.
+{
+public:
+	enum
+	{
+		BUFFER_SIZE = 65536
+	};
+
+	MultipartSourceBuf(std::istream& istr);
+	~MultipartSourceBuf();
+
+	bool fill(std::size_t length);
+		/// Reads from the underlying stream until at least the
+		/// given number of characters, which must not exceed
+		/// BUFFER_SIZE, is available in the buffer. Returns false
+		/// if the end of the stream has been reached before.
+		///
+		/// Does not read if enough characters are available. Otherwise,
+		/// reads the missing characters, and as many more as the
+		/// underlying stream can supply without blocking.
+
+	const char* data() const;
+		/// Returns a pointer to the characters available in the buffer.
+
+	std::size_t available() const;
+		/// Returns the number of characters available in the buffer.
+
+	void consume(std::size_t length);
+		/// Removes the given number of characters from the buffer.
+
+protected:
+	int_type underflow();
+
+private:
+	std::istream&      _istr;
+	Poco::Buffer<char> _buffer;
+	bool               _eof;
+};
+
+
 class Net_API MultipartStreamBuf: public Poco::BufferedStreamBuf
 	/// This is the streambuf class used for reading from a multipart message stream.
+	///
+	/// Boundaries are searched in the buffer of the MultipartSourceBuf
+	/// with the Boyer-Moore-Horspool algorithm, so that large parts
+	/// are copied in blocks rather than character by character.
 {
 public:
-	MultipartStreamBuf(std::istream& istr, const std::string& boundary);
+	MultipartStreamBuf(MultipartSourceBuf& source, const std::string& boundary);
 	~MultipartStreamBuf();
 	bool lastPart() const;
 	
@@ -46,12 +97,15 @@ protected:
 private:
 	enum 
 	{
-		STREAM_BUFFER_SIZE = 1024
+		STREAM_BUFFER_SIZE = 8192
 	};
 
-	std::istream& _istr;
-	std::string   _boundary;
-	bool          _lastPart;
+	std::size_t find(const char* data, std::size_t length) const;
+
+	MultipartSourceBuf& _source;
+	std::string         _delimiter;
+	std::size_t         _skip[256];
+	bool                _lastPart;
 };
 
 
@@ -59,7 +113,7 @@ class Net_API MultipartIOS: public virtual std::ios
 	/// The base class for MultipartInputStream.
 {
 public:
-	MultipartIOS(std::istream& istr, const std::string& boundary);
+	MultipartIOS(MultipartSourceBuf& source, const std::string& boundary);
 	~MultipartIOS();
 	MultipartStreamBuf* rdbuf();
 	bool lastPart() const;
@@ -73,7 +127,7 @@ class Net_API MultipartInputStream: public MultipartIOS, public std::istream
 	/// This class is for internal use by MultipartReader only.
 {
 public:
-	MultipartInputStream(std::istream& istr, const std::string& boundary);
+	MultipartInputStream(MultipartSourceBuf& source, const std::string& boundary);
 	~MultipartInputStream();
 };
 
@@ -96,6 +150,10 @@ class Net_API MultipartReader
 	/// Always ensure that you read all data from the part
 	/// stream, otherwise the MultipartReader will fail to
 	/// find the next part.
+	///
+	/// The MultipartReader reads ahead from the input stream,
+	/// so data following the multipart message in the input
+	/// stream may be consumed as well.
 {
 public:
 	explicit MultipartReader(std::istream& istr);
@@ -150,7 +208,8 @@ private:
 	MultipartReader(const MultipartReader&);
 	MultipartReader& operator = (const MultipartReader&);
 
-	std::istream&         _istr;
+	MultipartSourceBuf    _sourceBuf;
+	std::istream          _istr;
 	std::string           _boundary;
 	MultipartInputStream* _pMPI;
 };
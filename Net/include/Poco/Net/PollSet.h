@@ -0,0 +1,115 @@
+//
+// PollSet.h
+//
+// $Id$
+//
+// Library: Net
+// Package: Sockets
+// Module:  PollSet
+//
+// Definition of the PollSet class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_PollSet_INCLUDED
+#define Net_PollSet_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/Socket.h"
+#include <map>
+
+
+namespace Poco {
+namespace Net {
+
+
+class PollSetImpl;
+
+
+class Net_API PollSet
+	/// A set of sockets that can be polled for readability,
+	/// writability or errors.
+	///
+	/// Unlike Socket::select(), which builds its descriptor
+	/// set anew with every call, a PollSet keeps its sockets
+	/// registered between calls to poll(), and the cost of
+	/// poll() does not depend on the number of sockets that
+	/// are not ready. On Linux, epoll is used if POCO_HAVE_FD_EPOLL
+	/// is defined. On other Unix platforms, poll() is used, and
+	/// select() on Windows, where the number of sockets is limited
+	/// to FD_SETSIZE.
+	///
+	/// Sockets can be added, updated and removed from any thread,
+	/// but poll() must only be called by one thread at a time.
+{
+public:
+	enum Mode
+	{
+		POLL_READ  = 0x01,
+		POLL_WRITE = 0x02,
+		POLL_ERROR = 0x04
+	};
+
+	typedef std::map<Socket, int> SocketModeMap;
+
+	PollSet();
+		/// Creates an empty PollSet.
+
+	~PollSet();
+		/// Destroys the PollSet.
+
+	void add(const Socket& socket, int mode);
+		/// Adds the given socket to the set, for polling
+		/// with the given mode, which is a combination of
+		/// Mode flags. If the socket is already in the set,
+		/// its mode is replaced.
+
+	void update(const Socket& socket, int mode);
+		/// Changes the mode of the given socket, which
+		/// must be in the set.
+
+	void remove(const Socket& socket);
+		/// Removes the given socket from the set.
+		/// Does nothing if the socket is not in the set.
+
+	bool has(const Socket& socket) const;
+		/// Returns true iff the given socket is in the set.
+
+	bool empty() const;
+		/// Returns true iff the set contains no sockets.
+
+	std::size_t size() const;
+		/// Returns the number of sockets in the set.
+
+	void clear();
+		/// Removes all sockets from the set.
+
+	int poll(const Poco::Timespan& timeout, SocketModeMap& ready);
+		/// Waits until at least one of the sockets in the
+		/// set is ready, or the given timeout has expired,
+		/// and stores the ready sockets together with
+		/// the modes they are ready for in ready.
+		///
+		/// Errors and hang-ups are always reported as POLL_ERROR,
+		/// even if the socket has not been added with that mode.
+		///
+		/// Returns the number of ready sockets.
+
+private:
+	PollSet(const PollSet&);
+	PollSet& operator = (const PollSet&);
+
+	PollSetImpl* _pImpl;
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_PollSet_INCLUDED
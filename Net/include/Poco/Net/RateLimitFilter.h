@@ -0,0 +1,139 @@
+//
+// RateLimitFilter.h
+//
+// $Id$
+//
+// Library: Net
+// Package: TCPServer
+// Module:  RateLimitFilter
+//
+// Definition of the RateLimitFilter class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_RateLimitFilter_INCLUDED
+#define Net_RateLimitFilter_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/TCPServerConnectionFilter.h"
+#include "Poco/Net/TokenBucket.h"
+#include "Poco/Net/IPAddress.h"
+#include "Poco/LRUCache.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/AtomicCounter.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API RateLimitFilter: public TCPServerConnectionFilter
+	/// A TCPServerConnectionFilter that limits the rate of
+	/// incoming connections, using a TokenBucket for the listener
+	/// and one for every remote address.
+	///
+	/// Connections exceeding a limit are closed right after
+	/// they have been accepted, so that a client opening many
+	/// connections cannot keep others from being served, and
+	/// a spike of connections does not overload the server.
+	///
+	/// A RateLimitFilter should be used with one TCPServer only,
+	/// so that its listener limit applies to this server.
+	///
+	/// Example:
+	///     RateLimitFilter::Ptr pFilter = new RateLimitFilter;
+	///     pFilter->setListenerRate(1000, 2000);
+	///     pFilter->setAddressRate(10, 50);
+	///     srv.setConnectionFilter(pFilter);
+{
+public:
+	typedef Poco::AutoPtr<RateLimitFilter> Ptr;
+
+	enum
+	{
+		DEFAULT_MAX_ADDRESSES = 10000
+	};
+
+	explicit RateLimitFilter(std::size_t maxAddresses = DEFAULT_MAX_ADDRESSES);
+		/// Creates the RateLimitFilter, which does not limit
+		/// anything until a rate has been set.
+		///
+		/// The filter keeps a TokenBucket for up to maxAddresses remote
+		/// addresses. When there are more, the least recently seen
+		/// ones are dropped.
+
+	void setListenerRate(double rate, double burst);
+		/// Limits the connections accepted from all clients together
+		/// to rate connections per second, with bursts of up to burst
+		/// connections. A burst of zero removes the limit.
+		///
+		/// Must be called before the filter is passed to the TCPServer.
+
+	void setAddressRate(double rate, double burst);
+		/// Limits the connections accepted from a single
+		/// remote address to rate connections per second,
+		/// with bursts of up to burst connections. A burst
+		/// of zero removes the limit.
+		///
+		/// Must be called before the filter is passed to the TCPServer.
+
+	bool accept(const StreamSocket& socket);
+		/// Takes a token from the bucket of the socket's remote
+		/// address and one from the listener's bucket. Returns
+		/// false if one of them is empty. If the listener's bucket
+		/// is empty, the address's token is put back, so that a
+		/// connection is counted against one limit only.
+		///
+		/// The address is checked first, so that the connections
+		/// rejected for a single address do not use up the
+		/// listener's tokens.
+
+	int rejectedByAddress() const;
+		/// Returns the number of connections rejected
+		/// because of the limit per remote address.
+
+	int rejectedByListener() const;
+		/// Returns the number of connections rejected
+		/// because of the listener limit.
+
+protected:
+	~RateLimitFilter();
+		/// Destroys the RateLimitFilter.
+
+private:
+	typedef Poco::LRUCache<IPAddress, TokenBucket> BucketCache;
+
+	double                        _addressRate;
+	double                        _addressBurst;
+	BucketCache                   _addressBuckets;
+	Poco::SharedPtr<TokenBucket>  _pListenerBucket;
+	Poco::AtomicCounter           _rejectedByAddress;
+	Poco::AtomicCounter           _rejectedByListener;
+};
+
+
+//
+// inlines
+//
+inline int RateLimitFilter::rejectedByAddress() const
+{
+	return _rejectedByAddress.value();
+}
+
+
+inline int RateLimitFilter::rejectedByListener() const
+{
+	return _rejectedByListener.value();
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_RateLimitFilter_INCLUDED
@@ -429,6 +429,7 @@ private:
 	
 	friend class Socket;
 	friend class SecureSocketImpl;
+	friend class PollSetImpl;
 };
 
 
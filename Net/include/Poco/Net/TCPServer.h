@@ -24,9 +24,11 @@
 #include "Poco/Net/ServerSocket.h"
 #include "Poco/Net/TCPServerConnectionFactory.h"
 #include "Poco/Net/TCPServerParams.h"
+#include "Poco/Net/TCPServerConnectionFilter.h"
 #include "Poco/Runnable.h"
 #include "Poco/Thread.h"
 #include "Poco/ThreadPool.h"
+#include "Poco/AtomicCounter.h"
 
 
 namespace Poco {
@@ -66,6 +68,13 @@ class Net_API TCPServer: public Poco::Runnable
 	/// This prevents the connection queue from overflowing in the 
 	/// case of an extreme server load. In such a case, connections that
 	/// cannot be queued are silently and immediately closed.
+	/// If a target queue latency has been set in the TCPServerParams,
+	/// the number of queued connections is additionally limited
+	/// adaptively, depending on how long connections wait in the queue.
+	///
+	/// A TCPServerConnectionFilter can be set to reject connections
+	/// in the accept loop, before they are queued, for example
+	/// to limit the connection rate (see RateLimitFilter).
 	///
 	/// TCPServer uses a separate thread to accept incoming connections.
 	/// Thus, the call to start() returns immediately, and the server
@@ -160,6 +169,25 @@ public:
 	int refusedConnections() const;
 		/// Returns the number of refused connections.
 
+	int limitedConnections() const;
+		/// Returns the number of connections refused because of
+		/// the adaptive concurrency limit. These are included
+		/// in refusedConnections().
+
+	int filteredConnections() const;
+		/// Returns the number of connections rejected
+		/// by the connection filter.
+
+	void setConnectionFilter(const TCPServerConnectionFilter::Ptr& pFilter);
+		/// Sets a TCPServerConnectionFilter, or removes the
+		/// filter if a null pointer is given.
+		///
+		/// The filter must be set before the server is started.
+
+	TCPServerConnectionFilter::Ptr getConnectionFilter() const;
+		/// Returns the TCPServerConnectionFilter, which
+		/// may be null.
+
 	const ServerSocket& socket() const;
 		/// Returns the underlying server socket.
 
@@ -181,10 +209,12 @@ private:
 	TCPServer(const TCPServer&);
 	TCPServer& operator = (const TCPServer&);
 	
-	ServerSocket         _socket;
-	TCPServerDispatcher* _pDispatcher;
-	Poco::Thread         _thread;
-	bool                 _stopped;
+	ServerSocket                   _socket;
+	TCPServerDispatcher*           _pDispatcher;
+	TCPServerConnectionFilter::Ptr _pConnectionFilter;
+	Poco::AtomicCounter            _filteredConnections;
+	Poco::Thread                   _thread;
+	bool                           _stopped;
 };
 
 
@@ -200,6 +230,18 @@ inline Poco::UInt16 TCPServer::port() const
 }
 
 
+inline int TCPServer::filteredConnections() const
+{
+	return _filteredConnections.value();
+}
+
+
+inline TCPServerConnectionFilter::Ptr TCPServer::getConnectionFilter() const
+{
+	return _pConnectionFilter;
+}
+
+
 } } // namespace Poco::Net
 
 
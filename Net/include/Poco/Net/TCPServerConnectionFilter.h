@@ -0,0 +1,66 @@
+//
+// TCPServerConnectionFilter.h
+//
+// $Id$
+//
+// Library: Net
+// Package: TCPServer
+// Module:  TCPServerConnectionFilter
+//
+// Definition of the TCPServerConnectionFilter class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_TCPServerConnectionFilter_INCLUDED
+#define Net_TCPServerConnectionFilter_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/AutoPtr.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API TCPServerConnectionFilter: public Poco::RefCountedObject
+	/// A TCPServerConnectionFilter can be used to reject incoming
+	/// connections in the TCPServer's accept loop, before they are
+	/// passed on to the TCPServerDispatcher and before a
+	/// TCPServerConnection is created for them.
+	///
+	/// Examples are address black lists or rate limits
+	/// (see RateLimitFilter).
+	///
+	/// Subclasses must override the accept() method.
+{
+public:
+	typedef Poco::AutoPtr<TCPServerConnectionFilter> Ptr;
+
+	virtual bool accept(const StreamSocket& socket) = 0;
+		/// Returns true if the given connection should be
+		/// handled and passed on to the TCPServerDispatcher.
+		///
+		/// Returns false if the connection should be
+		/// closed immediately.
+		///
+		/// accept() is called by the TCPServer's accept thread
+		/// and should return quickly, as no other connection can
+		/// be accepted meanwhile.
+
+protected:
+	virtual ~TCPServerConnectionFilter();
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_TCPServerConnectionFilter_INCLUDED
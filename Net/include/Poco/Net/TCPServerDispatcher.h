@@ -28,6 +28,7 @@
 #include "Poco/NotificationQueue.h"
 #include "Poco/ThreadPool.h"
 #include "Poco/Mutex.h"
+#include "Poco/Clock.h"
 
 
 namespace Poco {
@@ -84,6 +85,16 @@ public:
 	int refusedConnections() const;
 		/// Returns the number of refused connections.
 
+	int limitedConnections() const;
+		/// Returns the number of connections refused because of
+		/// the adaptive concurrency limit. These are included
+		/// in refusedConnections().
+
+	int concurrencyLimit() const;
+		/// Returns the current adaptive limit for the number of
+		/// queued and handled connections, or 0 if no target
+		/// queue latency has been set.
+
 	const TCPServerParams& params() const;
 		/// Returns a const reference to the TCPServerParam object.
 
@@ -102,6 +113,8 @@ private:
 	TCPServerDispatcher(const TCPServerDispatcher&);
 	TCPServerDispatcher& operator = (const TCPServerDispatcher&);
 
+	void updateConcurrencyLimit(Poco::Clock::ClockDiff latency);
+
 	int _rc;
 	TCPServerParams::Ptr _pParams;
 	int  _currentThreads;
@@ -109,7 +122,10 @@ private:
 	int  _currentConnections;
 	int  _maxConcurrentConnections;
 	int  _refusedConnections;
+	int  _limitedConnections;
+	int  _concurrencyLimit;
 	bool _stopped;
+	Poco::Clock                     _lastDecrease;
 	Poco::NotificationQueue         _queue;
 	TCPServerConnectionFactory::Ptr _pConnectionFactory;
 	Poco::ThreadPool&               _threadPool;
@@ -47,6 +47,7 @@ public:
 		///   - threadIdleTime:       10 seconds
 		///   - maxThreads:           0
 		///   - maxQueued:            64
+		///   - targetQueueLatency:   0 (no adaptive limit)
 
 	void setThreadIdleTime(const Poco::Timespan& idleTime);
 		/// Sets the maximum idle time for a thread before
@@ -94,6 +95,24 @@ public:
 		/// Returns the priority of TCP server threads
 		/// created by TCPServer. 
 
+	void setTargetQueueLatency(const Poco::Timespan& latency);
+		/// Sets the time connections should at most wait in
+		/// the queue before a thread starts handling them.
+		///
+		/// If set, the TCPServerDispatcher adaptively limits the number
+		/// of queued and handled connections. The limit is lowered
+		/// whenever a connection has waited longer than the target
+		/// latency, and raised again as long as connections are handled
+		/// in time. It never drops below the maximum number of threads
+		/// and never exceeds the maximum number of threads plus the
+		/// maximum number of queued connections. Connections
+		/// exceeding the limit are refused.
+		///
+		/// The default is zero, which disables the adaptive limit.
+
+	const Poco::Timespan& getTargetQueueLatency() const;
+		/// Returns the target queue latency.
+
 protected:
 	virtual ~TCPServerParams();
 		/// Destroys the TCPServerParams.
@@ -103,6 +122,7 @@ private:
 	int _maxThreads;
 	int _maxQueued;
 	Poco::Thread::Priority _threadPriority;
+	Poco::Timespan _targetQueueLatency;
 };
 
 
@@ -133,6 +153,12 @@ inline Poco::Thread::Priority TCPServerParams::getThreadPriority() const
 }
 
 
+inline const Poco::Timespan& TCPServerParams::getTargetQueueLatency() const
+{
+	return _targetQueueLatency;
+}
+
+
 } } // namespace Poco::Net
 
 
@@ -0,0 +1,110 @@
+//
+// TokenBucket.h
+//
+// $Id$
+//
+// Library: Net
+// Package: TCPServer
+// Module:  TokenBucket
+//
+// Definition of the TokenBucket class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_TokenBucket_INCLUDED
+#define Net_TokenBucket_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Clock.h"
+#include "Poco/Mutex.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API TokenBucket
+	/// A TokenBucket limits the rate of events, such as
+	/// incoming connections, while allowing short bursts.
+	///
+	/// The bucket holds up to burst tokens and is refilled
+	/// with rate tokens per second. Every event takes one token.
+	/// Events for which no token is available should be rejected.
+	///
+	/// A TokenBucket is thread-safe.
+{
+public:
+	TokenBucket(double rate, double burst);
+		/// Creates a full TokenBucket that is refilled with
+		/// rate tokens per second and holds up to burst tokens.
+		///
+		/// Throws an InvalidArgumentException if rate is negative
+		/// or burst is less than one.
+
+	~TokenBucket();
+		/// Destroys the TokenBucket.
+
+	bool tryConsume(double tokens = 1.0);
+		/// Takes the given number of tokens from the bucket and
+		/// returns true, or returns false and leaves the bucket
+		/// untouched if there are not enough tokens.
+
+	void refund(double tokens = 1.0);
+		/// Puts the given number of tokens back into the bucket,
+		/// after an event for which they have been taken did not
+		/// happen after all. The bucket never holds more than
+		/// burst tokens.
+
+	double available();
+		/// Returns the number of tokens currently available.
+
+	bool full();
+		/// Returns true iff the bucket has been refilled completely,
+		/// so that it is no different from a new TokenBucket.
+
+	double rate() const;
+		/// Returns the number of tokens added per second.
+
+	double burst() const;
+		/// Returns the maximum number of tokens.
+
+private:
+	TokenBucket();
+	TokenBucket(const TokenBucket&);
+	TokenBucket& operator = (const TokenBucket&);
+
+	void refill();
+
+	const double     _rate;
+	const double     _burst;
+	double           _tokens;
+	Poco::Clock      _lastRefill;
+	Poco::FastMutex  _mutex;
+};
+
+
+//
+// inlines
+//
+inline double TokenBucket::rate() const
+{
+	return _rate;
+}
+
+
+inline double TokenBucket::burst() const
+{
+	return _burst;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_TokenBucket_INCLUDED
@@ -22,6 +22,7 @@
 
 #include "Poco/Net/Net.h"
 #include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/WebSocketDeflate.h"
 #include "Poco/Net/HTTPCredentials.h"
 #include "Poco/Buffer.h"
 
@@ -51,6 +52,12 @@ class Net_API WebSocket: public StreamSocket
 	/// Note that special frames like PING must be handled at
 	/// application level. In the case of a PING, a PONG message
 	/// must be returned.
+	///
+	/// The permessage-deflate extension (RFC 7692) is supported;
+	/// see WebSocketDeflate for how to enable it. If it has been
+	/// negotiated, unfragmented text and binary messages are
+	/// compressed transparently by sendFrame(), and compressed
+	/// messages are decompressed by receiveFrame().
 {
 public:
 	enum Mode
@@ -126,8 +133,10 @@ public:
 			/// The server rejected the username or password for authentication.
 		WS_ERR_PAYLOAD_TOO_BIG                = 10,
 			/// Payload too big for supplied buffer.
-		WS_ERR_INCOMPLETE_FRAME               = 11
+		WS_ERR_INCOMPLETE_FRAME               = 11,
 			/// Incomplete frame received.
+		WS_ERR_COMPRESSION                    = 12
+			/// Invalid compressed payload received.
 	};
 	
 	WebSocket(HTTPServerRequest& request, HTTPServerResponse& response);
@@ -140,6 +149,14 @@ public:
 		///
 		/// Throws an exception if the request is not a proper WebSocket
 		/// upgrade request.
+
+	WebSocket(HTTPServerRequest& request, HTTPServerResponse& response, const WebSocketDeflate::Params& deflateParams);
+		/// Creates a server-side WebSocket from within a
+		/// HTTPRequestHandler, like the constructor above.
+		///
+		/// If the client offers the permessage-deflate extension,
+		/// the extension is enabled, using the given parameters
+		/// as far as the client's offer allows.
 		
 	WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response);
 		/// Creates a client-side WebSocket, using the given
@@ -148,7 +165,10 @@ public:
 		///
 		/// Additional HTTP headers for the initial handshake request
 		/// (such as Origin or Sec-WebSocket-Protocol) can be given
-		/// in the request object.
+		/// in the request object. The permessage-deflate extension
+		/// is offered by setting the Sec-WebSocket-Extensions header
+		/// (see WebSocketDeflate::offer()), and used if the server
+		/// accepts it.
 		///
 		/// The result of the handshake can be obtained from the response
 		/// object.
@@ -241,13 +261,30 @@ public:
 		/// Returns WS_SERVER if the WebSocket is a server-side
 		/// WebSocket, or WS_CLIENT otherwise.
 
+	bool compressed() const;
+		/// Returns true if the permessage-deflate extension
+		/// has been negotiated.
+
+	void setMaxPayloadSize(int maxPayloadSize);
+		/// Sets the maximum payload size of a received frame.
+		/// For a compressed frame, the limit applies to the
+		/// decompressed payload, which is checked while it is
+		/// inflated. A frame exceeding the limit causes
+		/// receiveFrame() to throw a WebSocketException with
+		/// WS_ERR_PAYLOAD_TOO_BIG.
+		///
+		/// The default is std::numeric_limits<int>::max().
+
+	int getMaxPayloadSize() const;
+		/// Returns the maximum payload size of a received frame.
+
 	static const std::string WEBSOCKET_VERSION;
 		/// The WebSocket protocol version supported (13).
 	
 protected:
-	static WebSocketImpl* accept(HTTPServerRequest& request, HTTPServerResponse& response);
+	static WebSocketImpl* accept(HTTPServerRequest& request, HTTPServerResponse& response, const WebSocketDeflate::Params* pDeflateParams = 0);
 	static WebSocketImpl* connect(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, HTTPCredentials& credentials);
-	static WebSocketImpl* completeHandshake(HTTPClientSession& cs, HTTPResponse& response, const std::string& key);
+	static WebSocketImpl* completeHandshake(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, const std::string& key);
 	static std::string computeAccept(const std::string& key);
 	static std::string createKey();
 	
@@ -0,0 +1,189 @@
+//
+// WebSocketDeflate.h
+//
+// $Id$
+//
+// Library: Net
+// Package: WebSocket
+// Module:  WebSocketDeflate
+//
+// Definition of the WebSocketDeflate class.
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_WebSocketDeflate_INCLUDED
+#define Net_WebSocketDeflate_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Buffer.h"
+#if defined(POCO_UNBUNDLED)
+#include <zlib.h>
+#else
+#include "Poco/zlib.h"
+#endif
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API WebSocketDeflate
+	/// This class implements the permessage-deflate WebSocket
+	/// extension specified in RFC 7692, which compresses the payload
+	/// of text and binary messages with the DEFLATE algorithm.
+	///
+	/// The extension is negotiated during the WebSocket handshake,
+	/// using the Sec-WebSocket-Extensions header. A client offers
+	/// the extension by setting the header in the handshake request:
+	///
+	///     request.set(WebSocketDeflate::EXTENSIONS_HEADER, WebSocketDeflate::offer(params));
+	///
+	/// A server accepts the offer if the WebSocket is created with
+	/// the constructor taking a WebSocketDeflate::Params argument.
+	///
+	/// The compression state is kept across messages (context takeover),
+	/// unless one of the no_context_takeover parameters has been
+	/// negotiated. This gives better compression for streams of
+	/// similar messages, at the cost of keeping the compression
+	/// state (up to about 300 KB with the default parameters)
+	/// for the lifetime of the connection.
+{
+public:
+	struct Net_API Params
+		/// The parameters of the permessage-deflate extension.
+	{
+		Params();
+			/// Creates the default parameters: context takeover
+			/// in both directions, 15 bit windows, the default
+			/// compression level, and compression of messages
+			/// of at least 64 bytes.
+
+		bool serverNoContextTakeover;
+			/// The server resets its compression state after every message.
+
+		bool clientNoContextTakeover;
+			/// The client resets its compression state after every message.
+
+		int serverMaxWindowBits;
+			/// The base-2 logarithm of the server's LZ77 window size (9 - 15).
+
+		int clientMaxWindowBits;
+			/// The base-2 logarithm of the client's LZ77 window size (9 - 15).
+			///
+			/// A peer may ask for 8, but only 9 or more are supported
+			/// for compression.
+
+		int compressionLevel;
+			/// The zlib compression level used for outgoing messages.
+			/// Not negotiated.
+
+		int minimumSize;
+			/// Outgoing messages with a smaller payload are sent
+			/// uncompressed. Not negotiated.
+	};
+
+	enum
+	{
+		MIN_WINDOW_BITS = 8,
+		MAX_WINDOW_BITS = 15
+	};
+
+	WebSocketDeflate(bool server, const Params& params);
+		/// Creates the WebSocketDeflate for the server or client
+		/// end of a connection, using the negotiated parameters.
+
+	~WebSocketDeflate();
+		/// Destroys the WebSocketDeflate.
+
+	const Params& params() const;
+		/// Returns the negotiated parameters.
+
+	bool compressible(int length) const;
+		/// Returns true if a message with the given payload
+		/// length should be compressed.
+
+	void compress(const char* data, int length, Poco::Buffer<char>& buffer);
+		/// Compresses the payload of a message, and stores
+		/// the result in buffer, replacing its previous content.
+
+	void decompress(const char* data, int length, bool final, Poco::Buffer<char>& buffer, int maxLength);
+		/// Decompresses the payload of a compressed message frame,
+		/// and appends the result to buffer. If final is true, the
+		/// frame is the last one of the message.
+		///
+		/// Throws a WebSocketException with WS_ERR_PAYLOAD_TOO_BIG
+		/// as soon as the frame decompresses to more than maxLength
+		/// bytes. The DEFLATE context is then unusable, and the
+		/// WebSocket connection must be terminated.
+
+	static std::string offer(const Params& params);
+		/// Returns the value of the Sec-WebSocket-Extensions
+		/// header for a client handshake request offering the
+		/// extension with the given parameters.
+
+	static bool accept(const std::string& extensions, const Params& params, Params& agreed, std::string& response);
+		/// Server side negotiation. Looks for an acceptable offer
+		/// of the extension in the given Sec-WebSocket-Extensions
+		/// header value from the client's handshake request.
+		///
+		/// If one is found, stores the resulting parameters in
+		/// agreed, the value for the Sec-WebSocket-Extensions header
+		/// of the handshake response in response, and returns true.
+		/// Otherwise, returns false.
+
+	static bool confirm(const std::string& offer, const std::string& response, Params& agreed);
+		/// Client side negotiation. Checks the Sec-WebSocket-Extensions
+		/// header value of the server's handshake response against
+		/// the one of the client's handshake request.
+		///
+		/// Returns false if the server did not accept the extension.
+		/// Otherwise, stores the resulting parameters in agreed and
+		/// returns true. The compression level and minimum size are
+		/// not negotiated, so the defaults are used for these.
+		///
+		/// Throws a WebSocketException if the response is invalid.
+
+	static const std::string EXTENSION;
+		/// The extension name, "permessage-deflate".
+
+	static const std::string EXTENSIONS_HEADER;
+		/// The name of the extension negotiation header,
+		/// "Sec-WebSocket-Extensions".
+
+private:
+	WebSocketDeflate(const WebSocketDeflate&);
+	WebSocketDeflate& operator = (const WebSocketDeflate&);
+
+	Params   _params;
+	bool     _resetDeflate;
+	bool     _resetInflate;
+	z_stream _deflate;
+	z_stream _inflate;
+};
+
+
+//
+// inlines
+//
+inline const WebSocketDeflate::Params& WebSocketDeflate::params() const
+{
+	return _params;
+}
+
+
+inline bool WebSocketDeflate::compressible(int length) const
+{
+	return length >= _params.minimumSize;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_WebSocketDeflate_INCLUDED
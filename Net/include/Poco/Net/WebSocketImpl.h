@@ -21,6 +21,7 @@
 
 
 #include "Poco/Net/StreamSocketImpl.h"
+#include "Poco/Net/WebSocketDeflate.h"
 #include "Poco/Buffer.h"
 #include "Poco/Random.h"
 
@@ -32,6 +33,12 @@ namespace Net {
 class Net_API WebSocketImpl: public StreamSocketImpl
 	/// This class implements a WebSocket, according
 	/// to the WebSocket protocol described in RFC 6455.
+	///
+	/// Incoming data is read from the socket in blocks of up to
+	/// RECEIVE_BUFFER_SIZE bytes, so that the headers and payloads
+	/// of consecutive small frames are obtained with a single
+	/// system call. Large payloads are received directly into
+	/// the caller's buffer.
 {
 public:
 	WebSocketImpl(StreamSocketImpl* pStreamSocketImpl, bool mustMaskPayload);
@@ -66,6 +73,11 @@ public:
 	virtual Poco::Timespan getSendTimeout();
 	virtual void setReceiveTimeout(const Poco::Timespan& timeout);
 	virtual Poco::Timespan getReceiveTimeout();
+	virtual int available();
+		/// Returns the number of bytes available that can be read
+		/// without causing the socket to block, including data that
+		/// has already been read from the socket into the receive
+		/// buffer.
 
 	// Internal
 	int frameFlags() const;
@@ -74,26 +86,62 @@ public:
 	bool mustMaskPayload() const;
 		/// Returns true if the payload must be masked.
 
+	void setDeflate(WebSocketDeflate* pDeflate);
+		/// Enables the permessage-deflate extension. Takes
+		/// ownership of the given WebSocketDeflate.
+
+	WebSocketDeflate* deflate() const;
+		/// Returns the WebSocketDeflate if the permessage-deflate
+		/// extension is used, or null otherwise.
+
+	void setMaxPayloadSize(int maxPayloadSize);
+		/// Sets the maximum payload size of a received frame.
+
+	int getMaxPayloadSize() const;
+		/// Returns the maximum payload size of a received frame.
+
+	static void maskPayload(char* dest, const char* src, int length, const char mask[4], int offset = 0);
+		/// XORs length bytes from src with the given masking key and
+		/// stores the result in dest, which may be equal to src.
+		/// The offset is the position of src[0] in the frame payload.
+		///
+		/// Processes 16 bytes per instruction on CPUs with SSE2
+		/// or NEON, and 8 bytes at a time otherwise.
+
 protected:
 	enum
 	{
-		FRAME_FLAG_MASK   = 0x80,
-		MAX_HEADER_LENGTH = 14
+		FRAME_FLAG_MASK     = 0x80,
+		MAX_HEADER_LENGTH   = 14,
+		RECEIVE_BUFFER_SIZE = 4096
 	};
 	
 	int receiveHeader(char mask[4], bool& useMask);
 	int receivePayload(char *buffer, int payloadLength, char mask[4], bool useMask);
+	int receiveCompressed(int payloadLength, char mask[4], bool useMask, Poco::Buffer<char>& buffer, int maxLength);
+	bool compressedFrame();
+	void sendFrame(const char* payload, int length, int flags);
 
 	int receiveNBytes(void* buffer, int bytes);
+	int fillBuffer(int bytes);
 	virtual ~WebSocketImpl();
 
 private:
 	WebSocketImpl();
 	
 	StreamSocketImpl* _pStreamSocketImpl;
+	int _maxPayloadSize;
 	int _frameFlags;
 	bool _mustMaskPayload;
 	Poco::Random _rnd;
+	Poco::Buffer<char> _buffer;
+	int _bufferOffset;
+	int _bufferLength;
+	WebSocketDeflate* _pDeflate;
+	bool _compressedMessage;
+	Poco::Buffer<char> _sendBuffer;
+	Poco::Buffer<char> _receiveBuffer;
+	Poco::Buffer<char> _inflateBuffer;
 };
 
 
@@ -112,6 +160,18 @@ inline bool WebSocketImpl::mustMaskPayload() const
 }
 
 
+inline WebSocketDeflate* WebSocketImpl::deflate() const
+{
+	return _pDeflate;
+}
+
+
+inline int WebSocketImpl::getMaxPayloadSize() const
+{
+	return _maxPayloadSize;
+}
+
+
 } } // namespace Poco::Net
 
 
@@ -15,6 +15,7 @@
 
 
 #include "Poco/Net/DNS.h"
+#include "Poco/Net/DNSCache.h"
 #include "Poco/Net/NetException.h"
 #include "Poco/Net/SocketAddress.h"
 #include "Poco/Environment.h"
@@ -42,7 +43,23 @@ static Poco::RWLock resolverLock;
 #endif
 
 
-HostEntry DNS::hostByName(const std::string& hostname, unsigned 
+HostEntry DNS::hostByName(const std::string& hostname, unsigned hintFlags)
+{
+	DNSCache& cache = DNSCache::defaultCache();
+	if (cache.isEnabled())
+		return cache.hostByName(hostname, hintFlags);
+	else
+		return lookupByName(hostname, hintFlags);
+}
+
+
+Poco::ActiveResult<HostEntry> DNS::hostByNameAsync(const std::string& hostname, unsigned hintFlags)
+{
+	return DNSCache::defaultCache().hostByNameAsync(hostname, hintFlags);
+}
+
+
+HostEntry DNS::lookupByName(const std::string& hostname, unsigned 
 #ifdef POCO_HAVE_ADDRINFO
 						  hintFlags
 #endif
@@ -178,6 +195,7 @@ void DNS::reload()
 
 void DNS::flushCache()
 {
+	DNSCache::defaultCache().clear();
 }
 
 
@@ -0,0 +1,373 @@
+//
+// DNSCache.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: NetCore
+// Module:  DNSCache
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/DNSCache.h"
+#include "Poco/Net/DNS.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Notification.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/SingletonHolder.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/String.h"
+#include <set>
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	class LookupNotification: public Poco::Notification
+	{
+	public:
+		LookupNotification(const std::string& key, const std::string& hostname, unsigned hintFlags):
+			_key(key),
+			_hostname(hostname),
+			_hintFlags(hintFlags)
+		{
+		}
+
+		const std::string& key() const
+		{
+			return _key;
+		}
+
+		const std::string& hostname() const
+		{
+			return _hostname;
+		}
+
+		unsigned hintFlags() const
+		{
+			return _hintFlags;
+		}
+
+	private:
+		std::string _key;
+		std::string _hostname;
+		unsigned    _hintFlags;
+	};
+
+	class StopNotification: public Poco::Notification
+	{
+	};
+}
+
+
+DNSCache::DNSCache(std::size_t maxEntries, int threads):
+	_cache(static_cast<long>(maxEntries)),
+	_enabled(true),
+	_ttl(60, 0),
+	_staleTtl(30, 0),
+	_negativeTtl(5, 0),
+	_maxThreads(threads)
+{
+	poco_assert (threads > 0);
+}
+
+
+DNSCache::~DNSCache()
+{
+	try
+	{
+		PendingMap pending;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+
+			_queue.clear();
+			for (std::size_t i = 0; i < _threads.size(); ++i)
+			{
+				_queue.enqueueNotification(new StopNotification);
+			}
+			pending.swap(_pending);
+		}
+		for (PendingMap::iterator it = pending.begin(); it != pending.end(); ++it)
+		{
+			it->second.error(IOException("DNSCache has been destroyed"));
+			it->second.notify();
+		}
+		for (std::vector<Poco::Thread*>::iterator it = _threads.begin(); it != _threads.end(); ++it)
+		{
+			(*it)->join();
+			delete *it;
+		}
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+HostEntry DNSCache::hostByName(const std::string& hostname, unsigned hintFlags)
+{
+	std::string key(makeKey(hostname, hintFlags));
+	if (_enabled)
+	{
+		Poco::SharedPtr<Entry> pEntry = _cache.get(key);
+		if (pEntry)
+		{
+			if (pEntry->pException) pEntry->pException->rethrow();
+			if (pEntry->fresh < Poco::Timestamp()) enqueue(key, hostname, hintFlags);
+			return pEntry->hostEntry;
+		}
+	}
+
+	Poco::SharedPtr<Result> pResult;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		PendingMap::iterator it = _pending.find(key);
+		if (it != _pending.end()) pResult = new Result(it->second);
+	}
+	if (pResult)
+	{
+		// another thread is already looking up the host
+		pResult->wait();
+		if (pResult->failed()) pResult->exception()->rethrow();
+		return pResult->data();
+	}
+	return resolve(key, hostname, hintFlags);
+}
+
+
+Poco::ActiveResult<HostEntry> DNSCache::hostByNameAsync(const std::string& hostname, unsigned hintFlags)
+{
+	std::string key(makeKey(hostname, hintFlags));
+	if (_enabled)
+	{
+		Poco::SharedPtr<Entry> pEntry = _cache.get(key);
+		if (pEntry)
+		{
+			Result result(new Poco::ActiveResultHolder<HostEntry>());
+			if (pEntry->pException)
+			{
+				result.error(*pEntry->pException);
+			}
+			else
+			{
+				result.data(new HostEntry(pEntry->hostEntry));
+				if (pEntry->fresh < Poco::Timestamp()) enqueue(key, hostname, hintFlags);
+			}
+			result.notify();
+			return result;
+		}
+	}
+	return enqueue(key, hostname, hintFlags);
+}
+
+
+void DNSCache::remove(const std::string& hostname)
+{
+	std::string name(Poco::toLower(hostname));
+	std::set<std::string> keys = _cache.getAllKeys();
+	for (std::set<std::string>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+	{
+		std::string::size_type pos = it->find(':');
+		if (it->compare(pos + 1, std::string::npos, name) == 0)
+			_cache.remove(*it);
+	}
+}
+
+
+void DNSCache::clear()
+{
+	_cache.clear();
+}
+
+
+std::size_t DNSCache::size()
+{
+	return _cache.size();
+}
+
+
+void DNSCache::setEnabled(bool enabled)
+{
+	_enabled = enabled;
+	if (!enabled) _cache.clear();
+}
+
+
+void DNSCache::setTimeToLive(const Poco::Timespan& ttl)
+{
+	_ttl = ttl;
+}
+
+
+void DNSCache::setStaleTimeToLive(const Poco::Timespan& ttl)
+{
+	_staleTtl = ttl;
+}
+
+
+void DNSCache::setNegativeTimeToLive(const Poco::Timespan& ttl)
+{
+	_negativeTtl = ttl;
+}
+
+
+HostEntry DNSCache::lookup(const std::string& hostname, unsigned hintFlags)
+{
+	return DNS::lookupByName(hostname, hintFlags);
+}
+
+
+void DNSCache::run()
+{
+	for (;;)
+	{
+		Poco::AutoPtr<Poco::Notification> pNf(_queue.waitDequeueNotification());
+		LookupNotification* pLookup = dynamic_cast<LookupNotification*>(pNf.get());
+		if (!pLookup) break;
+
+		HostEntry* pHostEntry = 0;
+		Poco::Exception* pException = 0;
+		try
+		{
+			pHostEntry = new HostEntry(resolve(pLookup->key(), pLookup->hostname(), pLookup->hintFlags()));
+		}
+		catch (Poco::Exception& exc)
+		{
+			pException = exc.clone();
+		}
+		catch (std::exception& exc)
+		{
+			pException = new Poco::SystemException(exc.what());
+		}
+		catch (...)
+		{
+			pException = new Poco::UnhandledException("unknown exception");
+		}
+
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		PendingMap::iterator it = _pending.find(pLookup->key());
+		if (it != _pending.end())
+		{
+			if (pHostEntry)
+				it->second.data(pHostEntry);
+			else
+				it->second.error(*pException);
+			it->second.notify();
+			_pending.erase(it);
+		}
+		else delete pHostEntry;
+		delete pException;
+	}
+}
+
+
+HostEntry DNSCache::resolve(const std::string& key, const std::string& hostname, unsigned hintFlags)
+{
+	++_lookups;
+	try
+	{
+		HostEntry hostEntry = lookup(hostname, hintFlags);
+		if (_enabled && _ttl > 0)
+		{
+			Entry entry;
+			entry.hostEntry = hostEntry;
+			entry.fresh     = Poco::Timestamp() + _ttl;
+			entry.expires   = entry.fresh + _staleTtl;
+			_cache.update(key, entry);
+		}
+		return hostEntry;
+	}
+	catch (HostNotFoundException& exc)
+	{
+		storeFailure(key, exc);
+		throw;
+	}
+	catch (NoAddressFoundException& exc)
+	{
+		storeFailure(key, exc);
+		throw;
+	}
+}
+
+
+void DNSCache::storeFailure(const std::string& key, const Poco::Exception& exc)
+{
+	if (_enabled && _negativeTtl > 0)
+	{
+		Entry entry;
+		entry.pException = exc.clone();
+		entry.fresh      = Poco::Timestamp() + _negativeTtl;
+		entry.expires    = entry.fresh;
+		_cache.update(key, entry);
+	}
+}
+
+
+DNSCache::Result DNSCache::enqueue(const std::string& key, const std::string& hostname, unsigned hintFlags)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	PendingMap::iterator it = _pending.find(key);
+	if (it != _pending.end()) return it->second;
+
+	startThreads();
+	Result result(new Poco::ActiveResultHolder<HostEntry>());
+	_pending.insert(PendingMap::value_type(key, result));
+	_queue.enqueueNotification(new LookupNotification(key, hostname, hintFlags));
+	return result;
+}
+
+
+void DNSCache::startThreads()
+{
+	while (static_cast<int>(_threads.size()) < _maxThreads)
+	{
+		Poco::Thread* pThread = new Poco::Thread("DNSCache");
+		try
+		{
+			pThread->start(*this);
+		}
+		catch (...)
+		{
+			delete pThread;
+			throw;
+		}
+		_threads.push_back(pThread);
+	}
+}
+
+
+std::string DNSCache::makeKey(const std::string& hostname, unsigned hintFlags)
+{
+	std::string key;
+	Poco::NumberFormatter::appendHex(key, hintFlags);
+	key += ':';
+	key += Poco::toLower(hostname);
+	return key;
+}
+
+
+namespace
+{
+	static Poco::SingletonHolder<DNSCache> singleton;
+}
+
+
+DNSCache& DNSCache::defaultCache()
+{
+	return *singleton.get();
+}
+
+
+} } // namespace Poco::Net
@@ -0,0 +1,113 @@
+//
+// FilePartHandler.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: Messages
+// Module:  FilePartHandler
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/FilePartHandler.h"
+#include "Poco/Net/MessageHeader.h"
+#include "Poco/Net/NameValueCollection.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/TemporaryFile.h"
+#include "Poco/FileStream.h"
+#include "Poco/Buffer.h"
+#include "Poco/File.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+FilePartHandler::FilePartHandler():
+	_maxPartSize(0),
+	_keepFiles(false)
+{
+}
+
+
+FilePartHandler::FilePartHandler(const std::string& directory):
+	_directory(directory),
+	_maxPartSize(0),
+	_keepFiles(false)
+{
+}
+
+
+FilePartHandler::~FilePartHandler()
+{
+	if (!_keepFiles)
+	{
+		for (PartVec::const_iterator it = _parts.begin(); it != _parts.end(); ++it)
+		{
+			try
+			{
+				Poco::File f(it->path);
+				if (f.exists()) f.remove();
+			}
+			catch (...)
+			{
+			}
+		}
+	}
+}
+
+
+void FilePartHandler::handlePart(const MessageHeader& header, std::istream& stream)
+{
+	Part part;
+	if (header.has("Content-Disposition"))
+	{
+		std::string disp;
+		NameValueCollection params;
+		MessageHeader::splitParameters(header.get("Content-Disposition"), disp, params);
+		part.name     = params.get("name", "");
+		part.filename = params.get("filename", "");
+	}
+	part.mediaType = header.get("Content-Type", "application/octet-stream");
+	part.path      = Poco::TemporaryFile::tempName(_directory);
+	part.size      = 0;
+	// register the part first, so that its file is deleted even if writing fails
+	_parts.push_back(part);
+
+	Poco::FileOutputStream ostr(part.path);
+	Poco::Buffer<char> buffer(BUFFER_SIZE);
+	while (stream.good())
+	{
+		stream.read(buffer.begin(), BUFFER_SIZE);
+		std::streamsize n = stream.gcount();
+		if (n == 0) break;
+		part.size += n;
+		if (_maxPartSize > 0 && part.size > _maxPartSize)
+			throw MessageException("Part too large");
+		ostr.write(buffer.begin(), n);
+		if (!ostr.good()) throw WriteFileException(part.path);
+	}
+	ostr.close();
+	if (!ostr.good()) throw WriteFileException(part.path);
+	_parts.back().size = part.size;
+}
+
+
+void FilePartHandler::setMaxPartSize(Poco::UInt64 maxSize)
+{
+	_maxPartSize = maxSize;
+}
+
+
+void FilePartHandler::keepFiles()
+{
+	_keepFiles = true;
+}
+
+
+} } // namespace Poco::Net
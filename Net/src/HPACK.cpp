@@ -0,0 +1,828 @@
+//
+// HPACK.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HPACK
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HPACK.h"
+#include "Poco/Net/HTTP2Connection.h"
+#include "Poco/Net/NetException.h"
+#include <algorithm>
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	struct StaticEntry
+	{
+		const char* name;
+		const char* value;
+	};
+
+	// RFC 7541, Appendix A.
+	const StaticEntry STATIC_TABLE[HPACKTable::STATIC_TABLE_LENGTH] =
+	{
+		{ ":authority", "" },
+		{ ":method", "GET" },
+		{ ":method", "POST" },
+		{ ":path", "/" },
+		{ ":path", "/index.html" },
+		{ ":scheme", "http" },
+		{ ":scheme", "https" },
+		{ ":status", "200" },
+		{ ":status", "204" },
+		{ ":status", "206" },
+		{ ":status", "304" },
+		{ ":status", "400" },
+		{ ":status", "404" },
+		{ ":status", "500" },
+		{ "accept-charset", "" },
+		{ "accept-encoding", "gzip, deflate" },
+		{ "accept-language", "" },
+		{ "accept-ranges", "" },
+		{ "accept", "" },
+		{ "access-control-allow-origin", "" },
+		{ "age", "" },
+		{ "allow", "" },
+		{ "authorization", "" },
+		{ "cache-control", "" },
+		{ "content-disposition", "" },
+		{ "content-encoding", "" },
+		{ "content-language", "" },
+		{ "content-length", "" },
+		{ "content-location", "" },
+		{ "content-range", "" },
+		{ "content-type", "" },
+		{ "cookie", "" },
+		{ "date", "" },
+		{ "etag", "" },
+		{ "expect", "" },
+		{ "expires", "" },
+		{ "from", "" },
+		{ "host", "" },
+		{ "if-match", "" },
+		{ "if-modified-since", "" },
+		{ "if-none-match", "" },
+		{ "if-range", "" },
+		{ "if-unmodified-since", "" },
+		{ "last-modified", "" },
+		{ "link", "" },
+		{ "location", "" },
+		{ "max-forwards", "" },
+		{ "proxy-authenticate", "" },
+		{ "proxy-authorization", "" },
+		{ "range", "" },
+		{ "referer", "" },
+		{ "refresh", "" },
+		{ "retry-after", "" },
+		{ "server", "" },
+		{ "set-cookie", "" },
+		{ "strict-transport-security", "" },
+		{ "transfer-encoding", "" },
+		{ "user-agent", "" },
+		{ "vary", "" },
+		{ "via", "" },
+		{ "www-authenticate", "" }
+	};
+
+	struct StaticFields
+	{
+		StaticFields()
+		{
+			for (int i = 0; i < HPACKTable::STATIC_TABLE_LENGTH; ++i)
+			{
+				fields[i].first  = STATIC_TABLE[i].name;
+				fields[i].second = STATIC_TABLE[i].value;
+			}
+		}
+
+		HPACKTable::Field fields[HPACKTable::STATIC_TABLE_LENGTH];
+	};
+
+	const StaticFields STATIC_FIELDS;
+
+	struct HuffmanCode
+	{
+		Poco::UInt32 code;
+		int bits;
+	};
+
+	// RFC 7541, Appendix B. Entry 256 is EOS.
+	const HuffmanCode HUFFMAN_CODES[257] =
+	{
+		{ 0x00001ff8, 13 },
+		{ 0x007fffd8, 23 },
+		{ 0x0fffffe2, 28 },
+		{ 0x0fffffe3, 28 },
+		{ 0x0fffffe4, 28 },
+		{ 0x0fffffe5, 28 },
+		{ 0x0fffffe6, 28 },
+		{ 0x0fffffe7, 28 },
+		{ 0x0fffffe8, 28 },
+		{ 0x00ffffea, 24 },
+		{ 0x3ffffffc, 30 },
+		{ 0x0fffffe9, 28 },
+		{ 0x0fffffea, 28 },
+		{ 0x3ffffffd, 30 },
+		{ 0x0fffffeb, 28 },
+		{ 0x0fffffec, 28 },
+		{ 0x0fffffed, 28 },
+		{ 0x0fffffee, 28 },
+		{ 0x0fffffef, 28 },
+		{ 0x0ffffff0, 28 },
+		{ 0x0ffffff1, 28 },
+		{ 0x0ffffff2, 28 },
+		{ 0x3ffffffe, 30 },
+		{ 0x0ffffff3, 28 },
+		{ 0x0ffffff4, 28 },
+		{ 0x0ffffff5, 28 },
+		{ 0x0ffffff6, 28 },
+		{ 0x0ffffff7, 28 },
+		{ 0x0ffffff8, 28 },
+		{ 0x0ffffff9, 28 },
+		{ 0x0ffffffa, 28 },
+		{ 0x0ffffffb, 28 },
+		{ 0x00000014,  6 },
+		{ 0x000003f8, 10 },
+		{ 0x000003f9, 10 },
+		{ 0x00000ffa, 12 },
+		{ 0x00001ff9, 13 },
+		{ 0x00000015,  6 },
+		{ 0x000000f8,  8 },
+		{ 0x000007fa, 11 },
+		{ 0x000003fa, 10 },
+		{ 0x000003fb, 10 },
+		{ 0x000000f9,  8 },
+		{ 0x000007fb, 11 },
+		{ 0x000000fa,  8 },
+		{ 0x00000016,  6 },
+		{ 0x00000017,  6 },
+		{ 0x00000018,  6 },
+		{ 0x00000000,  5 },
+		{ 0x00000001,  5 },
+		{ 0x00000002,  5 },
+		{ 0x00000019,  6 },
+		{ 0x0000001a,  6 },
+		{ 0x0000001b,  6 },
+		{ 0x0000001c,  6 },
+		{ 0x0000001d,  6 },
+		{ 0x0000001e,  6 },
+		{ 0x0000001f,  6 },
+		{ 0x0000005c,  7 },
+		{ 0x000000fb,  8 },
+		{ 0x00007ffc, 15 },
+		{ 0x00000020,  6 },
+		{ 0x00000ffb, 12 },
+		{ 0x000003fc, 10 },
+		{ 0x00001ffa, 13 },
+		{ 0x00000021,  6 },
+		{ 0x0000005d,  7 },
+		{ 0x0000005e,  7 },
+		{ 0x0000005f,  7 },
+		{ 0x00000060,  7 },
+		{ 0x00000061,  7 },
+		{ 0x00000062,  7 },
+		{ 0x00000063,  7 },
+		{ 0x00000064,  7 },
+		{ 0x00000065,  7 },
+		{ 0x00000066,  7 },
+		{ 0x00000067,  7 },
+		{ 0x00000068,  7 },
+		{ 0x00000069,  7 },
+		{ 0x0000006a,  7 },
+		{ 0x0000006b,  7 },
+		{ 0x0000006c,  7 },
+		{ 0x0000006d,  7 },
+		{ 0x0000006e,  7 },
+		{ 0x0000006f,  7 },
+		{ 0x00000070,  7 },
+		{ 0x00000071,  7 },
+		{ 0x00000072,  7 },
+		{ 0x000000fc,  8 },
+		{ 0x00000073,  7 },
+		{ 0x000000fd,  8 },
+		{ 0x00001ffb, 13 },
+		{ 0x0007fff0, 19 },
+		{ 0x00001ffc, 13 },
+		{ 0x00003ffc, 14 },
+		{ 0x00000022,  6 },
+		{ 0x00007ffd, 15 },
+		{ 0x00000003,  5 },
+		{ 0x00000023,  6 },
+		{ 0x00000004,  5 },
+		{ 0x00000024,  6 },
+		{ 0x00000005,  5 },
+		{ 0x00000025,  6 },
+		{ 0x00000026,  6 },
+		{ 0x00000027,  6 },
+		{ 0x00000006,  5 },
+		{ 0x00000074,  7 },
+		{ 0x00000075,  7 },
+		{ 0x00000028,  6 },
+		{ 0x00000029,  6 },
+		{ 0x0000002a,  6 },
+		{ 0x00000007,  5 },
+		{ 0x0000002b,  6 },
+		{ 0x00000076,  7 },
+		{ 0x0000002c,  6 },
+		{ 0x00000008,  5 },
+		{ 0x00000009,  5 },
+		{ 0x0000002d,  6 },
+		{ 0x00000077,  7 },
+		{ 0x00000078,  7 },
+		{ 0x00000079,  7 },
+		{ 0x0000007a,  7 },
+		{ 0x0000007b,  7 },
+		{ 0x00007ffe, 15 },
+		{ 0x000007fc, 11 },
+		{ 0x00003ffd, 14 },
+		{ 0x00001ffd, 13 },
+		{ 0x0ffffffc, 28 },
+		{ 0x000fffe6, 20 },
+		{ 0x003fffd2, 22 },
+		{ 0x000fffe7, 20 },
+		{ 0x000fffe8, 20 },
+		{ 0x003fffd3, 22 },
+		{ 0x003fffd4, 22 },
+		{ 0x003fffd5, 22 },
+		{ 0x007fffd9, 23 },
+		{ 0x003fffd6, 22 },
+		{ 0x007fffda, 23 },
+		{ 0x007fffdb, 23 },
+		{ 0x007fffdc, 23 },
+		{ 0x007fffdd, 23 },
+		{ 0x007fffde, 23 },
+		{ 0x00ffffeb, 24 },
+		{ 0x007fffdf, 23 },
+		{ 0x00ffffec, 24 },
+		{ 0x00ffffed, 24 },
+		{ 0x003fffd7, 22 },
+		{ 0x007fffe0, 23 },
+		{ 0x00ffffee, 24 },
+		{ 0x007fffe1, 23 },
+		{ 0x007fffe2, 23 },
+		{ 0x007fffe3, 23 },
+		{ 0x007fffe4, 23 },
+		{ 0x001fffdc, 21 },
+		{ 0x003fffd8, 22 },
+		{ 0x007fffe5, 23 },
+		{ 0x003fffd9, 22 },
+		{ 0x007fffe6, 23 },
+		{ 0x007fffe7, 23 },
+		{ 0x00ffffef, 24 },
+		{ 0x003fffda, 22 },
+		{ 0x001fffdd, 21 },
+		{ 0x000fffe9, 20 },
+		{ 0x003fffdb, 22 },
+		{ 0x003fffdc, 22 },
+		{ 0x007fffe8, 23 },
+		{ 0x007fffe9, 23 },
+		{ 0x001fffde, 21 },
+		{ 0x007fffea, 23 },
+		{ 0x003fffdd, 22 },
+		{ 0x003fffde, 22 },
+		{ 0x00fffff0, 24 },
+		{ 0x001fffdf, 21 },
+		{ 0x003fffdf, 22 },
+		{ 0x007fffeb, 23 },
+		{ 0x007fffec, 23 },
+		{ 0x001fffe0, 21 },
+		{ 0x001fffe1, 21 },
+		{ 0x003fffe0, 22 },
+		{ 0x001fffe2, 21 },
+		{ 0x007fffed, 23 },
+		{ 0x003fffe1, 22 },
+		{ 0x007fffee, 23 },
+		{ 0x007fffef, 23 },
+		{ 0x000fffea, 20 },
+		{ 0x003fffe2, 22 },
+		{ 0x003fffe3, 22 },
+		{ 0x003fffe4, 22 },
+		{ 0x007ffff0, 23 },
+		{ 0x003fffe5, 22 },
+		{ 0x003fffe6, 22 },
+		{ 0x007ffff1, 23 },
+		{ 0x03ffffe0, 26 },
+		{ 0x03ffffe1, 26 },
+		{ 0x000fffeb, 20 },
+		{ 0x0007fff1, 19 },
+		{ 0x003fffe7, 22 },
+		{ 0x007ffff2, 23 },
+		{ 0x003fffe8, 22 },
+		{ 0x01ffffec, 25 },
+		{ 0x03ffffe2, 26 },
+		{ 0x03ffffe3, 26 },
+		{ 0x03ffffe4, 26 },
+		{ 0x07ffffde, 27 },
+		{ 0x07ffffdf, 27 },
+		{ 0x03ffffe5, 26 },
+		{ 0x00fffff1, 24 },
+		{ 0x01ffffed, 25 },
+		{ 0x0007fff2, 19 },
+		{ 0x001fffe3, 21 },
+		{ 0x03ffffe6, 26 },
+		{ 0x07ffffe0, 27 },
+		{ 0x07ffffe1, 27 },
+		{ 0x03ffffe7, 26 },
+		{ 0x07ffffe2, 27 },
+		{ 0x00fffff2, 24 },
+		{ 0x001fffe4, 21 },
+		{ 0x001fffe5, 21 },
+		{ 0x03ffffe8, 26 },
+		{ 0x03ffffe9, 26 },
+		{ 0x0ffffffd, 28 },
+		{ 0x07ffffe3, 27 },
+		{ 0x07ffffe4, 27 },
+		{ 0x07ffffe5, 27 },
+		{ 0x000fffec, 20 },
+		{ 0x00fffff3, 24 },
+		{ 0x000fffed, 20 },
+		{ 0x001fffe6, 21 },
+		{ 0x003fffe9, 22 },
+		{ 0x001fffe7, 21 },
+		{ 0x001fffe8, 21 },
+		{ 0x007ffff3, 23 },
+		{ 0x003fffea, 22 },
+		{ 0x003fffeb, 22 },
+		{ 0x01ffffee, 25 },
+		{ 0x01ffffef, 25 },
+		{ 0x00fffff4, 24 },
+		{ 0x00fffff5, 24 },
+		{ 0x03ffffea, 26 },
+		{ 0x007ffff4, 23 },
+		{ 0x03ffffeb, 26 },
+		{ 0x07ffffe6, 27 },
+		{ 0x03ffffec, 26 },
+		{ 0x03ffffed, 26 },
+		{ 0x07ffffe7, 27 },
+		{ 0x07ffffe8, 27 },
+		{ 0x07ffffe9, 27 },
+		{ 0x07ffffea, 27 },
+		{ 0x07ffffeb, 27 },
+		{ 0x0ffffffe, 28 },
+		{ 0x07ffffec, 27 },
+		{ 0x07ffffed, 27 },
+		{ 0x07ffffee, 27 },
+		{ 0x07ffffef, 27 },
+		{ 0x07fffff0, 27 },
+		{ 0x03ffffee, 26 },
+		{ 0x3fffffff, 30 }
+	};
+
+	class HuffmanDecodeTable
+		/// Canonical Huffman decoding tables, built from HUFFMAN_CODES.
+		/// The codes of each length are consecutive, so a code of
+		/// length n is decoded by subtracting the first code of that
+		/// length and looking up the symbol.
+	{
+	public:
+		enum
+		{
+			MAX_BITS = 30
+		};
+
+		HuffmanDecodeTable()
+		{
+			for (int i = 0; i <= MAX_BITS; ++i)
+			{
+				first[i] = 0;
+				count[i] = 0;
+				offset[i] = 0;
+			}
+			for (int s = 0; s < 257; ++s) count[HUFFMAN_CODES[s].bits]++;
+			int pos = 0;
+			for (int i = 1; i <= MAX_BITS; ++i)
+			{
+				offset[i] = pos;
+				pos += count[i];
+			}
+			int fill[MAX_BITS + 1];
+			std::copy(offset, offset + MAX_BITS + 1, fill);
+			for (int s = 0; s < 257; ++s)
+			{
+				int bits = HUFFMAN_CODES[s].bits;
+				if (fill[bits] == offset[bits]) first[bits] = HUFFMAN_CODES[s].code;
+				symbols[fill[bits]++] = s;
+			}
+		}
+
+		Poco::UInt32 first[MAX_BITS + 1];
+		int count[MAX_BITS + 1];
+		int offset[MAX_BITS + 1];
+		int symbols[257];
+	};
+
+	const HuffmanDecodeTable HUFFMAN_DECODE_TABLE;
+
+	bool isSensitive(const std::string& name, const std::string& value)
+	{
+		// Short cookies are easy to guess by observing the
+		// compressed size, see RFC 7541, section 7.1.3.
+		return name == "authorization"
+			|| name == "proxy-authorization"
+			|| (name == "cookie" && value.size() < 20);
+	}
+
+	void compressionError(const std::string& msg)
+	{
+		throw HTTP2Exception("HPACK decoding error", msg, HTTP2Connection::H2_COMPRESSION_ERROR);
+	}
+}
+
+
+//
+// HPACKTable
+//
+
+
+HPACKTable::HPACKTable(std::size_t maxSize):
+	_size(0),
+	_maxSize(maxSize)
+{
+}
+
+
+HPACKTable::~HPACKTable()
+{
+}
+
+
+void HPACKTable::setMaxSize(std::size_t maxSize)
+{
+	evict(maxSize);
+	_maxSize = maxSize;
+}
+
+
+const HPACKTable::Field& HPACKTable::get(std::size_t index) const
+{
+	if (index == 0 || index > length())
+		throw HTTP2Exception("Invalid HPACK table index", HTTP2Connection::H2_COMPRESSION_ERROR);
+	if (index > STATIC_TABLE_LENGTH)
+		return _entries[index - STATIC_TABLE_LENGTH - 1];
+	else
+		return STATIC_FIELDS.fields[index - 1];
+}
+
+
+void HPACKTable::add(const std::string& name, const std::string& value)
+{
+	std::size_t entrySize = name.size() + value.size() + ENTRY_OVERHEAD;
+	if (entrySize > _maxSize)
+	{
+		// RFC 7541, section 4.4: an entry larger than the
+		// table empties the table and is not added.
+		evict(0);
+		return;
+	}
+	evict(_maxSize - entrySize);
+	_entries.push_front(Field(name, value));
+	_size += entrySize;
+}
+
+
+std::size_t HPACKTable::find(const std::string& name, const std::string& value, bool& valueMatch) const
+{
+	std::size_t nameIndex = 0;
+	valueMatch = false;
+	for (std::size_t i = 0; i < STATIC_TABLE_LENGTH; ++i)
+	{
+		if (name == STATIC_TABLE[i].name)
+		{
+			if (value == STATIC_TABLE[i].value)
+			{
+				valueMatch = true;
+				return i + 1;
+			}
+			if (nameIndex == 0) nameIndex = i + 1;
+		}
+	}
+	for (std::size_t i = 0; i < _entries.size(); ++i)
+	{
+		const Field& field = _entries[i];
+		if (field.first == name)
+		{
+			if (field.second == value)
+			{
+				valueMatch = true;
+				return i + STATIC_TABLE_LENGTH + 1;
+			}
+			if (nameIndex == 0) nameIndex = i + STATIC_TABLE_LENGTH + 1;
+		}
+	}
+	return nameIndex;
+}
+
+
+void HPACKTable::evict(std::size_t maxSize)
+{
+	while (_size > maxSize)
+	{
+		const Field& field = _entries.back();
+		_size -= field.first.size() + field.second.size() + ENTRY_OVERHEAD;
+		_entries.pop_back();
+	}
+}
+
+
+//
+// HPACKEncoder
+//
+
+
+HPACKEncoder::HPACKEncoder():
+	_pendingSize(HPACKTable::DEFAULT_TABLE_SIZE),
+	_sizeUpdate(false)
+{
+}
+
+
+HPACKEncoder::~HPACKEncoder()
+{
+}
+
+
+void HPACKEncoder::setMaxTableSize(std::size_t maxSize)
+{
+	// We never use a larger table than the default, even
+	// if the decoder allows it.
+	maxSize = std::min<std::size_t>(maxSize, HPACKTable::DEFAULT_TABLE_SIZE);
+	if (maxSize != _table.maxSize() || _sizeUpdate)
+	{
+		_pendingSize = maxSize;
+		_sizeUpdate = true;
+	}
+}
+
+
+void HPACKEncoder::encode(const HPACKTable::FieldList& fields, std::string& block)
+{
+	if (_sizeUpdate)
+	{
+		_table.setMaxSize(_pendingSize);
+		encodeInteger(static_cast<Poco::UInt32>(_pendingSize), 5, 0x20, block);
+		_sizeUpdate = false;
+	}
+	for (HPACKTable::FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it)
+	{
+		const std::string& name  = it->first;
+		const std::string& value = it->second;
+		bool valueMatch;
+		std::size_t index = _table.find(name, value, valueMatch);
+		if (isSensitive(name, value))
+		{
+			encodeInteger(static_cast<Poco::UInt32>(index), 4, 0x10, block);
+			if (index == 0) encodeString(name, block);
+			encodeString(value, block);
+		}
+		else if (valueMatch)
+		{
+			encodeInteger(static_cast<Poco::UInt32>(index), 7, 0x80, block);
+		}
+		else if (name.size() + value.size() + HPACKTable::ENTRY_OVERHEAD <= _table.maxSize())
+		{
+			encodeInteger(static_cast<Poco::UInt32>(index), 6, 0x40, block);
+			if (index == 0) encodeString(name, block);
+			encodeString(value, block);
+			_table.add(name, value);
+		}
+		else
+		{
+			encodeInteger(static_cast<Poco::UInt32>(index), 4, 0x00, block);
+			if (index == 0) encodeString(name, block);
+			encodeString(value, block);
+		}
+	}
+}
+
+
+void HPACKEncoder::encodeInteger(Poco::UInt32 value, int prefixBits, unsigned char flags, std::string& output)
+{
+	Poco::UInt32 maxPrefix = (1U << prefixBits) - 1;
+	if (value < maxPrefix)
+	{
+		output += static_cast<char>(flags | value);
+	}
+	else
+	{
+		output += static_cast<char>(flags | maxPrefix);
+		value -= maxPrefix;
+		while (value >= 0x80)
+		{
+			output += static_cast<char>((value & 0x7F) | 0x80);
+			value >>= 7;
+		}
+		output += static_cast<char>(value);
+	}
+}
+
+
+void HPACKEncoder::encodeString(const std::string& value, std::string& output)
+{
+	std::size_t huffLength = huffmanLength(value);
+	if (huffLength <= value.size() && !value.empty())
+	{
+		encodeInteger(static_cast<Poco::UInt32>(huffLength), 7, 0x80, output);
+		huffmanEncode(value, output);
+	}
+	else
+	{
+		encodeInteger(static_cast<Poco::UInt32>(value.size()), 7, 0x00, output);
+		output += value;
+	}
+}
+
+
+void HPACKEncoder::huffmanEncode(const std::string& value, std::string& output)
+{
+	Poco::UInt64 bits = 0;
+	int n = 0;
+	for (std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+	{
+		const HuffmanCode& hc = HUFFMAN_CODES[static_cast<unsigned char>(*it)];
+		bits = (bits << hc.bits) | hc.code;
+		n += hc.bits;
+		while (n >= 8)
+		{
+			n -= 8;
+			output += static_cast<char>(bits >> n);
+		}
+	}
+	if (n > 0)
+	{
+		// pad with the most significant bits of EOS
+		output += static_cast<char>((bits << (8 - n)) | (0xFF >> n));
+	}
+}
+
+
+std::size_t HPACKEncoder::huffmanLength(const std::string& value)
+{
+	std::size_t bits = 0;
+	for (std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+	{
+		bits += HUFFMAN_CODES[static_cast<unsigned char>(*it)].bits;
+	}
+	return (bits + 7)/8;
+}
+
+
+//
+// HPACKDecoder
+//
+
+
+HPACKDecoder::HPACKDecoder():
+	_maxTableSize(HPACKTable::DEFAULT_TABLE_SIZE),
+	_maxHeaderListSize(DEFAULT_MAX_HEADER_LIST_SIZE)
+{
+}
+
+
+HPACKDecoder::~HPACKDecoder()
+{
+}
+
+
+void HPACKDecoder::setMaxTableSize(std::size_t maxSize)
+{
+	_maxTableSize = maxSize;
+	if (_table.maxSize() > maxSize) _table.setMaxSize(maxSize);
+}
+
+
+void HPACKDecoder::setMaxHeaderListSize(std::size_t maxSize)
+{
+	_maxHeaderListSize = maxSize;
+}
+
+
+void HPACKDecoder::decode(const char* block, std::size_t length, HPACKTable::FieldList& fields)
+{
+	const unsigned char* it  = reinterpret_cast<const unsigned char*>(block);
+	const unsigned char* end = it + length;
+	std::size_t listSize = 0;
+	bool first = true;
+	while (it != end)
+	{
+		unsigned char c = *it;
+		std::string name;
+		std::string value;
+		if (c & 0x80)
+		{
+			// indexed header field
+			const HPACKTable::Field& field = _table.get(decodeInteger(it, end, 7));
+			name  = field.first;
+			value = field.second;
+		}
+		else if ((c & 0xE0) == 0x20)
+		{
+			// dynamic table size update
+			if (!first) compressionError("table size update after header field");
+			Poco::UInt32 size = decodeInteger(it, end, 5);
+			if (size > _maxTableSize) compressionError("table size update exceeds limit");
+			_table.setMaxSize(size);
+			continue;
+		}
+		else
+		{
+			// literal header field, with incremental indexing (01),
+			// without indexing (0000) or never indexed (0001)
+			bool indexing = (c & 0xC0) == 0x40;
+			Poco::UInt32 index = decodeInteger(it, end, indexing ? 6 : 4);
+			if (index)
+				name = _table.get(index).first;
+			else
+				decodeString(it, end, name);
+			decodeString(it, end, value);
+			if (indexing) _table.add(name, value);
+		}
+		first = false;
+		listSize += name.size() + value.size() + HPACKTable::ENTRY_OVERHEAD;
+		if (listSize > _maxHeaderListSize) compressionError("header list too large");
+		fields.push_back(HPACKTable::Field(name, value));
+	}
+}
+
+
+Poco::UInt32 HPACKDecoder::decodeInteger(const unsigned char*& it, const unsigned char* end, int prefixBits)
+{
+	if (it == end) compressionError("truncated integer");
+	Poco::UInt32 maxPrefix = (1U << prefixBits) - 1;
+	Poco::UInt32 value = *it++ & maxPrefix;
+	if (value < maxPrefix) return value;
+	int shift = 0;
+	unsigned char c;
+	do
+	{
+		if (it == end) compressionError("truncated integer");
+		if (shift > 21) compressionError("integer overflow");
+		c = *it++;
+		value += static_cast<Poco::UInt32>(c & 0x7F) << shift;
+		shift += 7;
+	}
+	while (c & 0x80);
+	return value;
+}
+
+
+void HPACKDecoder::decodeString(const unsigned char*& it, const unsigned char* end, std::string& value)
+{
+	if (it == end) compressionError("truncated string");
+	bool huffman = (*it & 0x80) != 0;
+	Poco::UInt32 length = decodeInteger(it, end, 7);
+	if (length > static_cast<std::size_t>(end - it)) compressionError("truncated string");
+	if (huffman)
+		huffmanDecode(it, length, value);
+	else
+		value.assign(reinterpret_cast<const char*>(it), length);
+	it += length;
+}
+
+
+void HPACKDecoder::huffmanDecode(const unsigned char* data, std::size_t length, std::string& output)
+{
+	const HuffmanDecodeTable& t = HUFFMAN_DECODE_TABLE;
+	Poco::UInt32 code = 0;
+	int bits = 0;
+	for (std::size_t i = 0; i < length; ++i)
+	{
+		unsigned char c = data[i];
+		for (int b = 7; b >= 0; --b)
+		{
+			code = (code << 1) | ((c >> b) & 1);
+			++bits;
+			if (bits >= 5 && code - t.first[bits] < static_cast<Poco::UInt32>(t.count[bits]))
+			{
+				int sym = t.symbols[t.offset[bits] + code - t.first[bits]];
+				if (sym == 256) compressionError("EOS in Huffman string");
+				output += static_cast<char>(sym);
+				code = 0;
+				bits = 0;
+			}
+			else if (bits == HuffmanDecodeTable::MAX_BITS)
+			{
+				compressionError("invalid Huffman code");
+			}
+		}
+	}
+	// RFC 7541, section 5.2: padding must be shorter
+	// than 8 bits and consist of the EOS prefix.
+	if (bits > 7 || code != (1U << bits) - 1) compressionError("invalid Huffman padding");
+}
+
+
+} } // namespace Poco::Net
@@ -26,16 +26,18 @@
 #include "Poco/CountingStream.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/URI.h"
+#include "Poco/URIView.h"
 #include "Poco/String.h"
 #include "Poco/CountingStream.h"
-#include "Poco/UTF8String.h"
 #include <sstream>
 
 
 using Poco::NullInputStream;
+using Poco::NullOutputStream;
 using Poco::StreamCopier;
 using Poco::SyntaxException;
 using Poco::URI;
+using Poco::URIView;
 using Poco::icompare;
 
 
@@ -136,12 +138,10 @@ void HTMLForm::load(const HTTPRequest& request, std::istream& requestBody, PartH
 {
 	clear();
 
-	URI uri(request.getURI());
-	const std::string& query = uri.getRawQuery();
+	const URIView::Range& query = request.getURIView().query();
 	if (!query.empty())
 	{
-		std::istringstream istr(query);
-		readUrl(istr);
+		readUrl(query.begin(), query.end());
 	}
 
 	if (request.getMethod() == HTTPRequest::HTTP_POST || request.getMethod() == HTTPRequest::HTTP_PUT)
@@ -195,8 +195,7 @@ void HTMLForm::read(std::istream& istr)
 
 void HTMLForm::read(const std::string& queryString)
 {
-	std::istringstream istr(queryString);
-	readUrl(istr);
+	readUrl(queryString.data(), queryString.data() + queryString.size());
 }
 
 
@@ -282,54 +281,76 @@ void HTMLForm::write(std::ostream& ostr)
 
 void HTMLForm::readUrl(std::istream& istr)
 {
+	// The body is read one field at a time, so that the field
+	// limits are enforced before the whole body has been read.
 	static const int eof = std::char_traits<char>::eof();
+	static const std::size_t MAX_FIELD_LENGTH = MAX_NAME_LENGTH + MAX_VALUE_LENGTH + 2;
 
+	std::streambuf& buf = *istr.rdbuf();
 	int fields = 0;
-	int ch = istr.get();
-	bool isFirst = true;
+	std::string field;
+	int ch = buf.sbumpc();
 	while (ch != eof)
 	{
-		if (_fieldLimit > 0 && fields == _fieldLimit)
-			throw HTMLFormException("Too many form fields");
-		std::string name;
-		std::string value;
-		while (ch != eof && ch != '=' && ch != '&')
+		field.clear();
+		while (ch != eof && ch != '&')
 		{
-			if (ch == '+') ch = ' ';
-			name += (char) ch;
-			ch = istr.get();
+			if (field.size() == MAX_FIELD_LENGTH)
+				throw HTMLFormException("Form field too long");
+			field += static_cast<char>(ch);
+			ch = buf.sbumpc();
 		}
-		if (ch == '=')
+		if (ch == '&')
 		{
-			ch = istr.get();
-			while (ch != eof && ch != '&')
-			{
-				if (ch == '+') ch = ' ';
-				value += (char) ch;
-				ch = istr.get();
-			}
+			// keep the separator, so that an empty
+			// field is read as in a query string
+			field += '&';
+			ch = buf.sbumpc();
 		}
+		readUrl(field.data(), field.data() + field.size(), fields);
+	}
+}
+
+
+void HTMLForm::readUrl(const char* begin, const char* end)
+{
+	int fields = 0;
+	readUrl(begin, end, fields);
+}
+
+
+void HTMLForm::readUrl(const char* begin, const char* end, int& fields)
+{
+	std::string name;
+	std::string value;
+	URIView::QueryIterator it(URIView::Range(begin, end));
+	while (it.next())
+	{
+		if (_fieldLimit > 0 && fields == _fieldLimit)
+			throw HTMLFormException("Too many form fields");
+		if (it.name().size() > MAX_NAME_LENGTH)
+			throw HTMLFormException("Field name too long");
+		if (it.value().size() > MAX_VALUE_LENGTH)
+			throw HTMLFormException("Field value too long");
+		URIView::Range encodedName(it.name());
 		// remove UTF-8 byte order mark from first name, if present
-		if (isFirst)
+		if (fields == 0 && encodedName.size() >= 3
+			&& static_cast<unsigned char>(encodedName.begin()[0]) == 0xEF
+			&& static_cast<unsigned char>(encodedName.begin()[1]) == 0xBB
+			&& static_cast<unsigned char>(encodedName.begin()[2]) == 0xBF)
 		{
-			UTF8::removeBOM(name);
+			encodedName = URIView::Range(encodedName.begin() + 3, encodedName.end());
 		}
-		std::string decodedName;
-		std::string decodedValue;
-		URI::decode(name, decodedName);
-		URI::decode(value, decodedValue);
-		add(decodedName, decodedValue);
+		URIView::decode(encodedName, name, true);
+		it.decodeValue(value);
+		add(name, value);
 		++fields;
-		if (ch == '&') ch = istr.get();
-		isFirst = false;
 	}
 }
 
 
 void HTMLForm::readMultipart(std::istream& istr, PartHandler& handler)
 {
-	static const int eof = std::char_traits<char>::eof();
-
 	int fields = 0;
 	MultipartReader reader(istr, _boundary);
 	while (reader.hasNextPart())
@@ -349,19 +370,14 @@ void HTMLForm::readMultipart(std::istream& istr, PartHandler& handler)
 		{
 			handler.handlePart(header, reader.stream());
 			// Ensure that the complete part has been read.
-			while (reader.stream().good()) reader.stream().get();
+			NullOutputStream nos;
+			StreamCopier::copyStream(reader.stream(), nos);
 		}
 		else
 		{
 			std::string name = params["name"];
 			std::string value;
-			std::istream& istr = reader.stream();
-			int ch = istr.get();
-			while (ch != eof)
-			{
-				value += (char) ch;
-				ch = istr.get();
-			}
+			StreamCopier::copyToString(reader.stream(), value);
 			add(name, value);
 		}
 		++fields;
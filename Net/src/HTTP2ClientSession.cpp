@@ -0,0 +1,170 @@
+//
+// HTTP2ClientSession.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2ClientSession
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTP2ClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/NumberParser.h"
+#include "Poco/String.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+HTTP2ClientSession::HTTP2ClientSession(const std::string& host, Poco::UInt16 port):
+	_host(host),
+	_connection(*this, false),
+	_runnable(_connection, &HTTP2Connection::run)
+{
+	connect(SocketAddress(host, port));
+	startConnection();
+}
+
+
+HTTP2ClientSession::HTTP2ClientSession(const StreamSocket& socket):
+	HTTPSession(socket),
+	_connection(*this, false),
+	_runnable(_connection, &HTTP2Connection::run)
+{
+	_host = this->socket().peerAddress().host().toString();
+	this->socket().setNoDelay(true);
+	startConnection();
+}
+
+
+HTTP2ClientSession::~HTTP2ClientSession()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+HTTP2Stream::Ptr HTTP2ClientSession::sendRequest(const HTTPRequest& request)
+{
+	HPACKTable::FieldList fields;
+	requestHeaders(request, fields);
+	return _connection.openStream(fields, true);
+}
+
+
+HTTP2Stream::Ptr HTTP2ClientSession::sendRequest(const HTTPRequest& request, const std::string& body)
+{
+	HPACKTable::FieldList fields;
+	requestHeaders(request, fields);
+	HTTP2Stream::Ptr pStream = _connection.openStream(fields, body.empty());
+	if (!body.empty())
+	{
+		_connection.sendData(*pStream, body.data(), body.size(), true);
+	}
+	return pStream;
+}
+
+
+HTTP2Stream::Ptr HTTP2ClientSession::sendRequestHeader(const HTTPRequest& request)
+{
+	HPACKTable::FieldList fields;
+	requestHeaders(request, fields);
+	return _connection.openStream(fields, false);
+}
+
+
+void HTTP2ClientSession::receiveResponse(HTTP2Stream::Ptr pStream, HTTPResponse& response)
+{
+	HPACKTable::FieldList fields;
+	int status = 0;
+	do
+	{
+		fields.clear();
+		if (!_connection.receiveHeaders(*pStream, fields))
+			throw NoMessageException("No HTTP/2 response received");
+		if (fields.empty() || fields[0].first != ":status")
+			throw MessageException("Missing HTTP/2 :status field");
+		if (!NumberParser::tryParse(fields[0].second, status))
+			throw MessageException("Invalid HTTP/2 status", fields[0].second);
+	}
+	while (status >= 100 && status < 200);
+
+	response.clear();
+	response.setVersion("HTTP/2.0");
+	response.setStatusAndReason(static_cast<HTTPResponse::HTTPStatus>(status));
+	for (HPACKTable::FieldList::const_iterator it = fields.begin() + 1; it != fields.end(); ++it)
+	{
+		if (it->first.empty() || it->first[0] == ':')
+			throw MessageException("Invalid HTTP/2 pseudo-header field", it->first);
+		response.add(it->first, it->second);
+	}
+}
+
+
+void HTTP2ClientSession::cancel(HTTP2Stream::Ptr pStream)
+{
+	_connection.resetStream(*pStream, HTTP2Connection::H2_CANCEL);
+}
+
+
+void HTTP2ClientSession::close()
+{
+	if (_thread.isRunning())
+	{
+		try
+		{
+			_connection.shutdown();
+			socket().shutdown();
+		}
+		catch (Poco::Exception&)
+		{
+		}
+		_thread.join();
+	}
+	HTTPSession::close();
+}
+
+
+void HTTP2ClientSession::startConnection()
+{
+	_connection.start(HTTP2Connection::Settings());
+	_thread.start(_runnable);
+}
+
+
+void HTTP2ClientSession::requestHeaders(const HTTPRequest& request, HPACKTable::FieldList& fields) const
+{
+	fields.reserve(request.size() + 4);
+	fields.push_back(HPACKTable::Field(":method", request.getMethod()));
+	fields.push_back(HPACKTable::Field(":scheme", const_cast<HTTP2ClientSession*>(this)->socket().secure() ? "https" : "http"));
+	fields.push_back(HPACKTable::Field(":authority", request.has(HTTPRequest::HOST) ? request.getHost() : _host));
+	fields.push_back(HPACKTable::Field(":path", request.getURI()));
+	for (HTTPRequest::ConstIterator it = request.begin(); it != request.end(); ++it)
+	{
+		std::string name = Poco::toLower(it->first);
+		// RFC 7540, section 8.1.2.2
+		if (name != "host" && name != "connection" && name != "keep-alive" && name != "proxy-connection" && name != "transfer-encoding" && name != "upgrade")
+		{
+			fields.push_back(HPACKTable::Field(name, it->second));
+		}
+	}
+}
+
+
+} } // namespace Poco::Net
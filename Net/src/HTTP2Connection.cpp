@@ -0,0 +1,974 @@
+//
+// HTTP2Connection.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2Connection
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTP2Connection.h"
+#include "Poco/Net/HTTPSession.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Exception.h"
+#include <algorithm>
+#include <cstring>
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	void put16(char* p, Poco::UInt16 value)
+	{
+		p[0] = static_cast<char>(value >> 8);
+		p[1] = static_cast<char>(value);
+	}
+
+	void put24(char* p, Poco::UInt32 value)
+	{
+		p[0] = static_cast<char>(value >> 16);
+		p[1] = static_cast<char>(value >> 8);
+		p[2] = static_cast<char>(value);
+	}
+
+	void put32(char* p, Poco::UInt32 value)
+	{
+		p[0] = static_cast<char>(value >> 24);
+		p[1] = static_cast<char>(value >> 16);
+		p[2] = static_cast<char>(value >> 8);
+		p[3] = static_cast<char>(value);
+	}
+
+	Poco::UInt16 get16(const char* p)
+	{
+		const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+		return static_cast<Poco::UInt16>((u[0] << 8) | u[1]);
+	}
+
+	Poco::UInt32 get24(const char* p)
+	{
+		const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+		return (static_cast<Poco::UInt32>(u[0]) << 16) | (u[1] << 8) | u[2];
+	}
+
+	Poco::UInt32 get32(const char* p)
+	{
+		const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+		return (static_cast<Poco::UInt32>(u[0]) << 24) | (u[1] << 16) | (u[2] << 8) | u[3];
+	}
+
+	void connectionError(const std::string& msg, Poco::UInt32 errorCode)
+	{
+		throw HTTP2Exception(msg, static_cast<int>(errorCode));
+	}
+}
+
+
+const std::string HTTP2Connection::PREFACE("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n");
+
+
+HTTP2Connection::Settings::Settings():
+	headerTableSize(HPACKTable::DEFAULT_TABLE_SIZE),
+	enablePush(0),
+	maxConcurrentStreams(100),
+	initialWindowSize(DEFAULT_WINDOW_SIZE),
+	maxFrameSize(DEFAULT_FRAME_SIZE),
+	maxHeaderListSize(HPACKDecoder::DEFAULT_MAX_HEADER_LIST_SIZE)
+{
+}
+
+
+HTTP2Connection::HTTP2Connection(HTTPSession& session, bool server):
+	_session(session),
+	_server(server),
+	_nextStreamId(server ? 2 : 1),
+	_lastPeerStreamId(0),
+	_sendWindow(DEFAULT_WINDOW_SIZE),
+	_receiveWindow(DEFAULT_WINDOW_SIZE),
+	_unacknowledged(0),
+	_closed(false),
+	_goingAway(false),
+	_peerGoingAway(false),
+	_payload(DEFAULT_FRAME_SIZE),
+	_payloadLength(0),
+	_headerStreamId(0),
+	_headerEndStream(false)
+{
+	// Until the peer's SETTINGS frame arrives, the protocol
+	// defaults apply, including an unlimited number of streams.
+	_peerSettings.enablePush = 1;
+	_peerSettings.maxConcurrentStreams = 0xFFFFFFFF;
+	_peerSettings.maxHeaderListSize = 0xFFFFFFFF;
+}
+
+
+HTTP2Connection::~HTTP2Connection()
+{
+}
+
+
+void HTTP2Connection::start(const Settings& settings)
+{
+	_localSettings = settings;
+	_localSettings.enablePush = 0;
+	_localSettings.maxFrameSize = DEFAULT_FRAME_SIZE;
+	_decoder.setMaxTableSize(_localSettings.headerTableSize);
+	_decoder.setMaxHeaderListSize(_localSettings.maxHeaderListSize);
+
+	char payload[5*6];
+	char* p = payload;
+	if (!_server)
+	{
+		_session.write(PREFACE.data(), static_cast<std::streamsize>(PREFACE.size()));
+		put16(p, SETTINGS_ENABLE_PUSH); put32(p + 2, 0); p += 6;
+	}
+	put16(p, SETTINGS_HEADER_TABLE_SIZE); put32(p + 2, _localSettings.headerTableSize); p += 6;
+	put16(p, SETTINGS_MAX_CONCURRENT_STREAMS); put32(p + 2, _localSettings.maxConcurrentStreams); p += 6;
+	put16(p, SETTINGS_INITIAL_WINDOW_SIZE); put32(p + 2, _localSettings.initialWindowSize); p += 6;
+	put16(p, SETTINGS_MAX_HEADER_LIST_SIZE); put32(p + 2, _localSettings.maxHeaderListSize); p += 6;
+	writeFrame(FRAME_SETTINGS, 0, 0, payload, p - payload);
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		_receiveWindow = CONNECTION_WINDOW_SIZE;
+	}
+	writeWindowUpdate(0, CONNECTION_WINDOW_SIZE - DEFAULT_WINDOW_SIZE);
+}
+
+
+void HTTP2Connection::run()
+{
+	Poco::UInt32 errorCode = H2_NO_ERROR;
+	try
+	{
+		Poco::UInt8 type;
+		Poco::UInt8 flags;
+		Poco::UInt32 streamId;
+		while (readFrame(type, flags, streamId))
+		{
+			processFrame(type, flags, streamId);
+			updateReceiveWindow();
+		}
+	}
+	catch (HTTP2Exception& exc)
+	{
+		errorCode = exc.code();
+		try
+		{
+			writeGoAway(errorCode);
+		}
+		catch (...)
+		{
+		}
+	}
+	catch (Poco::Exception&)
+	{
+		errorCode = H2_CONNECT_ERROR;
+	}
+
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	_closed = true;
+	for (StreamMap::iterator it = _streams.begin(); it != _streams.end(); ++it)
+	{
+		HTTP2Stream& stream = *it->second;
+		if (!stream._remoteClosed || !stream._localClosed)
+		{
+			stream._reset = true;
+			stream._errorCode = errorCode == H2_NO_ERROR ? static_cast<Poco::UInt32>(H2_CANCEL) : errorCode;
+		}
+	}
+	_streams.clear();
+	_condition.broadcast();
+}
+
+
+void HTTP2Connection::shutdown(Poco::UInt32 errorCode)
+{
+	bool idle;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		if (_goingAway || _closed) return;
+		_goingAway = true;
+		idle = _streams.empty();
+	}
+	writeGoAway(errorCode);
+	if (idle) _session.socket().shutdown();
+}
+
+
+HTTP2Stream::Ptr HTTP2Connection::openStream(const HPACKTable::FieldList& headers, bool endStream)
+{
+	poco_assert (!_server);
+
+	for (;;)
+	{
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			while (!_closed && !_peerGoingAway && _streams.size() >= _peerSettings.maxConcurrentStreams)
+			{
+				_condition.wait(_mutex);
+			}
+			if (_closed || _peerGoingAway) throw HTTP2Exception("Connection closed", H2_REFUSED_STREAM);
+		}
+		Poco::ScopedLock<Poco::Mutex> writeLock(_writeMutex);
+		HTTP2Stream::Ptr pStream;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			if (_streams.size() >= _peerSettings.maxConcurrentStreams) continue;
+			if (_nextStreamId > MAX_WINDOW_SIZE) throw HTTP2Exception("Stream identifiers exhausted", H2_REFUSED_STREAM);
+			pStream = new HTTP2Stream(*this, _nextStreamId, _peerSettings.initialWindowSize, _localSettings.initialWindowSize);
+			pStream->_localClosed = endStream;
+			_streams[_nextStreamId] = pStream;
+			_nextStreamId += 2;
+		}
+		writeHeaders(pStream->id(), headers, endStream);
+		return pStream;
+	}
+}
+
+
+HTTP2Stream::Ptr HTTP2Connection::upgradeStream(const HPACKTable::FieldList& headers, const std::string& settings)
+{
+	poco_assert (_server);
+
+	applySettings(settings.data(), settings.size());
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	HTTP2Stream::Ptr pStream = new HTTP2Stream(*this, 1, _peerSettings.initialWindowSize, _localSettings.initialWindowSize);
+	pStream->_remoteClosed = true;
+	pStream->_headers.push_back(headers);
+	_streams[1] = pStream;
+	_lastPeerStreamId = 1;
+	return pStream;
+}
+
+
+void HTTP2Connection::sendHeaders(HTTP2Stream& stream, const HPACKTable::FieldList& headers, bool endStream)
+{
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		checkStream(stream);
+	}
+	writeHeaders(stream.id(), headers, endStream);
+	if (endStream)
+	{
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			stream._localClosed = true;
+			if (stream._remoteClosed) closeStream(stream);
+		}
+		updateReceiveWindow();
+	}
+}
+
+
+void HTTP2Connection::sendData(HTTP2Stream& stream, const char* data, std::size_t length, bool endStream)
+{
+	if (length == 0)
+	{
+		if (!endStream) return;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			checkStream(stream);
+		}
+		writeFrame(FRAME_DATA, FLAG_END_STREAM, stream.id(), 0, 0);
+	}
+	while (length > 0)
+	{
+		std::size_t n;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			while (!stream._reset && !_closed && (stream._sendWindow <= 0 || _sendWindow <= 0))
+			{
+				_condition.wait(_mutex);
+			}
+			checkStream(stream);
+			n = static_cast<std::size_t>(std::min(stream._sendWindow, _sendWindow));
+			n = std::min<std::size_t>(n, _peerSettings.maxFrameSize);
+			n = std::min(n, length);
+			stream._sendWindow -= n;
+			_sendWindow -= n;
+		}
+		bool last = endStream && n == length;
+		writeFrame(FRAME_DATA, last ? FLAG_END_STREAM : 0, stream.id(), data, n);
+		data += n;
+		length -= n;
+	}
+	if (endStream)
+	{
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			stream._localClosed = true;
+			if (stream._remoteClosed) closeStream(stream);
+		}
+		updateReceiveWindow();
+	}
+}
+
+
+bool HTTP2Connection::receiveHeaders(HTTP2Stream& stream, HPACKTable::FieldList& headers)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	while (stream._headers.empty() && !stream._remoteClosed && !stream._reset)
+	{
+		_condition.wait(_mutex);
+	}
+	if (!stream._headers.empty())
+	{
+		headers.swap(stream._headers.front());
+		stream._headers.pop_front();
+		return true;
+	}
+	checkStream(stream);
+	return false;
+}
+
+
+int HTTP2Connection::receiveData(HTTP2Stream& stream, char* buffer, int length)
+{
+	Poco::UInt32 increment = 0;
+	int n = 0;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		while (stream._data.size() == stream._dataOffset && !stream._remoteClosed && !stream._reset)
+		{
+			_condition.wait(_mutex);
+		}
+		std::size_t available = stream._data.size() - stream._dataOffset;
+		if (available == 0)
+		{
+			if (stream._reset) checkStream(stream);
+			return 0;
+		}
+		n = static_cast<int>(std::min<std::size_t>(available, length));
+		std::memcpy(buffer, stream._data.data() + stream._dataOffset, n);
+		stream._dataOffset += n;
+		if (stream._dataOffset == stream._data.size())
+		{
+			stream._data.clear();
+			stream._dataOffset = 0;
+		}
+		stream._unacknowledged += n;
+		if (!stream._remoteClosed && !stream._reset && stream._unacknowledged >= _localSettings.initialWindowSize/2)
+		{
+			increment = stream._unacknowledged;
+			stream._unacknowledged = 0;
+			stream._receiveWindow += increment;
+		}
+		// The rest of a closed stream's data has
+		// already been acknowledged by closeStream().
+		if (_streams.find(stream.id()) != _streams.end())
+			_unacknowledged += n;
+	}
+	if (increment) writeWindowUpdate(stream.id(), increment);
+	updateReceiveWindow();
+	return n;
+}
+
+
+void HTTP2Connection::resetStream(HTTP2Stream& stream, Poco::UInt32 errorCode)
+{
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		if (stream._reset || _closed || (stream._localClosed && stream._remoteClosed)) return;
+		stream._reset = true;
+		stream._errorCode = errorCode;
+		closeStream(stream);
+		_condition.broadcast();
+	}
+	writeResetStream(stream.id(), errorCode);
+	updateReceiveWindow();
+}
+
+
+int HTTP2Connection::activeStreams() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return static_cast<int>(_streams.size());
+}
+
+
+bool HTTP2Connection::closed() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	return _closed;
+}
+
+
+void HTTP2Connection::streamOpened(HTTP2Stream::Ptr pStream)
+{
+	resetStream(*pStream, H2_REFUSED_STREAM);
+}
+
+
+void HTTP2Connection::readPreface(std::size_t offset)
+{
+	poco_assert (offset <= PREFACE.size());
+
+	char preface[24];
+	std::size_t length = PREFACE.size() - offset;
+	readFully(preface, length);
+	if (PREFACE.compare(offset, length, preface, length) != 0)
+		throw HTTP2Exception("Invalid HTTP/2 connection preface", H2_PROTOCOL_ERROR);
+}
+
+
+bool HTTP2Connection::readFrame(Poco::UInt8& type, Poco::UInt8& flags, Poco::UInt32& streamId)
+{
+	char header[FRAME_HEADER_SIZE];
+	int n = 0;
+	for (;;)
+	{
+		try
+		{
+			n = read(header, FRAME_HEADER_SIZE);
+			break;
+		}
+		catch (Poco::TimeoutException&)
+		{
+			// An idle server connection is closed after the session
+			// timeout. The client keeps its connection until closed.
+			if (_server && activeStreams() == 0)
+			{
+				writeGoAway(H2_NO_ERROR);
+				return false;
+			}
+		}
+	}
+	if (n <= 0) return false;
+	if (n < FRAME_HEADER_SIZE) readFully(header + n, FRAME_HEADER_SIZE - n);
+
+	_payloadLength = get24(header);
+	type     = static_cast<Poco::UInt8>(header[3]);
+	flags    = static_cast<Poco::UInt8>(header[4]);
+	streamId = get32(header + 5) & 0x7FFFFFFF;
+	if (_payloadLength > _localSettings.maxFrameSize) connectionError("Frame too large", H2_FRAME_SIZE_ERROR);
+	readFully(_payload.begin(), _payloadLength);
+	return true;
+}
+
+
+int HTTP2Connection::read(char* buffer, std::size_t length)
+{
+	if (_session.buffered() == 0 && _session.socket().secure())
+	{
+		// Wait until data is available without holding the
+		// write lock, so that writers are blocked only while
+		// a TLS record is being read.
+		StreamSocket& socket = _session.socket();
+		if (!socket.poll(_session.getTimeout(), Socket::SELECT_READ) && socket.available() == 0)
+			throw Poco::TimeoutException();
+		Poco::Mutex::ScopedLock lock(_writeMutex);
+		return _session.read(buffer, static_cast<std::streamsize>(length));
+	}
+	return _session.read(buffer, static_cast<std::streamsize>(length));
+}
+
+
+void HTTP2Connection::readFully(char* buffer, std::size_t length)
+{
+	while (length > 0)
+	{
+		int n = read(buffer, length);
+		if (n <= 0) throw NetException("Unexpected end of HTTP/2 frame");
+		buffer += n;
+		length -= n;
+	}
+}
+
+
+void HTTP2Connection::processFrame(Poco::UInt8 type, Poco::UInt8 flags, Poco::UInt32 streamId)
+{
+	if (_headerStreamId != 0 && type != FRAME_CONTINUATION)
+		connectionError("CONTINUATION frame expected", H2_PROTOCOL_ERROR);
+
+	switch (type)
+	{
+	case FRAME_DATA:
+		processData(flags, streamId);
+		break;
+	case FRAME_HEADERS:
+	case FRAME_CONTINUATION:
+		processHeaders(type, flags, streamId);
+		break;
+	case FRAME_PRIORITY:
+		if (streamId == 0) connectionError("PRIORITY frame without stream", H2_PROTOCOL_ERROR);
+		if (_payloadLength != 5) connectionError("Invalid PRIORITY frame", H2_FRAME_SIZE_ERROR);
+		break;
+	case FRAME_RST_STREAM:
+		processResetStream(streamId);
+		break;
+	case FRAME_SETTINGS:
+		processSettings(flags, streamId);
+		break;
+	case FRAME_PUSH_PROMISE:
+		connectionError("Server push is disabled", H2_PROTOCOL_ERROR);
+		break;
+	case FRAME_PING:
+		processPing(flags, streamId);
+		break;
+	case FRAME_GOAWAY:
+		processGoAway(streamId);
+		break;
+	case FRAME_WINDOW_UPDATE:
+		processWindowUpdate(streamId);
+		break;
+	default:
+		// RFC 7540, section 4.1: unknown frame types are ignored.
+		break;
+	}
+}
+
+
+void HTTP2Connection::processData(Poco::UInt8 flags, Poco::UInt32 streamId)
+{
+	if (streamId == 0) connectionError("DATA frame without stream", H2_PROTOCOL_ERROR);
+
+	std::size_t offset = 0;
+	std::size_t length = stripPadding(flags, offset);
+	Poco::UInt32 errorCode = H2_NO_ERROR;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		// RFC 7540, section 6.9.1: the connection's window
+		// covers DATA frames on all streams, even closed ones.
+		if (static_cast<Poco::Int64>(_payloadLength) > _receiveWindow)
+			connectionError("Connection flow control window exceeded", H2_FLOW_CONTROL_ERROR);
+		_receiveWindow -= _payloadLength;
+		// Data that is not buffered for a stream
+		// is acknowledged right away.
+		std::size_t buffered = 0;
+		StreamMap::iterator it = _streams.find(streamId);
+		if (it != _streams.end() && !it->second->_remoteClosed)
+		{
+			HTTP2Stream& stream = *it->second;
+			if (static_cast<Poco::Int64>(_payloadLength) > stream._receiveWindow)
+			{
+				errorCode = H2_FLOW_CONTROL_ERROR;
+				stream._reset = true;
+				stream._errorCode = errorCode;
+				closeStream(stream);
+			}
+			else
+			{
+				stream._receiveWindow -= _payloadLength;
+				stream._data.append(_payload.begin() + offset, length);
+				buffered = length;
+				// padding is never consumed, so it is acknowledged right away
+				stream._unacknowledged += static_cast<Poco::UInt32>(_payloadLength - length);
+				if (flags & FLAG_END_STREAM)
+				{
+					stream._remoteClosed = true;
+					if (stream._localClosed) closeStream(stream);
+				}
+			}
+			_condition.broadcast();
+		}
+		else if (it != _streams.end())
+		{
+			errorCode = H2_STREAM_CLOSED;
+		}
+		else if ((streamId & 1) == (_server ? 1U : 0U) ? streamId > _lastPeerStreamId : streamId >= _nextStreamId)
+		{
+			connectionError("DATA frame on idle stream", H2_PROTOCOL_ERROR);
+		}
+		_unacknowledged += static_cast<Poco::UInt32>(_payloadLength - buffered);
+	}
+	if (errorCode != H2_NO_ERROR) writeResetStream(streamId, errorCode);
+}
+
+
+void HTTP2Connection::processHeaders(Poco::UInt8 type, Poco::UInt8 flags, Poco::UInt32 streamId)
+{
+	if (streamId == 0) connectionError("HEADERS frame without stream", H2_PROTOCOL_ERROR);
+
+	if (type == FRAME_HEADERS)
+	{
+		std::size_t offset = 0;
+		std::size_t length = stripPadding(flags, offset);
+		if (flags & FLAG_PRIORITY)
+		{
+			if (length < 5) connectionError("Invalid HEADERS frame", H2_FRAME_SIZE_ERROR);
+			offset += 5;
+			length -= 5;
+		}
+		_headerBlock.assign(_payload.begin() + offset, length);
+		_headerEndStream = (flags & FLAG_END_STREAM) != 0;
+	}
+	else
+	{
+		if (streamId != _headerStreamId) connectionError("Unexpected CONTINUATION frame", H2_PROTOCOL_ERROR);
+		_headerBlock.append(_payload.begin(), _payloadLength);
+	}
+	if (_headerBlock.size() > MAX_HEADER_BLOCK_SIZE) connectionError("Header block too large", H2_ENHANCE_YOUR_CALM);
+
+	if (flags & FLAG_END_HEADERS)
+	{
+		_headerStreamId = 0;
+		processHeaderBlock(streamId, _headerEndStream);
+		_headerBlock.clear();
+	}
+	else _headerStreamId = streamId;
+}
+
+
+void HTTP2Connection::processHeaderBlock(Poco::UInt32 streamId, bool endStream)
+{
+	HPACKTable::FieldList fields;
+	_decoder.decode(_headerBlock.data(), _headerBlock.size(), fields);
+
+	HTTP2Stream::Ptr pOpened;
+	Poco::UInt32 errorCode = H2_NO_ERROR;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		StreamMap::iterator it = _streams.find(streamId);
+		if (it != _streams.end())
+		{
+			HTTP2Stream& stream = *it->second;
+			if (stream._remoteClosed)
+			{
+				errorCode = H2_STREAM_CLOSED;
+			}
+			else
+			{
+				stream._headers.push_back(HPACKTable::FieldList());
+				stream._headers.back().swap(fields);
+				if (endStream)
+				{
+					stream._remoteClosed = true;
+					if (stream._localClosed) closeStream(stream);
+				}
+				_condition.broadcast();
+			}
+		}
+		else if (_server && (streamId & 1) && streamId > _lastPeerStreamId)
+		{
+			_lastPeerStreamId = streamId;
+			if (_goingAway)
+			{
+				// ignored, see RFC 7540, section 6.8
+			}
+			else if (_streams.size() >= _localSettings.maxConcurrentStreams)
+			{
+				errorCode = H2_REFUSED_STREAM;
+			}
+			else
+			{
+				pOpened = new HTTP2Stream(*this, streamId, _peerSettings.initialWindowSize, _localSettings.initialWindowSize);
+				pOpened->_headers.push_back(HPACKTable::FieldList());
+				pOpened->_headers.back().swap(fields);
+				pOpened->_remoteClosed = endStream;
+				_streams[streamId] = pOpened;
+			}
+		}
+		else if (_server ? streamId > _lastPeerStreamId : streamId >= _nextStreamId)
+		{
+			connectionError("HEADERS frame on invalid stream", H2_PROTOCOL_ERROR);
+		}
+	}
+	if (errorCode != H2_NO_ERROR) writeResetStream(streamId, errorCode);
+	if (pOpened) streamOpened(pOpened);
+}
+
+
+void HTTP2Connection::processResetStream(Poco::UInt32 streamId)
+{
+	if (streamId == 0) connectionError("RST_STREAM frame without stream", H2_PROTOCOL_ERROR);
+	if (_payloadLength != 4) connectionError("Invalid RST_STREAM frame", H2_FRAME_SIZE_ERROR);
+
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	StreamMap::iterator it = _streams.find(streamId);
+	if (it != _streams.end())
+	{
+		HTTP2Stream& stream = *it->second;
+		stream._reset = true;
+		stream._errorCode = get32(_payload.begin());
+		closeStream(stream);
+		_condition.broadcast();
+	}
+}
+
+
+void HTTP2Connection::processSettings(Poco::UInt8 flags, Poco::UInt32 streamId)
+{
+	if (streamId != 0) connectionError("SETTINGS frame on stream", H2_PROTOCOL_ERROR);
+	if (flags & FLAG_ACK)
+	{
+		if (_payloadLength != 0) connectionError("Invalid SETTINGS acknowledgement", H2_FRAME_SIZE_ERROR);
+		return;
+	}
+	applySettings(_payload.begin(), _payloadLength);
+	writeFrame(FRAME_SETTINGS, FLAG_ACK, 0, 0, 0);
+}
+
+
+void HTTP2Connection::applySettings(const char* data, std::size_t length)
+{
+	if (length % 6 != 0) connectionError("Invalid SETTINGS frame", H2_FRAME_SIZE_ERROR);
+
+	Poco::ScopedLock<Poco::Mutex> writeLock(_writeMutex);
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	for (std::size_t i = 0; i < length; i += 6)
+	{
+		Poco::UInt16 id    = get16(data + i);
+		Poco::UInt32 value = get32(data + i + 2);
+		switch (id)
+		{
+		case SETTINGS_HEADER_TABLE_SIZE:
+			_peerSettings.headerTableSize = value;
+			_encoder.setMaxTableSize(value);
+			break;
+		case SETTINGS_ENABLE_PUSH:
+			if (value > 1) connectionError("Invalid SETTINGS_ENABLE_PUSH", H2_PROTOCOL_ERROR);
+			_peerSettings.enablePush = value;
+			break;
+		case SETTINGS_MAX_CONCURRENT_STREAMS:
+			_peerSettings.maxConcurrentStreams = value;
+			break;
+		case SETTINGS_INITIAL_WINDOW_SIZE:
+			{
+				if (value > MAX_WINDOW_SIZE) connectionError("Invalid SETTINGS_INITIAL_WINDOW_SIZE", H2_FLOW_CONTROL_ERROR);
+				Poco::Int64 delta = static_cast<Poco::Int64>(value) - _peerSettings.initialWindowSize;
+				for (StreamMap::iterator it = _streams.begin(); it != _streams.end(); ++it)
+				{
+					it->second->_sendWindow += delta;
+					if (it->second->_sendWindow > MAX_WINDOW_SIZE) connectionError("Window overflow", H2_FLOW_CONTROL_ERROR);
+				}
+				_peerSettings.initialWindowSize = value;
+			}
+			break;
+		case SETTINGS_MAX_FRAME_SIZE:
+			if (value < DEFAULT_FRAME_SIZE || value > 0xFFFFFF) connectionError("Invalid SETTINGS_MAX_FRAME_SIZE", H2_PROTOCOL_ERROR);
+			_peerSettings.maxFrameSize = value;
+			break;
+		case SETTINGS_MAX_HEADER_LIST_SIZE:
+			_peerSettings.maxHeaderListSize = value;
+			break;
+		default:
+			// RFC 7540, section 6.5.2: unknown settings are ignored.
+			break;
+		}
+	}
+	_condition.broadcast();
+}
+
+
+void HTTP2Connection::processPing(Poco::UInt8 flags, Poco::UInt32 streamId)
+{
+	if (streamId != 0) connectionError("PING frame on stream", H2_PROTOCOL_ERROR);
+	if (_payloadLength != 8) connectionError("Invalid PING frame", H2_FRAME_SIZE_ERROR);
+	if (!(flags & FLAG_ACK))
+	{
+		writeFrame(FRAME_PING, FLAG_ACK, 0, _payload.begin(), 8);
+	}
+}
+
+
+void HTTP2Connection::processGoAway(Poco::UInt32 streamId)
+{
+	if (streamId != 0) connectionError("GOAWAY frame on stream", H2_PROTOCOL_ERROR);
+	if (_payloadLength < 8) connectionError("Invalid GOAWAY frame", H2_FRAME_SIZE_ERROR);
+
+	Poco::UInt32 lastStreamId = get32(_payload.begin()) & 0x7FFFFFFF;
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	_peerGoingAway = true;
+	StreamMap::iterator it = _streams.begin();
+	while (it != _streams.end())
+	{
+		HTTP2Stream& stream = *it->second;
+		++it;
+		// streams we initiated that the peer has not processed
+		if ((stream.id() & 1) == (_server ? 0U : 1U) && stream.id() > lastStreamId)
+		{
+			stream._reset = true;
+			stream._errorCode = H2_REFUSED_STREAM;
+			closeStream(stream);
+		}
+	}
+	_condition.broadcast();
+}
+
+
+void HTTP2Connection::processWindowUpdate(Poco::UInt32 streamId)
+{
+	if (_payloadLength != 4) connectionError("Invalid WINDOW_UPDATE frame", H2_FRAME_SIZE_ERROR);
+
+	Poco::UInt32 increment = get32(_payload.begin()) & 0x7FFFFFFF;
+	bool reset = false;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		if (streamId == 0)
+		{
+			if (increment == 0) connectionError("Invalid window increment", H2_PROTOCOL_ERROR);
+			_sendWindow += increment;
+			if (_sendWindow > MAX_WINDOW_SIZE) connectionError("Window overflow", H2_FLOW_CONTROL_ERROR);
+		}
+		else
+		{
+			StreamMap::iterator it = _streams.find(streamId);
+			if (it != _streams.end())
+			{
+				HTTP2Stream& stream = *it->second;
+				stream._sendWindow += increment;
+				if (increment == 0 || stream._sendWindow > MAX_WINDOW_SIZE)
+				{
+					stream._reset = true;
+					stream._errorCode = increment == 0 ? H2_PROTOCOL_ERROR : H2_FLOW_CONTROL_ERROR;
+					closeStream(stream);
+					reset = true;
+				}
+			}
+		}
+		_condition.broadcast();
+	}
+	if (reset) writeResetStream(streamId, increment == 0 ? H2_PROTOCOL_ERROR : H2_FLOW_CONTROL_ERROR);
+}
+
+
+std::size_t HTTP2Connection::stripPadding(Poco::UInt8 flags, std::size_t& offset)
+{
+	if (flags & FLAG_PADDED)
+	{
+		if (_payloadLength < 1) connectionError("Invalid padding", H2_PROTOCOL_ERROR);
+		std::size_t padding = static_cast<unsigned char>(_payload[0]);
+		if (padding >= _payloadLength) connectionError("Invalid padding", H2_PROTOCOL_ERROR);
+		offset = 1;
+		return _payloadLength - 1 - padding;
+	}
+	offset = 0;
+	return _payloadLength;
+}
+
+
+void HTTP2Connection::writeFrame(Poco::UInt8 type, Poco::UInt8 flags, Poco::UInt32 streamId, const char* payload, std::size_t length)
+{
+	char header[FRAME_HEADER_SIZE];
+	put24(header, static_cast<Poco::UInt32>(length));
+	header[3] = static_cast<char>(type);
+	header[4] = static_cast<char>(flags);
+	put32(header + 5, streamId);
+
+	// The frame is sent with a single write, so that the header
+	// is never sent in a segment of its own.
+	Poco::ScopedLock<Poco::Mutex> lock(_writeMutex);
+	_frameBuffer.assign(header, FRAME_HEADER_SIZE);
+	if (length) _frameBuffer.append(payload, length);
+	const char* p = _frameBuffer.data();
+	std::size_t n = _frameBuffer.size();
+	while (n > 0)
+	{
+		int sent = _session.write(p, static_cast<std::streamsize>(n));
+		if (sent <= 0) throw NetException("Cannot send HTTP/2 frame");
+		p += sent;
+		n -= sent;
+	}
+}
+
+
+void HTTP2Connection::writeHeaders(Poco::UInt32 streamId, const HPACKTable::FieldList& headers, bool endStream)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_writeMutex);
+	std::string block;
+	_encoder.encode(headers, block);
+	std::size_t maxFrameSize;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		maxFrameSize = _peerSettings.maxFrameSize;
+	}
+	const char* p = block.data();
+	std::size_t length = block.size();
+	Poco::UInt8 type = FRAME_HEADERS;
+	Poco::UInt8 flags = endStream ? FLAG_END_STREAM : 0;
+	do
+	{
+		std::size_t n = std::min(length, maxFrameSize);
+		if (n == length) flags |= FLAG_END_HEADERS;
+		writeFrame(type, flags, streamId, p, n);
+		type  = FRAME_CONTINUATION;
+		flags = 0;
+		p += n;
+		length -= n;
+	}
+	while (length > 0);
+}
+
+
+void HTTP2Connection::writeResetStream(Poco::UInt32 streamId, Poco::UInt32 errorCode)
+{
+	char payload[4];
+	put32(payload, errorCode);
+	writeFrame(FRAME_RST_STREAM, 0, streamId, payload, sizeof(payload));
+}
+
+
+void HTTP2Connection::writeWindowUpdate(Poco::UInt32 streamId, Poco::UInt32 increment)
+{
+	char payload[4];
+	put32(payload, increment);
+	writeFrame(FRAME_WINDOW_UPDATE, 0, streamId, payload, sizeof(payload));
+}
+
+
+void HTTP2Connection::writeGoAway(Poco::UInt32 errorCode)
+{
+	char payload[8];
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		put32(payload, _lastPeerStreamId);
+	}
+	put32(payload + 4, errorCode);
+	writeFrame(FRAME_GOAWAY, 0, 0, payload, sizeof(payload));
+}
+
+
+void HTTP2Connection::checkStream(const HTTP2Stream& stream) const
+{
+	if (stream._reset) throw HTTP2Exception("HTTP/2 stream reset", static_cast<int>(stream._errorCode));
+	if (_closed) throw HTTP2Exception("HTTP/2 connection closed", H2_CANCEL);
+}
+
+
+void HTTP2Connection::closeStream(HTTP2Stream& stream)
+{
+	// Data that has not been read yet may never be,
+	// so it no longer counts against the window.
+	if (_streams.erase(stream.id()))
+		_unacknowledged += static_cast<Poco::UInt32>(stream._data.size() - stream._dataOffset);
+	if (_goingAway && _streams.empty())
+	{
+		try
+		{
+			_session.socket().shutdown();
+		}
+		catch (...)
+		{
+		}
+	}
+	_condition.broadcast();
+}
+
+
+void HTTP2Connection::updateReceiveWindow()
+{
+	Poco::UInt32 increment = 0;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		if (_unacknowledged >= CONNECTION_WINDOW_SIZE/2 && !_closed)
+		{
+			increment = _unacknowledged;
+			_unacknowledged = 0;
+			_receiveWindow += increment;
+		}
+	}
+	if (increment) writeWindowUpdate(0, increment);
+}
+
+
+} } // namespace Poco::Net
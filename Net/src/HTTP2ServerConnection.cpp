@@ -0,0 +1,263 @@
+//
+// HTTP2ServerConnection.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2ServerConnection
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTP2ServerConnection.h"
+#include "Poco/Net/HTTP2ServerRequestImpl.h"
+#include "Poco/Net/HTTP2ServerResponseImpl.h"
+#include "Poco/Net/HTTPServerSession.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Runnable.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Base64Decoder.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/String.h"
+#include <sstream>
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTP2ServerConnection::StreamHandler: public Poco::Runnable
+{
+public:
+	StreamHandler(HTTP2ServerConnection& connection, HTTP2Stream::Ptr pStream):
+		_connection(connection),
+		_pStream(pStream)
+	{
+	}
+
+	void run()
+	{
+		try
+		{
+			_connection.handleStream(_pStream);
+		}
+		catch (...)
+		{
+			try
+			{
+				_connection.resetStream(*_pStream, H2_INTERNAL_ERROR);
+			}
+			catch (...)
+			{
+			}
+		}
+		{
+			Poco::FastMutex::ScopedLock lock(_connection._handlerMutex);
+			--_connection._handlers;
+			_connection._handlerCondition.broadcast();
+		}
+		delete this;
+	}
+
+private:
+	HTTP2ServerConnection& _connection;
+	HTTP2Stream::Ptr       _pStream;
+};
+
+
+const std::string HTTP2ServerConnection::UPGRADE_H2C("h2c");
+const std::string HTTP2ServerConnection::HTTP2_SETTINGS("HTTP2-Settings");
+
+
+HTTP2ServerConnection::HTTP2ServerConnection(HTTPServerSession& session, HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory, Poco::ThreadPool& threadPool):
+	HTTP2Connection(session, true),
+	_session(session),
+	_pParams(pParams),
+	_pFactory(pFactory),
+	_threadPool(threadPool),
+	_handlers(0)
+{
+	_session.setDeferredOutput(false);
+	_session.socket().setNoDelay(true);
+}
+
+
+HTTP2ServerConnection::~HTTP2ServerConnection()
+{
+}
+
+
+void HTTP2ServerConnection::upgrade(const HTTPRequest& request, HTTPServerResponse& response)
+{
+	// The HTTP2-Settings header contains a SETTINGS
+	// payload in base64url encoding (RFC 7540, section 3.2.1).
+	std::string encoded = request.get(HTTP2_SETTINGS);
+	Poco::translateInPlace(encoded, "-_", "+/");
+	while (encoded.size() % 4) encoded += '=';
+	std::istringstream istr(encoded);
+	Poco::Base64Decoder decoder(istr);
+	std::string settings;
+	Poco::StreamCopier::copyToString(decoder, settings);
+
+	HPACKTable::FieldList fields;
+	fields.push_back(HPACKTable::Field(":method", request.getMethod()));
+	fields.push_back(HPACKTable::Field(":scheme", "http"));
+	fields.push_back(HPACKTable::Field(":path", request.getURI()));
+	fields.push_back(HPACKTable::Field(":authority", request.getHost()));
+	for (HTTPRequest::ConstIterator it = request.begin(); it != request.end(); ++it)
+	{
+		std::string name = Poco::toLower(it->first);
+		if (name != "host" && name != "connection" && name != "upgrade" && name != "http2-settings" && name != "keep-alive")
+		{
+			fields.push_back(HPACKTable::Field(name, it->second));
+		}
+	}
+
+	response.setVersion(HTTPMessage::HTTP_1_1);
+	response.setStatusAndReason(HTTPResponse::HTTP_SWITCHING_PROTOCOLS);
+	response.set("Connection", "Upgrade");
+	response.set("Upgrade", UPGRADE_H2C);
+	response.send();
+
+	_pUpgradeStream = upgradeStream(fields, settings);
+}
+
+
+void HTTP2ServerConnection::serve()
+{
+	_clientAddress = _session.clientAddress();
+	_serverAddress = _session.serverAddress();
+
+	Settings settings;
+	settings.maxConcurrentStreams = _pParams->getMaxConcurrentStreams();
+	start(settings);
+	// Without an upgrade, the first part of the preface
+	// has already been read as a HTTP/1.x request.
+	readPreface(_pUpgradeStream ? 0 : PREFACE.size() - 6);
+	if (_pUpgradeStream)
+	{
+		streamOpened(_pUpgradeStream);
+		_pUpgradeStream = 0;
+	}
+	run();
+
+	Poco::FastMutex::ScopedLock lock(_handlerMutex);
+	while (_handlers > 0)
+	{
+		_handlerCondition.wait(_handlerMutex);
+	}
+}
+
+
+bool HTTP2ServerConnection::isPreface(const HTTPRequest& request)
+{
+	return request.getMethod() == "PRI" && request.getURI() == "*" && request.getVersion() == HTTP2ServerRequestImpl::HTTP_2;
+}
+
+
+bool HTTP2ServerConnection::isUpgrade(const HTTPRequest& request)
+{
+	return Poco::icompare(request.get("Upgrade", HTTPMessage::EMPTY), UPGRADE_H2C) == 0
+		&& request.has(HTTP2_SETTINGS)
+		&& request.getVersion() == HTTPMessage::HTTP_1_1
+		&& !request.getChunkedTransferEncoding()
+#if defined(POCO_HAVE_INT64)
+		&& (!request.hasContentLength() || request.getContentLength64() == 0);
+#else
+		&& (!request.hasContentLength() || request.getContentLength() == 0);
+#endif
+}
+
+
+void HTTP2ServerConnection::streamOpened(HTTP2Stream::Ptr pStream)
+{
+	StreamHandler* pHandler = new StreamHandler(*this, pStream);
+	{
+		Poco::FastMutex::ScopedLock lock(_handlerMutex);
+		++_handlers;
+	}
+	try
+	{
+		_threadPool.start(*pHandler);
+	}
+	catch (Poco::NoThreadAvailableException&)
+	{
+		delete pHandler;
+		{
+			Poco::FastMutex::ScopedLock lock(_handlerMutex);
+			--_handlers;
+		}
+		resetStream(*pStream, H2_REFUSED_STREAM);
+	}
+}
+
+
+void HTTP2ServerConnection::handleStream(HTTP2Stream::Ptr pStream)
+{
+	HPACKTable::FieldList headers;
+	if (!receiveHeaders(*pStream, headers)) return;
+
+	HTTP2ServerResponseImpl response(pStream);
+	try
+	{
+		HTTP2ServerRequestImpl request(response, pStream, headers, _pParams, _clientAddress, _serverAddress);
+
+		response.setDate(Poco::Timestamp());
+		const std::string& server = _pParams->getSoftwareVersion();
+		if (!server.empty())
+			response.set("Server", server);
+
+		HTTPRequestHandlerFactory::ScopedHandler pHandler(*_pFactory, request);
+		if (pHandler.get())
+		{
+			if (request.expectContinue())
+				response.sendContinue();
+
+			pHandler->handleRequest(request, response);
+		}
+		else
+		{
+			response.setStatusAndReason(HTTPResponse::HTTP_NOT_IMPLEMENTED);
+			response.setContentLength(0);
+		}
+		response.finish();
+		// RFC 7540, section 8.1: the rest of the
+		// request is no longer needed.
+		resetStream(*pStream, H2_NO_ERROR);
+	}
+	catch (MessageException&)
+	{
+		resetStream(*pStream, H2_PROTOCOL_ERROR);
+	}
+	catch (HTTP2Exception&)
+	{
+		resetStream(*pStream, H2_CANCEL);
+	}
+	catch (Poco::Exception&)
+	{
+		if (!response.sent())
+		{
+			try
+			{
+				response.setStatusAndReason(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+				response.setContentLength(0);
+				response.finish();
+			}
+			catch (...)
+			{
+			}
+		}
+		resetStream(*pStream, H2_INTERNAL_ERROR);
+	}
+}
+
+
+} } // namespace Poco::Net
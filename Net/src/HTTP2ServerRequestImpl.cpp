@@ -0,0 +1,109 @@
+//
+// HTTP2ServerRequestImpl.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2ServerRequestImpl
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTP2ServerRequestImpl.h"
+#include "Poco/Net/HTTP2ServerResponseImpl.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/String.h"
+
+
+using Poco::icompare;
+
+
+namespace Poco {
+namespace Net {
+
+
+const std::string HTTP2ServerRequestImpl::HTTP_2("HTTP/2.0");
+
+
+HTTP2ServerRequestImpl::HTTP2ServerRequestImpl(HTTP2ServerResponseImpl& response, HTTP2Stream::Ptr pStream, const HPACKTable::FieldList& headers, HTTPServerParams* pParams, const SocketAddress& clientAddress, const SocketAddress& serverAddress):
+	_response(response),
+	_stream(pStream),
+	_pParams(pParams, true),
+	_clientAddress(clientAddress),
+	_serverAddress(serverAddress)
+{
+	response.attachRequest(this);
+	setVersion(HTTP_2);
+
+	bool hasMethod = false;
+	bool hasPath = false;
+	std::string cookies;
+	for (HPACKTable::FieldList::const_iterator it = headers.begin(); it != headers.end(); ++it)
+	{
+		const std::string& name = it->first;
+		if (!name.empty() && name[0] == ':')
+		{
+			if (name == ":method")
+			{
+				setMethod(it->second);
+				hasMethod = true;
+			}
+			else if (name == ":path")
+			{
+				setURI(it->second);
+				hasPath = true;
+			}
+			else if (name == ":authority")
+			{
+				setHost(it->second);
+			}
+			else if (name != ":scheme")
+			{
+				throw MessageException("Invalid HTTP/2 pseudo-header field", name);
+			}
+		}
+		else if (name == "cookie")
+		{
+			// RFC 7540, section 8.1.2.5: cookie fields may be split
+			if (!cookies.empty()) cookies.append("; ");
+			cookies.append(it->second);
+		}
+		else if (name == "host")
+		{
+			if (!has(HOST)) set(HOST, it->second);
+		}
+		else
+		{
+			add(name, it->second);
+		}
+	}
+	if (!hasMethod || (!hasPath && getMethod() != HTTP_CONNECT))
+		throw MessageException("Missing HTTP/2 pseudo-header field");
+	if (!cookies.empty()) set("Cookie", cookies);
+}
+
+
+HTTP2ServerRequestImpl::~HTTP2ServerRequestImpl()
+{
+}
+
+
+bool HTTP2ServerRequestImpl::expectContinue() const
+{
+	const std::string& expect = get("Expect", EMPTY);
+	return !expect.empty() && icompare(expect, "100-continue") == 0;
+}
+
+
+HTTPServerResponse& HTTP2ServerRequestImpl::response() const
+{
+	return _response;
+}
+
+
+} } // namespace Poco::Net
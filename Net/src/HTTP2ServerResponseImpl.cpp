@@ -0,0 +1,278 @@
+//
+// HTTP2ServerResponseImpl.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2ServerResponseImpl
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTP2ServerResponseImpl.h"
+#include "Poco/Net/HTTP2ServerRequestImpl.h"
+#include "Poco/Net/HTTP2Connection.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPCompression.h"
+#include "Poco/File.h"
+#include "Poco/Timestamp.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/NullStream.h"
+#include "Poco/Exception.h"
+#include "Poco/FileStream.h"
+#include "Poco/DateTimeFormatter.h"
+#include "Poco/DateTimeFormat.h"
+#include "Poco/String.h"
+#include "Poco/DeflatingStream.h"
+
+
+using Poco::File;
+using Poco::Timestamp;
+using Poco::NumberFormatter;
+using Poco::StreamCopier;
+using Poco::OpenFileException;
+using Poco::DateTimeFormatter;
+using Poco::DateTimeFormat;
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	bool isConnectionHeader(const std::string& name)
+	{
+		// RFC 7540, section 8.1.2.2
+		return name == "connection"
+			|| name == "keep-alive"
+			|| name == "proxy-connection"
+			|| name == "transfer-encoding"
+			|| name == "upgrade";
+	}
+}
+
+
+HTTP2ServerResponseImpl::HTTP2ServerResponseImpl(HTTP2Stream::Ptr pStream):
+	_pStream(pStream),
+	_pRequest(0),
+	_pOutput(0),
+	_pDeflater(0),
+	_sent(false)
+{
+	setVersion(HTTP2ServerRequestImpl::HTTP_2);
+}
+
+
+HTTP2ServerResponseImpl::~HTTP2ServerResponseImpl()
+{
+	delete _pDeflater;
+	delete _pOutput;
+}
+
+
+void HTTP2ServerResponseImpl::sendContinue()
+{
+	HPACKTable::FieldList fields;
+	fields.push_back(HPACKTable::Field(":status", "100"));
+	_pStream->connection().sendHeaders(*_pStream, fields, false);
+}
+
+
+std::ostream& HTTP2ServerResponseImpl::send()
+{
+	poco_assert (!_sent);
+
+#if defined(POCO_HAVE_INT64)
+	std::string encoding = contentEncoding(hasContentLength() ? getContentLength64() : -1);
+#else
+	std::string encoding = contentEncoding(hasContentLength() ? getContentLength() : -1);
+#endif
+	if (!encoding.empty())
+	{
+		set(HTTPCompression::CONTENT_ENCODING, encoding);
+		erase(HTTPMessage::CONTENT_LENGTH);
+		sendHeader(false);
+		_pOutput = new HTTP2OutputStream(_pStream);
+		_pDeflater = new Poco::DeflatingOutputStream(*_pOutput, HTTPCompression::streamType(encoding), _pRequest->serverParams().getCompressionLevel());
+		return *_pDeflater;
+	}
+	else if (hasBody())
+	{
+		sendHeader(false);
+		_pOutput = new HTTP2OutputStream(_pStream);
+	}
+	else
+	{
+		sendHeader(true);
+		_pOutput = new Poco::NullOutputStream;
+	}
+	return *_pOutput;
+}
+
+
+void HTTP2ServerResponseImpl::sendFile(const std::string& path, const std::string& mediaType)
+{
+	poco_assert (!_sent);
+
+	File f(path);
+	Timestamp dateTime    = f.getLastModified();
+	File::FileSize length = f.getSize();
+	set("Last-Modified", DateTimeFormatter::format(dateTime, DateTimeFormat::HTTP_FORMAT));
+#if defined(POCO_HAVE_INT64)
+	setContentLength64(length);
+#else
+	setContentLength(static_cast<int>(length));
+#endif
+	setContentType(mediaType);
+	setChunkedTransferEncoding(false);
+
+	std::string encoding = contentEncoding(length);
+	if (!encoding.empty())
+	{
+		const HTTPServerParams& params = _pRequest->serverParams();
+		HTTPCompressionCache::Ptr pCache = params.getCompressionCache();
+		HTTPCompressionCache::DataPtr pData;
+		if (pCache)
+		{
+			pData = pCache->get(path, dateTime, length, encoding, params.getFileCompressionLevel());
+		}
+		else if (length <= HTTPCompressionCache::DEFAULT_MAX_FILE_SIZE)
+		{
+			Poco::FileInputStream istr(path);
+			if (!istr.good()) throw OpenFileException(path);
+			pData = new std::string;
+			HTTPCompression::compress(istr, encoding, params.getFileCompressionLevel(), *pData);
+		}
+		if (pData)
+		{
+			sendCompressed(*pData, encoding);
+			return;
+		}
+	}
+
+	Poco::FileInputStream istr(path);
+	if (istr.good())
+	{
+		std::ostream& ostr = send();
+		StreamCopier::copyStream(istr, ostr);
+	}
+	else throw OpenFileException(path);
+}
+
+
+void HTTP2ServerResponseImpl::sendBuffer(const void* pBuffer, std::size_t length)
+{
+	poco_assert (!_sent);
+
+	setContentLength(static_cast<int>(length));
+	setChunkedTransferEncoding(false);
+
+	std::string encoding = contentEncoding(static_cast<Poco::Int64>(length));
+	if (!encoding.empty())
+	{
+		std::string data;
+		HTTPCompression::compress(static_cast<const char*>(pBuffer), length, encoding, _pRequest->serverParams().getCompressionLevel(), data);
+		sendCompressed(data, encoding);
+	}
+	else if (hasBody() && length > 0)
+	{
+		sendHeader(false);
+		_pStream->connection().sendData(*_pStream, static_cast<const char*>(pBuffer), length, true);
+	}
+	else sendHeader(true);
+}
+
+
+void HTTP2ServerResponseImpl::redirect(const std::string& uri, HTTPStatus status)
+{
+	poco_assert (!_sent);
+
+	setContentLength(0);
+	setChunkedTransferEncoding(false);
+
+	setStatusAndReason(status);
+	set("Location", uri);
+
+	sendHeader(true);
+}
+
+
+void HTTP2ServerResponseImpl::requireAuthentication(const std::string& realm)
+{
+	poco_assert (!_sent);
+
+	setStatusAndReason(HTTPResponse::HTTP_UNAUTHORIZED);
+	std::string auth("Basic realm=\"");
+	auth.append(realm);
+	auth.append("\"");
+	set("WWW-Authenticate", auth);
+}
+
+
+void HTTP2ServerResponseImpl::finish()
+{
+	if (!_sent) send();
+	delete _pDeflater;
+	_pDeflater = 0;
+	delete _pOutput;
+	_pOutput = 0;
+}
+
+
+void HTTP2ServerResponseImpl::sendHeader(bool endStream)
+{
+	HPACKTable::FieldList fields;
+	fields.reserve(size() + 1);
+	fields.push_back(HPACKTable::Field(":status", NumberFormatter::format(static_cast<int>(getStatus()))));
+	for (ConstIterator it = begin(); it != end(); ++it)
+	{
+		std::string name = Poco::toLower(it->first);
+		if (!isConnectionHeader(name))
+		{
+			fields.push_back(HPACKTable::Field(name, it->second));
+		}
+	}
+	_sent = true;
+	_pStream->connection().sendHeaders(*_pStream, fields, endStream);
+}
+
+
+bool HTTP2ServerResponseImpl::hasBody() const
+{
+	return !(_pRequest && _pRequest->getMethod() == HTTPRequest::HTTP_HEAD)
+		&& getStatus() >= 200
+		&& getStatus() != HTTPResponse::HTTP_NO_CONTENT
+		&& getStatus() != HTTPResponse::HTTP_NOT_MODIFIED;
+}
+
+
+std::string HTTP2ServerResponseImpl::contentEncoding(Poco::Int64 length)
+{
+	if (_pRequest)
+		return HTTPCompression::encodingFor(*_pRequest, *this, length);
+	else
+		return std::string();
+}
+
+
+void HTTP2ServerResponseImpl::sendCompressed(const std::string& data, const std::string& encoding)
+{
+	set(HTTPCompression::CONTENT_ENCODING, encoding);
+	setContentLength(static_cast<int>(data.size()));
+
+	sendHeader(data.empty());
+	if (!data.empty())
+	{
+		_pStream->connection().sendData(*_pStream, data.data(), data.size(), true);
+	}
+}
+
+
+} } // namespace Poco::Net
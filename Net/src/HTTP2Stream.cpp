@@ -0,0 +1,157 @@
+//
+// HTTP2Stream.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTP2
+// Module:  HTTP2Stream
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTP2Stream.h"
+#include "Poco/Net/HTTP2Connection.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+//
+// HTTP2Stream
+//
+
+
+HTTP2Stream::HTTP2Stream(HTTP2Connection& connection, Poco::UInt32 id, Poco::Int64 sendWindow, Poco::Int64 receiveWindow):
+	_connection(connection),
+	_id(id),
+	_localClosed(false),
+	_remoteClosed(false),
+	_reset(false),
+	_errorCode(0),
+	_sendWindow(sendWindow),
+	_receiveWindow(receiveWindow),
+	_unacknowledged(0),
+	_dataOffset(0)
+{
+}
+
+
+HTTP2Stream::~HTTP2Stream()
+{
+}
+
+
+//
+// HTTP2StreamBuf
+//
+
+
+HTTP2StreamBuf::HTTP2StreamBuf(HTTP2Stream::Ptr pStream, openmode mode):
+	HTTPBasicStreamBuf(HTTPBufferAllocator::BUFFER_SIZE, mode),
+	_pStream(pStream),
+	_mode(mode),
+	_closed(false)
+{
+}
+
+
+HTTP2StreamBuf::~HTTP2StreamBuf()
+{
+}
+
+
+void HTTP2StreamBuf::close()
+{
+	if ((_mode & std::ios::out) && !_closed)
+	{
+		_closed = true;
+		sync();
+		_pStream->connection().sendData(*_pStream, 0, 0, true);
+	}
+}
+
+
+int HTTP2StreamBuf::readFromDevice(char* buffer, std::streamsize length)
+{
+	return _pStream->connection().receiveData(*_pStream, buffer, static_cast<int>(length));
+}
+
+
+int HTTP2StreamBuf::writeToDevice(const char* buffer, std::streamsize length)
+{
+	_pStream->connection().sendData(*_pStream, buffer, static_cast<std::size_t>(length), false);
+	return static_cast<int>(length);
+}
+
+
+//
+// HTTP2IOS
+//
+
+
+HTTP2IOS::HTTP2IOS(HTTP2Stream::Ptr pStream, HTTP2StreamBuf::openmode mode):
+	_buf(pStream, mode)
+{
+	poco_ios_init(&_buf);
+}
+
+
+HTTP2IOS::~HTTP2IOS()
+{
+	try
+	{
+		_buf.close();
+	}
+	catch (...)
+	{
+	}
+}
+
+
+HTTP2StreamBuf* HTTP2IOS::rdbuf()
+{
+	return &_buf;
+}
+
+
+//
+// HTTP2InputStream
+//
+
+
+HTTP2InputStream::HTTP2InputStream(HTTP2Stream::Ptr pStream):
+	HTTP2IOS(pStream, std::ios::in),
+	std::istream(&_buf)
+{
+}
+
+
+HTTP2InputStream::~HTTP2InputStream()
+{
+}
+
+
+//
+// HTTP2OutputStream
+//
+
+
+HTTP2OutputStream::HTTP2OutputStream(HTTP2Stream::Ptr pStream):
+	HTTP2IOS(pStream, std::ios::out),
+	std::ostream(&_buf)
+{
+}
+
+
+HTTP2OutputStream::~HTTP2OutputStream()
+{
+}
+
+
+} } // namespace Poco::Net
@@ -0,0 +1,1063 @@
+//
+// HTTPAsyncClient.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPClient
+// Module:  HTTPAsyncClient
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTPAsyncClient.h"
+#include "Poco/Net/PollSet.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/DatagramSocket.h"
+#include "Poco/Net/SocketImpl.h"
+#include "Poco/Net/DNS.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/NumberParser.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/ErrorHandler.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/String.h"
+#include "Poco/Error.h"
+#include <sstream>
+#include <deque>
+#include <map>
+#include <algorithm>
+
+
+using Poco::NumberParser;
+using Poco::NumberFormatter;
+using Poco::ErrorHandler;
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	const std::size_t MAX_HEADER_SIZE = 64*1024;
+	const std::size_t MAX_LINE_SIZE   = 4096;
+	const int         BUFFER_SIZE     = 16384;
+	const long        LOOKUP_INTERVAL = 10000; // microseconds
+
+	bool isIdempotent(const std::string& method)
+		/// Returns true if a request with the given method can
+		/// safely be sent again (RFC 7231, section 4.2.2).
+	{
+		return method == HTTPRequest::HTTP_GET
+			|| method == HTTPRequest::HTTP_HEAD
+			|| method == HTTPRequest::HTTP_OPTIONS
+			|| method == HTTPRequest::HTTP_TRACE
+			|| method == HTTPRequest::HTTP_PUT
+			|| method == HTTPRequest::HTTP_DELETE;
+	}
+
+	struct AFLT
+	{
+		bool operator () (const IPAddress& a1, const IPAddress& a2)
+		{
+			return a1.af() < a2.af();
+		}
+	};
+}
+
+
+//
+// HTTPAsyncClient::Exchange
+//
+
+
+HTTPAsyncClient::Exchange::Exchange(const std::string& host, Poco::UInt16 port, const HTTPRequest& request, const std::string& body, Callback* pCallback, const Poco::Timestamp& deadline):
+	_host(host),
+	_port(port),
+	_request(request.getMethod(), request.getURI(), request.getVersion()),
+	_requestBody(body),
+	_pCallback(pCallback),
+	_deadline(deadline),
+	_retried(false),
+	_state(EXCHANGE_PENDING),
+	_pException(0),
+	_done(Poco::Event::EVENT_MANUALRESET)
+{
+	for (HTTPRequest::ConstIterator it = request.begin(); it != request.end(); ++it)
+	{
+		_request.add(it->first, it->second);
+	}
+	if (!_request.has(HTTPRequest::HOST))
+		_request.setHost(host, port);
+	if (!_request.has(HTTPMessage::CONNECTION))
+		_request.setKeepAlive(true);
+	if (!body.empty() || _request.getMethod() == HTTPRequest::HTTP_POST || _request.getMethod() == HTTPRequest::HTTP_PUT)
+	{
+		_request.setChunkedTransferEncoding(false);
+#if defined(POCO_HAVE_INT64)
+		_request.setContentLength64(static_cast<Poco::Int64>(body.size()));
+#else
+		_request.setContentLength(static_cast<int>(body.size()));
+#endif
+	}
+}
+
+
+HTTPAsyncClient::Exchange::~Exchange()
+{
+	delete _pException;
+}
+
+
+void HTTPAsyncClient::Exchange::wait()
+{
+	_done.wait();
+	if (_state == EXCHANGE_FAILED) _pException->rethrow();
+}
+
+
+bool HTTPAsyncClient::Exchange::tryWait(long milliseconds)
+{
+	if (!_done.tryWait(milliseconds)) return false;
+	if (_state == EXCHANGE_FAILED) _pException->rethrow();
+	return true;
+}
+
+
+//
+// HTTPAsyncClient::Callback
+//
+
+
+HTTPAsyncClient::Callback::~Callback()
+{
+}
+
+
+//
+// HTTPAsyncClient::Host
+//
+
+
+struct HTTPAsyncClient::Host
+{
+	Host(const SocketAddress& addr):
+		address(addr),
+		connections(0)
+	{
+	}
+
+	SocketAddress                address;
+	std::deque<Exchange::Ptr>    waiting;
+	std::vector<Connection*>     idle;
+	int                          connections;
+};
+
+
+//
+// HTTPAsyncClient::Connection
+//
+
+
+class HTTPAsyncClient::Connection
+	/// A non-blocking connection to a server, which
+	/// sends a request and parses its response.
+{
+public:
+	enum State
+	{
+		CONN_CONNECTING,
+		CONN_SENDING,
+		CONN_RECEIVING,
+		CONN_IDLE
+	};
+
+	enum Phase
+	{
+		PHASE_HEADER,
+		PHASE_BODY,
+		PHASE_CHUNK_SIZE,
+		PHASE_CHUNK_DATA,
+		PHASE_CHUNK_END,
+		PHASE_TRAILER,
+		PHASE_UNTIL_EOF
+	};
+
+	Connection(Host& h):
+		host(h),
+		state(CONN_CONNECTING),
+		sent(0),
+		phase(PHASE_HEADER),
+		remaining(0),
+		reused(false),
+		received(false)
+	{
+	}
+
+	void begin(Exchange::Ptr pEx)
+		/// Prepares the connection for sending
+		/// the request of the given exchange.
+	{
+		pExchange = pEx;
+		std::ostringstream ostr;
+		pExchange->_request.write(ostr);
+		output = ostr.str();
+		output.append(pExchange->_requestBody);
+		sent      = 0;
+		input.clear();
+		phase     = PHASE_HEADER;
+		remaining = 0;
+		received  = false;
+		pExchange->_response.clear();
+		pExchange->_responseBody.clear();
+	}
+
+	bool send()
+		/// Sends as much of the request as possible.
+		/// Returns true if the request has been sent completely.
+	{
+		while (sent < output.size())
+		{
+			int n = 0;
+			try
+			{
+				n = socket.sendBytes(output.data() + sent, static_cast<int>(output.size() - sent));
+			}
+			catch (Poco::IOException& exc)
+			{
+				if (exc.code() == POCO_EWOULDBLOCK || exc.code() == POCO_EAGAIN)
+					return false;
+				throw;
+			}
+			if (n <= 0) return false;
+			sent += n;
+		}
+		return true;
+	}
+
+	bool parse()
+		/// Parses the received data. Returns true
+		/// if the response is complete.
+	{
+		Exchange& ex = *pExchange;
+		std::size_t pos = 0;
+		bool complete = false;
+		while (!complete && pos < input.size())
+		{
+			if (phase == PHASE_HEADER)
+			{
+				std::string::size_type end = input.find("\r\n\r\n", pos);
+				if (end == std::string::npos)
+				{
+					if (input.size() - pos > MAX_HEADER_SIZE) throw MessageException("Response header too long");
+					break;
+				}
+				std::istringstream istr(input.substr(pos, end + 4 - pos));
+				ex._response.clear();
+				ex._response.read(istr);
+				pos = end + 4;
+
+				int status = ex._response.getStatus();
+				if (status >= 100 && status < 200)
+				{
+					// interim response
+				}
+				else if (ex._request.getMethod() == HTTPRequest::HTTP_HEAD
+					|| status == HTTPResponse::HTTP_NO_CONTENT
+					|| status == HTTPResponse::HTTP_NOT_MODIFIED)
+				{
+					complete = true;
+				}
+				else if (ex._response.getChunkedTransferEncoding())
+				{
+					phase = PHASE_CHUNK_SIZE;
+				}
+				else if (ex._response.hasContentLength())
+				{
+#if defined(POCO_HAVE_INT64)
+					remaining = ex._response.getContentLength64();
+#else
+					remaining = ex._response.getContentLength();
+#endif
+					if (remaining > 0)
+						phase = PHASE_BODY;
+					else
+						complete = true;
+				}
+				else
+				{
+					phase = PHASE_UNTIL_EOF;
+				}
+			}
+			else if (phase == PHASE_BODY || phase == PHASE_CHUNK_DATA)
+			{
+				std::size_t n = input.size() - pos;
+				if (static_cast<Poco::Int64>(n) > remaining) n = static_cast<std::size_t>(remaining);
+				ex._responseBody.append(input, pos, n);
+				pos += n;
+				remaining -= n;
+				if (remaining == 0)
+				{
+					if (phase == PHASE_BODY)
+						complete = true;
+					else
+						phase = PHASE_CHUNK_END;
+				}
+			}
+			else if (phase == PHASE_UNTIL_EOF)
+			{
+				ex._responseBody.append(input, pos, std::string::npos);
+				pos = input.size();
+			}
+			else
+			{
+				std::string::size_type eol = input.find("\r\n", pos);
+				if (eol == std::string::npos)
+				{
+					if (input.size() - pos > MAX_LINE_SIZE) throw MessageException("Invalid chunked transfer encoding");
+					break;
+				}
+				std::string line(input, pos, eol - pos);
+				pos = eol + 2;
+				if (phase == PHASE_CHUNK_SIZE)
+				{
+					std::string::size_type semi = line.find(';');
+					if (semi != std::string::npos) line.resize(semi);
+					Poco::trimInPlace(line);
+					unsigned chunk;
+					if (!NumberParser::tryParseHex(line, chunk)) throw MessageException("Invalid chunk size", line);
+					if (chunk > 0)
+					{
+						remaining = chunk;
+						phase = PHASE_CHUNK_DATA;
+					}
+					else phase = PHASE_TRAILER;
+				}
+				else if (phase == PHASE_CHUNK_END)
+				{
+					if (!line.empty()) throw MessageException("Invalid chunked transfer encoding");
+					phase = PHASE_CHUNK_SIZE;
+				}
+				else if (line.empty())
+				{
+					complete = true;
+				}
+			}
+		}
+		input.erase(0, pos);
+		return complete;
+	}
+
+	bool keepAlive() const
+		/// Returns true if the connection can be
+		/// used for another request.
+	{
+		return phase != PHASE_UNTIL_EOF
+			&& input.empty()
+			&& pExchange->_request.getKeepAlive()
+			&& pExchange->_response.getKeepAlive();
+	}
+
+	Host&           host;
+	StreamSocket    socket;
+	State           state;
+	Exchange::Ptr   pExchange;
+	std::string     output;
+	std::size_t     sent;
+	std::string     input;
+	Phase           phase;
+	Poco::Int64     remaining;
+	bool            reused;
+	bool            received;
+	Poco::Timestamp idleSince;
+};
+
+
+//
+// HTTPAsyncClient::Loop
+//
+
+
+class HTTPAsyncClient::Loop: public Poco::Runnable
+	/// A thread that drives the connections to a part
+	/// of the servers a HTTPAsyncClient sends requests to.
+{
+public:
+	Loop(HTTPAsyncClient& client):
+		_client(client),
+		_stopped(false)
+	{
+		// Other threads wake up the loop by sending a
+		// datagram to a socket in the loop's PollSet.
+		_wakeUpSocket.bind(SocketAddress("127.0.0.1", 0));
+		_wakeUpSocket.connect(_wakeUpSocket.address());
+		_wakeUpSocket.setBlocking(false);
+		_pollSet.add(_wakeUpSocket, PollSet::POLL_READ);
+		_thread.start(*this);
+	}
+
+	~Loop()
+	{
+		try
+		{
+			stop();
+		}
+		catch (...)
+		{
+			poco_unexpected();
+		}
+	}
+
+	void enqueue(Exchange::Ptr pExchange)
+	{
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			if (_stopped) throw Poco::IllegalStateException("HTTPAsyncClient has been closed");
+			_queue.push_back(pExchange);
+		}
+		wakeUp();
+	}
+
+	void stop()
+	{
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			if (_stopped) return;
+			_stopped = true;
+		}
+		wakeUp();
+		_thread.join();
+	}
+
+	void run()
+	{
+		PollSet::SocketModeMap ready;
+		Poco::Timestamp nextCheck;
+		for (;;)
+		{
+			{
+				Poco::FastMutex::ScopedLock lock(_mutex);
+				if (_stopped) break;
+			}
+			Poco::Timespan timeout = nextCheck - Poco::Timestamp();
+			if (timeout < 0) timeout = 0;
+			try
+			{
+				_pollSet.poll(timeout, ready);
+			}
+			catch (Poco::Exception& exc)
+			{
+				ErrorHandler::handle(exc);
+				ready.clear();
+			}
+			for (PollSet::SocketModeMap::iterator it = ready.begin(); it != ready.end(); ++it)
+			{
+				if (it->first == _wakeUpSocket)
+				{
+					drainWakeUp();
+					continue;
+				}
+				ConnectionMap::iterator itc = _connections.find(it->first.impl());
+				if (itc != _connections.end())
+				{
+					Connection* pConnection = itc->second;
+					Host& host = pConnection->host;
+					try
+					{
+						handleEvents(pConnection, it->second);
+					}
+					catch (Poco::Exception& exc)
+					{
+						failConnection(pConnection, exc);
+					}
+					dispatch(host);
+				}
+			}
+			processQueue(nextCheck);
+			Poco::Timestamp now;
+			if (now >= nextCheck)
+			{
+				nextCheck = checkTimeouts(now);
+			}
+		}
+		shutdown();
+	}
+
+private:
+	typedef std::map<std::string, Host*> HostMap;
+	typedef std::map<SocketImpl*, Connection*> ConnectionMap;
+
+	void wakeUp()
+	{
+		try
+		{
+			_wakeUpSocket.sendBytes("w", 1);
+		}
+		catch (Poco::Exception&)
+		{
+			// The socket buffer is full, so the loop
+			// will wake up anyway.
+		}
+	}
+
+	void drainWakeUp()
+	{
+		char buffer[64];
+		try
+		{
+			while (_wakeUpSocket.receiveBytes(buffer, sizeof(buffer)) > 0);
+		}
+		catch (Poco::Exception&)
+		{
+		}
+	}
+
+	void processQueue(Poco::Timestamp& nextCheck)
+		/// Dispatches the exchanges sent by other threads whose
+		/// host name has been resolved, and moves the next check
+		/// of deadlines forward if needed.
+	{
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			_resolving.insert(_resolving.end(), _queue.begin(), _queue.end());
+			_queue.clear();
+		}
+		std::vector<Exchange::Ptr>::iterator it = _resolving.begin();
+		while (it != _resolving.end())
+		{
+			Exchange::Ptr pExchange = *it;
+			if (pExchange->_deadline < nextCheck) nextCheck = pExchange->_deadline;
+			if (pExchange->_pLookup && !pExchange->_pLookup->available())
+			{
+				++it;
+				continue;
+			}
+			it = _resolving.erase(it);
+			try
+			{
+				resolve(*pExchange);
+			}
+			catch (Poco::Exception& exc)
+			{
+				_client.finishExchange(pExchange, &exc);
+				continue;
+			}
+			const SocketAddress& address = pExchange->_address;
+			std::string key = address.toString();
+			HostMap::iterator itHost = _hosts.find(key);
+			if (itHost == _hosts.end())
+			{
+				itHost = _hosts.insert(HostMap::value_type(key, new Host(address))).first;
+			}
+			itHost->second->waiting.push_back(pExchange);
+			dispatch(*itHost->second);
+		}
+		if (!_resolving.empty())
+		{
+			// The DNS cache cannot notify the loop, so
+			// pending lookups are checked periodically.
+			Poco::Timestamp next = Poco::Timestamp() + LOOKUP_INTERVAL;
+			if (next < nextCheck) nextCheck = next;
+		}
+	}
+
+	void resolve(Exchange& exchange)
+		/// Sets the address of the given exchange from the
+		/// result of its host name lookup, if it had one.
+		/// IPv4 addresses are preferred, like in SocketAddress.
+	{
+		if (!exchange._pLookup) return;
+
+		Exchange::LookupPtr pLookup = exchange._pLookup;
+		exchange._pLookup = 0;
+		if (pLookup->failed())
+		{
+			if (pLookup->exception())
+				pLookup->exception()->rethrow();
+			else
+				throw HostNotFoundException(pLookup->error(), exchange._host);
+		}
+		HostEntry::AddressList addresses = pLookup->data().addresses();
+		if (addresses.empty()) throw HostNotFoundException("No address found for host", exchange._host);
+#if defined(POCO_HAVE_IPv6)
+		std::sort(addresses.begin(), addresses.end(), AFLT());
+#endif
+		exchange._address = SocketAddress(addresses[0], exchange._port);
+	}
+
+	void dispatch(Host& host)
+	{
+		while (!host.waiting.empty())
+		{
+			if (!host.idle.empty())
+			{
+				Exchange::Ptr pExchange = host.waiting.front();
+				host.waiting.pop_front();
+				Connection* pConnection = host.idle.back();
+				host.idle.pop_back();
+				startExchange(pConnection, pExchange);
+			}
+			else if (host.connections < _client._maxConnectionsPerHost)
+			{
+				Exchange::Ptr pExchange = host.waiting.front();
+				host.waiting.pop_front();
+				openConnection(host, pExchange);
+			}
+			else break;
+		}
+	}
+
+	void openConnection(Host& host, Exchange::Ptr pExchange)
+	{
+		Connection* pConnection = new Connection(host);
+		try
+		{
+			pConnection->socket.connectNB(host.address);
+			_pollSet.add(pConnection->socket, PollSet::POLL_WRITE);
+		}
+		catch (Poco::Exception& exc)
+		{
+			delete pConnection;
+			_client.finishExchange(pExchange, &exc);
+			return;
+		}
+		pConnection->pExchange = pExchange;
+		_connections[pConnection->socket.impl()] = pConnection;
+		++host.connections;
+		++_client._connections;
+		++_client._connectionsOpened;
+	}
+
+	void startExchange(Connection* pConnection, Exchange::Ptr pExchange)
+	{
+		try
+		{
+			pConnection->begin(pExchange);
+			pConnection->state = Connection::CONN_SENDING;
+			sendRequest(pConnection);
+		}
+		catch (Poco::Exception& exc)
+		{
+			failConnection(pConnection, exc);
+		}
+	}
+
+	void sendRequest(Connection* pConnection)
+	{
+		if (pConnection->send())
+		{
+			pConnection->state = Connection::CONN_RECEIVING;
+			_pollSet.update(pConnection->socket, PollSet::POLL_READ);
+		}
+		else
+		{
+			_pollSet.update(pConnection->socket, PollSet::POLL_READ | PollSet::POLL_WRITE);
+		}
+	}
+
+	void handleEvents(Connection* pConnection, int mode)
+		/// Handles the events reported for the given connection.
+		/// The connection may have been closed when this returns.
+	{
+		if (pConnection->state == Connection::CONN_CONNECTING)
+		{
+			int err = pConnection->socket.impl()->socketError();
+			if (err != 0)
+			{
+				if (err == POCO_ECONNREFUSED)
+					throw ConnectionRefusedException(pConnection->host.address.toString(), err);
+				else
+					throw NetException(Poco::Error::getMessage(err), pConnection->host.address.toString(), err);
+			}
+			if (!(mode & PollSet::POLL_WRITE)) return;
+
+			pConnection->socket.setNoDelay(true);
+			Exchange::Ptr pExchange = pConnection->pExchange;
+			pConnection->begin(pExchange);
+			pConnection->state = Connection::CONN_SENDING;
+			sendRequest(pConnection);
+			return;
+		}
+		if (pConnection->state == Connection::CONN_SENDING && (mode & PollSet::POLL_WRITE))
+		{
+			sendRequest(pConnection);
+		}
+		if (mode & (PollSet::POLL_READ | PollSet::POLL_ERROR))
+		{
+			receive(pConnection);
+		}
+	}
+
+	void receive(Connection* pConnection)
+	{
+		char buffer[BUFFER_SIZE];
+		int n = pConnection->socket.receiveBytes(buffer, sizeof(buffer));
+		if (n < 0) return;
+
+		if (pConnection->state == Connection::CONN_IDLE)
+		{
+			// The server has closed the idle connection.
+			closeConnection(pConnection);
+		}
+		else if (n == 0)
+		{
+			if (pConnection->phase == Connection::PHASE_UNTIL_EOF)
+				completeExchange(pConnection, false);
+			else if (pConnection->received)
+				throw MessageException("Connection closed before the response was complete");
+			else
+				throw NoMessageException("Connection closed without a response");
+		}
+		else
+		{
+			pConnection->received = true;
+			pConnection->input.append(buffer, n);
+			if (pConnection->parse())
+			{
+				completeExchange(pConnection, pConnection->state == Connection::CONN_RECEIVING && pConnection->keepAlive());
+			}
+		}
+	}
+
+	void completeExchange(Connection* pConnection, bool keepAlive)
+	{
+		Exchange::Ptr pExchange = pConnection->pExchange;
+		pConnection->pExchange = 0;
+		if (keepAlive)
+		{
+			pConnection->state    = Connection::CONN_IDLE;
+			pConnection->reused   = true;
+			pConnection->output.clear();
+			pConnection->idleSince.update();
+			_pollSet.update(pConnection->socket, PollSet::POLL_READ);
+			pConnection->host.idle.push_back(pConnection);
+		}
+		else closeConnection(pConnection);
+
+		_client.finishExchange(pExchange, 0);
+	}
+
+	void failConnection(Connection* pConnection, const Poco::Exception& exc)
+		/// Closes the given connection, and fails its exchange.
+		/// If the connection has been reused and the server has
+		/// closed it before sending anything, an idempotent request
+		/// is sent again on another connection. Other requests may
+		/// already have been processed by the server, and fail.
+	{
+		Exchange::Ptr pExchange = pConnection->pExchange;
+		bool retry = pConnection->reused && !pConnection->received && pExchange && isIdempotent(pExchange->_request.getMethod());
+		Host& host = pConnection->host;
+		closeConnection(pConnection);
+		if (pExchange)
+		{
+			if (retry && !pExchange->_retried)
+			{
+				pExchange->_retried = true;
+				host.waiting.push_front(pExchange);
+			}
+			else _client.finishExchange(pExchange, &exc);
+		}
+	}
+
+	void closeConnection(Connection* pConnection)
+	{
+		Host& host = pConnection->host;
+		_pollSet.remove(pConnection->socket);
+		_connections.erase(pConnection->socket.impl());
+		std::vector<Connection*>::iterator it = std::find(host.idle.begin(), host.idle.end(), pConnection);
+		if (it != host.idle.end()) host.idle.erase(it);
+		--host.connections;
+		--_client._connections;
+		try
+		{
+			pConnection->socket.close();
+		}
+		catch (Poco::Exception&)
+		{
+		}
+		delete pConnection;
+	}
+
+	Poco::Timestamp checkTimeouts(const Poco::Timestamp& now)
+		/// Fails exchanges whose deadline has passed, closes
+		/// connections that have been idle for too long, and
+		/// returns the time of the next check.
+	{
+		Poco::Timestamp next = now + Poco::Timespan(1, 0);
+		Poco::TimeoutException timeout("HTTP exchange timed out");
+
+		std::vector<Connection*> expired;
+		for (ConnectionMap::iterator it = _connections.begin(); it != _connections.end(); ++it)
+		{
+			Connection* pConnection = it->second;
+			Poco::Timestamp deadline;
+			if (pConnection->state == Connection::CONN_IDLE)
+				deadline = pConnection->idleSince + _client._keepAliveTimeout;
+			else
+				deadline = pConnection->pExchange->_deadline;
+			if (deadline <= now)
+				expired.push_back(pConnection);
+			else if (deadline < next)
+				next = deadline;
+		}
+		for (std::vector<Connection*>::iterator it = expired.begin(); it != expired.end(); ++it)
+		{
+			Exchange::Ptr pExchange = (*it)->pExchange;
+			closeConnection(*it);
+			if (pExchange) _client.finishExchange(pExchange, &timeout);
+		}
+
+		std::vector<Exchange::Ptr>::iterator itRes = _resolving.begin();
+		while (itRes != _resolving.end())
+		{
+			if ((*itRes)->_deadline <= now)
+			{
+				// The lookup is left to the DNS cache,
+				// which will still cache its result.
+				Exchange::Ptr pExchange = *itRes;
+				itRes = _resolving.erase(itRes);
+				pExchange->_pLookup = 0;
+				_client.finishExchange(pExchange, &timeout);
+			}
+			else ++itRes;
+		}
+		if (!_resolving.empty())
+		{
+			Poco::Timestamp lookupCheck = now + LOOKUP_INTERVAL;
+			if (lookupCheck < next) next = lookupCheck;
+		}
+
+		for (HostMap::iterator it = _hosts.begin(); it != _hosts.end();)
+		{
+			Host* pHost = it->second;
+			std::deque<Exchange::Ptr>::iterator itEx = pHost->waiting.begin();
+			while (itEx != pHost->waiting.end())
+			{
+				if ((*itEx)->_deadline <= now)
+				{
+					Exchange::Ptr pExchange = *itEx;
+					itEx = pHost->waiting.erase(itEx);
+					_client.finishExchange(pExchange, &timeout);
+				}
+				else
+				{
+					if ((*itEx)->_deadline < next) next = (*itEx)->_deadline;
+					++itEx;
+				}
+			}
+			dispatch(*pHost);
+			if (pHost->connections == 0 && pHost->waiting.empty())
+			{
+				delete pHost;
+				_hosts.erase(it++);
+			}
+			else ++it;
+		}
+		return next;
+	}
+
+	void shutdown()
+		/// Closes all connections and fails all exchanges
+		/// that have not completed yet.
+	{
+		Poco::IOException exc("HTTPAsyncClient has been closed");
+		std::vector<Exchange::Ptr> failed;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			std::swap(failed, _queue);
+		}
+		failed.insert(failed.end(), _resolving.begin(), _resolving.end());
+		_resolving.clear();
+		while (!_connections.empty())
+		{
+			Connection* pConnection = _connections.begin()->second;
+			if (pConnection->pExchange) failed.push_back(pConnection->pExchange);
+			closeConnection(pConnection);
+		}
+		for (HostMap::iterator it = _hosts.begin(); it != _hosts.end(); ++it)
+		{
+			failed.insert(failed.end(), it->second->waiting.begin(), it->second->waiting.end());
+			delete it->second;
+		}
+		_hosts.clear();
+		for (std::vector<Exchange::Ptr>::iterator it = failed.begin(); it != failed.end(); ++it)
+		{
+			_client.finishExchange(*it, &exc);
+		}
+	}
+
+	HTTPAsyncClient&           _client;
+	PollSet                    _pollSet;
+	DatagramSocket             _wakeUpSocket;
+	HostMap                    _hosts;
+	ConnectionMap              _connections;
+	std::vector<Exchange::Ptr> _queue;
+	std::vector<Exchange::Ptr> _resolving;
+	bool                       _stopped;
+	Poco::FastMutex            _mutex;
+	Poco::Thread               _thread;
+};
+
+
+//
+// HTTPAsyncClient
+//
+
+
+HTTPAsyncClient::HTTPAsyncClient(int threads):
+	_timeout(30, 0),
+	_keepAliveTimeout(8, 0),
+	_maxConnectionsPerHost(DEFAULT_MAX_CONNECTIONS_PER_HOST),
+	_closed(false)
+{
+	poco_assert (threads > 0);
+
+	for (int i = 0; i < threads; ++i)
+	{
+		_loops.push_back(new Loop(*this));
+	}
+}
+
+
+HTTPAsyncClient::~HTTPAsyncClient()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+	for (std::vector<Loop*>::iterator it = _loops.begin(); it != _loops.end(); ++it)
+	{
+		delete *it;
+	}
+}
+
+
+HTTPAsyncClient::Exchange::Ptr HTTPAsyncClient::sendRequest(const std::string& host, Poco::UInt16 port, const HTTPRequest& request, const std::string& body, Callback* pCallback)
+{
+	return sendRequest(host, port, request, body, pCallback, _timeout);
+}
+
+
+HTTPAsyncClient::Exchange::Ptr HTTPAsyncClient::sendRequest(const std::string& host, Poco::UInt16 port, const HTTPRequest& request, const std::string& body, Callback* pCallback, const Poco::Timespan& timeout)
+{
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		if (_closed) throw Poco::IllegalStateException("HTTPAsyncClient has been closed");
+	}
+
+	Exchange::Ptr pExchange = new Exchange(host, port, request, body, pCallback, Poco::Timestamp() + timeout);
+	IPAddress ip;
+	if (IPAddress::tryParse(host, ip))
+	{
+		pExchange->_address = SocketAddress(ip, port);
+	}
+	else
+	{
+		// The lookup is finished by the loop, under the
+		// deadline of the exchange, so that the calling
+		// thread never waits for the DNS server.
+		pExchange->_pLookup = new Poco::ActiveResult<HostEntry>(DNS::hostByNameAsync(host));
+	}
+	++_pending;
+
+	// All requests to a server are handled by the same loop,
+	// so that they can share its connections.
+	std::string key = host;
+	key += ':';
+	NumberFormatter::append(key, port);
+	std::size_t hash = 0;
+	for (std::string::const_iterator it = key.begin(); it != key.end(); ++it)
+	{
+		hash = hash*31 + static_cast<unsigned char>(*it);
+	}
+	try
+	{
+		_loops[hash % _loops.size()]->enqueue(pExchange);
+	}
+	catch (...)
+	{
+		--_pending;
+		throw;
+	}
+	return pExchange;
+}
+
+
+void HTTPAsyncClient::close()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		if (_closed) return;
+		_closed = true;
+	}
+	for (std::vector<Loop*>::iterator it = _loops.begin(); it != _loops.end(); ++it)
+	{
+		(*it)->stop();
+	}
+}
+
+
+void HTTPAsyncClient::setTimeout(const Poco::Timespan& timeout)
+{
+	_timeout = timeout;
+}
+
+
+void HTTPAsyncClient::setKeepAliveTimeout(const Poco::Timespan& timeout)
+{
+	_keepAliveTimeout = timeout;
+}
+
+
+void HTTPAsyncClient::setMaxConnectionsPerHost(int maxConnections)
+{
+	poco_assert (maxConnections > 0);
+
+	_maxConnectionsPerHost = maxConnections;
+}
+
+
+void HTTPAsyncClient::finishExchange(Exchange::Ptr pExchange, const Poco::Exception* pException)
+{
+	if (pException)
+	{
+		pExchange->_pException = pException->clone();
+		pExchange->_state = Exchange::EXCHANGE_FAILED;
+	}
+	else pExchange->_state = Exchange::EXCHANGE_COMPLETED;
+	--_pending;
+
+	if (pExchange->_pCallback)
+	{
+		try
+		{
+			pExchange->_pCallback->exchangeCompleted(*pExchange);
+		}
+		catch (Poco::Exception& exc)
+		{
+			ErrorHandler::handle(exc);
+		}
+		catch (std::exception& exc)
+		{
+			ErrorHandler::handle(exc);
+		}
+		catch (...)
+		{
+			ErrorHandler::handle();
+		}
+	}
+	pExchange->_done.set();
+}
+
+
+} } // namespace Poco::Net
@@ -52,7 +52,11 @@ void HTTPChunkedStreamBuf::close()
 {
 	if (_mode & std::ios::out)
 	{
-		sync();
+		// the last chunk is sent together with the terminating chunk
+		bool deferred = _session.getDeferredOutput();
+		_session.setDeferredOutput(true);
+		HTTPBasicStreamBuf::sync();
+		_session.setDeferredOutput(deferred);
 		_session.write("0\r\n\r\n", 5);
 	}
 }
@@ -103,6 +107,14 @@ int HTTPChunkedStreamBuf::writeToDevice(const char* buffer, std::streamsize leng
 }
 
 
+int HTTPChunkedStreamBuf::sync()
+{
+	int rc = HTTPBasicStreamBuf::sync();
+	if ((_mode & std::ios::out) && !_session.getDeferredOutput()) _session.flush();
+	return rc;
+}
+
+
 //
 // HTTPChunkedIOS
 //
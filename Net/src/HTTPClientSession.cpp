@@ -27,6 +27,7 @@
 #include "Poco/CountingStream.h"
 #include "Poco/RegularExpression.h"
 #include <sstream>
+#include <limits>
 
 
 using Poco::NumberFormatter;
@@ -191,13 +192,26 @@ void HTTPClientSession::setKeepAliveTimeout(const Poco::Timespan& timeout)
 std::ostream& HTTPClientSession::sendRequest(HTTPRequest& request)
 {
 	clearException();
-	_pResponseStream = 0;
 
 	bool keepAlive = getKeepAlive();
-	if ((connected() && !keepAlive) || mustReconnect())
+	bool pipelined = keepAlive && connected() && !_pipeline.empty();
+	if (pipelined)
 	{
-		close();
-		_mustReconnect = false;
+		// The previous request is sent when its stream is destroyed,
+		// so it is held back together with this one.
+		setDeferredOutput(true);
+		_pRequestStream = 0;
+	}
+	else
+	{
+		_pResponseStream = 0;
+		_pipeline.clear();
+		setDeferredOutput(false);
+		if ((connected() && !keepAlive) || mustReconnect())
+		{
+			close();
+			_mustReconnect = false;
+		}
 	}
 	try
 	{
@@ -212,8 +226,8 @@ std::ostream& HTTPClientSession::sendRequest(HTTPRequest& request)
 			request.setURI(proxyRequestPrefix() + request.getURI());
 			proxyAuthenticate(request);
 		}
-		_reconnect = keepAlive;
-		_expectResponseBody = request.getMethod() != HTTPRequest::HTTP_HEAD;
+		_reconnect = keepAlive && !pipelined;
+		_pipeline.push_back(request.getMethod() != HTTPRequest::HTTP_HEAD);
 		if (request.getChunkedTransferEncoding())
 		{
 			HTTPHeaderOutputStream hos(*this);
@@ -248,6 +262,7 @@ std::ostream& HTTPClientSession::sendRequest(HTTPRequest& request)
 	}
 	catch (Exception&)
 	{
+		_pipeline.clear();
 		close();
 		throw;
 	}
@@ -259,6 +274,18 @@ std::istream& HTTPClientSession::receiveResponse(HTTPResponse& response)
 	_pRequestStream = 0;
 	if (networkException()) networkException()->rethrow();
 
+	if (_pResponseStream)
+	{
+		// skip the rest of the previous pipelined response
+		_pResponseStream->ignore(std::numeric_limits<std::streamsize>::max());
+		_pResponseStream = 0;
+	}
+	if (!_pipeline.empty())
+	{
+		_expectResponseBody = _pipeline.front();
+		_pipeline.pop_front();
+	}
+
 	do
 	{
 		response.clear();
@@ -269,6 +296,7 @@ std::istream& HTTPClientSession::receiveResponse(HTTPResponse& response)
 		}
 		catch (Exception&)
 		{
+			_pipeline.clear();
 			close();
 			if (networkException())
 				networkException()->rethrow();
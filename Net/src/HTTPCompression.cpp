@@ -0,0 +1,156 @@
+//
+// HTTPCompression.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPCompression
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTPCompression.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/MessageHeader.h"
+#include "Poco/Net/NameValueCollection.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/NumberParser.h"
+#include "Poco/String.h"
+#include <sstream>
+
+
+namespace Poco {
+namespace Net {
+
+
+const std::string HTTPCompression::GZIP("gzip");
+const std::string HTTPCompression::DEFLATE("deflate");
+const std::string HTTPCompression::ACCEPT_ENCODING("Accept-Encoding");
+const std::string HTTPCompression::CONTENT_ENCODING("Content-Encoding");
+const std::string HTTPCompression::VARY("Vary");
+const std::string HTTPCompression::ETAG("ETag");
+
+
+std::string HTTPCompression::negotiate(const std::string& acceptEncoding)
+{
+	double gzip    = -1;
+	double deflate = -1;
+	double any     = -1;
+	std::vector<std::string> elements;
+	MessageHeader::splitElements(acceptEncoding, elements);
+	for (std::vector<std::string>::const_iterator it = elements.begin(); it != elements.end(); ++it)
+	{
+		std::string coding;
+		NameValueCollection params;
+		MessageHeader::splitParameters(*it, coding, params);
+		double q = 1;
+		if (params.has("q") && !NumberParser::tryParseFloat(params.get("q"), q)) q = 0;
+
+		if (Poco::icompare(coding, GZIP) == 0 || Poco::icompare(coding, "x-gzip") == 0)
+			gzip = q;
+		else if (Poco::icompare(coding, DEFLATE) == 0)
+			deflate = q;
+		else if (coding == "*")
+			any = q;
+	}
+	if (gzip < 0) gzip = any;
+	if (deflate < 0) deflate = any;
+
+	if (gzip > 0 && gzip >= deflate)
+		return GZIP;
+	else if (deflate > 0)
+		return DEFLATE;
+	else
+		return std::string();
+}
+
+
+bool HTTPCompression::isCompressible(const std::string& contentType, const std::vector<std::string>& mediaTypes)
+{
+	std::string::const_iterator end = contentType.begin();
+	while (end != contentType.end() && *end != ';') ++end;
+	std::string mediaType(contentType.begin(), end);
+	Poco::trimInPlace(mediaType);
+	if (mediaType.empty()) return false;
+
+	for (std::vector<std::string>::const_iterator it = mediaTypes.begin(); it != mediaTypes.end(); ++it)
+	{
+		if (it->size() > 1 && it->compare(it->size() - 2, 2, "/*") == 0)
+		{
+			std::size_t length = it->size() - 1;
+			if (mediaType.size() > length && Poco::icompare(mediaType, 0, length, *it, 0, length) == 0)
+				return true;
+		}
+		else if (Poco::icompare(mediaType, *it) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+std::string HTTPCompression::encodingFor(const HTTPServerRequest& request, HTTPResponse& response, Poco::Int64 length)
+{
+	const HTTPServerParams& params = request.serverParams();
+	if (!params.getCompressionEnabled()) return std::string();
+
+	HTTPResponse::HTTPStatus status = response.getStatus();
+	if (status < HTTPResponse::HTTP_OK || status >= HTTPResponse::HTTP_MULTIPLE_CHOICES
+		|| status == HTTPResponse::HTTP_NO_CONTENT || status == HTTPResponse::HTTP_PARTIAL_CONTENT)
+		return std::string();
+	if (response.has(CONTENT_ENCODING) || !isCompressible(response.getContentType(), params.getCompressedMediaTypes()))
+		return std::string();
+
+	// The response depends on Accept-Encoding, even if it is not compressed.
+	const std::string& vary = response.get(VARY, HTTPMessage::EMPTY);
+	if (vary.empty())
+	{
+		response.set(VARY, ACCEPT_ENCODING);
+	}
+	else if (Poco::toLower(vary).find("accept-encoding") == std::string::npos && vary != "*")
+	{
+		response.set(VARY, vary + ", " + ACCEPT_ENCODING);
+	}
+
+	if (length >= 0 && length < params.getMinCompressionSize())
+		return std::string();
+	return negotiate(request.get(ACCEPT_ENCODING, HTTPMessage::EMPTY));
+}
+
+
+void HTTPCompression::compress(const char* data, std::size_t length, const std::string& encoding, int level, std::string& output)
+{
+	std::ostringstream ostr;
+	Poco::DeflatingOutputStream deflater(ostr, streamType(encoding), level);
+	deflater.write(data, static_cast<std::streamsize>(length));
+	deflater.close();
+	output = ostr.str();
+}
+
+
+void HTTPCompression::compress(std::istream& istr, const std::string& encoding, int level, std::string& output)
+{
+	std::ostringstream ostr;
+	Poco::DeflatingOutputStream deflater(ostr, streamType(encoding), level);
+	Poco::StreamCopier::copyStream(istr, deflater);
+	deflater.close();
+	output = ostr.str();
+}
+
+
+Poco::DeflatingStreamBuf::StreamType HTTPCompression::streamType(const std::string& encoding)
+{
+	// Note: The "deflate" content coding is the zlib format (RFC 7230, section 4.2.2).
+	return encoding == GZIP ? Poco::DeflatingStreamBuf::STREAM_GZIP : Poco::DeflatingStreamBuf::STREAM_ZLIB;
+}
+
+
+} } // namespace Poco::Net
@@ -0,0 +1,75 @@
+//
+// HTTPCompressionCache.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPCompression
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTPCompressionCache.h"
+#include "Poco/Net/HTTPCompression.h"
+#include "Poco/FileStream.h"
+#include "Poco/Exception.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+HTTPCompressionCache::HTTPCompressionCache(std::size_t maxEntries, std::size_t maxFileSize):
+	_cache(static_cast<long>(maxEntries)),
+	_maxFileSize(maxFileSize)
+{
+}
+
+
+HTTPCompressionCache::~HTTPCompressionCache()
+{
+}
+
+
+HTTPCompressionCache::DataPtr HTTPCompressionCache::get(const std::string& path, const Poco::Timestamp& modified, Poco::UInt64 size, const std::string& encoding, int level)
+{
+	if (size > _maxFileSize) return DataPtr();
+
+	std::string key(encoding);
+	key += ':';
+	key += path;
+	Poco::SharedPtr<Entry> pEntry = _cache.get(key);
+	if (pEntry && pEntry->modified == modified && pEntry->size == size && pEntry->level == level)
+		return pEntry->pData;
+
+	Poco::FileInputStream istr(path);
+	if (!istr.good()) throw OpenFileException(path);
+	Entry entry;
+	entry.modified = modified;
+	entry.size     = size;
+	entry.level    = level;
+	entry.pData    = new std::string;
+	HTTPCompression::compress(istr, encoding, level, *entry.pData);
+	_cache.update(key, entry);
+	return entry.pData;
+}
+
+
+void HTTPCompressionCache::clear()
+{
+	_cache.clear();
+}
+
+
+std::size_t HTTPCompressionCache::size()
+{
+	return _cache.size();
+}
+
+
+} } // namespace Poco::Net
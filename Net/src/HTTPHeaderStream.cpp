@@ -16,6 +16,7 @@
 
 #include "Poco/Net/HTTPHeaderStream.h"
 #include "Poco/Net/HTTPSession.h"
+#include <cstring>
 
 
 namespace Poco {
@@ -30,7 +31,9 @@ namespace Net {
 HTTPHeaderStreamBuf::HTTPHeaderStreamBuf(HTTPSession& session, openmode mode):
 	HTTPBasicStreamBuf(HTTPBufferAllocator::BUFFER_SIZE, mode),
 	_session(session),
-	_end(false)
+	_end(false),
+	_lineLength(0),
+	_firstChar(0)
 {
 }
 
@@ -42,22 +45,39 @@ HTTPHeaderStreamBuf::~HTTPHeaderStreamBuf()
 
 int HTTPHeaderStreamBuf::readFromDevice(char* buffer, std::streamsize length)
 {
-	// read line-by-line; an empty line denotes the end of the headers.
-	static const int eof = std::char_traits<char>::eof();
-
+	// Copies as many lines as are available from the session buffer,
+	// locating line ends with memchr(). An empty line denotes the end
+	// of the headers, and nothing after it must be consumed.
 	if (_end) return 0;
 
 	int n = 0;
-	int ch = _session.get();
-	while (ch != eof && ch != '\n' && n < length - 1)
-	{
-		*buffer++ = (char) ch; ++n;
-		ch = _session.get();
-	}
-	if (ch != eof)
+	while (n < length && !_end)
 	{
-		*buffer++ = (char) ch; ++n;
-		if (n == 2) _end = true;
+		if (_session._pCurrent == _session._pEnd)
+		{
+			if (n > 0) break;
+			_session.refill();
+			if (_session._pCurrent == _session._pEnd) break;
+		}
+		const char* pCurrent = _session._pCurrent;
+		std::streamsize avail = _session._pEnd - pCurrent;
+		if (avail > length - n) avail = length - n;
+		const char* pLF = static_cast<const char*>(std::memchr(pCurrent, '\n', static_cast<std::size_t>(avail)));
+		std::streamsize count = pLF ? pLF - pCurrent : avail;
+		if (count > 0)
+		{
+			if (_lineLength == 0) _firstChar = *pCurrent;
+			_lineLength += count;
+		}
+		if (pLF)
+		{
+			_end = _lineLength == 0 || (_lineLength == 1 && _firstChar == '\r');
+			_lineLength = 0;
+			++count;
+		}
+		std::memcpy(buffer + n, pCurrent, static_cast<std::size_t>(count));
+		_session._pCurrent += count;
+		n += static_cast<int>(count);
 	}
 	return n;
 }
@@ -46,7 +46,8 @@ const std::string HTTPRequest::UPGRADE             = "Upgrade";
 
 HTTPRequest::HTTPRequest():
 	_method(HTTP_GET),
-	_uri("/")
+	_uri("/"),
+	_uriViewValid(false)
 {
 }
 
@@ -54,14 +55,16 @@ HTTPRequest::HTTPRequest():
 HTTPRequest::HTTPRequest(const std::string& version):
 	HTTPMessage(version),
 	_method(HTTP_GET),
-	_uri("/")
+	_uri("/"),
+	_uriViewValid(false)
 {
 }
 
 	
 HTTPRequest::HTTPRequest(const std::string& method, const std::string& uri):
 	_method(method),
-	_uri(uri)
+	_uri(uri),
+	_uriViewValid(false)
 {
 }
 
@@ -69,7 +72,8 @@ HTTPRequest::HTTPRequest(const std::string& method, const std::string& uri):
 HTTPRequest::HTTPRequest(const std::string& method, const std::string& uri, const std::string& version):
 	HTTPMessage(version),
 	_method(method),
-	_uri(uri)
+	_uri(uri),
+	_uriViewValid(false)
 {
 }
 
@@ -88,6 +92,18 @@ void HTTPRequest::setMethod(const std::string& method)
 void HTTPRequest::setURI(const std::string& uri)
 {
 	_uri = uri;
+	_uriViewValid = false;
+}
+
+
+const Poco::URIView& HTTPRequest::getURIView() const
+{
+	if (!_uriViewValid)
+	{
+		_uriView.parse(_uri);
+		_uriViewValid = true;
+	}
+	return _uriView;
 }
 
 
@@ -202,32 +218,44 @@ void HTTPRequest::read(std::istream& istr)
 {
 	static const int eof = std::char_traits<char>::eof();
 
-	std::string method;
-	std::string uri;
-	std::string version;
-	method.reserve(16);
-	uri.reserve(64);
-	version.reserve(16);
 	int ch = istr.get();
 	if (istr.bad()) throw NetException("Error reading HTTP request header");
 	if (ch == eof) throw NoMessageException();
 	while (Poco::Ascii::isSpace(ch)) ch = istr.get();
 	if (ch == eof) throw MessageException("No HTTP request header");
-	while (!Poco::Ascii::isSpace(ch) && ch != eof && method.length() < MAX_METHOD_LENGTH) { method += (char) ch; ch = istr.get(); }
-	if (!Poco::Ascii::isSpace(ch)) throw MessageException("HTTP request method invalid or too long");
-	while (Poco::Ascii::isSpace(ch)) ch = istr.get();
-	while (!Poco::Ascii::isSpace(ch) && ch != eof && uri.length() < MAX_URI_LENGTH) { uri += (char) ch; ch = istr.get(); }
-	if (!Poco::Ascii::isSpace(ch)) throw MessageException("HTTP request URI invalid or too long");
-	while (Poco::Ascii::isSpace(ch)) ch = istr.get();
-	while (!Poco::Ascii::isSpace(ch) && ch != eof && version.length() < MAX_VERSION_LENGTH) { version += (char) ch; ch = istr.get(); }
-	if (!Poco::Ascii::isSpace(ch)) throw MessageException("Invalid HTTP version string");
-	while (ch != '\n' && ch != eof) { ch = istr.get(); }
+
+	// The rest of the request line is extracted in one go (see
+	// MessageHeader::read()) and split into its parts in place.
+	char line[MAX_METHOD_LENGTH + MAX_URI_LENGTH + MAX_VERSION_LENGTH + 16];
+	line[0] = static_cast<char>(ch);
+	istr.getline(line + 1, sizeof(line) - 1);
+	bool tooLong = istr.fail() && !istr.eof();
+	bool complete = !istr.fail() && !istr.eof();
+	const char* end = line + 1 + istr.gcount() - (complete ? 1 : 0);
+
+	const char* it = line;
+	const char* method = it;
+	while (it != end && !Poco::Ascii::isSpace(*it)) ++it;
+	const char* methodEnd = it;
+	if (methodEnd - method > MAX_METHOD_LENGTH || (it == end && !complete)) throw MessageException("HTTP request method invalid or too long");
+	while (it != end && Poco::Ascii::isSpace(*it)) ++it;
+	const char* uri = it;
+	while (it != end && !Poco::Ascii::isSpace(*it)) ++it;
+	const char* uriEnd = it;
+	if (uriEnd == uri || uriEnd - uri > MAX_URI_LENGTH || (it == end && !complete)) throw MessageException("HTTP request URI invalid or too long");
+	while (it != end && Poco::Ascii::isSpace(*it)) ++it;
+	const char* version = it;
+	while (it != end && !Poco::Ascii::isSpace(*it)) ++it;
+	const char* versionEnd = it;
+	if (versionEnd == version || versionEnd - version > MAX_VERSION_LENGTH || (it == end && !complete)) throw MessageException("Invalid HTTP version string");
+	if (tooLong) throw MessageException("HTTP request line too long");
+
 	HTTPMessage::read(istr);
 	ch = istr.get();
 	while (ch != '\n' && ch != eof) { ch = istr.get(); }
-	setMethod(method);
-	setURI(uri);
-	setVersion(version);
+	setMethod(std::string(method, methodEnd));
+	setURI(std::string(uri, uriEnd));
+	setVersion(std::string(version, versionEnd));
 }
 
 
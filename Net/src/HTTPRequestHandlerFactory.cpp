@@ -15,6 +15,7 @@
 
 
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPRequestHandler.h"
 
 
 namespace Poco {
@@ -31,4 +32,33 @@ HTTPRequestHandlerFactory::~HTTPRequestHandlerFactory()
 }
 
 
+void HTTPRequestHandlerFactory::releaseRequestHandler(HTTPRequestHandler* pHandler)
+{
+	delete pHandler;
+}
+
+
+HTTPRequestHandlerFactory::ScopedHandler::ScopedHandler(HTTPRequestHandlerFactory& factory, const HTTPServerRequest& request):
+	_factory(factory),
+	_pHandler(factory.createRequestHandler(request))
+{
+}
+
+
+HTTPRequestHandlerFactory::ScopedHandler::~ScopedHandler()
+{
+	if (_pHandler)
+	{
+		try
+		{
+			_factory.releaseRequestHandler(_pHandler);
+		}
+		catch (...)
+		{
+			poco_unexpected();
+		}
+	}
+}
+
+
 } } // namespace Poco::Net
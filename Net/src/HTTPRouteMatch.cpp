@@ -0,0 +1,108 @@
+//
+// HTTPRouteMatch.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPRouter
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTPRouteMatch.h"
+#include "Poco/Exception.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	const std::string EMPTY;
+}
+
+
+HTTPRouteMatch::HTTPRouteMatch():
+	_pURI(0),
+	_pPattern(0),
+	_pAllowedMethods(0),
+	_count(0)
+{
+}
+
+
+HTTPRouteMatch::~HTTPRouteMatch()
+{
+}
+
+
+const std::string& HTTPRouteMatch::pattern() const
+{
+	return _pPattern ? *_pPattern : EMPTY;
+}
+
+
+std::string HTTPRouteMatch::value(std::size_t index) const
+{
+	poco_assert (index < _count);
+
+	return _pURI->substr(_parameters[index].offset, _parameters[index].length);
+}
+
+
+bool HTTPRouteMatch::has(const std::string& name) const
+{
+	return find(name) < _count;
+}
+
+
+std::string HTTPRouteMatch::get(const std::string& name) const
+{
+	std::size_t index = find(name);
+	if (index < _count)
+		return value(index);
+	else
+		throw NotFoundException("Route parameter", name);
+}
+
+
+std::string HTTPRouteMatch::get(const std::string& name, const std::string& defaultValue) const
+{
+	std::size_t index = find(name);
+	if (index < _count)
+		return value(index);
+	else
+		return defaultValue;
+}
+
+
+const std::string& HTTPRouteMatch::allowedMethods() const
+{
+	return _pAllowedMethods ? *_pAllowedMethods : EMPTY;
+}
+
+
+void HTTPRouteMatch::clear()
+{
+	_pURI = 0;
+	_pPattern = 0;
+	_pAllowedMethods = 0;
+	_count = 0;
+}
+
+
+std::size_t HTTPRouteMatch::find(const std::string& name) const
+{
+	std::size_t index = 0;
+	while (index < _count && *_parameters[index].pName != name) ++index;
+	return index;
+}
+
+
+} } // namespace Poco::Net
@@ -0,0 +1,362 @@
+//
+// HTTPRouter.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPRouter
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTPRouter.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/ThreadLocal.h"
+#include "Poco/Exception.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	class NotFoundRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			response.setStatusAndReason(HTTPResponse::HTTP_NOT_FOUND);
+			response.setContentLength(0);
+			response.send();
+		}
+	};
+
+	class MethodNotAllowedRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			response.setStatusAndReason(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+			response.set("Allow", HTTPRouter::currentMatch().allowedMethods());
+			response.setContentLength(0);
+			response.send();
+		}
+	};
+
+	Poco::ThreadLocal<HTTPRouteMatch> currentRouteMatch;
+}
+
+
+struct HTTPRouter::Node
+	/// A node of the radix tree. The children of a node
+	/// have prefixes starting with different characters,
+	/// which are stored in indices for fast lookup.
+	/// A node can also have a parameter child, which
+	/// matches a path segment, and a catch-all child,
+	/// which matches the rest of the path.
+{
+	struct Route
+	{
+		std::string method;
+		HTTPRequestHandler* pHandler;
+	};
+
+	Node():
+		pParameter(0),
+		pCatchAll(0)
+	{
+	}
+
+	~Node()
+	{
+		for (std::vector<Node*>::iterator it = children.begin(); it != children.end(); ++it)
+		{
+			delete *it;
+		}
+		delete pParameter;
+		delete pCatchAll;
+	}
+
+	std::string prefix;
+	std::string indices;
+	std::vector<Node*> children;
+	Node* pParameter;
+	Node* pCatchAll;
+	std::string name;
+	std::string pattern;
+	std::vector<Route> routes;
+	std::string allowedMethods;
+};
+
+
+const std::string HTTPRouter::ANY_METHOD("*");
+
+
+HTTPRouter::HTTPRouter():
+	_pRoot(new Node),
+	_pNotFoundHandler(new NotFoundRequestHandler),
+	_pMethodNotAllowedHandler(new MethodNotAllowedRequestHandler)
+{
+}
+
+
+HTTPRouter::~HTTPRouter()
+{
+	delete _pRoot;
+}
+
+
+void HTTPRouter::addRoute(const std::string& method, const std::string& pattern, HandlerPtr pHandler)
+{
+	poco_check_ptr (pHandler.get());
+
+	if (method.empty())
+		throw InvalidArgumentException("Empty method for route", pattern);
+	if (pattern.empty() || pattern[0] != '/')
+		throw InvalidArgumentException("Route pattern must start with a slash", pattern);
+
+	Node* pNode = insert(_pRoot, pattern);
+	for (std::vector<Node::Route>::const_iterator it = pNode->routes.begin(); it != pNode->routes.end(); ++it)
+	{
+		if (it->method == method)
+			throw ExistsException("Route", method + " " + pattern);
+	}
+	if (pNode->pattern.empty()) pNode->pattern = pattern;
+	Node::Route route;
+	route.method = method;
+	route.pHandler = pHandler.get();
+	pNode->routes.push_back(route);
+	_handlers.push_back(pHandler);
+
+	bool hasGet = false;
+	bool hasHead = false;
+	pNode->allowedMethods.clear();
+	for (std::vector<Node::Route>::const_iterator it = pNode->routes.begin(); it != pNode->routes.end(); ++it)
+	{
+		if (!pNode->allowedMethods.empty()) pNode->allowedMethods += ", ";
+		pNode->allowedMethods += it->method;
+		hasGet  = hasGet  || it->method == HTTPRequest::HTTP_GET;
+		hasHead = hasHead || it->method == HTTPRequest::HTTP_HEAD;
+	}
+	if (hasGet && !hasHead)
+	{
+		pNode->allowedMethods += ", ";
+		pNode->allowedMethods += HTTPRequest::HTTP_HEAD;
+	}
+}
+
+
+void HTTPRouter::setNotFoundHandler(HandlerPtr pHandler)
+{
+	poco_check_ptr (pHandler.get());
+
+	_pNotFoundHandler = pHandler;
+}
+
+
+bool HTTPRouter::match(const std::string& method, const std::string& uri, HTTPRouteMatch& match) const
+{
+	return route(method, uri, match) != 0;
+}
+
+
+HTTPRequestHandler* HTTPRouter::createRequestHandler(const HTTPServerRequest& request)
+{
+	HTTPRouteMatch& match = *currentRouteMatch;
+	HTTPRequestHandler* pHandler = route(request.getMethod(), request.getURI(), match);
+	if (pHandler)
+		return pHandler;
+	else if (!match.allowedMethods().empty())
+		return _pMethodNotAllowedHandler.get();
+	else
+		return _pNotFoundHandler.get();
+}
+
+
+void HTTPRouter::releaseRequestHandler(HTTPRequestHandler* pHandler)
+{
+}
+
+
+const HTTPRouteMatch& HTTPRouter::currentMatch()
+{
+	return *currentRouteMatch;
+}
+
+
+HTTPRequestHandler* HTTPRouter::route(const std::string& method, const std::string& uri, HTTPRouteMatch& match) const
+{
+	match.clear();
+	match._pURI = &uri;
+
+	// the path of an absolute URI starts after the authority
+	std::size_t begin = 0;
+	if (uri.empty() || uri[0] != '/')
+	{
+		begin = uri.find("://");
+		if (begin == std::string::npos) return 0;
+		begin = uri.find('/', begin + 3);
+		if (begin == std::string::npos) return 0;
+	}
+	std::size_t end = uri.find_first_of("?#", begin);
+	if (end == std::string::npos) end = uri.size();
+
+	const Node* pNode = find(_pRoot, uri, begin, end, match);
+	if (!pNode) return 0;
+
+	match._pPattern = &pNode->pattern;
+	HTTPRequestHandler* pAnyHandler = 0;
+	HTTPRequestHandler* pGetHandler = 0;
+	for (std::vector<Node::Route>::const_iterator it = pNode->routes.begin(); it != pNode->routes.end(); ++it)
+	{
+		if (it->method == method)
+			return it->pHandler;
+		else if (it->method == ANY_METHOD)
+			pAnyHandler = it->pHandler;
+		else if (it->method == HTTPRequest::HTTP_GET)
+			pGetHandler = it->pHandler;
+	}
+	if (pAnyHandler)
+		return pAnyHandler;
+	if (pGetHandler && method == HTTPRequest::HTTP_HEAD)
+		return pGetHandler;
+	match._pAllowedMethods = &pNode->allowedMethods;
+	return 0;
+}
+
+
+HTTPRouter::Node* HTTPRouter::insert(Node* pNode, const std::string& pattern)
+{
+	std::size_t parameters = 0;
+	std::size_t pos = 0;
+	while (pos < pattern.size())
+	{
+		if (pattern[pos] == '{')
+		{
+			std::size_t end = pattern.find('}', pos);
+			if (end == std::string::npos)
+				throw InvalidArgumentException("Unterminated parameter in route pattern", pattern);
+			std::string name(pattern, pos + 1, end - pos - 1);
+			bool catchAll = !name.empty() && name[name.size() - 1] == '*';
+			if (catchAll) name.resize(name.size() - 1);
+			if (name.empty() || name.find_first_of("{/*") != std::string::npos)
+				throw InvalidArgumentException("Invalid parameter name in route pattern", pattern);
+			if (pattern[pos - 1] != '/' || (end + 1 < pattern.size() && (catchAll || pattern[end + 1] != '/')))
+				throw InvalidArgumentException("Parameter must be a complete path segment in route pattern", pattern);
+			if (++parameters > HTTPRouteMatch::MAX_PARAMETERS)
+				throw InvalidArgumentException("Too many parameters in route pattern", pattern);
+
+			Node*& pChild = catchAll ? pNode->pCatchAll : pNode->pParameter;
+			if (!pChild)
+			{
+				pChild = new Node;
+				pChild->name = name;
+			}
+			else if (pChild->name != name)
+			{
+				throw InvalidArgumentException("Conflicting parameter name in route pattern", pattern);
+			}
+			pNode = pChild;
+			pos = end + 1;
+		}
+		else
+		{
+			std::size_t end = pattern.find('{', pos);
+			if (end == std::string::npos) end = pattern.size();
+			if (pattern.find('}', pos) < end)
+				throw InvalidArgumentException("Unbalanced braces in route pattern", pattern);
+			pNode = insertStatic(pNode, pattern, pos, end);
+			pos = end;
+		}
+	}
+	return pNode;
+}
+
+
+HTTPRouter::Node* HTTPRouter::insertStatic(Node* pNode, const std::string& pattern, std::size_t pos, std::size_t end)
+{
+	while (pos < end)
+	{
+		std::string::size_type index = pNode->indices.find(pattern[pos]);
+		if (index == std::string::npos)
+		{
+			Node* pChild = new Node;
+			pChild->prefix.assign(pattern, pos, end - pos);
+			pNode->indices += pattern[pos];
+			pNode->children.push_back(pChild);
+			return pChild;
+		}
+
+		Node* pChild = pNode->children[index];
+		std::size_t length = 0;
+		std::size_t maxLength = pChild->prefix.size() < end - pos ? pChild->prefix.size() : end - pos;
+		while (length < maxLength && pChild->prefix[length] == pattern[pos + length]) ++length;
+		if (length < pChild->prefix.size())
+		{
+			// split the edge at the end of the common prefix
+			Node* pSplit = new Node;
+			pSplit->prefix.assign(pChild->prefix, 0, length);
+			pChild->prefix.erase(0, length);
+			pSplit->indices += pChild->prefix[0];
+			pSplit->children.push_back(pChild);
+			pNode->children[index] = pSplit;
+			pChild = pSplit;
+		}
+		pNode = pChild;
+		pos += length;
+	}
+	return pNode;
+}
+
+
+const HTTPRouter::Node* HTTPRouter::find(const Node* pNode, const std::string& uri, std::size_t pos, std::size_t end, HTTPRouteMatch& match)
+{
+	if (pos == end && !pNode->routes.empty()) return pNode;
+
+	if (pos < end)
+	{
+		std::string::size_type index = pNode->indices.find(uri[pos]);
+		if (index != std::string::npos)
+		{
+			const Node* pChild = pNode->children[index];
+			std::size_t length = pChild->prefix.size();
+			if (length <= end - pos && uri.compare(pos, length, pChild->prefix) == 0)
+			{
+				const Node* pResult = find(pChild, uri, pos + length, end, match);
+				if (pResult) return pResult;
+			}
+		}
+		if (pNode->pParameter && uri[pos] != '/')
+		{
+			std::size_t next = pos;
+			while (next < end && uri[next] != '/') ++next;
+			HTTPRouteMatch::Parameter& param = match._parameters[match._count++];
+			param.pName  = &pNode->pParameter->name;
+			param.offset = pos;
+			param.length = next - pos;
+			const Node* pResult = find(pNode->pParameter, uri, next, end, match);
+			if (pResult) return pResult;
+			--match._count;
+		}
+	}
+	if (pNode->pCatchAll)
+	{
+		HTTPRouteMatch::Parameter& param = match._parameters[match._count++];
+		param.pName  = &pNode->pCatchAll->name;
+		param.offset = pos;
+		param.length = end - pos;
+		return pNode->pCatchAll;
+	}
+	return 0;
+}
+
+
+} } // namespace Poco::Net
@@ -18,6 +18,7 @@
 #include "Poco/Net/HTTPServerSession.h"
 #include "Poco/Net/HTTPServerRequestImpl.h"
 #include "Poco/Net/HTTPServerResponseImpl.h"
+#include "Poco/Net/HTTP2ServerConnection.h"
 #include "Poco/Net/HTTPRequestHandler.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
 #include "Poco/Net/NetException.h"
@@ -35,6 +36,20 @@ HTTPServerConnection::HTTPServerConnection(const StreamSocket& socket, HTTPServe
 	TCPServerConnection(socket),
 	_pParams(pParams),
 	_pFactory(pFactory),
+	_threadPool(Poco::ThreadPool::defaultPool()),
+	_stopped(false)
+{
+	poco_check_ptr (pFactory);
+	
+	_pFactory->serverStopped += Poco::delegate(this, &HTTPServerConnection::onServerStopped);
+}
+
+
+HTTPServerConnection::HTTPServerConnection(const StreamSocket& socket, HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory, Poco::ThreadPool& threadPool):
+	TCPServerConnection(socket),
+	_pParams(pParams),
+	_pFactory(pFactory),
+	_threadPool(threadPool),
 	_stopped(false)
 {
 	poco_check_ptr (pFactory);
@@ -60,6 +75,7 @@ void HTTPServerConnection::run()
 {
 	std::string server = _pParams->getSoftwareVersion();
 	HTTPServerSession session(socket(), _pParams);
+	std::auto_ptr<HTTP2ServerConnection> pHTTP2;
 	while (!_stopped && session.hasMoreRequests())
 	{
 		try
@@ -69,7 +85,31 @@ void HTTPServerConnection::run()
 			{
 				HTTPServerResponseImpl response(session);
 				HTTPServerRequestImpl request(response, session, _pParams);
+				session.setDeferredOutput(false);
+
+				if (_pParams->getHTTP2Enabled())
+				{
+					if (HTTP2ServerConnection::isPreface(request))
+					{
+						pHTTP2.reset(new HTTP2ServerConnection(session, _pParams, _pFactory, _threadPool));
+						break;
+					}
+					else if (HTTP2ServerConnection::isUpgrade(request) && !session.socket().secure())
+					{
+						pHTTP2.reset(new HTTP2ServerConnection(session, _pParams, _pFactory, _threadPool));
+						pHTTP2->upgrade(request, response);
+						break;
+					}
+				}
 			
+				// While the next request has already been received, the response
+				// is held back, so that the responses to pipelined requests are
+				// sent together. The held-back output is sent when the buffer
+				// becomes full, or here, once no further request is waiting.
+				bool pipelined = request.getKeepAlive() && session.hasBufferedRequest();
+				session.setDeferredOutput(pipelined);
+				if (!pipelined) session.flush();
+
 				Poco::Timestamp now;
 				response.setDate(now);
 				response.setVersion(request.getVersion());
@@ -78,14 +118,20 @@ void HTTPServerConnection::run()
 					response.set("Server", server);
 				try
 				{
-					std::auto_ptr<HTTPRequestHandler> pHandler(_pFactory->createRequestHandler(request));
+					HTTPRequestHandlerFactory::ScopedHandler pHandler(*_pFactory, request);
 					if (pHandler.get())
 					{
 						if (request.expectContinue())
+						{
+							session.setDeferredOutput(false);
 							response.sendContinue();
+						}
 					
 						pHandler->handleRequest(request, response);
 						session.setKeepAlive(_pParams->getKeepAlive() && response.getKeepAlive() && session.canKeepAlive());
+						// The rest of the response, written when the response is
+						// destroyed, is held back as well if another request is waiting.
+						session.setDeferredOutput(session.getKeepAlive() && session.hasBufferedRequest());
 					}
 					else sendErrorResponse(session, HTTPResponse::HTTP_NOT_IMPLEMENTED);
 				}
@@ -122,6 +168,10 @@ void HTTPServerConnection::run()
 			else throw;
 		}
 	}
+	if (pHTTP2.get() && !_stopped)
+	{
+		pHTTP2->serve();
+	}
 }
 
 
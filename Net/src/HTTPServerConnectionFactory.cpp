@@ -25,7 +25,17 @@ namespace Net {
 
 HTTPServerConnectionFactory::HTTPServerConnectionFactory(HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory):
 	_pParams(pParams),
-	_pFactory(pFactory)
+	_pFactory(pFactory),
+	_threadPool(Poco::ThreadPool::defaultPool())
+{
+	poco_check_ptr (pFactory);
+}
+
+
+HTTPServerConnectionFactory::HTTPServerConnectionFactory(HTTPServerParams::Ptr pParams, HTTPRequestHandlerFactory::Ptr pFactory, Poco::ThreadPool& threadPool):
+	_pParams(pParams),
+	_pFactory(pFactory),
+	_threadPool(threadPool)
 {
 	poco_check_ptr (pFactory);
 }
@@ -38,7 +48,7 @@ HTTPServerConnectionFactory::~HTTPServerConnectionFactory()
 
 TCPServerConnection* HTTPServerConnectionFactory::createConnection(const StreamSocket& socket)
 {
-	return new HTTPServerConnection(socket, _pParams, _pFactory);
+	return new HTTPServerConnection(socket, _pParams, _pFactory, _threadPool);
 }
 
 
@@ -25,8 +25,20 @@ HTTPServerParams::HTTPServerParams():
 	_timeout(60000000),
 	_keepAlive(true),
 	_maxKeepAliveRequests(0),
-	_keepAliveTimeout(15000000)
+	_keepAliveTimeout(15000000),
+	_http2Enabled(false),
+	_maxConcurrentStreams(100),
+	_compressionEnabled(false),
+	_compressionLevel(6),
+	_fileCompressionLevel(9),
+	_minCompressionSize(1024),
+	_pCompressionCache(new HTTPCompressionCache)
 {
+	_compressedMediaTypes.push_back("text/*");
+	_compressedMediaTypes.push_back("application/json");
+	_compressedMediaTypes.push_back("application/javascript");
+	_compressedMediaTypes.push_back("application/xml");
+	_compressedMediaTypes.push_back("image/svg+xml");
 }
 
 
@@ -70,6 +82,58 @@ void HTTPServerParams::setMaxKeepAliveRequests(int maxKeepAliveRequests)
 	poco_assert (maxKeepAliveRequests >= 0);
 	_maxKeepAliveRequests = maxKeepAliveRequests;
 }
+
+
+void HTTPServerParams::setHTTP2Enabled(bool enabled)
+{
+	_http2Enabled = enabled;
+}
+
+
+void HTTPServerParams::setMaxConcurrentStreams(int maxConcurrentStreams)
+{
+	poco_assert (maxConcurrentStreams > 0);
+	_maxConcurrentStreams = maxConcurrentStreams;
+}
+
+
+void HTTPServerParams::setCompressionEnabled(bool enabled)
+{
+	_compressionEnabled = enabled;
+}
+
+
+void HTTPServerParams::setCompressionLevel(int level)
+{
+	poco_assert (level >= 1 && level <= 9);
+	_compressionLevel = level;
+}
+
+
+void HTTPServerParams::setFileCompressionLevel(int level)
+{
+	poco_assert (level >= 1 && level <= 9);
+	_fileCompressionLevel = level;
+}
+
+
+void HTTPServerParams::setMinCompressionSize(int size)
+{
+	poco_assert (size >= 0);
+	_minCompressionSize = size;
+}
+
+
+void HTTPServerParams::setCompressedMediaTypes(const std::vector<std::string>& mediaTypes)
+{
+	_compressedMediaTypes = mediaTypes;
+}
+
+
+void HTTPServerParams::setCompressionCache(HTTPCompressionCache::Ptr pCache)
+{
+	_pCompressionCache = pCache;
+}
 	
 
 } } // namespace Poco::Net
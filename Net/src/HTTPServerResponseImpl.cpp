@@ -21,6 +21,8 @@
 #include "Poco/Net/HTTPStream.h"
 #include "Poco/Net/HTTPFixedLengthStream.h"
 #include "Poco/Net/HTTPChunkedStream.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPCompression.h"
 #include "Poco/File.h"
 #include "Poco/Timestamp.h"
 #include "Poco/NumberFormatter.h"
@@ -30,6 +32,7 @@
 #include "Poco/FileStream.h"
 #include "Poco/DateTimeFormatter.h"
 #include "Poco/DateTimeFormat.h"
+#include "Poco/DeflatingStream.h"
 
 
 using Poco::File;
@@ -48,13 +51,15 @@ namespace Net {
 HTTPServerResponseImpl::HTTPServerResponseImpl(HTTPServerSession& session):
 	_session(session),
 	_pRequest(0),
-	_pStream(0)
+	_pStream(0),
+	_pDeflater(0)
 {
 }
 
 
 HTTPServerResponseImpl::~HTTPServerResponseImpl()
 {
+	delete _pDeflater;
 	delete _pStream;
 }
 
@@ -70,6 +75,25 @@ std::ostream& HTTPServerResponseImpl::send()
 {
 	poco_assert (!_pStream);
 
+#if defined(POCO_HAVE_INT64)
+	std::string encoding = contentEncoding(hasContentLength() ? getContentLength64() : -1);
+#else
+	std::string encoding = contentEncoding(hasContentLength() ? getContentLength() : -1);
+#endif
+	if (!encoding.empty() && _pRequest->getVersion() == HTTPMessage::HTTP_1_1)
+	{
+		// The length of the compressed body is not known in advance.
+		setContentEncoding(encoding);
+		erase(HTTPMessage::CONTENT_LENGTH);
+		setChunkedTransferEncoding(true);
+		if (_pRequest->getMethod() != HTTPRequest::HTTP_HEAD)
+		{
+			writeHeader();
+			_pStream = new HTTPChunkedOutputStream(_session);
+			_pDeflater = new Poco::DeflatingOutputStream(*_pStream, HTTPCompression::streamType(encoding), _pRequest->serverParams().getCompressionLevel());
+			return *_pDeflater;
+		}
+	}
 	if ((_pRequest && _pRequest->getMethod() == HTTPRequest::HTTP_HEAD) ||
 		getStatus() < 200 ||
 		getStatus() == HTTPResponse::HTTP_NO_CONTENT ||
@@ -82,8 +106,7 @@ std::ostream& HTTPServerResponseImpl::send()
 	}
 	else if (getChunkedTransferEncoding())
 	{
-		HTTPHeaderOutputStream hs(_session);
-		write(hs);
+		writeHeader();
 		_pStream = new HTTPChunkedOutputStream(_session);
 	}
 	else if (hasContentLength())
@@ -123,6 +146,36 @@ void HTTPServerResponseImpl::sendFile(const std::string& path, const std::string
 	setContentType(mediaType);
 	setChunkedTransferEncoding(false);
 
+	std::string encoding = contentEncoding(length);
+	if (!encoding.empty())
+	{
+		const HTTPServerParams& params = _pRequest->serverParams();
+		HTTPCompressionCache::Ptr pCache = params.getCompressionCache();
+		HTTPCompressionCache::DataPtr pData;
+		if (pCache)
+		{
+			pData = pCache->get(path, dateTime, length, encoding, params.getFileCompressionLevel());
+		}
+		else if (length <= HTTPCompressionCache::DEFAULT_MAX_FILE_SIZE)
+		{
+			Poco::FileInputStream istr(path);
+			if (!istr.good()) throw OpenFileException(path);
+			pData = new std::string;
+			HTTPCompression::compress(istr, encoding, params.getFileCompressionLevel(), *pData);
+		}
+		if (pData)
+		{
+			sendCompressed(*pData, encoding);
+		}
+		else
+		{
+			Poco::FileInputStream istr(path);
+			if (!istr.good()) throw OpenFileException(path);
+			StreamCopier::copyStream(istr, send());
+		}
+		return;
+	}
+
 	Poco::FileInputStream istr(path);
 	if (istr.good())
 	{
@@ -143,6 +196,15 @@ void HTTPServerResponseImpl::sendBuffer(const void* pBuffer, std::size_t length)
 
 	setContentLength(static_cast<int>(length));
 	setChunkedTransferEncoding(false);
+
+	std::string encoding = contentEncoding(static_cast<Poco::Int64>(length));
+	if (!encoding.empty())
+	{
+		std::string data;
+		HTTPCompression::compress(static_cast<const char*>(pBuffer), length, encoding, _pRequest->serverParams().getCompressionLevel(), data);
+		sendCompressed(data, encoding);
+		return;
+	}
 	
 	_pStream = new HTTPHeaderOutputStream(_session);
 	write(*_pStream);
@@ -180,4 +242,54 @@ void HTTPServerResponseImpl::requireAuthentication(const std::string& realm)
 }
 
 
+std::string HTTPServerResponseImpl::contentEncoding(Poco::Int64 length)
+{
+	if (_pRequest)
+		return HTTPCompression::encodingFor(*_pRequest, *this, length);
+	else
+		return std::string();
+}
+
+
+void HTTPServerResponseImpl::writeHeader()
+{
+	bool deferred = _session.getDeferredOutput();
+	_session.setDeferredOutput(true);
+	{
+		HTTPHeaderOutputStream hs(_session);
+		write(hs);
+	}
+	_session.setDeferredOutput(deferred);
+}
+
+
+void HTTPServerResponseImpl::sendCompressed(const std::string& data, const std::string& encoding)
+{
+	setContentEncoding(encoding);
+	setContentLength(static_cast<int>(data.size()));
+
+	_pStream = new HTTPHeaderOutputStream(_session);
+	write(*_pStream);
+	if (_pRequest->getMethod() != HTTPRequest::HTTP_HEAD)
+	{
+		_pStream->write(data.data(), static_cast<std::streamsize>(data.size()));
+	}
+}
+
+
+void HTTPServerResponseImpl::setContentEncoding(const std::string& encoding)
+{
+	set(HTTPCompression::CONTENT_ENCODING, encoding);
+
+	// The compressed body is not byte-for-byte the same as the
+	// uncompressed one, so a strong entity tag must be weakened
+	// (RFC 7232, section 2.1).
+	const std::string& etag = get(HTTPCompression::ETAG, HTTPMessage::EMPTY);
+	if (!etag.empty() && etag.compare(0, 2, "W/") != 0)
+	{
+		set(HTTPCompression::ETAG, "W/" + etag);
+	}
+}
+
+
 } } // namespace Poco::Net
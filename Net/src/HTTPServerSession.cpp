@@ -51,9 +51,15 @@ bool HTTPServerSession::hasMoreRequests()
 	{
 		if (_maxKeepAliveRequests > 0) 
 			--_maxKeepAliveRequests;
-		return buffered() > 0 || socket().poll(_keepAliveTimeout, Socket::SELECT_READ);
+		if (buffered() > 0) return true;
+		flush();
+		return socket().poll(_keepAliveTimeout, Socket::SELECT_READ);
+	}
+	else
+	{
+		flush();
+		return false;
 	}
-	else return false;
 }
 
 
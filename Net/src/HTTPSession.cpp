@@ -31,6 +31,9 @@ HTTPSession::HTTPSession():
 	_pBuffer(0),
 	_pCurrent(0),
 	_pEnd(0),
+	_pOutput(0),
+	_outputLength(0),
+	_deferredOutput(false),
 	_keepAlive(false),
 	_timeout(HTTP_DEFAULT_TIMEOUT),
 	_pException(0)
@@ -43,6 +46,9 @@ HTTPSession::HTTPSession(const StreamSocket& socket):
 	_pBuffer(0),
 	_pCurrent(0),
 	_pEnd(0),
+	_pOutput(0),
+	_outputLength(0),
+	_deferredOutput(false),
 	_keepAlive(false),
 	_timeout(HTTP_DEFAULT_TIMEOUT),
 	_pException(0)
@@ -55,6 +61,9 @@ HTTPSession::HTTPSession(const StreamSocket& socket, bool keepAlive):
 	_pBuffer(0),
 	_pCurrent(0),
 	_pEnd(0),
+	_pOutput(0),
+	_outputLength(0),
+	_deferredOutput(false),
 	_keepAlive(keepAlive),
 	_timeout(HTTP_DEFAULT_TIMEOUT),
 	_pException(0)
@@ -73,6 +82,21 @@ HTTPSession::~HTTPSession()
 		poco_unexpected();
 	}
 	try
+	{
+		if (_outputLength > 0) flush();
+	}
+	catch (...)
+	{
+	}
+	try
+	{
+		if (_pOutput) HTTPBufferAllocator::deallocate(_pOutput, HTTPBufferAllocator::BUFFER_SIZE);
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+	try
 	{
 		close();
 	}
@@ -137,6 +161,19 @@ int HTTPSession::write(const char* buffer, std::streamsize length)
 {
 	try
 	{
+		if (_deferredOutput || _outputLength > 0)
+		{
+			if (_outputLength + length > HTTPBufferAllocator::BUFFER_SIZE)
+				flush();
+			if (_outputLength + length <= HTTPBufferAllocator::BUFFER_SIZE)
+			{
+				if (!_pOutput) _pOutput = HTTPBufferAllocator::allocate(HTTPBufferAllocator::BUFFER_SIZE);
+				std::memcpy(_pOutput + _outputLength, buffer, static_cast<std::size_t>(length));
+				_outputLength += static_cast<int>(length);
+				if (!_deferredOutput) flush();
+				return static_cast<int>(length);
+			}
+		}
 		return _socket.sendBytes(buffer, (int) length);
 	}
 	catch (Poco::Exception& exc)
@@ -151,6 +188,7 @@ int HTTPSession::receive(char* buffer, int length)
 {
 	try
 	{
+		if (_outputLength > 0) flush();
 		return _socket.receiveBytes(buffer, length);
 	}
 	catch (Poco::Exception& exc)
@@ -181,6 +219,7 @@ bool HTTPSession::connected() const
 
 void HTTPSession::connect(const SocketAddress& address)
 {
+	_outputLength = 0;
 	_socket.connect(address, _timeout);
 	_socket.setReceiveTimeout(_timeout);
 	_socket.setNoDelay(true);
@@ -199,10 +238,39 @@ void HTTPSession::abort()
 
 void HTTPSession::close()
 {
+	_outputLength = 0;
 	_socket.close();
 }
 
 
+void HTTPSession::setDeferredOutput(bool deferred)
+{
+	_deferredOutput = deferred;
+}
+
+
+void HTTPSession::flush()
+{
+	try
+	{
+		int sent = 0;
+		while (sent < _outputLength)
+		{
+			int n = _socket.sendBytes(_pOutput + sent, _outputLength - sent);
+			if (n <= 0) throw NetException("Cannot send deferred output");
+			sent += n;
+		}
+		_outputLength = 0;
+	}
+	catch (Poco::Exception& exc)
+	{
+		_outputLength = 0;
+		setException(exc);
+		throw;
+	}
+}
+
+
 void HTTPSession::setException(const Poco::Exception& exc)
 {
 	delete _pException;
@@ -219,6 +287,7 @@ void HTTPSession::clearException()
 
 StreamSocket HTTPSession::detachSocket()
 {
+	if (_outputLength > 0) flush();
 	StreamSocket oldSocket(_socket);
 	StreamSocket newSocket;
 	_socket = newSocket;
@@ -18,6 +18,7 @@
 #include "Poco/Net/NetException.h"
 #include "Poco/String.h"
 #include "Poco/Ascii.h"
+#include <cstring>
 
 
 namespace Poco {
@@ -60,48 +61,75 @@ void MessageHeader::write(std::ostream& ostr) const
 }
 
 
+namespace
+{
+	std::streamsize readLine(std::istream& istr, char* line, std::streamsize size)
+		/// Extracts the next line, and stores it without the
+		/// terminating CRLF or LF in line. Returns the length
+		/// of the line, or -1 if the line does not fit.
+		///
+		/// istream::getline() is used because the standard library
+		/// implements it by searching the stream buffer for the
+		/// delimiter, instead of copying one character at a time.
+	{
+		istr.getline(line, size);
+		std::streamsize n = istr.gcount();
+		if (istr.fail())
+		{
+			if (!istr.eof()) return -1;
+		}
+		else if (!istr.eof()) --n; // '\n'
+		if (n > 0 && line[n - 1] == '\r') --n;
+		return n;
+	}
+}
+
+
 void MessageHeader::read(std::istream& istr)
 {
 	static const int eof = std::char_traits<char>::eof();
 	std::streambuf& buf = *istr.rdbuf();
 
+	// the whitespace before a value or a folded line is skipped before
+	// the line is read, so that only the value counts against the limit
+	char line[MAX_VALUE_LENGTH + 2];
 	std::string name;
 	std::string value;
 	name.reserve(32);
-	value.reserve(64);
-	int ch = buf.sbumpc();
+	int ch = buf.sgetc();
 	int fields = 0;
 	while (ch != eof && ch != '\r' && ch != '\n')
 	{
 		if (_fieldLimit > 0 && fields == _fieldLimit)
 			throw MessageException("Too many header fields");
 		name.clear();
-		value.clear();
-		while (ch != eof && ch != ':' && ch != '\n' && name.length() < MAX_NAME_LENGTH) { name += ch; ch = buf.sbumpc(); }
-		if (ch == '\n') { ch = buf.sbumpc(); continue; } // ignore invalid header lines
+		while (ch != eof && ch != ':' && ch != '\n' && name.length() < MAX_NAME_LENGTH) { name += ch; ch = buf.snextc(); }
+		if (ch == '\n') { ch = buf.snextc(); continue; } // ignore invalid header lines
+		if (ch == eof) continue;
 		if (ch != ':') throw MessageException("Field name too long/no colon found");
-		if (ch != eof) ch = buf.sbumpc(); // ':'
-		while (ch != eof && Poco::Ascii::isSpace(ch) && ch != '\r' && ch != '\n') ch = buf.sbumpc();
-		while (ch != eof && ch != '\r' && ch != '\n' && value.length() < MAX_VALUE_LENGTH) { value += ch; ch = buf.sbumpc(); }
-		if (ch == '\r') ch = buf.sbumpc();
-		if (ch == '\n')
-			ch = buf.sbumpc();
-		else if (ch != eof)
+		ch = buf.snextc(); // ':'
+		while (ch != eof && Poco::Ascii::isSpace(ch) && ch != '\r' && ch != '\n') ch = buf.snextc();
+		std::streamsize n = readLine(istr, line, sizeof(line));
+		if (n < 0 || n > MAX_VALUE_LENGTH || std::memchr(line, '\r', n))
 			throw MessageException("Field value too long/no CRLF found");
+		value.assign(line, n);
+		ch = buf.sgetc();
 		while (ch == ' ' || ch == '\t') // folding
 		{
-			while (ch != eof && ch != '\r' && ch != '\n' && value.length() < MAX_VALUE_LENGTH) { value += ch; ch = buf.sbumpc(); }
-			if (ch == '\r') ch = buf.sbumpc();
-			if (ch == '\n')
-				ch = buf.sbumpc();
-			else if (ch != eof)
+			char fold = static_cast<char>(ch);
+			ch = buf.snextc();
+			while (ch == ' ' || ch == '\t') ch = buf.snextc();
+			n = readLine(istr, line, sizeof(line));
+			if (n < 0 || value.size() + n + 1 > MAX_VALUE_LENGTH || std::memchr(line, '\r', n))
 				throw MessageException("Folded field value too long/no CRLF found");
+			value += fold;
+			value.append(line, n);
+			ch = buf.sgetc();
 		}
 		Poco::trimRightInPlace(value);
 		add(name, value);
 		++fields;
 	}
-	istr.putback(ch);
 }
 
 
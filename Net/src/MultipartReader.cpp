@@ -18,6 +18,8 @@
 #include "Poco/Net/MessageHeader.h"
 #include "Poco/Net/NetException.h"
 #include "Poco/Ascii.h"
+#include <algorithm>
+#include <cstring>
 
 
 using Poco::BufferedStreamBuf;
@@ -27,18 +29,108 @@ namespace Poco {
 namespace Net {
 
 
+//
+// MultipartSourceBuf
+//
+
+
+MultipartSourceBuf::MultipartSourceBuf(std::istream& istr):
+	_istr(istr),
+	_buffer(BUFFER_SIZE),
+	_eof(false)
+{
+	setg(_buffer.begin(), _buffer.begin(), _buffer.begin());
+}
+
+
+MultipartSourceBuf::~MultipartSourceBuf()
+{
+}
+
+
+bool MultipartSourceBuf::fill(std::size_t length)
+{
+	poco_assert_dbg (length <= BUFFER_SIZE);
+
+	std::size_t n = available();
+	if (n >= length) return true;
+	if (_eof) return false;
+
+	if (gptr() != _buffer.begin())
+	{
+		std::memmove(_buffer.begin(), gptr(), n);
+		setg(_buffer.begin(), _buffer.begin(), _buffer.begin() + n);
+	}
+	std::streambuf& buf = *_istr.rdbuf();
+	while (n < BUFFER_SIZE)
+	{
+		// read what is needed, and what can be read without blocking
+		std::streamsize space = static_cast<std::streamsize>(BUFFER_SIZE - n);
+		std::streamsize want  = n < length ? static_cast<std::streamsize>(length - n) : 0;
+		want = std::max(want, buf.in_avail());
+		if (want <= 0) break;
+		std::streamsize rc = buf.sgetn(_buffer.begin() + n, std::min(want, space));
+		if (rc <= 0)
+		{
+			_eof = true;
+			break;
+		}
+		n += static_cast<std::size_t>(rc);
+		setg(_buffer.begin(), _buffer.begin(), _buffer.begin() + n);
+	}
+	return n >= length;
+}
+
+
+const char* MultipartSourceBuf::data() const
+{
+	return gptr();
+}
+
+
+std::size_t MultipartSourceBuf::available() const
+{
+	return static_cast<std::size_t>(egptr() - gptr());
+}
+
+
+void MultipartSourceBuf::consume(std::size_t length)
+{
+	poco_assert_dbg (length <= available());
+
+	setg(eback(), gptr() + length, egptr());
+}
+
+
+MultipartSourceBuf::int_type MultipartSourceBuf::underflow()
+{
+	if (fill(1))
+		return traits_type::to_int_type(*gptr());
+	else
+		return traits_type::eof();
+}
+
+
 //
 // MultipartStreamBuf
 //
 
 
-MultipartStreamBuf::MultipartStreamBuf(std::istream& istr, const std::string& boundary):
+MultipartStreamBuf::MultipartStreamBuf(MultipartSourceBuf& source, const std::string& boundary):
 	BufferedStreamBuf(STREAM_BUFFER_SIZE, std::ios::in),
-	_istr(istr),
-	_boundary(boundary),
+	_source(source),
+	_delimiter("\n--"),
 	_lastPart(false)
 {
 	poco_assert (!boundary.empty() && boundary.length() < STREAM_BUFFER_SIZE - 6);
+
+	_delimiter += boundary;
+	const std::size_t m = _delimiter.length();
+	std::fill(_skip, _skip + 256, m);
+	for (std::size_t i = 0; i < m - 1; ++i)
+	{
+		_skip[static_cast<unsigned char>(_delimiter[i])] = m - 1 - i;
+	}
 }
 
 
@@ -49,65 +141,78 @@ MultipartStreamBuf::~MultipartStreamBuf()
 
 int MultipartStreamBuf::readFromDevice(char* buffer, std::streamsize length)
 {
-	poco_assert_dbg (length >= _boundary.length() + 6);
-
-	static const int eof = std::char_traits<char>::eof();
-	std::streambuf& buf = *_istr.rdbuf();
-
-	int n  = 0;
-	int ch = buf.sbumpc();
-	if (ch == eof) return -1;
-	*buffer++ = (char) ch; ++n;
-	if (ch == '\n' || (ch == '\r' && buf.sgetc() == '\n'))
+	// A part ends with a line break, followed by "--", the boundary,
+	// and either another line break or "--" for the last part.
+	// Only what is needed to tell whether the buffered data ends
+	// with a delimiter is waited for; the rest of the buffer is
+	// searched as it is, so that a part that has been received
+	// completely can be read without waiting for the next one.
+	const std::size_t m = _delimiter.length();
+	const std::size_t len = static_cast<std::size_t>(length);
+	bool more = _source.fill(m + 2);
+	std::size_t available = _source.available();
+	if (available == 0) return -1;
+
+	const char* data = _source.data();
+	std::size_t window = std::min(available, len + m + 2);
+	std::size_t pos = find(data, window);
+	std::size_t n;
+	if (pos == std::string::npos)
 	{
-		if (ch == '\r')
-		{
-			ch = buf.sbumpc(); // '\n'
-			*buffer++ = (char) ch; ++n;
-		}
-		ch = buf.sgetc();
-		if (ch == '\r' || ch == '\n') return n;
-		*buffer++ = (char) buf.sbumpc(); ++n;
-		if (ch == '-' && buf.sgetc() == '-')
+		// keep what may be the beginning of a delimiter
+		n = more ? window - m : window;
+	}
+	else
+	{
+		n = (pos > 0 && data[pos - 1] == '\r') ? pos - 1 : pos;
+		if (n == 0)
 		{
-			ch = buf.sbumpc(); // '-'
-			*buffer++ = (char) ch; ++n;
-			std::string::const_iterator it  = _boundary.begin();
-			std::string::const_iterator end = _boundary.end();
-			ch = buf.sbumpc();
-			*buffer++ = (char) ch; ++n;
-			while (it != end && ch == *it)
+			std::size_t tail = pos + m;
+			_source.fill(tail + 2);
+			data = _source.data();
+			available = _source.available();
+			if (tail < available && data[tail] == '\n')
 			{
-				++it;
-				ch = buf.sbumpc();
-				*buffer++ = (char) ch; ++n;
+				_source.consume(tail + 1);
+				return 0;
 			}
-			if (it == end)
+			else if (tail + 1 < available && data[tail] == '\r' && data[tail + 1] == '\n')
 			{
-				if (ch == '\n' || (ch == '\r' && buf.sgetc() == '\n'))
-				{
-					if (ch == '\r')
-					{
-						ch = buf.sbumpc(); // '\n'
-					}
-					return 0;					
-				}
-				else if (ch == '-' && buf.sgetc() == '-')
-				{
-					ch = buf.sbumpc(); // '-'
-					_lastPart = true;
-					return 0;
-				}
+				_source.consume(tail + 2);
+				return 0;
 			}
+			else if (tail + 1 < available && data[tail] == '-' && data[tail + 1] == '-')
+			{
+				_source.consume(tail + 2);
+				_lastPart = true;
+				return 0;
+			}
+			// not a boundary line, so the line break is part of the data
+			n = pos + 1;
 		}
 	}
-	ch = buf.sgetc();
-	while (ch != eof && ch != '\r' && ch != '\n' && n < length)
+	if (n > len) n = len;
+	std::memcpy(buffer, data, n);
+	_source.consume(n);
+	return static_cast<int>(n);
+}
+
+
+std::size_t MultipartStreamBuf::find(const char* data, std::size_t length) const
+{
+	// Boyer-Moore-Horspool search for the delimiter
+	const std::size_t m = _delimiter.length();
+	const char* delimiter = _delimiter.data();
+	const char last = delimiter[m - 1];
+	std::size_t pos = 0;
+	while (pos + m <= length)
 	{
-		*buffer++ = (char) buf.sbumpc(); ++n;
-		ch = buf.sgetc();
+		char ch = data[pos + m - 1];
+		if (ch == last && std::memcmp(data + pos, delimiter, m - 1) == 0)
+			return pos;
+		pos += _skip[static_cast<unsigned char>(ch)];
 	}
-	return n;
+	return std::string::npos;
 }
 
 
@@ -122,8 +227,8 @@ bool MultipartStreamBuf::lastPart() const
 //
 
 
-MultipartIOS::MultipartIOS(std::istream& istr, const std::string& boundary):
-	_buf(istr, boundary)
+MultipartIOS::MultipartIOS(MultipartSourceBuf& source, const std::string& boundary):
+	_buf(source, boundary)
 {
 	poco_ios_init(&_buf);
 }
@@ -158,8 +263,8 @@ bool MultipartIOS::lastPart() const
 //
 
 
-MultipartInputStream::MultipartInputStream(std::istream& istr, const std::string& boundary):
-	MultipartIOS(istr, boundary),
+MultipartInputStream::MultipartInputStream(MultipartSourceBuf& source, const std::string& boundary):
+	MultipartIOS(source, boundary),
 	std::istream(&_buf)
 {
 }
@@ -176,14 +281,16 @@ MultipartInputStream::~MultipartInputStream()
 
 
 MultipartReader::MultipartReader(std::istream& istr):
-	_istr(istr),
+	_sourceBuf(istr),
+	_istr(&_sourceBuf),
 	_pMPI(0)
 {
 }
 
 
 MultipartReader::MultipartReader(std::istream& istr, const std::string& boundary):
-	_istr(istr),
+	_sourceBuf(istr),
+	_istr(&_sourceBuf),
 	_boundary(boundary),
 	_pMPI(0)
 {
@@ -211,7 +318,7 @@ void MultipartReader::nextPart(MessageHeader& messageHeader)
 	}
 	parseHeader(messageHeader);
 	delete _pMPI;
-	_pMPI = new MultipartInputStream(_istr, _boundary);
+	_pMPI = new MultipartInputStream(_sourceBuf, _boundary);
 }
 
 
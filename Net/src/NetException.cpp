@@ -49,6 +49,7 @@ POCO_IMPLEMENT_EXCEPTION(ICMPException, NetException, "ICMP Exception")
 POCO_IMPLEMENT_EXCEPTION(NTPException, NetException, "NTP Exception")
 POCO_IMPLEMENT_EXCEPTION(HTMLFormException, NetException, "HTML Form Exception")
 POCO_IMPLEMENT_EXCEPTION(WebSocketException, NetException, "WebSocket Exception")
+POCO_IMPLEMENT_EXCEPTION(HTTP2Exception, NetException, "HTTP/2 Exception")
 POCO_IMPLEMENT_EXCEPTION(UnsupportedFamilyException, NetException, "Unknown or unsupported socket family.")
 
 
@@ -0,0 +1,395 @@
+//
+// PollSet.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: Sockets
+// Module:  PollSet
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/PollSet.h"
+#include "Poco/Net/SocketImpl.h"
+#include "Poco/Mutex.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Exception.h"
+#include <vector>
+#include <string.h> // FD_SET needs memset on some platforms, so we can't use <cstring>
+#if defined(POCO_HAVE_FD_EPOLL)
+#include <sys/epoll.h>
+#elif defined(POCO_OS_FAMILY_UNIX)
+#include <poll.h>
+#endif
+
+
+namespace Poco {
+namespace Net {
+
+
+class PollSetImpl
+{
+public:
+	struct Entry
+	{
+		Entry(const Socket& s, int m):
+			socket(s),
+			mode(m)
+		{
+		}
+
+		Socket socket;
+		int    mode;
+	};
+
+	typedef std::map<SocketImpl*, Entry> EntryMap;
+
+	PollSetImpl()
+	{
+#if defined(POCO_HAVE_FD_EPOLL)
+		_epollfd = epoll_create(1);
+		if (_epollfd < 0) SocketImpl::error("Cannot create epoll instance");
+#endif
+	}
+
+	~PollSetImpl()
+	{
+#if defined(POCO_HAVE_FD_EPOLL)
+		::close(_epollfd);
+#endif
+	}
+
+	void add(const Socket& socket, int mode)
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		EntryMap::iterator it = _entries.find(socket.impl());
+		if (it == _entries.end())
+		{
+#if defined(POCO_HAVE_FD_EPOLL)
+			control(EPOLL_CTL_ADD, socket, mode);
+#endif
+			_entries.insert(EntryMap::value_type(socket.impl(), Entry(socket, mode)));
+		}
+		else
+		{
+#if defined(POCO_HAVE_FD_EPOLL)
+			control(EPOLL_CTL_MOD, socket, mode);
+#endif
+			it->second.mode = mode;
+		}
+	}
+
+	void update(const Socket& socket, int mode)
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		EntryMap::iterator it = _entries.find(socket.impl());
+		if (it == _entries.end()) throw Poco::NotFoundException("Socket not in PollSet");
+#if defined(POCO_HAVE_FD_EPOLL)
+		control(EPOLL_CTL_MOD, socket, mode);
+#endif
+		it->second.mode = mode;
+	}
+
+	void remove(const Socket& socket)
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		EntryMap::iterator it = _entries.find(socket.impl());
+		if (it != _entries.end())
+		{
+#if defined(POCO_HAVE_FD_EPOLL)
+			// a closed socket has already been removed by the kernel
+			if (socket.impl()->sockfd() != POCO_INVALID_SOCKET)
+			{
+				struct epoll_event ev;
+				memset(&ev, 0, sizeof(ev));
+				epoll_ctl(_epollfd, EPOLL_CTL_DEL, socket.impl()->sockfd(), &ev);
+			}
+#endif
+			_entries.erase(it);
+		}
+	}
+
+	bool has(const Socket& socket) const
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		return _entries.find(socket.impl()) != _entries.end();
+	}
+
+	std::size_t size() const
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		return _entries.size();
+	}
+
+	void clear()
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+#if defined(POCO_HAVE_FD_EPOLL)
+		for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it)
+		{
+			if (it->second.socket.impl()->sockfd() != POCO_INVALID_SOCKET)
+			{
+				struct epoll_event ev;
+				memset(&ev, 0, sizeof(ev));
+				epoll_ctl(_epollfd, EPOLL_CTL_DEL, it->second.socket.impl()->sockfd(), &ev);
+			}
+		}
+#endif
+		_entries.clear();
+	}
+
+#if defined(POCO_HAVE_FD_EPOLL)
+
+	int poll(const Poco::Timespan& timeout, PollSet::SocketModeMap& ready)
+	{
+		ready.clear();
+		std::size_t size;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			size = _entries.size();
+		}
+		if (size == 0) return 0;
+
+		_events.resize(size);
+		int rc = waitEvents(timeout, &_events[0], static_cast<int>(size));
+
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		for (int i = 0; i < rc; ++i)
+		{
+			// The socket may have been removed in the meantime.
+			EntryMap::iterator it = _entries.find(static_cast<SocketImpl*>(_events[i].data.ptr));
+			if (it != _entries.end())
+			{
+				int mode = 0;
+				if (_events[i].events & EPOLLIN)  mode |= PollSet::POLL_READ;
+				if (_events[i].events & EPOLLOUT) mode |= PollSet::POLL_WRITE;
+				if (_events[i].events & (EPOLLERR | EPOLLHUP)) mode |= PollSet::POLL_ERROR;
+				ready[it->second.socket] = mode;
+			}
+		}
+		return static_cast<int>(ready.size());
+	}
+
+#elif defined(POCO_OS_FAMILY_UNIX)
+
+	int poll(const Poco::Timespan& timeout, PollSet::SocketModeMap& ready)
+	{
+		ready.clear();
+		std::vector<Socket> sockets;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			if (_entries.empty()) return 0;
+
+			_pollfds.resize(_entries.size());
+			sockets.reserve(_entries.size());
+			std::size_t i = 0;
+			for (EntryMap::const_iterator it = _entries.begin(); it != _entries.end(); ++it, ++i)
+			{
+				_pollfds[i].fd      = it->second.socket.impl()->sockfd();
+				_pollfds[i].events  = 0;
+				_pollfds[i].revents = 0;
+				if (it->second.mode & PollSet::POLL_READ)  _pollfds[i].events |= POLLIN;
+				if (it->second.mode & PollSet::POLL_WRITE) _pollfds[i].events |= POLLOUT;
+				sockets.push_back(it->second.socket);
+			}
+		}
+
+		Poco::Timespan remainingTime(timeout);
+		int rc;
+		do
+		{
+			Poco::Timestamp start;
+			rc = ::poll(&_pollfds[0], _pollfds.size(), static_cast<int>(remainingTime.totalMilliseconds()));
+			if (rc < 0 && SocketImpl::lastError() == POCO_EINTR)
+			{
+				Poco::Timespan waited = start.elapsed();
+				if (waited < remainingTime)
+					remainingTime -= waited;
+				else
+					remainingTime = 0;
+			}
+		}
+		while (rc < 0 && SocketImpl::lastError() == POCO_EINTR);
+		if (rc < 0) SocketImpl::error();
+
+		for (std::size_t i = 0; i < _pollfds.size(); ++i)
+		{
+			int mode = 0;
+			if (_pollfds[i].revents & POLLIN)  mode |= PollSet::POLL_READ;
+			if (_pollfds[i].revents & POLLOUT) mode |= PollSet::POLL_WRITE;
+			if (_pollfds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) mode |= PollSet::POLL_ERROR;
+			if (mode) ready[sockets[i]] = mode;
+		}
+		return static_cast<int>(ready.size());
+	}
+
+#else
+
+	int poll(const Poco::Timespan& timeout, PollSet::SocketModeMap& ready)
+	{
+		ready.clear();
+		fd_set fdRead;
+		fd_set fdWrite;
+		fd_set fdExcept;
+		FD_ZERO(&fdRead);
+		FD_ZERO(&fdWrite);
+		FD_ZERO(&fdExcept);
+		int nfd = 0;
+		std::vector<Socket> sockets;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			if (_entries.empty()) return 0;
+
+			sockets.reserve(_entries.size());
+			for (EntryMap::const_iterator it = _entries.begin(); it != _entries.end(); ++it)
+			{
+				poco_socket_t fd = it->second.socket.impl()->sockfd();
+				if (fd != POCO_INVALID_SOCKET)
+				{
+					if (int(fd) > nfd) nfd = int(fd);
+					if (it->second.mode & PollSet::POLL_READ) FD_SET(fd, &fdRead);
+					if (it->second.mode & PollSet::POLL_WRITE) FD_SET(fd, &fdWrite);
+					FD_SET(fd, &fdExcept);
+					sockets.push_back(it->second.socket);
+				}
+			}
+		}
+
+		struct timeval tv;
+		tv.tv_sec  = (long) timeout.totalSeconds();
+		tv.tv_usec = (long) timeout.useconds();
+		int rc = ::select(nfd + 1, &fdRead, &fdWrite, &fdExcept, &tv);
+		if (rc < 0) SocketImpl::error();
+
+		for (std::vector<Socket>::const_iterator it = sockets.begin(); it != sockets.end(); ++it)
+		{
+			poco_socket_t fd = it->impl()->sockfd();
+			int mode = 0;
+			if (FD_ISSET(fd, &fdRead))   mode |= PollSet::POLL_READ;
+			if (FD_ISSET(fd, &fdWrite))  mode |= PollSet::POLL_WRITE;
+			if (FD_ISSET(fd, &fdExcept)) mode |= PollSet::POLL_ERROR;
+			if (mode) ready[*it] = mode;
+		}
+		return static_cast<int>(ready.size());
+	}
+
+#endif
+
+private:
+#if defined(POCO_HAVE_FD_EPOLL)
+	void control(int op, const Socket& socket, int mode)
+	{
+		struct epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		if (mode & PollSet::POLL_READ)  ev.events |= EPOLLIN;
+		if (mode & PollSet::POLL_WRITE) ev.events |= EPOLLOUT;
+		if (mode & PollSet::POLL_ERROR) ev.events |= EPOLLERR;
+		ev.data.ptr = socket.impl();
+		if (epoll_ctl(_epollfd, op, socket.impl()->sockfd(), &ev) < 0)
+			SocketImpl::error();
+	}
+
+	int waitEvents(const Poco::Timespan& timeout, struct epoll_event* events, int size)
+	{
+		Poco::Timespan remainingTime(timeout);
+		int rc;
+		do
+		{
+			Poco::Timestamp start;
+			rc = epoll_wait(_epollfd, events, size, static_cast<int>(remainingTime.totalMilliseconds()));
+			if (rc < 0 && SocketImpl::lastError() == POCO_EINTR)
+			{
+				Poco::Timespan waited = start.elapsed();
+				if (waited < remainingTime)
+					remainingTime -= waited;
+				else
+					remainingTime = 0;
+			}
+		}
+		while (rc < 0 && SocketImpl::lastError() == POCO_EINTR);
+		if (rc < 0) SocketImpl::error();
+		return rc;
+	}
+
+	int _epollfd;
+	std::vector<struct epoll_event> _events;
+#elif defined(POCO_OS_FAMILY_UNIX)
+	std::vector<struct pollfd> _pollfds;
+#endif
+	EntryMap _entries;
+	mutable Poco::FastMutex _mutex;
+};
+
+
+PollSet::PollSet():
+	_pImpl(new PollSetImpl)
+{
+}
+
+
+PollSet::~PollSet()
+{
+	delete _pImpl;
+}
+
+
+void PollSet::add(const Socket& socket, int mode)
+{
+	_pImpl->add(socket, mode);
+}
+
+
+void PollSet::update(const Socket& socket, int mode)
+{
+	_pImpl->update(socket, mode);
+}
+
+
+void PollSet::remove(const Socket& socket)
+{
+	_pImpl->remove(socket);
+}
+
+
+bool PollSet::has(const Socket& socket) const
+{
+	return _pImpl->has(socket);
+}
+
+
+bool PollSet::empty() const
+{
+	return _pImpl->size() == 0;
+}
+
+
+std::size_t PollSet::size() const
+{
+	return _pImpl->size();
+}
+
+
+void PollSet::clear()
+{
+	_pImpl->clear();
+}
+
+
+int PollSet::poll(const Poco::Timespan& timeout, SocketModeMap& ready)
+{
+	return _pImpl->poll(timeout, ready);
+}
+
+
+} } // namespace Poco::Net
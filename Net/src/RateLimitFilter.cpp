@@ -0,0 +1,90 @@
+//
+// RateLimitFilter.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: TCPServer
+// Module:  RateLimitFilter
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/RateLimitFilter.h"
+#include "Poco/Net/SocketAddress.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+RateLimitFilter::RateLimitFilter(std::size_t maxAddresses):
+	_addressRate(0),
+	_addressBurst(0),
+	_addressBuckets(static_cast<long>(maxAddresses))
+{
+}
+
+
+RateLimitFilter::~RateLimitFilter()
+{
+}
+
+
+void RateLimitFilter::setListenerRate(double rate, double burst)
+{
+	if (burst > 0)
+		_pListenerBucket = new TokenBucket(rate, burst);
+	else
+		_pListenerBucket = 0;
+}
+
+
+void RateLimitFilter::setAddressRate(double rate, double burst)
+{
+	if (burst > 0)
+	{
+		// fail early on invalid values
+		TokenBucket bucket(rate, burst);
+	}
+	_addressRate  = rate;
+	_addressBurst = burst;
+	_addressBuckets.clear();
+}
+
+
+bool RateLimitFilter::accept(const StreamSocket& socket)
+{
+	Poco::SharedPtr<TokenBucket> pBucket;
+	if (_addressBurst > 0)
+	{
+		IPAddress address = socket.peerAddress().host();
+		pBucket = _addressBuckets.get(address);
+		if (!pBucket)
+		{
+			pBucket = new TokenBucket(_addressRate, _addressBurst);
+			_addressBuckets.add(address, pBucket);
+		}
+		if (!pBucket->tryConsume())
+		{
+			++_rejectedByAddress;
+			return false;
+		}
+	}
+	if (_pListenerBucket && !_pListenerBucket->tryConsume())
+	{
+		// A connection rejected by the listener limit
+		// does not count against the address limit.
+		if (pBucket) pBucket->refund();
+		++_rejectedByListener;
+		return false;
+	}
+	return true;
+}
+
+
+} } // namespace Poco::Net
@@ -120,9 +120,13 @@ void TCPServer::run()
 			try
 			{
 				StreamSocket ss = _socket.acceptConnection();
-				// enabe nodelay per default: OSX really needs that
-				ss.setNoDelay(true);
-				_pDispatcher->enqueue(ss);
+				if (!_pConnectionFilter || _pConnectionFilter->accept(ss))
+				{
+					// enabe nodelay per default: OSX really needs that
+					ss.setNoDelay(true);
+					_pDispatcher->enqueue(ss);
+				}
+				else ++_filteredConnections;
 			}
 			catch (Poco::Exception& exc)
 			{
@@ -182,6 +186,20 @@ int TCPServer::refusedConnections() const
 }
 
 
+int TCPServer::limitedConnections() const
+{
+	return _pDispatcher->limitedConnections();
+}
+
+
+void TCPServer::setConnectionFilter(const TCPServerConnectionFilter::Ptr& pConnectionFilter)
+{
+	poco_assert (_stopped);
+
+	_pConnectionFilter = pConnectionFilter;
+}
+
+
 std::string TCPServer::threadName(const ServerSocket& socket)
 {
 #if _WIN32_WCE == 0x0800
@@ -0,0 +1,29 @@
+//
+// TCPServerConnectionFilter.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: TCPServer
+// Module:  TCPServerConnectionFilter
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/TCPServerConnectionFilter.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+TCPServerConnectionFilter::~TCPServerConnectionFilter()
+{
+}
+
+
+} } // namespace Poco::Net
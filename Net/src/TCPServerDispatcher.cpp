@@ -47,8 +47,14 @@ public:
 		return _socket;
 	}
 
+	const Poco::Clock& enqueued() const
+	{
+		return _enqueued;
+	}
+
 private:
 	StreamSocket _socket;
+	Poco::Clock  _enqueued;
 };
 
 
@@ -60,6 +66,8 @@ TCPServerDispatcher::TCPServerDispatcher(TCPServerConnectionFactory::Ptr pFactor
 	_currentConnections(0),
 	_maxConcurrentConnections(0),
 	_refusedConnections(0),
+	_limitedConnections(0),
+	_concurrencyLimit(0),
 	_stopped(false),
 	_pConnectionFactory(pFactory),
 	_threadPool(threadPool)
@@ -71,6 +79,9 @@ TCPServerDispatcher::TCPServerDispatcher(TCPServerConnectionFactory::Ptr pFactor
 	
 	if (_pParams->getMaxThreads() == 0)
 		_pParams->setMaxThreads(threadPool.capacity());
+
+	if (_pParams->getTargetQueueLatency() > 0)
+		_concurrencyLimit = _pParams->getMaxThreads() + _pParams->getMaxQueued();
 }
 
 
@@ -110,6 +121,8 @@ void TCPServerDispatcher::run()
 			TCPConnectionNotification* pCNf = dynamic_cast<TCPConnectionNotification*>(pNf.get());
 			if (pCNf)
 			{
+				if (_concurrencyLimit > 0)
+					updateConcurrencyLimit(Poco::Clock() - pCNf->enqueued());
 				std::auto_ptr<TCPServerConnection> pConnection(_pConnectionFactory->createConnection(pCNf->socket()));
 				poco_check_ptr(pConnection.get());
 				beginConnection();
@@ -138,7 +151,12 @@ void TCPServerDispatcher::enqueue(const StreamSocket& socket)
 {
 	FastMutex::ScopedLock lock(_mutex);
 
-	if (_queue.size() < _pParams->getMaxQueued())
+	if (_concurrencyLimit > 0 && _queue.size() + _currentConnections >= _concurrencyLimit)
+	{
+		++_refusedConnections;
+		++_limitedConnections;
+	}
+	else if (_queue.size() < _pParams->getMaxQueued())
 	{
 		_queue.enqueueNotification(new TCPConnectionNotification(socket));
 		if (!_queue.hasIdleThreads() && _currentThreads < _pParams->getMaxThreads())
@@ -223,6 +241,22 @@ int TCPServerDispatcher::refusedConnections() const
 }
 
 
+int TCPServerDispatcher::limitedConnections() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+	
+	return _limitedConnections;
+}
+
+
+int TCPServerDispatcher::concurrencyLimit() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+	
+	return _concurrencyLimit;
+}
+
+
 void TCPServerDispatcher::beginConnection()
 {
 	FastMutex::ScopedLock lock(_mutex);
@@ -242,4 +276,31 @@ void TCPServerDispatcher::endConnection()
 }
 
 
+void TCPServerDispatcher::updateConcurrencyLimit(Poco::Clock::ClockDiff latency)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	Poco::Clock::ClockDiff target = _pParams->getTargetQueueLatency().totalMicroseconds();
+	if (latency > target)
+	{
+		// Connections dequeued right after this one have waited in the
+		// same queue, so lower the limit at most once per target latency.
+		Poco::Clock now;
+		if (now - _lastDecrease >= target)
+		{
+			_concurrencyLimit -= _concurrencyLimit/10 > 1 ? _concurrencyLimit/10 : 1;
+			_lastDecrease = now;
+		}
+	}
+	else ++_concurrencyLimit;
+
+	int minLimit = _pParams->getMaxThreads();
+	int maxLimit = minLimit + _pParams->getMaxQueued();
+	if (_concurrencyLimit < minLimit)
+		_concurrencyLimit = minLimit;
+	else if (_concurrencyLimit > maxLimit)
+		_concurrencyLimit = maxLimit;
+}
+
+
 } } // namespace Poco::Net
@@ -25,7 +25,8 @@ TCPServerParams::TCPServerParams():
 	_threadIdleTime(10000000),
 	_maxThreads(0),
 	_maxQueued(64),
-	_threadPriority(Poco::Thread::PRIO_NORMAL)
+	_threadPriority(Poco::Thread::PRIO_NORMAL),
+	_targetQueueLatency(0)
 {
 }
 
@@ -63,4 +64,10 @@ void TCPServerParams::setThreadPriority(Poco::Thread::Priority prio)
 }
 
 
+void TCPServerParams::setTargetQueueLatency(const Poco::Timespan& latency)
+{
+	_targetQueueLatency = latency;
+}
+
+
 } } // namespace Poco::Net
@@ -0,0 +1,92 @@
+//
+// TokenBucket.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: TCPServer
+// Module:  TokenBucket
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/TokenBucket.h"
+#include "Poco/Exception.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+TokenBucket::TokenBucket(double rate, double burst):
+	_rate(rate),
+	_burst(burst),
+	_tokens(burst)
+{
+	if (rate < 0) throw Poco::InvalidArgumentException("TokenBucket rate must not be negative");
+	if (burst < 1) throw Poco::InvalidArgumentException("TokenBucket burst must be at least one");
+}
+
+
+TokenBucket::~TokenBucket()
+{
+}
+
+
+bool TokenBucket::tryConsume(double tokens)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	refill();
+	if (_tokens >= tokens)
+	{
+		_tokens -= tokens;
+		return true;
+	}
+	return false;
+}
+
+
+void TokenBucket::refund(double tokens)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	refill();
+	_tokens += tokens;
+	if (_tokens > _burst) _tokens = _burst;
+}
+
+
+double TokenBucket::available()
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	refill();
+	return _tokens;
+}
+
+
+bool TokenBucket::full()
+{
+	return available() >= _burst;
+}
+
+
+void TokenBucket::refill()
+{
+	Poco::Clock now;
+	Poco::Clock::ClockDiff elapsed = now - _lastRefill;
+	if (elapsed > 0)
+	{
+		_tokens += _rate*static_cast<double>(elapsed)/Poco::Clock::resolution();
+		if (_tokens > _burst) _tokens = _burst;
+		_lastRefill = now;
+	}
+}
+
+
+} } // namespace Poco::Net
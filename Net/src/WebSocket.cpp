@@ -48,6 +48,12 @@ WebSocket::WebSocket(HTTPServerRequest& request, HTTPServerResponse& response):
 }
 
 	
+WebSocket::WebSocket(HTTPServerRequest& request, HTTPServerResponse& response, const WebSocketDeflate::Params& deflateParams):
+	StreamSocket(accept(request, response, &deflateParams))
+{
+}
+
+	
 WebSocket::WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response):
 	StreamSocket(connect(cs, request, response, _defaultCreds))
 {
@@ -129,7 +135,25 @@ WebSocket::Mode WebSocket::mode() const
 }
 
 
-WebSocketImpl* WebSocket::accept(HTTPServerRequest& request, HTTPServerResponse& response)
+bool WebSocket::compressed() const
+{
+	return static_cast<WebSocketImpl*>(impl())->deflate() != 0;
+}
+
+
+void WebSocket::setMaxPayloadSize(int maxPayloadSize)
+{
+	static_cast<WebSocketImpl*>(impl())->setMaxPayloadSize(maxPayloadSize);
+}
+
+
+int WebSocket::getMaxPayloadSize() const
+{
+	return static_cast<WebSocketImpl*>(impl())->getMaxPayloadSize();
+}
+
+
+WebSocketImpl* WebSocket::accept(HTTPServerRequest& request, HTTPServerResponse& response, const WebSocketDeflate::Params* pDeflateParams)
 {
 	if (request.hasToken("Connection", "upgrade") && icompare(request.get("Upgrade", ""), "websocket") == 0)
 	{
@@ -139,14 +163,21 @@ WebSocketImpl* WebSocket::accept(HTTPServerRequest& request, HTTPServerResponse&
 		std::string key = request.get("Sec-WebSocket-Key", "");
 		Poco::trimInPlace(key);
 		if (key.empty()) throw WebSocketException("Missing Sec-WebSocket-Key in handshake request", WS_ERR_HANDSHAKE_NO_KEY);
+
+		WebSocketDeflate::Params deflateParams;
+		std::string extensions;
+		bool deflate = pDeflateParams && WebSocketDeflate::accept(request.get(WebSocketDeflate::EXTENSIONS_HEADER, ""), *pDeflateParams, deflateParams, extensions);
 		
 		response.setStatusAndReason(HTTPResponse::HTTP_SWITCHING_PROTOCOLS);
 		response.set("Upgrade", "websocket");
 		response.set("Connection", "Upgrade");
 		response.set("Sec-WebSocket-Accept", computeAccept(key));
+		if (deflate) response.set(WebSocketDeflate::EXTENSIONS_HEADER, extensions);
 		response.setContentLength(0);
 		response.send().flush();
-		return new WebSocketImpl(static_cast<StreamSocketImpl*>(static_cast<HTTPServerRequestImpl&>(request).detachSocket().impl()), false);
+		WebSocketImpl* pImpl = new WebSocketImpl(static_cast<StreamSocketImpl*>(static_cast<HTTPServerRequestImpl&>(request).detachSocket().impl()), false);
+		if (deflate) pImpl->setDeflate(new WebSocketDeflate(true, deflateParams));
+		return pImpl;
 	}
 	else throw WebSocketException("No WebSocket handshake", WS_ERR_NO_HANDSHAKE);
 }
@@ -169,7 +200,7 @@ WebSocketImpl* WebSocket::connect(HTTPClientSession& cs, HTTPRequest& request, H
 	std::istream& istr = cs.receiveResponse(response);
 	if (response.getStatus() == HTTPResponse::HTTP_SWITCHING_PROTOCOLS)
 	{
-		return completeHandshake(cs, response, key);
+		return completeHandshake(cs, request, response, key);
 	}
 	else if (response.getStatus() == HTTPResponse::HTTP_UNAUTHORIZED)
 	{
@@ -185,7 +216,7 @@ WebSocketImpl* WebSocket::connect(HTTPClientSession& cs, HTTPRequest& request, H
 		cs.receiveResponse(response);
 		if (response.getStatus() == HTTPResponse::HTTP_SWITCHING_PROTOCOLS)
 		{
-			return completeHandshake(cs, response, key);
+			return completeHandshake(cs, request, response, key);
 		}
 		else if (response.getStatus() == HTTPResponse::HTTP_UNAUTHORIZED)
 		{
@@ -203,7 +234,7 @@ WebSocketImpl* WebSocket::connect(HTTPClientSession& cs, HTTPRequest& request, H
 }
 
 
-WebSocketImpl* WebSocket::completeHandshake(HTTPClientSession& cs, HTTPResponse& response, const std::string& key)
+WebSocketImpl* WebSocket::completeHandshake(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, const std::string& key)
 {
 	std::string connection = response.get("Connection", "");
 	if (Poco::icompare(connection, "Upgrade") != 0) 
@@ -214,7 +245,11 @@ WebSocketImpl* WebSocket::completeHandshake(HTTPClientSession& cs, HTTPResponse&
 	std::string accept = response.get("Sec-WebSocket-Accept", "");
 	if (accept != computeAccept(key))
 		throw WebSocketException("Invalid or missing Sec-WebSocket-Accept header in handshake response", WS_ERR_NO_HANDSHAKE);
-	return new WebSocketImpl(static_cast<StreamSocketImpl*>(cs.detachSocket().impl()), true);
+	WebSocketDeflate::Params deflateParams;
+	bool deflate = WebSocketDeflate::confirm(request.get(WebSocketDeflate::EXTENSIONS_HEADER, ""), response.get(WebSocketDeflate::EXTENSIONS_HEADER, ""), deflateParams);
+	WebSocketImpl* pImpl = new WebSocketImpl(static_cast<StreamSocketImpl*>(cs.detachSocket().impl()), true);
+	if (deflate) pImpl->setDeflate(new WebSocketDeflate(false, deflateParams));
+	return pImpl;
 }
 
 
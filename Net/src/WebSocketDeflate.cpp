@@ -0,0 +1,399 @@
+//
+// WebSocketDeflate.cpp
+//
+// $Id$
+//
+// Library: Net
+// Package: WebSocket
+// Module:  WebSocketDeflate
+//
+// Copyright (c) 2012, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/WebSocketDeflate.h"
+#include "Poco/Net/WebSocket.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/StringTokenizer.h"
+#include "Poco/NumberParser.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/String.h"
+#include "Poco/Exception.h"
+#include <vector>
+#include <cstring>
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	// The trailing empty stored block produced by a Z_SYNC_FLUSH,
+	// which is removed from every compressed message (RFC 7692, 7.2.1).
+	const char SYNC_TAIL[] = { 0x00, 0x00, '\xff', '\xff' };
+
+	typedef std::vector<std::pair<std::string, std::string> > ParamList;
+
+	struct Extension
+	{
+		std::string name;
+		ParamList params;
+	};
+
+	void parseExtensions(const std::string& header, std::vector<Extension>& extensions)
+	{
+		Poco::StringTokenizer list(header, ",", Poco::StringTokenizer::TOK_TRIM | Poco::StringTokenizer::TOK_IGNORE_EMPTY);
+		for (Poco::StringTokenizer::Iterator it = list.begin(); it != list.end(); ++it)
+		{
+			Poco::StringTokenizer tok(*it, ";", Poco::StringTokenizer::TOK_TRIM | Poco::StringTokenizer::TOK_IGNORE_EMPTY);
+			if (tok.count() == 0) continue;
+			Extension ext;
+			ext.name = Poco::toLower(tok[0]);
+			for (std::size_t i = 1; i < tok.count(); ++i)
+			{
+				std::string::size_type pos = tok[i].find('=');
+				std::string name = Poco::trim(tok[i].substr(0, pos));
+				std::string value;
+				if (pos != std::string::npos)
+				{
+					value = Poco::trim(tok[i].substr(pos + 1));
+					if (value.size() >= 2 && value[0] == '"' && value[value.size() - 1] == '"')
+						value = value.substr(1, value.size() - 2);
+				}
+				ext.params.push_back(ParamList::value_type(Poco::toLower(name), value));
+			}
+			extensions.push_back(ext);
+		}
+	}
+
+	bool parseWindowBits(const std::string& value, int& bits)
+	{
+		return Poco::NumberParser::tryParse(value, bits) && bits >= WebSocketDeflate::MIN_WINDOW_BITS && bits <= WebSocketDeflate::MAX_WINDOW_BITS;
+	}
+
+	bool hasParam(const ParamList& params, const std::string& name)
+	{
+		for (ParamList::const_iterator it = params.begin(); it != params.end(); ++it)
+		{
+			if (it->first == name) return true;
+		}
+		return false;
+	}
+
+	// zlib cannot compress raw DEFLATE streams with a 256 byte
+	// window. A 512 byte window can decompress such streams, though.
+	const int MIN_DEFLATE_WINDOW_BITS = 9;
+
+	int zlibWindowBits(int bits)
+	{
+		return -(bits < MIN_DEFLATE_WINDOW_BITS ? MIN_DEFLATE_WINDOW_BITS : bits);
+	}
+}
+
+
+const std::string WebSocketDeflate::EXTENSION("permessage-deflate");
+const std::string WebSocketDeflate::EXTENSIONS_HEADER("Sec-WebSocket-Extensions");
+
+
+WebSocketDeflate::Params::Params():
+	serverNoContextTakeover(false),
+	clientNoContextTakeover(false),
+	serverMaxWindowBits(MAX_WINDOW_BITS),
+	clientMaxWindowBits(MAX_WINDOW_BITS),
+	compressionLevel(Z_DEFAULT_COMPRESSION),
+	minimumSize(64)
+{
+}
+
+
+WebSocketDeflate::WebSocketDeflate(bool server, const Params& params):
+	_params(params),
+	_resetDeflate(server ? params.serverNoContextTakeover : params.clientNoContextTakeover),
+	_resetInflate(server ? params.clientNoContextTakeover : params.serverNoContextTakeover)
+{
+	std::memset(&_deflate, 0, sizeof(_deflate));
+	std::memset(&_inflate, 0, sizeof(_inflate));
+
+	int deflateBits = server ? params.serverMaxWindowBits : params.clientMaxWindowBits;
+	int inflateBits = server ? params.clientMaxWindowBits : params.serverMaxWindowBits;
+	int rc = deflateInit2(&_deflate, params.compressionLevel, Z_DEFLATED, zlibWindowBits(deflateBits), 8, Z_DEFAULT_STRATEGY);
+	if (rc != Z_OK) throw Poco::IOException(zError(rc));
+	rc = inflateInit2(&_inflate, zlibWindowBits(inflateBits));
+	if (rc != Z_OK)
+	{
+		deflateEnd(&_deflate);
+		throw Poco::IOException(zError(rc));
+	}
+}
+
+
+WebSocketDeflate::~WebSocketDeflate()
+{
+	deflateEnd(&_deflate);
+	inflateEnd(&_inflate);
+}
+
+
+void WebSocketDeflate::compress(const char* data, int length, Poco::Buffer<char>& buffer)
+{
+	_deflate.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	_deflate.avail_in = static_cast<uInt>(length);
+
+	std::size_t size = 0;
+	buffer.resize(deflateBound(&_deflate, length) + 16, false);
+	do
+	{
+		if (size == buffer.size()) buffer.resize(2*size);
+		_deflate.next_out  = reinterpret_cast<Bytef*>(buffer.begin() + size);
+		_deflate.avail_out = static_cast<uInt>(buffer.size() - size);
+		int rc = deflate(&_deflate, Z_SYNC_FLUSH);
+		if (rc != Z_OK && rc != Z_BUF_ERROR) throw Poco::IOException(zError(rc));
+		size = buffer.size() - _deflate.avail_out;
+	}
+	while (_deflate.avail_out == 0);
+
+	if (size >= 4 && std::memcmp(buffer.begin() + size - 4, SYNC_TAIL, 4) == 0)
+		size -= 4;
+	if (size == 0)
+	{
+		// an empty message is sent as an empty stored block
+		buffer[0] = 0;
+		size = 1;
+	}
+	buffer.resize(size);
+
+	if (_resetDeflate) deflateReset(&_deflate);
+}
+
+
+void WebSocketDeflate::decompress(const char* data, int length, bool final, Poco::Buffer<char>& buffer, int maxLength)
+{
+	poco_assert (maxLength >= 0);
+
+	std::size_t size = buffer.size();
+	const std::size_t limit = size + static_cast<std::size_t>(maxLength);
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		if (pass == 0)
+		{
+			_inflate.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+			_inflate.avail_in = static_cast<uInt>(length);
+		}
+		else if (final)
+		{
+			_inflate.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(SYNC_TAIL));
+			_inflate.avail_in = 4;
+		}
+		else break;
+
+		for (;;)
+		{
+			std::size_t room = 4*static_cast<std::size_t>(length) + 1024;
+			if (room < size) room = size;
+			// one byte more than allowed tells an oversized
+			// payload from one that has exactly maxLength bytes
+			if (room > limit + 1 - size) room = limit + 1 - size;
+			buffer.resize(size + room);
+			_inflate.next_out  = reinterpret_cast<Bytef*>(buffer.begin() + size);
+			_inflate.avail_out = static_cast<uInt>(room);
+			int rc = inflate(&_inflate, Z_SYNC_FLUSH);
+			size += room - _inflate.avail_out;
+			if (rc == Z_STREAM_END)
+			{
+				// the peer has terminated the DEFLATE stream with
+				// a final block; the next one starts from scratch
+				inflateReset(&_inflate);
+			}
+			else if (rc != Z_OK && rc != Z_BUF_ERROR)
+			{
+				buffer.resize(size);
+				throw WebSocketException("Invalid compressed payload", WebSocket::WS_ERR_COMPRESSION);
+			}
+			if (size > limit)
+			{
+				buffer.resize(limit);
+				throw WebSocketException("Payload too big", WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
+			}
+			if (_inflate.avail_in == 0 && _inflate.avail_out > 0) break;
+		}
+	}
+	buffer.resize(size);
+
+	if (final && _resetInflate) inflateReset(&_inflate);
+}
+
+
+std::string WebSocketDeflate::offer(const Params& params)
+{
+	std::string result(EXTENSION);
+	if (params.serverNoContextTakeover)
+		result += "; server_no_context_takeover";
+	if (params.clientNoContextTakeover)
+		result += "; client_no_context_takeover";
+	if (params.serverMaxWindowBits < MAX_WINDOW_BITS)
+	{
+		result += "; server_max_window_bits=";
+		result += Poco::NumberFormatter::format(params.serverMaxWindowBits);
+	}
+	// always allow the server to limit our window size
+	result += "; client_max_window_bits";
+	if (params.clientMaxWindowBits < MAX_WINDOW_BITS)
+	{
+		result += "=";
+		result += Poco::NumberFormatter::format(params.clientMaxWindowBits);
+	}
+	return result;
+}
+
+
+bool WebSocketDeflate::accept(const std::string& extensions, const Params& params, Params& agreed, std::string& response)
+{
+	std::vector<Extension> offers;
+	parseExtensions(extensions, offers);
+	for (std::vector<Extension>::const_iterator it = offers.begin(); it != offers.end(); ++it)
+	{
+		if (it->name != EXTENSION) continue;
+
+		Params result(params);
+		bool clientWindowBits = false;
+		bool valid = true;
+		for (ParamList::const_iterator p = it->params.begin(); valid && p != it->params.end(); ++p)
+		{
+			// parameters must not be repeated
+			if (hasParam(ParamList(it->params.begin(), p), p->first))
+			{
+				valid = false;
+			}
+			else if (p->first == "server_no_context_takeover")
+			{
+				valid = p->second.empty();
+				result.serverNoContextTakeover = true;
+			}
+			else if (p->first == "client_no_context_takeover")
+			{
+				valid = p->second.empty();
+				result.clientNoContextTakeover = true;
+			}
+			else if (p->first == "server_max_window_bits")
+			{
+				int bits;
+				valid = parseWindowBits(p->second, bits) && bits >= MIN_DEFLATE_WINDOW_BITS;
+				if (valid && bits < result.serverMaxWindowBits)
+					result.serverMaxWindowBits = bits;
+			}
+			else if (p->first == "client_max_window_bits")
+			{
+				int bits = MAX_WINDOW_BITS;
+				valid = p->second.empty() || parseWindowBits(p->second, bits);
+				if (valid && bits < result.clientMaxWindowBits)
+					result.clientMaxWindowBits = bits;
+				clientWindowBits = true;
+			}
+			else valid = false;
+		}
+		if (!valid) continue;
+
+		// without client_max_window_bits in the offer, the client
+		// may use any window size
+		if (!clientWindowBits)
+			result.clientMaxWindowBits = MAX_WINDOW_BITS;
+
+		response = EXTENSION;
+		if (result.serverNoContextTakeover)
+			response += "; server_no_context_takeover";
+		if (result.clientNoContextTakeover)
+			response += "; client_no_context_takeover";
+		if (result.serverMaxWindowBits < MAX_WINDOW_BITS)
+		{
+			response += "; server_max_window_bits=";
+			response += Poco::NumberFormatter::format(result.serverMaxWindowBits);
+		}
+		if (result.clientMaxWindowBits < MAX_WINDOW_BITS)
+		{
+			response += "; client_max_window_bits=";
+			response += Poco::NumberFormatter::format(result.clientMaxWindowBits);
+		}
+		agreed = result;
+		return true;
+	}
+	return false;
+}
+
+
+bool WebSocketDeflate::confirm(const std::string& offer, const std::string& response, Params& agreed)
+{
+	std::vector<Extension> responses;
+	parseExtensions(response, responses);
+	const Extension* pAccepted = 0;
+	for (std::vector<Extension>::const_iterator it = responses.begin(); it != responses.end(); ++it)
+	{
+		if (it->name == EXTENSION)
+		{
+			if (pAccepted) throw WebSocketException("Extension accepted more than once", EXTENSION, WebSocket::WS_ERR_NO_HANDSHAKE);
+			pAccepted = &*it;
+		}
+	}
+	if (!pAccepted) return false;
+
+	std::vector<Extension> offers;
+	parseExtensions(offer, offers);
+	const Extension* pOffered = 0;
+	for (std::vector<Extension>::const_iterator it = offers.begin(); !pOffered && it != offers.end(); ++it)
+	{
+		if (it->name == EXTENSION) pOffered = &*it;
+	}
+	if (!pOffered) throw WebSocketException("Extension accepted without being offered", EXTENSION, WebSocket::WS_ERR_NO_HANDSHAKE);
+
+	Params result;
+	int serverWindowLimit = MAX_WINDOW_BITS;
+	bool clientWindowBits = false;
+	for (ParamList::const_iterator p = pOffered->params.begin(); p != pOffered->params.end(); ++p)
+	{
+		int bits;
+		if (p->first == "client_no_context_takeover")
+			result.clientNoContextTakeover = true;
+		else if (p->first == "server_max_window_bits" && parseWindowBits(p->second, bits))
+			serverWindowLimit = bits;
+		else if (p->first == "client_max_window_bits")
+		{
+			clientWindowBits = true;
+			if (parseWindowBits(p->second, bits)) result.clientMaxWindowBits = bits;
+		}
+	}
+
+	bool serverWindowBits = false;
+	for (ParamList::const_iterator p = pAccepted->params.begin(); p != pAccepted->params.end(); ++p)
+	{
+		int bits;
+		if (p->first == "server_no_context_takeover" && p->second.empty())
+		{
+			result.serverNoContextTakeover = true;
+		}
+		else if (p->first == "client_no_context_takeover" && p->second.empty())
+		{
+			result.clientNoContextTakeover = true;
+		}
+		else if (p->first == "server_max_window_bits" && parseWindowBits(p->second, bits) && bits <= serverWindowLimit)
+		{
+			result.serverMaxWindowBits = bits;
+			serverWindowBits = true;
+		}
+		else if (p->first == "client_max_window_bits" && clientWindowBits && parseWindowBits(p->second, bits) && bits >= MIN_DEFLATE_WINDOW_BITS)
+		{
+			if (bits < result.clientMaxWindowBits) result.clientMaxWindowBits = bits;
+		}
+		else throw WebSocketException("Invalid extension parameter in handshake response", p->first, WebSocket::WS_ERR_NO_HANDSHAKE);
+	}
+	if (serverWindowLimit < MAX_WINDOW_BITS && !serverWindowBits)
+		throw WebSocketException("Missing server_max_window_bits in handshake response", WebSocket::WS_ERR_NO_HANDSHAKE);
+
+	agreed = result;
+	return true;
+}
+
+
+} } // namespace Poco::Net
@@ -18,11 +18,17 @@
 #include "Poco/Net/NetException.h"
 #include "Poco/Net/WebSocket.h"
 #include "Poco/Buffer.h"
-#include "Poco/BinaryWriter.h"
-#include "Poco/BinaryReader.h"
-#include "Poco/MemoryStream.h"
 #include "Poco/Format.h"
+#include <algorithm>
+#include <limits>
 #include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POCO_WEBSOCKET_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define POCO_WEBSOCKET_NEON
+#endif
 
 
 namespace Poco {
@@ -32,8 +38,17 @@ namespace Net {
 WebSocketImpl::WebSocketImpl(StreamSocketImpl* pStreamSocketImpl, bool mustMaskPayload):
 	StreamSocketImpl(pStreamSocketImpl->sockfd()),
 	_pStreamSocketImpl(pStreamSocketImpl),
+	_maxPayloadSize(std::numeric_limits<int>::max()),
 	_frameFlags(0),
-	_mustMaskPayload(mustMaskPayload)
+	_mustMaskPayload(mustMaskPayload),
+	_buffer(0),
+	_bufferOffset(0),
+	_bufferLength(0),
+	_pDeflate(0),
+	_compressedMessage(false),
+	_sendBuffer(0),
+	_receiveBuffer(0),
+	_inflateBuffer(0)
 {
 	poco_check_ptr(pStreamSocketImpl);
 	_pStreamSocketImpl->duplicate();
@@ -51,18 +66,39 @@ WebSocketImpl::~WebSocketImpl()
 	{
 		poco_unexpected();
 	}
+	delete _pDeflate;
 }
 
 	
 int WebSocketImpl::sendBytes(const void* buffer, int length, int flags)
 {
-	Poco::Buffer<char> frame(length + MAX_HEADER_LENGTH);
-	Poco::MemoryOutputStream ostr(frame.begin(), frame.size());
-	Poco::BinaryWriter writer(ostr, Poco::BinaryWriter::NETWORK_BYTE_ORDER);
-	
 	if (flags == 0) flags = WebSocket::FRAME_BINARY;
 	flags &= 0xff;
-	writer << static_cast<Poco::UInt8>(flags);
+
+	int opcode = flags & WebSocket::FRAME_OP_BITMASK;
+	if (_pDeflate 
+		&& (opcode == WebSocket::FRAME_OP_TEXT || opcode == WebSocket::FRAME_OP_BINARY)
+		&& (flags & (WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_FLAG_RSV1)) == WebSocket::FRAME_FLAG_FIN
+		&& _pDeflate->compressible(length))
+	{
+		// Only unfragmented messages are compressed; the
+		// extension allows sending any message uncompressed.
+		_pDeflate->compress(reinterpret_cast<const char*>(buffer), length, _sendBuffer);
+		sendFrame(_sendBuffer.begin(), static_cast<int>(_sendBuffer.size()), flags | WebSocket::FRAME_FLAG_RSV1);
+	}
+	else
+	{
+		sendFrame(reinterpret_cast<const char*>(buffer), length, flags);
+	}
+	return length;
+}
+
+
+void WebSocketImpl::sendFrame(const char* payload, int length, int flags)
+{
+	Poco::Buffer<char> frame(length + MAX_HEADER_LENGTH);
+	Poco::UInt8* p = reinterpret_cast<Poco::UInt8*>(frame.begin());
+	*p++ = static_cast<Poco::UInt8>(flags);
 	Poco::UInt8 lengthByte(0);
 	if (_mustMaskPayload)
 	{
@@ -70,123 +106,158 @@ int WebSocketImpl::sendBytes(const void* buffer, int length, int flags)
 	}
 	if (length < 126)
 	{
-		lengthByte |= static_cast<Poco::UInt8>(length);
-		writer << lengthByte;
+		*p++ = lengthByte | static_cast<Poco::UInt8>(length);
 	}
 	else if (length < 65536)
 	{
-		lengthByte |= 126;
-		writer << lengthByte << static_cast<Poco::UInt16>(length);
+		*p++ = lengthByte | 126;
+		*p++ = static_cast<Poco::UInt8>(length >> 8);
+		*p++ = static_cast<Poco::UInt8>(length);
 	}
 	else
 	{
-		lengthByte |= 127;
-		writer << lengthByte << static_cast<Poco::UInt64>(length);
+		*p++ = lengthByte | 127;
+		Poco::UInt64 l = static_cast<Poco::UInt64>(length);
+		for (int i = 56; i >= 0; i -= 8)
+		{
+			*p++ = static_cast<Poco::UInt8>(l >> i);
+		}
 	}
 	if (_mustMaskPayload)
 	{
-		const Poco::UInt32 mask = _rnd.next();
-		const char* m = reinterpret_cast<const char*>(&mask);
-		const char* b = reinterpret_cast<const char*>(buffer);
-		writer.writeRaw(m, 4);
-		char* p = frame.begin() + ostr.charsWritten();
-		for (int i = 0; i < length; i++)
-		{
-			p[i] = b[i] ^ m[i % 4];
-		}
+		const Poco::UInt32 rnd = _rnd.next();
+		char mask[4];
+		std::memcpy(mask, &rnd, 4);
+		std::memcpy(p, mask, 4);
+		p += 4;
+		maskPayload(reinterpret_cast<char*>(p), payload, length, mask);
 	}
 	else
 	{
-		std::memcpy(frame.begin() + ostr.charsWritten(), buffer, length);
+		std::memcpy(p, payload, length);
 	}
-	_pStreamSocketImpl->sendBytes(frame.begin(), length + static_cast<int>(ostr.charsWritten()));
-	return length;
+	int headerLength = static_cast<int>(reinterpret_cast<char*>(p) - frame.begin());
+	_pStreamSocketImpl->sendBytes(frame.begin(), length + headerLength);
 }
 
 	
 int WebSocketImpl::receiveHeader(char mask[4], bool& useMask)
 {
-	char header[MAX_HEADER_LENGTH];
-	int n = receiveNBytes(header, 2);
+	int n = fillBuffer(2);
 	if (n <= 0)
 	{
 		_frameFlags = 0;
+		_compressedMessage = false;
 		return n;
 	}
-	poco_assert (n == 2);
-	Poco::UInt8 flags = static_cast<Poco::UInt8>(header[0]);
-	_frameFlags = flags;
-	Poco::UInt8 lengthByte = static_cast<Poco::UInt8>(header[1]);
+	const Poco::UInt8* p = reinterpret_cast<const Poco::UInt8*>(_buffer.begin() + _bufferOffset);
+	Poco::UInt8 lengthByte = p[1];
 	useMask = ((lengthByte & FRAME_FLAG_MASK) != 0);
-	int payloadLength;
 	lengthByte &= 0x7f;
+	int headerLength = 2;
+	if (lengthByte == 127)
+		headerLength += 8;
+	else if (lengthByte == 126)
+		headerLength += 2;
+	if (useMask)
+		headerLength += 4;
+
+	// the header is parsed only once it is complete, so a timeout
+	// while receiving it does not lose the part already received
+	fillBuffer(headerLength);
+	p = reinterpret_cast<const Poco::UInt8*>(_buffer.begin() + _bufferOffset);
+	Poco::UInt64 payloadLength = lengthByte;
 	if (lengthByte == 127)
 	{
-		n = receiveNBytes(header + 2, 8);
-		if (n <= 0)
+		payloadLength = 0;
+		for (int i = 2; i < 10; i++)
 		{
-			_frameFlags = 0;
-			return n;
+			payloadLength = (payloadLength << 8) | p[i];
 		}
-		Poco::MemoryInputStream istr(header + 2, 8);
-		Poco::BinaryReader reader(istr, Poco::BinaryReader::NETWORK_BYTE_ORDER);
-		Poco::UInt64 l;
-		reader >> l;
-		payloadLength = static_cast<int>(l);
-	} else if (lengthByte == 126)
-	{
-		n = receiveNBytes(header + 2, 2);
-		if (n <= 0)
-		{
-			_frameFlags = 0;
-			return n;
-		}
-		Poco::MemoryInputStream istr(header + 2, 2);
-		Poco::BinaryReader reader(istr, Poco::BinaryReader::NETWORK_BYTE_ORDER);
-		Poco::UInt16 l;
-		reader >> l;
-		payloadLength = static_cast<int>(l);
 	}
-	else
+	else if (lengthByte == 126)
 	{
-		payloadLength = lengthByte;
+		payloadLength = (static_cast<Poco::UInt64>(p[2]) << 8) | p[3];
 	}
-
 	if (useMask)
 	{
-		n = receiveNBytes(mask, 4);
-		if (n <= 0)
-		{
-			_frameFlags = 0;
-			return n;
-		}
+		std::memcpy(mask, p + headerLength - 4, 4);
 	}
+	_frameFlags = p[0];
+	_bufferOffset += headerLength;
+	if (payloadLength > static_cast<Poco::UInt64>(_maxPayloadSize))
+		throw WebSocketException("Payload too big", WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
 
-	return payloadLength;
+	return static_cast<int>(payloadLength);
 }
 
 
 int WebSocketImpl::receivePayload(char *buffer, int payloadLength, char mask[4], bool useMask)
 {
-	int received = receiveNBytes(reinterpret_cast<char*>(buffer), payloadLength);
-	if (received <= 0) throw WebSocketException("Incomplete frame received", WebSocket::WS_ERR_INCOMPLETE_FRAME);
+	int received = _bufferLength - _bufferOffset;
+	if (received > payloadLength) received = payloadLength;
+	if (received > 0)
+	{
+		std::memcpy(buffer, _buffer.begin() + _bufferOffset, received);
+		_bufferOffset += received;
+	}
+	if (received < payloadLength)
+	{
+		// the rest of the payload goes directly into the caller's buffer
+		int n = receiveNBytes(buffer + received, payloadLength - received);
+		if (n <= 0) throw WebSocketException("Incomplete frame received", WebSocket::WS_ERR_INCOMPLETE_FRAME);
+		received += n;
+	}
 
 	if (useMask)
 	{
-		for (int i = 0; i < received; i++)
-		{
-			buffer[i] ^= mask[i % 4];
-		}
+		maskPayload(buffer, buffer, received, mask);
 	}
 	return received;
 }
 
 
+bool WebSocketImpl::compressedFrame()
+{
+	if (!_pDeflate) return false;
+
+	int opcode = _frameFlags & WebSocket::FRAME_OP_BITMASK;
+	if (opcode == WebSocket::FRAME_OP_TEXT || opcode == WebSocket::FRAME_OP_BINARY)
+		_compressedMessage = (_frameFlags & WebSocket::FRAME_FLAG_RSV1) != 0;
+	else if (opcode != WebSocket::FRAME_OP_CONT)
+		return false;
+	return _compressedMessage;
+}
+
+
+int WebSocketImpl::receiveCompressed(int payloadLength, char mask[4], bool useMask, Poco::Buffer<char>& buffer, int maxLength)
+{
+	_receiveBuffer.resize(payloadLength, false);
+	if (payloadLength > 0)
+	{
+		receivePayload(_receiveBuffer.begin(), payloadLength, mask, useMask);
+	}
+	bool final = (_frameFlags & WebSocket::FRAME_FLAG_FIN) != 0;
+	std::size_t oldSize = buffer.size();
+	_pDeflate->decompress(_receiveBuffer.begin(), payloadLength, final, buffer, maxLength);
+	if (final) _compressedMessage = false;
+	_frameFlags &= ~WebSocket::FRAME_FLAG_RSV1;
+	return static_cast<int>(buffer.size() - oldSize);
+}
+
+
 int WebSocketImpl::receiveBytes(void* buffer, int length, int)
 {
 	char mask[4];
 	bool useMask;
 	int payloadLength = receiveHeader(mask, useMask);
+	if (compressedFrame())
+	{
+		_inflateBuffer.resize(0);
+		int n = receiveCompressed(payloadLength, mask, useMask, _inflateBuffer, std::min(length, _maxPayloadSize));
+		std::memcpy(buffer, _inflateBuffer.begin(), n);
+		return n;
+	}
 	if (payloadLength <= 0)
 		return payloadLength;
 	if (payloadLength > length)
@@ -200,6 +271,8 @@ int WebSocketImpl::receiveBytes(Poco::Buffer<char>& buffer, int)
 	char mask[4];
 	bool useMask;
 	int payloadLength = receiveHeader(mask, useMask);
+	if (compressedFrame())
+		return receiveCompressed(payloadLength, mask, useMask, buffer, _maxPayloadSize);
 	if (payloadLength <= 0)
 		return payloadLength;
 	int oldSize = buffer.size();
@@ -226,6 +299,117 @@ int WebSocketImpl::receiveNBytes(void* buffer, int bytes)
 }
 
 
+int WebSocketImpl::fillBuffer(int bytes)
+{
+	int available = _bufferLength - _bufferOffset;
+	if (available >= bytes) return available;
+
+	if (_buffer.size() == 0)
+	{
+		_buffer.resize(RECEIVE_BUFFER_SIZE, false);
+	}
+	else if (_bufferOffset > 0)
+	{
+		std::memmove(_buffer.begin(), _buffer.begin() + _bufferOffset, available);
+	}
+	_bufferOffset = 0;
+	_bufferLength = available;
+	while (_bufferLength < bytes)
+	{
+		int n = _pStreamSocketImpl->receiveBytes(_buffer.begin() + _bufferLength, RECEIVE_BUFFER_SIZE - _bufferLength);
+		if (n <= 0)
+		{
+			if (_bufferLength == 0) return n;
+			throw WebSocketException("Incomplete frame received", WebSocket::WS_ERR_INCOMPLETE_FRAME);
+		}
+		_bufferLength += n;
+	}
+	return _bufferLength;
+}
+
+
+void WebSocketImpl::setDeflate(WebSocketDeflate* pDeflate)
+{
+	delete _pDeflate;
+	_pDeflate = pDeflate;
+}
+
+
+void WebSocketImpl::setMaxPayloadSize(int maxPayloadSize)
+{
+	poco_assert (maxPayloadSize > 0);
+
+	_maxPayloadSize = maxPayloadSize;
+}
+
+
+void WebSocketImpl::maskPayload(char* dest, const char* src, int length, const char mask[4], int offset)
+{
+	char key[4];
+	for (int i = 0; i < 4; i++)
+	{
+		key[i] = mask[(i + offset) & 3];
+	}
+
+	// All steps below process a multiple of four bytes, so
+	// that the key stays aligned with the payload.
+	int i = 0;
+#if defined(POCO_WEBSOCKET_SSE2)
+	if (length >= 16)
+	{
+		Poco::UInt32 k;
+		std::memcpy(&k, key, 4);
+		const __m128i m = _mm_set1_epi32(static_cast<int>(k));
+		for (; i + 64 <= length; i += 64)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_xor_si128(a, m));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 16), _mm_xor_si128(b, m));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 32), _mm_xor_si128(c, m));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 48), _mm_xor_si128(d, m));
+		}
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_xor_si128(a, m));
+		}
+	}
+#elif defined(POCO_WEBSOCKET_NEON)
+	if (length >= 16)
+	{
+		Poco::UInt32 k;
+		std::memcpy(&k, key, 4);
+		const uint8x16_t m = vreinterpretq_u8_u32(vdupq_n_u32(k));
+		for (; i + 16 <= length; i += 16)
+		{
+			uint8x16_t a = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+			vst1q_u8(reinterpret_cast<uint8_t*>(dest + i), veorq_u8(a, m));
+		}
+	}
+#endif
+	if (i + 8 <= length)
+	{
+		Poco::UInt64 k;
+		std::memcpy(&k, key, 4);
+		std::memcpy(reinterpret_cast<char*>(&k) + 4, key, 4);
+		for (; i + 8 <= length; i += 8)
+		{
+			Poco::UInt64 w;
+			std::memcpy(&w, src + i, 8);
+			w ^= k;
+			std::memcpy(dest + i, &w, 8);
+		}
+	}
+	for (; i < length; i++)
+	{
+		dest[i] = src[i] ^ key[i & 3];
+	}
+}
+
+
 SocketImpl* WebSocketImpl::acceptConnection(SocketAddress& clientAddr)
 {
 	throw Poco::InvalidAccessException("Cannot acceptConnection() on a WebSocketImpl");
@@ -340,5 +524,11 @@ Poco::Timespan WebSocketImpl::getReceiveTimeout()
 	return _pStreamSocketImpl->getReceiveTimeout();
 }
 
+
+int WebSocketImpl::available()
+{
+	return _bufferLength - _bufferOffset + _pStreamSocketImpl->available();
+}
+
 	
 } } // namespace Poco::Net
@@ -0,0 +1,313 @@
+//
+// DNSCacheTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "DNSCacheTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/DNSCache.h"
+#include "Poco/Net/DNS.h"
+#include "Poco/Net/HostEntry.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/ActiveResult.h"
+#include "Poco/Thread.h"
+#include <vector>
+
+
+using Poco::Net::DNSCache;
+using Poco::Net::DNS;
+using Poco::Net::HostEntry;
+using Poco::Net::DNSException;
+using Poco::Net::HostNotFoundException;
+using Poco::ActiveResult;
+using Poco::Thread;
+using Poco::Timespan;
+
+
+namespace
+{
+	const unsigned FLAGS = DNS::DNS_HINT_NONE;
+
+	class TestDNSCache: public DNSCache
+		/// Resolves every host name to 127.0.0.1, except
+		/// "nohost", which is not found, and "error", for
+		/// which the lookup fails.
+	{
+	public:
+		TestDNSCache(std::size_t maxEntries = DNSCache::DEFAULT_MAX_ENTRIES):
+			DNSCache(maxEntries),
+			_delay(0)
+		{
+		}
+
+		void setDelay(long milliseconds)
+		{
+			_delay = milliseconds;
+		}
+
+	protected:
+		HostEntry lookup(const std::string& hostname, unsigned hintFlags)
+		{
+			if (_delay > 0) Thread::sleep(_delay);
+			if (hostname == "nohost")
+				throw HostNotFoundException(hostname);
+			else if (hostname == "error")
+				throw DNSException("Temporary DNS error while resolving", hostname);
+			else
+				return DNSCache::lookup("127.0.0.1", hintFlags);
+		}
+
+	private:
+		long _delay;
+	};
+}
+
+
+DNSCacheTest::DNSCacheTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+DNSCacheTest::~DNSCacheTest()
+{
+}
+
+
+void DNSCacheTest::testCache()
+{
+	TestDNSCache cache;
+	HostEntry he1 = cache.hostByName("host1", FLAGS);
+	assert (he1.addresses().size() >= 1);
+	assert (he1.addresses()[0].toString() == "127.0.0.1");
+	assert (cache.lookups() == 1);
+	assert (cache.size() == 1);
+
+	HostEntry he2 = cache.hostByName("host1", FLAGS);
+	assert (he2.addresses()[0].toString() == "127.0.0.1");
+	assert (cache.lookups() == 1);
+
+	cache.hostByName("HOST1", FLAGS);
+	assert (cache.lookups() == 1);
+
+	cache.hostByName("host2", FLAGS);
+	assert (cache.lookups() == 2);
+	assert (cache.size() == 2);
+}
+
+
+void DNSCacheTest::testNegativeCache()
+{
+	TestDNSCache cache;
+	for (int i = 0; i < 2; ++i)
+	{
+		try
+		{
+			cache.hostByName("nohost", FLAGS);
+			fail ("host not found - must throw");
+		}
+		catch (HostNotFoundException&)
+		{
+		}
+	}
+	assert (cache.lookups() == 1);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		try
+		{
+			cache.hostByName("error", FLAGS);
+			fail ("DNS error - must throw");
+		}
+		catch (DNSException&)
+		{
+		}
+	}
+	assert (cache.lookups() == 3);
+
+	cache.clear();
+	cache.setNegativeTimeToLive(0);
+	for (int i = 0; i < 2; ++i)
+	{
+		try
+		{
+			cache.hostByName("nohost", FLAGS);
+			fail ("host not found - must throw");
+		}
+		catch (HostNotFoundException&)
+		{
+		}
+	}
+	assert (cache.lookups() == 5);
+}
+
+
+void DNSCacheTest::testStale()
+{
+	TestDNSCache cache;
+	cache.setTimeToLive(Timespan(0, 100000));
+	cache.setStaleTimeToLive(Timespan(10, 0));
+	cache.hostByName("host1", FLAGS);
+	assert (cache.lookups() == 1);
+	Thread::sleep(200);
+
+	// the stale entry is returned while it is refreshed
+	cache.setTimeToLive(Timespan(10, 0));
+	cache.setDelay(200);
+	HostEntry he = cache.hostByName("host1", FLAGS);
+	assert (he.addresses()[0].toString() == "127.0.0.1");
+	int n = 0;
+	while (cache.lookups() < 2 && n++ < 100) Thread::sleep(10);
+	assert (cache.lookups() == 2);
+	Thread::sleep(300);
+
+	cache.setDelay(0);
+	cache.hostByName("host1", FLAGS);
+	assert (cache.lookups() == 2);
+}
+
+
+void DNSCacheTest::testExpire()
+{
+	TestDNSCache cache;
+	cache.setTimeToLive(Timespan(0, 100000));
+	cache.setStaleTimeToLive(0);
+	cache.hostByName("host1", FLAGS);
+	cache.hostByName("host1", FLAGS);
+	assert (cache.lookups() == 1);
+	Thread::sleep(200);
+	cache.hostByName("host1", FLAGS);
+	assert (cache.lookups() == 2);
+	assert (cache.size() == 1);
+}
+
+
+void DNSCacheTest::testMaxEntries()
+{
+	TestDNSCache cache(2);
+	cache.hostByName("host1", FLAGS);
+	cache.hostByName("host2", FLAGS);
+	cache.hostByName("host3", FLAGS);
+	assert (cache.size() == 2);
+	assert (cache.lookups() == 3);
+
+	cache.hostByName("host3", FLAGS);
+	assert (cache.lookups() == 3);
+	cache.hostByName("host1", FLAGS);
+	assert (cache.lookups() == 4);
+}
+
+
+void DNSCacheTest::testRemove()
+{
+	TestDNSCache cache;
+	cache.hostByName("host1", FLAGS);
+	cache.hostByName("host1", FLAGS | 1);
+	cache.hostByName("host2", FLAGS);
+	assert (cache.size() == 3);
+
+	cache.remove("Host1");
+	assert (cache.size() == 1);
+	cache.hostByName("host2", FLAGS);
+	assert (cache.lookups() == 3);
+
+	cache.clear();
+	assert (cache.size() == 0);
+}
+
+
+void DNSCacheTest::testDisabled()
+{
+	TestDNSCache cache;
+	cache.setEnabled(false);
+	assert (!cache.isEnabled());
+	cache.hostByName("host1", FLAGS);
+	cache.hostByName("host1", FLAGS);
+	assert (cache.lookups() == 2);
+	assert (cache.size() == 0);
+}
+
+
+void DNSCacheTest::testAsync()
+{
+	TestDNSCache cache;
+	ActiveResult<HostEntry> result1 = cache.hostByNameAsync("host1", FLAGS);
+	result1.wait();
+	assert (!result1.failed());
+	assert (result1.data().addresses()[0].toString() == "127.0.0.1");
+	assert (cache.lookups() == 1);
+
+	ActiveResult<HostEntry> result2 = cache.hostByNameAsync("host1", FLAGS);
+	assert (result2.available());
+	assert (result2.data().addresses()[0].toString() == "127.0.0.1");
+	assert (cache.lookups() == 1);
+
+	ActiveResult<HostEntry> result3 = cache.hostByNameAsync("nohost", FLAGS);
+	result3.wait();
+	assert (result3.failed());
+	assert (dynamic_cast<HostNotFoundException*>(result3.exception()) != 0);
+
+	ActiveResult<HostEntry> result4 = cache.hostByNameAsync("nohost", FLAGS);
+	assert (result4.available());
+	assert (result4.failed());
+	assert (cache.lookups() == 2);
+}
+
+
+void DNSCacheTest::testAsyncCombined()
+{
+	TestDNSCache cache;
+	cache.setDelay(200);
+	std::vector<ActiveResult<HostEntry> > results;
+	for (int i = 0; i < 5; ++i)
+	{
+		results.push_back(cache.hostByNameAsync("host1", FLAGS));
+	}
+
+	// a synchronous lookup waits for the pending one
+	HostEntry he = cache.hostByName("host1", FLAGS);
+	assert (he.addresses()[0].toString() == "127.0.0.1");
+
+	for (std::vector<ActiveResult<HostEntry> >::iterator it = results.begin(); it != results.end(); ++it)
+	{
+		it->wait();
+		assert (!it->failed());
+		assert (it->data().addresses()[0].toString() == "127.0.0.1");
+	}
+	assert (cache.lookups() == 1);
+}
+
+
+void DNSCacheTest::setUp()
+{
+}
+
+
+void DNSCacheTest::tearDown()
+{
+}
+
+
+CppUnit::Test* DNSCacheTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("DNSCacheTest");
+
+	CppUnit_addTest(pSuite, DNSCacheTest, testCache);
+	CppUnit_addTest(pSuite, DNSCacheTest, testNegativeCache);
+	CppUnit_addTest(pSuite, DNSCacheTest, testStale);
+	CppUnit_addTest(pSuite, DNSCacheTest, testExpire);
+	CppUnit_addTest(pSuite, DNSCacheTest, testMaxEntries);
+	CppUnit_addTest(pSuite, DNSCacheTest, testRemove);
+	CppUnit_addTest(pSuite, DNSCacheTest, testDisabled);
+	CppUnit_addTest(pSuite, DNSCacheTest, testAsync);
+	CppUnit_addTest(pSuite, DNSCacheTest, testAsyncCombined);
+
+	return pSuite;
+}
@@ -0,0 +1,48 @@
+//
+// DNSCacheTest.h
+//
+// $Id$
+//
+// Definition of the DNSCacheTest class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef DNSCacheTest_INCLUDED
+#define DNSCacheTest_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "CppUnit/TestCase.h"
+
+
+class DNSCacheTest: public CppUnit::TestCase
+{
+public:
+	DNSCacheTest(const std::string& name);
+	~DNSCacheTest();
+
+	void testCache();
+	void testNegativeCache();
+	void testStale();
+	void testExpire();
+	void testMaxEntries();
+	void testRemove();
+	void testDisabled();
+	void testAsync();
+	void testAsyncCombined();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // DNSCacheTest_INCLUDED
@@ -17,8 +17,13 @@
 #include "Poco/Net/PartSource.h"
 #include "Poco/Net/StringPartSource.h"
 #include "Poco/Net/PartHandler.h"
+#include "Poco/Net/FilePartHandler.h"
 #include "Poco/Net/HTTPRequest.h"
 #include "Poco/Net/NetException.h"
+#include "Poco/FileStream.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/File.h"
+#include "Poco/UnbufferedStreamBuf.h"
 #include <sstream>
 
 
@@ -26,6 +31,7 @@ using Poco::Net::HTMLForm;
 using Poco::Net::PartSource;
 using Poco::Net::StringPartSource;
 using Poco::Net::PartHandler;
+using Poco::Net::FilePartHandler;
 using Poco::Net::HTTPRequest;
 using Poco::Net::HTTPMessage;
 using Poco::Net::MessageHeader;
@@ -72,6 +78,36 @@ namespace
 		std::string _disp;
 		std::string _type;
 	};
+
+	class RepeatStreamBuf: public Poco::UnbufferedStreamBuf
+		/// Repeats the given pattern until the given number
+		/// of characters has been read, and counts them.
+	{
+	public:
+		RepeatStreamBuf(const std::string& pattern, std::size_t length):
+			_pattern(pattern),
+			_length(length),
+			_read(0)
+		{
+		}
+
+		std::size_t read() const
+		{
+			return _read;
+		}
+
+	protected:
+		int readFromDevice()
+		{
+			if (_read == _length) return -1;
+			return static_cast<unsigned char>(_pattern[_read++ % _pattern.size()]);
+		}
+
+	private:
+		std::string _pattern;
+		std::size_t _length;
+		std::size_t _read;
+	};
 }
 
 
@@ -248,6 +284,63 @@ void HTMLFormTest::testReadMultipart()
 }
 
 
+void HTMLFormTest::testFilePartHandler()
+{
+	std::string data;
+	for (int i = 0; i < 100000; ++i) data += char('a' + i % 26);
+	std::istringstream istr(
+		"--MIME_boundary_0123456789\r\n"
+		"Content-Disposition: form-data; name=\"field1\"\r\n"
+		"\r\n"
+		"value1\r\n"
+		"--MIME_boundary_0123456789\r\n"
+		"Content-Disposition: form-data; name=\"upload\"; filename=\"../upload.bin\"\r\n"
+		"Content-Type: application/octet-stream\r\n"
+		"\r\n" +
+		data +
+		"\r\n"
+		"--MIME_boundary_0123456789--\r\n"
+	);
+	HTTPRequest req("POST", "/form.cgi");
+	req.setContentType(HTMLForm::ENCODING_MULTIPART + "; boundary=\"MIME_boundary_0123456789\"");
+	std::string path;
+	{
+		FilePartHandler handler;
+		HTMLForm form(req, istr, handler);
+		assert (form.size() == 1);
+		assert (form["field1"] == "value1");
+
+		assert (handler.parts().size() == 1);
+		const FilePartHandler::Part& part = handler.parts()[0];
+		assert (part.name == "upload");
+		assert (part.filename == "../upload.bin");
+		assert (part.mediaType == "application/octet-stream");
+		assert (part.size == data.size());
+		assert (part.path.find("upload.bin") == std::string::npos);
+		path = part.path;
+
+		Poco::FileInputStream fstr(path);
+		std::string content;
+		Poco::StreamCopier::copyToString(fstr, content);
+		assert (content == data);
+	}
+	assert (!Poco::File(path).exists());
+
+	istr.clear();
+	istr.seekg(0);
+	FilePartHandler handler;
+	handler.setMaxPartSize(1000);
+	try
+	{
+		HTMLForm form(req, istr, handler);
+		fail ("part too large - must throw");
+	}
+	catch (Poco::Net::MessageException&)
+	{
+	}
+}
+
+
 void HTMLFormTest::testSubmit1()
 {
 	HTMLForm form;
@@ -311,6 +404,50 @@ void HTMLFormTest::testFieldLimitUrl()
 }
 
 
+void HTMLFormTest::testFieldLimitUrlStream()
+{
+	const std::size_t LENGTH = 16*1024*1024;
+	HTTPRequest req("POST", "/form.cgi");
+
+	// too many fields
+	RepeatStreamBuf fieldsBuf("field=value&", LENGTH);
+	std::istream fieldsStream(&fieldsBuf);
+	HTMLForm form;
+	form.setFieldLimit(3);
+	try
+	{
+		form.load(req, fieldsStream);
+		fail("field limit violated - must throw");
+	}
+	catch (Poco::Net::HTMLFormException&)
+	{
+	}
+	assert (fieldsBuf.read() < 1024);
+
+	// a single field that is too long
+	RepeatStreamBuf valueBuf("value", LENGTH);
+	std::istream valueStream(&valueBuf);
+	HTMLForm form2;
+	try
+	{
+		form2.load(req, valueStream);
+		fail("field too long - must throw");
+	}
+	catch (Poco::Net::HTMLFormException&)
+	{
+	}
+	assert (valueBuf.read() < 1024*1024);
+
+	// fields below the limits are read completely
+	RepeatStreamBuf okBuf("field=value&", 12*100);
+	std::istream okStream(&okBuf);
+	HTMLForm form3;
+	form3.load(req, okStream);
+	assert (form3.size() == 100);
+	assert (okBuf.read() == 12*100);
+}
+
+
 void HTMLFormTest::testFieldLimitMultipart()
 {
 	std::istringstream istr(
@@ -375,10 +512,12 @@ CppUnit::Test* HTMLFormTest::suite()
 	CppUnit_addTest(pSuite, HTMLFormTest, testReadUrlPUT);
 	CppUnit_addTest(pSuite, HTMLFormTest, testReadUrlBOM);
 	CppUnit_addTest(pSuite, HTMLFormTest, testReadMultipart);
+	CppUnit_addTest(pSuite, HTMLFormTest, testFilePartHandler);
 	CppUnit_addTest(pSuite, HTMLFormTest, testSubmit1);
 	CppUnit_addTest(pSuite, HTMLFormTest, testSubmit2);
 	CppUnit_addTest(pSuite, HTMLFormTest, testSubmit3);
 	CppUnit_addTest(pSuite, HTMLFormTest, testFieldLimitUrl);
+	CppUnit_addTest(pSuite, HTMLFormTest, testFieldLimitUrlStream);
 	CppUnit_addTest(pSuite, HTMLFormTest, testFieldLimitMultipart);
 
 	return pSuite;
@@ -33,10 +33,12 @@ public:
 	void testReadUrlPUT();
 	void testReadUrlBOM();
 	void testReadMultipart();
+	void testFilePartHandler();
 	void testSubmit1();
 	void testSubmit2();
 	void testSubmit3();
 	void testFieldLimitUrl();
+	void testFieldLimitUrlStream();
 	void testFieldLimitMultipart();
 
 	void setUp();
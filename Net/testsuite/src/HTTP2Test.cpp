@@ -0,0 +1,662 @@
+//
+// HTTP2Test.cpp
+//
+// $Id$
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "HTTP2Test.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/HTTP2ClientSession.h"
+#include "Poco/Net/HTTP2Stream.h"
+#include "Poco/Net/HTTP2Connection.h"
+#include "Poco/Net/HPACK.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/InflatingStream.h"
+#include "Poco/Thread.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Event.h"
+#include "Poco/Runnable.h"
+#include "Poco/NumberFormatter.h"
+#include <sstream>
+
+
+using Poco::Net::HTTP2ClientSession;
+using Poco::Net::HTTP2Stream;
+using Poco::Net::HTTP2InputStream;
+using Poco::Net::HTTP2OutputStream;
+using Poco::Net::HTTP2Exception;
+using Poco::Net::HTTP2Connection;
+using Poco::Net::HPACKTable;
+using Poco::Net::HPACKDecoder;
+using Poco::Net::HPACKEncoder;
+using Poco::Net::HTTPServer;
+using Poco::Net::HTTPServerParams;
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPRequestHandlerFactory;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+using Poco::Net::HTTPClientSession;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPMessage;
+using Poco::Net::StreamSocket;
+using Poco::Net::ServerSocket;
+using Poco::Net::SocketAddress;
+using Poco::StreamCopier;
+using Poco::InflatingInputStream;
+using Poco::InflatingStreamBuf;
+using Poco::Thread;
+using Poco::ThreadPool;
+using Poco::Event;
+using Poco::NumberFormatter;
+
+
+namespace
+{
+	class EchoBodyRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			std::string body;
+			StreamCopier::copyToString(request.stream(), body);
+			response.setContentType(request.getContentType());
+			response.setContentLength((int) body.size());
+			response.set("X-Version", request.getVersion());
+			response.send() << body;
+		}
+	};
+
+	class EchoURIRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			std::string body = request.getMethod() + " " + request.getURI() + " " + request.getHost() + " " + request.get("X-Test", "");
+			response.setContentType("text/plain");
+			response.setContentLength((int) body.size());
+			std::ostream& ostr = response.send();
+			if (request.getMethod() != HTTPRequest::HTTP_HEAD)
+				ostr << body;
+		}
+	};
+
+	class LargeRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			response.setChunkedTransferEncoding(true);
+			response.setContentType("text/plain");
+			std::ostream& ostr = response.send();
+			std::string line(1023, 'x');
+			for (int i = 0; i < 1024; ++i)
+			{
+				ostr << line << '\n';
+			}
+		}
+	};
+
+	class ThreadNameRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			std::string body = Thread::current()->getName();
+			response.setContentType("text/plain");
+			response.setContentLength((int) body.size());
+			response.send() << body;
+		}
+	};
+
+	Event holdEvent(false);
+
+	class HoldRequestHandler: public HTTPRequestHandler
+		/// Does not read the request body until holdEvent is set.
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			holdEvent.tryWait(10000);
+			response.setContentLength(0);
+			response.send();
+		}
+	};
+
+	class RequestHandlerFactory: public HTTPRequestHandlerFactory
+	{
+	public:
+		HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
+		{
+			if (request.getURI() == "/echoBody")
+				return new EchoBodyRequestHandler;
+			else if (request.getURI() == "/large")
+				return new LargeRequestHandler;
+			else if (request.getURI() == "/thread")
+				return new ThreadNameRequestHandler;
+			else if (request.getURI() == "/hold")
+				return new HoldRequestHandler;
+			else if (request.getURI().compare(0, 5, "/echo") == 0)
+				return new EchoURIRequestHandler;
+			else
+				return 0;
+		}
+	};
+
+	class ClientRunnable: public Poco::Runnable
+	{
+	public:
+		ClientRunnable(HTTP2ClientSession& session, int id):
+			_session(session),
+			_id(id),
+			_ok(0)
+		{
+		}
+
+		void run()
+		{
+			for (int i = 0; i < 10; ++i)
+			{
+				std::string uri = "/echo/" + NumberFormatter::format(_id) + "/" + NumberFormatter::format(i);
+				HTTPRequest request(HTTPRequest::HTTP_GET, uri);
+				HTTP2Stream::Ptr pStream = _session.sendRequest(request);
+				HTTPResponse response;
+				_session.receiveResponse(pStream, response);
+				HTTP2InputStream istr(pStream);
+				std::string body;
+				StreamCopier::copyToString(istr, body);
+				if (response.getStatus() == HTTPResponse::HTTP_OK && body.compare(0, uri.size() + 5, "GET " + uri + " ") == 0)
+					++_ok;
+			}
+		}
+
+		int ok() const
+		{
+			return _ok;
+		}
+
+	private:
+		HTTP2ClientSession& _session;
+		int _id;
+		int _ok;
+	};
+
+	void appendFrame(std::string& frames, int type, int flags, Poco::UInt32 streamId, const std::string& payload)
+	{
+		frames += static_cast<char>(payload.size() >> 16);
+		frames += static_cast<char>(payload.size() >> 8);
+		frames += static_cast<char>(payload.size());
+		frames += static_cast<char>(type);
+		frames += static_cast<char>(flags);
+		frames += static_cast<char>(streamId >> 24);
+		frames += static_cast<char>(streamId >> 16);
+		frames += static_cast<char>(streamId >> 8);
+		frames += static_cast<char>(streamId);
+		frames += payload;
+	}
+
+	HTTPServerParams* http2Params()
+	{
+		HTTPServerParams* pParams = new HTTPServerParams;
+		pParams->setHTTP2Enabled(true);
+		return pParams;
+	}
+}
+
+
+HTTP2Test::HTTP2Test(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+HTTP2Test::~HTTP2Test()
+{
+}
+
+
+void HTTP2Test::testGet()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, http2Params());
+	srv.start();
+
+	HTTP2ClientSession cs("localhost", svs.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/echo?a=b");
+	request.set("X-Test", "value");
+	HTTP2Stream::Ptr pStream = cs.sendRequest(request);
+	HTTPResponse response;
+	cs.receiveResponse(pStream, response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.getVersion() == "HTTP/2.0");
+	assert (response.getContentType() == "text/plain");
+	assert (response.has("date"));
+	HTTP2InputStream istr(pStream);
+	std::string body;
+	StreamCopier::copyToString(istr, body);
+	assert (body == "GET /echo?a=b localhost value");
+	assert (response.getContentLength() == body.size());
+}
+
+
+void HTTP2Test::testHead()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, http2Params());
+	srv.start();
+
+	HTTP2ClientSession cs("localhost", svs.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_HEAD, "/echo");
+	HTTP2Stream::Ptr pStream = cs.sendRequest(request);
+	HTTPResponse response;
+	cs.receiveResponse(pStream, response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.getContentLength() == 21);
+	HTTP2InputStream istr(pStream);
+	std::string body;
+	StreamCopier::copyToString(istr, body);
+	assert (body.empty());
+}
+
+
+void HTTP2Test::testPost()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, http2Params());
+	srv.start();
+
+	HTTP2ClientSession cs("localhost", svs.address().port());
+	std::string body(5000, 'x');
+	HTTPRequest request(HTTPRequest::HTTP_POST, "/echoBody");
+	request.setContentType("text/plain");
+	HTTP2Stream::Ptr pStream = cs.sendRequest(request, body);
+	HTTPResponse response;
+	cs.receiveResponse(pStream, response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.getContentType() == "text/plain");
+	assert (response.get("x-version") == "HTTP/2.0");
+	HTTP2InputStream istr(pStream);
+	std::string rbody;
+	StreamCopier::copyToString(istr, rbody);
+	assert (rbody == body);
+
+	pStream = cs.sendRequestHeader(request);
+	{
+		HTTP2OutputStream ostr(pStream);
+		for (int i = 0; i < 100; ++i)
+			ostr << "Hello, world! ";
+	}
+	cs.receiveResponse(pStream, response);
+	HTTP2InputStream istr2(pStream);
+	rbody.clear();
+	StreamCopier::copyToString(istr2, rbody);
+	assert (rbody.size() == 1400);
+	assert (rbody.compare(0, 14, "Hello, world! ") == 0);
+}
+
+
+void HTTP2Test::testLargeBody()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, http2Params());
+	srv.start();
+
+	HTTP2ClientSession cs("localhost", svs.address().port());
+
+	// The request and response bodies are both larger than
+	// the initial flow-control windows.
+	std::string body(1024*1024, 'y');
+	HTTPRequest request(HTTPRequest::HTTP_POST, "/echoBody");
+	HTTP2Stream::Ptr pStream = cs.sendRequest(request, body);
+	HTTPResponse response;
+	cs.receiveResponse(pStream, response);
+	HTTP2InputStream istr(pStream);
+	std::string rbody;
+	StreamCopier::copyToString(istr, rbody);
+	assert (rbody == body);
+
+	request.setURI("/large");
+	request.setMethod(HTTPRequest::HTTP_GET);
+	pStream = cs.sendRequest(request);
+	cs.receiveResponse(pStream, response);
+	assert (!response.getChunkedTransferEncoding());
+	HTTP2InputStream istr2(pStream);
+	rbody.clear();
+	StreamCopier::copyToString(istr2, rbody);
+	assert (rbody.size() == 1024*1024);
+}
+
+
+void HTTP2Test::testConcurrentStreams()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, http2Params());
+	srv.start();
+
+	HTTP2ClientSession cs("localhost", svs.address().port());
+	ClientRunnable r1(cs, 1);
+	ClientRunnable r2(cs, 2);
+	ClientRunnable r3(cs, 3);
+	Thread t1;
+	Thread t2;
+	Thread t3;
+	t1.start(r1);
+	t2.start(r2);
+	t3.start(r3);
+	t1.join();
+	t2.join();
+	t3.join();
+	assert (r1.ok() == 10);
+	assert (r2.ok() == 10);
+	assert (r3.ok() == 10);
+	assert (cs.connection().activeStreams() == 0);
+}
+
+
+void HTTP2Test::testCompression()
+{
+	HTTPServerParams* pParams = http2Params();
+	pParams->setCompressionEnabled(true);
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	HTTP2ClientSession cs("localhost", svs.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/large");
+	request.set("Accept-Encoding", "gzip");
+	HTTP2Stream::Ptr pStream = cs.sendRequest(request);
+	HTTPResponse response;
+	cs.receiveResponse(pStream, response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.get("content-encoding") == "gzip");
+	assert (response.get("vary") == "Accept-Encoding");
+	HTTP2InputStream istr(pStream);
+	InflatingInputStream inflater(istr, InflatingStreamBuf::STREAM_GZIP);
+	std::string body;
+	StreamCopier::copyToString(inflater, body);
+	assert (body.size() == 1024*1024);
+	assert (body.find_first_not_of("x\n") == std::string::npos);
+
+	// below the minimum size
+	request.setURI("/echo");
+	pStream = cs.sendRequest(request);
+	cs.receiveResponse(pStream, response);
+	assert (!response.has("content-encoding"));
+	HTTP2InputStream istr2(pStream);
+	body.clear();
+	StreamCopier::copyToString(istr2, body);
+	assert (body == "GET /echo localhost ");
+}
+
+
+void HTTP2Test::testNotFound()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, http2Params());
+	srv.start();
+
+	HTTP2ClientSession cs("localhost", svs.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/unknown");
+	HTTP2Stream::Ptr pStream = cs.sendRequest(request);
+	HTTPResponse response;
+	cs.receiveResponse(pStream, response);
+	assert (response.getStatus() == HTTPResponse::HTTP_NOT_IMPLEMENTED);
+
+	cs.close();
+	try
+	{
+		cs.sendRequest(request);
+		fail ("connection closed - must throw");
+	}
+	catch (HTTP2Exception&)
+	{
+	}
+}
+
+
+void HTTP2Test::testUpgrade()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, http2Params());
+	srv.start();
+
+	StreamSocket ss(SocketAddress("localhost", svs.address().port()));
+	// HTTP2-Settings contains SETTINGS_ENABLE_PUSH = 0.
+	std::string request =
+		"GET /echo HTTP/1.1\r\n"
+		"Host: localhost\r\n"
+		"X-Test: upgrade\r\n"
+		"Connection: Upgrade, HTTP2-Settings\r\n"
+		"Upgrade: h2c\r\n"
+		"HTTP2-Settings: AAIAAAAA\r\n"
+		"\r\n";
+	ss.sendBytes(request.data(), (int) request.size());
+	std::string header;
+	while (header.size() < 4 || header.compare(header.size() - 4, 4, "\r\n\r\n") != 0)
+	{
+		char c;
+		assert (ss.receiveBytes(&c, 1) == 1);
+		header += c;
+	}
+	assert (header.compare(0, 12, "HTTP/1.1 101") == 0);
+	assert (header.find("Upgrade: h2c") != std::string::npos);
+
+	// Send the connection preface and an empty SETTINGS frame,
+	// then read the response to the upgraded request on stream 1.
+	std::string preface = HTTP2Connection::PREFACE;
+	preface.append("\0\0\0\x04\0\0\0\0\0", 9);
+	ss.sendBytes(preface.data(), (int) preface.size());
+
+	HPACKDecoder decoder;
+	HPACKTable::FieldList fields;
+	std::string body;
+	bool endStream = false;
+	while (!endStream)
+	{
+		unsigned char frame[9];
+		int n = 0;
+		while (n < 9)
+		{
+			int rc = ss.receiveBytes(frame + n, 9 - n);
+			assert (rc > 0);
+			n += rc;
+		}
+		int length = (frame[0] << 16) | (frame[1] << 8) | frame[2];
+		Poco::UInt32 streamId = ((frame[5] & 0x7F) << 24) | (frame[6] << 16) | (frame[7] << 8) | frame[8];
+		std::string payload(length, '\0');
+		n = 0;
+		while (n < length)
+		{
+			int rc = ss.receiveBytes(&payload[n], length - n);
+			assert (rc > 0);
+			n += rc;
+		}
+		if (frame[3] == HTTP2Connection::FRAME_HEADERS)
+		{
+			assert (streamId == 1);
+			assert (frame[4] & HTTP2Connection::FLAG_END_HEADERS);
+			decoder.decode(payload.data(), payload.size(), fields);
+		}
+		else if (frame[3] == HTTP2Connection::FRAME_DATA)
+		{
+			assert (streamId == 1);
+			body += payload;
+		}
+		if (streamId == 1 && (frame[4] & HTTP2Connection::FLAG_END_STREAM))
+			endStream = true;
+	}
+	assert (!fields.empty());
+	assert (fields[0] == HPACKTable::Field(":status", "200"));
+	assert (body == "GET /echo localhost upgrade");
+}
+
+
+void HTTP2Test::testDisabled()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, svs, new HTTPServerParams);
+	srv.start();
+
+	StreamSocket ss(SocketAddress("localhost", svs.address().port()));
+	ss.sendBytes(HTTP2Connection::PREFACE.data(), (int) HTTP2Connection::PREFACE.size());
+	char buffer[256];
+	int n = ss.receiveBytes(buffer, sizeof(buffer));
+	assert (n > 12);
+	assert (std::string(buffer, 12) != "HTTP/1.1 101");
+	assert (buffer[0] == 'H');
+
+	// An upgrade request is handled as an ordinary request.
+	HTTPClientSession cs("localhost", svs.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/echo", HTTPMessage::HTTP_1_1);
+	request.set("Connection", "Upgrade, HTTP2-Settings");
+	request.set("Upgrade", "h2c");
+	request.set("HTTP2-Settings", "AAIAAAAA");
+	cs.sendRequest(request);
+	HTTPResponse response;
+	std::string body;
+	StreamCopier::copyToString(cs.receiveResponse(response), body);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (body == "GET /echo localhost:" + NumberFormatter::format(svs.address().port()) + " ");
+}
+
+
+void HTTP2Test::testThreadPool()
+{
+	ThreadPool pool("h2pool", 2, 8);
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, pool, svs, http2Params());
+	srv.start();
+
+	HTTP2ClientSession cs("localhost", svs.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/thread");
+	HTTP2Stream::Ptr pStream = cs.sendRequest(request);
+	HTTPResponse response;
+	cs.receiveResponse(pStream, response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	HTTP2InputStream istr(pStream);
+	std::string body;
+	StreamCopier::copyToString(istr, body);
+	assert (body.compare(0, 8, "h2pool[#") == 0);
+}
+
+
+void HTTP2Test::testConnectionFlowControl()
+{
+	holdEvent.reset();
+	ThreadPool pool(2, 32);
+	ServerSocket svs(0);
+	HTTPServer srv(new RequestHandlerFactory, pool, svs, http2Params());
+	srv.start();
+
+	StreamSocket ss(SocketAddress("localhost", svs.address().port()));
+	ss.setReceiveTimeout(Poco::Timespan(10, 0));
+	std::string preface = HTTP2Connection::PREFACE;
+	preface.append("\0\0\0\x04\0\0\0\0\0", 9);
+	ss.sendBytes(preface.data(), (int) preface.size());
+
+	// Each stream stays within its own window, but the handlers
+	// do not read, so that the streams together exceed the
+	// connection's window.
+	HPACKEncoder encoder;
+	HPACKTable::FieldList fields;
+	fields.push_back(HPACKTable::Field(":method", "POST"));
+	fields.push_back(HPACKTable::Field(":scheme", "http"));
+	fields.push_back(HPACKTable::Field(":path", "/hold"));
+	fields.push_back(HPACKTable::Field(":authority", "localhost"));
+	const int frameSize = 16383;
+	const int streams = HTTP2Connection::CONNECTION_WINDOW_SIZE/(4*frameSize) + 1;
+	std::string data(frameSize, 'x');
+	for (int i = 0; i < streams; ++i)
+	{
+		Poco::UInt32 streamId = 2*i + 1;
+		std::string block;
+		encoder.encode(fields, block);
+		std::string frames;
+		appendFrame(frames, HTTP2Connection::FRAME_HEADERS, HTTP2Connection::FLAG_END_HEADERS, streamId, block);
+		for (int j = 0; j < 4; ++j)
+		{
+			appendFrame(frames, HTTP2Connection::FRAME_DATA, 0, streamId, data);
+		}
+		ss.sendBytes(frames.data(), (int) frames.size());
+	}
+
+	// The server must send a GOAWAY frame with FLOW_CONTROL_ERROR.
+	Poco::UInt32 errorCode = HTTP2Connection::H2_NO_ERROR;
+	for (;;)
+	{
+		unsigned char frame[9];
+		int n = 0;
+		while (n < 9)
+		{
+			int rc = ss.receiveBytes(frame + n, 9 - n);
+			assert (rc > 0);
+			n += rc;
+		}
+		int length = (frame[0] << 16) | (frame[1] << 8) | frame[2];
+		std::string payload(length, '\0');
+		n = 0;
+		while (n < length)
+		{
+			int rc = ss.receiveBytes(&payload[n], length - n);
+			assert (rc > 0);
+			n += rc;
+		}
+		if (frame[3] == HTTP2Connection::FRAME_GOAWAY)
+		{
+			assert (length >= 8);
+			errorCode = (static_cast<unsigned char>(payload[4]) << 24) | (static_cast<unsigned char>(payload[5]) << 16)
+				| (static_cast<unsigned char>(payload[6]) << 8) | static_cast<unsigned char>(payload[7]);
+			break;
+		}
+	}
+	holdEvent.set();
+	assert (errorCode == HTTP2Connection::H2_FLOW_CONTROL_ERROR);
+}
+
+
+void HTTP2Test::setUp()
+{
+}
+
+
+void HTTP2Test::tearDown()
+{
+}
+
+
+CppUnit::Test* HTTP2Test::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTP2Test");
+
+	CppUnit_addTest(pSuite, HTTP2Test, testGet);
+	CppUnit_addTest(pSuite, HTTP2Test, testHead);
+	CppUnit_addTest(pSuite, HTTP2Test, testPost);
+	CppUnit_addTest(pSuite, HTTP2Test, testLargeBody);
+	CppUnit_addTest(pSuite, HTTP2Test, testConcurrentStreams);
+	CppUnit_addTest(pSuite, HTTP2Test, testCompression);
+	CppUnit_addTest(pSuite, HTTP2Test, testNotFound);
+	CppUnit_addTest(pSuite, HTTP2Test, testUpgrade);
+	CppUnit_addTest(pSuite, HTTP2Test, testDisabled);
+	CppUnit_addTest(pSuite, HTTP2Test, testThreadPool);
+	CppUnit_addTest(pSuite, HTTP2Test, testConnectionFlowControl);
+
+	return pSuite;
+}
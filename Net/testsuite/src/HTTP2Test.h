@@ -0,0 +1,50 @@
+//
+// HTTP2Test.h
+//
+// $Id$
+//
+// Definition of the HTTP2Test class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef HTTP2Test_INCLUDED
+#define HTTP2Test_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "CppUnit/TestCase.h"
+
+
+class HTTP2Test: public CppUnit::TestCase
+{
+public:
+	HTTP2Test(const std::string& name);
+	~HTTP2Test();
+
+	void testGet();
+	void testHead();
+	void testPost();
+	void testLargeBody();
+	void testConcurrentStreams();
+	void testCompression();
+	void testNotFound();
+	void testUpgrade();
+	void testDisabled();
+	void testThreadPool();
+	void testConnectionFlowControl();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // HTTP2Test_INCLUDED
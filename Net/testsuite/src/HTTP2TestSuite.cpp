@@ -0,0 +1,26 @@
+//
+// HTTP2TestSuite.cpp
+//
+// $Id$
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "HTTP2TestSuite.h"
+#include "HPACKTest.h"
+#include "HTTP2Test.h"
+
+
+CppUnit::Test* HTTP2TestSuite::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTP2TestSuite");
+
+	pSuite->addTest(HPACKTest::suite());
+	pSuite->addTest(HTTP2Test::suite());
+
+	return pSuite;
+}
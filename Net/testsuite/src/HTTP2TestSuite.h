@@ -0,0 +1,29 @@
+//
+// HTTP2TestSuite.h
+//
+// $Id$
+//
+// Definition of the HTTP2TestSuite class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef HTTP2TestSuite_INCLUDED
+#define HTTP2TestSuite_INCLUDED
+
+
+#include "CppUnit/TestSuite.h"
+
+
+class HTTP2TestSuite
+{
+public:
+	static CppUnit::Test* suite();
+};
+
+
+#endif // HTTP2TestSuite_INCLUDED
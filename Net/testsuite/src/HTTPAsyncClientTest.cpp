@@ -0,0 +1,734 @@
+//
+// HTTPAsyncClientTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "HTTPAsyncClientTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/HTTPAsyncClient.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Thread.h"
+#include "Poco/Event.h"
+#include "Poco/AtomicCounter.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Runnable.h"
+#include <vector>
+
+
+using Poco::Net::HTTPAsyncClient;
+using Poco::Net::HTTPServer;
+using Poco::Net::HTTPServerParams;
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPRequestHandlerFactory;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPMessage;
+using Poco::Net::ServerSocket;
+using Poco::Net::StreamSocket;
+using Poco::Net::SocketAddress;
+using Poco::StreamCopier;
+using Poco::Thread;
+using Poco::AtomicCounter;
+using Poco::NumberFormatter;
+using Poco::Timestamp;
+
+
+namespace
+{
+	class AsyncRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			const std::string& uri = request.getURI();
+			response.setContentType("text/plain");
+			if (uri == "/echo")
+			{
+				std::string body;
+				StreamCopier::copyToString(request.stream(), body);
+				response.setChunkedTransferEncoding(true);
+				std::ostream& ostr = response.send();
+				for (std::size_t i = 0; i < body.size(); i += 1000)
+				{
+					ostr << body.substr(i, 1000);
+					ostr.flush();
+				}
+			}
+			else if (uri == "/slow")
+			{
+				Thread::sleep(1000);
+				response.sendBuffer("slow", 4);
+			}
+			else if (uri == "/wait")
+			{
+				Thread::sleep(50);
+				response.sendBuffer("wait", 4);
+			}
+			else if (uri == "/close")
+			{
+				response.setKeepAlive(false);
+				response.send() << "until close";
+			}
+			else if (uri == "/nocontent")
+			{
+				response.setStatusAndReason(HTTPResponse::HTTP_NO_CONTENT);
+				response.setContentLength(0);
+				response.send();
+			}
+			else
+			{
+				std::string body("Hello, world! ");
+				body += uri;
+				response.sendBuffer(body.data(), body.size());
+			}
+		}
+	};
+
+	class AsyncRequestHandlerFactory: public HTTPRequestHandlerFactory
+	{
+	public:
+		HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
+		{
+			return new AsyncRequestHandler;
+		}
+	};
+
+	class ThreadCallback: public HTTPAsyncClient::Callback
+		/// Remembers the thread that has invoked the callback.
+	{
+	public:
+		ThreadCallback():
+			_pThread(0),
+			_invoked(false)
+		{
+		}
+
+		void exchangeCompleted(HTTPAsyncClient::Exchange& exchange)
+		{
+			_pThread = Thread::current();
+			_invoked = true;
+		}
+
+		bool invoked() const
+		{
+			return _invoked;
+		}
+
+		Thread* thread() const
+		{
+			return _pThread;
+		}
+
+	private:
+		Thread*       _pThread;
+		volatile bool _invoked;
+	};
+
+	class CountingCallback: public HTTPAsyncClient::Callback
+	{
+	public:
+		CountingCallback(int expected):
+			_expected(expected),
+			_completed(0),
+			_failed(0),
+			_finished(0)
+		{
+		}
+
+		void exchangeCompleted(HTTPAsyncClient::Exchange& exchange)
+		{
+			if (exchange.state() == HTTPAsyncClient::Exchange::EXCHANGE_COMPLETED
+				&& exchange.response().getStatus() == HTTPResponse::HTTP_OK
+				&& exchange.responseBody() == "Hello, world! " + exchange.request().getURI())
+				++_completed;
+			else
+				++_failed;
+			if (++_finished == _expected)
+				_done.set();
+		}
+
+		bool wait(long milliseconds)
+		{
+			return _done.tryWait(milliseconds);
+		}
+
+		int completed() const
+		{
+			return _completed;
+		}
+
+		int failed() const
+		{
+			return _failed;
+		}
+
+	private:
+		int           _expected;
+		AtomicCounter _completed;
+		AtomicCounter _failed;
+		AtomicCounter _finished;
+		Poco::Event   _done;
+	};
+
+	class DroppingServer: public Poco::Runnable
+		/// Answers the first request on every connection, and
+		/// closes the connection when the next one arrives.
+	{
+	public:
+		DroppingServer():
+			_socket(0),
+			_stop(false),
+			_connections(0),
+			_requests(0)
+		{
+			_thread.start(*this);
+		}
+
+		~DroppingServer()
+		{
+			_stop = true;
+			_thread.join();
+		}
+
+		Poco::UInt16 port() const
+		{
+			return _socket.address().port();
+		}
+
+		int connections() const
+		{
+			return _connections;
+		}
+
+		int requests() const
+		{
+			return _requests;
+		}
+
+		void run()
+		{
+			while (!_stop)
+			{
+				if (!_socket.poll(Poco::Timespan(0, 100000), Poco::Net::Socket::SELECT_READ)) continue;
+				StreamSocket ss = _socket.acceptConnection();
+				++_connections;
+				ss.setReceiveTimeout(Poco::Timespan(10, 0));
+				if (receiveRequest(ss))
+				{
+					std::string response("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+					ss.sendBytes(response.data(), (int) response.size());
+					receiveRequest(ss);
+				}
+				ss.close();
+			}
+		}
+
+	private:
+		bool receiveRequest(StreamSocket& ss)
+		{
+			std::string header;
+			while (header.size() < 4 || header.compare(header.size() - 4, 4, "\r\n\r\n") != 0)
+			{
+				char c;
+				if (ss.receiveBytes(&c, 1) != 1) return false;
+				header += c;
+			}
+			++_requests;
+			return true;
+		}
+
+		ServerSocket  _socket;
+		Thread        _thread;
+		volatile bool _stop;
+		AtomicCounter _connections;
+		AtomicCounter _requests;
+	};
+
+	HTTPServerParams* serverParams()
+	{
+		HTTPServerParams* pParams = new HTTPServerParams;
+		pParams->setKeepAlive(true);
+		pParams->setMaxKeepAliveRequests(10000);
+		return pParams;
+	}
+}
+
+
+HTTPAsyncClientTest::HTTPAsyncClientTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+HTTPAsyncClientTest::~HTTPAsyncClientTest()
+{
+}
+
+
+void HTTPAsyncClientTest::testGet()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/hello", HTTPMessage::HTTP_1_1);
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	pExchange->wait();
+	assert (pExchange->done());
+	assert (pExchange->state() == HTTPAsyncClient::Exchange::EXCHANGE_COMPLETED);
+	assert (pExchange->exception() == 0);
+	assert (pExchange->response().getStatus() == HTTPResponse::HTTP_OK);
+	assert (pExchange->response().getContentType() == "text/plain");
+	assert (pExchange->responseBody() == "Hello, world! /hello");
+	assert (pExchange->request().getHost() == "localhost:" + NumberFormatter::format(svs.address().port()));
+	assert (pExchange->request().getKeepAlive());
+	assert (client.pending() == 0);
+
+	request.setURI("/nocontent");
+	pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	assert (pExchange->tryWait(5000));
+	assert (pExchange->response().getStatus() == HTTPResponse::HTTP_NO_CONTENT);
+	assert (pExchange->responseBody().empty());
+	assert (client.connectionsOpened() == 1);
+}
+
+
+void HTTPAsyncClientTest::testPost()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	std::string body;
+	for (int i = 0; i < 10000; ++i)
+	{
+		body += NumberFormatter::format(i);
+		body += ' ';
+	}
+	HTTPRequest request(HTTPRequest::HTTP_POST, "/echo", HTTPMessage::HTTP_1_1);
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("localhost", svs.address().port(), request, body);
+	pExchange->wait();
+	assert (pExchange->request().getContentLength() == body.size());
+	assert (pExchange->requestBody() == body);
+	assert (pExchange->response().getChunkedTransferEncoding());
+	assert (pExchange->responseBody() == body);
+
+	// an empty body
+	pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	pExchange->wait();
+	assert (pExchange->request().getContentLength() == 0);
+	assert (pExchange->responseBody().empty());
+	assert (client.connectionsOpened() == 1);
+}
+
+
+void HTTPAsyncClientTest::testHead()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	HTTPRequest request(HTTPRequest::HTTP_HEAD, "/hello", HTTPMessage::HTTP_1_1);
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	pExchange->wait();
+	assert (pExchange->response().getContentLength() == 20);
+	assert (pExchange->responseBody().empty());
+
+	request.setMethod(HTTPRequest::HTTP_GET);
+	pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	pExchange->wait();
+	assert (pExchange->responseBody() == "Hello, world! /hello");
+	assert (client.connectionsOpened() == 1);
+}
+
+
+void HTTPAsyncClientTest::testUntilClose()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/close", HTTPMessage::HTTP_1_1);
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	pExchange->wait();
+	assert (!pExchange->response().getKeepAlive());
+	assert (pExchange->responseBody() == "until close");
+
+	request.setURI("/hello");
+	pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	pExchange->wait();
+	assert (pExchange->responseBody() == "Hello, world! /hello");
+	assert (client.connectionsOpened() == 2);
+}
+
+
+void HTTPAsyncClientTest::testKeepAlive()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	for (int i = 0; i < 50; ++i)
+	{
+		std::string uri("/hello/");
+		NumberFormatter::append(uri, i);
+		HTTPRequest request(HTTPRequest::HTTP_GET, uri, HTTPMessage::HTTP_1_1);
+		HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("127.0.0.1", svs.address().port(), request);
+		pExchange->wait();
+		assert (pExchange->responseBody() == "Hello, world! " + uri);
+	}
+	assert (client.connectionsOpened() == 1);
+	assert (client.connections() == 1);
+
+	// idle connections are closed after the keep-alive timeout
+	client.setKeepAliveTimeout(Poco::Timespan(0, 100000));
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/hello", HTTPMessage::HTTP_1_1);
+	client.sendRequest("127.0.0.1", svs.address().port(), request)->wait();
+	Thread::sleep(1500);
+	assert (client.connections() == 0);
+
+	// no persistent connection if requested
+	int opened = client.connectionsOpened();
+	request.setKeepAlive(false);
+	client.sendRequest("127.0.0.1", svs.address().port(), request)->wait();
+	client.sendRequest("127.0.0.1", svs.address().port(), request)->wait();
+	assert (client.connectionsOpened() == opened + 2);
+	assert (client.connections() == 0);
+}
+
+
+void HTTPAsyncClientTest::testServerClose()
+{
+	HTTPServerParams* pParams = serverParams();
+	pParams->setKeepAliveTimeout(Poco::Timespan(0, 200000));
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	HTTPAsyncClient client;
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/hello", HTTPMessage::HTTP_1_1);
+	client.sendRequest("localhost", svs.address().port(), request)->wait();
+	assert (client.connections() == 1);
+
+	// the server closes the idle connection
+	Thread::sleep(600);
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	pExchange->wait();
+	assert (pExchange->responseBody() == "Hello, world! /hello");
+	assert (client.connectionsOpened() == 2);
+}
+
+
+void HTTPAsyncClientTest::testNoRetry()
+{
+	DroppingServer srv;
+	HTTPAsyncClient client;
+	HTTPRequest get(HTTPRequest::HTTP_GET, "/hello", HTTPMessage::HTTP_1_1);
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("127.0.0.1", srv.port(), get);
+	pExchange->wait();
+	assert (pExchange->responseBody() == "ok");
+
+	// a POST on a dropped connection is not sent again
+	HTTPRequest post(HTTPRequest::HTTP_POST, "/post", HTTPMessage::HTTP_1_1);
+	pExchange = client.sendRequest("127.0.0.1", srv.port(), post, "body");
+	try
+	{
+		pExchange->wait();
+		fail("connection dropped - must throw");
+	}
+	catch (Poco::Exception&)
+	{
+	}
+	assert (pExchange->state() == HTTPAsyncClient::Exchange::EXCHANGE_FAILED);
+	assert (srv.requests() == 2);
+	assert (srv.connections() == 1);
+	assert (client.connectionsOpened() == 1);
+
+	// a GET is sent again on a new connection
+	client.sendRequest("127.0.0.1", srv.port(), get)->wait();
+	assert (client.connectionsOpened() == 2);
+	pExchange = client.sendRequest("127.0.0.1", srv.port(), get);
+	pExchange->wait();
+	assert (pExchange->responseBody() == "ok");
+	assert (srv.requests() == 5);
+	assert (client.connectionsOpened() == 3);
+}
+
+
+void HTTPAsyncClientTest::testCallback()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	CountingCallback callback(100);
+	std::vector<HTTPAsyncClient::Exchange::Ptr> exchanges;
+	for (int i = 0; i < 100; ++i)
+	{
+		std::string uri("/cb/");
+		NumberFormatter::append(uri, i);
+		HTTPRequest request(HTTPRequest::HTTP_GET, uri, HTTPMessage::HTTP_1_1);
+		exchanges.push_back(client.sendRequest("localhost", svs.address().port(), request, "", &callback));
+	}
+	assert (callback.wait(10000));
+	assert (callback.completed() == 100);
+	assert (callback.failed() == 0);
+	assert (client.pending() == 0);
+	for (std::vector<HTTPAsyncClient::Exchange::Ptr>::iterator it = exchanges.begin(); it != exchanges.end(); ++it)
+	{
+		assert ((*it)->done());
+	}
+}
+
+
+void HTTPAsyncClientTest::testTimeout()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/slow", HTTPMessage::HTTP_1_1);
+	Timestamp start;
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("localhost", svs.address().port(), request, "", 0, Poco::Timespan(0, 200000));
+	try
+	{
+		pExchange->wait();
+		fail ("exchange must time out");
+	}
+	catch (Poco::TimeoutException&)
+	{
+	}
+	assert (start.elapsed() < 900000);
+	assert (pExchange->state() == HTTPAsyncClient::Exchange::EXCHANGE_FAILED);
+	assert (dynamic_cast<const Poco::TimeoutException*>(pExchange->exception()) != 0);
+	assert (client.connections() == 0);
+
+	// the client's default timeout
+	client.setTimeout(Poco::Timespan(0, 200000));
+	pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	try
+	{
+		pExchange->wait();
+		fail ("exchange must time out");
+	}
+	catch (Poco::TimeoutException&)
+	{
+	}
+	assert (client.pending() == 0);
+
+	// let the server finish the slow requests
+	while (srv.currentConnections() > 0) Thread::sleep(10);
+}
+
+
+void HTTPAsyncClientTest::testConnectionRefused()
+{
+	Poco::UInt16 port;
+	{
+		ServerSocket svs(0);
+		port = svs.address().port();
+	}
+	HTTPAsyncClient client;
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/hello", HTTPMessage::HTTP_1_1);
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("127.0.0.1", port, request);
+	try
+	{
+		pExchange->wait();
+		fail ("connection must be refused");
+	}
+	catch (Poco::Net::NetException&)
+	{
+	}
+	assert (pExchange->state() == HTTPAsyncClient::Exchange::EXCHANGE_FAILED);
+	assert (client.connections() == 0);
+}
+
+
+void HTTPAsyncClientTest::testUnresolvableHost()
+{
+	HTTPAsyncClient client;
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/hello", HTTPMessage::HTTP_1_1);
+	ThreadCallback callback;
+	Timestamp start;
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("nohost.invalid", 80, request, "", &callback, Poco::Timespan(0, 200000));
+	// the caller must not wait for the lookup
+	assert (start.elapsed() < 200000);
+	try
+	{
+		pExchange->wait();
+		fail ("host name must not be resolved");
+	}
+	catch (Poco::TimeoutException&)
+	{
+	}
+	catch (Poco::Net::HostNotFoundException&)
+	{
+	}
+	catch (Poco::Net::NoAddressFoundException&)
+	{
+	}
+	catch (Poco::Net::DNSException&)
+	{
+	}
+	// the deadline covers the lookup
+	assert (start.elapsed() < 900000);
+	assert (pExchange->state() == HTTPAsyncClient::Exchange::EXCHANGE_FAILED);
+	assert (callback.invoked());
+	assert (callback.thread() != 0);
+	assert (client.pending() == 0);
+	assert (client.connectionsOpened() == 0);
+}
+
+
+void HTTPAsyncClientTest::testMaxConnections()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	client.setMaxConnectionsPerHost(2);
+	assert (client.getMaxConnectionsPerHost() == 2);
+	std::vector<HTTPAsyncClient::Exchange::Ptr> exchanges;
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/wait", HTTPMessage::HTTP_1_1);
+	for (int i = 0; i < 10; ++i)
+	{
+		exchanges.push_back(client.sendRequest("localhost", svs.address().port(), request));
+	}
+	for (std::vector<HTTPAsyncClient::Exchange::Ptr>::iterator it = exchanges.begin(); it != exchanges.end(); ++it)
+	{
+		(*it)->wait();
+		assert ((*it)->responseBody() == "wait");
+	}
+	assert (client.connectionsOpened() == 2);
+}
+
+
+void HTTPAsyncClientTest::testClose()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, svs, serverParams());
+	srv.start();
+
+	HTTPAsyncClient client;
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/slow", HTTPMessage::HTTP_1_1);
+	HTTPAsyncClient::Exchange::Ptr pExchange = client.sendRequest("localhost", svs.address().port(), request);
+	Thread::sleep(100);
+	client.close();
+	assert (pExchange->done());
+	try
+	{
+		pExchange->wait();
+		fail ("client closed - must throw");
+	}
+	catch (Poco::IOException&)
+	{
+	}
+	try
+	{
+		client.sendRequest("localhost", svs.address().port(), request);
+		fail ("client closed - must throw");
+	}
+	catch (Poco::IllegalStateException&)
+	{
+	}
+	assert (client.pending() == 0);
+	assert (client.connections() == 0);
+
+	// let the server finish the slow request
+	while (srv.currentConnections() > 0) Thread::sleep(10);
+}
+
+
+void HTTPAsyncClientTest::testLoad()
+{
+	const int requests = 2000;
+	const int connections = 32;
+
+	Poco::ThreadPool pool(connections, connections + 8);
+	HTTPServerParams* pParams = serverParams();
+	pParams->setMaxThreads(connections + 8);
+	ServerSocket svs(0);
+	HTTPServer srv(new AsyncRequestHandlerFactory, pool, svs, pParams);
+	srv.start();
+
+	HTTPAsyncClient client(2);
+	client.setMaxConnectionsPerHost(connections);
+	CountingCallback callback(requests);
+	for (int i = 0; i < requests; ++i)
+	{
+		std::string uri("/load/");
+		NumberFormatter::append(uri, i);
+		HTTPRequest request(HTTPRequest::HTTP_GET, uri, HTTPMessage::HTTP_1_1);
+		client.sendRequest("localhost", svs.address().port(), request, "", &callback);
+	}
+	assert (callback.wait(60000));
+	assert (callback.completed() == requests);
+	assert (callback.failed() == 0);
+	assert (client.connectionsOpened() > 0);
+	assert (client.connectionsOpened() <= connections);
+	assert (client.connections() <= connections);
+	assert (client.pending() == 0);
+}
+
+
+void HTTPAsyncClientTest::setUp()
+{
+}
+
+
+void HTTPAsyncClientTest::tearDown()
+{
+}
+
+
+CppUnit::Test* HTTPAsyncClientTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTPAsyncClientTest");
+
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testGet);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testPost);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testHead);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testUntilClose);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testKeepAlive);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testServerClose);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testNoRetry);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testCallback);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testTimeout);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testConnectionRefused);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testUnresolvableHost);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testMaxConnections);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testClose);
+	CppUnit_addTest(pSuite, HTTPAsyncClientTest, testLoad);
+
+	return pSuite;
+}
@@ -0,0 +1,53 @@
+//
+// HTTPAsyncClientTest.h
+//
+// $Id$
+//
+// Definition of the HTTPAsyncClientTest class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef HTTPAsyncClientTest_INCLUDED
+#define HTTPAsyncClientTest_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "CppUnit/TestCase.h"
+
+
+class HTTPAsyncClientTest: public CppUnit::TestCase
+{
+public:
+	HTTPAsyncClientTest(const std::string& name);
+	~HTTPAsyncClientTest();
+
+	void testGet();
+	void testPost();
+	void testHead();
+	void testUntilClose();
+	void testKeepAlive();
+	void testServerClose();
+	void testNoRetry();
+	void testCallback();
+	void testTimeout();
+	void testConnectionRefused();
+	void testUnresolvableHost();
+	void testMaxConnections();
+	void testClose();
+	void testLoad();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // HTTPAsyncClientTest_INCLUDED
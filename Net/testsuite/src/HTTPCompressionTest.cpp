@@ -0,0 +1,505 @@
+//
+// HTTPCompressionTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "HTTPCompressionTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/HTTPCompression.h"
+#include "Poco/Net/HTTPCompressionCache.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/InflatingStream.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/TemporaryFile.h"
+#include "Poco/FileStream.h"
+#include "Poco/Timestamp.h"
+#include <sstream>
+#include <vector>
+
+
+using Poco::Net::HTTPCompression;
+using Poco::Net::HTTPCompressionCache;
+using Poco::Net::HTTPServer;
+using Poco::Net::HTTPServerParams;
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPRequestHandlerFactory;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+using Poco::Net::HTTPClientSession;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPMessage;
+using Poco::Net::ServerSocket;
+using Poco::InflatingInputStream;
+using Poco::InflatingStreamBuf;
+using Poco::StreamCopier;
+using Poco::TemporaryFile;
+
+
+namespace
+{
+	std::string text()
+	{
+		std::string body;
+		for (int i = 0; i < 1000; ++i)
+		{
+			body += "The quick brown fox jumps over the lazy dog. ";
+		}
+		return body;
+	}
+
+	std::string inflate(const std::string& data, InflatingStreamBuf::StreamType type)
+	{
+		std::istringstream istr(data);
+		InflatingInputStream inflater(istr, type);
+		std::string result;
+		StreamCopier::copyToString(inflater, result);
+		return result;
+	}
+
+	class CompressionRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		CompressionRequestHandler(const std::string& path):
+			_path(path)
+		{
+		}
+
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			const std::string& uri = request.getURI();
+			if (uri == "/stream")
+			{
+				response.setContentType("text/plain");
+				std::ostream& ostr = response.send();
+				std::string body = text();
+				for (std::size_t i = 0; i < body.size(); i += 1000)
+				{
+					ostr << body.substr(i, 1000);
+				}
+			}
+			else if (uri == "/buffer")
+			{
+				response.setContentType("application/json; charset=utf-8");
+				std::string body = text();
+				response.sendBuffer(body.data(), body.size());
+			}
+			else if (uri == "/small")
+			{
+				response.setContentType("text/plain");
+				response.sendBuffer("hello", 5);
+			}
+			else if (uri == "/image")
+			{
+				response.setContentType("image/png");
+				std::string body = text();
+				response.sendBuffer(body.data(), body.size());
+			}
+			else if (uri == "/encoded")
+			{
+				response.setContentType("text/plain");
+				response.set("Content-Encoding", "identity");
+				std::string body = text();
+				response.sendBuffer(body.data(), body.size());
+			}
+			else if (uri == "/etag")
+			{
+				response.setContentType("text/plain");
+				response.set("ETag", "\"v1\"");
+				std::string body = text();
+				response.sendBuffer(body.data(), body.size());
+			}
+			else if (uri == "/etag/weak")
+			{
+				response.setContentType("text/plain");
+				response.set("ETag", "W/\"v1\"");
+				response.send() << text();
+			}
+			else if (uri == "/file")
+			{
+				response.sendFile(_path, "text/html");
+			}
+			else
+			{
+				response.setStatusAndReason(HTTPResponse::HTTP_NOT_FOUND);
+				response.setContentType("text/plain");
+				std::string body = text();
+				response.sendBuffer(body.data(), body.size());
+			}
+		}
+
+	private:
+		std::string _path;
+	};
+
+	class CompressionRequestHandlerFactory: public HTTPRequestHandlerFactory
+	{
+	public:
+		CompressionRequestHandlerFactory(const std::string& path = ""):
+			_path(path)
+		{
+		}
+
+		HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
+		{
+			return new CompressionRequestHandler(_path);
+		}
+
+	private:
+		std::string _path;
+	};
+
+	HTTPServerParams::Ptr compressionParams()
+	{
+		HTTPServerParams::Ptr pParams = new HTTPServerParams;
+		pParams->setCompressionEnabled(true);
+		return pParams;
+	}
+
+	std::string get(HTTPClientSession& cs, const std::string& uri, const std::string& acceptEncoding, HTTPResponse& response)
+	{
+		HTTPRequest request(HTTPRequest::HTTP_GET, uri, HTTPMessage::HTTP_1_1);
+		if (!acceptEncoding.empty()) request.set("Accept-Encoding", acceptEncoding);
+		cs.sendRequest(request);
+		std::istream& rs = cs.receiveResponse(response);
+		std::string body;
+		StreamCopier::copyToString(rs, body);
+		return body;
+	}
+
+	void head(HTTPClientSession& cs, const std::string& uri, const std::string& acceptEncoding, HTTPResponse& response)
+	{
+		HTTPRequest request(HTTPRequest::HTTP_HEAD, uri, HTTPMessage::HTTP_1_1);
+		if (!acceptEncoding.empty()) request.set("Accept-Encoding", acceptEncoding);
+		cs.sendRequest(request);
+		cs.receiveResponse(response);
+	}
+}
+
+
+HTTPCompressionTest::HTTPCompressionTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+HTTPCompressionTest::~HTTPCompressionTest()
+{
+}
+
+
+void HTTPCompressionTest::testNegotiate()
+{
+	assert (HTTPCompression::negotiate("gzip") == "gzip");
+	assert (HTTPCompression::negotiate("x-gzip") == "gzip");
+	assert (HTTPCompression::negotiate("deflate") == "deflate");
+	assert (HTTPCompression::negotiate("gzip, deflate, br") == "gzip");
+	assert (HTTPCompression::negotiate("deflate, gzip") == "gzip");
+	assert (HTTPCompression::negotiate("GZIP;q=0.5, deflate;q=0.8") == "deflate");
+	assert (HTTPCompression::negotiate("gzip;q=0, deflate") == "deflate");
+	assert (HTTPCompression::negotiate("gzip;q=0, deflate;q=0") == "");
+	assert (HTTPCompression::negotiate("*") == "gzip");
+	assert (HTTPCompression::negotiate("gzip;q=0, *") == "deflate");
+	assert (HTTPCompression::negotiate("*;q=0") == "");
+	assert (HTTPCompression::negotiate("identity") == "");
+	assert (HTTPCompression::negotiate("br") == "");
+	assert (HTTPCompression::negotiate("") == "");
+}
+
+
+void HTTPCompressionTest::testCompressible()
+{
+	std::vector<std::string> mediaTypes;
+	mediaTypes.push_back("text/*");
+	mediaTypes.push_back("application/json");
+
+	assert (HTTPCompression::isCompressible("text/html", mediaTypes));
+	assert (HTTPCompression::isCompressible("text/plain; charset=utf-8", mediaTypes));
+	assert (HTTPCompression::isCompressible("Application/JSON", mediaTypes));
+	assert (HTTPCompression::isCompressible("application/json;charset=utf-8", mediaTypes));
+	assert (!HTTPCompression::isCompressible("application/jsonp", mediaTypes));
+	assert (!HTTPCompression::isCompressible("image/png", mediaTypes));
+	assert (!HTTPCompression::isCompressible("text/", mediaTypes));
+	assert (!HTTPCompression::isCompressible("text", mediaTypes));
+	assert (!HTTPCompression::isCompressible("", mediaTypes));
+}
+
+
+void HTTPCompressionTest::testStream()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new CompressionRequestHandlerFactory, svs, compressionParams());
+	srv.start();
+
+	HTTPClientSession cs("localhost", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPResponse response;
+	std::string body = get(cs, "/stream", "gzip, deflate", response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.get("Content-Encoding") == "gzip");
+	assert (response.get("Vary") == "Accept-Encoding");
+	assert (response.getChunkedTransferEncoding());
+	assert (!response.hasContentLength());
+	assert (response.getKeepAlive());
+	assert (body.size() < text().size()/10);
+	assert (inflate(body, InflatingStreamBuf::STREAM_GZIP) == text());
+
+	// the connection must still be usable
+	body = get(cs, "/stream", "deflate", response);
+	assert (response.get("Content-Encoding") == "deflate");
+	assert (inflate(body, InflatingStreamBuf::STREAM_ZLIB) == text());
+
+	body = get(cs, "/stream", "", response);
+	assert (!response.has("Content-Encoding"));
+	assert (response.get("Vary") == "Accept-Encoding");
+	assert (body == text());
+}
+
+
+void HTTPCompressionTest::testBuffer()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new CompressionRequestHandlerFactory, svs, compressionParams());
+	srv.start();
+
+	HTTPClientSession cs("localhost", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPResponse response;
+	std::string body = get(cs, "/buffer", "gzip", response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.get("Content-Encoding") == "gzip");
+	assert (response.getContentLength() == body.size());
+	assert (!response.getChunkedTransferEncoding());
+	assert (inflate(body, InflatingStreamBuf::STREAM_GZIP) == text());
+
+	body = get(cs, "/buffer", "deflate;q=1, gzip;q=0.1", response);
+	assert (response.get("Content-Encoding") == "deflate");
+	assert (response.getContentLength() == body.size());
+	assert (inflate(body, InflatingStreamBuf::STREAM_ZLIB) == text());
+
+}
+
+
+void HTTPCompressionTest::testNotCompressed()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new CompressionRequestHandlerFactory, svs, compressionParams());
+	srv.start();
+
+	HTTPClientSession cs("localhost", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPResponse response;
+
+	// below the minimum size
+	std::string body = get(cs, "/small", "gzip", response);
+	assert (!response.has("Content-Encoding"));
+	assert (body == "hello");
+
+	// not a compressible media type
+	body = get(cs, "/image", "gzip", response);
+	assert (!response.has("Content-Encoding"));
+	assert (!response.has("Vary"));
+	assert (body == text());
+
+	// already encoded by the handler
+	body = get(cs, "/encoded", "gzip", response);
+	assert (response.get("Content-Encoding") == "identity");
+	assert (body == text());
+
+	// not a successful response
+	body = get(cs, "/missing", "gzip", response);
+	assert (response.getStatus() == HTTPResponse::HTTP_NOT_FOUND);
+	assert (!response.has("Content-Encoding"));
+	assert (body == text());
+
+	// not enabled
+	ServerSocket svs2(0);
+	HTTPServer srv2(new CompressionRequestHandlerFactory, svs2, new HTTPServerParams);
+	srv2.start();
+	HTTPClientSession cs2("localhost", svs2.address().port());
+	body = get(cs2, "/stream", "gzip", response);
+	assert (!response.has("Content-Encoding"));
+	assert (!response.has("Vary"));
+	assert (body == text());
+}
+
+
+void HTTPCompressionTest::testFileCache()
+{
+	TemporaryFile file;
+	{
+		Poco::FileOutputStream ostr(file.path());
+		ostr << text();
+	}
+	HTTPServerParams::Ptr pParams = compressionParams();
+	HTTPCompressionCache::Ptr pCache = pParams->getCompressionCache();
+	assert (!pCache.isNull());
+	assert (pCache->size() == 0);
+
+	ServerSocket svs(0);
+	HTTPServer srv(new CompressionRequestHandlerFactory(file.path()), svs, pParams);
+	srv.start();
+
+	HTTPClientSession cs("localhost", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPResponse response;
+	std::string body = get(cs, "/file", "gzip", response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.get("Content-Encoding") == "gzip");
+	assert (response.getContentLength() == body.size());
+	assert (response.has("Last-Modified"));
+	assert (inflate(body, InflatingStreamBuf::STREAM_GZIP) == text());
+	assert (pCache->size() == 1);
+
+	std::string cached = get(cs, "/file", "gzip", response);
+	assert (cached == body);
+	assert (pCache->size() == 1);
+
+	body = get(cs, "/file", "deflate", response);
+	assert (response.get("Content-Encoding") == "deflate");
+	assert (inflate(body, InflatingStreamBuf::STREAM_ZLIB) == text());
+	assert (pCache->size() == 2);
+
+	body = get(cs, "/file", "", response);
+	assert (!response.has("Content-Encoding"));
+	assert (body == text());
+
+	// a modified file must be compressed again
+	{
+		Poco::FileOutputStream ostr(file.path());
+		ostr << "modified " << text();
+	}
+	file.setLastModified(Poco::Timestamp() + 10*Poco::Timestamp::resolution());
+	body = get(cs, "/file", "gzip", response);
+	assert (inflate(body, InflatingStreamBuf::STREAM_GZIP) == "modified " + text());
+	assert (pCache->size() == 2);
+
+	pCache->clear();
+	assert (pCache->size() == 0);
+
+	// files larger than the maximum size are streamed
+	pParams->setCompressionCache(new HTTPCompressionCache(16, 1024));
+	body = get(cs, "/file", "gzip", response);
+	assert (response.get("Content-Encoding") == "gzip");
+	assert (response.getChunkedTransferEncoding());
+	assert (inflate(body, InflatingStreamBuf::STREAM_GZIP) == "modified " + text());
+	assert (pParams->getCompressionCache()->size() == 0);
+}
+
+
+void HTTPCompressionTest::testHead()
+{
+	TemporaryFile file;
+	{
+		Poco::FileOutputStream ostr(file.path());
+		ostr << text();
+	}
+	ServerSocket svs(0);
+	HTTPServer srv(new CompressionRequestHandlerFactory(file.path()), svs, compressionParams());
+	srv.start();
+
+	HTTPClientSession cs("localhost", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPResponse getResponse;
+	HTTPResponse headResponse;
+
+	std::string body = get(cs, "/buffer", "gzip", getResponse);
+	head(cs, "/buffer", "gzip", headResponse);
+	assert (headResponse.getStatus() == HTTPResponse::HTTP_OK);
+	assert (headResponse.get("Content-Encoding") == "gzip");
+	assert (headResponse.get("Vary") == "Accept-Encoding");
+	assert (headResponse.getContentLength() == body.size());
+	assert (headResponse.getContentLength() == getResponse.getContentLength());
+
+	body = get(cs, "/file", "deflate", getResponse);
+	head(cs, "/file", "deflate", headResponse);
+	assert (headResponse.get("Content-Encoding") == "deflate");
+	assert (headResponse.get("Vary") == "Accept-Encoding");
+	assert (headResponse.getContentLength() == body.size());
+
+	get(cs, "/stream", "gzip", getResponse);
+	head(cs, "/stream", "gzip", headResponse);
+	assert (headResponse.get("Content-Encoding") == "gzip");
+	assert (headResponse.get("Vary") == "Accept-Encoding");
+	assert (headResponse.getChunkedTransferEncoding() == getResponse.getChunkedTransferEncoding());
+	assert (!headResponse.hasContentLength());
+
+	head(cs, "/buffer", "", headResponse);
+	assert (!headResponse.has("Content-Encoding"));
+	assert (headResponse.getContentLength() == text().size());
+
+	// the connection must still be usable
+	body = get(cs, "/buffer", "gzip", getResponse);
+	assert (inflate(body, InflatingStreamBuf::STREAM_GZIP) == text());
+}
+
+
+void HTTPCompressionTest::testETag()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new CompressionRequestHandlerFactory, svs, compressionParams());
+	srv.start();
+
+	HTTPClientSession cs("localhost", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPResponse response;
+
+	get(cs, "/etag", "gzip", response);
+	assert (response.get("Content-Encoding") == "gzip");
+	assert (response.get("ETag") == "W/\"v1\"");
+
+	head(cs, "/etag", "gzip", response);
+	assert (response.get("ETag") == "W/\"v1\"");
+
+	get(cs, "/etag", "", response);
+	assert (!response.has("Content-Encoding"));
+	assert (response.get("ETag") == "\"v1\"");
+
+	std::string body = get(cs, "/etag/weak", "deflate", response);
+	assert (response.get("Content-Encoding") == "deflate");
+	assert (response.get("ETag") == "W/\"v1\"");
+	assert (inflate(body, InflatingStreamBuf::STREAM_ZLIB) == text());
+}
+
+
+void HTTPCompressionTest::setUp()
+{
+}
+
+
+void HTTPCompressionTest::tearDown()
+{
+}
+
+
+CppUnit::Test* HTTPCompressionTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTPCompressionTest");
+
+	CppUnit_addTest(pSuite, HTTPCompressionTest, testNegotiate);
+	CppUnit_addTest(pSuite, HTTPCompressionTest, testCompressible);
+	CppUnit_addTest(pSuite, HTTPCompressionTest, testStream);
+	CppUnit_addTest(pSuite, HTTPCompressionTest, testBuffer);
+	CppUnit_addTest(pSuite, HTTPCompressionTest, testNotCompressed);
+	CppUnit_addTest(pSuite, HTTPCompressionTest, testFileCache);
+	CppUnit_addTest(pSuite, HTTPCompressionTest, testHead);
+	CppUnit_addTest(pSuite, HTTPCompressionTest, testETag);
+
+	return pSuite;
+}
@@ -0,0 +1,47 @@
+//
+// HTTPCompressionTest.h
+//
+// $Id$
+//
+// Definition of the HTTPCompressionTest class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef HTTPCompressionTest_INCLUDED
+#define HTTPCompressionTest_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "CppUnit/TestCase.h"
+
+
+class HTTPCompressionTest: public CppUnit::TestCase
+{
+public:
+	HTTPCompressionTest(const std::string& name);
+	~HTTPCompressionTest();
+
+	void testNegotiate();
+	void testCompressible();
+	void testStream();
+	void testBuffer();
+	void testNotCompressed();
+	void testFileCache();
+	void testHead();
+	void testETag();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // HTTPCompressionTest_INCLUDED
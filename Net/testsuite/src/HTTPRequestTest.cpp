@@ -15,13 +15,16 @@
 #include "CppUnit/TestSuite.h"
 #include "Poco/Net/HTTPRequest.h"
 #include "Poco/Net/NetException.h"
+#include "Poco/Stopwatch.h"
 #include <sstream>
+#include <iostream>
 
 
 using Poco::Net::HTTPRequest;
 using Poco::Net::HTTPMessage;
 using Poco::Net::MessageException;
 using Poco::Net::NameValueCollection;
+using Poco::Stopwatch;
 
 
 HTTPRequestTest::HTTPRequestTest(const std::string& name): CppUnit::TestCase(name)
@@ -154,6 +157,51 @@ void HTTPRequestTest::testRead4()
 }
 
 
+void HTTPRequestTest::testRead5()
+{
+	std::string s("\r\nGET  /a?b=c   HTTP/1.1 \r\nHost: localhost\r\nX-Folded: one\r\n two\r\n\r\nbody");
+	std::istringstream istr(s);
+	HTTPRequest request;
+	request.read(istr);
+	assert (request.getMethod() == HTTPRequest::HTTP_GET);
+	assert (request.getURI() == "/a?b=c");
+	assert (request.getVersion() == HTTPMessage::HTTP_1_1);
+	assert (request.size() == 2);
+	assert (request["Host"] == "localhost");
+	assert (request["X-Folded"] == "one two");
+	std::string rest;
+	istr >> rest;
+	assert (rest == "body");
+}
+
+
+void HTTPRequestTest::testReadPerformance()
+{
+	std::string s("GET /index.html?page=1 HTTP/1.1\r\n"
+		"Host: www.example.com\r\n"
+		"User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:52.0) Gecko/20100101 Firefox/52.0\r\n"
+		"Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+		"Accept-Language: en-US,en;q=0.5\r\n"
+		"Accept-Encoding: gzip, deflate\r\n"
+		"Cookie: session=0123456789abcdef0123456789abcdef; theme=dark\r\n"
+		"Connection: keep-alive\r\n"
+		"Cache-Control: max-age=0\r\n"
+		"\r\n");
+	const int count = 100000;
+	Stopwatch sw;
+	sw.start();
+	for (int i = 0; i < count; ++i)
+	{
+		std::istringstream istr(s);
+		HTTPRequest request;
+		request.read(istr);
+		assert (request.size() == 8);
+	}
+	sw.stop();
+	std::cout << "parsed " << count << " requests in " << sw.elapsed()/1000 << " ms" << std::endl;
+}
+
+
 void HTTPRequestTest::testInvalid1()
 {
 	std::string s(256, 'x');
@@ -204,6 +252,22 @@ void HTTPRequestTest::testInvalid3()
 }
 
 
+void HTTPRequestTest::testInvalid4()
+{
+	std::string s("GET\r\nHost: localhost\r\n\r\n");
+	std::istringstream istr(s);
+	HTTPRequest request;
+	try
+	{
+		request.read(istr);
+		fail("inavalid request - must throw");
+	}
+	catch (MessageException&)
+	{
+	}
+}
+
+
 void HTTPRequestTest::testCookies()
 {
 	HTTPRequest request1;
@@ -238,6 +302,37 @@ void HTTPRequestTest::testCookies()
 }
 
 
+void HTTPRequestTest::testURIView()
+{
+	std::string s("GET /search?q=hello+world&page=2 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+	std::istringstream istr(s);
+	HTTPRequest request;
+	request.read(istr);
+	const Poco::URIView& view = request.getURIView();
+	assert (view.path() == "/search");
+	assert (view.query() == "q=hello+world&page=2");
+	assert (&request.getURIView() == &view);
+	std::string value;
+	assert (view.getQueryParameter("q", value));
+	assert (value == "hello world");
+
+	request.setURI("/index.html#top");
+	assert (request.getURIView().path() == "/index.html");
+	assert (request.getURIView().query().empty());
+	assert (request.getURIView().fragment() == "top");
+
+	request.setURI("http://localhost:0/");
+	try
+	{
+		request.getURIView();
+		fail ("bad port - must throw");
+	}
+	catch (Poco::SyntaxException&)
+	{
+	}
+}
+
+
 void HTTPRequestTest::setUp()
 {
 }
@@ -260,10 +355,14 @@ CppUnit::Test* HTTPRequestTest::suite()
 	CppUnit_addTest(pSuite, HTTPRequestTest, testRead2);
 	CppUnit_addTest(pSuite, HTTPRequestTest, testRead3);
 	CppUnit_addTest(pSuite, HTTPRequestTest, testRead4);
+	CppUnit_addTest(pSuite, HTTPRequestTest, testRead5);
+	CppUnit_addTest(pSuite, HTTPRequestTest, testReadPerformance);
 	CppUnit_addTest(pSuite, HTTPRequestTest, testInvalid1);
 	CppUnit_addTest(pSuite, HTTPRequestTest, testInvalid2);
 	CppUnit_addTest(pSuite, HTTPRequestTest, testInvalid3);
+	CppUnit_addTest(pSuite, HTTPRequestTest, testInvalid4);
 	CppUnit_addTest(pSuite, HTTPRequestTest, testCookies);
+	CppUnit_addTest(pSuite, HTTPRequestTest, testURIView);
 
 	return pSuite;
 }
@@ -34,10 +34,14 @@ public:
 	void testRead2();
 	void testRead3();
 	void testRead4();
+	void testRead5();
+	void testReadPerformance();
 	void testInvalid1();
 	void testInvalid2();
 	void testInvalid3();
+	void testInvalid4();
 	void testCookies();
+	void testURIView();
 	
 	void setUp();
 	void tearDown();
@@ -0,0 +1,490 @@
+//
+// HTTPRouterTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "HTTPRouterTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/HTTPRouter.h"
+#include "Poco/Net/HTTPRouteMatch.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/AtomicCounter.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Exception.h"
+#include <iostream>
+#include <vector>
+
+
+using Poco::Net::HTTPRouter;
+using Poco::Net::HTTPRouteMatch;
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPServer;
+using Poco::Net::HTTPServerParams;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+using Poco::Net::HTTPClientSession;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::ServerSocket;
+using Poco::AtomicCounter;
+using Poco::StreamCopier;
+using Poco::NumberFormatter;
+
+
+namespace
+{
+	class RouteRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		RouteRequestHandler(const std::string& name):
+			_name(name)
+		{
+			++instances;
+		}
+
+		~RouteRequestHandler()
+		{
+			--instances;
+		}
+
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			const HTTPRouteMatch& match = HTTPRouter::currentMatch();
+			std::string body = _name;
+			for (std::size_t i = 0; i < match.count(); ++i)
+			{
+				body += ' ';
+				body += match.name(i);
+				body += '=';
+				body += match.value(i);
+			}
+			response.setContentType("text/plain");
+			response.setContentLength((int) body.size());
+			response.send() << body;
+		}
+
+		static AtomicCounter instances;
+
+	private:
+		std::string _name;
+	};
+
+	AtomicCounter RouteRequestHandler::instances;
+
+	HTTPRouter::HandlerPtr handler(const std::string& name)
+	{
+		return new RouteRequestHandler(name);
+	}
+
+	std::string pattern(HTTPRouter& router, const std::string& method, const std::string& uri)
+	{
+		HTTPRouteMatch match;
+		if (router.match(method, uri, match))
+			return match.pattern();
+		else
+			return "";
+	}
+}
+
+
+HTTPRouterTest::HTTPRouterTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+HTTPRouterTest::~HTTPRouterTest()
+{
+}
+
+
+void HTTPRouterTest::testStatic()
+{
+	HTTPRouter router;
+	HTTPRouter::HandlerPtr pHandler = handler("static");
+	const char* patterns[] =
+	{
+		"/", "/index.html", "/in", "/inbox", "/info", "/info/", "/contact", "/con", "/a/b/c", "/a/b", "/a"
+	};
+	const std::size_t count = sizeof(patterns)/sizeof(patterns[0]);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		router.addRoute(HTTPRequest::HTTP_GET, patterns[i], pHandler);
+	}
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		assert (pattern(router, HTTPRequest::HTTP_GET, patterns[i]) == patterns[i]);
+	}
+	assert (pattern(router, HTTPRequest::HTTP_GET, "/index.html?x=y") == "/index.html");
+	assert (pattern(router, HTTPRequest::HTTP_GET, "/info#top") == "/info");
+	assert (pattern(router, HTTPRequest::HTTP_GET, "http://www.appinf.com/inbox") == "/inbox");
+	assert (pattern(router, HTTPRequest::HTTP_GET, "/i").empty());
+	assert (pattern(router, HTTPRequest::HTTP_GET, "/inf").empty());
+	assert (pattern(router, HTTPRequest::HTTP_GET, "/index").empty());
+	assert (pattern(router, HTTPRequest::HTTP_GET, "/a/b/c/d").empty());
+	assert (pattern(router, HTTPRequest::HTTP_GET, "/a/").empty());
+	assert (pattern(router, HTTPRequest::HTTP_GET, "").empty());
+	assert (pattern(router, HTTPRequest::HTTP_GET, "*").empty());
+}
+
+
+void HTTPRouterTest::testParameters()
+{
+	HTTPRouter router;
+	HTTPRouter::HandlerPtr pHandler = handler("param");
+	router.addRoute(HTTPRequest::HTTP_GET, "/users/{id}", pHandler);
+	router.addRoute(HTTPRequest::HTTP_GET, "/users/me", pHandler);
+	router.addRoute(HTTPRequest::HTTP_GET, "/users/{id}/orders/{order}", pHandler);
+	router.addRoute(HTTPRequest::HTTP_GET, "/users/me/orders/latest", pHandler);
+	router.addRoute(HTTPRequest::HTTP_GET, "/{section}/about", pHandler);
+
+	HTTPRouteMatch match;
+	std::string uri("/users/42?verbose=1");
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/users/{id}");
+	assert (match.count() == 1);
+	assert (match.name(0) == "id");
+	assert (match.value(0) == "42");
+	assert (std::string(match.data(0), match.length(0)) == "42");
+	assert (match.has("id"));
+	assert (match.get("id") == "42");
+	assert (!match.has("order"));
+	assert (match.get("order", "none") == "none");
+	try
+	{
+		match.get("order");
+		fail ("no such parameter - must throw");
+	}
+	catch (Poco::NotFoundException&)
+	{
+	}
+
+	uri = "/users/me";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/users/me");
+	assert (match.count() == 0);
+
+	uri = "/users/meself";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/users/{id}");
+	assert (match.get("id") == "meself");
+
+	uri = "/users/42/orders/7";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/users/{id}/orders/{order}");
+	assert (match.count() == 2);
+	assert (match.get("id") == "42");
+	assert (match.get("order") == "7");
+
+	// the literal "me" does not lead to a route,
+	// so the parameter route must be used
+	uri = "/users/me/orders/7";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/users/{id}/orders/{order}");
+	assert (match.get("id") == "me");
+
+	uri = "/users/about";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/users/{id}");
+
+	uri = "/users/about/x";
+	assert (!router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.count() == 0);
+
+	uri = "/news/about";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/{section}/about");
+	assert (match.get("section") == "news");
+
+	uri = "/users/";
+	assert (!router.match(HTTPRequest::HTTP_GET, uri, match));
+	uri = "/users//orders/7";
+	assert (!router.match(HTTPRequest::HTTP_GET, uri, match));
+}
+
+
+void HTTPRouterTest::testCatchAll()
+{
+	HTTPRouter router;
+	HTTPRouter::HandlerPtr pHandler = handler("files");
+	router.addRoute(HTTPRequest::HTTP_GET, "/static/{path*}", pHandler);
+	router.addRoute(HTTPRequest::HTTP_GET, "/static/index.html", pHandler);
+	router.addRoute(HTTPRequest::HTTP_GET, "/{user}/files/{path*}", pHandler);
+
+	HTTPRouteMatch match;
+	std::string uri("/static/css/site.css?v=2");
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/static/{path*}");
+	assert (match.get("path") == "css/site.css");
+
+	uri = "/static/";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.get("path") == "");
+
+	uri = "/static/index.html";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.pattern() == "/static/index.html");
+
+	uri = "/static/index.htm";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.get("path") == "index.htm");
+
+	uri = "/static";
+	assert (!router.match(HTTPRequest::HTTP_GET, uri, match));
+
+	uri = "/guest/files/a/b/c";
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.count() == 2);
+	assert (match.get("user") == "guest");
+	assert (match.get("path") == "a/b/c");
+}
+
+
+void HTTPRouterTest::testMethods()
+{
+	HTTPRouter router;
+	router.addRoute(HTTPRequest::HTTP_GET, "/items", handler("list"));
+	router.addRoute(HTTPRequest::HTTP_POST, "/items", handler("create"));
+	router.addRoute(HTTPRequest::HTTP_DELETE, "/items/{id}", handler("delete"));
+	router.addRoute(HTTPRouter::ANY_METHOD, "/any", handler("any"));
+	router.addRoute(HTTPRequest::HTTP_GET, "/any", handler("get"));
+
+	HTTPRouteMatch match;
+	std::string uri("/items");
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (router.match(HTTPRequest::HTTP_POST, uri, match));
+	assert (router.match(HTTPRequest::HTTP_HEAD, uri, match));
+	assert (!router.match(HTTPRequest::HTTP_PUT, uri, match));
+	assert (match.allowedMethods() == "GET, POST, HEAD");
+
+	uri = "/items/1";
+	assert (router.match(HTTPRequest::HTTP_DELETE, uri, match));
+	assert (!router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.allowedMethods() == "DELETE");
+
+	uri = "/any";
+	assert (router.match(HTTPRequest::HTTP_PUT, uri, match));
+	assert (router.match(HTTPRequest::HTTP_GET, uri, match));
+
+	uri = "/none";
+	assert (!router.match(HTTPRequest::HTTP_GET, uri, match));
+	assert (match.allowedMethods().empty());
+
+	try
+	{
+		router.addRoute(HTTPRequest::HTTP_GET, "/items", handler("list"));
+		fail ("route exists - must throw");
+	}
+	catch (Poco::ExistsException&)
+	{
+	}
+}
+
+
+void HTTPRouterTest::testInvalidPatterns()
+{
+	const char* patterns[] =
+	{
+		"", "items", "/items/{", "/items/{}", "/items/{id", "/items/id}", "/items/x{id}",
+		"/items/{id}x", "/items/{path*}/x", "/items/{a/b}", "/items/{*}",
+		"/{a}/{b}/{c}/{d}/{e}/{f}/{g}/{h}/{i}/{j}/{k}/{l}/{m}/{n}/{o}/{p}/{q}"
+	};
+	HTTPRouter router;
+	for (std::size_t i = 0; i < sizeof(patterns)/sizeof(patterns[0]); ++i)
+	{
+		try
+		{
+			router.addRoute(HTTPRequest::HTTP_GET, patterns[i], handler("invalid"));
+			fail ("invalid pattern - must throw");
+		}
+		catch (Poco::InvalidArgumentException&)
+		{
+		}
+	}
+
+	router.addRoute(HTTPRequest::HTTP_GET, "/users/{id}", handler("user"));
+	try
+	{
+		router.addRoute(HTTPRequest::HTTP_GET, "/users/{name}/profile", handler("profile"));
+		fail ("conflicting parameter name - must throw");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+}
+
+
+void HTTPRouterTest::testServer()
+{
+	int instances = RouteRequestHandler::instances.value();
+	HTTPRouter* pRouter = new HTTPRouter;
+	pRouter->addRoute(HTTPRequest::HTTP_GET, "/users/{id}", handler("user"));
+	pRouter->addRoute(HTTPRequest::HTTP_POST, "/users", handler("create"));
+	assert (RouteRequestHandler::instances.value() == instances + 2);
+
+	ServerSocket svs(0);
+	HTTPServer srv(pRouter, svs, new HTTPServerParams);
+	srv.start();
+
+	HTTPClientSession cs("localhost", svs.address().port());
+	for (int i = 0; i < 10; ++i)
+	{
+		HTTPRequest request(HTTPRequest::HTTP_GET, "/users/" + NumberFormatter::format(i), HTTPRequest::HTTP_1_1);
+		cs.sendRequest(request);
+		HTTPResponse response;
+		std::string body;
+		StreamCopier::copyToString(cs.receiveResponse(response), body);
+		assert (response.getStatus() == HTTPResponse::HTTP_OK);
+		assert (body == "user id=" + NumberFormatter::format(i));
+	}
+	// handlers are reused, not created per request
+	assert (RouteRequestHandler::instances.value() == instances + 2);
+
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/unknown", HTTPRequest::HTTP_1_1);
+	cs.sendRequest(request);
+	HTTPResponse response;
+	std::string body;
+	StreamCopier::copyToString(cs.receiveResponse(response), body);
+	assert (response.getStatus() == HTTPResponse::HTTP_NOT_FOUND);
+	assert (body.empty());
+
+	request.setURI("/users");
+	cs.sendRequest(request);
+	StreamCopier::copyToString(cs.receiveResponse(response), body);
+	assert (response.getStatus() == HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+	assert (response.get("Allow") == "POST");
+
+	request.setMethod(HTTPRequest::HTTP_POST);
+	request.setContentLength(0);
+	cs.sendRequest(request);
+	StreamCopier::copyToString(cs.receiveResponse(response), body);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (body == "create");
+
+	srv.stop();
+}
+
+
+void HTTPRouterTest::testRoutingThroughput()
+{
+	// 400 endpoints, as in a typical REST API
+	const char* resources[] =
+	{
+		"users", "orders", "products", "invoices", "customers", "suppliers", "shipments", "payments",
+		"accounts", "reports", "categories", "reviews", "carts", "coupons", "stores", "employees",
+		"departments", "projects", "tasks", "tickets", "messages", "events", "devices", "files", "groups"
+	};
+	const char* actions[] =
+	{
+		"", "/{id}", "/{id}/history", "/{id}/comments", "/{id}/attachments", "/{id}/owner", "/{id}/status",
+		"/{id}/tags", "/search", "/export", "/import", "/stats", "/{id}/audit", "/{id}/links", "/{id}/notes", "/recent"
+	};
+	const std::size_t resourceCount = sizeof(resources)/sizeof(resources[0]);
+	const std::size_t actionCount = sizeof(actions)/sizeof(actions[0]);
+
+	HTTPRouter router;
+	HTTPRouter::HandlerPtr pHandler = handler("bench");
+	std::vector<std::string> patterns;
+	std::vector<std::string> uris;
+	for (std::size_t r = 0; r < resourceCount; ++r)
+	{
+		for (std::size_t a = 0; a < actionCount; ++a)
+		{
+			std::string pattern = std::string("/api/v1/") + resources[r] + actions[a];
+			router.addRoute(HTTPRequest::HTTP_GET, pattern, pHandler);
+			patterns.push_back(pattern);
+			std::string uri = pattern;
+			std::string::size_type pos = uri.find("{id}");
+			if (pos != std::string::npos) uri.replace(pos, 4, "12345");
+			uris.push_back(uri + "?page=2");
+		}
+	}
+	assert (patterns.size() == 400);
+
+	const int iterations = 100;
+	HTTPRouteMatch match;
+	Poco::Timestamp start;
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (std::size_t u = 0; u < uris.size(); ++u)
+		{
+			if (!router.match(HTTPRequest::HTTP_GET, uris[u], match) || match.pattern() != patterns[u])
+				fail ("route not found: " + uris[u]);
+		}
+	}
+	Poco::Timestamp::TimeDiff radix = start.elapsed();
+
+	// the same lookups with a chain of comparisons, as found in
+	// typical request handler factories
+	start.update();
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (std::size_t u = 0; u < uris.size(); ++u)
+		{
+			std::string path = uris[u].substr(0, uris[u].find('?'));
+			std::size_t p = 0;
+			for (; p < patterns.size(); ++p)
+			{
+				const std::string& pattern = patterns[p];
+				std::string::size_type pos = pattern.find("{id}");
+				if (pos == std::string::npos)
+				{
+					if (path == pattern) break;
+				}
+				else if (path.compare(0, pos, pattern, 0, pos) == 0)
+				{
+					std::string::size_type end = path.find('/', pos);
+					if (end == std::string::npos) end = path.size();
+					if (path.compare(end, std::string::npos, pattern, pos + 4, std::string::npos) == 0) break;
+				}
+			}
+			if (p == patterns.size()) fail ("route not found: " + uris[u]);
+		}
+	}
+	Poco::Timestamp::TimeDiff linear = start.elapsed();
+
+	std::cout << "routing " << iterations*uris.size() << " requests to 400 routes: "
+	          << radix/1000 << " ms radix tree, " << linear/1000 << " ms if/else chain" << std::endl;
+}
+
+
+void HTTPRouterTest::setUp()
+{
+}
+
+
+void HTTPRouterTest::tearDown()
+{
+}
+
+
+CppUnit::Test* HTTPRouterTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTPRouterTest");
+
+	CppUnit_addTest(pSuite, HTTPRouterTest, testStatic);
+	CppUnit_addTest(pSuite, HTTPRouterTest, testParameters);
+	CppUnit_addTest(pSuite, HTTPRouterTest, testCatchAll);
+	CppUnit_addTest(pSuite, HTTPRouterTest, testMethods);
+	CppUnit_addTest(pSuite, HTTPRouterTest, testInvalidPatterns);
+	CppUnit_addTest(pSuite, HTTPRouterTest, testServer);
+	CppUnit_addTest(pSuite, HTTPRouterTest, testRoutingThroughput);
+
+	return pSuite;
+}
@@ -0,0 +1,46 @@
+//
+// HTTPRouterTest.h
+//
+// $Id$
+//
+// Definition of the HTTPRouterTest class.
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef HTTPRouterTest_INCLUDED
+#define HTTPRouterTest_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "CppUnit/TestCase.h"
+
+
+class HTTPRouterTest: public CppUnit::TestCase
+{
+public:
+	HTTPRouterTest(const std::string& name);
+	~HTTPRouterTest();
+
+	void testStatic();
+	void testParameters();
+	void testCatchAll();
+	void testMethods();
+	void testInvalidPatterns();
+	void testServer();
+	void testRoutingThroughput();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // HTTPRouterTest_INCLUDED
@@ -23,7 +23,14 @@
 #include "Poco/Net/HTTPResponse.h"
 #include "Poco/Net/HTTPServerResponse.h"
 #include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/ServerSocketImpl.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/StreamSocketImpl.h"
+#include "Poco/Net/SocketStream.h"
+#include "Poco/Net/SocketAddress.h"
 #include "Poco/StreamCopier.h"
+#include "Poco/Thread.h"
+#include "Poco/AtomicCounter.h"
 #include <sstream>
 
 
@@ -39,7 +46,14 @@ using Poco::Net::HTTPResponse;
 using Poco::Net::HTTPServerResponse;
 using Poco::Net::HTTPMessage;
 using Poco::Net::ServerSocket;
+using Poco::Net::ServerSocketImpl;
+using Poco::Net::SocketImpl;
+using Poco::Net::StreamSocket;
+using Poco::Net::StreamSocketImpl;
+using Poco::Net::SocketStream;
+using Poco::Net::SocketAddress;
 using Poco::StreamCopier;
+using Poco::AtomicCounter;
 
 
 namespace
@@ -106,6 +120,82 @@ namespace
 		}
 	};
 	
+	class ChunkedRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			response.setChunkedTransferEncoding(true);
+			response.send() << "body";
+		}
+	};
+	
+	class SlowRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			Poco::Thread::sleep(500);
+			std::string data("slow");
+			response.sendBuffer(data.data(), data.length());
+		}
+	};
+	
+	class CountingStreamSocketImpl: public StreamSocketImpl
+		/// Counts the writes to the socket.
+	{
+	public:
+		CountingStreamSocketImpl(poco_socket_t sockfd, AtomicCounter& writes):
+			StreamSocketImpl(sockfd),
+			_writes(writes)
+		{
+		}
+
+		int sendBytes(const void* buffer, int length, int flags)
+		{
+			++_writes;
+			return StreamSocketImpl::sendBytes(buffer, length, flags);
+		}
+
+	private:
+		AtomicCounter& _writes;
+	};
+
+	class CountingServerSocketImpl: public ServerSocketImpl
+		/// Accepts connections that count their writes.
+	{
+	public:
+		CountingServerSocketImpl(AtomicCounter& writes):
+			_writes(writes)
+		{
+		}
+
+		SocketImpl* acceptConnection(SocketAddress& clientAddr)
+		{
+			char buffer[SocketAddress::MAX_ADDRESS_LENGTH];
+			struct sockaddr* pSA = reinterpret_cast<struct sockaddr*>(buffer);
+			poco_socklen_t saLen = sizeof(buffer);
+			poco_socket_t sd = ::accept(sockfd(), pSA, &saLen);
+			if (sd == POCO_INVALID_SOCKET) error();
+			clientAddr = SocketAddress(pSA, saLen);
+			return new CountingStreamSocketImpl(sd, _writes);
+		}
+
+	private:
+		AtomicCounter& _writes;
+	};
+
+	class CountingServerSocket: public ServerSocket
+	{
+	public:
+		CountingServerSocket(AtomicCounter& writes):
+			ServerSocket(new CountingServerSocketImpl(writes), true)
+		{
+			bind(SocketAddress(), true);
+			listen();
+		}
+	};
+
 	class RequestHandlerFactory: public HTTPRequestHandlerFactory
 	{
 	public:
@@ -121,6 +211,10 @@ namespace
 				return new AuthRequestHandler();
 			else if (request.getURI() == "/buffer")
 				return new BufferRequestHandler();
+			else if (request.getURI() == "/chunked")
+				return new ChunkedRequestHandler();
+			else if (request.getURI() == "/slow")
+				return new SlowRequestHandler();
 			else
 				return 0;
 		}
@@ -518,6 +612,159 @@ void HTTPServerTest::testBuffer()
 }
 
 
+void HTTPServerTest::testPipelining()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(true);
+	HTTPServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+	
+	HTTPClientSession cs("localhost", svs.address().port());
+	cs.setKeepAlive(true);
+	for (int i = 0; i < 3; ++i)
+	{
+		HTTPRequest request("POST", "/echoBody", HTTPMessage::HTTP_1_1);
+		std::string body(i*1000 + 10, static_cast<char>('a' + i));
+		request.setContentLength((int) body.length());
+		request.setContentType("text/plain");
+		cs.sendRequest(request) << body;
+	}
+	HTTPRequest head("HEAD", "/echoHeader", HTTPMessage::HTTP_1_1);
+	cs.sendRequest(head);
+	HTTPRequest buffer("GET", "/buffer", HTTPMessage::HTTP_1_1);
+	cs.sendRequest(buffer);
+	assert (cs.pendingResponses() == 5);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		HTTPResponse response;
+		std::istream& rs = cs.receiveResponse(response);
+		assert (response.getStatus() == HTTPResponse::HTTP_OK);
+		assert (response.getContentLength() == i*1000 + 10);
+		assert (response.getKeepAlive());
+		if (i == 1)
+		{
+			// the unread rest of the body must be skipped
+			assert (rs.get() == 'b');
+		}
+		else
+		{
+			std::string rbody;
+			rs >> rbody;
+			assert (rbody == std::string(i*1000 + 10, static_cast<char>('a' + i)));
+		}
+	}
+	{
+		HTTPResponse response;
+		std::string rbody;
+		cs.receiveResponse(response) >> rbody;
+		assert (response.getStatus() == HTTPResponse::HTTP_OK);
+		assert (response.getContentLength() > 0);
+		assert (rbody.empty());
+	}
+	{
+		HTTPResponse response;
+		std::string rbody;
+		cs.receiveResponse(response) >> rbody;
+		assert (rbody == "xxxxxxxxxx");
+	}
+	assert (cs.pendingResponses() == 0);
+
+	// the session can still be used without pipelining
+	HTTPRequest request("GET", "/buffer", HTTPMessage::HTTP_1_1);
+	cs.sendRequest(request);
+	HTTPResponse response;
+	std::string rbody;
+	cs.receiveResponse(response) >> rbody;
+	assert (rbody == "xxxxxxxxxx");
+}
+
+
+void HTTPServerTest::testPipeliningSlowRequest()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(true);
+	HTTPServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+	
+	// both requests are sent at once, so that the second one
+	// has been received when the first handler returns
+	StreamSocket ss;
+	ss.connect(SocketAddress("localhost", svs.address().port()));
+	std::string requests(
+		"POST /echoBody HTTP/1.1\r\nHost: localhost\r\nContent-Length: 4\r\n\r\nbody"
+		"GET /slow HTTP/1.1\r\nHost: localhost\r\n\r\n");
+	ss.sendBytes(requests.data(), (int) requests.size());
+
+	// the first response must not wait for the slow handler
+	ss.setReceiveTimeout(Poco::Timespan(0, 250000));
+	SocketStream sstr(ss);
+	HTTPResponse response;
+	response.read(sstr);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.getContentLength() == 4);
+	char body[4];
+	sstr.read(body, sizeof(body));
+	assert (sstr.gcount() == 4);
+	assert (std::string(body, 4) == "body");
+
+	ss.setReceiveTimeout(Poco::Timespan(10, 0));
+	HTTPResponse slowResponse;
+	slowResponse.read(sstr);
+	assert (slowResponse.getStatus() == HTTPResponse::HTTP_OK);
+	assert (slowResponse.getContentLength() == 4);
+}
+
+
+void HTTPServerTest::testPipeliningWrites()
+{
+	AtomicCounter writes;
+	CountingServerSocket svs(writes);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(true);
+	HTTPServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	// the responses to pipelined requests are sent together
+	const int count = 10;
+	std::string requests;
+	for (int i = 0; i < count; ++i)
+		requests.append("GET /buffer HTTP/1.1\r\nHost: localhost\r\n\r\n");
+	StreamSocket ss;
+	ss.connect(SocketAddress("localhost", svs.address().port()));
+	ss.setReceiveTimeout(Poco::Timespan(10, 0));
+	ss.sendBytes(requests.data(), (int) requests.size());
+	SocketStream sstr(ss);
+	for (int i = 0; i < count; ++i)
+	{
+		HTTPResponse response;
+		response.read(sstr);
+		assert (response.getStatus() == HTTPResponse::HTTP_OK);
+		assert (response.getContentLength() == 10);
+		char body[10];
+		sstr.read(body, sizeof(body));
+		assert (std::string(body, sizeof(body)) == "xxxxxxxxxx");
+	}
+	assert (writes.value() <= 2);
+
+	// a chunked response is sent with a single write
+	writes = 0;
+	requests = "GET /chunked HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	ss.sendBytes(requests.data(), (int) requests.size());
+	HTTPResponse response;
+	response.read(sstr);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.getChunkedTransferEncoding());
+	std::string chunks("4\r\nbody\r\n0\r\n\r\n");
+	std::string body(chunks.size(), '\0');
+	sstr.read(&body[0], static_cast<std::streamsize>(body.size()));
+	assert (body == chunks);
+	assert (writes.value() == 1);
+}
+
+
 void HTTPServerTest::setUp()
 {
 }
@@ -546,6 +793,9 @@ CppUnit::Test* HTTPServerTest::suite()
 	CppUnit_addTest(pSuite, HTTPServerTest, testAuth);
 	CppUnit_addTest(pSuite, HTTPServerTest, testNotImpl);
 	CppUnit_addTest(pSuite, HTTPServerTest, testBuffer);
+	CppUnit_addTest(pSuite, HTTPServerTest, testPipelining);
+	CppUnit_addTest(pSuite, HTTPServerTest, testPipeliningSlowRequest);
+	CppUnit_addTest(pSuite, HTTPServerTest, testPipeliningWrites);
 
 	return pSuite;
 }
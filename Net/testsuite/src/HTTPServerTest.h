@@ -40,6 +40,9 @@ public:
 	void testAuth();
 	void testNotImpl();
 	void testBuffer();
+	void testPipelining();
+	void testPipeliningSlowRequest();
+	void testPipeliningWrites();
 
 	void setUp();
 	void tearDown();
@@ -12,6 +12,8 @@
 
 #include "HTTPServerTestSuite.h"
 #include "HTTPServerTest.h"
+#include "HTTPRouterTest.h"
+#include "HTTPCompressionTest.h"
 
 
 CppUnit::Test* HTTPServerTestSuite::suite()
@@ -19,6 +21,8 @@ CppUnit::Test* HTTPServerTestSuite::suite()
 	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTPServerTestSuite");
 
 	pSuite->addTest(HTTPServerTest::suite());
+	pSuite->addTest(HTTPRouterTest::suite());
+	pSuite->addTest(HTTPCompressionTest::suite());
 
 	return pSuite;
 }
@@ -179,6 +179,44 @@ void MessageHeaderTest::testReadFolding5()
 }
 
 
+void MessageHeaderTest::testReadMaxValueWhitespace()
+{
+	// whitespace before a value and in folding does not count against the limit
+	const std::size_t MAX_VALUE_LENGTH = 8192;
+	std::string value1(MAX_VALUE_LENGTH, 'x');
+	std::string value2(MAX_VALUE_LENGTH/2 - 1, 'y');
+	std::string s("name1:");
+	s.append(1000, ' ');
+	s.append(value1);
+	s.append("\r\nname2: ");
+	s.append(value2);
+	s.append("\r\n");
+	s.append(1000, '\t');
+	s.append(value2);
+	s.append("\r\n\r\n");
+	std::istringstream istr(s);
+	MessageHeader mh;
+	mh.read(istr);
+	assert (mh.size() == 2);
+	assert (mh["name1"] == value1);
+	assert (mh["name2"] == value2 + "\t" + value2);
+
+	s.assign("name1: ");
+	s.append(value1);
+	s.append("x\r\n\r\n");
+	istr.clear();
+	istr.str(s);
+	try
+	{
+		mh.read(istr);
+		fail("value too long - must throw");
+	}
+	catch (MessageException&)
+	{
+	}
+}
+
+
 void MessageHeaderTest::testReadInvalid1()
 {
 	std::string s("name1: value1\r\nname2: value21\r\n value22\r\n value23\r\n");
@@ -213,6 +251,22 @@ void MessageHeaderTest::testReadInvalid2()
 }
 
 
+void MessageHeaderTest::testReadInvalid3()
+{
+	std::string s("name1: value1\r\nname2: value2\rvalue3\r\n\r\n");
+	std::istringstream istr(s);
+	MessageHeader mh;
+	try
+	{
+		mh.read(istr);
+		fail("malformed message - must throw");
+	}
+	catch (MessageException&)
+	{
+	}
+}
+
+
 void MessageHeaderTest::testSplitElements()
 {
 	std::string s;
@@ -387,8 +441,10 @@ CppUnit::Test* MessageHeaderTest::suite()
 	CppUnit_addTest(pSuite, MessageHeaderTest, testReadFolding3);
 	CppUnit_addTest(pSuite, MessageHeaderTest, testReadFolding4);
 	CppUnit_addTest(pSuite, MessageHeaderTest, testReadFolding5);
+	CppUnit_addTest(pSuite, MessageHeaderTest, testReadMaxValueWhitespace);
 	CppUnit_addTest(pSuite, MessageHeaderTest, testReadInvalid1);
 	CppUnit_addTest(pSuite, MessageHeaderTest, testReadInvalid2);
+	CppUnit_addTest(pSuite, MessageHeaderTest, testReadInvalid3);
 	CppUnit_addTest(pSuite, MessageHeaderTest, testSplitElements);
 	CppUnit_addTest(pSuite, MessageHeaderTest, testSplitParameters);
 	CppUnit_addTest(pSuite, MessageHeaderTest, testFieldLimit);
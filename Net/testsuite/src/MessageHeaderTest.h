@@ -37,8 +37,10 @@ public:
 	void testReadFolding3();
 	void testReadFolding4();
 	void testReadFolding5();
+	void testReadMaxValueWhitespace();
 	void testReadInvalid1();
 	void testReadInvalid2();
+	void testReadInvalid3();
 	void testSplitElements();
 	void testSplitParameters();
 	void testFieldLimit();
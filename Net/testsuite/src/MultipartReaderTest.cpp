@@ -16,12 +16,58 @@
 #include "Poco/Net/MultipartReader.h"
 #include "Poco/Net/MessageHeader.h"
 #include "Poco/Net/NetException.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Timestamp.h"
 #include <sstream>
+#include <iostream>
+#include <vector>
 
 
 using Poco::Net::MultipartReader;
 using Poco::Net::MessageHeader;
 using Poco::Net::MultipartException;
+using Poco::StreamCopier;
+using Poco::Timestamp;
+
+
+namespace
+{
+	class SegmentedStreamBuf: public std::streambuf
+		/// Supplies the first part of a string as if it had
+		/// already been received, and the rest as if it had
+		/// to be waited for, which is recorded.
+	{
+	public:
+		SegmentedStreamBuf(const std::string& data, std::size_t received):
+			_data(data),
+			_received(received),
+			_waited(false)
+		{
+			char* p = const_cast<char*>(_data.data());
+			setg(p, p, p + _received);
+		}
+
+		bool waited() const
+		{
+			return _waited;
+		}
+
+	protected:
+		int_type underflow()
+		{
+			if (egptr() == _data.data() + _data.size()) return traits_type::eof();
+			_waited = true;
+			char* p = const_cast<char*>(_data.data());
+			setg(p, p + _received, p + _data.size());
+			return traits_type::to_int_type(*gptr());
+		}
+
+	private:
+		std::string _data;
+		std::size_t _received;
+		bool        _waited;
+	};
+}
 
 
 MultipartReaderTest::MultipartReaderTest(const std::string& name): CppUnit::TestCase(name)
@@ -352,6 +398,132 @@ void MultipartReaderTest::testUnixLineEnds()
 }
 
 
+void MultipartReaderTest::testBoundaryInData()
+{
+	std::string part1("line 1\r\n--MIME_boundary_0123456\r\n--MIME_boundary_01234567X\r\n\r\n\n--MIME_boundary_01234567 \r\n-");
+	std::string part2("--MIME_boundary_01234567\r--");
+	std::string s("\r\n--MIME_boundary_01234567\r\n\r\n");
+	s.append(part1);
+	s.append("\r\n--MIME_boundary_01234567\r\n\r\n");
+	s.append(part2);
+	s.append("\r\n--MIME_boundary_01234567--\r\n");
+	std::istringstream istr(s);
+	MultipartReader r(istr, "MIME_boundary_01234567");
+	MessageHeader h;
+	r.nextPart(h);
+	std::string part;
+	StreamCopier::copyToString(r.stream(), part);
+	assert (part == part1);
+	assert (r.hasNextPart());
+	r.nextPart(h);
+	part.clear();
+	StreamCopier::copyToString(r.stream(), part);
+	assert (part == part2);
+	assert (!r.hasNextPart());
+}
+
+
+void MultipartReaderTest::testBufferBoundaries()
+{
+	// parts whose delimiters straddle the ends of the internal buffers
+	static const int sizes[] = {0, 1, 8100, 8190, 8191, 8192, 8193, 8200, 65440, 65535, 65536, 65537, 200000};
+	const int nSizes = sizeof(sizes)/sizeof(sizes[0]);
+	std::vector<std::string> parts;
+	std::string s;
+	for (int i = 0; i < nSizes; ++i)
+	{
+		std::string part;
+		part.reserve(sizes[i]);
+		for (int k = 0; k < sizes[i]; ++k)
+		{
+			part += (k % 61 == 60) ? '\n' : (k % 59 == 58) ? '\r' : char('a' + k % 26);
+		}
+		parts.push_back(part);
+		s.append("--MIME_boundary_01234567\r\nname: value\r\n\r\n");
+		s.append(part);
+		s.append("\r\n");
+	}
+	s.append("--MIME_boundary_01234567--\r\n");
+
+	for (int offset = 0; offset < 3; ++offset)
+	{
+		// shift everything relative to the buffers
+		std::istringstream istr(std::string(offset, '\n') + s);
+		MultipartReader r(istr, "MIME_boundary_01234567");
+		for (int i = 0; i < nSizes; ++i)
+		{
+			assert (r.hasNextPart());
+			MessageHeader h;
+			r.nextPart(h);
+			assert (h["name"] == "value");
+			std::string part;
+			StreamCopier::copyToString(r.stream(), part);
+			assert (part == parts[i]);
+		}
+		assert (!r.hasNextPart());
+	}
+}
+
+
+void MultipartReaderTest::testReadAhead()
+{
+	// a part that has been received completely can be
+	// read without waiting for the rest of the message
+	std::string first("--MIME_boundary_01234567\r\nname: value\r\n\r\nhello\r\n--MIME_boundary_01234567\r\n");
+	std::string s(first);
+	s.append("name: value\r\n\r\n");
+	s.append(std::string(20000, 'x'));
+	s.append("\r\n--MIME_boundary_01234567--\r\n");
+
+	SegmentedStreamBuf buf(s, first.size());
+	std::istream istr(&buf);
+	MultipartReader r(istr, "MIME_boundary_01234567");
+	assert (r.hasNextPart());
+	MessageHeader h;
+	r.nextPart(h);
+	std::string part;
+	StreamCopier::copyToString(r.stream(), part);
+	assert (part == "hello");
+	assert (!buf.waited());
+
+	assert (r.hasNextPart());
+	r.nextPart(h);
+	std::string part2;
+	StreamCopier::copyToString(r.stream(), part2);
+	assert (part2 == std::string(20000, 'x'));
+	assert (!r.hasNextPart());
+	assert (buf.waited());
+}
+
+
+void MultipartReaderTest::testThroughput()
+{
+	const std::size_t size = 32*1024*1024;
+	std::string data(size, 'X');
+	for (std::size_t i = 99; i < size; i += 100) data[i] = '\n';
+	std::string s("--MIME_boundary_01234567\r\nContent-Type: application/octet-stream\r\n\r\n");
+	s.append(data);
+	s.append("\r\n--MIME_boundary_01234567--\r\n");
+	data.clear();
+
+	std::istringstream istr(s);
+	Timestamp start;
+	MultipartReader r(istr, "MIME_boundary_01234567");
+	MessageHeader h;
+	r.nextPart(h);
+	char buffer[65536];
+	std::size_t n = 0;
+	while (r.stream().good())
+	{
+		r.stream().read(buffer, sizeof(buffer));
+		n += static_cast<std::size_t>(r.stream().gcount());
+	}
+	Timestamp::TimeDiff elapsed = start.elapsed();
+	assert (n == size);
+	std::cout << "32 MB part: " << elapsed/1000 << " ms, " << (elapsed > 0 ? Poco::UInt64(size)/elapsed : 0) << " MB/s" << std::endl;
+}
+
+
 void MultipartReaderTest::setUp()
 {
 }
@@ -375,6 +547,10 @@ CppUnit::Test* MultipartReaderTest::suite()
 	CppUnit_addTest(pSuite, MultipartReaderTest, testBadBoundary);
 	CppUnit_addTest(pSuite, MultipartReaderTest, testRobustness);
 	CppUnit_addTest(pSuite, MultipartReaderTest, testUnixLineEnds);
+	CppUnit_addTest(pSuite, MultipartReaderTest, testBoundaryInData);
+	CppUnit_addTest(pSuite, MultipartReaderTest, testBufferBoundaries);
+	CppUnit_addTest(pSuite, MultipartReaderTest, testReadAhead);
+	CppUnit_addTest(pSuite, MultipartReaderTest, testThroughput);
 
 	return pSuite;
 }
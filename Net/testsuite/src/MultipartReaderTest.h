@@ -35,6 +35,10 @@ public:
 	void testBadBoundary();
 	void testRobustness();
 	void testUnixLineEnds();
+	void testBoundaryInData();
+	void testBufferBoundaries();
+	void testReadAhead();
+	void testThroughput();
 
 	void setUp();
 	void tearDown();
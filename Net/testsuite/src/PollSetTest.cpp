@@ -0,0 +1,218 @@
+//
+// PollSetTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2005-2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "PollSetTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/PollSet.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Timespan.h"
+#include <vector>
+
+
+using Poco::Net::PollSet;
+using Poco::Net::StreamSocket;
+using Poco::Net::ServerSocket;
+using Poco::Net::SocketAddress;
+using Poco::Timestamp;
+using Poco::Timespan;
+
+
+PollSetTest::PollSetTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+PollSetTest::~PollSetTest()
+{
+}
+
+
+void PollSetTest::testAddRemove()
+{
+	ServerSocket svs(SocketAddress("127.0.0.1", 0));
+	StreamSocket ss1(svs.address());
+	StreamSocket ss2(svs.address());
+
+	PollSet ps;
+	assert (ps.empty());
+	assert (ps.size() == 0);
+	assert (!ps.has(ss1));
+
+	ps.add(ss1, PollSet::POLL_READ);
+	ps.add(ss2, PollSet::POLL_READ);
+	assert (!ps.empty());
+	assert (ps.size() == 2);
+	assert (ps.has(ss1));
+	assert (ps.has(ss2));
+
+	// adding again only changes the mode
+	ps.add(ss1, PollSet::POLL_WRITE);
+	assert (ps.size() == 2);
+
+	ps.update(ss2, PollSet::POLL_WRITE);
+	ps.remove(ss1);
+	assert (ps.size() == 1);
+	assert (!ps.has(ss1));
+	ps.remove(ss1);
+	assert (ps.size() == 1);
+
+	try
+	{
+		ps.update(ss1, PollSet::POLL_READ);
+		fail ("socket not in set - must throw");
+	}
+	catch (Poco::NotFoundException&)
+	{
+	}
+
+	ps.clear();
+	assert (ps.empty());
+	assert (!ps.has(ss2));
+}
+
+
+void PollSetTest::testPoll()
+{
+	ServerSocket svs(SocketAddress("127.0.0.1", 0));
+	StreamSocket ss(svs.address());
+	StreamSocket peer = svs.acceptConnection();
+
+	PollSet ps;
+	PollSet::SocketModeMap ready;
+	ps.add(ss, PollSet::POLL_READ | PollSet::POLL_WRITE);
+	ps.add(peer, PollSet::POLL_READ);
+	assert (ps.poll(Timespan(1, 0), ready) == 1);
+	assert (ready.size() == 1);
+	assert (ready.begin()->first == ss);
+	assert (ready.begin()->second == PollSet::POLL_WRITE);
+
+	ps.update(ss, PollSet::POLL_READ);
+	ss.sendBytes("hello", 5);
+	assert (ps.poll(Timespan(1, 0), ready) == 1);
+	assert (ready.begin()->first == peer);
+	assert (ready.begin()->second & PollSet::POLL_READ);
+
+	char buffer[16];
+	assert (peer.receiveBytes(buffer, sizeof(buffer)) == 5);
+	peer.sendBytes("world", 5);
+	assert (ps.poll(Timespan(1, 0), ready) == 1);
+	assert (ready.begin()->first == ss);
+	assert (ready.begin()->second == PollSet::POLL_READ);
+
+	ps.update(peer, PollSet::POLL_READ | PollSet::POLL_WRITE);
+	assert (ps.poll(Timespan(1, 0), ready) == 2);
+	assert (ready[ss] == PollSet::POLL_READ);
+	assert (ready[peer] == PollSet::POLL_WRITE);
+}
+
+
+void PollSetTest::testTimeout()
+{
+	ServerSocket svs(SocketAddress("127.0.0.1", 0));
+	StreamSocket ss(svs.address());
+
+	PollSet ps;
+	PollSet::SocketModeMap ready;
+	ps.add(ss, PollSet::POLL_READ);
+	Timestamp start;
+	assert (ps.poll(Timespan(0, 200000), ready) == 0);
+	assert (ready.empty());
+	assert (start.elapsed() >= 150000);
+}
+
+
+void PollSetTest::testClosed()
+{
+	ServerSocket svs(SocketAddress("127.0.0.1", 0));
+	StreamSocket ss(svs.address());
+	StreamSocket peer = svs.acceptConnection();
+
+	PollSet ps;
+	PollSet::SocketModeMap ready;
+	ps.add(ss, PollSet::POLL_READ);
+	peer.close();
+	assert (ps.poll(Timespan(1, 0), ready) == 1);
+	assert (ready.begin()->second & PollSet::POLL_READ);
+	char buffer[16];
+	assert (ss.receiveBytes(buffer, sizeof(buffer)) == 0);
+
+	// a socket closed while in the set is not reported
+	StreamSocket ss2(svs.address());
+	ps.add(ss2, PollSet::POLL_READ);
+	ps.remove(ss);
+	ss.close();
+	ps.remove(ss2);
+	ss2.close();
+	assert (ps.empty());
+	assert (ps.poll(Timespan(0, 10000), ready) == 0);
+}
+
+
+void PollSetTest::testManySockets()
+{
+	ServerSocket svs(SocketAddress("127.0.0.1", 0), 256);
+	std::vector<StreamSocket> clients;
+	std::vector<StreamSocket> peers;
+	PollSet ps;
+	for (int i = 0; i < 200; ++i)
+	{
+		clients.push_back(StreamSocket(svs.address()));
+		peers.push_back(svs.acceptConnection());
+		ps.add(peers.back(), PollSet::POLL_READ);
+	}
+	PollSet::SocketModeMap ready;
+	assert (ps.poll(Timespan(0, 10000), ready) == 0);
+
+	for (int i = 0; i < 200; i += 10)
+	{
+		clients[i].sendBytes("x", 1);
+	}
+	Timestamp start;
+	int n = 0;
+	while (n < 20 && start.elapsed() < 1000000)
+	{
+		n = ps.poll(Timespan(1, 0), ready);
+	}
+	assert (n == 20);
+	for (int i = 0; i < 200; ++i)
+	{
+		assert ((ready.find(peers[i]) != ready.end()) == (i % 10 == 0));
+	}
+}
+
+
+void PollSetTest::setUp()
+{
+}
+
+
+void PollSetTest::tearDown()
+{
+}
+
+
+CppUnit::Test* PollSetTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("PollSetTest");
+
+	CppUnit_addTest(pSuite, PollSetTest, testAddRemove);
+	CppUnit_addTest(pSuite, PollSetTest, testPoll);
+	CppUnit_addTest(pSuite, PollSetTest, testTimeout);
+	CppUnit_addTest(pSuite, PollSetTest, testClosed);
+	CppUnit_addTest(pSuite, PollSetTest, testManySockets);
+
+	return pSuite;
+}
@@ -17,9 +17,14 @@
 #include "Poco/Net/TCPServerConnection.h"
 #include "Poco/Net/TCPServerConnectionFactory.h"
 #include "Poco/Net/TCPServerParams.h"
+#include "Poco/Net/TCPServerConnectionFilter.h"
+#include "Poco/Net/RateLimitFilter.h"
+#include "Poco/Net/TokenBucket.h"
+#include "Poco/Net/NetException.h"
 #include "Poco/Net/StreamSocket.h"
 #include "Poco/Net/ServerSocket.h"
 #include "Poco/Thread.h"
+#include "Poco/Exception.h"
 #include <iostream>
 
 
@@ -28,6 +33,9 @@ using Poco::Net::TCPServerConnection;
 using Poco::Net::TCPServerConnectionFactory;
 using Poco::Net::TCPServerConnectionFactoryImpl;
 using Poco::Net::TCPServerParams;
+using Poco::Net::TCPServerConnectionFilter;
+using Poco::Net::RateLimitFilter;
+using Poco::Net::TokenBucket;
 using Poco::Net::StreamSocket;
 using Poco::Net::ServerSocket;
 using Poco::Net::SocketAddress;
@@ -62,6 +70,34 @@ namespace
 			}
 		}
 	};
+
+	class RejectFilter: public TCPServerConnectionFilter
+	{
+	public:
+		bool accept(const StreamSocket&)
+		{
+			return false;
+		}
+	};
+
+	bool echoes(StreamSocket& ss)
+		/// Returns true if the server echoes data sent
+		/// over the socket, or false if the server has
+		/// closed the connection.
+	{
+		std::string data("hello, world");
+		char buffer[256];
+		try
+		{
+			ss.sendBytes(data.data(), (int) data.size());
+			int n = ss.receiveBytes(buffer, sizeof(buffer));
+			return n > 0 && std::string(buffer, n) == data;
+		}
+		catch (Poco::Net::NetException&)
+		{
+			return false;
+		}
+	}
 }
 
 
@@ -243,6 +279,160 @@ void TCPServerTest::testThreadCapacity(){
 }
 
 
+void TCPServerTest::testFilter()
+{
+	TCPServer srv(new TCPServerConnectionFactoryImpl<EchoConnection>());
+	srv.setConnectionFilter(new RejectFilter);
+	srv.start();
+
+	SocketAddress sa("localhost", srv.socket().address().port());
+	StreamSocket ss1(sa);
+	assert (!echoes(ss1));
+	assert (srv.filteredConnections() == 1);
+	assert (srv.totalConnections() == 0);
+	assert (srv.refusedConnections() == 0);
+}
+
+
+void TCPServerTest::testTokenBucket()
+{
+	TokenBucket bucket1(0, 3);
+	assert (bucket1.full());
+	assert (bucket1.tryConsume());
+	assert (bucket1.tryConsume(2));
+	assert (!bucket1.tryConsume());
+	assert (!bucket1.full());
+	assert (bucket1.available() == 0);
+
+	TokenBucket bucket2(100, 1);
+	assert (bucket2.tryConsume());
+	assert (!bucket2.tryConsume());
+	Thread::sleep(50);
+	assert (bucket2.tryConsume());
+	Thread::sleep(50);
+	assert (bucket2.full());
+	assert (bucket2.available() == 1);
+
+	TokenBucket bucket5(0, 2);
+	assert (bucket5.tryConsume(2));
+	bucket5.refund();
+	assert (bucket5.available() == 1);
+	bucket5.refund(5);
+	assert (bucket5.full());
+	assert (bucket5.available() == 2);
+
+	try
+	{
+		TokenBucket bucket3(-1, 1);
+		fail ("negative rate - must throw");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+	try
+	{
+		TokenBucket bucket4(1, 0.5);
+		fail ("burst less than one - must throw");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+}
+
+
+void TCPServerTest::testRateLimit()
+{
+	RateLimitFilter::Ptr pFilter1 = new RateLimitFilter;
+	pFilter1->setAddressRate(0, 2);
+	TCPServer srv1(new TCPServerConnectionFactoryImpl<EchoConnection>());
+	srv1.setConnectionFilter(pFilter1);
+	srv1.start();
+
+	SocketAddress sa1("localhost", srv1.socket().address().port());
+	StreamSocket ss1(sa1);
+	StreamSocket ss2(sa1);
+	StreamSocket ss3(sa1);
+	assert (echoes(ss1));
+	assert (echoes(ss2));
+	assert (!echoes(ss3));
+	assert (pFilter1->rejectedByAddress() == 1);
+	assert (pFilter1->rejectedByListener() == 0);
+	assert (srv1.filteredConnections() == 1);
+	ss1.close();
+	ss2.close();
+
+	RateLimitFilter::Ptr pFilter2 = new RateLimitFilter;
+	pFilter2->setListenerRate(0, 1);
+	pFilter2->setAddressRate(0, 5);
+	TCPServer srv2(new TCPServerConnectionFactoryImpl<EchoConnection>());
+	srv2.setConnectionFilter(pFilter2);
+	srv2.start();
+
+	SocketAddress sa2("localhost", srv2.socket().address().port());
+	StreamSocket ss4(sa2);
+	StreamSocket ss5(sa2);
+	assert (echoes(ss4));
+	assert (!echoes(ss5));
+	assert (pFilter2->rejectedByAddress() == 0);
+	assert (pFilter2->rejectedByListener() == 1);
+	assert (srv2.filteredConnections() == 1);
+
+	// a connection rejected by the listener
+	// keeps its address's token
+	RateLimitFilter::Ptr pFilter3 = new RateLimitFilter;
+	pFilter3->setListenerRate(10, 1);
+	pFilter3->setAddressRate(0, 2);
+	assert (pFilter3->accept(ss4));
+	assert (!pFilter3->accept(ss4));
+	Thread::sleep(200);
+	assert (pFilter3->accept(ss4));
+	assert (pFilter3->rejectedByAddress() == 0);
+	assert (pFilter3->rejectedByListener() == 1);
+	ss4.close();
+
+	Thread::sleep(500);
+	assert (srv1.currentConnections() == 0);
+	assert (srv2.currentConnections() == 0);
+}
+
+
+void TCPServerTest::testAdaptiveLimit()
+{
+	ServerSocket svs(0);
+	TCPServerParams* pParams = new TCPServerParams;
+	pParams->setMaxThreads(1);
+	pParams->setMaxQueued(2);
+	pParams->setThreadIdleTime(100);
+	pParams->setTargetQueueLatency(Poco::Timespan(0, 50000));
+	TCPServer srv(new TCPServerConnectionFactoryImpl<EchoConnection>(), svs, pParams);
+	srv.start();
+
+	SocketAddress sa("localhost", svs.address().port());
+	StreamSocket ss1(sa);
+	assert (echoes(ss1));
+	StreamSocket ss2(sa);
+	StreamSocket ss3(sa);
+	Thread::sleep(300);
+	assert (srv.queuedConnections() == 2);
+	assert (srv.limitedConnections() == 0);
+
+	// ss2 has waited longer than the target latency,
+	// so the limit is lowered to two connections
+	ss1.close();
+	assert (echoes(ss2));
+	StreamSocket ss4(sa);
+	assert (!echoes(ss4));
+	assert (srv.limitedConnections() == 1);
+	assert (srv.refusedConnections() == 1);
+
+	ss2.close();
+	assert (echoes(ss3));
+	ss3.close();
+	Thread::sleep(500);
+	assert (srv.currentConnections() == 0);
+}
+
+
 
 void TCPServerTest::setUp()
 {
@@ -262,6 +452,10 @@ CppUnit::Test* TCPServerTest::suite()
 	CppUnit_addTest(pSuite, TCPServerTest, testTwoConnections);
 	CppUnit_addTest(pSuite, TCPServerTest, testMultiConnections);
 	CppUnit_addTest(pSuite, TCPServerTest, testThreadCapacity);
+	CppUnit_addTest(pSuite, TCPServerTest, testFilter);
+	CppUnit_addTest(pSuite, TCPServerTest, testTokenBucket);
+	CppUnit_addTest(pSuite, TCPServerTest, testRateLimit);
+	CppUnit_addTest(pSuite, TCPServerTest, testAdaptiveLimit);
 
 	return pSuite;
 }
@@ -30,6 +30,10 @@ public:
 	void testTwoConnections();
 	void testMultiConnections();
 	void testThreadCapacity();
+	void testFilter();
+	void testTokenBucket();
+	void testRateLimit();
+	void testAdaptiveLimit();
 
 	void setUp();
 	void tearDown();
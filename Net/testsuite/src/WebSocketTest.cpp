@@ -14,6 +14,8 @@
 #include "CppUnit/TestCaller.h"
 #include "CppUnit/TestSuite.h"
 #include "Poco/Net/WebSocket.h"
+#include "Poco/Net/WebSocketImpl.h"
+#include "Poco/Net/WebSocketDeflate.h"
 #include "Poco/Net/SocketStream.h"
 #include "Poco/Net/HTTPClientSession.h"
 #include "Poco/Net/HTTPServer.h"
@@ -25,6 +27,8 @@
 #include "Poco/Net/ServerSocket.h"
 #include "Poco/Net/NetException.h"
 #include "Poco/Thread.h"
+#include "Poco/Timestamp.h"
+#include <iostream>
 
 
 using Poco::Net::HTTPClientSession;
@@ -35,6 +39,8 @@ using Poco::Net::HTTPServerResponse;
 using Poco::Net::SocketStream;
 using Poco::Net::WebSocket;
 using Poco::Net::WebSocketException;
+using Poco::Net::WebSocketImpl;
+using Poco::Net::WebSocketDeflate;
 
 
 namespace
@@ -42,7 +48,9 @@ namespace
 	class WebSocketRequestHandler: public Poco::Net::HTTPRequestHandler
 	{
 	public:
-		WebSocketRequestHandler(std::size_t bufSize = 1024): _bufSize(bufSize)
+		WebSocketRequestHandler(std::size_t bufSize = 1024, bool deflate = false):
+			_bufSize(bufSize),
+			_deflate(deflate)
 		{
 		}
 
@@ -50,7 +58,7 @@ namespace
 		{
 			try
 			{
-				WebSocket ws(request, response);
+				WebSocket ws = _deflate ? WebSocket(request, response, WebSocketDeflate::Params()) : WebSocket(request, response);
 				std::auto_ptr<char> pBuffer(new char[_bufSize]);
 				int flags;
 				int n;
@@ -81,22 +89,26 @@ namespace
 
 	private:
 		std::size_t _bufSize;
+		bool _deflate;
 	};
 	
 	class WebSocketRequestHandlerFactory: public Poco::Net::HTTPRequestHandlerFactory
 	{
 	public:
-		WebSocketRequestHandlerFactory(std::size_t bufSize = 1024): _bufSize(bufSize)
+		WebSocketRequestHandlerFactory(std::size_t bufSize = 1024, bool deflate = false):
+			_bufSize(bufSize),
+			_deflate(deflate)
 		{
 		}
 
 		Poco::Net::HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
 		{
-			return new WebSocketRequestHandler(_bufSize);
+			return new WebSocketRequestHandler(_bufSize, _deflate);
 		}
 
 	private:
 		std::size_t _bufSize;
+		bool _deflate;
 	};
 }
 
@@ -267,6 +279,282 @@ void WebSocketTest::testWebSocketLargeInOneFrame()
 }
 
 
+void WebSocketTest::testMaskPayload()
+{
+	const char mask[4] = { '\x12', '\x34', '\x56', '\x78' };
+	std::string data;
+	for (int i = 0; i < 300; i++)
+		data += static_cast<char>(i*7);
+
+	for (int length = 0; length < 200; length++)
+	{
+		for (int offset = 0; offset < 4; offset++)
+		{
+			std::string expected(data, 0, length);
+			for (int i = 0; i < length; i++)
+				expected[i] ^= mask[(i + offset) % 4];
+
+			// unaligned source and destination
+			std::string masked(length + 1, '\0');
+			WebSocketImpl::maskPayload(&masked[1], data.data(), length, mask, offset);
+			assert (masked.compare(1, length, expected) == 0);
+
+			std::string inPlace(data, 0, length);
+			WebSocketImpl::maskPayload(&inPlace[0], inPlace.data(), length, mask, offset);
+			assert (inPlace == expected);
+		}
+	}
+}
+
+
+void WebSocketTest::testDeflateNegotiation()
+{
+	WebSocketDeflate::Params server;
+	WebSocketDeflate::Params agreed;
+	std::string response;
+
+	assert (!WebSocketDeflate::accept("", server, agreed, response));
+	assert (!WebSocketDeflate::accept("x-webkit-deflate-frame", server, agreed, response));
+
+	WebSocketDeflate::Params client;
+	std::string offer = WebSocketDeflate::offer(client);
+	assert (offer == "permessage-deflate; client_max_window_bits");
+	assert (WebSocketDeflate::accept(offer, server, agreed, response));
+	assert (response == "permessage-deflate");
+	assert (!agreed.serverNoContextTakeover && !agreed.clientNoContextTakeover);
+	assert (agreed.serverMaxWindowBits == 15 && agreed.clientMaxWindowBits == 15);
+	assert (WebSocketDeflate::confirm(offer, response, agreed));
+	assert (agreed.serverMaxWindowBits == 15 && agreed.clientMaxWindowBits == 15);
+
+	client.serverNoContextTakeover = true;
+	client.serverMaxWindowBits = 10;
+	offer = WebSocketDeflate::offer(client);
+	assert (offer == "permessage-deflate; server_no_context_takeover; server_max_window_bits=10; client_max_window_bits");
+	server.clientMaxWindowBits = 12;
+	assert (WebSocketDeflate::accept(offer, server, agreed, response));
+	assert (response == "permessage-deflate; server_no_context_takeover; server_max_window_bits=10; client_max_window_bits=12");
+	assert (WebSocketDeflate::confirm(offer, response, agreed));
+	assert (agreed.serverNoContextTakeover && !agreed.clientNoContextTakeover);
+	assert (agreed.serverMaxWindowBits == 10 && agreed.clientMaxWindowBits == 12);
+
+	// the first acceptable offer wins
+	assert (WebSocketDeflate::accept("permessage-deflate; foo, permessage-deflate; client_no_context_takeover", WebSocketDeflate::Params(), agreed, response));
+	assert (response == "permessage-deflate; client_no_context_takeover");
+	assert (!WebSocketDeflate::accept("permessage-deflate; server_max_window_bits=16", WebSocketDeflate::Params(), agreed, response));
+	assert (!WebSocketDeflate::accept("permessage-deflate; server_max_window_bits", WebSocketDeflate::Params(), agreed, response));
+	assert (!WebSocketDeflate::accept("permessage-deflate; client_no_context_takeover; client_no_context_takeover", WebSocketDeflate::Params(), agreed, response));
+
+	assert (!WebSocketDeflate::confirm(offer, "", agreed));
+	try
+	{
+		WebSocketDeflate::confirm("", "permessage-deflate", agreed);
+		fail ("extension not offered - must throw");
+	}
+	catch (WebSocketException&)
+	{
+	}
+	try
+	{
+		WebSocketDeflate::confirm(offer, "permessage-deflate; server_max_window_bits=12", agreed);
+		fail ("window larger than offered - must throw");
+	}
+	catch (WebSocketException&)
+	{
+	}
+}
+
+
+void WebSocketTest::testWebSocketDeflate()
+{
+	Poco::Net::ServerSocket ss(0);
+	Poco::Net::HTTPServer server(new WebSocketRequestHandlerFactory(100000, true), ss, new Poco::Net::HTTPServerParams);
+	server.start();
+	
+	Poco::Thread::sleep(200);
+	
+	HTTPClientSession cs("localhost", ss.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/ws");
+	request.set(WebSocketDeflate::EXTENSIONS_HEADER, WebSocketDeflate::offer(WebSocketDeflate::Params()));
+	HTTPResponse response;
+	WebSocket ws(cs, request, response);
+	assert (ws.compressed());
+	assert (response.get(WebSocketDeflate::EXTENSIONS_HEADER) == "permessage-deflate");
+
+	Poco::Buffer<char> buffer(100000);
+	int flags;
+	int n;
+	for (int i = 0; i < 20; i++)
+	{
+		// repeated messages exercise context takeover
+		std::string payload;
+		for (int j = 0; j < 1000*i; j++)
+			payload += static_cast<char>('a' + j % 7);
+		ws.sendFrame(payload.data(), (int) payload.size());
+		n = ws.receiveFrame(buffer.begin(), (int) buffer.size(), flags);
+		assert (n == payload.size());
+		assert (std::string(buffer.begin(), n) == payload);
+		assert (flags == WebSocket::FRAME_TEXT);
+
+		ws.sendFrame(payload.data(), (int) payload.size(), WebSocket::FRAME_BINARY);
+		Poco::Buffer<char> pocobuffer(0);
+		n = ws.receiveFrame(pocobuffer, flags);
+		assert (n == payload.size());
+		assert (std::string(pocobuffer.begin(), n) == payload);
+		assert (flags == WebSocket::FRAME_BINARY);
+	}
+
+	// fragmented messages are sent uncompressed
+	std::string part1(100, 'x');
+	std::string part2(100, 'y');
+	ws.sendFrame(part1.data(), (int) part1.size(), WebSocket::FRAME_OP_TEXT);
+	n = ws.receiveFrame(buffer.begin(), (int) buffer.size(), flags);
+	assert (n == part1.size());
+	assert (flags == WebSocket::FRAME_OP_TEXT);
+	ws.sendFrame(part2.data(), (int) part2.size(), WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_CONT);
+	n = ws.receiveFrame(buffer.begin(), (int) buffer.size(), flags);
+	assert (n == part2.size());
+	assert (std::string(buffer.begin(), n) == part2);
+	assert (flags == (WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_CONT));
+
+	ws.shutdown();
+	n = ws.receiveFrame(buffer.begin(), (int) buffer.size(), flags);
+	assert (n == 2);
+	assert ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_CLOSE);
+
+	server.stop();
+}
+
+
+void WebSocketTest::testWebSocketDeflateLimit()
+{
+	Poco::Net::ServerSocket ss(0);
+	Poco::Net::HTTPServer server(new WebSocketRequestHandlerFactory(2000000, true), ss, new Poco::Net::HTTPServerParams);
+	server.start();
+	
+	Poco::Thread::sleep(200);
+
+	// a megabyte of a single character compresses to about a kilobyte
+	std::string payload(1000000, 'x');
+	int flags;
+	int n;
+
+	{
+		HTTPClientSession cs("localhost", ss.address().port());
+		HTTPRequest request(HTTPRequest::HTTP_GET, "/ws");
+		request.set(WebSocketDeflate::EXTENSIONS_HEADER, WebSocketDeflate::offer(WebSocketDeflate::Params()));
+		HTTPResponse response;
+		WebSocket ws(cs, request, response);
+		assert (ws.compressed());
+		ws.setMaxPayloadSize(1000);
+		assert (ws.getMaxPayloadSize() == 1000);
+
+		// a payload of exactly the maximum size is accepted
+		Poco::Buffer<char> buffer(0);
+		ws.sendFrame(payload.data(), 1000);
+		n = ws.receiveFrame(buffer, flags);
+		assert (n == 1000);
+
+		ws.sendFrame(payload.data(), (int) payload.size());
+		buffer.resize(0);
+		try
+		{
+			ws.receiveFrame(buffer, flags);
+			fail("payload too big - must throw");
+		}
+		catch (WebSocketException& exc)
+		{
+			assert (exc.code() == WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
+		}
+		// inflation stops at the limit
+		assert (buffer.size() <= 1000);
+	}
+
+	{
+		HTTPClientSession cs("localhost", ss.address().port());
+		HTTPRequest request(HTTPRequest::HTTP_GET, "/ws");
+		request.set(WebSocketDeflate::EXTENSIONS_HEADER, WebSocketDeflate::offer(WebSocketDeflate::Params()));
+		HTTPResponse response;
+		WebSocket ws(cs, request, response);
+		assert (ws.compressed());
+
+		char buffer[1000];
+		ws.sendFrame(payload.data(), (int) payload.size());
+		try
+		{
+			ws.receiveFrame(buffer, sizeof(buffer), flags);
+			fail("payload too big - must throw");
+		}
+		catch (WebSocketException& exc)
+		{
+			assert (exc.code() == WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
+		}
+	}
+
+	server.stop();
+}
+
+
+void WebSocketTest::testFrameThroughput()
+{
+	const int size = 1024*1024;
+	std::string data(size, 'x');
+	const char mask[4] = { 1, 2, 3, 4 };
+	Poco::Timestamp start;
+	for (int i = 0; i < 256; i++)
+	{
+		for (int j = 0; j < size; j++)
+			data[j] ^= mask[j % 4];
+	}
+	Poco::Timestamp::TimeDiff bytewise = start.elapsed();
+	start.update();
+	for (int i = 0; i < 256; i++)
+	{
+		WebSocketImpl::maskPayload(&data[0], data.data(), size, mask);
+	}
+	Poco::Timestamp::TimeDiff wide = start.elapsed();
+	std::cout << "masking 256 MB: " << bytewise/1000 << " ms bytewise, " << wide/1000 << " ms wide" << std::endl;
+
+	const int frameCounts[] = { 100000, 20000, 500 };
+	const int frameSizes[]  = { 16, 1024, 65536 };
+	for (int t = 0; t < 3; t++)
+	{
+		Poco::Net::ServerSocket ss(0);
+		Poco::Net::HTTPServer server(new WebSocketRequestHandlerFactory(frameSizes[t]), ss, new Poco::Net::HTTPServerParams);
+		server.start();
+
+		HTTPClientSession cs("localhost", ss.address().port());
+		HTTPRequest request(HTTPRequest::HTTP_GET, "/ws");
+		HTTPResponse response;
+		WebSocket ws(cs, request, response);
+
+		// keep a window of frames in flight, so that both
+		// ends receive several frames per read
+		std::string payload(frameSizes[t], 'x');
+		Poco::Buffer<char> buffer(frameSizes[t]);
+		const int window = 64;
+		int flags;
+		start.update();
+		for (int i = 0; i < frameCounts[t] + window; i++)
+		{
+			if (i < frameCounts[t])
+				ws.sendFrame(payload.data(), (int) payload.size(), WebSocket::FRAME_BINARY);
+			if (i >= window)
+			{
+				int n = ws.receiveFrame(buffer.begin(), (int) buffer.size(), flags);
+				assert (n == frameSizes[t]);
+			}
+		}
+		Poco::Timestamp::TimeDiff elapsed = start.elapsed();
+		std::cout << frameCounts[t] << " frames of " << frameSizes[t] << " bytes echoed in " << elapsed/1000 << " ms ("
+			<< static_cast<Poco::UInt64>(frameCounts[t])*1000000/(elapsed ? elapsed : 1) << " frames/s)" << std::endl;
+
+		ws.shutdown();
+		ws.receiveFrame(buffer.begin(), (int) buffer.size(), flags);
+		server.stop();
+	}
+}
+
+
 void WebSocketTest::setUp()
 {
 }
@@ -284,6 +572,11 @@ CppUnit::Test* WebSocketTest::suite()
 	CppUnit_addTest(pSuite, WebSocketTest, testWebSocket);
 	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketLarge);
 	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketLargeInOneFrame);
+	CppUnit_addTest(pSuite, WebSocketTest, testMaskPayload);
+	CppUnit_addTest(pSuite, WebSocketTest, testDeflateNegotiation);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketDeflate);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketDeflateLimit);
+	CppUnit_addTest(pSuite, WebSocketTest, testFrameThroughput);
 
 	return pSuite;
 }
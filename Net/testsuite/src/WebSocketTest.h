@@ -29,6 +29,11 @@ public:
 	void testWebSocket();
 	void testWebSocketLarge();
 	void testWebSocketLargeInOneFrame();
+	void testMaskPayload();
+	void testDeflateNegotiation();
+	void testWebSocketDeflate();
+	void testWebSocketDeflateLimit();
+	void testFrameThroughput();
 
 	void setUp();
 	void tearDown();
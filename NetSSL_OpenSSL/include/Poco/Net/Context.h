@@ -22,12 +22,19 @@
 
 #include "Poco/Net/NetSSL.h"
 #include "Poco/Net/SocketDefs.h"
+#include "Poco/Net/Session.h"
+#include "Poco/Net/SessionCache.h"
 #include "Poco/Crypto/X509Certificate.h"
 #include "Poco/Crypto/RSAKey.h"
 #include "Poco/RefCountedObject.h"
 #include "Poco/AutoPtr.h"
+#include "Poco/LRUCache.h"
+#include "Poco/Mutex.h"
+#include "Poco/Timespan.h"
 #include <openssl/ssl.h>
 #include <cstdlib>
+#include <deque>
+#include <vector>
 
 
 namespace Poco {
@@ -43,9 +50,37 @@ class NetSSL_API Context: public Poco::RefCountedObject
 	///
 	/// The Context class is also used to control
 	/// SSL session caching on the server and client side.
+	///
+	/// On the server side, sessions can be resumed from the
+	/// Context's own session cache, from an external SessionCache
+	/// shared with other Context objects or processes, and from
+	/// session tickets (RFC 5077) encrypted with rotating keys.
+	///
+	/// On the client side, the Context keeps the most recent
+	/// session of every server, so that new connections (e.g.,
+	/// from HTTPSClientSession) can resume it automatically.
 {
 public:
 	typedef Poco::AutoPtr<Context> Ptr;
+
+	enum
+	{
+		TICKET_KEY_SIZE = 80,
+			/// Size of a session ticket key: 16 bytes key name,
+			/// 32 bytes HMAC-SHA256 key and 32 bytes AES-256 key.
+
+		MAX_TICKET_KEYS = 3,
+			/// Number of session ticket keys kept for decrypting
+			/// tickets, including the current key.
+
+		DEFAULT_TICKET_KEY_LIFETIME = 12*3600,
+			/// Default time in seconds after which a new session
+			/// ticket key is generated.
+
+		DEFAULT_CLIENT_CACHE_SIZE = 1024
+			/// Maximum number of servers for which a client
+			/// session is kept.
+	};
 	
 	enum Usage
 	{
@@ -249,6 +284,78 @@ public:
 		/// Flushes the SSL session cache on the server.
 		///
 		/// This method may only be called on SERVER_USE Context objets.
+
+	void setSessionCache(SessionCache::Ptr pCache);
+		/// Sets an external session cache, which receives every new
+		/// session created by the server, and is asked for sessions
+		/// that cannot be found in the Context's own session cache.
+		/// Passing a null pointer removes the external cache.
+		///
+		/// Sharing the SessionCache between the Context objects of
+		/// several acceptors, or between processes, allows clients
+		/// to resume their sessions with any of them. Setting a
+		/// SessionCache enables session caching. A session ID context
+		/// must be set with enableSessionCache(), and must be the
+		/// same for all servers sharing the cache.
+		///
+		/// This method may only be called on SERVER_USE Context objets.
+
+	SessionCache::Ptr getSessionCache() const;
+		/// Returns the external session cache, or a null pointer
+		/// if none has been set.
+
+	void enableSessionTickets(const Poco::Timespan& keyLifetime = Poco::Timespan(DEFAULT_TICKET_KEY_LIFETIME, 0));
+		/// Enables stateless session resumption with session
+		/// tickets (RFC 5077), which does not need a session cache.
+		///
+		/// Tickets are encrypted with AES-256-CBC and authenticated
+		/// with HMAC-SHA256, using random keys generated by the Context.
+		/// A new key is generated when the current key is older than
+		/// keyLifetime. Tickets encrypted with one of the previous
+		/// MAX_TICKET_KEYS - 1 keys are still accepted, and the client
+		/// receives a new ticket. A keyLifetime of zero disables the
+		/// automatic key rotation.
+		///
+		/// This method may only be called on SERVER_USE Context objets.
+
+	void addSessionTicketKey(const std::string& key);
+		/// Enables session tickets, and makes the given key, which
+		/// must be TICKET_KEY_SIZE bytes long, the current key for
+		/// encrypting tickets. Previous keys are kept for decrypting
+		/// tickets, up to MAX_TICKET_KEYS keys.
+		///
+		/// This is used by servers running in several processes or
+		/// on several hosts, which must all use the same keys to
+		/// accept each other's tickets. These servers must rotate
+		/// the keys by periodically calling addSessionTicketKey()
+		/// with a new key, which must be kept secret, as it protects
+		/// the master secrets of all sessions. Automatic key rotation
+		/// is disabled.
+		///
+		/// This method may only be called on SERVER_USE Context objets.
+
+	void rotateSessionTicketKeys();
+		/// Generates a new random key for encrypting session tickets.
+		///
+		/// This method may only be called on SERVER_USE Context objets.
+
+	bool sessionTicketsEnabled() const;
+		/// Returns true iff session tickets have been enabled with
+		/// enableSessionTickets() or addSessionTicketKey().
+
+	void cacheClientSession(const std::string& peer, Session::Ptr pSession);
+		/// Stores the given session for resumption with the given peer,
+		/// which is usually "host:port". A null pointer removes
+		/// the stored session.
+		///
+		/// This method may only be called on CLIENT_USE Context objets.
+
+	Session::Ptr findClientSession(const std::string& peer);
+		/// Returns the session stored for the given peer with
+		/// cacheClientSession(), or a null pointer if there is none,
+		/// or if the session has expired.
+		///
+		/// This method may only be called on CLIENT_USE Context objets.
 				
 	void enableExtendedCertificateVerification(bool flag = true);
 		/// Enable or disable the automatic post-connection
@@ -266,14 +373,70 @@ public:
 		///
 		/// The feature can be disabled by calling this method.
 
+	void setALPNProtocols(const std::vector<std::string>& protocols);
+		/// Sets the application layer protocols (RFC 7301) supported
+		/// by the Context, in order of preference, e.g. "h2" and "http/1.1".
+		///
+		/// A client Context offers the protocols to the server.
+		/// A server Context selects the first of its protocols that is
+		/// also offered by the client. If there is none, or the
+		/// client does not use ALPN, no protocol is negotiated.
+		///
+		/// The negotiated protocol can be obtained with
+		/// SecureStreamSocket::alpnProtocol() after the handshake.
+		///
+		/// Throws a Poco::NotImplementedException if OpenSSL
+		/// is older than 1.0.2.
+
+	const std::vector<std::string>& getALPNProtocols() const;
+		/// Returns the application layer protocols set
+		/// with setALPNProtocols().
+
 private:
+	struct TicketKey
+	{
+		unsigned char name[16];
+		unsigned char hmacKey[32];
+		unsigned char aesKey[32];
+		Poco::Timestamp created;
+	};
+
+	typedef std::deque<TicketKey> TicketKeys;
+
 	void createSSLContext();
 		/// Create a SSL_CTX object according to Context configuration.
 
+	void addTicketKey(const unsigned char* key);
+		/// Makes the given key the current session ticket key.
+		/// The mutex must be locked.
+
+	void installTicketKeyCallback();
+		/// Enables session tickets with our own keys.
+
+	int ticketKey(unsigned char* name, unsigned char* iv, EVP_CIPHER_CTX* pCipherContext, HMAC_CTX* pHMACContext, int enc);
+		/// Sets up encryption or decryption of a session ticket.
+
+	static Context* fromSSLContext(SSL_CTX* pSSLContext);
+	static int newSessionCallback(SSL* pSSL, SSL_SESSION* pSession);
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	static SSL_SESSION* getSessionCallback(SSL* pSSL, const unsigned char* id, int length, int* pCopy);
+#else
+	static SSL_SESSION* getSessionCallback(SSL* pSSL, unsigned char* id, int length, int* pCopy);
+#endif
+	static int ticketKeyCallback(SSL* pSSL, unsigned char* name, unsigned char* iv, EVP_CIPHER_CTX* pCipherContext, HMAC_CTX* pHMACContext, int enc);
+	static int alpnSelectCallback(SSL* pSSL, const unsigned char** out, unsigned char* outLength, const unsigned char* in, unsigned int inLength, void* arg);
+
 	Usage _usage;
 	VerificationMode _mode;
 	SSL_CTX* _pSSLContext;
 	bool _extendedCertificateVerification;
+	SessionCache::Ptr _pSessionCache;
+	TicketKeys _ticketKeys;
+	Poco::Timespan _ticketKeyLifetime;
+	bool _ticketsEnabled;
+	Poco::LRUCache<std::string, Session::Ptr> _clientSessions;
+	std::vector<std::string> _alpnProtocols;
+	mutable Poco::FastMutex _mutex;
 };
 
 
@@ -313,6 +476,26 @@ inline bool Context::extendedCertificateVerificationEnabled() const
 }
 
 
+inline SessionCache::Ptr Context::getSessionCache() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	return _pSessionCache;
+}
+
+
+inline const std::vector<std::string>& Context::getALPNProtocols() const
+{
+	return _alpnProtocols;
+}
+
+
+inline bool Context::sessionTicketsEnabled() const
+{
+	return _ticketsEnabled;
+}
+
+
 } } // namespace Poco::Net
 
 
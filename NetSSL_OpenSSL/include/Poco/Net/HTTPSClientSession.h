@@ -69,7 +69,12 @@ class NetSSL_API HTTPSClientSession: public HTTPClientSession
 	/// If session caching has been enabled for the Context object passed
 	/// to the HTTPSClientSession, the HTTPSClientSession class will
 	/// attempt to reuse a previously obtained Session object in
-	/// case of a reconnect.
+	/// case of a reconnect. If no Session object has been given,
+	/// the session of the most recent connection of any
+	/// HTTPSClientSession using the same Context to the same host
+	/// and port is reused (see Context::findClientSession()), so
+	/// that short-lived HTTPSClientSession objects avoid a full
+	/// handshake.
 {
 public:
 	enum
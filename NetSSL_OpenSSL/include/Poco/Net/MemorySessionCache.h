@@ -0,0 +1,81 @@
+//
+// MemorySessionCache.h
+//
+// $Id$
+//
+// Library: NetSSL_OpenSSL
+// Package: SSLCore
+// Module:  MemorySessionCache
+//
+// Definition of the MemorySessionCache class.
+//
+// Copyright (c) 2010, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef NetSSL_MemorySessionCache_INCLUDED
+#define NetSSL_MemorySessionCache_INCLUDED
+
+
+#include "Poco/Net/NetSSL.h"
+#include "Poco/Net/SessionCache.h"
+#include "Poco/LRUCache.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class NetSSL_API MemorySessionCache: public SessionCache
+	/// A SessionCache that keeps the sessions in memory.
+	///
+	/// A MemorySessionCache can be shared by the server Context
+	/// objects of all worker threads or acceptors of a process.
+	/// If the cache is full, the least recently used session
+	/// is removed.
+{
+public:
+	typedef Poco::AutoPtr<MemorySessionCache> Ptr;
+
+	enum
+	{
+		DEFAULT_CACHE_SIZE = 20480
+	};
+
+	explicit MemorySessionCache(long size = DEFAULT_CACHE_SIZE);
+		/// Creates the MemorySessionCache, which can hold
+		/// up to size sessions.
+
+	// SessionCache
+	void add(const std::string& id, const std::string& session, const Poco::Timestamp& expires);
+	bool find(const std::string& id, std::string& session);
+	void remove(const std::string& id);
+
+	std::size_t size();
+		/// Returns the number of sessions in the cache,
+		/// including expired sessions not yet removed.
+
+	void clear();
+		/// Removes all sessions from the cache.
+
+protected:
+	~MemorySessionCache();
+
+private:
+	struct Entry
+	{
+		std::string session;
+		Poco::Timestamp expires;
+	};
+
+	Poco::LRUCache<std::string, Entry> _cache;
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // NetSSL_MemorySessionCache_INCLUDED
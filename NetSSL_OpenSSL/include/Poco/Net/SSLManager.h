@@ -90,6 +90,8 @@ class NetSSL_API SSLManager
 	///            <sessionIdContext>someString</sessionIdContext> <!-- server only -->
 	///            <sessionCacheSize>0..n</sessionCacheSize>       <!-- server only -->
 	///            <sessionTimeout>0..n</sessionTimeout>           <!-- server only -->
+	///            <sessionTickets>true|false</sessionTickets>     <!-- server only -->
+	///            <sessionTicketKeyLifetime>0..n</sessionTicketKeyLifetime> <!-- server only -->
 	///            <extendedVerification>true|false</extendedVerification>
 	///            <requireTLSv1>true|false</requireTLSv1>
 	///            <requireTLSv1_1>true|false</requireTLSv1_1>
@@ -132,6 +134,10 @@ class NetSSL_API SSLManager
 	///      large for many applications, especially on embedded platforms with limited memory.
 	///      Specifying a size of 0 will set an unlimited cache size.
 	///    - sessionTimeout (integer):  Sets the timeout (in seconds) of cached sessions on the server.
+	///    - sessionTickets (boolean): Enables session tickets with rotating keys on the server
+	///      (see Context::enableSessionTickets()).
+	///    - sessionTicketKeyLifetime (integer): Sets the time (in seconds) after which a new session
+	///      ticket key is generated. Defaults to 43200 (12 hours).
 	///    - extendedVerification (boolean): Enable or disable the automatic post-connection
 	///      extended certificate verification.
 	///    - requireTLSv1 (boolean): Require a TLSv1 connection.
@@ -316,6 +322,8 @@ private:
 	static const std::string CFG_SESSION_ID_CONTEXT;
 	static const std::string CFG_SESSION_CACHE_SIZE;
 	static const std::string CFG_SESSION_TIMEOUT;
+	static const std::string CFG_SESSION_TICKETS;
+	static const std::string CFG_SESSION_TICKET_KEY_LIFETIME;
 	static const std::string CFG_EXTENDED_VERIFICATION;
 	static const std::string CFG_REQUIRE_TLSV1;
 	static const std::string CFG_REQUIRE_TLSV1_1;
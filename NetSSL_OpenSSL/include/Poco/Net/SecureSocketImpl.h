@@ -38,8 +38,24 @@ class HostEntry;
 
 class NetSSL_API SecureSocketImpl
 	/// The SocketImpl for SecureStreamSocket.
+	///
+	/// If the underlying socket is in nonblocking mode when the
+	/// SSL connection is set up, or is switched to nonblocking
+	/// mode before the SSL handshake starts, OpenSSL reads from and
+	/// writes to memory buffers instead of the socket. The socket
+	/// is only read when OpenSSL needs more data, and the encrypted
+	/// data of all SSL records written since the socket was last
+	/// writable is sent with a single system call.
 {
 public:
+	enum
+	{
+		MAX_PENDING_OUTPUT = 64*1024
+			/// Maximum number of encrypted bytes buffered for
+			/// sending on a nonblocking socket. If more data is
+			/// buffered, sendBytes() returns ERR_SSL_WANT_WRITE.
+	};
+
 	SecureSocketImpl(Poco::AutoPtr<SocketImpl> pSocketImpl, Context::Ptr pContext);
 		/// Creates the SecureSocketImpl using an already
 		/// connected stream socket.
@@ -129,6 +145,24 @@ public:
 	int available() const;
 		/// Returns the number of bytes available from the
 		/// SSL buffer for immediate reading.
+
+	void setBlocking(bool flag);
+		/// Sets the socket in blocking mode if flag is true,
+		/// disables blocking mode if flag is false.
+		///
+		/// If the socket is switched to nonblocking mode before
+		/// the SSL handshake has started, buffered I/O is used.
+
+	int flush();
+		/// Sends as much of the buffered encrypted data as
+		/// possible, without blocking.
+		///
+		/// Returns the number of bytes still buffered, which
+		/// is always 0 if buffered I/O is not used.
+
+	int pendingOutput() const;
+		/// Returns the number of encrypted bytes buffered
+		/// for sending.
 	
 	int completeHandshake();
 		/// Completes the SSL handshake.
@@ -181,6 +215,12 @@ public:
 	bool sessionWasReused();
 		/// Returns true iff a reused session was negotiated during
 		/// the handshake.
+
+	std::string alpnProtocol() const;
+		/// Returns the application layer protocol negotiated
+		/// with ALPN during the handshake (see
+		/// Context::setALPNProtocols()), or an empty string
+		/// if no protocol has been negotiated.
 		
 protected:
 	void acceptSSL();
@@ -200,6 +240,24 @@ protected:
 	int handleError(int rc);
 		/// Handles an SSL error by throwing an appropriate exception.
 
+	void attachBIO();
+		/// Connects the SSL object to the socket, or to memory
+		/// buffers if the socket is in nonblocking mode.
+
+	void useMemoryBIO();
+		/// Makes the SSL object read from and write to memory buffers.
+
+	int readSocket();
+		/// Reads available data from the socket into the read buffer.
+		/// Returns the number of bytes read, 0 if the peer has closed
+		/// the connection, or -1 if no data is available.
+
+	int handshakeNB();
+	int sendBytesNB(const void* buffer, int length);
+	int receiveBytesNB(void* buffer, int length);
+		/// Implement completeHandshake(), sendBytes() and receiveBytes()
+		/// for buffered I/O.
+
 	void reset();
 		/// Prepares the socket for re-use. 
 		///
@@ -214,6 +272,8 @@ private:
 	SecureSocketImpl& operator = (const SecureSocketImpl&);
 
 	SSL* _pSSL;
+	BIO* _pReadBIO;
+	BIO* _pWriteBIO;
 	Poco::AutoPtr<SocketImpl> _pSocket;
 	Context::Ptr _pContext;
 	bool _needHandshake;
@@ -45,6 +45,24 @@ class NetSSL_API SecureStreamSocket: public StreamSocket
 	/// ERR_SSL_WANT_READ is returned, receiveBytes() must be called
 	/// as soon as data is available for reading (indicated by select()).
 	///
+	/// If the socket is in nonblocking mode before the SSL
+	/// handshake starts (e.g., when connected with connectNB(), or
+	/// when setBlocking(false) is called right after accepting the
+	/// connection), encrypted data is buffered in memory. This is
+	/// the mode to use with a SocketReactor: the handshake proceeds
+	/// a step at a time, driven by receiveBytes() calls from the
+	/// ReadableNotification handler, and the socket is never read
+	/// unless OpenSSL actually needs more data. Since a single
+	/// socket read may contain several SSL records, a
+	/// ReadableNotification handler should call receiveBytes() until
+	/// it returns ERR_SSL_WANT_READ (available() is not sufficient
+	/// for that). Encrypted data that could not be sent immediately
+	/// is kept until the socket becomes writable; while flush()
+	/// returns a nonzero value, the handler should listen for
+	/// WritableNotification and call flush() again from there.
+	/// sendBytes() returns ERR_SSL_WANT_WRITE once more than
+	/// SecureSocketImpl::MAX_PENDING_OUTPUT bytes are buffered.
+	///
 	/// The SSL handshake is delayed until the first sendBytes() or 
 	/// receiveBytes() operation is performed on the socket. No automatic
 	/// post connection check (checking the peer certificate for a valid
@@ -256,10 +274,27 @@ public:
 	bool sessionWasReused();
 		/// Returns true iff a reused session was negotiated during
 		/// the handshake.
+
+	std::string alpnProtocol() const;
+		/// Returns the application layer protocol negotiated
+		/// with ALPN during the handshake (see
+		/// Context::setALPNProtocols()), or an empty string
+		/// if no protocol has been negotiated.
 		
 	void abort();
 		/// Aborts the SSL connection by closing the underlying
 		/// TCP connection. No orderly SSL shutdown is performed.
+
+	int flush();
+		/// For a nonblocking socket, sends as much of the buffered
+		/// encrypted data as possible without blocking.
+		///
+		/// Returns the number of bytes still buffered. If nonzero,
+		/// flush() should be called again when the socket becomes
+		/// writable.
+
+	int pendingOutput() const;
+		/// Returns the number of encrypted bytes buffered for sending.
 		
 protected:
 	SecureStreamSocket(SocketImpl* pImpl);
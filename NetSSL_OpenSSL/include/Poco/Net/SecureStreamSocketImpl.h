@@ -112,6 +112,20 @@ public:
 		/// can be read from the currently buffered SSL record,
 		/// before a new record is read from the underlying socket.
 
+	void setBlocking(bool flag);
+		/// Sets the socket in blocking mode if flag is true,
+		/// disables blocking mode if flag is false.
+
+	int flush();
+		/// Sends as much of the encrypted data buffered for
+		/// a nonblocking socket as possible.
+		///
+		/// Returns the number of bytes still buffered.
+
+	int pendingOutput() const;
+		/// Returns the number of encrypted bytes buffered
+		/// for sending.
+
 	void shutdownReceive();
 		/// Shuts down the receiving part of the socket connection.
 		///
@@ -197,6 +211,12 @@ public:
 	bool sessionWasReused();
 		/// Returns true iff a reused session was negotiated during
 		/// the handshake.
+
+	std::string alpnProtocol() const;
+		/// Returns the application layer protocol negotiated
+		/// with ALPN during the handshake (see
+		/// Context::setALPNProtocols()), or an empty string
+		/// if no protocol has been negotiated.
 		
 protected:
 	void acceptSSL();
@@ -265,6 +285,24 @@ inline bool SecureStreamSocketImpl::sessionWasReused()
 }
 
 
+inline std::string SecureStreamSocketImpl::alpnProtocol() const
+{
+	return _impl.alpnProtocol();
+}
+
+
+inline int SecureStreamSocketImpl::flush()
+{
+	return _impl.flush();
+}
+
+
+inline int SecureStreamSocketImpl::pendingOutput() const
+{
+	return _impl.pendingOutput();
+}
+
+
 inline int SecureStreamSocketImpl::lastError()
 {
 	return SocketImpl::lastError();
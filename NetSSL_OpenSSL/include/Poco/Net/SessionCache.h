@@ -0,0 +1,80 @@
+//
+// SessionCache.h
+//
+// $Id$
+//
+// Library: NetSSL_OpenSSL
+// Package: SSLCore
+// Module:  SessionCache
+//
+// Definition of the SessionCache class.
+//
+// Copyright (c) 2010, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef NetSSL_SessionCache_INCLUDED
+#define NetSSL_SessionCache_INCLUDED
+
+
+#include "Poco/Net/NetSSL.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/Timestamp.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+class NetSSL_API SessionCache: public Poco::RefCountedObject
+	/// This is the interface of an external server-side SSL session cache.
+	///
+	/// OpenSSL keeps the sessions of a server in a cache that
+	/// belongs to a single Context object and thus to a single process.
+	/// A SessionCache set with Context::setSessionCache() receives
+	/// every new session in serialized form, and is asked for sessions
+	/// that could not be found in the Context's own cache. This allows
+	/// several Context objects, or several server processes (if the
+	/// SessionCache stores the sessions in shared memory or in a
+	/// network cache like memcached), to resume each other's sessions.
+	///
+	/// Implementations must be thread-safe, as they are called
+	/// from all threads doing SSL handshakes.
+	///
+	/// See MemorySessionCache for an implementation that keeps the
+	/// sessions in memory.
+{
+public:
+	typedef Poco::AutoPtr<SessionCache> Ptr;
+
+	virtual void add(const std::string& id, const std::string& session, const Poco::Timestamp& expires) = 0;
+		/// Stores the serialized session with the given session ID.
+		/// The session must not be returned by find() after
+		/// the given expiration time.
+
+	virtual bool find(const std::string& id, std::string& session) = 0;
+		/// Looks up the session with the given session ID.
+		/// Returns true and stores the serialized session in
+		/// session if found, or returns false otherwise.
+
+	virtual void remove(const std::string& id) = 0;
+		/// Removes the session with the given session ID,
+		/// e.g. because it has been invalidated by an error.
+
+protected:
+	SessionCache();
+		/// Creates the SessionCache.
+
+	virtual ~SessionCache();
+		/// Destroys the SessionCache.
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // NetSSL_SessionCache_INCLUDED
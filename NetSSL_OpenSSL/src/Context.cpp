@@ -24,8 +24,12 @@
 #include "Poco/Timestamp.h"
 #include <openssl/bio.h>
 #include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
 #include <openssl/ssl.h>
 #include <openssl/x509v3.h>
+#include <cstring>
 
 
 namespace Poco {
@@ -44,7 +48,9 @@ Context::Context(
 	_usage(usage),
 	_mode(verificationMode),
 	_pSSLContext(0),
-	_extendedCertificateVerification(true)
+	_extendedCertificateVerification(true),
+	_ticketsEnabled(false),
+	_clientSessions(DEFAULT_CLIENT_CACHE_SIZE)
 {
 	Poco::Crypto::OpenSSLInitializer::initialize();
 	
@@ -125,7 +131,9 @@ Context::Context(
 	_usage(usage),
 	_mode(verificationMode),
 	_pSSLContext(0),
-	_extendedCertificateVerification(true)
+	_extendedCertificateVerification(true),
+	_ticketsEnabled(false),
+	_clientSessions(DEFAULT_CLIENT_CACHE_SIZE)
 {
 	Poco::Crypto::OpenSSLInitializer::initialize();
 	
@@ -303,6 +311,104 @@ void Context::flushSessionCache()
 }
 
 
+void Context::setSessionCache(SessionCache::Ptr pCache)
+{
+	poco_assert (isForServerUse());
+
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	_pSessionCache = pCache;
+	if (pCache)
+	{
+		SSL_CTX_set_session_cache_mode(_pSSLContext, SSL_SESS_CACHE_SERVER);
+		SSL_CTX_sess_set_new_cb(_pSSLContext, &Context::newSessionCallback);
+		SSL_CTX_sess_set_get_cb(_pSSLContext, &Context::getSessionCallback);
+	}
+	else
+	{
+		SSL_CTX_sess_set_new_cb(_pSSLContext, 0);
+		SSL_CTX_sess_set_get_cb(_pSSLContext, 0);
+	}
+}
+
+
+void Context::enableSessionTickets(const Poco::Timespan& keyLifetime)
+{
+	poco_assert (isForServerUse());
+
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	_ticketKeyLifetime = keyLifetime;
+	if (_ticketKeys.empty())
+	{
+		unsigned char key[TICKET_KEY_SIZE];
+		if (RAND_bytes(key, TICKET_KEY_SIZE) != 1)
+			throw SSLContextException("Cannot generate session ticket key", Utility::getLastError());
+		addTicketKey(key);
+	}
+	installTicketKeyCallback();
+}
+
+
+void Context::addSessionTicketKey(const std::string& key)
+{
+	poco_assert (isForServerUse());
+
+	if (key.size() != TICKET_KEY_SIZE)
+		throw Poco::InvalidArgumentException("Session ticket keys must be 80 bytes long");
+
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	_ticketKeyLifetime = 0;
+	addTicketKey(reinterpret_cast<const unsigned char*>(key.data()));
+	installTicketKeyCallback();
+}
+
+
+void Context::rotateSessionTicketKeys()
+{
+	poco_assert (isForServerUse());
+
+	unsigned char key[TICKET_KEY_SIZE];
+	if (RAND_bytes(key, TICKET_KEY_SIZE) != 1)
+		throw SSLContextException("Cannot generate session ticket key", Utility::getLastError());
+
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	addTicketKey(key);
+}
+
+
+void Context::cacheClientSession(const std::string& peer, Session::Ptr pSession)
+{
+	poco_assert (!isForServerUse());
+
+	if (pSession)
+		_clientSessions.add(peer, pSession);
+	else
+		_clientSessions.remove(peer);
+}
+
+
+Session::Ptr Context::findClientSession(const std::string& peer)
+{
+	poco_assert (!isForServerUse());
+
+	Poco::SharedPtr<Session::Ptr> pEntry = _clientSessions.get(peer);
+	if (!pEntry) return 0;
+
+	Session::Ptr pSession = *pEntry;
+	SSL_SESSION* pSSLSession = pSession->sslSession();
+	Poco::Timestamp::TimeVal expires = static_cast<Poco::Timestamp::TimeVal>(SSL_SESSION_get_time(pSSLSession)) + SSL_SESSION_get_timeout(pSSLSession);
+	if (expires <= Poco::Timestamp().epochTime())
+	{
+		_clientSessions.remove(peer);
+		return 0;
+	}
+	return pSession;
+}
+
+
 void Context::enableExtendedCertificateVerification(bool flag)
 {
 	_extendedCertificateVerification = flag;
@@ -317,6 +423,34 @@ void Context::disableStatelessSessionResumption()
 }
 
 
+void Context::setALPNProtocols(const std::vector<std::string>& protocols)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+	std::string wire;
+	for (std::vector<std::string>::const_iterator it = protocols.begin(); it != protocols.end(); ++it)
+	{
+		if (it->empty() || it->size() > 255)
+			throw Poco::InvalidArgumentException("Invalid ALPN protocol name", *it);
+		wire += static_cast<char>(it->size());
+		wire += *it;
+	}
+	_alpnProtocols = protocols;
+	if (!isForServerUse())
+	{
+		// note: SSL_CTX_set_alpn_protos() returns 0 on success
+		if (SSL_CTX_set_alpn_protos(_pSSLContext, reinterpret_cast<const unsigned char*>(wire.data()), static_cast<unsigned>(wire.size())) != 0)
+			throw SSLContextException("Cannot set ALPN protocols");
+	}
+	else
+	{
+		SSL_CTX_set_alpn_select_cb(_pSSLContext, protocols.empty() ? 0 : &Context::alpnSelectCallback, this);
+	}
+#else
+	throw Poco::NotImplementedException("ALPN requires OpenSSL 1.0.2 or newer");
+#endif
+}
+
+
 void Context::createSSLContext()
 {
 	if (SSLManager::isFIPSEnabled())
@@ -366,9 +500,184 @@ void Context::createSSLContext()
 	}
 
 	SSL_CTX_set_default_passwd_cb(_pSSLContext, &SSLManager::privateKeyPassphraseCallback);
+	SSL_CTX_set_app_data(_pSSLContext, this);
 	Utility::clearErrorStack();
 	SSL_CTX_set_options(_pSSLContext, SSL_OP_ALL);
 }
 
 
+void Context::addTicketKey(const unsigned char* key)
+{
+	TicketKey ticketKey;
+	std::memcpy(ticketKey.name, key, sizeof(ticketKey.name));
+	std::memcpy(ticketKey.hmacKey, key + sizeof(ticketKey.name), sizeof(ticketKey.hmacKey));
+	std::memcpy(ticketKey.aesKey, key + sizeof(ticketKey.name) + sizeof(ticketKey.hmacKey), sizeof(ticketKey.aesKey));
+	_ticketKeys.push_front(ticketKey);
+	while (_ticketKeys.size() > MAX_TICKET_KEYS)
+	{
+		TicketKey& retired = _ticketKeys.back();
+		std::memset(retired.hmacKey, 0, sizeof(retired.hmacKey));
+		std::memset(retired.aesKey, 0, sizeof(retired.aesKey));
+		_ticketKeys.pop_back();
+	}
+}
+
+
+void Context::installTicketKeyCallback()
+{
+#if defined(SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB)
+	SSL_CTX_clear_options(_pSSLContext, SSL_OP_NO_TICKET);
+	SSL_CTX_set_tlsext_ticket_key_cb(_pSSLContext, &Context::ticketKeyCallback);
+	_ticketsEnabled = true;
+#else
+	throw Poco::NotImplementedException("Session tickets are not supported by this OpenSSL version");
+#endif
+}
+
+
+int Context::ticketKey(unsigned char* name, unsigned char* iv, EVP_CIPHER_CTX* pCipherContext, HMAC_CTX* pHMACContext, int enc)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	if (enc)
+	{
+		if (_ticketKeyLifetime > 0 && _ticketKeys.front().created.isElapsed(_ticketKeyLifetime.totalMicroseconds()))
+		{
+			unsigned char key[TICKET_KEY_SIZE];
+			if (RAND_bytes(key, TICKET_KEY_SIZE) == 1)
+				addTicketKey(key);
+		}
+		const TicketKey& key = _ticketKeys.front();
+		const EVP_CIPHER* pCipher = EVP_aes_256_cbc();
+		if (RAND_bytes(iv, EVP_CIPHER_iv_length(pCipher)) != 1) return -1;
+		std::memcpy(name, key.name, sizeof(key.name));
+		if (EVP_EncryptInit_ex(pCipherContext, pCipher, 0, key.aesKey, iv) != 1) return -1;
+		if (HMAC_Init_ex(pHMACContext, key.hmacKey, sizeof(key.hmacKey), EVP_sha256(), 0) != 1) return -1;
+		return 1;
+	}
+	else
+	{
+		for (TicketKeys::const_iterator it = _ticketKeys.begin(); it != _ticketKeys.end(); ++it)
+		{
+			if (std::memcmp(name, it->name, sizeof(it->name)) == 0)
+			{
+				if (HMAC_Init_ex(pHMACContext, it->hmacKey, sizeof(it->hmacKey), EVP_sha256(), 0) != 1) return -1;
+				if (EVP_DecryptInit_ex(pCipherContext, EVP_aes_256_cbc(), 0, it->aesKey, iv) != 1) return -1;
+				// tickets encrypted with a previous key are accepted, but renewed
+				return it == _ticketKeys.begin() ? 1 : 2;
+			}
+		}
+		// unknown or retired key, do a full handshake
+		return 0;
+	}
+}
+
+
+Context* Context::fromSSLContext(SSL_CTX* pSSLContext)
+{
+	return reinterpret_cast<Context*>(SSL_CTX_get_app_data(pSSLContext));
+}
+
+
+int Context::newSessionCallback(SSL* pSSL, SSL_SESSION* pSession)
+{
+	SessionCache::Ptr pCache = fromSSLContext(SSL_get_SSL_CTX(pSSL))->getSessionCache();
+	if (pCache)
+	{
+		unsigned idLength = 0;
+		const unsigned char* id = SSL_SESSION_get_id(pSession, &idLength);
+		int length = i2d_SSL_SESSION(pSession, 0);
+		if (idLength > 0 && length > 0)
+		{
+			std::string session(length, '\0');
+			unsigned char* p = reinterpret_cast<unsigned char*>(&session[0]);
+			i2d_SSL_SESSION(pSession, &p);
+			Poco::Timestamp expires = Poco::Timestamp::fromEpochTime(SSL_SESSION_get_time(pSession) + SSL_SESSION_get_timeout(pSession));
+			try
+			{
+				pCache->add(std::string(reinterpret_cast<const char*>(id), idLength), session, expires);
+			}
+			catch (...)
+			{
+				// must not propagate through OpenSSL; the session just won't be shared
+			}
+		}
+	}
+	// OpenSSL keeps its reference to the session
+	return 0;
+}
+
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+SSL_SESSION* Context::getSessionCallback(SSL* pSSL, const unsigned char* id, int length, int* pCopy)
+#else
+SSL_SESSION* Context::getSessionCallback(SSL* pSSL, unsigned char* id, int length, int* pCopy)
+#endif
+{
+	// the returned session's reference is passed to OpenSSL
+	*pCopy = 0;
+
+	SessionCache::Ptr pCache = fromSSLContext(SSL_get_SSL_CTX(pSSL))->getSessionCache();
+	if (!pCache) return 0;
+
+	std::string key(reinterpret_cast<const char*>(id), length);
+	std::string session;
+	try
+	{
+		if (!pCache->find(key, session)) return 0;
+	}
+	catch (...)
+	{
+		return 0;
+	}
+
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(session.data());
+	SSL_SESSION* pSession = d2i_SSL_SESSION(0, &p, static_cast<long>(session.size()));
+	if (!pSession)
+	{
+		Utility::clearErrorStack();
+		try
+		{
+			pCache->remove(key);
+		}
+		catch (...)
+		{
+		}
+	}
+	return pSession;
+}
+
+
+int Context::ticketKeyCallback(SSL* pSSL, unsigned char* name, unsigned char* iv, EVP_CIPHER_CTX* pCipherContext, HMAC_CTX* pHMACContext, int enc)
+{
+	return fromSSLContext(SSL_get_SSL_CTX(pSSL))->ticketKey(name, iv, pCipherContext, pHMACContext, enc);
+}
+
+
+int Context::alpnSelectCallback(SSL* pSSL, const unsigned char** out, unsigned char* outLength, const unsigned char* in, unsigned int inLength, void* arg)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+	const std::vector<std::string>& protocols = reinterpret_cast<Context*>(arg)->_alpnProtocols;
+	// use the server's order of preference
+	for (std::vector<std::string>::const_iterator it = protocols.begin(); it != protocols.end(); ++it)
+	{
+		unsigned int pos = 0;
+		while (pos < inLength)
+		{
+			unsigned int length = in[pos];
+			if (pos + 1 + length > inLength) break;
+			if (length == it->size() && std::memcmp(in + pos + 1, it->data(), length) == 0)
+			{
+				*out = in + pos + 1;
+				*outLength = static_cast<unsigned char>(length);
+				return SSL_TLSEXT_ERR_OK;
+			}
+			pos += 1 + length;
+		}
+	}
+#endif
+	return SSL_TLSEXT_ERR_NOACK;
+}
+
+
 } } // namespace Poco::Net
@@ -145,15 +145,25 @@ void HTTPSClientSession::proxyAuthenticate(HTTPRequest& request)
 
 void HTTPSClientSession::connect(const SocketAddress& address)
 {
+	bool cacheSessions = _pContext->sessionCacheEnabled();
+	std::string peer;
+	if (cacheSessions && !getHost().empty())
+	{
+		peer = getHost();
+		peer += ':';
+		NumberFormatter::append(peer, getPort());
+		if (!_pSession) _pSession = _pContext->findClientSession(peer);
+	}
+
 	if (getProxyHost().empty() || bypassProxy())
 	{
 		SecureStreamSocket sss(socket());
-		if (_pContext->sessionCacheEnabled())
+		if (cacheSessions)
 		{
 			sss.useSession(_pSession);
 		}
 		HTTPSession::connect(address);
-		if (_pContext->sessionCacheEnabled())
+		if (cacheSessions)
 		{
 			_pSession = sss.currentSession();
 		}
@@ -163,11 +173,16 @@ void HTTPSClientSession::connect(const SocketAddress& address)
 		StreamSocket proxySocket(proxyConnect());
 		SecureStreamSocket secureSocket = SecureStreamSocket::attach(proxySocket, getHost(), _pContext, _pSession);
 		attachSocket(secureSocket);
-		if (_pContext->sessionCacheEnabled())
+		if (cacheSessions)
 		{
 			_pSession = secureSocket.currentSession();
 		}
 	}
+
+	if (!peer.empty() && _pSession)
+	{
+		_pContext->cacheClientSession(peer, _pSession);
+	}
 }
 
 
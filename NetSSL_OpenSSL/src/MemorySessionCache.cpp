@@ -0,0 +1,77 @@
+//
+// MemorySessionCache.cpp
+//
+// $Id$
+//
+// Library: NetSSL_OpenSSL
+// Package: SSLCore
+// Module:  MemorySessionCache
+//
+// Copyright (c) 2010, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/MemorySessionCache.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+MemorySessionCache::MemorySessionCache(long size):
+	_cache(size)
+{
+}
+
+
+MemorySessionCache::~MemorySessionCache()
+{
+}
+
+
+void MemorySessionCache::add(const std::string& id, const std::string& session, const Poco::Timestamp& expires)
+{
+	Entry entry;
+	entry.session = session;
+	entry.expires = expires;
+	_cache.add(id, entry);
+}
+
+
+bool MemorySessionCache::find(const std::string& id, std::string& session)
+{
+	Poco::SharedPtr<Entry> pEntry = _cache.get(id);
+	if (!pEntry) return false;
+
+	if (pEntry->expires < Poco::Timestamp())
+	{
+		_cache.remove(id);
+		return false;
+	}
+	session = pEntry->session;
+	return true;
+}
+
+
+void MemorySessionCache::remove(const std::string& id)
+{
+	_cache.remove(id);
+}
+
+
+std::size_t MemorySessionCache::size()
+{
+	return _cache.size();
+}
+
+
+void MemorySessionCache::clear()
+{
+	_cache.clear();
+}
+
+
+} } // namespace Poco::Net
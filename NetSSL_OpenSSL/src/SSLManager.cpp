@@ -52,6 +52,8 @@ const std::string SSLManager::CFG_CACHE_SESSIONS("cacheSessions");
 const std::string SSLManager::CFG_SESSION_ID_CONTEXT("sessionIdContext");
 const std::string SSLManager::CFG_SESSION_CACHE_SIZE("sessionCacheSize");
 const std::string SSLManager::CFG_SESSION_TIMEOUT("sessionTimeout");
+const std::string SSLManager::CFG_SESSION_TICKETS("sessionTickets");
+const std::string SSLManager::CFG_SESSION_TICKET_KEY_LIFETIME("sessionTicketKeyLifetime");
 const std::string SSLManager::CFG_EXTENDED_VERIFICATION("extendedVerification");
 const std::string SSLManager::CFG_REQUIRE_TLSV1("requireTLSv1");
 const std::string SSLManager::CFG_REQUIRE_TLSV1_1("requireTLSv1_1");
@@ -305,6 +307,11 @@ void SSLManager::initDefaultContext(bool server)
 			int timeout = config.getInt(prefix + CFG_SESSION_TIMEOUT);
 			_ptrDefaultServerContext->setSessionTimeout(timeout);
 		}
+		if (config.getBool(prefix + CFG_SESSION_TICKETS, false))
+		{
+			int lifetime = config.getInt(prefix + CFG_SESSION_TICKET_KEY_LIFETIME, Context::DEFAULT_TICKET_KEY_LIFETIME);
+			_ptrDefaultServerContext->enableSessionTickets(Poco::Timespan(lifetime, 0));
+		}
 	}
 	else
 	{
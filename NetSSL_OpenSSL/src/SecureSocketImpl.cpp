@@ -49,6 +49,8 @@ namespace Net {
 
 SecureSocketImpl::SecureSocketImpl(Poco::AutoPtr<SocketImpl> pSocketImpl, Context::Ptr pContext): 
 	_pSSL(0),
+	_pReadBIO(0),
+	_pWriteBIO(0),
 	_pSocket(pSocketImpl),
 	_pContext(pContext),
 	_needHandshake(false)
@@ -87,17 +89,18 @@ void SecureSocketImpl::acceptSSL()
 {
 	poco_assert (!_pSSL);
 
-	BIO* pBIO = BIO_new(BIO_s_socket());
-	if (!pBIO) throw SSLException("Cannot create BIO object");
-	BIO_set_fd(pBIO, static_cast<int>(_pSocket->sockfd()), BIO_NOCLOSE);
-
 	_pSSL = SSL_new(_pContext->sslContext());
-	if (!_pSSL)
+	if (!_pSSL) throw SSLException("Cannot create SSL object");
+	try
 	{
-		BIO_free(pBIO);
-		throw SSLException("Cannot create SSL object");
+		attachBIO();
+	}
+	catch (...)
+	{
+		SSL_free(_pSSL);
+		_pSSL = 0;
+		throw;
 	}
-	SSL_set_bio(_pSSL, pBIO, pBIO);
 	SSL_set_accept_state(_pSSL);
 	_needHandshake = true;
 }
@@ -147,17 +150,8 @@ void SecureSocketImpl::connectSSL(bool performHandshake)
 	poco_assert (!_pSSL);
 	poco_assert (_pSocket->initialized());
 	
-	BIO* pBIO = BIO_new(BIO_s_socket());
-	if (!pBIO) throw SSLException("Cannot create SSL BIO object");
-	BIO_set_fd(pBIO, static_cast<int>(_pSocket->sockfd()), BIO_NOCLOSE);
-
 	_pSSL = SSL_new(_pContext->sslContext());
-	if (!_pSSL) 
-	{
-		BIO_free(pBIO);
-		throw SSLException("Cannot create SSL object");
-	}
-	SSL_set_bio(_pSSL, pBIO, pBIO);
+	if (!_pSSL) throw SSLException("Cannot create SSL object");
 	
 #if OPENSSL_VERSION_NUMBER >= 0x0908060L && !defined(OPENSSL_NO_TLSEXT)
 	if (!_peerHostName.empty())
@@ -173,6 +167,7 @@ void SecureSocketImpl::connectSSL(bool performHandshake)
 	
 	try
 	{
+		attachBIO();
 		if (performHandshake && _pSocket->getBlocking())
 		{
 			int ret = SSL_connect(_pSSL);
@@ -228,6 +223,7 @@ void SecureSocketImpl::shutdown()
 			// done with it.
 			int rc = SSL_shutdown(_pSSL);
 			if (rc < 0) handleError(rc);
+			flush();
 			if (_pSocket->getBlocking())
 			{
 				_pSocket->shutdown();
@@ -266,6 +262,7 @@ int SecureSocketImpl::sendBytes(const void* buffer, int length, int flags)
 		else
 			return rc;
 	}
+	if (_pWriteBIO) return sendBytesNB(buffer, length);
 	do
 	{
 		rc = SSL_write(_pSSL, buffer, length);
@@ -294,6 +291,7 @@ int SecureSocketImpl::receiveBytes(void* buffer, int length, int flags)
 		else
 			return rc;
 	}
+	if (_pReadBIO) return receiveBytesNB(buffer, length);
 	do
 	{
 		rc = SSL_read(_pSSL, buffer, length);
@@ -315,11 +313,81 @@ int SecureSocketImpl::available() const
 }
 
 
+void SecureSocketImpl::setBlocking(bool flag)
+{
+	_pSocket->setBlocking(flag);
+
+	// The BIO can only be replaced before the handshake
+	// has started, as OpenSSL may already have read ahead
+	// from the socket.
+	if (!flag && _pSSL && !_pReadBIO && _needHandshake && SSL_in_before(_pSSL))
+	{
+		useMemoryBIO();
+	}
+}
+
+
+int SecureSocketImpl::flush()
+{
+	if (!_pWriteBIO) return 0;
+
+	char* pData;
+	long pending = BIO_get_mem_data(_pWriteBIO, &pData);
+	long sent = 0;
+	while (sent < pending)
+	{
+		int rc;
+		do
+		{
+			rc = ::send(_pSocket->sockfd(), pData + sent, static_cast<int>(pending - sent), 0);
+		}
+		while (rc < 0 && SocketImpl::lastError() == POCO_EINTR);
+		if (rc < 0)
+		{
+			int err = SocketImpl::lastError();
+			if (err == POCO_EAGAIN && !_pSocket->getBlocking())
+				break;
+			else if (err == POCO_EAGAIN || err == POCO_ETIMEDOUT)
+				throw TimeoutException(err);
+			else
+				SocketImpl::error(err);
+		}
+		sent += rc;
+	}
+	if (sent == pending)
+	{
+		(void) BIO_reset(_pWriteBIO);
+	}
+	else if (sent > 0)
+	{
+		char discard[4096];
+		const long discardSize = sizeof(discard);
+		long n = sent;
+		while (n > 0)
+		{
+			n -= BIO_read(_pWriteBIO, discard, static_cast<int>(n < discardSize ? n : discardSize));
+		}
+	}
+	return static_cast<int>(pending - sent);
+}
+
+
+int SecureSocketImpl::pendingOutput() const
+{
+	if (_pWriteBIO)
+		return static_cast<int>(BIO_ctrl_pending(_pWriteBIO));
+	else
+		return 0;
+}
+
+
 int SecureSocketImpl::completeHandshake()
 {
 	poco_assert (_pSocket->initialized());
 	poco_check_ptr (_pSSL);
 
+	if (_pReadBIO) return handshakeNB();
+
 	int rc;
 	do
 	{
@@ -335,6 +403,104 @@ int SecureSocketImpl::completeHandshake()
 }
 
 
+int SecureSocketImpl::handshakeNB()
+{
+	for (;;)
+	{
+		int rc = SSL_do_handshake(_pSSL);
+		int pending = flush();
+		if (rc > 0)
+		{
+			_needHandshake = false;
+			return rc;
+		}
+		if (SSL_get_error(_pSSL, rc) != SSL_ERROR_WANT_READ)
+			return handleError(rc);
+		if (pending > 0)
+			return SecureStreamSocket::ERR_SSL_WANT_WRITE;
+		if (readSocket() < 0)
+			return SecureStreamSocket::ERR_SSL_WANT_READ;
+	}
+}
+
+
+int SecureSocketImpl::sendBytesNB(const void* buffer, int length)
+{
+	int pending = pendingOutput();
+	if (pending >= MAX_PENDING_OUTPUT)
+	{
+		pending = flush();
+		if (pending >= MAX_PENDING_OUTPUT)
+			return SecureStreamSocket::ERR_SSL_WANT_WRITE;
+	}
+	if (length > MAX_PENDING_OUTPUT - pending)
+		length = MAX_PENDING_OUTPUT - pending;
+
+	for (;;)
+	{
+		// All records produced by SSL_write() end up in the write
+		// buffer and are sent together, using as few system calls
+		// as the socket send buffer allows.
+		int rc = SSL_write(_pSSL, buffer, length);
+		if (rc > 0)
+		{
+			flush();
+			return rc;
+		}
+		if (SSL_get_error(_pSSL, rc) != SSL_ERROR_WANT_READ)
+		{
+			rc = handleError(rc);
+			if (rc == 0) throw SSLConnectionUnexpectedlyClosedException();
+			return rc;
+		}
+		if (flush() > 0)
+			return SecureStreamSocket::ERR_SSL_WANT_WRITE;
+		if (readSocket() < 0)
+			return SecureStreamSocket::ERR_SSL_WANT_READ;
+	}
+}
+
+
+int SecureSocketImpl::receiveBytesNB(void* buffer, int length)
+{
+	for (;;)
+	{
+		int rc = SSL_read(_pSSL, buffer, length);
+		if (rc > 0)
+		{
+			// SSL_read() may have produced handshake messages,
+			// e.g. session tickets or a key update.
+			if (BIO_ctrl_pending(_pWriteBIO) > 0) flush();
+			return rc;
+		}
+		if (SSL_get_error(_pSSL, rc) != SSL_ERROR_WANT_READ)
+			return handleError(rc);
+		if (flush() > 0)
+			return SecureStreamSocket::ERR_SSL_WANT_WRITE;
+		if (readSocket() < 0)
+			return SecureStreamSocket::ERR_SSL_WANT_READ;
+	}
+}
+
+
+int SecureSocketImpl::readSocket()
+{
+	char buffer[SSL3_RT_MAX_PLAIN_LENGTH + SSL3_RT_MAX_ENCRYPTED_OVERHEAD];
+	int n = _pSocket->receiveBytes(buffer, sizeof(buffer));
+	if (n > 0)
+	{
+		BIO_write(_pReadBIO, buffer, n);
+	}
+	else if (n == 0)
+	{
+		// Let OpenSSL see the end of the connection the
+		// same way it would when reading from the socket.
+		BIO_set_mem_eof_return(_pReadBIO, 0);
+	}
+	return n;
+}
+
+
 void SecureSocketImpl::verifyPeerCertificate()
 {
 	if (_peerHostName.empty())
@@ -395,7 +561,8 @@ int SecureSocketImpl::handleError(int rc)
 	if (rc > 0) return rc;
 
 	int sslError = SSL_get_error(_pSSL, rc);
-	int error = SocketImpl::lastError();
+	// socket errors are reported directly when using memory BIOs
+	int error = _pReadBIO ? 0 : SocketImpl::lastError();
 
 	switch (sslError)
 	{
@@ -477,7 +644,40 @@ void SecureSocketImpl::reset()
 	{
 		SSL_free(_pSSL);
 		_pSSL = 0;
+		_pReadBIO = 0;
+		_pWriteBIO = 0;
+	}
+}
+
+
+void SecureSocketImpl::attachBIO()
+{
+	if (_pSocket->getBlocking())
+	{
+		BIO* pBIO = BIO_new(BIO_s_socket());
+		if (!pBIO) throw SSLException("Cannot create BIO object");
+		BIO_set_fd(pBIO, static_cast<int>(_pSocket->sockfd()), BIO_NOCLOSE);
+		SSL_set_bio(_pSSL, pBIO, pBIO);
+	}
+	else useMemoryBIO();
+}
+
+
+void SecureSocketImpl::useMemoryBIO()
+{
+	BIO* pReadBIO = BIO_new(BIO_s_mem());
+	BIO* pWriteBIO = BIO_new(BIO_s_mem());
+	if (!pReadBIO || !pWriteBIO)
+	{
+		if (pReadBIO) BIO_free(pReadBIO);
+		if (pWriteBIO) BIO_free(pWriteBIO);
+		throw SSLException("Cannot create BIO object");
 	}
+	// an empty read buffer means "try again later", not end of file
+	BIO_set_mem_eof_return(pReadBIO, -1);
+	SSL_set_bio(_pSSL, pReadBIO, pWriteBIO);
+	_pReadBIO = pReadBIO;
+	_pWriteBIO = pWriteBIO;
 }
 
 
@@ -521,4 +721,19 @@ bool SecureSocketImpl::sessionWasReused()
 }
 
 
+std::string SecureSocketImpl::alpnProtocol() const
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+	if (_pSSL)
+	{
+		const unsigned char* data = 0;
+		unsigned length = 0;
+		SSL_get0_alpn_selected(_pSSL, &data, &length);
+		if (data) return std::string(reinterpret_cast<const char*>(data), length);
+	}
+#endif
+	return std::string();
+}
+
+
 } } // namespace Poco::Net
@@ -280,10 +280,28 @@ bool SecureStreamSocket::sessionWasReused()
 }
 
 
+std::string SecureStreamSocket::alpnProtocol() const
+{
+	return static_cast<SecureStreamSocketImpl*>(impl())->alpnProtocol();
+}
+
+
 void SecureStreamSocket::abort()
 {
 	static_cast<SecureStreamSocketImpl*>(impl())->abort();
 }
 
 
+int SecureStreamSocket::flush()
+{
+	return static_cast<SecureStreamSocketImpl*>(impl())->flush();
+}
+
+
+int SecureStreamSocket::pendingOutput() const
+{
+	return static_cast<SecureStreamSocketImpl*>(impl())->pendingOutput();
+}
+
+
 } } // namespace Poco::Net
@@ -153,6 +153,13 @@ int SecureStreamSocketImpl::available()
 }
 
 
+void SecureStreamSocketImpl::setBlocking(bool flag)
+{
+	StreamSocketImpl::setBlocking(flag);
+	_impl.setBlocking(flag);
+}
+
+
 void SecureStreamSocketImpl::shutdownReceive()
 {
 }
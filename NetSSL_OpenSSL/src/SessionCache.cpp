@@ -0,0 +1,34 @@
+//
+// SessionCache.cpp
+//
+// $Id$
+//
+// Library: NetSSL_OpenSSL
+// Package: SSLCore
+// Module:  SessionCache
+//
+// Copyright (c) 2010, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/SessionCache.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+SessionCache::SessionCache()
+{
+}
+
+
+SessionCache::~SessionCache()
+{
+}
+
+
+} } // namespace Poco::Net
@@ -25,11 +25,13 @@
 #include "Poco/Net/SecureStreamSocket.h"
 #include "Poco/Net/Context.h"
 #include "Poco/Net/Session.h"
+#include "Poco/Net/MemorySessionCache.h"
 #include "Poco/Net/SSLManager.h"
 #include "Poco/Net/SSLException.h"
 #include "Poco/Util/Application.h"
 #include "Poco/Util/AbstractConfiguration.h"
 #include "Poco/StreamCopier.h"
+#include "Poco/NumberFormatter.h"
 #include "Poco/Exception.h"
 #include "Poco/DateTimeFormatter.h"
 #include "Poco/DateTimeFormat.h"
@@ -415,6 +417,127 @@ void HTTPSClientSessionTest::testCachedSession()
 }
 
 
+void HTTPSClientSessionTest::testAutomaticSessionReuse()
+{
+	Context::Ptr pServerContext = new Context(
+		Context::SERVER_USE, 
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.caConfig"),
+		Context::VERIFY_NONE,
+		9,
+		true,
+		"ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");	
+	pServerContext->enableSessionCache(true, "TestSuite");
+	pServerContext->disableStatelessSessionResumption();
+
+	HTTPSTestServer srv(pServerContext);
+
+	Context::Ptr pClientContext = createClientContext();
+	
+	Session::Ptr pSession1 = getSmall(pClientContext, srv.port());
+	assert (!pSession1.isNull());
+	assert (pClientContext->findClientSession("localhost:" + Poco::NumberFormatter::format(srv.port())) == pSession1);
+
+	// no Session passed, the session of the previous connection is reused
+	Session::Ptr pSession2 = getSmall(pClientContext, srv.port());
+	assert (pSession1 == pSession2);
+
+	pClientContext->cacheClientSession("localhost:" + Poco::NumberFormatter::format(srv.port()), 0);
+	Session::Ptr pSession3 = getSmall(pClientContext, srv.port());
+	assert (pSession1 != pSession3);
+}
+
+
+void HTTPSClientSessionTest::testSessionTickets()
+{
+	Context::Ptr pServerContext = new Context(
+		Context::SERVER_USE, 
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.caConfig"),
+		Context::VERIFY_NONE,
+		9,
+		true,
+		"ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");	
+	pServerContext->enableSessionTickets();
+	assert (pServerContext->sessionTicketsEnabled());
+	assert (!pServerContext->sessionCacheEnabled());
+
+	HTTPSTestServer srv(pServerContext);
+
+	Context::Ptr pClientContext = createClientContext();
+
+	Session::Ptr pSession1 = getSmall(pClientContext, srv.port());
+	Session::Ptr pSession2 = getSmall(pClientContext, srv.port());
+	assert (pSession1 == pSession2);
+
+	// tickets encrypted with the previous key are still accepted
+	pServerContext->rotateSessionTicketKeys();
+	Session::Ptr pSession3 = getSmall(pClientContext, srv.port());
+	Session::Ptr pSession4 = getSmall(pClientContext, srv.port());
+	assert (pSession4 == pSession3);
+
+	// after MAX_TICKET_KEYS rotations, the ticket's key has been retired
+	for (int i = 0; i < Context::MAX_TICKET_KEYS; ++i)
+		pServerContext->rotateSessionTicketKeys();
+	Session::Ptr pSession5 = getSmall(pClientContext, srv.port());
+	assert (pSession5 != pSession4);
+
+	try
+	{
+		pServerContext->addSessionTicketKey("too short");
+		fail("invalid key - must throw");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+}
+
+
+void HTTPSClientSessionTest::testSharedSessionCache()
+{
+	MemorySessionCache::Ptr pCache = new MemorySessionCache;
+
+	Context::Ptr pServerContext1 = new Context(
+		Context::SERVER_USE, 
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.caConfig"),
+		Context::VERIFY_NONE,
+		9,
+		true,
+		"ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");	
+	pServerContext1->enableSessionCache(true, "TestSuite");
+	pServerContext1->disableStatelessSessionResumption();
+	pServerContext1->setSessionCache(pCache);
+
+	Context::Ptr pServerContext2 = new Context(
+		Context::SERVER_USE, 
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.caConfig"),
+		Context::VERIFY_NONE,
+		9,
+		true,
+		"ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");	
+	pServerContext2->enableSessionCache(true, "TestSuite");
+	pServerContext2->disableStatelessSessionResumption();
+	pServerContext2->setSessionCache(pCache);
+
+	HTTPSTestServer srv1(pServerContext1);
+	HTTPSTestServer srv2(pServerContext2);
+
+	Context::Ptr pClientContext = createClientContext();
+
+	// the session created by the first server is resumed by the second
+	Session::Ptr pSession1 = getSmall(pClientContext, srv1.port());
+	assert (pCache->size() == 1);
+	Session::Ptr pSession2 = getSmall(pClientContext, srv2.port(), pSession1);
+	assert (pSession1 == pSession2);
+}
+
+
 void HTTPSClientSessionTest::testUnknownContentLength()
 {
 	HTTPSTestServer srv;
@@ -449,6 +572,36 @@ void HTTPSClientSessionTest::testServerAbort()
 }
 
 
+Context::Ptr HTTPSClientSessionTest::createClientContext()
+{
+	Context::Ptr pClientContext = new Context(
+		Context::CLIENT_USE, 
+		Application::instance().config().getString("openSSL.client.privateKeyFile"),
+		Application::instance().config().getString("openSSL.client.privateKeyFile"),
+		Application::instance().config().getString("openSSL.client.caConfig"),
+		Context::VERIFY_RELAXED,
+		9,
+		true,
+		"ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+	pClientContext->enableSessionCache(true);
+	return pClientContext;
+}
+
+
+Session::Ptr HTTPSClientSessionTest::getSmall(Context::Ptr pClientContext, Poco::UInt16 port, Session::Ptr pSession)
+{
+	HTTPSClientSession s("localhost", port, pClientContext, pSession);
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/small");
+	s.sendRequest(request);
+	HTTPResponse response;
+	std::istream& rs = s.receiveResponse(response);
+	std::ostringstream ostr;
+	StreamCopier::copyStream(rs, ostr);
+	assert (ostr.str() == HTTPSTestServer::SMALL_BODY);
+	return s.sslSession();
+}
+
+
 void HTTPSClientSessionTest::setUp()
 {
 }
@@ -475,6 +628,9 @@ CppUnit::Test* HTTPSClientSessionTest::suite()
 	CppUnit_addTest(pSuite, HTTPSClientSessionTest, testInterop);
 	CppUnit_addTest(pSuite, HTTPSClientSessionTest, testProxy);
 	CppUnit_addTest(pSuite, HTTPSClientSessionTest, testCachedSession);
+	CppUnit_addTest(pSuite, HTTPSClientSessionTest, testAutomaticSessionReuse);
+	CppUnit_addTest(pSuite, HTTPSClientSessionTest, testSessionTickets);
+	CppUnit_addTest(pSuite, HTTPSClientSessionTest, testSharedSessionCache);
 	CppUnit_addTest(pSuite, HTTPSClientSessionTest, testUnknownContentLength);
 	CppUnit_addTest(pSuite, HTTPSClientSessionTest, testServerAbort);
 
@@ -17,6 +17,8 @@
 
 
 #include "Poco/Net/Net.h"
+#include "Poco/Net/Context.h"
+#include "Poco/Net/Session.h"
 #include "CppUnit/TestCase.h"
 
 
@@ -38,6 +40,9 @@ public:
 	void testInterop();
 	void testProxy();
 	void testCachedSession();
+	void testAutomaticSessionReuse();
+	void testSessionTickets();
+	void testSharedSessionCache();
 	void testUnknownContentLength();
 	void testServerAbort();
 
@@ -48,6 +53,8 @@ public:
 	static CppUnit::Test* suite();
 
 private:
+	Poco::Net::Context::Ptr createClientContext();
+	Poco::Net::Session::Ptr getSmall(Poco::Net::Context::Ptr pClientContext, Poco::UInt16 port, Poco::Net::Session::Ptr pSession = 0);
 };
 
 
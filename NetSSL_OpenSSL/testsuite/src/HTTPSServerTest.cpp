@@ -23,6 +23,12 @@
 #include "Poco/Net/HTTPResponse.h"
 #include "Poco/Net/HTTPServerResponse.h"
 #include "Poco/Net/SecureServerSocket.h"
+#include "Poco/Net/SecureStreamSocket.h"
+#include "Poco/Net/HTTP2ClientSession.h"
+#include "Poco/Net/HTTP2Stream.h"
+#include "Poco/Net/Context.h"
+#include "Poco/Util/Application.h"
+#include "Poco/Util/AbstractConfiguration.h"
 #include "Poco/StreamCopier.h"
 #include <sstream>
 
@@ -38,6 +44,13 @@ using Poco::Net::HTTPResponse;
 using Poco::Net::HTTPServerResponse;
 using Poco::Net::HTTPMessage;
 using Poco::Net::SecureServerSocket;
+using Poco::Net::SecureStreamSocket;
+using Poco::Net::HTTP2ClientSession;
+using Poco::Net::HTTP2Stream;
+using Poco::Net::HTTP2InputStream;
+using Poco::Net::Context;
+using Poco::Net::SocketAddress;
+using Poco::Util::Application;
 using Poco::StreamCopier;
 
 
@@ -324,6 +337,70 @@ void HTTPSServerTest::testNotImpl()
 }
 
 
+void HTTPSServerTest::testHTTP2()
+{
+	Context::Ptr pServerContext = new Context(
+		Context::SERVER_USE,
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.privateKeyFile"),
+		Application::instance().config().getString("openSSL.server.caConfig"),
+		Context::VERIFY_NONE,
+		9,
+		true,
+		"ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+	std::vector<std::string> serverProtocols;
+	serverProtocols.push_back("h2");
+	serverProtocols.push_back("http/1.1");
+	pServerContext->setALPNProtocols(serverProtocols);
+
+	Context::Ptr pClientContext = new Context(
+		Context::CLIENT_USE,
+		Application::instance().config().getString("openSSL.client.privateKeyFile"),
+		Application::instance().config().getString("openSSL.client.privateKeyFile"),
+		Application::instance().config().getString("openSSL.client.caConfig"),
+		Context::VERIFY_RELAXED,
+		9,
+		true,
+		"ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+	std::vector<std::string> clientProtocols;
+	clientProtocols.push_back("http/1.1");
+	clientProtocols.push_back("h2");
+	pClientContext->setALPNProtocols(clientProtocols);
+
+	SecureServerSocket svs(0, 64, pServerContext);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setHTTP2Enabled(true);
+	HTTPServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	SecureStreamSocket ss(SocketAddress("localhost", svs.address().port()), pClientContext);
+	ss.completeHandshake();
+	// the server's preference wins
+	assert (ss.alpnProtocol() == "h2");
+
+	HTTP2ClientSession cs(ss);
+	std::string body(100000, 'x');
+	HTTPRequest request(HTTPRequest::HTTP_POST, "/echoBody");
+	request.setContentType("text/plain");
+	HTTP2Stream::Ptr pStream = cs.sendRequest(request, body);
+	HTTPResponse response;
+	cs.receiveResponse(pStream, response);
+	assert (response.getStatus() == HTTPResponse::HTTP_OK);
+	assert (response.getVersion() == "HTTP/2.0");
+	assert (response.getContentType() == "text/plain");
+	HTTP2InputStream istr(pStream);
+	std::string rbody;
+	StreamCopier::copyToString(istr, rbody);
+	assert (rbody == body);
+	cs.close();
+
+	// without ALPN, no protocol is negotiated
+	SecureStreamSocket ss2(SocketAddress("localhost", svs.address().port()));
+	ss2.completeHandshake();
+	assert (ss2.alpnProtocol().empty());
+}
+
+
 void HTTPSServerTest::setUp()
 {
 }
@@ -346,6 +423,7 @@ CppUnit::Test* HTTPSServerTest::suite()
 	CppUnit_addTest(pSuite, HTTPSServerTest, testRedirect);
 	CppUnit_addTest(pSuite, HTTPSServerTest, testAuth);
 	CppUnit_addTest(pSuite, HTTPSServerTest, testNotImpl);
+	CppUnit_addTest(pSuite, HTTPSServerTest, testHTTP2);
 
 	return pSuite;
 }
@@ -34,6 +34,7 @@ public:
 	void testRedirect();
 	void testAuth();
 	void testNotImpl();
+	void testHTTP2();
 
 	void setUp();
 	void tearDown();
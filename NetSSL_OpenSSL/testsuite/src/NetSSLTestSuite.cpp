@@ -16,6 +16,7 @@
 #include "TCPServerTestSuite.h"
 #include "HTTPSServerTestSuite.h"
 #include "WebSocketTestSuite.h"
+#include "SecureStreamSocketTestSuite.h"
 
 
 CppUnit::Test* NetSSLTestSuite::suite()
@@ -27,6 +28,7 @@ CppUnit::Test* NetSSLTestSuite::suite()
 	pSuite->addTest(TCPServerTestSuite::suite());
 	pSuite->addTest(HTTPSServerTestSuite::suite());
 	pSuite->addTest(WebSocketTestSuite::suite());
+	pSuite->addTest(SecureStreamSocketTestSuite::suite());
 
 	return pSuite;
 }
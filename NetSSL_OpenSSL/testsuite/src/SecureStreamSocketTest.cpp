@@ -0,0 +1,281 @@
+//
+// SecureStreamSocketTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2006, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "SecureStreamSocketTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/SocketReactor.h"
+#include "Poco/Net/SocketNotification.h"
+#include "Poco/Net/SocketAcceptor.h"
+#include "Poco/Net/SecureStreamSocket.h"
+#include "Poco/Net/SecureServerSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Observer.h"
+#include "Poco/Thread.h"
+#include "Poco/Timespan.h"
+#include "Poco/Exception.h"
+#include <algorithm>
+#include <iostream>
+
+
+using Poco::Net::SocketReactor;
+using Poco::Net::SocketAcceptor;
+using Poco::Net::ReadableNotification;
+using Poco::Net::WritableNotification;
+using Poco::Net::Socket;
+using Poco::Net::StreamSocket;
+using Poco::Net::SecureStreamSocket;
+using Poco::Net::SecureServerSocket;
+using Poco::Net::SocketAddress;
+using Poco::Observer;
+using Poco::Thread;
+using Poco::Timespan;
+
+
+namespace
+{
+	class SecureEchoServiceHandler
+		/// Echoes everything it receives, using nonblocking I/O
+		/// the way a SocketReactor-based TLS server would.
+	{
+	public:
+		SecureEchoServiceHandler(StreamSocket& socket, SocketReactor& reactor):
+			_socket(socket),
+			_reactor(reactor),
+			_writable(false)
+		{
+			_socket.setBlocking(false);
+			_reactor.addEventHandler(_socket, Observer<SecureEchoServiceHandler, ReadableNotification>(*this, &SecureEchoServiceHandler::onReadable));
+		}
+
+		~SecureEchoServiceHandler()
+		{
+			_reactor.removeEventHandler(_socket, Observer<SecureEchoServiceHandler, ReadableNotification>(*this, &SecureEchoServiceHandler::onReadable));
+			if (_writable)
+			{
+				_reactor.removeEventHandler(_socket, Observer<SecureEchoServiceHandler, WritableNotification>(*this, &SecureEchoServiceHandler::onWritable));
+			}
+		}
+
+		void onReadable(ReadableNotification* pNf)
+		{
+			pNf->release();
+			process();
+		}
+
+		void onWritable(WritableNotification* pNf)
+		{
+			pNf->release();
+			process();
+		}
+
+	private:
+		void process()
+		{
+			try
+			{
+				char buffer[4096];
+				int n;
+				// a single socket read may yield several SSL records
+				while ((n = _socket.receiveBytes(buffer, sizeof(buffer))) > 0)
+				{
+					_pending.append(buffer, n);
+				}
+				if (n == 0)
+				{
+					delete this;
+					return;
+				}
+				while (!_pending.empty() && (n = _socket.sendBytes(_pending.data(), static_cast<int>(_pending.size()))) > 0)
+				{
+					_pending.erase(0, n);
+				}
+				bool writable = !_pending.empty() || _socket.flush() > 0;
+				if (writable != _writable)
+				{
+					Observer<SecureEchoServiceHandler, WritableNotification> observer(*this, &SecureEchoServiceHandler::onWritable);
+					if (writable)
+						_reactor.addEventHandler(_socket, observer);
+					else
+						_reactor.removeEventHandler(_socket, observer);
+					_writable = writable;
+				}
+			}
+			catch (Poco::Exception& exc)
+			{
+				std::cerr << "SecureEchoServiceHandler: " << exc.displayText() << std::endl;
+				delete this;
+			}
+		}
+
+		SecureStreamSocket _socket;
+		SocketReactor&     _reactor;
+		std::string        _pending;
+		bool               _writable;
+	};
+
+	std::string makeData(std::size_t size)
+	{
+		std::string data;
+		data.reserve(size);
+		for (std::size_t i = 0; i < size; ++i)
+			data += static_cast<char>('a' + i % 26);
+		return data;
+	}
+
+	std::string echo(const SocketAddress& address, const std::string& data)
+	{
+		SecureStreamSocket ss(address);
+		std::size_t sent = 0;
+		while (sent < data.size())
+		{
+			sent += ss.sendBytes(data.data() + sent, static_cast<int>(data.size() - sent));
+		}
+		std::string result;
+		char buffer[8192];
+		while (result.size() < data.size())
+		{
+			int n = ss.receiveBytes(buffer, sizeof(buffer));
+			if (n <= 0) break;
+			result.append(buffer, n);
+		}
+		ss.close();
+		return result;
+	}
+}
+
+
+SecureStreamSocketTest::SecureStreamSocketTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+SecureStreamSocketTest::~SecureStreamSocketTest()
+{
+}
+
+
+void SecureStreamSocketTest::testReactorEcho()
+{
+	SecureServerSocket svs(0);
+	SocketReactor reactor;
+	SocketAcceptor<SecureEchoServiceHandler> acceptor(svs, reactor);
+	Thread thread;
+	thread.start(reactor);
+
+	SocketAddress sa("localhost", svs.address().port());
+	for (int i = 0; i < 3; ++i)
+	{
+		std::string data("hello, world");
+		assert (echo(sa, data) == data);
+	}
+
+	reactor.stop();
+	thread.join();
+}
+
+
+void SecureStreamSocketTest::testReactorLargeData()
+{
+	SecureServerSocket svs(0);
+	SocketReactor reactor;
+	SocketAcceptor<SecureEchoServiceHandler> acceptor(svs, reactor);
+	Thread thread;
+	thread.start(reactor);
+
+	// more than SecureSocketImpl::MAX_PENDING_OUTPUT, so that the
+	// server's sendBytes() has to report ERR_SSL_WANT_WRITE
+	SocketAddress sa("localhost", svs.address().port());
+	std::string data = makeData(1024*1024);
+	assert (echo(sa, data) == data);
+
+	reactor.stop();
+	thread.join();
+}
+
+
+void SecureStreamSocketTest::testNonBlockingClient()
+{
+	SecureServerSocket svs(0);
+	SocketReactor reactor;
+	SocketAcceptor<SecureEchoServiceHandler> acceptor(svs, reactor);
+	Thread thread;
+	thread.start(reactor);
+
+	SecureStreamSocket ss;
+	ss.connectNB(SocketAddress("localhost", svs.address().port()));
+	int rc;
+	while ((rc = ss.completeHandshake()) != 1)
+	{
+		assert (rc == SecureStreamSocket::ERR_SSL_WANT_READ || rc == SecureStreamSocket::ERR_SSL_WANT_WRITE);
+		int mode = rc == SecureStreamSocket::ERR_SSL_WANT_READ ? Socket::SELECT_READ : Socket::SELECT_WRITE;
+		if (!ss.poll(Timespan(10, 0), mode)) fail ("handshake timed out");
+	}
+
+	std::string data = makeData(300000);
+	std::string result;
+	std::size_t sent = 0;
+	char buffer[8192];
+	while (result.size() < data.size())
+	{
+		if (sent < data.size())
+		{
+			int n = ss.sendBytes(data.data() + sent, static_cast<int>(std::min<std::size_t>(data.size() - sent, 100000)));
+			if (n > 0) sent += n;
+			else assert (n == SecureStreamSocket::ERR_SSL_WANT_WRITE);
+		}
+		int n = ss.receiveBytes(buffer, sizeof(buffer));
+		if (n > 0)
+		{
+			result.append(buffer, n);
+		}
+		else
+		{
+			assert (n < 0);
+			int mode = Socket::SELECT_READ;
+			if (ss.flush() > 0) mode |= Socket::SELECT_WRITE;
+			if (sent == data.size() || mode != Socket::SELECT_READ)
+			{
+				if (!ss.poll(Timespan(10, 0), mode)) fail ("echo timed out");
+			}
+		}
+	}
+	assert (result == data);
+	assert (ss.flush() == 0);
+	assert (ss.pendingOutput() == 0);
+	ss.close();
+
+	reactor.stop();
+	thread.join();
+}
+
+
+void SecureStreamSocketTest::setUp()
+{
+}
+
+
+void SecureStreamSocketTest::tearDown()
+{
+}
+
+
+CppUnit::Test* SecureStreamSocketTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("SecureStreamSocketTest");
+
+	CppUnit_addTest(pSuite, SecureStreamSocketTest, testReactorEcho);
+	CppUnit_addTest(pSuite, SecureStreamSocketTest, testReactorLargeData);
+	CppUnit_addTest(pSuite, SecureStreamSocketTest, testNonBlockingClient);
+
+	return pSuite;
+}
@@ -23,6 +23,7 @@
 #include "Poco/SevenZip/SevenZip.h"
 #include "Poco/SevenZip/ArchiveEntry.h"
 #include "Poco/BasicEvent.h"
+#include "Poco/ThreadPool.h"
 #include <vector>
 #include <utility>
 
@@ -92,6 +93,20 @@ public:
 		///
 		/// Progress and errors for single entries will be reported
 		/// via the extracted and failed events.
+
+	void extract(const std::string& destPath, Poco::ThreadPool& threadPool);
+		/// Extracts the entire archive to the given path, using
+		/// threads from the given thread pool.
+		///
+		/// The entries of a folder (a solid block) are extracted
+		/// together, so that the folder is decoded only once, while
+		/// independent folders are decoded concurrently, each from
+		/// its own handle to the archive file. If the pool has no
+		/// thread available, a folder is extracted on the calling
+		/// thread. Returns when all entries have been extracted.
+		///
+		/// The extracted and failed events are fired from the pool's
+		/// threads, and not in the order of the entries.
 		
 	std::string extract(const ArchiveEntry& entry, const std::string& destPath);
 		/// Extracts a specific entry to the given path.
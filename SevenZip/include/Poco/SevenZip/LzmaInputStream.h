@@ -0,0 +1,128 @@
+//
+// LzmaInputStream.h
+//
+// $Id$
+//
+// Library: SevenZip
+// Package: SevenZip
+// Module:  LzmaStream
+//
+// Definition of the LzmaInputStreamBuf and LzmaInputStream classes.
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef SevenZip_LzmaInputStream_INCLUDED
+#define SevenZip_LzmaInputStream_INCLUDED
+
+
+#include "Poco/SevenZip/SevenZip.h"
+#include "Poco/BufferedStreamBuf.h"
+#include <istream>
+
+
+namespace Poco {
+namespace SevenZip {
+
+
+class SevenZip_API LzmaInputStreamBuf: public Poco::BufferedStreamBuf
+	/// This is the streambuf class used by LzmaInputStream.
+	/// The actual work is delegated to the LZMA SDK.
+	///
+	/// Both streams written by LzmaOutputStream and .xz files
+	/// created by other tools can be decompressed. Concatenated
+	/// .xz streams are decompressed as a single stream.
+{
+public:
+	enum StreamType
+	{
+		STREAM_LZMA2, /// A raw LZMA2 stream, preceded by the LZMA2 property byte (dictionary size).
+		STREAM_XZ     /// An .xz stream.
+	};
+
+	LzmaInputStreamBuf(std::istream& istr, StreamType type);
+		/// Creates a LzmaInputStreamBuf for decompressing data read
+		/// from the given input stream.
+
+	~LzmaInputStreamBuf();
+		/// Destroys the LzmaInputStreamBuf.
+
+protected:
+	int readFromDevice(char* buffer, std::streamsize length);
+
+private:
+	enum
+	{
+		STREAM_BUFFER_SIZE = 65536,
+		INPUT_BUFFER_SIZE = 65536
+	};
+
+	struct Decoder;
+
+	bool fillInput();
+
+	std::istream* _pIstr;
+	StreamType _type;
+	Decoder* _pDecoder;
+	char* _buffer;
+	std::size_t _pos;
+	std::size_t _size;
+	bool _inputEnd;
+	bool _eof;
+	bool _initialized;
+};
+
+
+class SevenZip_API LzmaInputIOS: public virtual std::ios
+	/// The base class for LzmaInputStream.
+	///
+	/// This class is needed to ensure the correct initialization
+	/// order of the stream buffer and base classes.
+{
+public:
+	LzmaInputIOS(std::istream& istr, LzmaInputStreamBuf::StreamType type);
+		/// Creates a LzmaInputIOS for decompressing data read
+		/// from the given input stream.
+
+	~LzmaInputIOS();
+		/// Destroys the LzmaInputIOS.
+
+	LzmaInputStreamBuf* rdbuf();
+		/// Returns a pointer to the underlying stream buffer.
+
+protected:
+	LzmaInputStreamBuf _buf;
+};
+
+
+class SevenZip_API LzmaInputStream: public LzmaInputIOS, public std::istream
+	/// This stream decompresses LZMA2 or .xz compressed data
+	/// read from another input stream.
+	///
+	/// Example:
+	///     std::ifstream istr("data.xz", std::ios::binary);
+	///     LzmaInputStream xz(istr, LzmaInputStreamBuf::STREAM_XZ);
+	///     std::string data;
+	///     Poco::StreamCopier::copyToString(xz, data);
+	///
+	/// Corrupt data is reported by throwing a Poco::DataFormatException
+	/// from the read operation, which sets the stream's badbit.
+{
+public:
+	LzmaInputStream(std::istream& istr, LzmaInputStreamBuf::StreamType type = LzmaInputStreamBuf::STREAM_XZ);
+		/// Creates a LzmaInputStream for decompressing data read
+		/// from the given input stream.
+
+	~LzmaInputStream();
+		/// Destroys the LzmaInputStream.
+};
+
+
+} } // namespace Poco::SevenZip
+
+
+#endif // SevenZip_LzmaInputStream_INCLUDED
@@ -0,0 +1,212 @@
+//
+// LzmaOutputStream.h
+//
+// $Id$
+//
+// Library: SevenZip
+// Package: SevenZip
+// Module:  LzmaStream
+//
+// Definition of the LzmaOutputStreamBuf and LzmaOutputStream classes.
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef SevenZip_LzmaOutputStream_INCLUDED
+#define SevenZip_LzmaOutputStream_INCLUDED
+
+
+#include "Poco/SevenZip/SevenZip.h"
+#include "Poco/BufferedStreamBuf.h"
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/ThreadPool.h"
+#include <ostream>
+#include <vector>
+#include <deque>
+
+
+namespace Poco {
+namespace SevenZip {
+
+
+class SevenZip_API LzmaOutputStreamBuf: public Poco::BufferedStreamBuf
+	/// This is the streambuf class used by LzmaOutputStream.
+	/// The actual work is delegated to the LZMA SDK.
+	///
+	/// The data is split into blocks that are compressed independently,
+	/// so that several blocks can be compressed at the same time on the
+	/// threads of a thread pool. Each block uses its own
+	/// dictionary. The default block size is four times the dictionary
+	/// size, but at least 1 MB.
+	///
+	/// Output streams must call close() to ensure proper completion
+	/// of compression.
+{
+public:
+	enum StreamType
+	{
+		STREAM_LZMA2, /// A raw LZMA2 stream, preceded by the LZMA2 property byte (dictionary size).
+		STREAM_XZ     /// An .xz stream with CRC-32 checks, which can be decompressed by the xz utility.
+	};
+
+	enum
+	{
+		DEFAULT_LEVEL = 5
+			/// Default compression level (0 to 9).
+	};
+
+	LzmaOutputStreamBuf(std::ostream& ostr, StreamType type, int level, Poco::UInt32 dictionarySize, int threads);
+		/// Creates a LzmaOutputStreamBuf for compressing data passed
+		/// through and forwarding it to the given output stream.
+		///
+		/// If dictionarySize is 0, the dictionary size is determined
+		/// by the compression level. If threads is greater than 1,
+		/// up to the given number of blocks are compressed at the same
+		/// time on the default thread pool.
+
+	LzmaOutputStreamBuf(std::ostream& ostr, StreamType type, int level, Poco::UInt32 dictionarySize, int threads, Poco::ThreadPool& threadPool);
+		/// Creates a LzmaOutputStreamBuf that compresses up to the given
+		/// number of blocks at the same time on the given thread pool.
+		/// If no thread is available, a block is compressed on the
+		/// calling thread.
+
+	~LzmaOutputStreamBuf();
+		/// Destroys the LzmaOutputStreamBuf.
+
+	int close();
+		/// Compresses the remaining data and finishes up the stream.
+		///
+		/// Must be called when compression is complete.
+
+	Poco::UInt32 dictionarySize() const;
+		/// Returns the dictionary size used by the encoder.
+
+	std::size_t blockSize() const;
+		/// Returns the size of the blocks compressed independently.
+
+protected:
+	int writeToDevice(const char* buffer, std::streamsize length);
+
+private:
+	enum
+	{
+		STREAM_BUFFER_SIZE = 65536,
+		MIN_BLOCK_SIZE = 1024*1024
+	};
+
+	class Block;
+	typedef Poco::SharedPtr<Block> BlockPtr;
+	typedef std::deque<BlockPtr> BlockQueue;
+
+	void init(Poco::UInt32 dictionarySize);
+	void queueBlock();
+	void writeBlocks(std::size_t maxPending);
+
+	std::ostream* _pOstr;
+	Poco::ThreadPool* _pThreadPool;
+	StreamType _type;
+	int _level;
+	Poco::UInt32 _dictionarySize;
+	int _threads;
+	std::size_t _blockSize;
+	std::vector<char> _input;
+	BlockQueue _blocks;
+	bool _blocksWritten;
+	bool _closed;
+	Poco::FastMutex _mutex;
+	Poco::Condition _blockDone;
+};
+
+
+class SevenZip_API LzmaOutputIOS: public virtual std::ios
+	/// The base class for LzmaOutputStream.
+	///
+	/// This class is needed to ensure the correct initialization
+	/// order of the stream buffer and base classes.
+{
+public:
+	LzmaOutputIOS(std::ostream& ostr, LzmaOutputStreamBuf::StreamType type, int level, Poco::UInt32 dictionarySize, int threads);
+		/// Creates a LzmaOutputIOS for compressing data passed
+		/// through and forwarding it to the given output stream.
+
+	LzmaOutputIOS(std::ostream& ostr, LzmaOutputStreamBuf::StreamType type, int level, Poco::UInt32 dictionarySize, int threads, Poco::ThreadPool& threadPool);
+		/// Creates a LzmaOutputIOS for compressing data passed
+		/// through and forwarding it to the given output stream,
+		/// using the given thread pool.
+
+	~LzmaOutputIOS();
+		/// Destroys the LzmaOutputIOS.
+
+	LzmaOutputStreamBuf* rdbuf();
+		/// Returns a pointer to the underlying stream buffer.
+
+protected:
+	LzmaOutputStreamBuf _buf;
+};
+
+
+class SevenZip_API LzmaOutputStream: public LzmaOutputIOS, public std::ostream
+	/// This stream compresses all data passing through it
+	/// using LZMA2, either as raw LZMA2 stream or in the .xz
+	/// container format.
+	///
+	/// After all data has been written to the stream, close()
+	/// must be called to ensure completion of compression.
+	///
+	/// Example:
+	///     std::ofstream ostr("data.xz", std::ios::binary);
+	///     LzmaOutputStream xz(ostr, LzmaOutputStreamBuf::STREAM_XZ, 6, 0, 4);
+	///     xz << "Hello, world!" << std::endl;
+	///     xz.close();
+	///     ostr.close();
+{
+public:
+	LzmaOutputStream(std::ostream& ostr, LzmaOutputStreamBuf::StreamType type = LzmaOutputStreamBuf::STREAM_XZ, int level = LzmaOutputStreamBuf::DEFAULT_LEVEL, Poco::UInt32 dictionarySize = 0, int threads = 1);
+		/// Creates a LzmaOutputStream for compressing data passed
+		/// through and forwarding it to the given output stream.
+		///
+		/// See LzmaOutputStreamBuf for a description of the parameters.
+
+	LzmaOutputStream(std::ostream& ostr, LzmaOutputStreamBuf::StreamType type, int level, Poco::UInt32 dictionarySize, int threads, Poco::ThreadPool& threadPool);
+		/// Creates a LzmaOutputStream for compressing data passed
+		/// through and forwarding it to the given output stream,
+		/// compressing blocks on the given thread pool.
+		///
+		/// See LzmaOutputStreamBuf for a description of the parameters.
+
+	~LzmaOutputStream();
+		/// Destroys the LzmaOutputStream.
+
+	int close();
+		/// Finishes up the stream.
+		///
+		/// Must be called to ensure all data is properly written to
+		/// the target output stream.
+};
+
+
+//
+// inlines
+//
+inline Poco::UInt32 LzmaOutputStreamBuf::dictionarySize() const
+{
+	return _dictionarySize;
+}
+
+
+inline std::size_t LzmaOutputStreamBuf::blockSize() const
+{
+	return _blockSize;
+}
+
+
+} } // namespace Poco::SevenZip
+
+
+#endif // SevenZip_LzmaOutputStream_INCLUDED
@@ -25,6 +25,9 @@
 #include "Poco/File.h"
 #include "Poco/Path.h"
 #include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/SharedPtr.h"
 #include "7z.h"
 #include "7zAlloc.h"
 #include "7zCrc.h"
@@ -77,7 +80,65 @@ public:
 		return _entries.end();
 	}
 	
+	struct ExtractCache
+		/// Holds the decoded folder (solid block) of the most
+		/// recently extracted file, so that files from the same
+		/// folder can be extracted without decoding it again.
+	{
+		ExtractCache():
+			blockIndex(0xFFFFFFFF),
+			pOutBuffer(0),
+			outBufferSize(0)
+		{
+		}
+		
+		~ExtractCache()
+		{
+			IAlloc_Free(&_szAlloc, pOutBuffer);
+		}
+		
+		Poco::UInt32 blockIndex;
+		Byte* pOutBuffer;
+		std::size_t outBufferSize;
+	};
+	
+	class Reader
+		/// A separate read stream for the archive file, used by
+		/// threads extracting entries concurrently.
+	{
+	public:
+		Reader(const std::string& path)
+		{
+			FileInStream_CreateVTable(&_archiveStream);
+			LookToRead_CreateVTable(&_lookStream, False);
+			openFile(path, _archiveStream, _lookStream);
+		}
+		
+		~Reader()
+		{
+			File_Close(&_archiveStream.file);
+		}
+		
+		ILookInStream* stream()
+		{
+			return &_lookStream.s;
+		}
+		
+	private:
+		Reader(const Reader&);
+		Reader& operator = (const Reader&);
+		
+		CFileInStream _archiveStream;
+		CLookToRead _lookStream;
+	};
+	
 	std::string extract(const ArchiveEntry& entry, const std::string& destPath)
+	{
+		ExtractCache cache;
+		return extract(entry, destPath, &_lookStream.s, cache);
+	}
+	
+	std::string extract(const ArchiveEntry& entry, const std::string& destPath, ILookInStream* pStream, ExtractCache& cache)
 	{
 		Poco::Path basePath;
 		if (destPath.empty())
@@ -96,41 +157,27 @@ public:
 		
 		if (entry.isFile())
 		{	
-			Poco::UInt32 blockIndex = 0;
-			Byte* pOutBuffer = 0;
-			std::size_t outBufferSize = 0;
 			std::size_t offset = 0;
 			std::size_t extractedSize = 0;
 			int err = SzArEx_Extract(
 				&_db, 
-				&_lookStream.s, 
+				pStream, 
 				entry.index(), 
-				&blockIndex, 
-				&pOutBuffer,
-				&outBufferSize,
+				&cache.blockIndex, 
+				&cache.pOutBuffer,
+				&cache.outBufferSize,
 				&offset,
 				&extractedSize,
 				&_szAlloc,
 				&_szAllocTemp);
 			if (err == SZ_OK)
 			{
-				try
-				{
-					poco_assert (extractedSize == entry.size());
-				
-					Poco::Path parent = extractedPath.parent();
-					Poco::File dir(parent.toString());
-					dir.createDirectories();
-
-					Poco::FileOutputStream ostr(extractedPath.toString());
-					ostr.write(reinterpret_cast<const char*>(pOutBuffer) + offset, extractedSize);
-					IAlloc_Free(&_szAlloc, pOutBuffer);
-				}
-				catch (...)
-				{
-					IAlloc_Free(&_szAlloc, pOutBuffer);
-					throw;
-				}
+				poco_assert (extractedSize == entry.size());
+			
+				createDirectories(extractedPath.parent());
+
+				Poco::FileOutputStream ostr(extractedPath.toString());
+				ostr.write(reinterpret_cast<const char*>(cache.pOutBuffer) + offset, extractedSize);
 			}
 			else
 			{
@@ -139,13 +186,26 @@ public:
 		}
 		else
 		{
-			Poco::File dir(extractedPath.toString());
-			dir.createDirectories();
+			createDirectories(extractedPath);
 		}
 		
 		return extractedPath.toString();
 	}
 	
+	Poco::UInt32 folderIndex(const ArchiveEntry& entry) const
+		/// Returns the index of the folder (solid block) containing
+		/// the entry's data, or NO_FOLDER if the entry has no data.
+	{
+		return _db.FileIndexToFolderIndexMap[entry.index()];
+	}
+	
+	Poco::UInt32 folderCount() const
+	{
+		return _db.db.NumFolders;
+	}
+	
+	static const Poco::UInt32 NO_FOLDER = 0xFFFFFFFF;
+	
 protected:
 	void initialize()
 	{
@@ -164,22 +224,7 @@ protected:
 	{
 		checkFile();
 
-#if defined(_WIN32) && defined(POCO_WIN32_UTF8)
-		std::wstring wpath;
-		Poco::UnicodeConverter::toUTF16(_path, wpath);
-		if (InFile_OpenW(&_archiveStream.file, wpath.c_str()) != SZ_OK)
-		{
-			throw Poco::OpenFileException(_path);
-		}
-#else
-		if (InFile_Open(&_archiveStream.file, _path.c_str()) != SZ_OK)
-		{
-			throw Poco::OpenFileException(_path);
-		}
-#endif
-	
-		_lookStream.realStream = &_archiveStream.s;
-		LookToRead_Init(&_lookStream);
+		openFile(_path, _archiveStream, _lookStream);
 
 		SzArEx_Init(&_db);
 		int err = SzArEx_Open(&_db, &_lookStream.s, &_szAlloc, &_szAllocTemp);
@@ -193,6 +238,35 @@ protected:
 		}
 	}
 	
+	static void openFile(const std::string& path, CFileInStream& archiveStream, CLookToRead& lookStream)
+	{
+#if defined(_WIN32) && defined(POCO_WIN32_UTF8)
+		std::wstring wpath;
+		Poco::UnicodeConverter::toUTF16(path, wpath);
+		if (InFile_OpenW(&archiveStream.file, wpath.c_str()) != SZ_OK)
+		{
+			throw Poco::OpenFileException(path);
+		}
+#else
+		if (InFile_Open(&archiveStream.file, path.c_str()) != SZ_OK)
+		{
+			throw Poco::OpenFileException(path);
+		}
+#endif
+	
+		lookStream.realStream = &archiveStream.s;
+		LookToRead_Init(&lookStream);
+	}
+	
+	void createDirectories(const Poco::Path& path)
+	{
+		// Several threads may create the same parent directories.
+		Poco::FastMutex::ScopedLock lock(_dirMutex);
+		
+		Poco::File dir(path.toString());
+		dir.createDirectories();
+	}
+	
 	void close()
 	{
 		SzArEx_Free(&_db, &_szAlloc);
@@ -292,6 +366,7 @@ private:
 	CFileInStream _archiveStream;
 	CLookToRead _lookStream;
 	CSzArEx _db;
+	Poco::FastMutex _dirMutex;
 	static ISzAlloc _szAlloc;
 	static ISzAlloc _szAllocTemp;
 	static Poco::FastMutex _initMutex;
@@ -367,6 +442,204 @@ void Archive::extract(const std::string& destPath)
 	}
 }
 
+
+class PendingJobGuard
+	/// Decrements the number of pending jobs and wakes up
+	/// the waiting thread when the job is finished, even
+	/// if it is left with an exception.
+{
+public:
+	PendingJobGuard(Poco::FastMutex& mutex, Poco::Condition& done, int& pending):
+		_mutex(mutex),
+		_done(done),
+		_pending(pending)
+	{
+	}
+	
+	~PendingJobGuard()
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		--_pending;
+		_done.broadcast();
+	}
+	
+private:
+	Poco::FastMutex& _mutex;
+	Poco::Condition& _done;
+	int& _pending;
+};
+
+
+class ExtractFolderJob: public Poco::Runnable
+	/// Extracts all entries of a folder (solid block), so that
+	/// the folder is decoded only once.
+{
+public:
+	ExtractFolderJob(Archive& archive, ArchiveImpl& impl, const std::string& destPath, Poco::FastMutex& mutex, Poco::Condition& done, int& pending):
+		_archive(archive),
+		_impl(impl),
+		_destPath(destPath),
+		_mutex(mutex),
+		_done(done),
+		_pending(pending)
+	{
+	}
+	
+	void add(const ArchiveEntry& entry)
+	{
+		_entries.push_back(entry);
+	}
+	
+	bool empty() const
+	{
+		return _entries.empty();
+	}
+	
+	void run()
+	{
+		PendingJobGuard guard(_mutex, _done, _pending);
+		Archive::ConstIterator it = _entries.begin();
+		try
+		{
+			ArchiveImpl::Reader reader(_impl.path());
+			ArchiveImpl::ExtractCache cache;
+			for (; it != _entries.end(); ++it)
+			{
+				extract(*it, reader.stream(), cache);
+			}
+		}
+		catch (Poco::Exception& exc)
+		{
+			failRemaining(it, exc);
+		}
+		catch (std::exception& exc)
+		{
+			Poco::Exception failure(exc.what());
+			failRemaining(it, failure);
+		}
+		catch (...)
+		{
+			Poco::Exception failure("Unknown exception");
+			failRemaining(it, failure);
+		}
+	}
+	
+private:
+	void extract(const ArchiveEntry& entry, ILookInStream* pStream, ArchiveImpl::ExtractCache& cache)
+	{
+		Archive::ExtractedEventArgs extractedArgs;
+		extractedArgs.entry = entry;
+		try
+		{
+			extractedArgs.extractedPath = _impl.extract(entry, _destPath, pStream, cache);
+		}
+		catch (Poco::Exception& exc)
+		{
+			fail(entry, exc);
+			return;
+		}
+		catch (std::exception& exc)
+		{
+			Poco::Exception failure(exc.what());
+			fail(entry, failure);
+			return;
+		}
+		_archive.extracted(&_archive, extractedArgs);
+	}
+	
+	void failRemaining(Archive::ConstIterator it, Poco::Exception& exc)
+		/// Reports the entries not yet extracted as failed,
+		/// e.g. if the archive could not be opened.
+	{
+		for (; it != _entries.end(); ++it)
+		{
+			fail(*it, exc);
+		}
+	}
+	
+	void fail(const ArchiveEntry& entry, Poco::Exception& exc)
+	{
+		Archive::FailedEventArgs failedArgs;
+		failedArgs.entry = entry;
+		failedArgs.pException = &exc;
+		_archive.failed(&_archive, failedArgs);
+	}
+	
+	Archive& _archive;
+	ArchiveImpl& _impl;
+	std::string _destPath;
+	Archive::EntryVec _entries;
+	Poco::FastMutex& _mutex;
+	Poco::Condition& _done;
+	int& _pending;
+};
+
+
+void Archive::extract(const std::string& destPath, Poco::ThreadPool& threadPool)
+{
+	typedef Poco::SharedPtr<ExtractFolderJob> JobPtr;
+	typedef std::vector<JobPtr> JobVec;
+	
+	Poco::FastMutex mutex;
+	Poco::Condition done;
+	int pending = 0;
+	
+	JobVec jobs;
+	jobs.reserve(_pImpl->folderCount());
+	for (Poco::UInt32 i = 0; i < _pImpl->folderCount(); i++)
+	{
+		jobs.push_back(new ExtractFolderJob(*this, *_pImpl, destPath, mutex, done, pending));
+	}
+	
+	// Directories and empty files have no data; they are
+	// created first, on the calling thread.
+	ExtractFolderJob noFolder(*this, *_pImpl, destPath, mutex, done, pending);
+	for (ConstIterator it = begin(); it != end(); ++it)
+	{
+		Poco::UInt32 folder = _pImpl->folderIndex(*it);
+		if (folder == ArchiveImpl::NO_FOLDER)
+			noFolder.add(*it);
+		else
+			jobs[folder]->add(*it);
+	}
+	try
+	{
+		if (!noFolder.empty())
+		{
+			pending++;
+			noFolder.run();
+		}
+		
+		for (JobVec::iterator it = jobs.begin(); it != jobs.end(); ++it)
+		{
+			if ((*it)->empty()) continue;
+			{
+				Poco::FastMutex::ScopedLock lock(mutex);
+				pending++;
+			}
+			try
+			{
+				threadPool.start(**it);
+			}
+			catch (Poco::NoThreadAvailableException&)
+			{
+				(*it)->run();
+			}
+		}
+	}
+	catch (...)
+	{
+		// an event delegate has thrown; the running jobs refer to
+		// the local state and must finish before it goes away
+		Poco::FastMutex::ScopedLock lock(mutex);
+		while (pending > 0) done.wait(mutex);
+		throw;
+	}
+	
+	Poco::FastMutex::ScopedLock lock(mutex);
+	while (pending > 0) done.wait(mutex);
+}
+
 	
 std::string Archive::extract(const ArchiveEntry& entry, const std::string& destPath)
 {
@@ -0,0 +1,214 @@
+//
+// LzmaInputStream.cpp
+//
+// $Id$
+//
+// Library: SevenZip
+// Package: SevenZip
+// Module:  LzmaStream
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/SevenZip/LzmaInputStream.h"
+#include "Poco/Mutex.h"
+#include "Poco/Exception.h"
+#include "Poco/StreamUtil.h"
+#include "Lzma2Dec.h"
+#include "Xz.h"
+#include "7zAlloc.h"
+#include "7zCrc.h"
+#include "XzCrc64.h"
+
+
+namespace Poco {
+namespace SevenZip {
+
+
+namespace
+{
+	ISzAlloc szAlloc = { SzAlloc, SzFree };
+
+	Poco::FastMutex initMutex;
+	bool initialized = false;
+
+	void initializeTables()
+	{
+		Poco::FastMutex::ScopedLock lock(initMutex);
+		if (!initialized)
+		{
+			CrcGenerateTable();
+			Crc64GenerateTable();
+			initialized = true;
+		}
+	}
+
+	void handleError(SRes res)
+	{
+		switch (res)
+		{
+		case SZ_OK:
+			break;
+		case SZ_ERROR_MEM:
+			throw Poco::OutOfMemoryException("LZMA decoder");
+		case SZ_ERROR_UNSUPPORTED:
+			throw Poco::DataFormatException("Unsupported LZMA properties");
+		case SZ_ERROR_CRC:
+			throw Poco::DataFormatException("LZMA data CRC error");
+		default:
+			throw Poco::DataFormatException("Corrupt LZMA data", res);
+		}
+	}
+}
+
+
+struct LzmaInputStreamBuf::Decoder
+{
+	CLzma2Dec lzma2;
+	CXzUnpacker xz;
+};
+
+
+LzmaInputStreamBuf::LzmaInputStreamBuf(std::istream& istr, StreamType type):
+	BufferedStreamBuf(STREAM_BUFFER_SIZE, std::ios::in),
+	_pIstr(&istr),
+	_type(type),
+	_pDecoder(new Decoder),
+	_buffer(new char[INPUT_BUFFER_SIZE]),
+	_pos(0),
+	_size(0),
+	_inputEnd(false),
+	_eof(false),
+	_initialized(false)
+{
+	initializeTables();
+	if (_type == STREAM_LZMA2)
+	{
+		Lzma2Dec_Construct(&_pDecoder->lzma2);
+	}
+	else
+	{
+		XzUnpacker_Construct(&_pDecoder->xz, &szAlloc);
+		XzUnpacker_Init(&_pDecoder->xz);
+	}
+}
+
+
+LzmaInputStreamBuf::~LzmaInputStreamBuf()
+{
+	if (_type == STREAM_LZMA2)
+	{
+		Lzma2Dec_Free(&_pDecoder->lzma2, &szAlloc);
+	}
+	else
+	{
+		XzUnpacker_Free(&_pDecoder->xz);
+	}
+	delete _pDecoder;
+	delete [] _buffer;
+}
+
+
+int LzmaInputStreamBuf::readFromDevice(char* buffer, std::streamsize length)
+{
+	if (_eof || length == 0) return 0;
+
+	if (_type == STREAM_LZMA2 && !_initialized)
+	{
+		// the stream starts with the property byte
+		int prop = _pIstr->get();
+		if (prop == std::char_traits<char>::eof())
+			throw Poco::DataFormatException("Missing LZMA2 properties");
+		handleError(Lzma2Dec_Allocate(&_pDecoder->lzma2, static_cast<Byte>(prop), &szAlloc));
+		Lzma2Dec_Init(&_pDecoder->lzma2);
+		_initialized = true;
+	}
+
+	for (;;)
+	{
+		if (_pos == _size && !fillInput())
+		{
+			if (_type == STREAM_XZ && XzUnpacker_IsStreamWasFinished(&_pDecoder->xz))
+			{
+				_eof = true;
+				return 0;
+			}
+			throw Poco::DataFormatException("Unexpected end of LZMA data");
+		}
+
+		SizeT destLen = static_cast<SizeT>(length);
+		SizeT srcLen = _size - _pos;
+		const Byte* pSrc = reinterpret_cast<const Byte*>(_buffer + _pos);
+		bool finished = false;
+		if (_type == STREAM_LZMA2)
+		{
+			ELzmaStatus status;
+			handleError(Lzma2Dec_DecodeToBuf(&_pDecoder->lzma2, reinterpret_cast<Byte*>(buffer), &destLen, pSrc, &srcLen, LZMA_FINISH_ANY, &status));
+			finished = status == LZMA_STATUS_FINISHED_WITH_MARK;
+		}
+		else
+		{
+			ECoderStatus status;
+			handleError(XzUnpacker_Code(&_pDecoder->xz, reinterpret_cast<Byte*>(buffer), &destLen, pSrc, &srcLen, CODER_FINISH_ANY, &status));
+		}
+		_pos += srcLen;
+		if (finished) _eof = true;
+		if (destLen > 0) return static_cast<int>(destLen);
+		if (_eof) return 0;
+		if (srcLen == 0 && _pos < _size)
+			throw Poco::DataFormatException("Corrupt LZMA data");
+	}
+}
+
+
+bool LzmaInputStreamBuf::fillInput()
+{
+	if (_inputEnd) return false;
+
+	_pIstr->read(_buffer, INPUT_BUFFER_SIZE);
+	_pos = 0;
+	_size = static_cast<std::size_t>(_pIstr->gcount());
+	if (_size == 0)
+	{
+		_inputEnd = true;
+		return false;
+	}
+	return true;
+}
+
+
+LzmaInputIOS::LzmaInputIOS(std::istream& istr, LzmaInputStreamBuf::StreamType type):
+	_buf(istr, type)
+{
+	poco_ios_init(&_buf);
+}
+
+
+LzmaInputIOS::~LzmaInputIOS()
+{
+}
+
+
+LzmaInputStreamBuf* LzmaInputIOS::rdbuf()
+{
+	return &_buf;
+}
+
+
+LzmaInputStream::LzmaInputStream(std::istream& istr, LzmaInputStreamBuf::StreamType type):
+	LzmaInputIOS(istr, type),
+	std::istream(&_buf)
+{
+}
+
+
+LzmaInputStream::~LzmaInputStream()
+{
+}
+
+
+} } // namespace Poco::SevenZip
@@ -0,0 +1,471 @@
+//
+// LzmaOutputStream.cpp
+//
+// $Id$
+//
+// Library: SevenZip
+// Package: SevenZip
+// Module:  LzmaStream
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/SevenZip/LzmaOutputStream.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Runnable.h"
+#include "Poco/Exception.h"
+#include "Poco/StreamUtil.h"
+#include <cstring>
+#include "Lzma2Enc.h"
+#include "XzEnc.h"
+#include "7zAlloc.h"
+#include "7zCrc.h"
+#include "XzCrc64.h"
+
+
+namespace Poco {
+namespace SevenZip {
+
+
+namespace
+{
+	ISzAlloc szAlloc = { SzAlloc, SzFree };
+
+	Poco::FastMutex initMutex;
+	bool initialized = false;
+
+	void initializeTables()
+	{
+		Poco::FastMutex::ScopedLock lock(initMutex);
+		if (!initialized)
+		{
+			CrcGenerateTable();
+			Crc64GenerateTable();
+			initialized = true;
+		}
+	}
+
+	struct BlockInStream
+	{
+		ISeqInStream s;
+		const char* pData;
+		std::size_t size;
+		std::size_t pos;
+	};
+
+	SRes readBlock(void* p, void* buf, size_t* size)
+	{
+		BlockInStream* pStream = reinterpret_cast<BlockInStream*>(p);
+		std::size_t n = pStream->size - pStream->pos;
+		if (n > *size) n = *size;
+		std::memcpy(buf, pStream->pData + pStream->pos, n);
+		pStream->pos += n;
+		*size = n;
+		return SZ_OK;
+	}
+
+	struct BlockOutStream
+	{
+		ISeqOutStream s;
+		std::vector<char>* pData;
+	};
+
+	size_t writeBlock(void* p, const void* buf, size_t size)
+	{
+		BlockOutStream* pStream = reinterpret_cast<BlockOutStream*>(p);
+		try
+		{
+			const char* pBuf = reinterpret_cast<const char*>(buf);
+			pStream->pData->insert(pStream->pData->end(), pBuf, pBuf + size);
+			return size;
+		}
+		catch (...)
+		{
+			return 0;
+		}
+	}
+
+	void initProps(CLzma2EncProps& props, int level, Poco::UInt32 dictionarySize)
+	{
+		Lzma2EncProps_Init(&props);
+		props.lzmaProps.level = level;
+		props.lzmaProps.dictSize = dictionarySize;
+		props.numBlockThreads = 1;
+		props.numTotalThreads = 1;
+		Lzma2EncProps_Normalize(&props);
+	}
+
+	void handleError(SRes res)
+	{
+		switch (res)
+		{
+		case SZ_OK:
+			break;
+		case SZ_ERROR_MEM:
+			throw Poco::OutOfMemoryException("LZMA encoder");
+		case SZ_ERROR_PARAM:
+			throw Poco::InvalidArgumentException("LZMA encoder properties");
+		case SZ_ERROR_WRITE:
+			throw Poco::WriteFileException("LZMA encoder output");
+		default:
+			throw Poco::IOException("LZMA encoder error", res);
+		}
+	}
+}
+
+
+class LzmaOutputStreamBuf::Block: public Poco::Runnable
+	/// A block of data, compressed independently of the other blocks.
+{
+public:
+	Block(StreamType type, int level, Poco::UInt32 dictionarySize, Poco::FastMutex& mutex, Poco::Condition& done):
+		_type(type),
+		_level(level),
+		_dictionarySize(dictionarySize),
+		_done(false),
+		_pException(0),
+		_mutex(mutex),
+		_blockDone(done)
+	{
+	}
+
+	~Block()
+	{
+		delete _pException;
+	}
+
+	std::vector<char>& input()
+	{
+		return _input;
+	}
+
+	const std::vector<char>& output() const
+	{
+		return _output;
+	}
+
+	bool isDone() const
+		/// Must be called with the mutex locked.
+	{
+		return _done;
+	}
+
+	void rethrow() const
+	{
+		if (_pException) _pException->rethrow();
+	}
+
+	void run()
+	{
+		try
+		{
+			compress();
+		}
+		catch (Poco::Exception& exc)
+		{
+			_pException = exc.clone();
+		}
+		catch (std::exception& exc)
+		{
+			_pException = new Poco::Exception(exc.what());
+		}
+		catch (...)
+		{
+			_pException = new Poco::Exception("Unknown exception while compressing block");
+		}
+		std::vector<char>().swap(_input);
+
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		_done = true;
+		_blockDone.broadcast();
+	}
+
+private:
+	void compress()
+	{
+		CLzma2EncProps props;
+		initProps(props, _level, _dictionarySize);
+
+		BlockInStream in;
+		in.s.Read = readBlock;
+		in.pData = _input.empty() ? 0 : &_input[0];
+		in.size = _input.size();
+		in.pos = 0;
+		BlockOutStream out;
+		out.s.Write = writeBlock;
+		out.pData = &_output;
+		_output.reserve(_input.size()/2);
+
+		if (_type == STREAM_LZMA2)
+		{
+			CLzma2EncHandle enc = Lzma2Enc_Create(&szAlloc, &szAlloc);
+			if (!enc) throw Poco::OutOfMemoryException("LZMA encoder");
+			SRes res = Lzma2Enc_SetProps(enc, &props);
+			if (res == SZ_OK)
+				res = Lzma2Enc_Encode(enc, &out.s, &in.s, 0);
+			Lzma2Enc_Destroy(enc);
+			handleError(res);
+
+			// the end marker is written once, after the last block
+			poco_assert (!_output.empty() && _output.back() == 0);
+			_output.pop_back();
+		}
+		else
+		{
+			CXzProps xzProps;
+			XzProps_Init(&xzProps);
+			xzProps.lzma2Props = &props;
+			xzProps.checkId = XZ_CHECK_CRC32;
+			// every block becomes a stream of its own; xz decoders
+			// accept concatenated streams
+			handleError(Xz_Encode(&out.s, &in.s, &xzProps, 0));
+		}
+	}
+
+	StreamType _type;
+	int _level;
+	Poco::UInt32 _dictionarySize;
+	std::vector<char> _input;
+	std::vector<char> _output;
+	bool _done;
+	Poco::Exception* _pException;
+	Poco::FastMutex& _mutex;
+	Poco::Condition& _blockDone;
+};
+
+
+LzmaOutputStreamBuf::LzmaOutputStreamBuf(std::ostream& ostr, StreamType type, int level, Poco::UInt32 dictionarySize, int threads):
+	BufferedStreamBuf(STREAM_BUFFER_SIZE, std::ios::out),
+	_pOstr(&ostr),
+	_pThreadPool(&Poco::ThreadPool::defaultPool()),
+	_type(type),
+	_level(level),
+	_dictionarySize(0),
+	_threads(threads < 1 ? 1 : threads),
+	_blockSize(0),
+	_blocksWritten(false),
+	_closed(false)
+{
+	init(dictionarySize);
+}
+
+
+LzmaOutputStreamBuf::LzmaOutputStreamBuf(std::ostream& ostr, StreamType type, int level, Poco::UInt32 dictionarySize, int threads, Poco::ThreadPool& threadPool):
+	BufferedStreamBuf(STREAM_BUFFER_SIZE, std::ios::out),
+	_pOstr(&ostr),
+	_pThreadPool(&threadPool),
+	_type(type),
+	_level(level),
+	_dictionarySize(0),
+	_threads(threads < 1 ? 1 : threads),
+	_blockSize(0),
+	_blocksWritten(false),
+	_closed(false)
+{
+	init(dictionarySize);
+}
+
+
+void LzmaOutputStreamBuf::init(Poco::UInt32 dictionarySize)
+{
+	if (_level < 0 || _level > 9)
+		throw Poco::InvalidArgumentException("Invalid LZMA compression level");
+
+	initializeTables();
+
+	CLzma2EncProps props;
+	initProps(props, _level, dictionarySize);
+	_dictionarySize = LzmaEncProps_GetDictSize(&props.lzmaProps);
+	_blockSize = 4*static_cast<std::size_t>(_dictionarySize);
+	if (_blockSize < MIN_BLOCK_SIZE) _blockSize = MIN_BLOCK_SIZE;
+
+	if (_type == STREAM_LZMA2)
+	{
+		CLzma2EncHandle enc = Lzma2Enc_Create(&szAlloc, &szAlloc);
+		if (!enc) throw Poco::OutOfMemoryException("LZMA encoder");
+		SRes res = Lzma2Enc_SetProps(enc, &props);
+		char prop = static_cast<char>(Lzma2Enc_WriteProperties(enc));
+		Lzma2Enc_Destroy(enc);
+		handleError(res);
+		_pOstr->write(&prop, 1);
+	}
+}
+
+
+LzmaOutputStreamBuf::~LzmaOutputStreamBuf()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+	try
+	{
+		// blocks may still be compressed if close() has failed
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		for (BlockQueue::iterator it = _blocks.begin(); it != _blocks.end(); ++it)
+		{
+			while (!(*it)->isDone()) _blockDone.wait(_mutex);
+		}
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+int LzmaOutputStreamBuf::close()
+{
+	if (_closed) return 0;
+
+	BufferedStreamBuf::sync();
+	_closed = true;
+	if (!_input.empty())
+		queueBlock();
+	writeBlocks(0);
+
+	if (_type == STREAM_LZMA2)
+	{
+		_pOstr->put(0);
+	}
+	else if (!_blocksWritten)
+	{
+		std::vector<char> output;
+		BlockOutStream out;
+		out.s.Write = writeBlock;
+		out.pData = &output;
+		handleError(Xz_EncodeEmpty(&out.s));
+		_pOstr->write(&output[0], static_cast<std::streamsize>(output.size()));
+	}
+	_pOstr->flush();
+	return _pOstr->good() ? 0 : -1;
+}
+
+
+int LzmaOutputStreamBuf::writeToDevice(const char* buffer, std::streamsize length)
+{
+	if (length == 0) return 0;
+	if (_closed) return -1;
+
+	std::size_t pos = 0;
+	std::size_t size = static_cast<std::size_t>(length);
+	while (pos < size)
+	{
+		std::size_t n = _blockSize - _input.size();
+		if (n > size - pos) n = size - pos;
+		_input.insert(_input.end(), buffer + pos, buffer + pos + n);
+		pos += n;
+		if (_input.size() == _blockSize)
+			queueBlock();
+	}
+	return static_cast<int>(length);
+}
+
+
+void LzmaOutputStreamBuf::queueBlock()
+{
+	writeBlocks(_threads - 1);
+
+	BlockPtr pBlock = new Block(_type, _level, _dictionarySize, _mutex, _blockDone);
+	pBlock->input().swap(_input);
+	_input.reserve(_blockSize);
+	_blocks.push_back(pBlock);
+	if (_threads > 1)
+	{
+		try
+		{
+			_pThreadPool->start(*pBlock);
+			return;
+		}
+		catch (Poco::NoThreadAvailableException&)
+		{
+		}
+	}
+	pBlock->run();
+}
+
+
+void LzmaOutputStreamBuf::writeBlocks(std::size_t maxPending)
+{
+	while (!_blocks.empty())
+	{
+		BlockPtr pBlock = _blocks.front();
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			if (!pBlock->isDone())
+			{
+				if (_blocks.size() <= maxPending) break;
+				while (!pBlock->isDone()) _blockDone.wait(_mutex);
+			}
+		}
+		_blocks.pop_front();
+		pBlock->rethrow();
+
+		const std::vector<char>& output = pBlock->output();
+		if (!output.empty())
+			_pOstr->write(&output[0], static_cast<std::streamsize>(output.size()));
+		if (!_pOstr->good())
+			throw Poco::WriteFileException("LZMA output stream");
+		_blocksWritten = true;
+	}
+}
+
+
+LzmaOutputIOS::LzmaOutputIOS(std::ostream& ostr, LzmaOutputStreamBuf::StreamType type, int level, Poco::UInt32 dictionarySize, int threads):
+	_buf(ostr, type, level, dictionarySize, threads)
+{
+	poco_ios_init(&_buf);
+}
+
+
+LzmaOutputIOS::LzmaOutputIOS(std::ostream& ostr, LzmaOutputStreamBuf::StreamType type, int level, Poco::UInt32 dictionarySize, int threads, Poco::ThreadPool& threadPool):
+	_buf(ostr, type, level, dictionarySize, threads, threadPool)
+{
+	poco_ios_init(&_buf);
+}
+
+
+LzmaOutputIOS::~LzmaOutputIOS()
+{
+}
+
+
+LzmaOutputStreamBuf* LzmaOutputIOS::rdbuf()
+{
+	return &_buf;
+}
+
+
+LzmaOutputStream::LzmaOutputStream(std::ostream& ostr, LzmaOutputStreamBuf::StreamType type, int level, Poco::UInt32 dictionarySize, int threads):
+	LzmaOutputIOS(ostr, type, level, dictionarySize, threads),
+	std::ostream(&_buf)
+{
+}
+
+
+LzmaOutputStream::LzmaOutputStream(std::ostream& ostr, LzmaOutputStreamBuf::StreamType type, int level, Poco::UInt32 dictionarySize, int threads, Poco::ThreadPool& threadPool):
+	LzmaOutputIOS(ostr, type, level, dictionarySize, threads, threadPool),
+	std::ostream(&_buf)
+{
+}
+
+
+LzmaOutputStream::~LzmaOutputStream()
+{
+}
+
+
+int LzmaOutputStream::close()
+{
+	return _buf.close();
+}
+
+
+} } // namespace Poco::SevenZip
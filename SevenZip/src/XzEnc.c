@@ -218,7 +218,7 @@ static SRes SeqInFilter_Read(void *pp, void *data, size_t *size)
   CSeqInFilter *p = (CSeqInFilter *)pp;
   size_t sizeOriginal = *size;
   if (sizeOriginal == 0)
-    return S_OK;
+    return SZ_OK;
   *size = 0;
   for (;;)
   {
@@ -274,7 +274,7 @@ static SRes SeqInFilter_Init(CSeqInFilter *p, const CXzFilter *props)
   RINOK(BraState_SetFromMethod(&p->StateCoder, props->id, 1, &g_Alloc));
   RINOK(p->StateCoder.SetProps(p->StateCoder.p, props->props, props->propsSize, &g_Alloc));
   p->StateCoder.Init(p->StateCoder.p);
-  return S_OK;
+  return SZ_OK;
 }
 
 /* ---------- CSbEncInStream ---------- */
@@ -293,7 +293,7 @@ static SRes SbEncInStream_Read(void *pp, void *data, size_t *size)
   CSbEncInStream *p = (CSbEncInStream *)pp;
   size_t sizeOriginal = *size;
   if (sizeOriginal == 0)
-    return S_OK;
+    return SZ_OK;
   for (;;)
   {
     if (p->enc.needRead && !p->enc.readWasFinished)
@@ -311,7 +311,7 @@ static SRes SbEncInStream_Read(void *pp, void *data, size_t *size)
     *size = sizeOriginal;
     RINOK(SbEnc_Read(&p->enc, data, size));
     if (*size != 0 || !p->enc.needRead)
-      return S_OK;
+      return SZ_OK;
   }
 }
 
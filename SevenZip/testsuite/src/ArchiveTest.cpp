@@ -0,0 +1,204 @@
+//
+// ArchiveTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "ArchiveTest.h"
+#include "Poco/SevenZip/ArchiveEntry.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Delegate.h"
+#include "Poco/Path.h"
+#include "Poco/File.h"
+#include "Poco/FileStream.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Exception.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+
+
+using Poco::SevenZip::Archive;
+using Poco::SevenZip::ArchiveEntry;
+
+
+namespace
+{
+	// test.7z contains three folders (solid blocks):
+	// a.txt and dir/b.txt, c.txt, and dir/sub/d.txt
+	const int ENTRIES = 4;
+
+	std::string readFile(const std::string& path)
+	{
+		Poco::FileInputStream istr(path);
+		std::string content;
+		Poco::StreamCopier::copyToString(istr, content);
+		return content;
+	}
+
+	std::string repeat(const std::string& str, int count)
+	{
+		std::string result;
+		for (int i = 0; i < count; ++i) result += str;
+		return result;
+	}
+}
+
+
+ArchiveTest::ArchiveTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+ArchiveTest::~ArchiveTest()
+{
+}
+
+
+void ArchiveTest::testEntries()
+{
+	Archive archive(getTestFile("test.7z"));
+	assert (archive.size() == ENTRIES);
+	Archive::ConstIterator it = archive.begin();
+	assert (it->path() == "a.txt");
+	assert (it->isFile());
+	assert (it->size() == 3100);
+	++it;
+	assert (it->path() == "dir/b.txt");
+	++it;
+	assert (it->path() == "c.txt");
+	++it;
+	assert (it->path() == "dir/sub/d.txt");
+	assert (it->size() == 10240);
+}
+
+
+void ArchiveTest::testExtract()
+{
+	Archive archive(getTestFile("test.7z"));
+	archive.extracted += Poco::delegate(this, &ArchiveTest::onExtracted);
+	archive.failed += Poco::delegate(this, &ArchiveTest::onFailed);
+	archive.extract("sevenzip");
+	archive.extracted -= Poco::delegate(this, &ArchiveTest::onExtracted);
+	archive.failed -= Poco::delegate(this, &ArchiveTest::onFailed);
+
+	assert (_extracted.size() == ENTRIES);
+	assert (_failed.empty());
+	assert (readFile("sevenzip/a.txt") == repeat("first file in the first folder\n", 100));
+	assert (readFile("sevenzip/dir/b.txt") == repeat("second file in the first folder\n", 50));
+}
+
+
+void ArchiveTest::testExtractParallel()
+{
+	Poco::ThreadPool pool(2, 4);
+	Archive archive(getTestFile("test.7z"));
+	archive.extracted += Poco::delegate(this, &ArchiveTest::onExtracted);
+	archive.failed += Poco::delegate(this, &ArchiveTest::onFailed);
+	archive.extract("sevenzip", pool);
+	archive.extracted -= Poco::delegate(this, &ArchiveTest::onExtracted);
+	archive.failed -= Poco::delegate(this, &ArchiveTest::onFailed);
+
+	assert (_extracted.size() == ENTRIES);
+	assert (_failed.empty());
+	assert (readFile("sevenzip/a.txt") == repeat("first file in the first folder\n", 100));
+	assert (readFile("sevenzip/dir/b.txt") == repeat("second file in the first folder\n", 50));
+	assert (readFile("sevenzip/c.txt") == repeat("the only file in the second folder\n", 200));
+	std::string d = readFile("sevenzip/dir/sub/d.txt");
+	assert (d.size() == 10240);
+	for (std::size_t i = 0; i < d.size(); ++i)
+	{
+		assert (static_cast<unsigned char>(d[i]) == i % 256);
+	}
+}
+
+
+void ArchiveTest::testExtractParallelMissingArchive()
+{
+	// every folder job opens the archive again, which fails
+	// after the archive has been removed
+	Poco::File(getTestFile("test.7z")).copyTo("missing.7z");
+	Poco::ThreadPool pool(2, 4);
+	Archive archive("missing.7z");
+	Poco::File("missing.7z").remove();
+	archive.extracted += Poco::delegate(this, &ArchiveTest::onExtracted);
+	archive.failed += Poco::delegate(this, &ArchiveTest::onFailed);
+	archive.extract("sevenzip", pool);
+	archive.extracted -= Poco::delegate(this, &ArchiveTest::onExtracted);
+	archive.failed -= Poco::delegate(this, &ArchiveTest::onFailed);
+
+	assert (_extracted.empty());
+	assert (_failed.size() == ENTRIES);
+}
+
+
+void ArchiveTest::setUp()
+{
+	_extracted.clear();
+	_failed.clear();
+}
+
+
+void ArchiveTest::tearDown()
+{
+	try
+	{
+		Poco::File("sevenzip").remove(true);
+	}
+	catch (Poco::Exception&)
+	{
+	}
+}
+
+
+std::string ArchiveTest::getTestFile(const std::string& testFile)
+{
+	Poco::Path root;
+	root.makeAbsolute();
+	Poco::Path result;
+	while (!Poco::Path::find(root.toString(), "data", result))
+	{
+		root.makeParent();
+		if (root.toString().empty() || root.toString() == "/")
+			throw Poco::FileNotFoundException("Didn't find data subdir");
+	}
+	result.makeDirectory();
+	result.setFileName(testFile);
+	Poco::File aFile(result.toString());
+	if (!aFile.exists() || (aFile.exists() && !aFile.isFile()))
+		throw Poco::FileNotFoundException("Didn't find " + testFile);
+
+	return result.toString();
+}
+
+
+void ArchiveTest::onExtracted(const void*, const Archive::ExtractedEventArgs& args)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	_extracted.insert(args.entry.path());
+}
+
+
+void ArchiveTest::onFailed(const void*, const Archive::FailedEventArgs& args)
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+	_failed.insert(args.entry.path());
+}
+
+
+CppUnit::Test* ArchiveTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("ArchiveTest");
+
+	CppUnit_addTest(pSuite, ArchiveTest, testEntries);
+	CppUnit_addTest(pSuite, ArchiveTest, testExtract);
+	CppUnit_addTest(pSuite, ArchiveTest, testExtractParallel);
+	CppUnit_addTest(pSuite, ArchiveTest, testExtractParallelMissingArchive);
+
+	return pSuite;
+}
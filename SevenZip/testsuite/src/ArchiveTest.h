@@ -0,0 +1,54 @@
+//
+// ArchiveTest.h
+//
+// $Id$
+//
+// Definition of the ArchiveTest class.
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef ArchiveTest_INCLUDED
+#define ArchiveTest_INCLUDED
+
+
+#include "Poco/SevenZip/SevenZip.h"
+#include "Poco/SevenZip/Archive.h"
+#include "Poco/Mutex.h"
+#include "CppUnit/TestCase.h"
+#include <set>
+
+
+class ArchiveTest: public CppUnit::TestCase
+{
+public:
+	ArchiveTest(const std::string& name);
+	~ArchiveTest();
+
+	void testEntries();
+	void testExtract();
+	void testExtractParallel();
+	void testExtractParallelMissingArchive();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+	static std::string getTestFile(const std::string& testFile);
+
+private:
+	void onExtracted(const void*, const Poco::SevenZip::Archive::ExtractedEventArgs& args);
+	void onFailed(const void*, const Poco::SevenZip::Archive::FailedEventArgs& args);
+
+	std::set<std::string> _extracted;
+	std::set<std::string> _failed;
+	Poco::FastMutex _mutex;
+};
+
+
+#endif // ArchiveTest_INCLUDED
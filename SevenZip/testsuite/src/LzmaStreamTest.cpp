@@ -0,0 +1,198 @@
+//
+// LzmaStreamTest.cpp
+//
+// $Id$
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "LzmaStreamTest.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Exception.h"
+#include "Poco/ThreadPool.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include <sstream>
+
+
+using Poco::SevenZip::LzmaOutputStream;
+using Poco::SevenZip::LzmaOutputStreamBuf;
+using Poco::SevenZip::LzmaInputStream;
+using Poco::SevenZip::LzmaInputStreamBuf;
+
+
+LzmaStreamTest::LzmaStreamTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+LzmaStreamTest::~LzmaStreamTest()
+{
+}
+
+
+void LzmaStreamTest::testLzma2()
+{
+	std::string data = testData(100000);
+	std::string compressed = compress(data, LzmaOutputStreamBuf::STREAM_LZMA2, 1);
+	assert (compressed.size() < data.size());
+	assert (decompress(compressed, LzmaInputStreamBuf::STREAM_LZMA2) == data);
+
+	std::string empty = compress(std::string(), LzmaOutputStreamBuf::STREAM_LZMA2, 1);
+	assert (decompress(empty, LzmaInputStreamBuf::STREAM_LZMA2).empty());
+}
+
+
+void LzmaStreamTest::testXz()
+{
+	std::string data = testData(100000);
+	std::string compressed = compress(data, LzmaOutputStreamBuf::STREAM_XZ, 1);
+	assert (compressed.size() < data.size());
+	assert (compressed.compare(0, 6, "\xFD" "7zXZ\x00", 6) == 0);
+	assert (decompress(compressed, LzmaInputStreamBuf::STREAM_XZ) == data);
+
+	// concatenated streams are decompressed as one
+	std::string second = testData(1000);
+	assert (decompress(compressed + compress(second, LzmaOutputStreamBuf::STREAM_XZ, 1), LzmaInputStreamBuf::STREAM_XZ) == data + second);
+}
+
+
+void LzmaStreamTest::testParallelBlocks()
+{
+	// the blocks have at least 1 MB, so this is compressed in four blocks
+	std::string data = testData(3500000);
+	for (int type = 0; type < 2; ++type)
+	{
+		LzmaOutputStreamBuf::StreamType outType = type == 0 ? LzmaOutputStreamBuf::STREAM_LZMA2 : LzmaOutputStreamBuf::STREAM_XZ;
+		LzmaInputStreamBuf::StreamType inType = type == 0 ? LzmaInputStreamBuf::STREAM_LZMA2 : LzmaInputStreamBuf::STREAM_XZ;
+		std::string sequential = compress(data, outType, 1);
+		std::string parallel = compress(data, outType, 4);
+		assert (parallel == sequential);
+		assert (decompress(parallel, inType) == data);
+
+		// the blocks are compressed on the given pool, or on the
+		// calling thread if the pool has no thread available
+		Poco::ThreadPool pool(1, 2);
+		std::ostringstream ostr;
+		LzmaOutputStream lzma(ostr, outType, 1, 65536, 4, pool);
+		lzma.write(data.data(), static_cast<std::streamsize>(data.size()));
+		lzma.close();
+		assert (ostr.str() == sequential);
+		assert (pool.allocated() == 2);
+	}
+}
+
+
+void LzmaStreamTest::testTruncated()
+{
+	std::string data = testData(100000);
+	for (int type = 0; type < 2; ++type)
+	{
+		LzmaOutputStreamBuf::StreamType outType = type == 0 ? LzmaOutputStreamBuf::STREAM_LZMA2 : LzmaOutputStreamBuf::STREAM_XZ;
+		LzmaInputStreamBuf::StreamType inType = type == 0 ? LzmaInputStreamBuf::STREAM_LZMA2 : LzmaInputStreamBuf::STREAM_XZ;
+		std::string compressed = compress(data, outType, 1);
+		try
+		{
+			decompress(compressed.substr(0, compressed.size()/2), inType);
+			fail("truncated data - must throw");
+		}
+		catch (Poco::DataFormatException& exc)
+		{
+			assert (exc.message() == "Unexpected end of LZMA data");
+		}
+	}
+}
+
+
+void LzmaStreamTest::testCorrupt()
+{
+	std::string compressed = compress(testData(100000), LzmaOutputStreamBuf::STREAM_LZMA2, 1);
+	// the control byte of the first LZMA2 chunk follows the property byte;
+	// values from 3 to 0x7F are invalid
+	compressed[1] = 0x10;
+	try
+	{
+		decompress(compressed, LzmaInputStreamBuf::STREAM_LZMA2);
+		fail("corrupt data - must throw");
+	}
+	catch (Poco::DataFormatException& exc)
+	{
+		assert (exc.message() == "Corrupt LZMA data");
+	}
+
+	try
+	{
+		decompress(std::string(100, 'x'), LzmaInputStreamBuf::STREAM_XZ);
+		fail("not an .xz stream - must throw");
+	}
+	catch (Poco::DataFormatException&)
+	{
+	}
+}
+
+
+void LzmaStreamTest::setUp()
+{
+}
+
+
+void LzmaStreamTest::tearDown()
+{
+}
+
+
+std::string LzmaStreamTest::compress(const std::string& data, LzmaOutputStreamBuf::StreamType type, int threads)
+{
+	std::ostringstream ostr;
+	LzmaOutputStream lzma(ostr, type, 1, 65536, threads);
+	lzma.write(data.data(), static_cast<std::streamsize>(data.size()));
+	lzma.close();
+	return ostr.str();
+}
+
+
+std::string LzmaStreamTest::decompress(const std::string& data, LzmaInputStreamBuf::StreamType type)
+{
+	std::istringstream istr(data);
+	LzmaInputStream lzma(istr, type);
+	lzma.exceptions(std::ios::badbit);
+	std::string result;
+	Poco::StreamCopier::copyToString(lzma, result);
+	return result;
+}
+
+
+std::string LzmaStreamTest::testData(std::size_t size)
+{
+	std::string data;
+	data.reserve(size + 64);
+	for (int i = 0; data.size() < size; ++i)
+	{
+		data += "line ";
+		data += Poco::NumberFormatter::format(i);
+		data += ": ";
+		data += Poco::NumberFormatter::format(i*i % 7919);
+		data += '\n';
+	}
+	data.resize(size);
+	return data;
+}
+
+
+CppUnit::Test* LzmaStreamTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("LzmaStreamTest");
+
+	CppUnit_addTest(pSuite, LzmaStreamTest, testLzma2);
+	CppUnit_addTest(pSuite, LzmaStreamTest, testXz);
+	CppUnit_addTest(pSuite, LzmaStreamTest, testParallelBlocks);
+	CppUnit_addTest(pSuite, LzmaStreamTest, testTruncated);
+	CppUnit_addTest(pSuite, LzmaStreamTest, testCorrupt);
+
+	return pSuite;
+}
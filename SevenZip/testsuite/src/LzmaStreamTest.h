@@ -0,0 +1,49 @@
+//
+// LzmaStreamTest.h
+//
+// $Id$
+//
+// Definition of the LzmaStreamTest class.
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef LzmaStreamTest_INCLUDED
+#define LzmaStreamTest_INCLUDED
+
+
+#include "Poco/SevenZip/SevenZip.h"
+#include "Poco/SevenZip/LzmaOutputStream.h"
+#include "Poco/SevenZip/LzmaInputStream.h"
+#include "CppUnit/TestCase.h"
+
+
+class LzmaStreamTest: public CppUnit::TestCase
+{
+public:
+	LzmaStreamTest(const std::string& name);
+	~LzmaStreamTest();
+
+	void testLzma2();
+	void testXz();
+	void testParallelBlocks();
+	void testTruncated();
+	void testCorrupt();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+	static std::string compress(const std::string& data, Poco::SevenZip::LzmaOutputStreamBuf::StreamType type, int threads);
+	static std::string decompress(const std::string& data, Poco::SevenZip::LzmaInputStreamBuf::StreamType type);
+	static std::string testData(std::size_t size);
+};
+
+
+#endif // LzmaStreamTest_INCLUDED
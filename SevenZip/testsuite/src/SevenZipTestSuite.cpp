@@ -0,0 +1,26 @@
+//
+// SevenZipTestSuite.cpp
+//
+// $Id$
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "SevenZipTestSuite.h"
+#include "LzmaStreamTest.h"
+#include "ArchiveTest.h"
+
+
+CppUnit::Test* SevenZipTestSuite::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("SevenZipTestSuite");
+
+	pSuite->addTest(LzmaStreamTest::suite());
+	pSuite->addTest(ArchiveTest::suite());
+
+	return pSuite;
+}
@@ -0,0 +1,29 @@
+//
+// SevenZipTestSuite.h
+//
+// $Id$
+//
+// Definition of the SevenZipTestSuite class.
+//
+// Copyright (c) 2014, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef SevenZipTestSuite_INCLUDED
+#define SevenZipTestSuite_INCLUDED
+
+
+#include "CppUnit/TestSuite.h"
+
+
+class SevenZipTestSuite
+{
+public:
+	static CppUnit::Test* suite();
+};
+
+
+#endif // SevenZipTestSuite_INCLUDED
@@ -23,9 +23,14 @@
 #include "Poco/Zip/Zip.h"
 #include "Poco/Zip/ZipArchive.h"
 #include "Poco/FIFOEvent.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include "Poco/SharedPtr.h"
 #include <istream>
 #include <ostream>
 #include <set>
+#include <deque>
 
 
 namespace Poco {
@@ -34,14 +39,43 @@ namespace Zip {
 
 class Zip_API Compress
 	/// Compresses a directory or files as zip.
+	///
+	/// By default, all entries are compressed on the calling thread.
+	/// A Compress created with a ThreadPool deflates the files on
+	/// the threads of the pool instead, while the entries are still
+	/// written to the output stream in the order they are added.
+	/// Files larger than the block size are split into blocks that
+	/// are deflated independently and concatenated into a single
+	/// deflate stream, so that a single large file is compressed by
+	/// several threads as well. Each block is primed with the last
+	/// 32 KB of the preceding block, which keeps the compression
+	/// ratio close to the one of a single stream.
 {
 public:
+	enum
+	{
+		DEFAULT_BLOCK_SIZE = 1024*1024
+			/// Default size of the blocks compressed in parallel.
+	};
+
 	Poco::FIFOEvent<const ZipLocalFileHeader> EDone;
+		/// Fired when an entry has been written. In parallel mode, this
+		/// may happen during a later call to addFile() or close(), but
+		/// always on the thread calling the Compress.
 
 	Compress(std::ostream& out, bool seekableOut);
 		/// seekableOut determines how we write the zip, setting it to true is recommended for local files (smaller zip file),
 		/// if you are compressing directly to a network, you MUST set it to false
 
+	Compress(std::ostream& out, bool seekableOut, Poco::ThreadPool& threadPool);
+		/// Creates a Compress that compresses the files on the threads of the
+		/// given thread pool. If no thread is available, a block is compressed
+		/// on the calling thread.
+		///
+		/// addFile() returns as soon as the data of the file has been read and
+		/// handed over to the pool. The input stream of a file is no longer used
+		/// after addFile() returns.
+
 	~Compress();
 
 	void addFile(std::istream& input, const Poco::DateTime& lastModifiedAt, const Poco::Path& fileName, ZipCommon::CompressionMethod cm = ZipCommon::CM_DEFLATE, ZipCommon::CompressionLevel cl = ZipCommon::CL_MAXIMUM);
@@ -89,6 +123,17 @@ public:
 		///
 		/// See setStoreExtensions() for more information.
 
+	void setBlockSize(std::size_t blockSize);
+		/// Sets the size of the blocks files are split into for parallel
+		/// compression. Must be at least 64 KB. Only used in parallel mode.
+
+	std::size_t getBlockSize() const;
+		/// Returns the size of the blocks files are split into for parallel
+		/// compression.
+
+	bool isParallel() const;
+		/// Returns true if the Compress compresses files on a thread pool.
+
 private:
 	enum
 	{
@@ -105,6 +150,25 @@ private:
 	void addFileRaw(std::istream& in, const ZipLocalFileHeader& hdr, const Poco::Path& fileName);
 		/// copys an already compressed ZipEntry from in
 
+	struct Entry;
+	class Block;
+	typedef Poco::SharedPtr<Block> BlockPtr;
+	typedef std::deque<BlockPtr> BlockQueue;
+
+	void queueEntry(std::istream& in, const ZipLocalFileHeader& hdr, const std::string& name);
+		/// Splits the data of a file entry into blocks and queues them for compression.
+
+	void queueBlock(BlockPtr pBlock);
+		/// Queues a block and starts its compression.
+
+	void writeBlocks(std::size_t maxPending);
+		/// Writes the compressed blocks at the head of the queue, waiting for
+		/// the compression of blocks until at most maxPending blocks are queued.
+
+	void writeBlock(Block& block);
+		/// Writes a compressed block, including the local header of its entry
+		/// for the first block of an entry.
+
 private:
 	std::set<std::string>      _storeExtensions;
 	std::ostream&              _out;
@@ -114,6 +178,12 @@ private:
 	ZipArchive::DirectoryInfos _dirs;
 	Poco::UInt32               _offset;
     std::string                _comment;
+	Poco::ThreadPool*          _pThreadPool;
+	std::size_t                _blockSize;
+	std::size_t                _maxPendingBlocks;
+	BlockQueue                 _blocks;
+	Poco::FastMutex            _mutex;
+	Poco::Condition            _blockDone;
 
 	friend class Keep;
 	friend class Rename;
@@ -141,6 +211,18 @@ inline const std::set<std::string>& Compress::getStoreExtensions() const
 }
 
 
+inline std::size_t Compress::getBlockSize() const
+{
+	return _blockSize;
+}
+
+
+inline bool Compress::isParallel() const
+{
+	return _pThreadPool != 0;
+}
+
+
 } } // namespace Poco::Zip
 
 
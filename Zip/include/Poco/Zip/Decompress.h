@@ -25,6 +25,8 @@
 #include "Poco/Zip/ZipArchive.h"
 #include "Poco/Path.h"
 #include "Poco/FIFOEvent.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Mutex.h"
 
 
 namespace Poco {
@@ -59,6 +61,22 @@ public:
 		/// Decompresses all files stored in the zip File. Can only be called once per Decompress object.
 		/// Use mapping to retrieve the location of the decompressed files
 
+	ZipArchive decompressAllFiles(Poco::ThreadPool& threadPool);
+		/// Decompresses all files stored in the zip file on the threads of the given
+		/// thread pool. Can only be called once per Decompress object.
+		///
+		/// The input stream must be seekable. Only the central directory is read on the
+		/// calling thread. Each entry is handled by its own thread, which reads the local
+		/// header and the data of the entry from the shared input stream. If no thread is
+		/// available, an entry is handled on the calling thread.
+		///
+		/// Errors decompressing a file are reported through EError. If the local header
+		/// of an entry cannot be read, the first such error is thrown once all entries
+		/// have been handled.
+		///
+		/// EOk and EError are fired on the thread that decompressed the file.
+		/// Use mapping to retrieve the location of the decompressed files
+
 	bool handleZipEntry(std::istream& zipStream, const ZipLocalFileHeader& hdr);
 
 	const ZipMapping& mapping() const;
@@ -66,6 +84,8 @@ public:
 		/// If for a ZipFileInfo no mapping exists, there was an error during decompression and the entry is considered to be corrupt
 
 private:
+	class Job;
+
 	Decompress(const Decompress&);
 	Decompress& operator=(const Decompress&);
 
@@ -77,6 +97,7 @@ private:
 	bool          _flattenDirs;
 	bool          _keepIncompleteFiles;
 	ZipMapping    _mapping;
+	Poco::FastMutex _mutex;
 };
 
 
@@ -0,0 +1,259 @@
+//
+// MappedZipArchive.h
+//
+// $Id$
+//
+// Library: Zip
+// Package: Zip
+// Module:  MappedZipArchive
+//
+// Definition of the MappedZipArchive class.
+//
+// Copyright (c) 2007, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Zip_MappedZipArchive_INCLUDED
+#define Zip_MappedZipArchive_INCLUDED
+
+
+#include "Poco/Zip/Zip.h"
+#include "Poco/Zip/ZipCommon.h"
+#include "Poco/SharedMemory.h"
+#include "Poco/HashMap.h"
+#include "Poco/DateTime.h"
+#include <vector>
+
+
+namespace Poco {
+namespace Zip {
+
+
+class Zip_API MappedZipArchive
+	/// A read-only view on a zip file that is mapped into memory.
+	///
+	/// Unlike ZipArchive, a MappedZipArchive does not parse the whole
+	/// file. Only the central directory at the end of the file is read,
+	/// and a hash index of the entry names is built from it, so that
+	/// looking up an entry takes constant time.
+	///
+	/// The data of an entry is accessed directly in the mapping. For
+	/// stored entries, data() returns the content of the file without
+	/// copying it. Deflated entries are inflated in a single pass into
+	/// a buffer supplied by the caller:
+	///
+	///     MappedZipArchive archive("resources.zip");
+	///     MappedZipArchive::ConstIterator it = archive.find("index.html");
+	///     if (it != archive.end())
+	///     {
+	///         if (it->isStored())
+	///             send(archive.data(*it), it->getUncompressedSize());
+	///         else
+	///         {
+	///             Poco::Buffer<char> buffer(it->getUncompressedSize());
+	///             send(buffer.begin(), archive.extract(*it, buffer.begin(), buffer.size()));
+	///         }
+	///     }
+	///
+	/// All member functions are const and can be called by several
+	/// threads at the same time. The zip file must not be modified
+	/// while it is mapped.
+{
+public:
+	class Zip_API Entry
+		/// An entry of the central directory.
+	{
+	public:
+		Entry();
+			/// Creates an empty Entry.
+
+		const std::string& getFileName() const;
+			/// Returns the name of the entry.
+
+		ZipCommon::CompressionMethod getCompressionMethod() const;
+			/// Returns the compression method of the entry.
+
+		bool isStored() const;
+			/// Returns true if the entry is stored without compression.
+
+		bool isDirectory() const;
+			/// Returns true if the entry is a directory.
+
+		bool isEncrypted() const;
+			/// Returns true if the entry is encrypted.
+
+		Poco::UInt32 getCRC() const;
+			/// Returns the CRC32 of the uncompressed data.
+
+		Poco::UInt32 getCompressedSize() const;
+			/// Returns the size of the data in the zip file.
+
+		Poco::UInt32 getUncompressedSize() const;
+			/// Returns the size of the uncompressed data.
+
+		const Poco::DateTime& lastModifiedAt() const;
+			/// Returns the modification time of the entry.
+
+	private:
+		std::string _fileName;
+		ZipCommon::CompressionMethod _method;
+		Poco::UInt16 _flags;
+		Poco::UInt32 _crc;
+		Poco::UInt32 _compressedSize;
+		Poco::UInt32 _uncompressedSize;
+		Poco::UInt32 _localHeaderOffset;
+		Poco::DateTime _lastModifiedAt;
+
+		friend class MappedZipArchive;
+	};
+
+	typedef std::vector<Entry> Entries;
+	typedef Entries::const_iterator ConstIterator;
+
+	explicit MappedZipArchive(const std::string& path);
+		/// Maps the given zip file into memory and reads
+		/// its central directory.
+		///
+		/// Throws a ZipException if the file is not a valid
+		/// zip file.
+
+	~MappedZipArchive();
+		/// Unmaps the zip file.
+
+	std::size_t size() const;
+		/// Returns the number of entries.
+
+	ConstIterator begin() const;
+		/// Returns an iterator to the first entry, in the
+		/// order of the central directory.
+
+	ConstIterator end() const;
+		/// Returns the end iterator.
+
+	ConstIterator find(const std::string& fileName) const;
+		/// Returns the entry with the given name, or end()
+		/// if no such entry exists.
+
+	const char* data(const Entry& entry) const;
+		/// Returns a pointer to the data of the entry in the mapping,
+		/// without copying it.
+		///
+		/// For stored entries, this is the content of the file
+		/// (getUncompressedSize() bytes). For deflated entries, this
+		/// is the raw deflate data (getCompressedSize() bytes).
+		///
+		/// Throws a ZipException if the local header of the entry
+		/// is invalid.
+
+	std::size_t extract(const Entry& entry, char* buffer, std::size_t length) const;
+		/// Writes the uncompressed content of the entry into the given
+		/// buffer and returns its size. Deflated entries are inflated
+		/// directly into the buffer, stored entries are copied.
+		///
+		/// The buffer must be able to hold getUncompressedSize() bytes.
+		/// Throws a ZipException if the data is corrupt or does not
+		/// match the CRC of the entry.
+
+private:
+	typedef Poco::HashMap<std::string, std::size_t> Index;
+
+	MappedZipArchive();
+	MappedZipArchive(const MappedZipArchive&);
+	MappedZipArchive& operator = (const MappedZipArchive&);
+
+	void parse();
+		/// Reads the central directory and builds the index.
+
+	std::size_t findEndOfCentralDirectory() const;
+		/// Returns the offset of the end of central directory record.
+
+	Poco::SharedMemory _memory;
+	const char* _pData;
+	std::size_t _size;
+	Entries _entries;
+	Index _index;
+};
+
+
+//
+// inlines
+//
+inline const std::string& MappedZipArchive::Entry::getFileName() const
+{
+	return _fileName;
+}
+
+
+inline ZipCommon::CompressionMethod MappedZipArchive::Entry::getCompressionMethod() const
+{
+	return _method;
+}
+
+
+inline bool MappedZipArchive::Entry::isStored() const
+{
+	return _method == ZipCommon::CM_STORE;
+}
+
+
+inline bool MappedZipArchive::Entry::isDirectory() const
+{
+	return !_fileName.empty() && _fileName[_fileName.size() - 1] == '/';
+}
+
+
+inline bool MappedZipArchive::Entry::isEncrypted() const
+{
+	return (_flags & 0x0001) != 0;
+}
+
+
+inline Poco::UInt32 MappedZipArchive::Entry::getCRC() const
+{
+	return _crc;
+}
+
+
+inline Poco::UInt32 MappedZipArchive::Entry::getCompressedSize() const
+{
+	return _compressedSize;
+}
+
+
+inline Poco::UInt32 MappedZipArchive::Entry::getUncompressedSize() const
+{
+	return _uncompressedSize;
+}
+
+
+inline const Poco::DateTime& MappedZipArchive::Entry::lastModifiedAt() const
+{
+	return _lastModifiedAt;
+}
+
+
+inline std::size_t MappedZipArchive::size() const
+{
+	return _entries.size();
+}
+
+
+inline MappedZipArchive::ConstIterator MappedZipArchive::begin() const
+{
+	return _entries.begin();
+}
+
+
+inline MappedZipArchive::ConstIterator MappedZipArchive::end() const
+{
+	return _entries.end();
+}
+
+
+} } // namespace Poco::Zip
+
+
+#endif // Zip_MappedZipArchive_INCLUDED
@@ -34,6 +34,7 @@ namespace Zip {
 
 class ParseCallback;
 class Compress;
+class Decompress;
 
 
 class Zip_API ZipArchive
@@ -79,6 +80,7 @@ private:
 		/// Stores directory info for all found disks
 
 	friend class Compress;
+	friend class Decompress;
 };
 
 
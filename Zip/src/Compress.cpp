@@ -24,19 +24,261 @@
 #include "Poco/File.h"
 #include "Poco/FileStream.h"
 #include "Poco/String.h"
+#include "Poco/Runnable.h"
+#include "Poco/Exception.h"
+#include <vector>
+#include <cstring>
+#if defined(POCO_UNBUNDLED)
+#include <zlib.h>
+#else
+#include "Poco/zlib.h"
+#endif
 
 
 namespace Poco {
 namespace Zip {
 
 
+namespace
+{
+	const std::size_t DICTIONARY_SIZE = 32768;
+		// Size of the deflate window, used to prime a block
+		// with the end of the preceding block.
+
+	const std::size_t MIN_BLOCK_SIZE = 65536;
+}
+
+
+struct Compress::Entry
+	/// The state of a file or directory entry whose blocks
+	/// are being compressed. Only used by the calling thread.
+{
+	Entry(const ZipLocalFileHeader& hdr, const std::string& entryName):
+		header(hdr),
+		name(entryName),
+		offset(0),
+		crc(0),
+		uncompressedSize(0),
+		compressedSize(0)
+	{
+	}
+
+	ZipLocalFileHeader header;
+	std::string name;
+	std::streamoff offset;
+	Poco::UInt32 crc;
+	Poco::UInt32 uncompressedSize;
+	Poco::UInt32 compressedSize;
+};
+
+
+class Compress::Block: public Poco::Runnable
+	/// A part of the data of an entry, compressed on a pooled thread.
+	///
+	/// The deflate output of all blocks of an entry but the last one
+	/// ends with a sync flush instead of a final block, so that the
+	/// concatenated output of the blocks forms a single deflate stream.
+{
+public:
+	Block(const Poco::SharedPtr<Entry>& pEntry, bool first, Poco::FastMutex& mutex, Poco::Condition& done):
+		_pEntry(pEntry),
+		_first(first),
+		_last(true),
+		_done(pEntry->header.isDirectory()),
+		_crc(0),
+		_inputSize(0),
+		_level(Z_DEFAULT_COMPRESSION),
+		_pException(0),
+		_mutex(mutex),
+		_blockDone(done)
+	{
+		ZipCommon::CompressionLevel cl = pEntry->header.getCompressionLevel();
+		if (cl == ZipCommon::CL_FAST || cl == ZipCommon::CL_SUPERFAST)
+			_level = Z_BEST_SPEED;
+		else if (cl == ZipCommon::CL_MAXIMUM)
+			_level = Z_BEST_COMPRESSION;
+	}
+
+	~Block()
+	{
+		delete _pException;
+	}
+
+	void run()
+	{
+		try
+		{
+			compress();
+		}
+		catch (Poco::Exception& exc)
+		{
+			_pException = exc.clone();
+		}
+		catch (std::exception& exc)
+		{
+			_pException = new Poco::Exception(exc.what());
+		}
+		catch (...)
+		{
+			_pException = new Poco::Exception("Unknown exception while compressing block");
+		}
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		_done = true;
+		_blockDone.broadcast();
+	}
+
+	Entry& entry()
+	{
+		return *_pEntry;
+	}
+
+	std::vector<char>& input()
+	{
+		return _input;
+	}
+
+	std::vector<char>& dictionary()
+	{
+		return _dictionary;
+	}
+
+	const std::vector<char>& output() const
+	{
+		return _pEntry->header.getCompressionMethod() == ZipCommon::CM_STORE ? _input : _output;
+	}
+
+	bool isFirst() const
+	{
+		return _first;
+	}
+
+	bool isLast() const
+	{
+		return _last;
+	}
+
+	void setLast(bool last)
+	{
+		_last = last;
+	}
+
+	bool isDone() const
+		/// Must be called with the mutex locked.
+	{
+		return _done;
+	}
+
+	Poco::UInt32 crc() const
+	{
+		return _crc;
+	}
+
+	Poco::UInt32 inputSize() const
+	{
+		return _inputSize;
+	}
+
+	void rethrow() const
+	{
+		if (_pException) _pException->rethrow();
+	}
+
+private:
+	void compress()
+	{
+		_inputSize = static_cast<Poco::UInt32>(_input.size());
+		_crc = crc32(0L, Z_NULL, 0);
+		if (_input.empty() && !_last) return;
+
+		const Bytef* pInput = _input.empty() ? Z_NULL : reinterpret_cast<const Bytef*>(&_input[0]);
+		_crc = crc32(_crc, pInput, static_cast<uInt>(_input.size()));
+		if (_pEntry->header.getCompressionMethod() == ZipCommon::CM_STORE) return;
+
+		z_stream zstr;
+		std::memset(&zstr, 0, sizeof(zstr));
+		int rc = deflateInit2(&zstr, _level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+		if (rc != Z_OK) throw Poco::IOException(zError(rc));
+
+		if (!_dictionary.empty())
+		{
+			rc = deflateSetDictionary(&zstr, reinterpret_cast<const Bytef*>(&_dictionary[0]), static_cast<uInt>(_dictionary.size()));
+			if (rc != Z_OK)
+			{
+				deflateEnd(&zstr);
+				throw Poco::IOException(zError(rc));
+			}
+		}
+
+		// room for the sync flush marker
+		_output.resize(deflateBound(&zstr, static_cast<uLong>(_input.size())) + 16);
+		zstr.next_in = const_cast<Bytef*>(pInput);
+		zstr.avail_in = static_cast<uInt>(_input.size());
+		int flush = _last ? Z_FINISH : Z_SYNC_FLUSH;
+		std::size_t written = 0;
+		for (;;)
+		{
+			if (written == _output.size())
+				_output.resize(2*_output.size());
+			zstr.next_out = reinterpret_cast<Bytef*>(&_output[written]);
+			zstr.avail_out = static_cast<uInt>(_output.size() - written);
+			rc = deflate(&zstr, flush);
+			written = _output.size() - zstr.avail_out;
+			if (rc == Z_STREAM_END) break;
+			if (rc != Z_OK)
+			{
+				deflateEnd(&zstr);
+				throw Poco::IOException(zError(rc));
+			}
+			if (flush == Z_SYNC_FLUSH && zstr.avail_out != 0) break;
+		}
+		deflateEnd(&zstr);
+		_output.resize(written);
+	}
+
+	Poco::SharedPtr<Entry> _pEntry;
+	bool _first;
+	bool _last;
+	bool _done;
+	std::vector<char> _input;
+	std::vector<char> _dictionary;
+	std::vector<char> _output;
+	Poco::UInt32 _crc;
+	Poco::UInt32 _inputSize;
+	int _level;
+	Poco::Exception* _pException;
+	Poco::FastMutex& _mutex;
+	Poco::Condition& _blockDone;
+};
+
+
 Compress::Compress(std::ostream& out, bool seekableOut):
 	_out(out),
 	_seekableOut(seekableOut),
 	_files(),
 	_infos(),
 	_dirs(),
-	_offset(0)
+	_offset(0),
+	_pThreadPool(0),
+	_blockSize(DEFAULT_BLOCK_SIZE),
+	_maxPendingBlocks(0)
+{
+	_storeExtensions.insert("gif");
+	_storeExtensions.insert("png");
+	_storeExtensions.insert("jpg");
+	_storeExtensions.insert("jpeg");
+}
+
+
+Compress::Compress(std::ostream& out, bool seekableOut, Poco::ThreadPool& threadPool):
+	_out(out),
+	_seekableOut(seekableOut),
+	_files(),
+	_infos(),
+	_dirs(),
+	_offset(0),
+	_pThreadPool(&threadPool),
+	_blockSize(DEFAULT_BLOCK_SIZE),
+	_maxPendingBlocks(2*threadPool.capacity() + 1)
 {
 	_storeExtensions.insert("gif");
 	_storeExtensions.insert("png");
@@ -47,6 +289,20 @@ Compress::Compress(std::ostream& out, bool seekableOut):
 
 Compress::~Compress()
 {
+	try
+	{
+		// blocks may still be compressed if close() has not been called
+		// or has failed
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		for (BlockQueue::iterator it = _blocks.begin(); it != _blocks.end(); ++it)
+		{
+			while (!(*it)->isDone()) _blockDone.wait(_mutex);
+		}
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
 }
 
 
@@ -68,6 +324,12 @@ void Compress::addEntry(std::istream& in, const Poco::DateTime& lastModifiedAt,
 	if (!in.good())
 		throw ZipException("Invalid input stream");
 
+	if (_pThreadPool)
+	{
+		queueEntry(in, ZipLocalFileHeader(fileName, lastModifiedAt, cm, cl), fileName.toString(Poco::Path::PATH_UNIX));
+		return;
+	}
+
 	std::streamoff localHeaderOffset = _offset;
 	ZipLocalFileHeader hdr(fileName, lastModifiedAt, cm, cl);
 	hdr.setStartPos(localHeaderOffset);
@@ -91,6 +353,8 @@ void Compress::addEntry(std::istream& in, const Poco::DateTime& lastModifiedAt,
 void Compress::addFileRaw(std::istream& in, const ZipLocalFileHeader& h, const Poco::Path& fileName)
 {
 	std::string fn = ZipUtil::validZipEntryFileName(fileName);
+	// raw entries are written directly, after all queued entries
+	writeBlocks(0);
 	//bypass the header of the input stream and point to the first byte of the data payload
 	in.seekg(h.getDataStartPos(), std::ios_base::beg);
 
@@ -200,9 +464,18 @@ void Compress::addDirectory(const Poco::Path& entryName, const Poco::DateTime& l
 		addDirectory(entryName.parent(), lastModifiedAt);
 	}
 
-	std::streamoff localHeaderOffset = _offset;
 	ZipCommon::CompressionMethod cm = ZipCommon::CM_STORE;
 	ZipCommon::CompressionLevel cl = ZipCommon::CL_NORMAL;
+	if (_pThreadPool)
+	{
+		// directory entries are queued as well to keep the order of entries
+		ZipLocalFileHeader hdr(entryName, lastModifiedAt, cm, cl);
+		_files.insert(std::make_pair(fileStr, hdr));
+		queueBlock(new Block(new Entry(hdr, fileStr), true, _mutex, _blockDone));
+		return;
+	}
+
+	std::streamoff localHeaderOffset = _offset;
 	ZipLocalFileHeader hdr(entryName, lastModifiedAt, cm, cl);
 	hdr.setStartPos(localHeaderOffset);
 	ZipOutputStream zipOut(_out, hdr, _seekableOut);
@@ -277,6 +550,8 @@ ZipArchive Compress::close()
 	if (!_dirs.empty())
 		return ZipArchive(_files, _infos, _dirs);
 
+	writeBlocks(0);
+
 	poco_assert (_infos.size() == _files.size());
 	poco_assert (_files.size() < 65536);
 	Poco::UInt32 centralDirStart = _offset;
@@ -324,4 +599,173 @@ void Compress::setStoreExtensions(const std::set<std::string>& extensions)
 }
 
 
+void Compress::setBlockSize(std::size_t blockSize)
+{
+	poco_assert (blockSize >= MIN_BLOCK_SIZE);
+	_blockSize = blockSize;
+}
+
+
+void Compress::queueEntry(std::istream& in, const ZipLocalFileHeader& hdr, const std::string& name)
+{
+	if (hdr.getCompressionMethod() != ZipCommon::CM_DEFLATE && hdr.getCompressionMethod() != ZipCommon::CM_STORE)
+		throw Poco::NotImplementedException("Unsupported compression method");
+
+	// reserve the name, the header is replaced once the entry is written
+	_files.insert(std::make_pair(name, hdr));
+
+	Poco::SharedPtr<Entry> pEntry = new Entry(hdr, name);
+	std::vector<char> dictionary;
+	bool first = true;
+	bool last = false;
+	while (!last)
+	{
+		BlockPtr pBlock = new Block(pEntry, first, _mutex, _blockDone);
+		std::vector<char>& data = pBlock->input();
+		data.resize(_blockSize);
+		in.read(&data[0], static_cast<std::streamsize>(_blockSize));
+		if (in.bad())
+			throw ZipException("Failed to read input stream");
+		data.resize(static_cast<std::size_t>(in.gcount()));
+		last = data.size() < _blockSize || in.peek() == std::char_traits<char>::eof();
+		pBlock->setLast(last);
+		pBlock->dictionary().swap(dictionary);
+		if (!last)
+		{
+			std::size_t n = data.size() < DICTIONARY_SIZE ? data.size() : DICTIONARY_SIZE;
+			dictionary.assign(data.end() - n, data.end());
+		}
+		queueBlock(pBlock);
+		first = false;
+	}
+}
+
+
+void Compress::queueBlock(BlockPtr pBlock)
+{
+	writeBlocks(_maxPendingBlocks - 1);
+	_blocks.push_back(pBlock);
+
+	bool done;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		done = pBlock->isDone();
+	}
+	if (!done)
+	{
+		try
+		{
+			_pThreadPool->start(*pBlock);
+		}
+		catch (Poco::NoThreadAvailableException&)
+		{
+			pBlock->run();
+		}
+	}
+}
+
+
+void Compress::writeBlocks(std::size_t maxPending)
+{
+	while (!_blocks.empty())
+	{
+		BlockPtr pBlock = _blocks.front();
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			if (!pBlock->isDone())
+			{
+				if (_blocks.size() <= maxPending) break;
+				while (!pBlock->isDone()) _blockDone.wait(_mutex);
+			}
+		}
+		_blocks.pop_front();
+		writeBlock(*pBlock);
+	}
+}
+
+
+void Compress::writeBlock(Block& block)
+{
+	block.rethrow();
+
+	Entry& entry = block.entry();
+	ZipLocalFileHeader& hdr = entry.header;
+	if (block.isFirst())
+	{
+		entry.offset = _offset;
+		hdr.setStartPos(entry.offset);
+		if (hdr.isDirectory())
+		{
+			ZipOutputStream zipOut(_out, hdr, _seekableOut);
+			zipOut.close();
+		}
+		else
+		{
+			if (block.isLast())
+			{
+				// a single block: the sizes are known before the data is written
+				hdr.setSearchCRCAndSizesAfterData(false);
+				hdr.setCRC(block.crc());
+				hdr.setUncompressedSize(block.inputSize());
+				hdr.setCompressedSize(static_cast<Poco::UInt32>(block.output().size()));
+			}
+			else
+			{
+				hdr.setSearchCRCAndSizesAfterData(!_seekableOut);
+			}
+			std::string header = hdr.createHeader();
+			_out.write(header.c_str(), static_cast<std::streamsize>(header.size()));
+		}
+		entry.crc = block.crc();
+	}
+	else
+	{
+		entry.crc = static_cast<Poco::UInt32>(crc32_combine(entry.crc, block.crc(), block.inputSize()));
+	}
+	entry.uncompressedSize += block.inputSize();
+	entry.compressedSize += static_cast<Poco::UInt32>(block.output().size());
+	if (!block.output().empty())
+		_out.write(&block.output()[0], static_cast<std::streamsize>(block.output().size()));
+
+	if (!block.isLast()) return;
+
+	if (!block.isFirst())
+	{
+		hdr.setCRC(entry.crc);
+		hdr.setUncompressedSize(entry.uncompressedSize);
+		hdr.setCompressedSize(entry.compressedSize);
+		if (hdr.searchCRCAndSizesAfterData())
+		{
+			ZipDataInfo info;
+			info.setCRC32(entry.crc);
+			info.setUncompressedSize(entry.uncompressedSize);
+			info.setCompressedSize(entry.compressedSize);
+			_out.write(info.getRawHeader(), static_cast<std::streamsize>(info.getFullHeaderSize()));
+		}
+		else
+		{
+			_out.seekp(entry.offset, std::ios_base::beg);
+			poco_assert (_out);
+			std::string header = hdr.createHeader();
+			_out.write(header.c_str(), static_cast<std::streamsize>(header.size()));
+			_out.seekp(0, std::ios_base::end);
+		}
+	}
+	hdr.setStartPos(entry.offset); // reset again now that compressed Size is known
+	_offset = hdr.getEndPos();
+	if (hdr.searchCRCAndSizesAfterData())
+		_offset += ZipDataInfo::getFullHeaderSize();
+	ZipArchive::FileHeaders::iterator itFile = _files.find(entry.name);
+	if (itFile != _files.end())
+		itFile->second = hdr;
+	else
+		_files.insert(std::make_pair(entry.name, hdr));
+	poco_assert (_out);
+	ZipFileInfo nfo(hdr);
+	nfo.setOffset(entry.offset);
+	_infos.insert(std::make_pair(entry.name, nfo));
+	EDone.notify(this, hdr);
+}
+
+
 } } // namespace Poco::Zip
@@ -24,12 +24,259 @@
 #include "Poco/StreamCopier.h"
 #include "Poco/Delegate.h"
 #include "Poco/FileStream.h"
+#include "Poco/BufferedStreamBuf.h"
+#include "Poco/StreamUtil.h"
+#include "Poco/Condition.h"
+#include "Poco/Runnable.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Buffer.h"
+#include <vector>
+#include <cstring>
 
 
 namespace Poco {
 namespace Zip {
 
 
+namespace
+{
+	class RangeStreamBuf: public Poco::BufferedStreamBuf
+		/// Reads a range of bytes from an input stream shared
+		/// by several threads. Every read repositions the shared
+		/// stream while holding the mutex.
+	{
+	public:
+		RangeStreamBuf(std::istream& istr, Poco::FastMutex& mutex, std::streamoff start, std::streamoff end):
+			Poco::BufferedStreamBuf(STREAM_BUFFER_SIZE, std::ios::in),
+			_istr(istr),
+			_mutex(mutex),
+			_pos(start),
+			_end(end)
+		{
+		}
+
+	protected:
+		int readFromDevice(char* buffer, std::streamsize length)
+		{
+			if (_pos >= _end) return 0;
+			if (length > _end - _pos)
+				length = static_cast<std::streamsize>(_end - _pos);
+
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			_istr.clear();
+			_istr.seekg(_pos, std::ios_base::beg);
+			_istr.read(buffer, length);
+			std::streamsize n = _istr.gcount();
+			if (n == 0)
+				throw Poco::IOException("Failed to read zip entry data");
+			_pos += n;
+			return static_cast<int>(n);
+		}
+
+	private:
+		enum
+		{
+			STREAM_BUFFER_SIZE = 65536
+		};
+
+		std::istream& _istr;
+		Poco::FastMutex& _mutex;
+		std::streamoff _pos;
+		std::streamoff _end;
+	};
+
+
+	class RangeIOS: public virtual std::ios
+	{
+	public:
+		RangeIOS(std::istream& istr, Poco::FastMutex& mutex, std::streamoff start, std::streamoff end):
+			_buf(istr, mutex, start, end)
+		{
+			poco_ios_init(&_buf);
+		}
+
+	protected:
+		RangeStreamBuf _buf;
+	};
+
+
+	class RangeInputStream: public RangeIOS, public std::istream
+	{
+	public:
+		RangeInputStream(std::istream& istr, Poco::FastMutex& mutex, std::streamoff start, std::streamoff end):
+			RangeIOS(istr, mutex, start, end),
+			std::istream(&_buf)
+		{
+		}
+	};
+
+
+	class DirectorySkipCallback: public ParseCallback
+		/// Skips the data of an entry using the compressed size
+		/// given in the central directory, so that a data descriptor
+		/// following the data can be read without searching for it.
+	{
+	public:
+		DirectorySkipCallback(const ZipFileInfo& info):
+			_info(info)
+		{
+		}
+
+		bool handleZipEntry(std::istream& zipStream, const ZipLocalFileHeader& hdr)
+		{
+			if (hdr.searchCRCAndSizesAfterData())
+				zipStream.seekg(_info.getCompressedSize(), std::ios_base::cur);
+			return true;
+		}
+
+	private:
+		const ZipFileInfo& _info;
+	};
+
+
+	void readCentralDirectory(std::istream& in, ZipArchive::FileInfos& infos, ZipArchive::DirectoryInfos& disks)
+		/// Reads the central directory of a zip file, located by
+		/// the end of central directory record, without reading
+		/// the entries.
+	{
+		enum
+		{
+			ARCHIVEINFO_SIZE = 22,
+			MAX_COMMENT_SIZE = 65535
+		};
+
+		in.clear();
+		in.seekg(0, std::ios_base::end);
+		std::streamoff size = in.tellg();
+		if (size < ARCHIVEINFO_SIZE)
+			throw ZipException("No central directory found");
+
+		std::streamoff tail = size < ARCHIVEINFO_SIZE + MAX_COMMENT_SIZE ? size : ARCHIVEINFO_SIZE + MAX_COMMENT_SIZE;
+		Poco::Buffer<char> buffer(static_cast<std::size_t>(tail));
+		in.seekg(size - tail, std::ios_base::beg);
+		in.read(buffer.begin(), tail);
+		if (in.gcount() != tail)
+			throw ZipException("Failed to read central directory");
+
+		std::streamoff pos = tail - ARCHIVEINFO_SIZE;
+		while (pos >= 0 && std::memcmp(buffer.begin() + pos, ZipArchiveInfo::HEADER, ZipCommon::HEADER_SIZE) != 0) --pos;
+		if (pos < 0)
+			throw ZipException("No central directory found");
+
+		in.seekg(size - tail + pos + ZipCommon::HEADER_SIZE, std::ios_base::beg);
+		ZipArchiveInfo nfo(in, true);
+		disks.insert(std::make_pair(nfo.getDiskNumber(), nfo));
+
+		// the central directory immediately precedes the end of central directory record
+		in.seekg(nfo.getHeaderOffset() - nfo.getCentralDirectorySize(), std::ios_base::beg);
+		for (Poco::UInt16 i = 0; i < nfo.getTotalNumberOfEntries(); ++i)
+		{
+			char header[ZipCommon::HEADER_SIZE] = {'\x00', '\x00', '\x00', '\x00'};
+			in.read(header, ZipCommon::HEADER_SIZE);
+			if (!in.good() || std::memcmp(header, ZipFileInfo::HEADER, ZipCommon::HEADER_SIZE) != 0)
+				throw ZipException("Bad central directory");
+			ZipFileInfo info(in, true);
+			infos.insert(std::make_pair(info.getFileName(), info));
+		}
+	}
+}
+
+
+class Decompress::Job: public Poco::Runnable
+	/// Reads the local header of a single entry and
+	/// decompresses it on a pooled thread.
+{
+public:
+	Job(Decompress& decompress, const ZipFileInfo& info, ZipArchive::FileHeaders& headers, Poco::SharedPtr<Poco::Exception>& pException, Poco::FastMutex& streamMutex, Poco::FastMutex& mutex, Poco::Condition& done, int& pending):
+		_decompress(decompress),
+		_info(info),
+		_headers(headers),
+		_pException(pException),
+		_streamMutex(streamMutex),
+		_mutex(mutex),
+		_done(done),
+		_pending(pending)
+	{
+	}
+
+	void run()
+	{
+		try
+		{
+			ZipLocalFileHeader hdr = readHeader();
+			{
+				Poco::FastMutex::ScopedLock lock(_mutex);
+				_headers.insert(std::make_pair(hdr.getFileName(), hdr));
+			}
+			if (hdr.isDirectory())
+			{
+				_decompress.handleZipEntry(_decompress._in, hdr);
+			}
+			else
+			{
+				RangeInputStream istr(_decompress._in, _streamMutex, hdr.getDataStartPos(), hdr.getDataEndPos());
+				_decompress.handleZipEntry(istr, hdr);
+			}
+		}
+		catch (Poco::Exception& exc)
+		{
+			// handleZipEntry() reports errors in files through EError,
+			// so this is a broken local header or directory name
+			setException(exc.clone());
+		}
+		catch (std::exception& exc)
+		{
+			setException(new Poco::Exception(exc.what()));
+		}
+		catch (...)
+		{
+			setException(new Poco::Exception("Unknown exception"));
+		}
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		--_pending;
+		_done.broadcast();
+	}
+
+private:
+	ZipLocalFileHeader readHeader()
+	{
+		DirectorySkipCallback skip(_info);
+		Poco::FastMutex::ScopedLock lock(_streamMutex);
+		_decompress._in.clear();
+		_decompress._in.seekg(_info.getRelativeOffsetOfLocalHeader(), std::ios_base::beg);
+		ZipLocalFileHeader hdr(_decompress._in, false, skip);
+		if (hdr.searchCRCAndSizesAfterData())
+		{
+			// the sizes in the central directory allow reading the data directly
+			hdr.setCRC(_info.getCRC());
+			hdr.setCompressedSize(_info.getCompressedSize());
+			hdr.setUncompressedSize(_info.getUncompressedSize());
+			hdr.setSearchCRCAndSizesAfterData(false);
+			hdr.setStartPos(hdr.getStartPos()); // recompute the end position
+		}
+		return hdr;
+	}
+
+	void setException(Poco::Exception* pException)
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		if (_pException)
+			delete pException;
+		else
+			_pException = pException;
+	}
+
+	Decompress& _decompress;
+	ZipFileInfo _info;
+	ZipArchive::FileHeaders& _headers;
+	Poco::SharedPtr<Poco::Exception>& _pException;
+	Poco::FastMutex& _streamMutex;
+	Poco::FastMutex& _mutex;
+	Poco::Condition& _done;
+	int& _pending;
+};
+
+
 Decompress::Decompress(std::istream& in, const Poco::Path& outputDir, bool flattenDirs, bool keepIncompleteFiles):
 	_in(in),
 	_outDir(outputDir),
@@ -73,6 +320,54 @@ ZipArchive Decompress::decompressAllFiles()
 }
 
 
+ZipArchive Decompress::decompressAllFiles(Poco::ThreadPool& threadPool)
+{
+	poco_assert (_mapping.empty());
+	ZipArchive::FileInfos infos;
+	ZipArchive::DirectoryInfos disks;
+	readCentralDirectory(_in, infos, disks);
+
+	ZipArchive::FileHeaders headers;
+	Poco::SharedPtr<Poco::Exception> pException;
+	Poco::FastMutex streamMutex;
+	Poco::FastMutex mutex;
+	Poco::Condition done;
+	int pending = 0;
+	std::vector<Poco::SharedPtr<Job> > jobs;
+	jobs.reserve(infos.size());
+	try
+	{
+		for (ZipArchive::FileInfos::const_iterator it = infos.begin(); it != infos.end(); ++it)
+		{
+			jobs.push_back(new Job(*this, it->second, headers, pException, streamMutex, mutex, done, pending));
+			{
+				Poco::FastMutex::ScopedLock lock(mutex);
+				++pending;
+			}
+			try
+			{
+				threadPool.start(*jobs.back());
+			}
+			catch (Poco::NoThreadAvailableException&)
+			{
+				jobs.back()->run();
+			}
+		}
+	}
+	catch (...)
+	{
+		Poco::FastMutex::ScopedLock lock(mutex);
+		while (pending > 0) done.wait(mutex);
+		throw;
+	}
+
+	Poco::FastMutex::ScopedLock lock(mutex);
+	while (pending > 0) done.wait(mutex);
+	if (pException) pException->rethrow();
+	return ZipArchive(headers, infos, disks);
+}
+
+
 bool Decompress::handleZipEntry(std::istream& zipStream, const ZipLocalFileHeader& hdr)
 {
 	if (hdr.isDirectory())
@@ -85,6 +380,7 @@ bool Decompress::handleZipEntry(std::istream& zipStream, const ZipLocalFileHeade
 				throw ZipException("Illegal entry name " + dirName + " containing parent directory reference");
 			Poco::Path dir(_outDir, dirName);
 			dir.makeDirectory();
+			Poco::FastMutex::ScopedLock lock(_mutex);
 			Poco::File aFile(dir);
 			aFile.createDirectories();
 		}
@@ -110,6 +406,7 @@ bool Decompress::handleZipEntry(std::istream& zipStream, const ZipLocalFileHeade
 		dest.makeFile();
 		if (dest.depth() > 0)
 		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
 			Poco::File aFile(dest.parent());
 			aFile.createDirectories();
 		}
@@ -167,6 +464,7 @@ bool Decompress::handleZipEntry(std::istream& zipStream, const ZipLocalFileHeade
 
 void Decompress::onOk(const void*, std::pair<const ZipLocalFileHeader, const Poco::Path>& val)
 {
+	Poco::FastMutex::ScopedLock lock(_mutex);
 	_mapping.insert(std::make_pair(val.first.getFileName(), val.second));
 }
 
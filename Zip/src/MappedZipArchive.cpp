@@ -0,0 +1,223 @@
+//
+// MappedZipArchive.cpp
+//
+// $Id$
+//
+// Library: Zip
+// Package: Zip
+// Module:  MappedZipArchive
+//
+// Copyright (c) 2007, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Zip/MappedZipArchive.h"
+#include "Poco/Zip/ZipUtil.h"
+#include "Poco/Zip/ZipException.h"
+#include "Poco/File.h"
+#include <cstring>
+#if defined(POCO_UNBUNDLED)
+#include <zlib.h>
+#else
+#include "Poco/zlib.h"
+#endif
+
+
+namespace Poco {
+namespace Zip {
+
+
+namespace
+{
+	// end of central directory record
+	const char         EOCD_SIGNATURE[] = {'\x50', '\x4b', '\x05', '\x06'};
+	const std::size_t  EOCD_SIZE = 22;
+	const std::size_t  EOCD_MAX_COMMENT_SIZE = 65535;
+	const Poco::UInt32 EOCD_TOTAL_ENTRIES_POS = 10;
+	const Poco::UInt32 EOCD_DIRECTORY_SIZE_POS = 12;
+	const Poco::UInt32 EOCD_DIRECTORY_OFFSET_POS = 16;
+	const Poco::UInt32 EOCD_COMMENT_SIZE_POS = 20;
+
+	// central directory file header
+	const char         CDFH_SIGNATURE[] = {'\x50', '\x4b', '\x01', '\x02'};
+	const std::size_t  CDFH_SIZE = 46;
+	const Poco::UInt32 CDFH_FLAGS_POS = 8;
+	const Poco::UInt32 CDFH_METHOD_POS = 10;
+	const Poco::UInt32 CDFH_TIME_POS = 12;
+	const Poco::UInt32 CDFH_DATE_POS = 14;
+	const Poco::UInt32 CDFH_CRC_POS = 16;
+	const Poco::UInt32 CDFH_COMPRESSED_SIZE_POS = 20;
+	const Poco::UInt32 CDFH_UNCOMPRESSED_SIZE_POS = 24;
+	const Poco::UInt32 CDFH_NAME_LENGTH_POS = 28;
+	const Poco::UInt32 CDFH_EXTRA_LENGTH_POS = 30;
+	const Poco::UInt32 CDFH_COMMENT_LENGTH_POS = 32;
+	const Poco::UInt32 CDFH_LOCAL_HEADER_OFFSET_POS = 42;
+
+	// local file header
+	const char         LFH_SIGNATURE[] = {'\x50', '\x4b', '\x03', '\x04'};
+	const std::size_t  LFH_SIZE = 30;
+	const Poco::UInt32 LFH_NAME_LENGTH_POS = 26;
+	const Poco::UInt32 LFH_EXTRA_LENGTH_POS = 28;
+}
+
+
+MappedZipArchive::Entry::Entry():
+	_method(ZipCommon::CM_STORE),
+	_flags(0),
+	_crc(0),
+	_compressedSize(0),
+	_uncompressedSize(0),
+	_localHeaderOffset(0)
+{
+}
+
+
+MappedZipArchive::MappedZipArchive(const std::string& path):
+	_memory(Poco::File(path), Poco::SharedMemory::AM_READ),
+	_pData(_memory.begin()),
+	_size(static_cast<std::size_t>(_memory.end() - _memory.begin()))
+{
+	parse();
+}
+
+
+MappedZipArchive::~MappedZipArchive()
+{
+}
+
+
+MappedZipArchive::ConstIterator MappedZipArchive::find(const std::string& fileName) const
+{
+	Index::ConstIterator it = _index.find(fileName);
+	if (it == _index.end())
+		return _entries.end();
+	return _entries.begin() + it->second;
+}
+
+
+const char* MappedZipArchive::data(const Entry& entry) const
+{
+	std::size_t pos = entry._localHeaderOffset;
+	if (pos + LFH_SIZE > _size || std::memcmp(_pData + pos, LFH_SIGNATURE, ZipCommon::HEADER_SIZE) != 0)
+		throw ZipException("Invalid local header", entry.getFileName());
+
+	// the extra field of the local header may differ from the one in the central directory
+	std::size_t dataPos = pos + LFH_SIZE
+		+ ZipUtil::get16BitValue(_pData + pos, LFH_NAME_LENGTH_POS)
+		+ ZipUtil::get16BitValue(_pData + pos, LFH_EXTRA_LENGTH_POS);
+	if (dataPos + entry.getCompressedSize() > _size)
+		throw ZipException("Entry data exceeds zip file", entry.getFileName());
+
+	return _pData + dataPos;
+}
+
+
+std::size_t MappedZipArchive::extract(const Entry& entry, char* buffer, std::size_t length) const
+{
+	if (entry.isEncrypted())
+		throw Poco::NotImplementedException("Encryption not supported");
+	if (length < entry.getUncompressedSize())
+		throw Poco::InvalidArgumentException("Buffer too small for entry", entry.getFileName());
+
+	const char* pData = data(entry);
+	std::size_t size = entry.getUncompressedSize();
+	if (entry.getCompressionMethod() == ZipCommon::CM_STORE)
+	{
+		if (entry.getCompressedSize() != size)
+			throw ZipException("Invalid size of stored entry", entry.getFileName());
+		std::memcpy(buffer, pData, size);
+	}
+	else if (entry.getCompressionMethod() == ZipCommon::CM_DEFLATE)
+	{
+		z_stream zstr;
+		std::memset(&zstr, 0, sizeof(zstr));
+		int rc = inflateInit2(&zstr, -MAX_WBITS);
+		if (rc != Z_OK)
+			throw ZipException(zError(rc), entry.getFileName());
+
+		zstr.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(pData));
+		zstr.avail_in = entry.getCompressedSize();
+		zstr.next_out = reinterpret_cast<Bytef*>(buffer);
+		zstr.avail_out = static_cast<uInt>(size);
+		rc = inflate(&zstr, Z_FINISH);
+		std::size_t inflated = static_cast<std::size_t>(zstr.total_out);
+		inflateEnd(&zstr);
+		if (rc != Z_STREAM_END || inflated != size)
+			throw ZipException("Corrupt deflate data", entry.getFileName());
+	}
+	else throw Poco::NotImplementedException("Unsupported compression method");
+
+	Poco::UInt32 crc = static_cast<Poco::UInt32>(crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(buffer), static_cast<uInt>(size)));
+	if (crc != entry.getCRC())
+		throw ZipException("CRC failure", entry.getFileName());
+
+	return size;
+}
+
+
+void MappedZipArchive::parse()
+{
+	std::size_t eocd = findEndOfCentralDirectory();
+	std::size_t count = ZipUtil::get16BitValue(_pData + eocd, EOCD_TOTAL_ENTRIES_POS);
+	std::size_t dirSize = ZipUtil::get32BitValue(_pData + eocd, EOCD_DIRECTORY_SIZE_POS);
+	std::size_t pos = ZipUtil::get32BitValue(_pData + eocd, EOCD_DIRECTORY_OFFSET_POS);
+	if (pos + dirSize > eocd)
+		throw ZipException("Invalid central directory offset");
+
+	std::size_t end = pos + dirSize;
+	_entries.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (pos + CDFH_SIZE > end || std::memcmp(_pData + pos, CDFH_SIGNATURE, ZipCommon::HEADER_SIZE) != 0)
+			throw ZipException("Invalid central directory entry");
+
+		const char* pHeader = _pData + pos;
+		std::size_t nameLength = ZipUtil::get16BitValue(pHeader, CDFH_NAME_LENGTH_POS);
+		std::size_t headerSize = CDFH_SIZE + nameLength
+			+ ZipUtil::get16BitValue(pHeader, CDFH_EXTRA_LENGTH_POS)
+			+ ZipUtil::get16BitValue(pHeader, CDFH_COMMENT_LENGTH_POS);
+		if (pos + headerSize > end)
+			throw ZipException("Central directory entry exceeds directory");
+
+		Entry entry;
+		entry._fileName.assign(pHeader + CDFH_SIZE, nameLength);
+		entry._method = static_cast<ZipCommon::CompressionMethod>(ZipUtil::get16BitValue(pHeader, CDFH_METHOD_POS));
+		entry._flags = ZipUtil::get16BitValue(pHeader, CDFH_FLAGS_POS);
+		entry._crc = ZipUtil::get32BitValue(pHeader, CDFH_CRC_POS);
+		entry._compressedSize = ZipUtil::get32BitValue(pHeader, CDFH_COMPRESSED_SIZE_POS);
+		entry._uncompressedSize = ZipUtil::get32BitValue(pHeader, CDFH_UNCOMPRESSED_SIZE_POS);
+		entry._localHeaderOffset = ZipUtil::get32BitValue(pHeader, CDFH_LOCAL_HEADER_OFFSET_POS);
+		entry._lastModifiedAt = ZipUtil::parseDateTime(pHeader, CDFH_TIME_POS, CDFH_DATE_POS);
+
+		// the first of several entries with the same name wins, like in ZipArchive
+		if (_index.insert(Index::ValueType(entry._fileName, _entries.size())).second)
+			_entries.push_back(entry);
+		pos += headerSize;
+	}
+}
+
+
+std::size_t MappedZipArchive::findEndOfCentralDirectory() const
+{
+	if (_size < EOCD_SIZE)
+		throw ZipException("Not a zip file");
+
+	// the record is followed by a comment of up to 64 KB
+	std::size_t pos = _size - EOCD_SIZE;
+	std::size_t last = pos > EOCD_MAX_COMMENT_SIZE ? pos - EOCD_MAX_COMMENT_SIZE : 0;
+	for (;;)
+	{
+		if (std::memcmp(_pData + pos, EOCD_SIGNATURE, ZipCommon::HEADER_SIZE) == 0
+			&& pos + EOCD_SIZE + ZipUtil::get16BitValue(_pData + pos, EOCD_COMMENT_SIZE_POS) == _size)
+			return pos;
+		if (pos == last) break;
+		--pos;
+	}
+	throw ZipException("End of central directory not found");
+}
+
+
+} } // namespace Poco::Zip
@@ -14,11 +14,16 @@
 #include "ZipTest.h"
 #include "Poco/Zip/Compress.h"
 #include "Poco/Zip/ZipManipulator.h"
+#include "Poco/Zip/ZipStream.h"
 #include "Poco/File.h"
 #include "Poco/FileStream.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Random.h"
 #include "CppUnit/TestCaller.h"
 #include "CppUnit/TestSuite.h"
 #include <fstream>
+#include <sstream>
 
 
 using namespace Poco::Zip;
@@ -134,6 +139,73 @@ void CompressTest::testSetZipComment()
 }
 
 
+void CompressTest::testParallel()
+{
+	parallelRoundTrip(true);
+}
+
+
+void CompressTest::testParallelNonSeekable()
+{
+	parallelRoundTrip(false);
+}
+
+
+void CompressTest::parallelRoundTrip(bool seekableOut)
+{
+	// compressible data spanning several blocks, with a partial last block
+	std::string large;
+	Poco::Random rnd;
+	rnd.seed(42);
+	static const char* words[] = {"zip ", "deflate ", "block ", "thread ", "pool ", "archive ", "entry ", "\n"};
+	while (large.size() < 5*65536 + 1234)
+	{
+		large.append(words[rnd.next(8)]);
+	}
+	std::string exact(2*65536, 'x');
+	std::string small("just some test data");
+
+	std::ostringstream out(std::ios::binary);
+	Poco::ThreadPool pool(2, 4);
+	{
+		Compress c(out, seekableOut, pool);
+		assert (c.isParallel());
+		c.setBlockSize(65536);
+		std::istringstream largeIn(large);
+		c.addFile(largeIn, Poco::DateTime(), Poco::Path("data/large.txt"));
+		std::istringstream exactIn(exact);
+		c.addFile(exactIn, Poco::DateTime(), Poco::Path("data/exact.txt"), ZipCommon::CM_DEFLATE, ZipCommon::CL_FAST);
+		std::istringstream smallIn(small);
+		c.addFile(smallIn, Poco::DateTime(), Poco::Path("small.txt"), ZipCommon::CM_STORE);
+		std::istringstream emptyIn;
+		c.addFile(emptyIn, Poco::DateTime(), Poco::Path("data/empty/empty.txt"));
+		ZipArchive a(c.close());
+		assert (a.findHeader("data/") != a.headerEnd());
+		assert (a.findHeader("data/empty/") != a.headerEnd());
+	}
+
+	std::istringstream in(out.str());
+	ZipArchive archive(in);
+	assert (archive.findHeader("data/") != archive.headerEnd());
+	assert (archive.findHeader("data/empty/") != archive.headerEnd());
+
+	const std::string names[] = {"data/large.txt", "data/exact.txt", "small.txt", "data/empty/empty.txt"};
+	const std::string* contents[] = {&large, &exact, &small, 0};
+	for (int i = 0; i < 4; ++i)
+	{
+		ZipArchive::FileHeaders::const_iterator it = archive.findHeader(names[i]);
+		assert (it != archive.headerEnd());
+		in.clear();
+		ZipInputStream zipIn(in, it->second);
+		std::ostringstream data(std::ios::binary);
+		Poco::StreamCopier::copyStream(zipIn, data);
+		assert (zipIn.crcValid());
+		assert (data.str() == (contents[i] ? *contents[i] : std::string()));
+	}
+	assert (out.str().size() < large.size()/2);
+}
+
+
 void CompressTest::setUp()
 {
 }
@@ -154,6 +226,8 @@ CppUnit::Test* CompressTest::suite()
 	CppUnit_addTest(pSuite, CompressTest, testManipulatorDel);
 	CppUnit_addTest(pSuite, CompressTest, testManipulatorReplace);
 	CppUnit_addTest(pSuite, CompressTest, testSetZipComment);
+	CppUnit_addTest(pSuite, CompressTest, testParallel);
+	CppUnit_addTest(pSuite, CompressTest, testParallelNonSeekable);
 
 	return pSuite;
 }
@@ -32,6 +32,8 @@ public:
 	void testManipulatorDel();
 	void testManipulatorReplace();
 	void testSetZipComment();
+	void testParallel();
+	void testParallelNonSeekable();
 
 	void setUp();
 	void tearDown();
@@ -39,6 +41,7 @@ public:
 	static CppUnit::Test* suite();
 
 private:
+	void parallelRoundTrip(bool seekableOut);
 };
 
 
@@ -17,12 +17,19 @@
 #include "Poco/Zip/ZipStream.h"
 #include "Poco/Zip/Decompress.h"
 #include "Poco/Zip/ZipCommon.h"
+#include "Poco/Zip/MappedZipArchive.h"
+#include "Poco/Zip/Compress.h"
+#include "Poco/Zip/ZipException.h"
+#include "Poco/Buffer.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/File.h"
 #include "Poco/URI.h"
 #include "Poco/Path.h"
 #include "Poco/Delegate.h"
 #include "Poco/StreamCopier.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/DateTime.h"
 #include "CppUnit/TestCaller.h"
 #include "CppUnit/TestSuite.h"
 #include <fstream>
@@ -164,6 +171,158 @@ void ZipTest::testDecompressFlat()
 }
 
 
+void ZipTest::testDecompressParallel()
+{
+	Poco::ThreadPool pool(2, 4);
+	const std::string testFiles[] = {"test.zip", "data.zip"};
+	for (int i = 0; i < 2; ++i)
+	{
+		std::string testFile = getTestFile(testFiles[i]);
+		std::ifstream inp(testFile.c_str(), std::ios::binary);
+		assert (inp.good());
+		Decompress dec(inp, Poco::Path("parallel"));
+		dec.EError += Poco::Delegate<ZipTest, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> >(this, &ZipTest::onDecompressError);
+		ZipArchive arch = dec.decompressAllFiles(pool);
+		dec.EError -= Poco::Delegate<ZipTest, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> >(this, &ZipTest::onDecompressError);
+		assert (_errCnt == 0);
+		assert (!dec.mapping().empty());
+
+		std::size_t files = 0;
+		for (ZipArchive::FileHeaders::const_iterator it = arch.headerBegin(); it != arch.headerEnd(); ++it)
+		{
+			if (it->second.isFile()) ++files;
+		}
+		assert (dec.mapping().size() == files);
+	}
+
+	// entries with data descriptors, as written to a non-seekable stream
+	std::ostringstream ostr;
+	Compress c(ostr, false, pool);
+	c.setBlockSize(65536);
+	for (int i = 0; i < 5; ++i)
+	{
+		std::istringstream data(std::string(100000 + i, 'a' + i));
+		c.addFile(data, Poco::DateTime(), Poco::Path("data" + Poco::NumberFormatter::format(i) + ".txt"));
+	}
+	c.close();
+	std::istringstream zipStream(ostr.str());
+	Decompress dec(zipStream, Poco::Path("parallel"));
+	dec.EError += Poco::Delegate<ZipTest, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> >(this, &ZipTest::onDecompressError);
+	ZipArchive arch = dec.decompressAllFiles(pool);
+	dec.EError -= Poco::Delegate<ZipTest, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> >(this, &ZipTest::onDecompressError);
+	assert (_errCnt == 0);
+	assert (dec.mapping().size() == 5);
+	assert (Poco::File("parallel/data4.txt").getSize() == 100004);
+
+	// no central directory
+	std::istringstream truncated(ostr.str().substr(0, ostr.str().size()/2));
+	Decompress decTruncated(truncated, Poco::Path("parallel"));
+	try
+	{
+		decTruncated.decompressAllFiles(pool);
+		fail("must throw");
+	}
+	catch (ZipException&)
+	{
+	}
+	Poco::File("parallel").remove(true);
+}
+
+
+void ZipTest::testMappedArchive()
+{
+	const std::string testFiles[] = {"test.zip", "data.zip"};
+	for (int i = 0; i < 2; ++i)
+	{
+		std::string testFile = getTestFile(testFiles[i]);
+		MappedZipArchive mapped(testFile);
+		std::ifstream inp(testFile.c_str(), std::ios::binary);
+		ZipArchive arch(inp);
+		assert (mapped.size() > 0);
+
+		std::size_t files = 0;
+		for (ZipArchive::FileHeaders::const_iterator it = arch.headerBegin(); it != arch.headerEnd(); ++it)
+		{
+			MappedZipArchive::ConstIterator itMapped = mapped.find(it->first);
+			assert (itMapped != mapped.end());
+			assert (itMapped->getFileName() == it->first);
+			assert (itMapped->isDirectory() == it->second.isDirectory());
+			if (itMapped->isDirectory()) continue;
+
+			inp.clear();
+			ZipInputStream zipin(inp, it->second);
+			std::ostringstream out(std::ios::binary);
+			Poco::StreamCopier::copyStream(zipin, out);
+
+			Poco::Buffer<char> buffer(itMapped->getUncompressedSize() + 1);
+			std::size_t n = mapped.extract(*itMapped, buffer.begin(), buffer.size());
+			assert (std::string(buffer.begin(), n) == out.str());
+			++files;
+		}
+		assert (files > 0);
+		assert (mapped.find("nonexisting.txt") == mapped.end());
+	}
+}
+
+
+void ZipTest::testMappedArchiveStored()
+{
+	std::string stored("stored data, returned without copying");
+	std::string deflated(10000, 'd');
+	{
+		std::ofstream out("mapped.zip", std::ios::binary);
+		Compress c(out, true);
+		std::istringstream storedIn(stored);
+		c.addFile(storedIn, Poco::DateTime(), Poco::Path("stored.txt"), ZipCommon::CM_STORE);
+		std::istringstream deflatedIn(deflated);
+		c.addFile(deflatedIn, Poco::DateTime(), Poco::Path("dir/deflated.txt"));
+		c.setZipComment("a comment");
+		c.close();
+	}
+	{
+		MappedZipArchive mapped("mapped.zip");
+		assert (mapped.size() == 2);
+
+		MappedZipArchive::ConstIterator it = mapped.find("stored.txt");
+		assert (it != mapped.end());
+		assert (it->isStored());
+		assert (std::string(mapped.data(*it), it->getUncompressedSize()) == stored);
+
+		it = mapped.find("dir/deflated.txt");
+		assert (it != mapped.end());
+		assert (!it->isStored());
+		assert (it->getCompressedSize() < deflated.size());
+		Poco::Buffer<char> buffer(it->getUncompressedSize());
+		assert (mapped.extract(*it, buffer.begin(), buffer.size()) == deflated.size());
+		assert (std::string(buffer.begin(), buffer.size()) == deflated);
+
+		try
+		{
+			mapped.extract(*it, buffer.begin(), buffer.size() - 1);
+			fail("buffer too small - must throw");
+		}
+		catch (Poco::InvalidArgumentException&)
+		{
+		}
+	}
+	Poco::File("mapped.zip").remove();
+
+	{
+		std::ofstream out("notazip.zip", std::ios::binary);
+		out << "just some text, no zip file";
+	}
+	try
+	{
+		MappedZipArchive mapped("notazip.zip");
+		fail("not a zip file - must throw");
+	}
+	catch (ZipException&)
+	{
+	}
+	Poco::File("notazip.zip").remove();
+}
+
+
 void ZipTest::onDecompressError(const void* pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>& info)
 {
 	++_errCnt;
@@ -189,6 +348,9 @@ CppUnit::Test* ZipTest::suite()
 	CppUnit_addTest(pSuite, ZipTest, testDecompressSingleFile);
 	CppUnit_addTest(pSuite, ZipTest, testDecompress);
 	CppUnit_addTest(pSuite, ZipTest, testDecompressFlat);
+	CppUnit_addTest(pSuite, ZipTest, testDecompressParallel);
+	CppUnit_addTest(pSuite, ZipTest, testMappedArchive);
+	CppUnit_addTest(pSuite, ZipTest, testMappedArchiveStored);
 	CppUnit_addTest(pSuite, ZipTest, testCrcAndSizeAfterData);
 	CppUnit_addTest(pSuite, ZipTest, testCrcAndSizeAfterDataWithArchive);
 	return pSuite;
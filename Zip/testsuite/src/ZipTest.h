@@ -34,6 +34,9 @@ public:
 	void testCrcAndSizeAfterDataWithArchive();
 
 	void testDecompressFlat();
+	void testDecompressParallel();
+	void testMappedArchive();
+	void testMappedArchiveStored();
 
 	void setUp();
 	void tearDown();